@@ -0,0 +1,194 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// Module Name:
+//
+//   OpteeBench.h
+//
+// Abstract:
+//
+//   Iteration loop, latency statistics and JSON report of the OpteeTest
+//   benchmark mode. Workloads, threads and the TrEE services stay in
+//   main.cpp; the clock is a hook, so the same code runs on the host against
+//   a mock TrEE service (test/OpteeBenchTest.cpp).
+//
+//   The including file may define:
+//
+//     BENCH_QUERY_COUNTER(CounterPtr)  Read the tick counter into a
+//                                      LARGE_INTEGER (QueryPerformanceCounter)
+//
+// Environment:
+//
+//   User mode
+//
+
+#ifndef _OPTEEBENCH_H_
+#define _OPTEEBENCH_H_
+
+#include <wchar.h>
+#include <algorithm>
+#include <vector>
+
+#ifndef BENCH_QUERY_COUNTER
+#define BENCH_QUERY_COUNTER(CounterPtr) QueryPerformanceCounter(CounterPtr)
+#endif
+
+//
+// What one benchmark thread measured. Failed calls are counted but their
+// latency is not recorded.
+//
+struct BENCH_THREAD_STATS {
+    std::vector<LONGLONG> Latencies;    // Ticks of each successful call
+    ULONG Errors;
+    DWORD LastError;
+};
+
+//
+// All threads of a run, latencies in microseconds
+//
+struct BENCH_SUMMARY {
+    size_t Completed;
+    ULONG Errors;
+    DWORD LastError;
+    double Seconds;
+    double OpsPerSecond;
+    double MinUs;
+    double P50Us;
+    double P90Us;
+    double P99Us;
+    double MaxUs;
+};
+
+//
+// Runs Operation, which returns NO_ERROR or an error code, Iterations
+// times and records the round trip of each call in StatsPtr.
+//
+template <typename OPERATION>
+VOID
+BenchRunIterations (
+    _Inout_ BENCH_THREAD_STATS* StatsPtr,
+    _In_ ULONG Iterations,
+    _In_ OPERATION Operation
+    )
+{
+    for (ULONG i = 0; i < Iterations; ++i) {
+        LARGE_INTEGER start;
+        LARGE_INTEGER end;
+
+        BENCH_QUERY_COUNTER(&start);
+        DWORD status = Operation();
+        BENCH_QUERY_COUNTER(&end);
+
+        if (status != NO_ERROR) {
+            ++StatsPtr->Errors;
+            StatsPtr->LastError = status;
+            continue;
+        }
+
+        StatsPtr->Latencies.push_back(end.QuadPart - start.QuadPart);
+    }
+}
+
+inline
+double
+BenchPercentileUs (
+    _In_ const std::vector<LONGLONG>& SortedLatencies,
+    _In_ ULONG Percentile,
+    _In_ double TicksPerUs
+    )
+{
+    if (SortedLatencies.empty()) {
+        return 0.0;
+    }
+
+    size_t index = ((SortedLatencies.size() - 1) * Percentile) / 100;
+    return SortedLatencies[index] / TicksPerUs;
+}
+
+//
+// Merges the threads' statistics of a run that took ElapsedTicks of a
+// counter running at Frequency ticks per second.
+//
+inline
+VOID
+BenchSummarize (
+    _In_reads_(ThreadCount) const BENCH_THREAD_STATS* const StatsPtrs[],
+    _In_ ULONG ThreadCount,
+    _In_ LONGLONG Frequency,
+    _In_ LONGLONG ElapsedTicks,
+    _Out_ BENCH_SUMMARY* SummaryPtr
+    )
+{
+    std::vector<LONGLONG> latencies;
+    ULONG errors = 0;
+    DWORD lastError = NO_ERROR;
+
+    for (ULONG threadInx = 0; threadInx < ThreadCount; ++threadInx) {
+        const BENCH_THREAD_STATS* statsPtr = StatsPtrs[threadInx];
+
+        latencies.insert(latencies.end(), statsPtr->Latencies.begin(), statsPtr->Latencies.end());
+        errors += statsPtr->Errors;
+        if (statsPtr->Errors != 0) {
+            lastError = statsPtr->LastError;
+        }
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+
+    double ticksPerUs = Frequency / 1000000.0;
+    double seconds = (double)ElapsedTicks / Frequency;
+
+    SummaryPtr->Completed = latencies.size();
+    SummaryPtr->Errors = errors;
+    SummaryPtr->LastError = lastError;
+    SummaryPtr->Seconds = seconds;
+    SummaryPtr->OpsPerSecond = (seconds > 0.0) ? (latencies.size() / seconds) : 0.0;
+    SummaryPtr->MinUs = BenchPercentileUs(latencies, 0, ticksPerUs);
+    SummaryPtr->P50Us = BenchPercentileUs(latencies, 50, ticksPerUs);
+    SummaryPtr->P90Us = BenchPercentileUs(latencies, 90, ticksPerUs);
+    SummaryPtr->P99Us = BenchPercentileUs(latencies, 99, ticksPerUs);
+    SummaryPtr->MaxUs = BenchPercentileUs(latencies, 100, ticksPerUs);
+}
+
+//
+// Formats the report of a run as one JSON object, without a newline.
+// Returns the number of characters written, or a negative value if the
+// buffer is too small.
+//
+inline
+int
+BenchFormatJson (
+    _Out_writes_(BufferLength) wchar_t* BufferPtr,
+    _In_ size_t BufferLength,
+    _In_ const wchar_t* WorkloadNameWsz,
+    _In_ ULONG Iterations,
+    _In_ ULONG Concurrency,
+    _In_ bool IsDeferred,
+    _In_ const BENCH_SUMMARY* SummaryPtr
+    )
+{
+    return swprintf(
+        BufferPtr,
+        BufferLength,
+        L"{\"workload\":\"%ls\",\"iterations\":%u,\"concurrency\":%u,"
+        L"\"deferred\":%ls,\"completed\":%zu,\"errors\":%u,\"last_error\":%u,"
+        L"\"seconds\":%.6f,\"ops_per_sec\":%.1f,"
+        L"\"latency_us\":{\"min\":%.1f,\"p50\":%.1f,\"p90\":%.1f,"
+        L"\"p99\":%.1f,\"max\":%.1f}}",
+        WorkloadNameWsz,
+        (unsigned)Iterations,
+        (unsigned)Concurrency,
+        IsDeferred ? L"true" : L"false",
+        SummaryPtr->Completed,
+        (unsigned)SummaryPtr->Errors,
+        (unsigned)SummaryPtr->LastError,
+        SummaryPtr->Seconds,
+        SummaryPtr->OpsPerSecond,
+        SummaryPtr->MinUs,
+        SummaryPtr->P50Us,
+        SummaryPtr->P90Us,
+        SummaryPtr->P99Us,
+        SummaryPtr->MaxUs);
+}
+
+#endif // _OPTEEBENCH_H_
@@ -4,9 +4,13 @@
 #include <windows.h>
 #include <initguid.h>
 #include <TrustedRT.h>
+#include <tbs.h>
 #include <memory>
+#include <vector>
+#include <algorithm>
 
 #include "OpteeCalls.h"
+#include "OpteeBench.h"
 
 //
 // OP-TEE TA GUIDs
@@ -87,6 +91,20 @@ struct OPTEE_SERVICE_DESC {
 //
 EVT_SERVICE_CMD_HANDLER AuthVarTestHandler;
 
+DWORD
+EnablePrivilege (
+    _In_ DWORD NewPrivilege
+    );
+
+//
+// Benchmark mode, see BenchMain
+//
+int
+BenchMain (
+    _In_ int ArgCount,
+    _In_reads_(ArgCount) const wchar_t* Args[]
+    );
+
 //
 // OP-TEE Service descriptors
 //
@@ -558,10 +576,16 @@ PCWSTR HelpSwz =
           "Usage F<service index><session index><funtion index>\n"
     L"h - Print this help message\n"
     L"q - Quit\n"
+    L"\n"
+    L"Run 'OpteeTest -bench' for the non interactive benchmark mode\n"
     ;
 
-int __cdecl wmain (int , const wchar_t* )
+int __cdecl wmain (int argc, const wchar_t* argv[])
 {
+    if ((argc > 1) && (_wcsicmp(argv[1], L"-bench") == 0)) {
+        return BenchMain(argc - 2, argv + 2);
+    }
+
     Init();
 
     wprintf(L"%ws\n", HelpSwz);
@@ -1128,3 +1152,584 @@ AuthVarTestHandler (
 
     return status;
 }
+
+
+//
+// Benchmark mode
+//
+// Runs one workload for a fixed number of iterations on a number of threads
+// and prints the round trip latency distribution and the throughput as a
+// single JSON object on stdout, diagnostics go to stderr.
+//
+
+#define BENCH_DEFAULT_ITERATIONS 1000
+#define BENCH_DEFAULT_CONCURRENCY 1
+#define BENCH_MAX_CONCURRENCY 64
+#define BENCH_BUFFER_SIZE_BYTES 32
+#define BENCH_VARIABLE_NAME L"OpteeTest-Bench"
+#define BENCH_ENUM_BUFFER_SIZE_BYTES (64 * 1024)
+
+//
+// TPM2_GetRandom(8)
+//
+static const BYTE BenchTpmGetRandomCmd[] = {
+    0x80, 0x01,                 // TPM_ST_NO_SESSIONS
+    0x00, 0x00, 0x00, 0x0C,     // commandSize
+    0x00, 0x00, 0x01, 0x7B,     // TPM_CC_GetRandom
+    0x00, 0x08                  // bytesRequested
+};
+
+typedef LONG (NTAPI *PFN_NT_ENUMERATE_SYSTEM_ENVIRONMENT_VALUES_EX)(
+    _In_ ULONG InformationClass,
+    _Out_ PVOID Buffer,
+    _Inout_ PULONG BufferLength
+    );
+
+#define BENCH_ENV_NAME_INFORMATION 1 // SystemEnvironmentNameInformation
+#define BENCH_STATUS_BUFFER_TOO_SMALL ((LONG)0xC0000023L)
+
+struct BENCH_THREAD_CONTEXT;
+
+typedef DWORD BENCH_OPERATION(_Inout_ BENCH_THREAD_CONTEXT* ContextPtr);
+
+struct BENCH_WORKLOAD_DESC {
+    PCWSTR NameWsz;
+    LPCGUID ServiceGuidPtr;     // Service to open a session to, if any
+    int Function;
+    BENCH_OPERATION* OperationPtr;
+};
+
+struct BENCH_THREAD_CONTEXT {
+    const BENCH_WORKLOAD_DESC* WorkloadPtr;
+    HANDLE ServiceHandle;
+    TBS_HCONTEXT TbsContext;
+    ULONG Iterations;
+    bool IsDeferred;
+    BENCH_THREAD_STATS Stats;
+    std::unique_ptr<BYTE[]> EnumBuffer;
+};
+
+BENCH_OPERATION BenchHelloWorldCmd;
+BENCH_OPERATION BenchFtpmGetRandom;
+BENCH_OPERATION BenchVariableGet;
+BENCH_OPERATION BenchVariableSet;
+BENCH_OPERATION BenchVariableEnum;
+
+static const BENCH_WORKLOAD_DESC BenchWorkloads[] = {
+    { L"pta", &GUID_OPTEE_HELLO_WORLD_PTA_SERVICE, 1, BenchHelloWorldCmd },
+    { L"ta", &GUID_OPTEE_HELLO_WORLD_TA_SERVICE, 1, BenchHelloWorldCmd },
+    { L"ftpm", nullptr, 0, BenchFtpmGetRandom },
+    { L"varget", nullptr, 0, BenchVariableGet },
+    { L"varset", nullptr, 0, BenchVariableSet },
+    { L"varenum", nullptr, 0, BenchVariableEnum },
+};
+
+static WCHAR BenchVariableGuidWsz[40];
+static PFN_NT_ENUMERATE_SYSTEM_ENVIRONMENT_VALUES_EX BenchNtEnumerateSystemEnvironmentValuesEx;
+
+PCWSTR BenchHelpSwz =
+    L"Usage: OpteeTest -bench <workload> [-n <iterations>] [-c <threads>] [-deferred]\n"
+    L"  workload  pta | ta | ftpm | varget | varset | varenum\n"
+    L"  -n        Iterations per thread, default 1000\n"
+    L"  -c        Number of concurrent threads, default 1\n"
+    L"  -deferred Issue every call from a new thread, as 'F' does\n"
+    ;
+
+_Use_decl_annotations_
+DWORD
+BenchHelloWorldCmd (
+    BENCH_THREAD_CONTEXT* ContextPtr
+    )
+{
+    UCHAR inBuffer[BENCH_BUFFER_SIZE_BYTES];
+    UCHAR outBuffer[BENCH_BUFFER_SIZE_BYTES];
+    for (UINT i = 0; i < ARRAYSIZE(inBuffer); ++i) {
+        inBuffer[i] = (UCHAR)i;
+    }
+
+    UINT32 bytesWritten;
+    BOOL isSuccess = CallOpteeCommand(
+        ContextPtr->ServiceHandle,
+        ContextPtr->WorkloadPtr->Function,
+        inBuffer, sizeof(inBuffer),
+        outBuffer, sizeof(outBuffer),
+        &bytesWritten,
+        NULL, // No callback
+        NULL);
+
+    return isSuccess ? NO_ERROR : GetLastError();
+}
+
+_Use_decl_annotations_
+DWORD
+BenchFtpmGetRandom (
+    BENCH_THREAD_CONTEXT* ContextPtr
+    )
+{
+    BYTE response[64];
+    UINT32 responseSize = sizeof(response);
+
+    TBS_RESULT result = Tbsip_Submit_Command(
+        ContextPtr->TbsContext,
+        TBS_COMMAND_LOCALITY_ZERO,
+        TBS_COMMAND_PRIORITY_NORMAL,
+        BenchTpmGetRandomCmd,
+        sizeof(BenchTpmGetRandomCmd),
+        response,
+        &responseSize);
+
+    if (result != TBS_SUCCESS) {
+        return result;
+    }
+
+    //
+    // TPM response code, big endian at offset 6
+    //
+    if ((responseSize < 10) ||
+        (response[6] | response[7] | response[8] | response[9]) != 0) {
+
+        return ERROR_INVALID_DATA;
+    }
+
+    return NO_ERROR;
+}
+
+_Use_decl_annotations_
+DWORD
+BenchVariableGet (
+    BENCH_THREAD_CONTEXT* ContextPtr
+    )
+{
+    UINT32 data;
+
+    UNREFERENCED_PARAMETER(ContextPtr);
+
+    if (GetFirmwareEnvironmentVariableExW(
+            BENCH_VARIABLE_NAME,
+            BenchVariableGuidWsz,
+            &data,
+            sizeof(data),
+            nullptr) == 0) {
+
+        return GetLastError();
+    }
+
+    return NO_ERROR;
+}
+
+_Use_decl_annotations_
+DWORD
+BenchVariableSet (
+    BENCH_THREAD_CONTEXT* ContextPtr
+    )
+{
+    UINT32 data = (UINT32)ContextPtr->Stats.Latencies.size();
+
+    if (!SetFirmwareEnvironmentVariableExW(
+            BENCH_VARIABLE_NAME,
+            BenchVariableGuidWsz,
+            &data,
+            sizeof(data),
+            (VARIABLE_ATTRIBUTE_NON_VOLATILE |
+                VARIABLE_ATTRIBUTE_RUNTIME_ACCESS |
+                VARIABLE_ATTRIBUTE_BOOTSERVICE_ACCESS))) {
+
+        return GetLastError();
+    }
+
+    return NO_ERROR;
+}
+
+_Use_decl_annotations_
+DWORD
+BenchVariableEnum (
+    BENCH_THREAD_CONTEXT* ContextPtr
+    )
+{
+    ULONG bufferLength = BENCH_ENUM_BUFFER_SIZE_BYTES;
+
+    LONG ntStatus = BenchNtEnumerateSystemEnvironmentValuesEx(
+        BENCH_ENV_NAME_INFORMATION,
+        ContextPtr->EnumBuffer.get(),
+        &bufferLength);
+
+    if (ntStatus == BENCH_STATUS_BUFFER_TOO_SMALL) {
+        return ERROR_INSUFFICIENT_BUFFER;
+    }
+
+    return (ntStatus >= 0) ? NO_ERROR : ERROR_GEN_FAILURE;
+}
+
+DWORD
+WINAPI
+BenchDeferredThread (LPVOID ParameterPtr)
+{
+    BENCH_THREAD_CONTEXT* contextPtr = (BENCH_THREAD_CONTEXT*)ParameterPtr;
+
+    return contextPtr->WorkloadPtr->OperationPtr(contextPtr);
+}
+
+DWORD
+BenchRunDeferred (
+    _Inout_ BENCH_THREAD_CONTEXT* ContextPtr
+    )
+{
+    HANDLE workerThread = CreateThread(
+        nullptr,
+        0,
+        BenchDeferredThread,
+        ContextPtr,
+        0,
+        nullptr);
+
+    if (workerThread == NULL) {
+        return GetLastError();
+    }
+
+    DWORD status;
+    WaitForSingleObject(workerThread, INFINITE);
+    if (!GetExitCodeThread(workerThread, &status)) {
+        status = GetLastError();
+    }
+
+    CloseHandle(workerThread);
+    return status;
+}
+
+DWORD
+WINAPI
+BenchThread (LPVOID ParameterPtr)
+{
+    BENCH_THREAD_CONTEXT* contextPtr = (BENCH_THREAD_CONTEXT*)ParameterPtr;
+
+    BenchRunIterations(&contextPtr->Stats, contextPtr->Iterations, [contextPtr] {
+        if (contextPtr->IsDeferred) {
+            return BenchRunDeferred(contextPtr);
+        }
+
+        return contextPtr->WorkloadPtr->OperationPtr(contextPtr);
+    });
+
+    return NO_ERROR;
+}
+
+HANDLE
+BenchOpenService (
+    _In_ LPCGUID ServiceGuid
+    )
+{
+    WCHAR interfaceSymlink[128];
+
+    swprintf_s(
+        interfaceSymlink,
+        L"\\\\.\\WindowsTrustedRT\\{%08x-%04x-%04x-%02x%02x-%02x%02x%02x%02x%02x%02x}",
+        ServiceGuid->Data1,
+        ServiceGuid->Data2,
+        ServiceGuid->Data3,
+        ServiceGuid->Data4[0],
+        ServiceGuid->Data4[1],
+        ServiceGuid->Data4[2],
+        ServiceGuid->Data4[3],
+        ServiceGuid->Data4[4],
+        ServiceGuid->Data4[5],
+        ServiceGuid->Data4[6],
+        ServiceGuid->Data4[7]);
+
+    return CreateFileW(
+        interfaceSymlink,
+        FILE_READ_DATA | FILE_WRITE_DATA,
+        0,
+        NULL,
+        OPEN_EXISTING,
+        FILE_FLAG_OVERLAPPED,
+        NULL);
+}
+
+DWORD
+BenchPrepareThread (
+    _Inout_ BENCH_THREAD_CONTEXT* ContextPtr
+    )
+{
+    const BENCH_WORKLOAD_DESC* workloadPtr = ContextPtr->WorkloadPtr;
+
+    ContextPtr->Stats.Latencies.reserve(ContextPtr->Iterations);
+
+    if (workloadPtr->ServiceGuidPtr != nullptr) {
+        ContextPtr->ServiceHandle = BenchOpenService(workloadPtr->ServiceGuidPtr);
+        if (ContextPtr->ServiceHandle == INVALID_HANDLE_VALUE) {
+            return GetLastError();
+        }
+    }
+
+    if (workloadPtr->OperationPtr == BenchFtpmGetRandom) {
+        TBS_CONTEXT_PARAMS2 params = {};
+        params.version = TPM_VERSION_20;
+        params.includeTpm20 = 1;
+
+        TBS_RESULT result = Tbsi_Context_Create(
+            (PCTBS_CONTEXT_PARAMS)&params,
+            &ContextPtr->TbsContext);
+
+        if (result != TBS_SUCCESS) {
+            return result;
+        }
+    }
+
+    if (workloadPtr->OperationPtr == BenchVariableEnum) {
+        ContextPtr->EnumBuffer.reset(
+            new (std::nothrow) BYTE[BENCH_ENUM_BUFFER_SIZE_BYTES]);
+
+        if (!ContextPtr->EnumBuffer) {
+            return ERROR_NOT_ENOUGH_MEMORY;
+        }
+    }
+
+    return NO_ERROR;
+}
+
+VOID
+BenchCleanupThread (
+    _Inout_ BENCH_THREAD_CONTEXT* ContextPtr
+    )
+{
+    if ((ContextPtr->ServiceHandle != NULL) &&
+        (ContextPtr->ServiceHandle != INVALID_HANDLE_VALUE)) {
+
+        CloseHandle(ContextPtr->ServiceHandle);
+    }
+
+    if (ContextPtr->TbsContext != NULL) {
+        Tbsip_Context_Close(ContextPtr->TbsContext);
+    }
+}
+
+DWORD
+BenchPrepareVariables (
+    _In_ const BENCH_WORKLOAD_DESC* WorkloadPtr
+    )
+{
+    DWORD status = EnablePrivilege(SE_SYSTEM_ENVIRONMENT_PRIVILEGE);
+    if (status != NO_ERROR) {
+        fwprintf(stderr, L"Error: enable privilege failed 0x%x\n", status);
+        return status;
+    }
+
+    if (WorkloadPtr->OperationPtr == BenchVariableEnum) {
+        BenchNtEnumerateSystemEnvironmentValuesEx =
+            (PFN_NT_ENUMERATE_SYSTEM_ENVIRONMENT_VALUES_EX)GetProcAddress(
+                GetModuleHandleW(L"ntdll.dll"),
+                "NtEnumerateSystemEnvironmentValuesEx");
+
+        if (BenchNtEnumerateSystemEnvironmentValuesEx == nullptr) {
+            return GetLastError();
+        }
+
+        return NO_ERROR;
+    }
+
+    GUID benchGuid;
+    CoCreateGuid(&benchGuid);
+    StringFromGUID2(benchGuid, BenchVariableGuidWsz, _countof(BenchVariableGuidWsz));
+
+    //
+    // The variable read by 'varget'
+    //
+    UINT32 data = 0x12345678;
+    if (!SetFirmwareEnvironmentVariableExW(
+            BENCH_VARIABLE_NAME,
+            BenchVariableGuidWsz,
+            &data,
+            sizeof(data),
+            (VARIABLE_ATTRIBUTE_NON_VOLATILE |
+                VARIABLE_ATTRIBUTE_RUNTIME_ACCESS |
+                VARIABLE_ATTRIBUTE_BOOTSERVICE_ACCESS))) {
+
+        status = GetLastError();
+        fwprintf(stderr, L"Error: creating the benchmark variable failed 0x%x\n", status);
+        return status;
+    }
+
+    return NO_ERROR;
+}
+
+VOID
+BenchCleanupVariables (
+    _In_ const BENCH_WORKLOAD_DESC* WorkloadPtr
+    )
+{
+    UNREFERENCED_PARAMETER(WorkloadPtr);
+
+    if (BenchVariableGuidWsz[0] == L'\0') {
+        return;
+    }
+
+    SetFirmwareEnvironmentVariableExW(
+        BENCH_VARIABLE_NAME,
+        BenchVariableGuidWsz,
+        nullptr,
+        0,
+        (VARIABLE_ATTRIBUTE_NON_VOLATILE |
+            VARIABLE_ATTRIBUTE_RUNTIME_ACCESS |
+            VARIABLE_ATTRIBUTE_BOOTSERVICE_ACCESS));
+}
+
+_Use_decl_annotations_
+int
+BenchMain (
+    int ArgCount,
+    const wchar_t* Args[]
+    )
+{
+    const BENCH_WORKLOAD_DESC* workloadPtr = nullptr;
+    ULONG iterations = BENCH_DEFAULT_ITERATIONS;
+    ULONG concurrency = BENCH_DEFAULT_CONCURRENCY;
+    bool isDeferred = false;
+
+    for (int argInx = 0; argInx < ArgCount; ++argInx) {
+        if ((_wcsicmp(Args[argInx], L"-n") == 0) && (argInx + 1 < ArgCount)) {
+            iterations = wcstoul(Args[++argInx], nullptr, 0);
+
+        } else if ((_wcsicmp(Args[argInx], L"-c") == 0) && (argInx + 1 < ArgCount)) {
+            concurrency = wcstoul(Args[++argInx], nullptr, 0);
+
+        } else if (_wcsicmp(Args[argInx], L"-deferred") == 0) {
+            isDeferred = true;
+
+        } else if (workloadPtr == nullptr) {
+            for (int workloadInx = 0;
+                 workloadInx < ARRAYSIZE(BenchWorkloads);
+                 ++workloadInx) {
+
+                if (_wcsicmp(Args[argInx], BenchWorkloads[workloadInx].NameWsz) == 0) {
+                    workloadPtr = &BenchWorkloads[workloadInx];
+                    break;
+                }
+            }
+
+            if (workloadPtr == nullptr) {
+                fwprintf(stderr, L"Error: unknown workload '%ws'\n%ws", Args[argInx], BenchHelpSwz);
+                return ERROR_INVALID_PARAMETER;
+            }
+
+        } else {
+            fwprintf(stderr, L"Error: unexpected argument '%ws'\n%ws", Args[argInx], BenchHelpSwz);
+            return ERROR_INVALID_PARAMETER;
+        }
+    }
+
+    if ((workloadPtr == nullptr) ||
+        (iterations == 0) ||
+        (concurrency == 0) ||
+        (concurrency > BENCH_MAX_CONCURRENCY)) {
+
+        fwprintf(stderr, L"%ws", BenchHelpSwz);
+        return ERROR_INVALID_PARAMETER;
+    }
+
+    DWORD status = NO_ERROR;
+    bool isVariableWorkload =
+        (workloadPtr->OperationPtr == BenchVariableGet) ||
+        (workloadPtr->OperationPtr == BenchVariableSet) ||
+        (workloadPtr->OperationPtr == BenchVariableEnum);
+
+    if (isVariableWorkload) {
+        status = BenchPrepareVariables(workloadPtr);
+        if (status != NO_ERROR) {
+            BenchCleanupVariables(workloadPtr);
+            return (int)status;
+        }
+    }
+
+    std::vector<BENCH_THREAD_CONTEXT> contexts(concurrency);
+    std::vector<HANDLE> threads;
+
+    for (ULONG threadInx = 0; threadInx < concurrency; ++threadInx) {
+        BENCH_THREAD_CONTEXT* contextPtr = &contexts[threadInx];
+        contextPtr->WorkloadPtr = workloadPtr;
+        contextPtr->ServiceHandle = NULL;
+        contextPtr->TbsContext = NULL;
+        contextPtr->Iterations = iterations;
+        contextPtr->IsDeferred = isDeferred;
+        contextPtr->Stats.Errors = 0;
+        contextPtr->Stats.LastError = NO_ERROR;
+
+        status = BenchPrepareThread(contextPtr);
+        if (status != NO_ERROR) {
+            fwprintf(stderr, L"Error: preparing thread %u failed 0x%x\n", threadInx, status);
+            goto Cleanup;
+        }
+    }
+
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER start;
+    LARGE_INTEGER end;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&start);
+
+    for (ULONG threadInx = 0; threadInx < concurrency; ++threadInx) {
+        HANDLE thread = CreateThread(
+            nullptr,
+            0,
+            BenchThread,
+            &contexts[threadInx],
+            0,
+            nullptr);
+
+        if (thread == NULL) {
+            status = GetLastError();
+            fwprintf(stderr, L"Error: failed to create benchmark thread 0x%x\n", status);
+            break;
+        }
+
+        threads.push_back(thread);
+    }
+
+    for (HANDLE thread : threads) {
+        WaitForSingleObject(thread, INFINITE);
+        CloseHandle(thread);
+    }
+
+    QueryPerformanceCounter(&end);
+
+    if (status == NO_ERROR) {
+        std::vector<const BENCH_THREAD_STATS*> statsPtrs;
+        for (const BENCH_THREAD_CONTEXT& context : contexts) {
+            statsPtrs.push_back(&context.Stats);
+        }
+
+        BENCH_SUMMARY summary;
+        BenchSummarize(
+            statsPtrs.data(),
+            concurrency,
+            frequency.QuadPart,
+            end.QuadPart - start.QuadPart,
+            &summary);
+
+        WCHAR report[512];
+        BenchFormatJson(
+            report,
+            _countof(report),
+            workloadPtr->NameWsz,
+            iterations,
+            concurrency,
+            isDeferred,
+            &summary);
+
+        wprintf(L"%ws\n", report);
+
+        if (summary.Errors != 0) {
+            status = summary.LastError;
+        }
+    }
+
+Cleanup:
+    for (BENCH_THREAD_CONTEXT& context : contexts) {
+        BenchCleanupThread(&context);
+    }
+
+    if (isVariableWorkload) {
+        BenchCleanupVariables(workloadPtr);
+    }
+
+    return (int)status;
+}
@@ -0,0 +1,504 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// Module Name:
+//
+//   OpteeBenchTest.cpp
+//
+// Abstract:
+//
+//   Host test of the OpteeTest benchmark engine in OpteeBench.h, run against
+//   a mock TrEE service. The mock echoes the command buffer like the hello
+//   world services, charges each call a known number of ticks on a mock
+//   clock and fails every n-th call, so the percentiles, error counts and
+//   JSON report of a run are checked exactly. Threads open their own
+//   session and run concurrently, and deferred mode issues every call from
+//   a new thread, as OpteeTest does.
+//
+//   "bench" runs the mock with no service time on the real clock and prints
+//   one JSON report per run, which is the client side cost of a call
+//   directly and deferred, for 1, 2 and 4 threads.
+//
+//   Build and run from the repository root:
+//
+//     c++ -std=c++14 -O2 -Wall -pthread
+//         -I driver/shared/hosttest -I driver/TrEE/OpteeTest
+//         driver/TrEE/OpteeTest/test/OpteeBenchTest.cpp -o OpteeBenchTest
+//     ./OpteeBenchTest [bench]
+//
+// Environment:
+//
+//   User mode, host
+//
+
+#include "hosttest.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+namespace { // static
+
+void mockQueryCounter (LARGE_INTEGER* CounterPtr);
+
+} // namespace "static"
+
+#define BENCH_QUERY_COUNTER(CounterPtr) mockQueryCounter(CounterPtr)
+
+#include "OpteeBench.h"
+
+namespace { // static
+
+const DWORD MOCK_ERROR_BUSY = 170;          // ERROR_BUSY
+const ULONG MOCK_BUFFER_SIZE_BYTES = 32;
+const LONGLONG MOCK_FREQUENCY = 1000000;    // Mock clock ticks are 1us
+const LONGLONG REAL_FREQUENCY = 1000000000;
+
+//
+// Clock. The mock clock only moves when the mock service charges a call,
+// the real clock is steady_clock in ns.
+//
+bool UseRealClock;
+std::atomic<LONGLONG> MockTicks;
+
+void mockQueryCounter (LARGE_INTEGER* CounterPtr)
+{
+    if (UseRealClock) {
+        CounterPtr->QuadPart = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    } else {
+        CounterPtr->QuadPart = MockTicks.load();
+    }
+}
+
+//
+// Mock TrEE service
+//
+struct MOCK_SESSION {
+    std::thread::id OwnerThread;
+    bool IsOpen;
+};
+
+struct MOCK_TREE_SERVICE {
+    std::mutex Lock;
+    ULONG OpenSessions;
+    ULONG PeakOpenSessions;
+    ULONG InFlight;
+    ULONG PeakInFlight;
+    ULONG Calls;
+    ULONG ForeignCalls;         // Calls not made by the session's opener
+    ULONG FailEvery;            // Every n-th call fails, 0 for none
+    bool ChargeCallIndex;       // The n-th call takes n mock ticks
+    ULONG SleepUs;              // Real service time of a call
+};
+
+MOCK_TREE_SERVICE MockService;
+
+void mockReset ()
+{
+    MockService.OpenSessions = 0;
+    MockService.PeakOpenSessions = 0;
+    MockService.InFlight = 0;
+    MockService.PeakInFlight = 0;
+    MockService.Calls = 0;
+    MockService.ForeignCalls = 0;
+    MockService.FailEvery = 0;
+    MockService.ChargeCallIndex = false;
+    MockService.SleepUs = 0;
+    MockTicks = 0;
+    UseRealClock = false;
+}
+
+void mockOpenSession (MOCK_SESSION* SessionPtr)
+{
+    std::lock_guard<std::mutex> lock(MockService.Lock);
+
+    SessionPtr->OwnerThread = std::this_thread::get_id();
+    SessionPtr->IsOpen = true;
+    ++MockService.OpenSessions;
+    MockService.PeakOpenSessions =
+        std::max(MockService.PeakOpenSessions, MockService.OpenSessions);
+}
+
+void mockCloseSession (MOCK_SESSION* SessionPtr)
+{
+    std::lock_guard<std::mutex> lock(MockService.Lock);
+
+    HOSTTEST_CHECK(SessionPtr->IsOpen);
+    SessionPtr->IsOpen = false;
+    --MockService.OpenSessions;
+}
+
+DWORD mockInvokeCommand (
+    MOCK_SESSION* SessionPtr,
+    const UCHAR* InBufferPtr,
+    UCHAR* OutBufferPtr,
+    ULONG Length
+    )
+{
+    ULONG callIndex;
+
+    {
+        std::lock_guard<std::mutex> lock(MockService.Lock);
+
+        if (!SessionPtr->IsOpen) {
+            return MOCK_ERROR_BUSY;
+        }
+
+        callIndex = ++MockService.Calls;
+        if (SessionPtr->OwnerThread != std::this_thread::get_id()) {
+            ++MockService.ForeignCalls;
+        }
+
+        ++MockService.InFlight;
+        MockService.PeakInFlight =
+            std::max(MockService.PeakInFlight, MockService.InFlight);
+    }
+
+    if (MockService.ChargeCallIndex) {
+        MockTicks += callIndex;
+    }
+
+    if (MockService.SleepUs != 0) {
+        std::this_thread::sleep_for(std::chrono::microseconds(MockService.SleepUs));
+    }
+
+    memcpy(OutBufferPtr, InBufferPtr, Length);
+
+    {
+        std::lock_guard<std::mutex> lock(MockService.Lock);
+        --MockService.InFlight;
+    }
+
+    if ((MockService.FailEvery != 0) && ((callIndex % MockService.FailEvery) == 0)) {
+        return MOCK_ERROR_BUSY;
+    }
+
+    return NO_ERROR;
+}
+
+//
+// The hello world workload of OpteeTest, against the mock
+//
+DWORD mockHelloWorldCmd (MOCK_SESSION* SessionPtr)
+{
+    UCHAR inBuffer[MOCK_BUFFER_SIZE_BYTES];
+    UCHAR outBuffer[MOCK_BUFFER_SIZE_BYTES];
+    for (ULONG i = 0; i < ARRAYSIZE(inBuffer); ++i) {
+        inBuffer[i] = (UCHAR)i;
+    }
+
+    DWORD status = mockInvokeCommand(SessionPtr, inBuffer, outBuffer, sizeof(outBuffer));
+    if ((status == NO_ERROR) && (memcmp(inBuffer, outBuffer, sizeof(inBuffer)) != 0)) {
+        return MOCK_ERROR_BUSY;
+    }
+
+    return status;
+}
+
+//
+// One run, threaded the way BenchMain and BenchThread are: a session and
+// statistics per thread, and in deferred mode a new thread per call.
+//
+void runMockBench (
+    ULONG Concurrency,
+    ULONG Iterations,
+    bool IsDeferred,
+    BENCH_SUMMARY* SummaryPtr
+    )
+{
+    std::vector<MOCK_SESSION> sessions(Concurrency);
+    std::vector<BENCH_THREAD_STATS> stats(Concurrency);
+    std::vector<const BENCH_THREAD_STATS*> statsPtrs;
+    std::vector<std::thread> threads;
+
+    for (ULONG threadInx = 0; threadInx < Concurrency; ++threadInx) {
+        stats[threadInx].Errors = 0;
+        stats[threadInx].LastError = NO_ERROR;
+        stats[threadInx].Latencies.reserve(Iterations);
+        statsPtrs.push_back(&stats[threadInx]);
+    }
+
+    LARGE_INTEGER start;
+    LARGE_INTEGER end;
+    mockQueryCounter(&start);
+
+    for (ULONG threadInx = 0; threadInx < Concurrency; ++threadInx) {
+        threads.emplace_back([&, threadInx] {
+            MOCK_SESSION* sessionPtr = &sessions[threadInx];
+
+            mockOpenSession(sessionPtr);
+            BenchRunIterations(&stats[threadInx], Iterations, [=] {
+                if (IsDeferred) {
+                    DWORD status;
+                    std::thread worker([&] { status = mockHelloWorldCmd(sessionPtr); });
+                    worker.join();
+                    return status;
+                }
+
+                return mockHelloWorldCmd(sessionPtr);
+            });
+            mockCloseSession(sessionPtr);
+        });
+    }
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    mockQueryCounter(&end);
+
+    BenchSummarize(
+        statsPtrs.data(),
+        Concurrency,
+        UseRealClock ? REAL_FREQUENCY : MOCK_FREQUENCY,
+        end.QuadPart - start.QuadPart,
+        SummaryPtr);
+}
+
+//
+// Nearest-rank percentiles over the sorted latencies
+//
+void testPercentiles ()
+{
+    std::vector<LONGLONG> latencies;
+
+    HOSTTEST_CHECK(BenchPercentileUs(latencies, 50, 1.0) == 0.0);
+
+    latencies.push_back(7);
+    HOSTTEST_CHECK(BenchPercentileUs(latencies, 0, 1.0) == 7.0);
+    HOSTTEST_CHECK(BenchPercentileUs(latencies, 100, 1.0) == 7.0);
+
+    latencies.clear();
+    for (LONGLONG i = 1; i <= 100; ++i) {
+        latencies.push_back(i * 10);
+    }
+
+    HOSTTEST_CHECK(BenchPercentileUs(latencies, 0, 10.0) == 1.0);
+    HOSTTEST_CHECK(BenchPercentileUs(latencies, 50, 10.0) == 50.0);
+    HOSTTEST_CHECK(BenchPercentileUs(latencies, 90, 10.0) == 90.0);
+    HOSTTEST_CHECK(BenchPercentileUs(latencies, 99, 10.0) == 99.0);
+    HOSTTEST_CHECK(BenchPercentileUs(latencies, 100, 10.0) == 100.0);
+}
+
+//
+// The n-th call takes n us, so one thread of 100 calls sees 1..100us
+//
+void testLatencyDistribution ()
+{
+    BENCH_SUMMARY summary;
+
+    mockReset();
+    MockService.ChargeCallIndex = true;
+    runMockBench(1, 100, false, &summary);
+
+    HOSTTEST_CHECK_EQ(MockService.Calls, 100);
+    HOSTTEST_CHECK_EQ(summary.Completed, 100);
+    HOSTTEST_CHECK_EQ(summary.Errors, 0);
+    HOSTTEST_CHECK_EQ(summary.LastError, NO_ERROR);
+    HOSTTEST_CHECK(summary.MinUs == 1.0);
+    HOSTTEST_CHECK(summary.P50Us == 50.0);
+    HOSTTEST_CHECK(summary.P90Us == 90.0);
+    HOSTTEST_CHECK(summary.P99Us == 99.0);
+    HOSTTEST_CHECK(summary.MaxUs == 100.0);
+
+    //
+    // 5050us in total
+    //
+    HOSTTEST_CHECK(summary.Seconds == 0.00505);
+    HOSTTEST_CHECK_EQ((LONGLONG)(summary.OpsPerSecond + 0.5), 19802);
+}
+
+//
+// Every 10th call fails: it is counted as an error and its latency is
+// left out of the distribution.
+//
+void testFailedCalls ()
+{
+    BENCH_SUMMARY summary;
+
+    mockReset();
+    MockService.ChargeCallIndex = true;
+    MockService.FailEvery = 10;
+    runMockBench(1, 100, false, &summary);
+
+    HOSTTEST_CHECK_EQ(MockService.Calls, 100);
+    HOSTTEST_CHECK_EQ(summary.Completed, 90);
+    HOSTTEST_CHECK_EQ(summary.Errors, 10);
+    HOSTTEST_CHECK_EQ(summary.LastError, MOCK_ERROR_BUSY);
+
+    //
+    // 1..99 without the multiples of 10
+    //
+    HOSTTEST_CHECK(summary.MinUs == 1.0);
+    HOSTTEST_CHECK(summary.P50Us == 49.0);
+    HOSTTEST_CHECK(summary.P90Us == 89.0);
+    HOSTTEST_CHECK(summary.P99Us == 98.0);
+    HOSTTEST_CHECK(summary.MaxUs == 99.0);
+
+    //
+    // A run where every call fails reports no latencies
+    //
+    mockReset();
+    MockService.FailEvery = 1;
+    runMockBench(2, 10, false, &summary);
+
+    HOSTTEST_CHECK_EQ(summary.Completed, 0);
+    HOSTTEST_CHECK_EQ(summary.Errors, 20);
+    HOSTTEST_CHECK(summary.MaxUs == 0.0);
+    HOSTTEST_CHECK(summary.OpsPerSecond == 0.0);
+}
+
+//
+// Threads open their own session, overlap their calls and all of their
+// calls are counted.
+//
+void testConcurrentSessions ()
+{
+    const ULONG concurrency = 4;
+    const ULONG iterations = 50;
+    BENCH_SUMMARY summary;
+
+    mockReset();
+    UseRealClock = true;
+    MockService.SleepUs = 200;
+    runMockBench(concurrency, iterations, false, &summary);
+
+    HOSTTEST_CHECK_EQ(MockService.Calls, concurrency * iterations);
+    HOSTTEST_CHECK_EQ(summary.Completed, concurrency * iterations);
+    HOSTTEST_CHECK_EQ(summary.Errors, 0);
+    HOSTTEST_CHECK_EQ(MockService.PeakOpenSessions, concurrency);
+    HOSTTEST_CHECK_EQ(MockService.OpenSessions, 0);
+    HOSTTEST_CHECK(MockService.PeakInFlight > 1);
+    HOSTTEST_CHECK_EQ(MockService.ForeignCalls, 0);
+    HOSTTEST_CHECK(summary.MinUs >= 200.0);
+    HOSTTEST_CHECK(summary.MinUs <= summary.P50Us);
+    HOSTTEST_CHECK(summary.P50Us <= summary.P90Us);
+    HOSTTEST_CHECK(summary.P90Us <= summary.P99Us);
+    HOSTTEST_CHECK(summary.P99Us <= summary.MaxUs);
+    HOSTTEST_CHECK(summary.OpsPerSecond > 0.0);
+}
+
+//
+// Deferred calls are made from another thread than the one that opened the
+// session, and are timed including the thread creation.
+//
+void testDeferred ()
+{
+    BENCH_SUMMARY summary;
+
+    mockReset();
+    MockService.ChargeCallIndex = true;
+    runMockBench(1, 20, true, &summary);
+
+    HOSTTEST_CHECK_EQ(MockService.Calls, 20);
+    HOSTTEST_CHECK_EQ(MockService.ForeignCalls, 20);
+    HOSTTEST_CHECK_EQ(summary.Completed, 20);
+    HOSTTEST_CHECK(summary.MinUs == 1.0);
+    HOSTTEST_CHECK(summary.MaxUs == 20.0);
+
+    mockReset();
+    MockService.FailEvery = 4;
+    runMockBench(3, 20, true, &summary);
+
+    HOSTTEST_CHECK_EQ(MockService.Calls, 60);
+    HOSTTEST_CHECK_EQ(MockService.ForeignCalls, 60);
+    HOSTTEST_CHECK_EQ(summary.Completed, 45);
+    HOSTTEST_CHECK_EQ(summary.Errors, 15);
+    HOSTTEST_CHECK_EQ(MockService.OpenSessions, 0);
+}
+
+void testJsonReport ()
+{
+    BENCH_SUMMARY summary;
+    wchar_t report[512];
+
+    mockReset();
+    MockService.ChargeCallIndex = true;
+    MockService.FailEvery = 10;
+    runMockBench(1, 100, false, &summary);
+
+    int length = BenchFormatJson(
+        report,
+        ARRAYSIZE(report),
+        L"ta",
+        100,
+        1,
+        false,
+        &summary);
+
+    const wchar_t* expectedWsz =
+        L"{\"workload\":\"ta\",\"iterations\":100,\"concurrency\":1,"
+        L"\"deferred\":false,\"completed\":90,\"errors\":10,\"last_error\":170,"
+        L"\"seconds\":0.005050,\"ops_per_sec\":17821.8,"
+        L"\"latency_us\":{\"min\":1.0,\"p50\":49.0,\"p90\":89.0,"
+        L"\"p99\":98.0,\"max\":99.0}}";
+
+    HOSTTEST_CHECK_EQ(length, wcslen(expectedWsz));
+    HOSTTEST_CHECK(wcscmp(report, expectedWsz) == 0);
+    if (wcscmp(report, expectedWsz) != 0) {
+        fprintf(stderr, "  got %ls\n", report);
+    }
+
+    length = BenchFormatJson(report, ARRAYSIZE(report), L"pta", 1, 64, true, &summary);
+    HOSTTEST_CHECK(length > 0);
+    HOSTTEST_CHECK(wcsstr(report, L"\"workload\":\"pta\",") != nullptr);
+    HOSTTEST_CHECK(wcsstr(report, L"\"concurrency\":64,\"deferred\":true,") != nullptr);
+
+    //
+    // Too small a buffer is reported, not overrun
+    //
+    report[16] = L'#';
+    length = BenchFormatJson(report, 16, L"ta", 100, 1, false, &summary);
+    HOSTTEST_CHECK(length < 0);
+    HOSTTEST_CHECK(report[16] == L'#');
+}
+
+void benchmark ()
+{
+    static const ULONG concurrencies[] = { 1, 2, 4 };
+
+    printf("\nOpteeTest client side cost against a mock TrEE service, no service time\n");
+
+    for (int deferred = 0; deferred < 2; ++deferred) {
+        for (ULONG concurrency : concurrencies) {
+            const ULONG iterations = deferred ? 2000 : 100000;
+            BENCH_SUMMARY summary;
+            wchar_t report[512];
+
+            mockReset();
+            UseRealClock = true;
+            runMockBench(concurrency, iterations, deferred != 0, &summary);
+
+            BenchFormatJson(
+                report,
+                ARRAYSIZE(report),
+                L"mock",
+                iterations,
+                concurrency,
+                deferred != 0,
+                &summary);
+
+            printf("%ls\n", report);
+        }
+    }
+}
+
+} // namespace "static"
+
+int main (int argc, char* argv[])
+{
+    HOSTTEST_RUN(testPercentiles);
+    HOSTTEST_RUN(testLatencyDistribution);
+    HOSTTEST_RUN(testFailedCalls);
+    HOSTTEST_RUN(testConcurrentSessions);
+    HOSTTEST_RUN(testDeferred);
+    HOSTTEST_RUN(testJsonReport);
+
+    if ((argc > 1) && (strcmp(argv[1], "bench") == 0)) {
+        benchmark();
+    }
+
+    return HostTestExit();
+}
@@ -72,9 +72,26 @@ typedef struct _TREE_FTPM_SERVICE_CONTEXT {
 
 WDF_DECLARE_CONTEXT_TYPE(TREE_FTPM_SERVICE_CONTEXT);
 
+//
+// Each session owns a shared memory arena sized for the largest TPM command
+// and response, allocated once when the session is opened. The operation
+// template holds the parameter types and the physical addresses of the
+// arena, so submitting a command only has to copy the command in, fill in
+// the sizes and copy the response out. A command that does not fit, or that
+// races another command on the same session, falls back to a temporary
+// allocation.
+//
+
 typedef struct _TREE_FTPM_SESSION_CONTEXT {
     PTREE_FTPM_SERVICE_CONTEXT  ServiceContext;
     TEEC_Session                ClientSession;
+    TEEC_SharedMemory           SharedMem;
+    PUCHAR                      SharedInput;
+    PUCHAR                      SharedOutput;
+    ULONG                       SharedInputSize;
+    ULONG                       SharedOutputSize;
+    TEEC_Operation              OperationTemplate;
+    volatile LONG               SharedMemBusy;
 } TREE_FTPM_SESSION_CONTEXT, *PTREE_FTPM_SESSION_CONTEXT;
 
 WDF_DECLARE_CONTEXT_TYPE(TREE_FTPM_SESSION_CONTEXT);
@@ -401,6 +418,74 @@ FtpmServiceDisconnectSecureService(
     return STATUS_SUCCESS;
 }
 
+VOID
+FtpmAllocateSessionSharedMemory(
+    _Inout_ PTREE_FTPM_SESSION_CONTEXT SessionContext
+    )
+
+/*++
+
+Routine Description:
+
+    This routine allocates the session shared memory arena and builds the
+    operation template used to submit commands through it. Failure is not
+    fatal, commands then use a temporary allocation each.
+
+Arguments:
+
+    SessionContext - Supplies the session context.
+
+Return Value:
+
+    None.
+
+--*/
+
+{
+    PFTPM_CONTROL_AREA ControlArea;
+    TEEC_Operation *Operation;
+    TEEC_Result TeecResult;
+
+    ControlArea = SessionContext->ServiceContext->ControlArea;
+    if ((ControlArea->CommandBufferSize == 0) ||
+        (ControlArea->ResponseBufferSize == 0)) {
+
+        return;
+    }
+
+    SessionContext->SharedMem.size = ControlArea->CommandBufferSize +
+                                     ControlArea->ResponseBufferSize;
+
+    TeecResult = TEEC_AllocateSharedMemory(
+                    &SessionContext->ServiceContext->TEECContext,
+                    &SessionContext->SharedMem);
+
+    if (TeecResult != TEEC_SUCCESS) {
+        TraceWarning("Session shared memory allocation failed, %Id bytes",
+                     SessionContext->SharedMem.size);
+
+        RtlZeroMemory(&SessionContext->SharedMem, sizeof(SessionContext->SharedMem));
+        return;
+    }
+
+    SessionContext->SharedInputSize = ControlArea->CommandBufferSize;
+    SessionContext->SharedOutputSize = ControlArea->ResponseBufferSize;
+    SessionContext->SharedInput = (PUCHAR)SessionContext->SharedMem.buffer;
+    SessionContext->SharedOutput = SessionContext->SharedInput +
+                                   SessionContext->SharedInputSize;
+
+    Operation = &SessionContext->OperationTemplate;
+    RtlZeroMemory(Operation, sizeof(*Operation));
+    Operation->params[0].tmpref.buffer =
+        (PVOID)(ULONG_PTR)OpteeClientVirtualToPhysical(SessionContext->SharedInput);
+    Operation->params[1].tmpref.buffer =
+        (PVOID)(ULONG_PTR)OpteeClientVirtualToPhysical(SessionContext->SharedOutput);
+    Operation->paramTypes = TEEC_PARAM_TYPES(TEEC_MEMREF_TEMP_INPUT,
+                                             TEEC_MEMREF_TEMP_INOUT,
+                                             TEEC_NONE,
+                                             TEEC_NONE);
+}
+
 _Use_decl_annotations_
 NTSTATUS
 FtpmServiceCreateSessionContext(
@@ -449,6 +534,10 @@ FtpmServiceCreateSessionContext(
 
     SessionContext = WdfObjectGet_TREE_FTPM_SESSION_CONTEXT(NewContext);
     SessionContext->ServiceContext = ServiceContext;    
+    RtlZeroMemory(&SessionContext->SharedMem, sizeof(SessionContext->SharedMem));
+    SessionContext->SharedInput = NULL;
+    SessionContext->SharedOutput = NULL;
+    SessionContext->SharedMemBusy = 0;
 
     TeecResult = TEEC_OpenSession(&ServiceContext->TEECContext,
         &SessionContext->ClientSession,
@@ -462,6 +551,8 @@ FtpmServiceCreateSessionContext(
         goto Exit;
     }
 
+    FtpmAllocateSessionSharedMemory(SessionContext);
+
     *SessionContextObject = NewContext;
     Status = STATUS_SUCCESS;   
     
@@ -508,6 +599,11 @@ FtpmServiceDestroySessionContext(
     if (*SessionContextObject != NULL) {
         SessionContext = WdfObjectGet_TREE_FTPM_SESSION_CONTEXT(*SessionContextObject);
         TEEC_CloseSession(&SessionContext->ClientSession);
+        if (SessionContext->SharedInput != NULL) {
+            TEEC_ReleaseSharedMemory(&SessionContext->SharedMem);
+            SessionContext->SharedInput = NULL;
+            SessionContext->SharedOutput = NULL;
+        }
         WdfObjectDelete(*SessionContextObject);
     }    
     return STATUS_SUCCESS;
@@ -527,6 +623,7 @@ FtpmOpteeSubmitCommand(
 
     ULONG ErrorOrigin;
     BOOLEAN FreeMemory;
+    BOOLEAN ReleaseArena;
     UCHAR *SharedInput;
     UCHAR *SharedOutput;
     NTSTATUS Status;
@@ -535,8 +632,30 @@ FtpmOpteeSubmitCommand(
     TEEC_SharedMemory TeecSharedMem;
 
     FreeMemory = FALSE;
+    ReleaseArena = FALSE;
     Status = STATUS_SUCCESS;
 
+    //
+    // Use the session arena when the command fits and no other command owns
+    // it.
+    //
+
+    if ((Context->SharedInput != NULL) &&
+        (InputBufferSize <= Context->SharedInputSize) &&
+        (OutputBufferSize <= Context->SharedOutputSize) &&
+        (InterlockedCompareExchange(&Context->SharedMemBusy, 1, 0) == 0)) {
+
+        ReleaseArena = TRUE;
+        SharedInput = Context->SharedInput;
+        SharedOutput = Context->SharedOutput;
+        RtlCopyMemory(SharedInput, InputBuffer, InputBufferSize);
+
+        TeecOperation = Context->OperationTemplate;
+        TeecOperation.params[0].tmpref.size = InputBufferSize;
+        TeecOperation.params[1].tmpref.size = OutputBufferSize;
+        goto FtpmSubmitCommandInvoke;
+    }
+
     //
     // Create shared memory copies of the buffers.
     //
@@ -567,6 +686,7 @@ FtpmOpteeSubmitCommand(
                                                 TEEC_NONE,
                                                 TEEC_NONE);
 
+FtpmSubmitCommandInvoke:
     TeecResult = TEEC_InvokeCommand(&Context->ClientSession,
                                     Command,
                                     &TeecOperation,
@@ -590,6 +710,10 @@ FtpmSubmitCommandEnd:
         TEEC_ReleaseSharedMemory(&TeecSharedMem);
     }
 
+    if (ReleaseArena != FALSE) {
+        InterlockedExchange(&Context->SharedMemBusy, 0);
+    }
+
     return Status;
 }
 
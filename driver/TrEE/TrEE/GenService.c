@@ -39,6 +39,15 @@ Environment:
 #define GENSVC_SESSION_CONTEXT_TAG 'sTPO'
 #define GENSVC_REQUEST_CONTEXT_TAG 'rTPO'
 
+//
+// Size of the shared memory arena each session keeps for its requests.
+// Requests whose input and output data do not fit, or that are submitted
+// while another request of the session owns the arena, use a temporary
+// allocation.
+//
+
+#define GENSVC_SESSION_SHARED_MEM_SIZE (2 * PAGE_SIZE)
+
 //
 // TrEE Generic Service private types
 //
@@ -65,6 +74,10 @@ typedef struct _TREE_GEN_SESSION_CONTEXT {
 
     FAST_MUTEX PendingRequestsLock;
     WDFCOLLECTION PendingRequests;
+
+    TEEC_SharedMemory SharedMem;
+    ULONGLONG SharedMemPhysical;
+    volatile LONG SharedMemBusy;
 } TREE_GEN_SESSION_CONTEXT, *PTREE_GEN_SESSION_CONTEXT;
 
 WDF_DECLARE_CONTEXT_TYPE_WITH_NAME(TREE_GEN_SESSION_CONTEXT, TreeGenGetSessionContext);
@@ -479,6 +492,10 @@ Return Value:
     ExInitializeFastMutex(&SessionContext->PendingRequestsLock);
     RtlZeroMemory(&SessionContext->ClientSession,
         sizeof(SessionContext->ClientSession));
+    RtlZeroMemory(&SessionContext->SharedMem,
+        sizeof(SessionContext->SharedMem));
+    SessionContext->SharedMemPhysical = 0;
+    SessionContext->SharedMemBusy = 0;
 
     WDF_OBJECT_ATTRIBUTES_INIT(&Attributes);
     Attributes.ParentObject = SessionHandle;
@@ -501,6 +518,25 @@ Return Value:
         goto Exit;
     }
 
+    //
+    // The arena is an optimization, requests still go through if it cannot
+    // be allocated.
+    //
+
+    SessionContext->SharedMem.size = GENSVC_SESSION_SHARED_MEM_SIZE;
+    TeecResult = TEEC_AllocateSharedMemory(&ServiceContext->TEECContext,
+        &SessionContext->SharedMem);
+    if (TeecResult == TEEC_SUCCESS) {
+        SessionContext->SharedMemPhysical =
+            OpteeClientVirtualToPhysical(SessionContext->SharedMem.buffer);
+    } else {
+        TraceWarning("Session shared memory allocation failed, %Id bytes",
+            SessionContext->SharedMem.size);
+
+        RtlZeroMemory(&SessionContext->SharedMem,
+            sizeof(SessionContext->SharedMem));
+    }
+
     Status = GenServiceAddSession(SessionHandle);
     if (!NT_SUCCESS(Status)) {
         TraceError("Failed to add session to service sessions list, %!STATUS!", Status);
@@ -556,6 +592,11 @@ Return Value:
     if (SessionContext->ClientSession.session_id != 0) {
         TEEC_CloseSession(&SessionContext->ClientSession);
     }
+
+    if (SessionContext->SharedMem.buffer != NULL) {
+        NT_ASSERT(SessionContext->SharedMemBusy == 0);
+        TEEC_ReleaseSharedMemory(&SessionContext->SharedMem);
+    }
 }
 
 _Use_decl_annotations_
@@ -881,6 +922,8 @@ Return Value:
     ULONG_PTR BytesWritten;
     ULONG ErrorOrigin;
     BOOLEAN FreeMemory;
+    BOOLEAN ReleaseArena;
+    ULONGLONG SharedPhysical;
     size_t InputDataSize;
     ULONG OutputParamIndex;
     ULONG ParamCount;
@@ -904,6 +947,8 @@ Return Value:
     SharedOutput = NULL;
     ParamCount = 0;
     FreeMemory = FALSE;
+    ReleaseArena = FALSE;
+    SharedPhysical = 0;
     BytesWritten = 0;
     Status = STATUS_SUCCESS;
 
@@ -937,25 +982,38 @@ Return Value:
     ++ParamCount;
 
     //
-    // Create shared memory copies of the buffers, if needed
+    // Create shared memory copies of the buffers, if needed. The session
+    // arena is used when the data fits and no other request owns it, the
+    // physical address of the arena is known so no translation is needed.
     //
 
     TeecSharedMem.size = InputDataSize + OutputDataSize;
 
     if (TeecSharedMem.size != 0) {
-        TeecResult = TEEC_AllocateSharedMemory(
-            &SessionContext->ServiceContext->TEECContext,
-            &TeecSharedMem);
+        if ((SessionContext->SharedMem.buffer != NULL) &&
+            (TeecSharedMem.size <= SessionContext->SharedMem.size) &&
+            (InterlockedCompareExchange(&SessionContext->SharedMemBusy, 1, 0) == 0)) {
 
-        if (TeecResult != TEEC_SUCCESS) {
-            TraceError("TEEC_AllocateSharedMemory failed, for %Id bytes", 
-                TeecSharedMem.size);
+            ReleaseArena = TRUE;
+            SharedInput = (UINT8 *)SessionContext->SharedMem.buffer;
+            SharedPhysical = SessionContext->SharedMemPhysical;
 
-            Status = STATUS_NO_MEMORY;
-            goto Exit;
+        } else {
+            TeecResult = TEEC_AllocateSharedMemory(
+                &SessionContext->ServiceContext->TEECContext,
+                &TeecSharedMem);
+
+            if (TeecResult != TEEC_SUCCESS) {
+                TraceError("TEEC_AllocateSharedMemory failed, for %Id bytes", 
+                    TeecSharedMem.size);
+
+                Status = STATUS_NO_MEMORY;
+                goto Exit;
+            }
+            FreeMemory = TRUE;
+            SharedInput = (UINT8 *)TeecSharedMem.buffer;
+            SharedPhysical = OpteeClientVirtualToPhysical(SharedInput);
         }
-        FreeMemory = TRUE;
-        SharedInput = (UINT8 *)TeecSharedMem.buffer;
 
         if (InputDataSize != 0) {
             NT_ASSERT(RequestContext->InputBuffer != NULL);
@@ -964,7 +1022,7 @@ Return Value:
 
             ParamsType[ParamCount] = TEEC_MEMREF_TEMP_INPUT;
             TeecOperation.params[ParamCount].tmpref.buffer = 
-                (PVOID)(ULONG_PTR)OpteeClientVirtualToPhysical(SharedInput);
+                (PVOID)(ULONG_PTR)SharedPhysical;
 
             TeecOperation.params[ParamCount].tmpref.size = InputDataSize;
             ++ParamCount;
@@ -978,7 +1036,7 @@ Return Value:
 
             ParamsType[ParamCount] = TEEC_MEMREF_TEMP_INOUT;
             TeecOperation.params[ParamCount].tmpref.buffer = 
-                (PVOID)(ULONG_PTR)OpteeClientVirtualToPhysical(SharedOutput);
+                (PVOID)(ULONG_PTR)(SharedPhysical + InputDataSize);
 
             TeecOperation.params[ParamCount].tmpref.size = OutputDataSize;
             ++ParamCount;
@@ -1084,6 +1142,15 @@ Return Value:
 
 Exit:
 
+    //
+    // Give the arena back before completing the request, completing the last
+    // request of a closed session deletes the session.
+    //
+
+    if (ReleaseArena != FALSE) {
+        InterlockedExchange(&SessionContext->SharedMemBusy, 0);
+    }
+
     GenServiceCompleteRequestAsync(RequestContext, Status, BytesWritten, RequestCompleteFinal);
 
     if (FreeMemory != FALSE) {
@@ -103,6 +103,8 @@ NTSTATUS OpteeClientApiLibInitialize(
 
         LibServiceDevice = ServiceDevice;
 
+        OpteeClientSmcInit();
+
         // Initializing the SMC lock.
         //
 
@@ -1,5 +1,6 @@
 #pragma once 
 #include <wdf.h>
+#include "OpteeClientSlab.h"
 
 struct _OPTEE_CLIENT_MM_HEADER
 {
@@ -8,7 +9,15 @@ struct _OPTEE_CLIENT_MM_HEADER
     PVOID BaseVA;
     PVOID BitMapAddress;
     RTL_BITMAP BitMapHeader;
+    ULONG CpuCount;
+    POPTEE_SLAB_CPU_CACHE CpuCaches;
+    OPTEE_SHM_STATS Stats;
 };
 
 typedef struct _OPTEE_CLIENT_MM_HEADER 
     OPTEE_MM_HEADER, *POPTEE_MM_HEADER;
+
+VOID
+OpteeClientMemQueryStats(
+    _Out_ OPTEE_SHM_STATS *Stats
+    );
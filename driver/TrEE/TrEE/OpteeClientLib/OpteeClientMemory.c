@@ -40,6 +40,11 @@ client in normal world and the OP-TEE OS in secure world.
 #include "OpteeTrEE.h"
 #include "OpteeClientMM.h"
 #include "types.h"
+#include "trace.h"
+
+#ifdef WPP_TRACING
+#include "OpteeClientMemory.tmh"
+#endif
 
 
 //
@@ -57,6 +62,11 @@ client in normal world and the OP-TEE OS in secure world.
 #define OPTEE_SHM_RESERVED_SIZE 0x1000
 #define MEMORY_GANULARITY PAGE_SIZE
 
+//
+// BitMapIndex of a slab object: the flag and its size class.
+//
+#define OPTEE_SLAB_INDEX_FLAG   0x80000000
+
 /*
 * Driver image handle to use for memory allocation.
 */
@@ -93,6 +103,8 @@ NTSTATUS OpteeClientMemInit(
 
 {
     ULONG BitMapSizeBits;
+    ULONG Cpu;
+    ULONG Class;
     NTSTATUS Status = STATUS_SUCCESS;
 
     UNREFERENCED_PARAMETER(ImageHandle);
@@ -141,6 +153,31 @@ NTSTATUS OpteeClientMemInit(
     //
     RtlClearAllBits(&g_OpteeMemoryHeader.BitMapHeader);
 
+    //
+    // Slab free lists are touched by frees at any IRQL, keep them in
+    // nonpaged pool.
+    //
+    g_OpteeMemoryHeader.CpuCount =
+        KeQueryMaximumProcessorCountEx(ALL_PROCESSOR_GROUPS);
+
+    g_OpteeMemoryHeader.CpuCaches = ExAllocatePoolWithTag(NonPagedPoolNx,
+        g_OpteeMemoryHeader.CpuCount * sizeof(OPTEE_SLAB_CPU_CACHE),
+        OPTEE_TREE_POOL_TAG);
+
+    if (g_OpteeMemoryHeader.CpuCaches == NULL) {
+        Status = STATUS_INSUFFICIENT_RESOURCES;
+        goto Exit;
+    }
+
+    for (Cpu = 0; Cpu < g_OpteeMemoryHeader.CpuCount; Cpu++) {
+        for (Class = 0; Class < OPTEE_SLAB_CLASS_COUNT; Class++) {
+            InitializeSListHead(&g_OpteeMemoryHeader.CpuCaches[Cpu].FreeList[Class]);
+        }
+    }
+
+    RtlZeroMemory(&g_OpteeMemoryHeader.Stats,
+                  sizeof(g_OpteeMemoryHeader.Stats));
+
 Exit:
     return Status;
 }
@@ -154,6 +191,24 @@ OpteeClientMemDeinit()
  */
 
 {
+    OPTEE_SHM_STATS* Stats = &g_OpteeMemoryHeader.Stats;
+    ULONG Class;
+
+    for (Class = 0; Class < OPTEE_SLAB_CLASS_COUNT; Class++) {
+        TraceInformation("Shared memory slab %d bytes: allocs=%d, frees=%d, pages=%d\n",
+                         OpteeSlabObjectSize(Class),
+                         Stats->SlabAllocs[Class],
+                         Stats->SlabFrees[Class],
+                         Stats->SlabPages[Class]);
+    }
+
+    TraceInformation("Shared memory pages: allocs=%d, frees=%d, peak=%d, cross CPU allocs=%d, failures=%d\n",
+                     Stats->PageAllocs,
+                     Stats->PageFrees,
+                     Stats->PeakPagesInUse,
+                     Stats->CrossCpuAllocs,
+                     Stats->AllocFailures);
+
     if (g_OpteeMemoryHeader.BaseVA != NULL) {
         MmUnmapIoSpace(g_OpteeMemoryHeader.BaseVA,
                        g_OpteeMemoryHeader.Length);
@@ -169,6 +224,77 @@ OpteeClientMemDeinit()
     }
 
     g_OpteeMemoryHeader.BitMapAddress = NULL;
+
+    if (g_OpteeMemoryHeader.CpuCaches != NULL) {
+        ExFreePoolWithTag(g_OpteeMemoryHeader.CpuCaches,
+                          OPTEE_TREE_POOL_TAG);
+    }
+
+    g_OpteeMemoryHeader.CpuCaches = NULL;
+    g_OpteeMemoryHeader.CpuCount = 0;
+}
+
+
+static
+PVOID
+OpteeClientMemAllocPages(
+    _In_ ULONG NumPages,
+    _Out_ ULONG *PageIndex
+    )
+
+/*
+ * Allocate a run of pages from the shared memory bitmap.
+ */
+
+{
+    NTSTATUS Status;
+    ULONG ClearIndex;
+
+    Status = KeWaitForSingleObject(&OpteeMemLock,
+                                   Executive,
+                                   KernelMode,
+                                   FALSE,
+                                   NULL);
+    ASSERT(Status == STATUS_SUCCESS);
+
+    //
+    // Find the run that contain the set of clear bits and set the bit(s).
+    //
+    ClearIndex = RtlFindClearBitsAndSet(&g_OpteeMemoryHeader.BitMapHeader,
+                                        NumPages,
+                                        0);
+
+    KeReleaseSemaphore(&OpteeMemLock,
+                       LOW_PRIORITY,
+                       1,
+                       FALSE);
+
+    if (ClearIndex == 0xFFFFFFFF) {
+        InterlockedIncrement(&g_OpteeMemoryHeader.Stats.AllocFailures);
+        return NULL;
+    }
+
+    OpteeShmStatsAddPages(&g_OpteeMemoryHeader.Stats, (LONG)NumPages);
+
+    *PageIndex = ClearIndex;
+    return (PVOID)((UINTN)g_OpteeMemoryHeader.BaseVA + ClearIndex * MEMORY_GANULARITY);
+}
+
+
+static
+PVOID
+OpteeClientMemAllocSlabPage(
+    VOID
+    )
+
+/*
+ * Allocate a page for a new slab.
+ */
+
+{
+    ULONG PageIndex;
+
+    return OpteeClientMemAllocPages(1, &PageIndex);
 }
 
 
@@ -180,15 +306,20 @@ OpteeClientMemAlloc(
     )
 
 /*
- * Allocate a page aligned block of memory from the TrustZone
- * shared memory block.
+ * Allocate a block of memory from the TrustZone shared memory block.
+ * Blocks up to half a page come from size class slabs, larger ones are
+ * page aligned runs of pages. Either way the returned block follows a
+ * 16 byte header.
  */
 
 {
-    NTSTATUS Status;
     UINT32 ActualLength;
     ULONG NumPages;
-    ULONG ClearIndex;
+    ULONG PageIndex;
+    ULONG Class;
+    PVOID Block;
+    OPTEE_CLIENT_MEM_HEADER* Header;
+    ULONG Cpu;
 
     *AllocatedMemory = NULL;
     if (PhysicalMemory != NULL) {
@@ -202,60 +333,57 @@ OpteeClientMemAlloc(
         return STATUS_MEMORY_NOT_ALLOCATED;
     }
 
-    Status = KeWaitForSingleObject(&OpteeMemLock,
-                                   Executive,
-                                   KernelMode,
-                                   FALSE,
-                                   NULL);
-    ASSERT(Status == STATUS_SUCCESS);
-
-    ActualLength = Length + sizeof(OPTEE_CLIENT_MEM_HEADER);
-    NumPages = (ActualLength / PAGE_SIZE) + 1;
-
-    if ((ActualLength % PAGE_SIZE) != 0) {
-        ActualLength = NumPages * PAGE_SIZE;
+    if (Length > (MAXUINT32 - PAGE_SIZE)) {
+        return STATUS_INVALID_PARAMETER;
     }
 
-    //
-    // Find the run that contain the set of clear bits and set the bit(s).
-    //
-    ClearIndex = RtlFindClearBitsAndSet(&g_OpteeMemoryHeader.BitMapHeader,
-                                        NumPages,
-                                        0);
+    ActualLength = Length + sizeof(OPTEE_CLIENT_MEM_HEADER);
 
-    if (ClearIndex == 0xFFFFFFFF) {
-        Status = STATUS_INSUFFICIENT_RESOURCES;
-        goto Exit;
+    if (ActualLength <= (1 << OPTEE_SLAB_MAX_SHIFT)) {
+        Class = OpteeSlabSizeClass(ActualLength);
+        Cpu = KeGetCurrentProcessorNumberEx(NULL);
+
+        Block = OpteeSlabAlloc(g_OpteeMemoryHeader.CpuCaches,
+                               g_OpteeMemoryHeader.CpuCount,
+                               Cpu,
+                               Class,
+                               &g_OpteeMemoryHeader.Stats,
+                               OpteeClientMemAllocSlabPage);
+        if (Block == NULL) {
+            return STATUS_INSUFFICIENT_RESOURCES;
+        }
+
+        Header = (OPTEE_CLIENT_MEM_HEADER*)Block;
+        Header->BitMapIndex = OPTEE_SLAB_INDEX_FLAG | Class;
+        Header->Length = OpteeSlabObjectSize(Class);
+
+    } else {
+        NumPages = (ActualLength + PAGE_SIZE - 1) / PAGE_SIZE;
+
+        Block = OpteeClientMemAllocPages(NumPages, &PageIndex);
+        if (Block == NULL) {
+            return STATUS_INSUFFICIENT_RESOURCES;
+        }
+
+        InterlockedIncrement(&g_OpteeMemoryHeader.Stats.PageAllocs);
+
+        Header = (OPTEE_CLIENT_MEM_HEADER*)Block;
+        Header->BitMapIndex = PageIndex;
+        Header->Length = NumPages * PAGE_SIZE;
     }
 
-    *AllocatedMemory = (PVOID)((UINTN)g_OpteeMemoryHeader.BaseVA + ClearIndex * MEMORY_GANULARITY);
+    Header->Reserved64 = 0;
 
     //
-    // Fill in the length into the header and account for the header at the start
-    // of the memory block.
+    // Account for the header at the start of the memory block.
     //
-    OPTEE_CLIENT_MEM_HEADER* Header = (OPTEE_CLIENT_MEM_HEADER*)(UINTN)(*AllocatedMemory);
-
-    Header->BitMapIndex = ClearIndex;
-    Header->Length = ActualLength;
-    Header->Reserved64 = 0;
-
-    *AllocatedMemory = (PVOID)((UINTN)(*AllocatedMemory) + sizeof(OPTEE_CLIENT_MEM_HEADER));
+    *AllocatedMemory = (PVOID)((UINTN)Block + sizeof(OPTEE_CLIENT_MEM_HEADER));
 
     if (PhysicalMemory != NULL) {
         PhysicalMemory->QuadPart = OpteeClientVirtualToPhysical(*AllocatedMemory);
     }
 
-    Status = STATUS_SUCCESS;
-
-Exit:
-
-    KeReleaseSemaphore(&OpteeMemLock,
-                       LOW_PRIORITY,
-                       1,
-                       FALSE);
-
-    return Status;
+    return STATUS_SUCCESS;
 }
 
 
@@ -272,22 +400,69 @@ OpteeClientMemFree(
 {
     OPTEE_CLIENT_MEM_HEADER* Header;
     ULONG NumPages;
+    ULONG Class;
+    ULONG Cpu;
+    NTSTATUS Status;
 
     Header = (OPTEE_CLIENT_MEM_HEADER*)(
         ((UINTN)(Mem)) - sizeof(OPTEE_CLIENT_MEM_HEADER));
 
+    if ((Header->BitMapIndex & OPTEE_SLAB_INDEX_FLAG) != 0) {
+        Class = Header->BitMapIndex & ~OPTEE_SLAB_INDEX_FLAG;
+
+        Cpu = KeGetCurrentProcessorNumberEx(NULL);
+        OpteeSlabFree(g_OpteeMemoryHeader.CpuCaches,
+                      g_OpteeMemoryHeader.CpuCount,
+                      Cpu,
+                      Class,
+                      &g_OpteeMemoryHeader.Stats,
+                      Header);
+
+        return;
+    }
+
     ASSERT(((UINTN)Header) % PAGE_SIZE == 0);
 
     NumPages = Header->Length  / PAGE_SIZE;
 
+    Status = KeWaitForSingleObject(&OpteeMemLock,
+                                   Executive,
+                                   KernelMode,
+                                   FALSE,
+                                   NULL);
+    ASSERT(Status == STATUS_SUCCESS);
+
     ASSERT(RtlAreBitsSet(&g_OpteeMemoryHeader.BitMapHeader, Header->BitMapIndex, NumPages) == TRUE);
 
     RtlClearBits(&g_OpteeMemoryHeader.BitMapHeader, Header->BitMapIndex, NumPages);
 
+    KeReleaseSemaphore(&OpteeMemLock,
+                       LOW_PRIORITY,
+                       1,
+                       FALSE);
+
+    InterlockedIncrement(&g_OpteeMemoryHeader.Stats.PageFrees);
+    InterlockedAdd(&g_OpteeMemoryHeader.Stats.PagesInUse, -(LONG)NumPages);
+
     return;
 }
 
 
+VOID
+OpteeClientMemQueryStats(
+    _Out_ OPTEE_SHM_STATS *Stats
+    )
+
+/*
+ * Returns a snapshot of the shared memory allocator counters.
+ */
+
+{
+    RtlCopyMemory(Stats,
+                  (const VOID*)&g_OpteeMemoryHeader.Stats,
+                  sizeof(*Stats));
+}
+
 ULONGLONG
 OpteeClientVirtualToPhysical(
     _In_ PVOID Va
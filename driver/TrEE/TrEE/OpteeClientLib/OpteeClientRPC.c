@@ -100,6 +100,33 @@ GenServiceReceiveRpcCommand(
 static UINT8 RpmbCid[RPMB_EMMC_CID_SIZE];
 static BOOLEAN RpmbCidAquired = FALSE;
 
+//
+// RPMB request pool
+//
+// Partition access requests are built in buffers preallocated at
+// initialization, each large enough for OPTEE_RPMB_POOL_MAX_BLOCKS frames.
+// Larger requests, or requests issued while every pool buffer is in use,
+// fall back to a pool allocation.
+//
+
+#define OPTEE_RPMB_POOL_DEPTH 2
+#define OPTEE_RPMB_POOL_MAX_BLOCKS 32
+#define OPTEE_RPMB_POOL_BUFFER_SIZE \
+    (sizeof(SFFDISK_DEVICE_PARTITION_ACCESS_DATA) + \
+     ((OPTEE_RPMB_POOL_MAX_BLOCKS - 1) * sizeof(SFFDISK_DEVICE_RPMB_DATA_FRAME)))
+
+static WDFMEMORY RpmbRequestPoolMemory = NULL;
+static PUCHAR RpmbRequestPool = NULL;
+static volatile LONG RpmbRequestPoolBusy[OPTEE_RPMB_POOL_DEPTH];
+
+//
+// RPMB device information, queried from the eMMC once.
+//
+
+static BOOLEAN RpmbDeviceInfoValid = FALSE;
+static ULONG RpmbMaxReliableWriteBlocks;
+static ULONG RpmbSizeInBytes;
+
 //
 // Wait object resources
 //
@@ -120,6 +147,9 @@ typedef struct _OPTEE_WAIT_BLOCK
 } OPTEE_WAIT_BLOCK, *POPTEE_WAIT_BLOCK;
 
 
+static SFFDISK_DEVICE_PARTITION_ACCESS_DATA *OpteeRpmbAllocRequest(ULONG Size);
+static VOID OpteeRpmbFreeRequest(SFFDISK_DEVICE_PARTITION_ACCESS_DATA *TreeData);
+
 static TEEC_Result OpteeRpcAlloc(UINTN Size, UINT64 *Address);
 static TEEC_Result OpteeRpcFree(UINT64 Address);
 
@@ -180,9 +210,73 @@ NTSTATUS OpteeClientRpcInit()
 
     ExInitializeFastMutex(&WaitBlockListLock);
 
+    //
+    // The RPMB request pool is an optimization, RPMB requests are still
+    // served without it.
+    //
+
+    WDF_OBJECT_ATTRIBUTES_INIT(&Attributes);
+    Attributes.ParentObject = WdfDriver;
+
+    Status = WdfMemoryCreate(&Attributes,
+                             PagedPool,
+                             OPTEE_RPC_MEMORY_TAG,
+                             OPTEE_RPMB_POOL_DEPTH * OPTEE_RPMB_POOL_BUFFER_SIZE,
+                             &RpmbRequestPoolMemory,
+                             (PVOID*)&RpmbRequestPool);
+
+    if (!NT_SUCCESS(Status)) {
+        TraceWarning("Failed to create RPMB request pool, %!STATUS!", Status);
+        RpmbRequestPoolMemory = NULL;
+        RpmbRequestPool = NULL;
+    }
+
+    RtlZeroMemory((PVOID)RpmbRequestPoolBusy, sizeof(RpmbRequestPoolBusy));
+
     return STATUS_SUCCESS;
 }
 
+/*
+ * Get a buffer for an RPMB partition access request.
+ */
+SFFDISK_DEVICE_PARTITION_ACCESS_DATA *OpteeRpmbAllocRequest(ULONG Size)
+{
+    ULONG Index;
+
+    if ((RpmbRequestPool != NULL) && (Size <= OPTEE_RPMB_POOL_BUFFER_SIZE)) {
+        for (Index = 0; Index < OPTEE_RPMB_POOL_DEPTH; Index++) {
+            if (InterlockedCompareExchange(&RpmbRequestPoolBusy[Index], 1, 0) == 0) {
+                return (SFFDISK_DEVICE_PARTITION_ACCESS_DATA *)
+                    (RpmbRequestPool + (Index * OPTEE_RPMB_POOL_BUFFER_SIZE));
+            }
+        }
+    }
+
+    return ExAllocatePoolWithTag(PagedPool, Size, OPTEE_RPC_MEMORY_TAG);
+}
+
+/*
+ * Release a buffer returned by OpteeRpmbAllocRequest.
+ */
+VOID OpteeRpmbFreeRequest(SFFDISK_DEVICE_PARTITION_ACCESS_DATA *TreeData)
+{
+    ULONG_PTR Offset;
+
+    Offset = (ULONG_PTR)TreeData - (ULONG_PTR)RpmbRequestPool;
+    if ((RpmbRequestPool != NULL) &&
+        ((PUCHAR)TreeData >= RpmbRequestPool) &&
+        (Offset < (OPTEE_RPMB_POOL_DEPTH * OPTEE_RPMB_POOL_BUFFER_SIZE))) {
+
+        NT_ASSERT((Offset % OPTEE_RPMB_POOL_BUFFER_SIZE) == 0);
+        InterlockedExchange(
+            &RpmbRequestPoolBusy[Offset / OPTEE_RPMB_POOL_BUFFER_SIZE], 0);
+
+        return;
+    }
+
+    ExFreePoolWithTag(TreeData, OPTEE_RPC_MEMORY_TAG);
+}
+
 /*
  * Handle the callback from secure world.
  */
@@ -701,9 +795,7 @@ TEEC_Result OpteeRpcCmdRpmb(t_teesmc_arg *TeeSmcArg)
                     InputSize = sizeof(SFFDISK_DEVICE_PARTITION_ACCESS_DATA);
                     OutputSize = sizeof(SFFDISK_DEVICE_PARTITION_ACCESS_DATA);
                     AllocSize = InputSize;
-                    TreeData = ExAllocatePoolWithTag(PagedPool,
-                                                     AllocSize,
-                                                     OPTEE_RPC_MEMORY_TAG);
+                    TreeData = OpteeRpmbAllocRequest(AllocSize);
 
                     if (TreeData == NULL) {
                         TraceError("ERR: Could not allocate requested size %d\n",
@@ -750,9 +842,7 @@ TEEC_Result OpteeRpcCmdRpmb(t_teesmc_arg *TeeSmcArg)
                     InputSize = sizeof(SFFDISK_DEVICE_PARTITION_ACCESS_DATA);
                     OutputSize = sizeof(SFFDISK_DEVICE_PARTITION_ACCESS_DATA);
                     AllocSize = InputSize;
-                    TreeData = ExAllocatePoolWithTag(PagedPool,
-                                                     AllocSize,
-                                                     OPTEE_RPC_MEMORY_TAG);
+                    TreeData = OpteeRpmbAllocRequest(AllocSize);
 
                     if (TreeData == NULL) {
                         TraceError("ERR: Could not allocate requested size %d\n",
@@ -806,6 +896,22 @@ TEEC_Result OpteeRpcCmdRpmb(t_teesmc_arg *TeeSmcArg)
                     BlockCount = RPMB_PACKET_DATA_TO_UINT16(
                                     RequestPackets->BlockCount);
 
+                    // A reliable write takes at most rel_wr_sec_c blocks,
+                    // which OP-TEE got from TEE_RPC_RPMB_CMD_GET_DEV_INFO.
+                    //
+
+                    if ((BlockCount == 0) ||
+                        (RpmbDeviceInfoValid &&
+                         (RpmbMaxReliableWriteBlocks != 0) &&
+                         (BlockCount > RpmbMaxReliableWriteBlocks))) {
+
+                        TraceError("ERR: Invalid RPMB write block count %d\n",
+                                   BlockCount);
+
+                        TeecResult = TEEC_ERROR_BAD_PARAMETERS;
+                        break;
+                    }
+
                     InputSize = sizeof(SFFDISK_DEVICE_RPMB_DATA_FRAME);
                     InputSize *= (BlockCount - 1);
                     InputSize += sizeof(SFFDISK_DEVICE_PARTITION_ACCESS_DATA);
@@ -816,9 +922,7 @@ TEEC_Result OpteeRpcCmdRpmb(t_teesmc_arg *TeeSmcArg)
                     //
 
                     AllocSize = InputSize;
-                    TreeData = ExAllocatePoolWithTag(PagedPool,
-                                                     AllocSize,
-                                                     OPTEE_RPC_MEMORY_TAG);
+                    TreeData = OpteeRpmbAllocRequest(AllocSize);
 
                     if (TreeData == NULL) {
                         TraceError("ERR: Could not allocate requested size %d\n",
@@ -873,6 +977,11 @@ TEEC_Result OpteeRpcCmdRpmb(t_teesmc_arg *TeeSmcArg)
                     //
 
                     BlockCount = RpmbRequest->block_count;
+                    if (BlockCount == 0) {
+                        TeecResult = TEEC_ERROR_BAD_PARAMETERS;
+                        break;
+                    }
+
                     OutputSize = sizeof(SFFDISK_DEVICE_RPMB_DATA_FRAME);
                     OutputSize *= (BlockCount - 1);
                     OutputSize += sizeof(SFFDISK_DEVICE_PARTITION_ACCESS_DATA);
@@ -890,9 +999,7 @@ TEEC_Result OpteeRpcCmdRpmb(t_teesmc_arg *TeeSmcArg)
                     //
 
                     AllocSize = OutputSize;
-                    TreeData = ExAllocatePoolWithTag(PagedPool,
-                                                     AllocSize,
-                                                     OPTEE_RPC_MEMORY_TAG);
+                    TreeData = OpteeRpmbAllocRequest(AllocSize);
 
                     if (TreeData == NULL) {
                         TraceError("ERR: Could not allocate requested size %d\n",
@@ -941,7 +1048,7 @@ TEEC_Result OpteeRpcCmdRpmb(t_teesmc_arg *TeeSmcArg)
             }
 
             if (TreeData != NULL) {
-                ExFreePool(TreeData);
+                OpteeRpmbFreeRequest(TreeData);
             }
 
             TraceInformation("Exit TeecResult %d\n", TeecResult);
@@ -965,12 +1072,23 @@ TEEC_Result OpteeRpcCmdRpmb(t_teesmc_arg *TeeSmcArg)
             DeviceInfo = (tee_rpc_rpmb_dev_info *)
                 OpteeClientPhysicalToVirtual(Physical);
 
+            // The partition geometry does not change, only the first
+            // request goes to the eMMC.
+            //
+
+            if (RpmbDeviceInfoValid) {
+                DeviceInfo->rel_wr_sec_c = (uint8_t)RpmbMaxReliableWriteBlocks;
+                DeviceInfo->rpmb_size_mult = (uint8_t)(RpmbSizeInBytes / (128 * 1024));
+                RtlCopyMemory(DeviceInfo->cid, RpmbCid, RPMB_EMMC_CID_SIZE);
+                TeecResult = TEEC_SUCCESS;
+                DeviceInfo->ret_code = (uint8_t)TeecResult;
+                break;
+            }
+
             InputSize = sizeof(SFFDISK_DEVICE_PARTITION_ACCESS_DATA);
             OutputSize = sizeof(SFFDISK_DEVICE_PARTITION_ACCESS_DATA);
             AllocSize = InputSize;
-            TreeData = ExAllocatePoolWithTag(PagedPool,
-                                             AllocSize,
-                                             OPTEE_RPC_MEMORY_TAG);
+            TreeData = OpteeRpmbAllocRequest(AllocSize);
 
             if (TreeData == NULL) {
                 TraceError("ERR: Could not allocate requested size %d\n",
@@ -1006,11 +1124,15 @@ TEEC_Result OpteeRpcCmdRpmb(t_teesmc_arg *TeeSmcArg)
                 RtlCopyMemory(DeviceInfo->cid, RpmbCid, RPMB_EMMC_CID_SIZE);
                 DeviceInfo->ret_code = TEE_RPC_RPMB_CMD_GET_DEV_INFO_RET_OK;
 
+                RpmbMaxReliableWriteBlocks = DeviceInfo->rel_wr_sec_c;
+                RpmbSizeInBytes = (ULONG)TreeData->Parameters.RpmbIsSupported.SizeInBytes;
+                RpmbDeviceInfoValid = TRUE;
+
                 TeecResult = TEEC_SUCCESS;
             }
 
             DeviceInfo->ret_code = (uint8_t)TeecResult;
-            ExFreePoolWithTag(TreeData, OPTEE_RPC_MEMORY_TAG);
+            OpteeRpmbFreeRequest(TreeData);
             break;
         }
 
@@ -44,6 +44,18 @@
 #include "teesmc.h"
 
 #define TEEC_SMC_SERIALIZE_CALLS 0
+
+// Number of standard calls allowed to be outstanding in secure world at the
+// same time. This should match the OP-TEE thread count (CFG_NUM_THREADS), a
+// higher value is safe since a call that finds no free thread waits for one
+// to be released and is reissued.
+//
+#define TEEC_SMC_MAX_CONCURRENT_CALLS 4
+
+// How long a call that hit the secure world thread limit waits for another
+// call to complete before it is reissued anyway.
+//
+#define TEEC_SMC_THREAD_LIMIT_RETRY_100NS (-10LL * 1000LL * 10LL)
 #define TEEC_SMC_DEFAULT_CACHE_ATTRIBUTES (TEESMC_ATTR_CACHE_DEFAULT << TEESMC_ATTR_CACHE_SHIFT);
 
 volatile float FloatingPointInit;
@@ -51,9 +63,42 @@ volatile float FloatingPointInit;
 static void SetTeeSmc32Params(TEEC_Operation *operation, t_teesmc_param *TeeSmcParam);
 static void GetTeeSmc32Params(t_teesmc_param *TeeSmcParam, TEEC_Operation *operation);
 
-static TEEC_Result OpteeSmcCallInternal(PHYSICAL_ADDRESS *SmcAddrPA);
 static TEEC_Result OpteeSmcCall(PHYSICAL_ADDRESS *SmcAddrPA);
 
+// Standard calls do not share any normal world state, each has its own
+// argument block, so calls from different threads go to secure world
+// concurrently. Contention between calls inside secure world is handled
+// there, through the wait queue RPCs. The normal world only bounds the number
+// of outstanding calls to the secure world thread count.
+//
+static KSEMAPHORE OpteeSmcCallSlots;
+static KEVENT OpteeSmcThreadReleased;
+static volatile LONG OpteeSmcThreadLimitWaiters;
+
+static VOID OpteeSmcWaitThreadReleased(VOID);
+
+#define OPTEE_SMC_ARM_CALL(Args)            ArmCallSmc(Args)
+#define OPTEE_SMC_RPC(Args)                 OpteeRpcCallback(Args)
+#define OPTEE_SMC_WAIT_THREAD_RELEASED()    OpteeSmcWaitThreadReleased()
+#define OPTEE_SMC_SIGNAL_THREAD_RELEASED() \
+    KeSetEvent(&OpteeSmcThreadReleased, IO_NO_INCREMENT, FALSE)
+
+#include "OpteeClientSmcLoop.h"
+
+
+/*
+ * Initialize the SMC call state.
+ */
+VOID OpteeClientSmcInit(VOID)
+{
+    KeInitializeSemaphore(&OpteeSmcCallSlots,
+                          TEEC_SMC_MAX_CONCURRENT_CALLS,
+                          TEEC_SMC_MAX_CONCURRENT_CALLS);
+
+    KeInitializeEvent(&OpteeSmcThreadReleased, SynchronizationEvent, FALSE);
+    OpteeSmcThreadLimitWaiters = 0;
+}
+
 
 /*
  * This function opens a new Session between the Client application and the
@@ -373,7 +418,16 @@ TEEC_Result OpteeSmcCall(PHYSICAL_ADDRESS *SmcAddrPA)
                                    FALSE,
                                    NULL);
     ASSERT(Status == STATUS_SUCCESS);
-#endif // TEEC_SMC_SERIALIZE_CALLS
+#else // TEEC_SMC_SERIALIZE_CALLS
+    NTSTATUS Status;
+
+    Status = KeWaitForSingleObject(&OpteeSmcCallSlots,
+                                   Executive,
+                                   KernelMode,
+                                   FALSE,
+                                   NULL);
+    ASSERT(Status == STATUS_SUCCESS);
+#endif // !TEEC_SMC_SERIALIZE_CALLS
 
     // Force VFP initialization, if OPTEE is built with TA VFP support
     // it assumes VFP is enabled.
@@ -385,7 +439,7 @@ TEEC_Result OpteeSmcCall(PHYSICAL_ADDRESS *SmcAddrPA)
     //
     FloatingPointInit = 1.1f;
 
-    Result = OpteeSmcCallInternal(SmcAddrPA);
+    Result = OpteeSmcCallLoop(SmcAddrPA, &OpteeSmcThreadLimitWaiters);
 
     KeRestoreExtendedProcessorState(&XStateSave);
 
@@ -394,56 +448,31 @@ TEEC_Result OpteeSmcCall(PHYSICAL_ADDRESS *SmcAddrPA)
                        LOW_PRIORITY,
                        1,
                        FALSE);
-#endif // TEEC_SMC_SERIALIZE_CALLS
+#else // TEEC_SMC_SERIALIZE_CALLS
+    KeReleaseSemaphore(&OpteeSmcCallSlots,
+                       LOW_PRIORITY,
+                       1,
+                       FALSE);
+#endif // !TEEC_SMC_SERIALIZE_CALLS
+
+    OpteeSmcCallCompleted(&OpteeSmcThreadLimitWaiters);
+
     return Result;
 }
 
 
 /*
- * Populate the SMC registers and make the call with OP-TEE specific
- * handling.
+ * Wait for a call to release its secure world thread, or for the retry
+ * timeout, after a call hit the secure world thread limit.
  */
-TEEC_Result OpteeSmcCallInternal(PHYSICAL_ADDRESS *TeeSmc32ArgPA)
+VOID OpteeSmcWaitThreadReleased(VOID)
 {
-    TEEC_Result TeecResult = TEEC_SUCCESS;
-    ARM_SMC_ARGS ArmSmcArgs = {0};
-    
-    // For now just use the normal call style.
-    //
-    ArmSmcArgs.Arg0 = TEESMC32_CALL_WITH_ARG;
-    ArmSmcArgs.Arg1 = TeeSmc32ArgPA->u.HighPart;
-    ArmSmcArgs.Arg2 = TeeSmc32ArgPA->u.LowPart;
-
-    // This is a loop because the call may result in RPC's that will need
-    // to be processed and may result in further calls until the originating
-    // call is completed.
-    //
-
-    for (;;) {
-
-        ArmCallSmc(&ArmSmcArgs);
-
-        if (TEESMC_RETURN_IS_RPC(ArmSmcArgs.Arg0)) {
-
-            // We must service the RPC even if it's processing failed
-            // and let the OP-TEE OS unwind and return back to us with
-            // it's error information.
-            //
-            (void) OpteeRpcCallback(&ArmSmcArgs);
-        }
-        else if (ArmSmcArgs.Arg0 == TEESMC_RETURN_UNKNOWN_FUNCTION) {
-            TeecResult = TEEC_ERROR_NOT_IMPLEMENTED;
-            break;
-        }
-        else if (ArmSmcArgs.Arg0 != TEESMC_RETURN_OK) {
-            TeecResult = TEEC_ERROR_COMMUNICATION;
-            break;
-        }
-        else {
-            TeecResult = TEEC_SUCCESS;
-            break;
-        }
-    }
-
-    return TeecResult;
+    LARGE_INTEGER Timeout;
+
+    Timeout.QuadPart = TEEC_SMC_THREAD_LIMIT_RETRY_100NS;
+    (void) KeWaitForSingleObject(&OpteeSmcThreadReleased,
+                                 Executive,
+                                 KernelMode,
+                                 FALSE,
+                                 &Timeout);
 }
@@ -34,6 +34,11 @@
 #include "OpteeClientLib.h"
 #include "types.h"
 
+VOID
+OpteeClientSmcInit(
+    VOID
+    );
+
 TEEC_Result 
 TEEC_SMC_OpenSession(
     _In_ TEEC_Context *context,
@@ -0,0 +1,240 @@
+/** @file
+Size class slabs of the OP-TEE shared memory allocator. The slabs only
+use SLISTs and interlocked counters, pages come from a callback, so the
+same code is stress tested and benchmarked on the host
+(test/OpteeClientSlabTest.c).
+**/
+
+/*
+* Copyright (c) 2018, Microsoft Corporation.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+//
+// Small allocations are served from per size class slabs carved out of
+// shared memory pages, larger ones directly from the page bitmap.
+// Object sizes include the allocation header.
+//
+#define OPTEE_SLAB_MIN_SHIFT        6       // 64 bytes
+#define OPTEE_SLAB_MAX_SHIFT        11      // 2 KB
+#define OPTEE_SLAB_CLASS_COUNT      (OPTEE_SLAB_MAX_SHIFT - OPTEE_SLAB_MIN_SHIFT + 1)
+
+//
+// A free slab object is linked through its first bytes, which hold the
+// allocation header while it is allocated.
+//
+C_ASSERT(sizeof(SLIST_ENTRY) <= (1 << OPTEE_SLAB_MIN_SHIFT));
+C_ASSERT((1 << OPTEE_SLAB_MAX_SHIFT) <= PAGE_SIZE);
+
+//
+// Free objects of each size class. Frees go to the list of the processor
+// the caller runs on, allocations try that list first, so processors
+// rarely contend and never take a lock on the fast path.
+//
+typedef struct _OPTEE_SLAB_CPU_CACHE
+{
+    SLIST_HEADER FreeList[OPTEE_SLAB_CLASS_COUNT];
+} OPTEE_SLAB_CPU_CACHE, *POPTEE_SLAB_CPU_CACHE;
+
+typedef struct _OPTEE_SHM_STATS
+{
+    volatile LONG SlabAllocs[OPTEE_SLAB_CLASS_COUNT];
+    volatile LONG SlabFrees[OPTEE_SLAB_CLASS_COUNT];
+    volatile LONG SlabPages[OPTEE_SLAB_CLASS_COUNT];
+    volatile LONG CrossCpuAllocs;
+    volatile LONG PageAllocs;
+    volatile LONG PageFrees;
+    volatile LONG PagesInUse;
+    volatile LONG PeakPagesInUse;
+    volatile LONG AllocFailures;
+} OPTEE_SHM_STATS, *POPTEE_SHM_STATS;
+
+//
+// Returns a page for a new slab, or NULL if shared memory is exhausted.
+//
+typedef PVOID OPTEE_SLAB_ALLOC_PAGE(VOID);
+
+
+FORCEINLINE
+ULONG
+OpteeSlabSizeClass(
+    _In_ UINT32 ActualLength
+    )
+
+/*
+ * Returns the smallest size class holding ActualLength bytes, which
+ * must not exceed the largest object size.
+ */
+
+{
+    ULONG Class = 0;
+
+    ASSERT(ActualLength <= (1 << OPTEE_SLAB_MAX_SHIFT));
+
+    while ((1UL << (Class + OPTEE_SLAB_MIN_SHIFT)) < ActualLength) {
+        Class++;
+    }
+
+    return Class;
+}
+
+
+FORCEINLINE
+ULONG
+OpteeSlabObjectSize(
+    _In_ ULONG Class
+    )
+{
+    return 1UL << (Class + OPTEE_SLAB_MIN_SHIFT);
+}
+
+
+FORCEINLINE
+VOID
+OpteeShmStatsAddPages(
+    _Inout_ OPTEE_SHM_STATS *Stats,
+    _In_ LONG NumPages
+    )
+
+/*
+ * Accounts for pages taken from the bitmap and updates the peak.
+ */
+
+{
+    LONG InUse;
+    LONG Peak;
+
+    InUse = InterlockedAdd(&Stats->PagesInUse, NumPages);
+    Peak = Stats->PeakPagesInUse;
+    while (InUse > Peak) {
+        LONG Prev = InterlockedCompareExchange(&Stats->PeakPagesInUse,
+                                               InUse,
+                                               Peak);
+        if (Prev == Peak) {
+            break;
+        }
+        Peak = Prev;
+    }
+}
+
+
+FORCEINLINE
+PVOID
+OpteeSlabAlloc(
+    _In_reads_(CpuCount) OPTEE_SLAB_CPU_CACHE *CpuCaches,
+    _In_ ULONG CpuCount,
+    _In_ ULONG CurrentCpu,
+    _In_ ULONG Class,
+    _Inout_ OPTEE_SHM_STATS *Stats,
+    _In_ OPTEE_SLAB_ALLOC_PAGE *AllocPage
+    )
+
+/*
+ * Allocate an object of the given size class, from the current
+ * processor's free list if possible, then from the other processors'
+ * lists, and finally by carving a new page into objects.
+ */
+
+{
+    ULONG Cpu;
+    ULONG ObjectSize;
+    ULONG Offset;
+    PUCHAR Page;
+    PSLIST_HEADER FreeList;
+    PSLIST_ENTRY Entry;
+
+    ASSERT(CurrentCpu < CpuCount);
+    ASSERT(Class < OPTEE_SLAB_CLASS_COUNT);
+
+    FreeList = &CpuCaches[CurrentCpu].FreeList[Class];
+    Entry = InterlockedPopEntrySList(FreeList);
+    if (Entry != NULL) {
+        goto Done;
+    }
+
+    for (Cpu = 0; Cpu < CpuCount; Cpu++) {
+        if (Cpu == CurrentCpu) {
+            continue;
+        }
+
+        Entry = InterlockedPopEntrySList(&CpuCaches[Cpu].FreeList[Class]);
+        if (Entry != NULL) {
+            InterlockedIncrement(&Stats->CrossCpuAllocs);
+            goto Done;
+        }
+    }
+
+    Page = AllocPage();
+    if (Page == NULL) {
+        return NULL;
+    }
+
+    InterlockedIncrement(&Stats->SlabPages[Class]);
+
+    //
+    // Keep the first object, the rest of the page goes to this processor's
+    // free list. Slab pages stay assigned to their size class.
+    //
+    ObjectSize = OpteeSlabObjectSize(Class);
+    for (Offset = ObjectSize; Offset < PAGE_SIZE; Offset += ObjectSize) {
+        InterlockedPushEntrySList(FreeList, (PSLIST_ENTRY)(Page + Offset));
+    }
+
+    Entry = (PSLIST_ENTRY)Page;
+
+Done:
+    InterlockedIncrement(&Stats->SlabAllocs[Class]);
+    return Entry;
+}
+
+
+FORCEINLINE
+VOID
+OpteeSlabFree(
+    _In_reads_(CpuCount) OPTEE_SLAB_CPU_CACHE *CpuCaches,
+    _In_ ULONG CpuCount,
+    _In_ ULONG CurrentCpu,
+    _In_ ULONG Class,
+    _Inout_ OPTEE_SHM_STATS *Stats,
+    _In_ PVOID Object
+    )
+
+/*
+ * Return an object to the current processor's free list of its class.
+ */
+
+{
+    UNREFERENCED_PARAMETER(CpuCount);
+
+    ASSERT(CurrentCpu < CpuCount);
+    ASSERT(Class < OPTEE_SLAB_CLASS_COUNT);
+    ASSERT(((ULONG_PTR)Object) % OpteeSlabObjectSize(Class) == 0);
+
+    InterlockedIncrement(&Stats->SlabFrees[Class]);
+    InterlockedPushEntrySList(&CpuCaches[CurrentCpu].FreeList[Class],
+                              (PSLIST_ENTRY)Object);
+}
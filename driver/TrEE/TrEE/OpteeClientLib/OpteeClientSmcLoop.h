@@ -0,0 +1,128 @@
+/** @file
+  The normal world side of an OP-TEE standard call: the SMC, RPC and
+  thread limit retry loop. The SMC, the RPC handler and the thread release
+  event are hooks, so the same loop runs against a simulated secure world
+  on the host (test/OpteeClientSmcTest.c).
+
+  The including file defines:
+
+    OPTEE_SMC_ARM_CALL(Args)            Issue the SMC (ArmCallSmc)
+    OPTEE_SMC_RPC(Args)                 Service an RPC (OpteeRpcCallback)
+    OPTEE_SMC_WAIT_THREAD_RELEASED()    Wait, with a timeout, for another
+                                        call to complete
+    OPTEE_SMC_SIGNAL_THREAD_RELEASED()  Wake a call waiting for one
+**/
+
+/*
+ * Copyright (c) 2018, Microsoft Corporation.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+/*
+ * Populate the SMC registers and make the call with OP-TEE specific
+ * handling. ThreadLimitWaiters counts the calls waiting in
+ * OPTEE_SMC_WAIT_THREAD_RELEASED for a secure world thread.
+ */
+FORCEINLINE
+TEEC_Result
+OpteeSmcCallLoop(
+    _In_ PHYSICAL_ADDRESS *TeeSmc32ArgPA,
+    _Inout_ volatile LONG *ThreadLimitWaiters
+    )
+{
+    TEEC_Result TeecResult = TEEC_SUCCESS;
+    ARM_SMC_ARGS ArmSmcArgs = {0};
+
+    // For now just use the normal call style.
+    //
+    ArmSmcArgs.Arg0 = TEESMC32_CALL_WITH_ARG;
+    ArmSmcArgs.Arg1 = TeeSmc32ArgPA->u.HighPart;
+    ArmSmcArgs.Arg2 = TeeSmc32ArgPA->u.LowPart;
+
+    // This is a loop because the call may result in RPC's that will need
+    // to be processed and may result in further calls until the originating
+    // call is completed.
+    //
+
+    for (;;) {
+
+        OPTEE_SMC_ARM_CALL(&ArmSmcArgs);
+
+        if (TEESMC_RETURN_IS_RPC(ArmSmcArgs.Arg0)) {
+
+            // We must service the RPC even if it's processing failed
+            // and let the OP-TEE OS unwind and return back to us with
+            // it's error information.
+            //
+            (void) OPTEE_SMC_RPC(&ArmSmcArgs);
+        }
+        else if (ArmSmcArgs.Arg0 == TEESMC_RETURN_ETHREAD_LIMIT) {
+
+            // All secure world threads are busy with calls from other
+            // processors, wait for one of them to complete and reissue
+            // the call.
+            //
+            InterlockedIncrement(ThreadLimitWaiters);
+            OPTEE_SMC_WAIT_THREAD_RELEASED();
+            InterlockedDecrement(ThreadLimitWaiters);
+
+            ArmSmcArgs.Arg0 = TEESMC32_CALL_WITH_ARG;
+            ArmSmcArgs.Arg1 = TeeSmc32ArgPA->u.HighPart;
+            ArmSmcArgs.Arg2 = TeeSmc32ArgPA->u.LowPart;
+        }
+        else if (ArmSmcArgs.Arg0 == TEESMC_RETURN_UNKNOWN_FUNCTION) {
+            TeecResult = TEEC_ERROR_NOT_IMPLEMENTED;
+            break;
+        }
+        else if (ArmSmcArgs.Arg0 != TEESMC_RETURN_OK) {
+            TeecResult = TEEC_ERROR_COMMUNICATION;
+            break;
+        }
+        else {
+            TeecResult = TEEC_SUCCESS;
+            break;
+        }
+    }
+
+    return TeecResult;
+}
+
+
+/*
+ * A call has returned and released its secure world thread, let a call
+ * that hit the thread limit try again.
+ */
+FORCEINLINE
+VOID
+OpteeSmcCallCompleted(
+    _In_ volatile LONG *ThreadLimitWaiters
+    )
+{
+    if (*ThreadLimitWaiters != 0) {
+        OPTEE_SMC_SIGNAL_THREAD_RELEASED();
+    }
+}
@@ -126,6 +126,140 @@ typedef struct _TEST_VARIABLE_ENTRY {
 
 #define TEST_VARIABLE_DATA(_Data) sizeof(_Data), _Data
 
+//
+// Normal world variable cache.
+//
+// Every variable write at runtime goes through VariableServiceSetVariable,
+// so the driver can keep what it has read from the Auth. Var. TA and serve
+// later reads without a call into secure world:
+//
+// - The contents and attributes of the EFI global variables listed in
+//   VariableCacheAllowList, up to VARIABLE_CACHE_MAX_DATA_SIZE each and
+//   VARIABLE_CACHE_MAX_DATA_TOTAL in total. These are readable at runtime
+//   and hold no secrets, so a cached copy never exposes anything the TA
+//   would not. Nothing else is cached.
+//
+// - The variable name list in enumeration order. The list is built as a
+//   client walks GetNextVariableName from the first name, and once the walk
+//   reaches the end every later enumeration is answered from the cache.
+//
+// A SetVariable drops the cached contents of the variable and the name list,
+// whether or not the set succeeded. The mode variables (SetupMode, AuditMode,
+// DeployedMode, VendorKeys) change as a side effect of writing PK, KEK, db or
+// dbx, so a SetVariable of any EFI global or image security database variable
+// drops all cached contents. Results of calls that were
+// in flight during a SetVariable are not cached, which is tracked through
+// VariableCacheGeneration.
+//
+
+#define VARIABLE_CACHE_TAG 'cVPO'
+#define VARIABLE_CACHE_MAX_ENTRIES 256
+#define VARIABLE_CACHE_MAX_DATA_SIZE 1024
+#define VARIABLE_CACHE_MAX_DATA_TOTAL (64 * 1024)
+
+typedef struct _VARIABLE_CACHE_ENTRY {
+    LIST_ENTRY Link;
+    LIST_ENTRY NameLink;
+    GUID VendorGuid;
+    BOOLEAN DataValid;
+    UINT32 Attributes;
+    UINT32 DataSize;
+    PUCHAR Data;
+    USHORT NameSize;
+    WCHAR Name[ANYSIZE_ARRAY];
+} VARIABLE_CACHE_ENTRY, *PVARIABLE_CACHE_ENTRY;
+
+FAST_MUTEX VariableCacheLock;
+LIST_ENTRY VariableCacheEntries;
+LIST_ENTRY VariableCacheNameList;
+BOOLEAN VariableCacheNameListComplete;
+ULONG VariableCacheEntryCount;
+ULONG VariableCacheDataTotal;
+volatile LONG VariableCacheGeneration;
+
+static const GUID VariableCacheGlobalVariableGuid =
+    { 0x8BE4DF61, 0x93CA, 0x11D2, { 0xAA, 0x0D, 0x00, 0xE0, 0x98, 0x03, 0x2B, 0x8C } };
+
+static const GUID VariableCacheImageSecurityDatabaseGuid =
+    { 0xD719B2CB, 0x3D3A, 0x4596, { 0xA3, 0xBC, 0xDA, 0xD0, 0x0E, 0x67, 0x65, 0x6F } };
+
+static const WCHAR *VariableCacheAllowList[] = {
+    L"SecureBoot",
+    L"SetupMode",
+    L"AuditMode",
+    L"DeployedMode",
+    L"SignatureSupport",
+    L"OsIndicationsSupported",
+    L"BootOptionSupport",
+    L"BootCurrent",
+    L"VendorKeys",
+    L"PKDefault",
+    L"KEKDefault",
+    L"dbDefault",
+    L"dbxDefault",
+    L"dbtDefault",
+};
+
+static
+VOID
+VariableCacheInitialize(
+    VOID
+    );
+
+static
+VOID
+VariableCacheFlush(
+    VOID
+    );
+
+static
+BOOLEAN
+VariableCacheGetVariable(
+    _In_ PEFI_GET_VARIABLE_IN Input,
+    _In_ SIZE_T NameSize,
+    _Out_ PEFI_GET_VARIABLE_OUT Output,
+    _In_ ULONG64 OutputBufferLength,
+    _Inout_ PULONG_PTR BytesWritten
+    );
+
+static
+VOID
+VariableCacheStoreVariable(
+    _In_ LONG Generation,
+    _In_ PEFI_GET_VARIABLE_IN Input,
+    _In_ SIZE_T NameSize,
+    _In_ UINT32 Attributes,
+    _In_reads_bytes_(DataSize) const UCHAR *Data,
+    _In_ UINT32 DataSize
+    );
+
+static
+BOOLEAN
+VariableCacheGetNextVariableName(
+    _In_ PEFI_GET_NEXT_VARIABLE_NAME_IN Input,
+    _In_ SIZE_T NameSize,
+    _Out_ PEFI_GET_NEXT_VARIABLE_NAME_OUT Output,
+    _In_ ULONG64 OutputBufferLength,
+    _Inout_ PULONG_PTR BytesWritten
+    );
+
+static
+VOID
+VariableCacheStoreNextVariableName(
+    _In_ LONG Generation,
+    _In_ PEFI_GET_NEXT_VARIABLE_NAME_IN Input,
+    _In_ SIZE_T NameSize,
+    _In_opt_ PVARIABLE_GET_NEXT_RESULT Result
+    );
+
+static
+VOID
+VariableCacheInvalidate(
+    _In_reads_bytes_(NameSize) const WCHAR *Name,
+    _In_ SIZE_T NameSize,
+    _In_ const GUID *VendorGuid
+    );
+
 _Use_decl_annotations_
 NTSTATUS
 VariableServiceCreateSecureServiceContext(
@@ -157,6 +291,8 @@ VariableServiceCreateSecureServiceContext(
     VariableServiceContext->DeviceContext = TreeGetDeviceContext(MasterDevice);
     VariableServiceContext->ServiceDevice = ServiceDevice;
 
+    VariableCacheInitialize();
+
     Status = OpteeClientApiLibInitialize(NULL,
         ServiceDevice,
         VariableServiceContext->DeviceContext->SharedMemoryBaseAddress,
@@ -228,6 +364,8 @@ Return Value:
     // Do the finalization in the reverse order of the initialization.
     //
 
+    VariableCacheFlush();
+
     if (mVariableParamMem.buffer != NULL) {
         TEEC_ReleaseSharedMemory(&mVariableParamMem);
     }
@@ -589,6 +727,564 @@ Return Value:
     WdfRequestComplete(Request, STATUS_INVALID_PARAMETER);
 }
 
+static
+VOID
+VariableCacheInitialize(
+    VOID
+    )
+{
+    ExInitializeFastMutex(&VariableCacheLock);
+    InitializeListHead(&VariableCacheEntries);
+    InitializeListHead(&VariableCacheNameList);
+    VariableCacheNameListComplete = FALSE;
+    VariableCacheEntryCount = 0;
+    VariableCacheDataTotal = 0;
+    VariableCacheGeneration = 0;
+}
+
+static
+VOID
+VariableCacheDropData(
+    _Inout_ PVARIABLE_CACHE_ENTRY Entry
+    )
+{
+    if (Entry->Data != NULL) {
+        VariableCacheDataTotal -= Entry->DataSize;
+        ExFreePoolWithTag(Entry->Data, VARIABLE_CACHE_TAG);
+        Entry->Data = NULL;
+    }
+
+    Entry->DataValid = FALSE;
+    Entry->DataSize = 0;
+}
+
+static
+VOID
+VariableCacheFreeEntry(
+    _In_ PVARIABLE_CACHE_ENTRY Entry
+    )
+{
+    VariableCacheDropData(Entry);
+    RemoveEntryList(&Entry->NameLink);
+    RemoveEntryList(&Entry->Link);
+    VariableCacheEntryCount -= 1;
+    ExFreePoolWithTag(Entry, VARIABLE_CACHE_TAG);
+}
+
+static
+VOID
+VariableCacheFlushNameList(
+    VOID
+    )
+
+/*++
+
+Routine Description:
+
+    Forget the variable name list. Entries that hold no contents either are
+    freed. Must be called with VariableCacheLock held.
+
+--*/
+
+{
+    PLIST_ENTRY Link;
+    PVARIABLE_CACHE_ENTRY Entry;
+
+    while (!IsListEmpty(&VariableCacheNameList)) {
+        Link = RemoveHeadList(&VariableCacheNameList);
+        InitializeListHead(Link);
+
+        Entry = CONTAINING_RECORD(Link, VARIABLE_CACHE_ENTRY, NameLink);
+        if (Entry->DataValid == FALSE) {
+            VariableCacheFreeEntry(Entry);
+        }
+    }
+
+    VariableCacheNameListComplete = FALSE;
+}
+
+static
+VOID
+VariableCacheFlush(
+    VOID
+    )
+{
+    PVARIABLE_CACHE_ENTRY Entry;
+
+    ExAcquireFastMutex(&VariableCacheLock);
+
+    while (!IsListEmpty(&VariableCacheEntries)) {
+        Entry = CONTAINING_RECORD(VariableCacheEntries.Flink,
+                                  VARIABLE_CACHE_ENTRY,
+                                  Link);
+
+        VariableCacheFreeEntry(Entry);
+    }
+
+    VariableCacheNameListComplete = FALSE;
+    InterlockedIncrement(&VariableCacheGeneration);
+
+    ExReleaseFastMutex(&VariableCacheLock);
+}
+
+static
+PVARIABLE_CACHE_ENTRY
+VariableCacheFind(
+    _In_reads_bytes_(NameSize) const WCHAR *Name,
+    _In_ SIZE_T NameSize,
+    _In_ const GUID *VendorGuid
+    )
+
+/*++
+
+Routine Description:
+
+    Look up a variable by name and vendor GUID. Must be called with
+    VariableCacheLock held.
+
+--*/
+
+{
+    PLIST_ENTRY Link;
+    PVARIABLE_CACHE_ENTRY Entry;
+
+    for (Link = VariableCacheEntries.Flink;
+         Link != &VariableCacheEntries;
+         Link = Link->Flink) {
+
+        Entry = CONTAINING_RECORD(Link, VARIABLE_CACHE_ENTRY, Link);
+        if ((Entry->NameSize == NameSize) &&
+            IsEqualGUID(&Entry->VendorGuid, VendorGuid) &&
+            (RtlCompareMemory(Entry->Name, Name, NameSize) == NameSize)) {
+
+            return Entry;
+        }
+    }
+
+    return NULL;
+}
+
+static
+PVARIABLE_CACHE_ENTRY
+VariableCacheFindOrCreate(
+    _In_reads_bytes_(NameSize) const WCHAR *Name,
+    _In_ SIZE_T NameSize,
+    _In_ const GUID *VendorGuid
+    )
+
+/*++
+
+Routine Description:
+
+    Look up a variable, adding an entry without contents if it is not cached
+    yet. Must be called with VariableCacheLock held.
+
+--*/
+
+{
+    PVARIABLE_CACHE_ENTRY Entry;
+
+    Entry = VariableCacheFind(Name, NameSize, VendorGuid);
+    if (Entry != NULL) {
+        return Entry;
+    }
+
+    if ((NameSize == 0) ||
+        (NameSize > MAXUSHORT) ||
+        (VariableCacheEntryCount >= VARIABLE_CACHE_MAX_ENTRIES)) {
+
+        return NULL;
+    }
+
+    Entry = (PVARIABLE_CACHE_ENTRY)ExAllocatePoolWithTag(
+                NonPagedPoolNx,
+                FIELD_OFFSET(VARIABLE_CACHE_ENTRY, Name) + NameSize,
+                VARIABLE_CACHE_TAG);
+
+    if (Entry == NULL) {
+        return NULL;
+    }
+
+    RtlZeroMemory(Entry, FIELD_OFFSET(VARIABLE_CACHE_ENTRY, Name));
+    RtlCopyMemory(&Entry->VendorGuid, VendorGuid, sizeof(GUID));
+    RtlCopyMemory(Entry->Name, Name, NameSize);
+    Entry->NameSize = (USHORT)NameSize;
+    InitializeListHead(&Entry->NameLink);
+    InsertTailList(&VariableCacheEntries, &Entry->Link);
+    VariableCacheEntryCount += 1;
+
+    return Entry;
+}
+
+static
+BOOLEAN
+VariableCacheGetVariable(
+    _In_ PEFI_GET_VARIABLE_IN Input,
+    _In_ SIZE_T NameSize,
+    _Out_ PEFI_GET_VARIABLE_OUT Output,
+    _In_ ULONG64 OutputBufferLength,
+    _Inout_ PULONG_PTR BytesWritten
+    )
+
+/*++
+
+Routine Description:
+
+    Answer a GetVariable request from the cache.
+
+Return Value:
+
+    TRUE if the request was completed from the cache, FALSE if it needs to
+    go to the Auth. Var. TA.
+
+--*/
+
+{
+    PVARIABLE_CACHE_ENTRY Entry;
+    BOOLEAN Hit;
+
+    Hit = FALSE;
+
+    ExAcquireFastMutex(&VariableCacheLock);
+
+    Entry = VariableCacheFind(Input->VariableName, NameSize, &Input->VendorGuid);
+    if ((Entry == NULL) || (Entry->DataValid == FALSE)) {
+        goto Exit;
+    }
+
+    Hit = TRUE;
+    *BytesWritten += Entry->DataSize;
+    Output->DataSize = Entry->DataSize;
+
+    if ((OutputBufferLength - FIELD_OFFSET(EFI_GET_VARIABLE_OUT, Data)) < Entry->DataSize) {
+        Output->EfiStatus = EFI_BUFFER_TOO_SMALL;
+        goto Exit;
+    }
+
+    Output->Attributes = Entry->Attributes;
+    RtlCopyMemory(Output->Data, Entry->Data, Entry->DataSize);
+    Output->EfiStatus = EFI_SUCCESS;
+
+Exit:
+    ExReleaseFastMutex(&VariableCacheLock);
+    return Hit;
+}
+
+static
+BOOLEAN
+VariableCacheIsCacheable(
+    _In_reads_bytes_(NameSize) const WCHAR *Name,
+    _In_ SIZE_T NameSize,
+    _In_ const GUID *VendorGuid,
+    _In_ UINT32 Attributes
+    )
+
+/*++
+
+Routine Description:
+
+    Check whether the contents of a variable may be cached: it must be one of
+    the EFI global variables on VariableCacheAllowList, and the TA must have
+    reported it as a runtime accessible variable.
+
+--*/
+
+{
+    SIZE_T AllowedSize;
+    ULONG Index;
+
+    if (((Attributes & EFI_VARIABLE_RUNTIME_ACCESS) == 0) ||
+        ((Attributes & EFI_VARIABLE_HARDWARE_ERROR_RECORD) != 0) ||
+        !IsEqualGUID(VendorGuid, &VariableCacheGlobalVariableGuid)) {
+
+        return FALSE;
+    }
+
+    for (Index = 0; Index < ARRAYSIZE(VariableCacheAllowList); Index += 1) {
+        AllowedSize = (wcslen(VariableCacheAllowList[Index]) + 1) * sizeof(WCHAR);
+        if ((AllowedSize == NameSize) &&
+            (RtlCompareMemory(VariableCacheAllowList[Index], Name, NameSize) == NameSize)) {
+
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+static
+VOID
+VariableCacheStoreVariable(
+    _In_ LONG Generation,
+    _In_ PEFI_GET_VARIABLE_IN Input,
+    _In_ SIZE_T NameSize,
+    _In_ UINT32 Attributes,
+    _In_reads_bytes_(DataSize) const UCHAR *Data,
+    _In_ UINT32 DataSize
+    )
+{
+    PVARIABLE_CACHE_ENTRY Entry;
+    PUCHAR Copy;
+
+    if ((DataSize > VARIABLE_CACHE_MAX_DATA_SIZE) ||
+        !VariableCacheIsCacheable(Input->VariableName,
+                                  NameSize,
+                                  &Input->VendorGuid,
+                                  Attributes)) {
+
+        return;
+    }
+
+    ExAcquireFastMutex(&VariableCacheLock);
+
+    if ((Generation != VariableCacheGeneration) ||
+        ((VariableCacheDataTotal + DataSize) > VARIABLE_CACHE_MAX_DATA_TOTAL)) {
+
+        goto Exit;
+    }
+
+    Entry = VariableCacheFindOrCreate(Input->VariableName, NameSize, &Input->VendorGuid);
+    if ((Entry == NULL) || (Entry->DataValid != FALSE)) {
+        goto Exit;
+    }
+
+    Copy = NULL;
+    if (DataSize != 0) {
+        Copy = (PUCHAR)ExAllocatePoolWithTag(NonPagedPoolNx,
+                                             DataSize,
+                                             VARIABLE_CACHE_TAG);
+        if (Copy == NULL) {
+            goto Exit;
+        }
+
+        RtlCopyMemory(Copy, Data, DataSize);
+    }
+
+    Entry->Data = Copy;
+    Entry->DataSize = DataSize;
+    Entry->Attributes = Attributes;
+    Entry->DataValid = TRUE;
+    VariableCacheDataTotal += DataSize;
+
+Exit:
+    ExReleaseFastMutex(&VariableCacheLock);
+}
+
+static
+BOOLEAN
+VariableCacheIsNameListTail(
+    _In_reads_bytes_(NameSize) const WCHAR *Name,
+    _In_ SIZE_T NameSize,
+    _In_ const GUID *VendorGuid
+    )
+
+/*++
+
+Routine Description:
+
+    Check whether a GetNextVariableName request continues the name list at
+    its end, either because it starts the walk and the list is empty or
+    because it names the last variable on the list. Must be called with
+    VariableCacheLock held.
+
+--*/
+
+{
+    PVARIABLE_CACHE_ENTRY Entry;
+
+    if (NameSize == 0) {
+        return IsListEmpty(&VariableCacheNameList);
+    }
+
+    if (IsListEmpty(&VariableCacheNameList)) {
+        return FALSE;
+    }
+
+    Entry = CONTAINING_RECORD(VariableCacheNameList.Blink,
+                              VARIABLE_CACHE_ENTRY,
+                              NameLink);
+
+    return (Entry->NameSize == NameSize) &&
+           IsEqualGUID(&Entry->VendorGuid, VendorGuid) &&
+           (RtlCompareMemory(Entry->Name, Name, NameSize) == NameSize);
+}
+
+static
+BOOLEAN
+VariableCacheGetNextVariableName(
+    _In_ PEFI_GET_NEXT_VARIABLE_NAME_IN Input,
+    _In_ SIZE_T NameSize,
+    _Out_ PEFI_GET_NEXT_VARIABLE_NAME_OUT Output,
+    _In_ ULONG64 OutputBufferLength,
+    _Inout_ PULONG_PTR BytesWritten
+    )
+
+/*++
+
+Routine Description:
+
+    Answer a GetNextVariableName request from the cached name list.
+
+Return Value:
+
+    TRUE if the request was completed from the cache, FALSE if it needs to
+    go to the Auth. Var. TA.
+
+--*/
+
+{
+    PVARIABLE_CACHE_ENTRY Entry;
+    PLIST_ENTRY Next;
+    BOOLEAN Hit;
+
+    Hit = FALSE;
+
+    ExAcquireFastMutex(&VariableCacheLock);
+
+    if (NameSize == 0) {
+        Next = VariableCacheNameList.Flink;
+
+    } else {
+        Entry = VariableCacheFind(Input->VariableName, NameSize, &Input->VendorGuid);
+        if ((Entry == NULL) || IsListEmpty(&Entry->NameLink)) {
+            goto Exit;
+        }
+
+        Next = Entry->NameLink.Flink;
+    }
+
+    if (Next == &VariableCacheNameList) {
+        if (VariableCacheNameListComplete != FALSE) {
+            Hit = TRUE;
+            Output->EfiStatus = EFI_NOT_FOUND;
+        }
+
+        goto Exit;
+    }
+
+    Hit = TRUE;
+    Entry = CONTAINING_RECORD(Next, VARIABLE_CACHE_ENTRY, NameLink);
+    *BytesWritten += Entry->NameSize;
+    Output->NameLength = Entry->NameSize;
+
+    if ((OutputBufferLength - FIELD_OFFSET(EFI_GET_NEXT_VARIABLE_NAME_OUT, VariableName)) <
+        Entry->NameSize) {
+
+        Output->EfiStatus = EFI_BUFFER_TOO_SMALL;
+        goto Exit;
+    }
+
+    RtlCopyMemory(&Output->VendorGuid, &Entry->VendorGuid, sizeof(GUID));
+    RtlCopyMemory(Output->VariableName, Entry->Name, Entry->NameSize);
+    Output->EfiStatus = EFI_SUCCESS;
+
+Exit:
+    ExReleaseFastMutex(&VariableCacheLock);
+    return Hit;
+}
+
+static
+VOID
+VariableCacheStoreNextVariableName(
+    _In_ LONG Generation,
+    _In_ PEFI_GET_NEXT_VARIABLE_NAME_IN Input,
+    _In_ SIZE_T NameSize,
+    _In_opt_ PVARIABLE_GET_NEXT_RESULT Result
+    )
+
+/*++
+
+Routine Description:
+
+    Extend the cached name list with the result of a GetNextVariableName
+    call into the Auth. Var. TA. A NULL Result records that the TA reported
+    the end of the list.
+
+--*/
+
+{
+    PVARIABLE_CACHE_ENTRY Entry;
+
+    ExAcquireFastMutex(&VariableCacheLock);
+
+    if ((Generation != VariableCacheGeneration) ||
+        (VariableCacheNameListComplete != FALSE) ||
+        !VariableCacheIsNameListTail(Input->VariableName, NameSize, &Input->VendorGuid)) {
+
+        goto Exit;
+    }
+
+    if (Result == NULL) {
+        VariableCacheNameListComplete = TRUE;
+        goto Exit;
+    }
+
+    Entry = VariableCacheFindOrCreate(Result->VariableName,
+                                      Result->VariableNameSize,
+                                      &Result->VendorGuid);
+
+    if ((Entry != NULL) && IsListEmpty(&Entry->NameLink)) {
+        InsertTailList(&VariableCacheNameList, &Entry->NameLink);
+    }
+
+Exit:
+    ExReleaseFastMutex(&VariableCacheLock);
+}
+
+static
+VOID
+VariableCacheInvalidate(
+    _In_reads_bytes_(NameSize) const WCHAR *Name,
+    _In_ SIZE_T NameSize,
+    _In_ const GUID *VendorGuid
+    )
+
+/*++
+
+Routine Description:
+
+    Drop what the cache holds about a variable that has just been set, and
+    the name list. Any set can delete a variable, whatever its DataSize: a
+    zero DataSize, attributes without access bits, or an authenticated
+    payload that carries only a descriptor all delete, and a set that fails
+    in the TA may still have changed the store.
+
+    Setting PK, KEK, db or dbx also changes the secure boot mode variables,
+    so a set of any EFI global or image security database variable drops
+    every cached variable.
+
+--*/
+
+{
+    PVARIABLE_CACHE_ENTRY Entry;
+
+    ExAcquireFastMutex(&VariableCacheLock);
+
+    InterlockedIncrement(&VariableCacheGeneration);
+
+    VariableCacheFlushNameList();
+
+    if (IsEqualGUID(VendorGuid, &VariableCacheGlobalVariableGuid) ||
+        IsEqualGUID(VendorGuid, &VariableCacheImageSecurityDatabaseGuid)) {
+
+        while (!IsListEmpty(&VariableCacheEntries)) {
+            Entry = CONTAINING_RECORD(VariableCacheEntries.Flink,
+                                      VARIABLE_CACHE_ENTRY,
+                                      Link);
+
+            VariableCacheFreeEntry(Entry);
+        }
+
+    } else {
+        Entry = VariableCacheFind(Name, NameSize, VendorGuid);
+        if (Entry != NULL) {
+            VariableCacheFreeEntry(Entry);
+        }
+    }
+
+    ExReleaseFastMutex(&VariableCacheLock);
+}
+
 EFI_STATUS
 OpteeRuntimeVariableInvokeCommand(
     _In_ TEEC_Session* Session,
@@ -742,6 +1438,7 @@ VariableServiceGetVariable(
     UINT32 VariableResultSize;
     UINT32 ResultSize = 0;
     UINT32 AuthVarStatus = 0;
+    LONG CacheGeneration;
 
     //
     // Validate that the buffers will fit.
@@ -756,6 +1453,17 @@ VariableServiceGetVariable(
         goto Exit;
     }
 
+    CacheGeneration = VariableCacheGeneration;
+    if (VariableCacheGetVariable(Input,
+                                 LocalVariableNameSize,
+                                 Output,
+                                 OutputBufferLength,
+                                 BytesWritten)) {
+
+        TraceDebug("    Served from cache, EFI Status: 0x%IX\n", Output->EfiStatus);
+        return Status;
+    }
+
     //
     // A note about sizes. The correct calculations should be of the form:
     //   OFFSET_OF(VARIABLE_GET_PARAM, VariableName)
@@ -846,6 +1554,13 @@ VariableServiceGetVariable(
     Output->Attributes = VariableResult->GetResult.Attributes;
     RtlCopyMemory(Output->Data, VariableResult->GetResult.Data, VariableResult->GetResult.DataSize);
     Output->DataSize = VariableResult->GetResult.DataSize;
+
+    VariableCacheStoreVariable(CacheGeneration,
+                               Input,
+                               LocalVariableNameSize,
+                               VariableResult->GetResult.Attributes,
+                               VariableResult->GetResult.Data,
+                               VariableResult->GetResult.DataSize);
     TraceDebug("    Output Size 0x%IX\n", Output->DataSize);
 
 Exit:
@@ -913,6 +1628,7 @@ VariableServiceGetNextVariableName(
     UINT32 VariableResultSize;
     UINT32 ResultSize = 0;
     UINT32 AuthVarStatus = 0;
+    LONG CacheGeneration;
 
     //
     // Validate that the buffers will fit.
@@ -926,6 +1642,18 @@ VariableServiceGetNextVariableName(
         Status = STATUS_INVALID_BUFFER_SIZE;
         goto Exit;
     }
+
+    CacheGeneration = VariableCacheGeneration;
+    if (VariableCacheGetNextVariableName(Input,
+                                         LocalVariableNameSize,
+                                         Output,
+                                         OutputBufferLength,
+                                         BytesWritten)) {
+
+        TraceDebug("GET NEXT Variable served from cache, EFI Status: 0x%IX\n",
+                   Output->EfiStatus);
+        return Status;
+    }
     //
     // A note about sizes. The correct calculations should be of the form:
     //   OFFSET_OF(VARIABLE_GET_NEXT_PARAM,  VariableName)
@@ -997,6 +1725,12 @@ VariableServiceGetNextVariableName(
     }
     else if (EFIStatus == EFI_SUCCESS) {
         *BytesWritten += VariableResult->GetNextResult.VariableNameSize;
+    } else if (EFIStatus == EFI_NOT_FOUND) {
+        VariableCacheStoreNextVariableName(CacheGeneration,
+                                           Input,
+                                           LocalVariableNameSize,
+                                           NULL);
+        goto Exit;
     } else if (EFI_ERROR(EFIStatus)) {
         goto Exit;
     }
@@ -1015,6 +1749,11 @@ VariableServiceGetNextVariableName(
     RtlCopyMemory(&Output->VendorGuid, &VariableResult->GetNextResult.VendorGuid, sizeof(VariableResult->GetNextResult.VendorGuid));
     RtlCopyMemory(&Output->VariableName, &VariableResult->GetNextResult.VariableName, VariableResult->GetNextResult.VariableNameSize);
 
+    VariableCacheStoreNextVariableName(CacheGeneration,
+                                       Input,
+                                       LocalVariableNameSize,
+                                       &VariableResult->GetNextResult);
+
 Exit:
     Output->EfiStatus = EFIStatus;
     return Status;
@@ -1117,6 +1856,13 @@ VariableServiceSetVariable(
         &ResultSize,
         &WtrStatus);
 
+    //
+    // Invalidate even if the set failed, the TA may have partially applied it.
+    //
+    VariableCacheInvalidate(VariableName,
+        VariableNameSize,
+        &Input->VendorGuid);
+
     TraceDebug("    EFI Status: 0x%IX\n", EFIStatus);
 
 Exit:
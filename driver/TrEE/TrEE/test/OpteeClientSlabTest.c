@@ -0,0 +1,663 @@
+/** @file
+Host test of the OP-TEE shared memory slabs in OpteeClientSlab.h.
+
+Pages come from a model of the shared memory bitmap. Each simulated
+processor is a thread, so the stress test runs the per processor free
+lists, the cross processor refill and the page carving concurrently, and
+checks that no object is handed out twice, that object contents survive
+until they are freed and that every object is back on a free list at the
+end. "bench" adds ns per allocation and free for 1, 2 and 4 processors,
+against a page bitmap behind one lock, which is what every allocation
+took before the slabs.
+
+Build and run from the repository root:
+
+  cc -std=c11 -O2 -Wall -pthread -I driver/shared/hosttest
+     -I driver/TrEE/TrEE/OpteeClientLib
+     driver/TrEE/TrEE/test/OpteeClientSlabTest.c -o OpteeClientSlabTest
+  ./OpteeClientSlabTest [bench]
+**/
+
+/*
+* Copyright (c) 2018, Microsoft Corporation.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <time.h>
+
+#include "hosttest.h"
+#include "OpteeClientSlab.h"
+
+#define SIM_CPUS_MAX            4
+#define SIM_POOL_PAGES_MAX      1024
+#define SIM_GRANULE             (1 << OPTEE_SLAB_MIN_SHIFT)
+#define SIM_GRANULES            (SIM_POOL_PAGES_MAX * PAGE_SIZE / SIM_GRANULE)
+#define SIM_HEADER_SIZE         16          // OPTEE_CLIENT_MEM_HEADER
+#define SIM_LIVE_MAX            64          // Objects a stress thread holds at once
+#define SIM_HANDOFF_SIZE        256
+#define SIM_STRESS_ITERATIONS   200000
+
+/*
+ * Shared memory model: a run of pages handed out one at a time from a
+ * bitmap behind a lock, as OpteeClientMemAllocPages does.
+ */
+typedef struct _SIM_POOL {
+    PUCHAR              Base;
+    ULONG               PageCount;
+    BOOLEAN             PageUsed[SIM_POOL_PAGES_MAX];
+    pthread_mutex_t     Lock;
+    UCHAR               Owned[SIM_GRANULES];    // Granules of objects currently allocated
+} SIM_POOL;
+
+static SIM_POOL SimPool;
+static OPTEE_SLAB_CPU_CACHE SimCaches[SIM_CPUS_MAX];
+static OPTEE_SHM_STATS SimStats;
+static volatile LONG SimErrors;
+
+static void SimInit(ULONG PageCount)
+{
+    ULONG Cpu;
+    ULONG Class;
+
+    ASSERT(PageCount <= SIM_POOL_PAGES_MAX);
+
+    if (SimPool.Base == NULL) {
+        SimPool.Base = aligned_alloc(PAGE_SIZE, SIM_POOL_PAGES_MAX * PAGE_SIZE);
+        pthread_mutex_init(&SimPool.Lock, NULL);
+    }
+
+    SimPool.PageCount = PageCount;
+    memset(SimPool.PageUsed, 0, sizeof(SimPool.PageUsed));
+    memset(SimPool.Owned, 0, sizeof(SimPool.Owned));
+
+    for (Cpu = 0; Cpu < SIM_CPUS_MAX; Cpu++) {
+        for (Class = 0; Class < OPTEE_SLAB_CLASS_COUNT; Class++) {
+            InitializeSListHead(&SimCaches[Cpu].FreeList[Class]);
+        }
+    }
+
+    RtlZeroMemory(&SimStats, sizeof(SimStats));
+    SimErrors = 0;
+}
+
+static PVOID SimAllocPage(VOID)
+{
+    ULONG Index;
+
+    pthread_mutex_lock(&SimPool.Lock);
+    for (Index = 0; Index < SimPool.PageCount; Index++) {
+        if (!SimPool.PageUsed[Index]) {
+            SimPool.PageUsed[Index] = TRUE;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&SimPool.Lock);
+
+    if (Index == SimPool.PageCount) {
+        InterlockedIncrement(&SimStats.AllocFailures);
+        return NULL;
+    }
+
+    OpteeShmStatsAddPages(&SimStats, 1);
+    return SimPool.Base + Index * PAGE_SIZE;
+}
+
+static BOOLEAN SimInPool(PVOID Object)
+{
+    PUCHAR Address = Object;
+
+    return (Address >= SimPool.Base) &&
+           (Address < SimPool.Base + SimPool.PageCount * PAGE_SIZE);
+}
+
+/*
+ * Marks the granules of an object as allocated or free. Fails if any of
+ * them already is, that is when an object is handed out twice or freed
+ * twice, or overlaps another.
+ */
+static BOOLEAN SimMarkObject(PVOID Object, ULONG Class, BOOLEAN Allocated)
+{
+    ULONG First = (ULONG)(((PUCHAR)Object - SimPool.Base) / SIM_GRANULE);
+    ULONG Count = OpteeSlabObjectSize(Class) / SIM_GRANULE;
+    UCHAR From = Allocated ? 0 : 1;
+    UCHAR To = Allocated ? 1 : 0;
+    BOOLEAN Ok = TRUE;
+    ULONG i;
+
+    for (i = First; i < First + Count; i++) {
+        if (__sync_val_compare_and_swap(&SimPool.Owned[i], From, To) != From) {
+            Ok = FALSE;
+        }
+    }
+
+    return Ok;
+}
+
+static PVOID SimAlloc(ULONG Cpu, ULONG Class)
+{
+    PVOID Object = OpteeSlabAlloc(SimCaches, SIM_CPUS_MAX, Cpu, Class, &SimStats, SimAllocPage);
+
+    if (Object != NULL) {
+        if (!SimInPool(Object) ||
+            (((ULONG_PTR)Object % OpteeSlabObjectSize(Class)) != 0) ||
+            !SimMarkObject(Object, Class, TRUE)) {
+
+            InterlockedIncrement(&SimErrors);
+        }
+    }
+
+    return Object;
+}
+
+static void SimFree(ULONG Cpu, ULONG Class, PVOID Object)
+{
+    if (!SimMarkObject(Object, Class, FALSE)) {
+        InterlockedIncrement(&SimErrors);
+    }
+
+    OpteeSlabFree(SimCaches, SIM_CPUS_MAX, Cpu, Class, &SimStats, Object);
+}
+
+static ULONG SimFreeListLength(ULONG Cpu, ULONG Class)
+{
+    PSLIST_ENTRY Entry;
+    ULONG Count = 0;
+
+    for (Entry = SimCaches[Cpu].FreeList[Class].Next; Entry != NULL; Entry = Entry->Next) {
+        // More entries than the pool holds objects means the list loops
+        if (++Count > SIM_GRANULES) {
+            InterlockedIncrement(&SimErrors);
+            break;
+        }
+    }
+
+    return Count;
+}
+
+/*
+ * Once everything is freed, every object of every slab page is on exactly
+ * one free list, and allocations and frees balance.
+ */
+static void SimCheckQuiescent(void)
+{
+    ULONG Class;
+    ULONG Cpu;
+    ULONG i;
+    ULONG Free;
+
+    for (Class = 0; Class < OPTEE_SLAB_CLASS_COUNT; Class++) {
+        Free = 0;
+        for (Cpu = 0; Cpu < SIM_CPUS_MAX; Cpu++) {
+            Free += SimFreeListLength(Cpu, Class);
+        }
+
+        HOSTTEST_CHECK_EQ(SimStats.SlabAllocs[Class], SimStats.SlabFrees[Class]);
+        HOSTTEST_CHECK_EQ(Free, SimStats.SlabPages[Class] * (PAGE_SIZE / OpteeSlabObjectSize(Class)));
+    }
+
+    for (i = 0; i < SIM_GRANULES; i++) {
+        if (SimPool.Owned[i] != 0) {
+            InterlockedIncrement(&SimErrors);
+        }
+    }
+
+    HOSTTEST_CHECK_EQ(SimErrors, 0);
+}
+
+static void TestSizeClass(void)
+{
+    HOSTTEST_CHECK_EQ(OpteeSlabSizeClass(1), 0);
+    HOSTTEST_CHECK_EQ(OpteeSlabSizeClass(SIM_HEADER_SIZE), 0);
+    HOSTTEST_CHECK_EQ(OpteeSlabSizeClass(64), 0);
+    HOSTTEST_CHECK_EQ(OpteeSlabSizeClass(65), 1);
+    HOSTTEST_CHECK_EQ(OpteeSlabSizeClass(128), 1);
+    HOSTTEST_CHECK_EQ(OpteeSlabSizeClass(129), 2);
+    HOSTTEST_CHECK_EQ(OpteeSlabSizeClass(1025), 5);
+    HOSTTEST_CHECK_EQ(OpteeSlabSizeClass(2048), OPTEE_SLAB_CLASS_COUNT - 1);
+
+    HOSTTEST_CHECK_EQ(OpteeSlabObjectSize(0), 64);
+    HOSTTEST_CHECK_EQ(OpteeSlabObjectSize(OPTEE_SLAB_CLASS_COUNT - 1), 2048);
+
+    // Every length gets the smallest class that holds it
+    for (UINT32 Length = 1; Length <= (1 << OPTEE_SLAB_MAX_SHIFT); Length++) {
+        ULONG Class = OpteeSlabSizeClass(Length);
+
+        HOSTTEST_CHECK(OpteeSlabObjectSize(Class) >= Length);
+        if (Class != 0) {
+            HOSTTEST_CHECK(OpteeSlabObjectSize(Class - 1) < Length);
+        }
+    }
+}
+
+/*
+ * A new page is carved into objects for the allocating processor, and
+ * only the next allocation after they are used up takes another page.
+ */
+static void TestCarvePage(void)
+{
+    for (ULONG Class = 0; Class < OPTEE_SLAB_CLASS_COUNT; Class++) {
+        const ULONG PerPage = PAGE_SIZE / OpteeSlabObjectSize(Class);
+        PVOID Objects[2 * (PAGE_SIZE / SIM_GRANULE)];
+        ULONG i;
+
+        SimInit(4);
+        for (i = 0; i < PerPage; i++) {
+            Objects[i] = SimAlloc(0, Class);
+            HOSTTEST_CHECK(Objects[i] != NULL);
+        }
+
+        HOSTTEST_CHECK_EQ(SimStats.SlabPages[Class], 1);
+        HOSTTEST_CHECK_EQ(SimStats.PagesInUse, 1);
+        HOSTTEST_CHECK_EQ(SimFreeListLength(0, Class), 0);
+
+        Objects[PerPage] = SimAlloc(0, Class);
+        HOSTTEST_CHECK_EQ(SimStats.SlabPages[Class], 2);
+        HOSTTEST_CHECK_EQ(SimFreeListLength(0, Class), PerPage - 1);
+
+        for (i = 0; i <= PerPage; i++) {
+            SimFree(0, Class, Objects[i]);
+        }
+
+        HOSTTEST_CHECK_EQ(SimStats.CrossCpuAllocs, 0);
+        SimCheckQuiescent();
+    }
+}
+
+/*
+ * Frees go to the freeing processor. A processor with an empty list takes
+ * from another one before it asks for a new page.
+ */
+static void TestCrossCpu(void)
+{
+    const ULONG Class = 2;
+    const ULONG PerPage = PAGE_SIZE / OpteeSlabObjectSize(Class);
+    PVOID Object;
+    PVOID Other;
+
+    SimInit(4);
+
+    Object = SimAlloc(0, Class);
+    HOSTTEST_CHECK_EQ(SimFreeListLength(0, Class), PerPage - 1);
+
+    SimFree(1, Class, Object);
+    HOSTTEST_CHECK_EQ(SimFreeListLength(1, Class), 1);
+
+    // Processor 1 gets its own freed object back
+    HOSTTEST_CHECK(SimAlloc(1, Class) == Object);
+    HOSTTEST_CHECK_EQ(SimStats.CrossCpuAllocs, 0);
+
+    // and then takes from processor 0 rather than a new page
+    Other = SimAlloc(1, Class);
+    HOSTTEST_CHECK(Other != NULL);
+    HOSTTEST_CHECK_EQ(SimStats.CrossCpuAllocs, 1);
+    HOSTTEST_CHECK_EQ(SimStats.SlabPages[Class], 1);
+    HOSTTEST_CHECK_EQ(SimFreeListLength(0, Class), PerPage - 2);
+
+    SimFree(3, Class, Object);
+    SimFree(3, Class, Other);
+    SimCheckQuiescent();
+}
+
+/*
+ * When the bitmap runs out allocations fail and are counted. Freed
+ * objects are reused without new pages, and slab pages stay with their
+ * size class.
+ */
+static void TestExhaustion(void)
+{
+    const ULONG Class = OPTEE_SLAB_CLASS_COUNT - 1;
+    const ULONG Pages = 4;
+    const ULONG Objects = Pages * (PAGE_SIZE / OpteeSlabObjectSize(Class));
+    PVOID Allocated[4 * (PAGE_SIZE >> OPTEE_SLAB_MAX_SHIFT)];
+    ULONG i;
+
+    SimInit(Pages);
+    for (i = 0; i < Objects; i++) {
+        Allocated[i] = SimAlloc(i % SIM_CPUS_MAX, Class);
+        HOSTTEST_CHECK(Allocated[i] != NULL);
+    }
+
+    HOSTTEST_CHECK(SimAlloc(0, Class) == NULL);
+    HOSTTEST_CHECK(SimAlloc(0, 0) == NULL);
+    HOSTTEST_CHECK_EQ(SimStats.AllocFailures, 2);
+    HOSTTEST_CHECK_EQ(SimStats.PeakPagesInUse, Pages);
+
+    for (i = 0; i < Objects; i++) {
+        SimFree((i + 1) % SIM_CPUS_MAX, Class, Allocated[i]);
+    }
+
+    for (i = 0; i < Objects; i++) {
+        Allocated[i] = SimAlloc(0, Class);
+        HOSTTEST_CHECK(Allocated[i] != NULL);
+    }
+
+    HOSTTEST_CHECK_EQ(SimStats.SlabPages[Class], Pages);
+    HOSTTEST_CHECK_EQ(SimStats.AllocFailures, 2);
+    HOSTTEST_CHECK(SimAlloc(1, 0) == NULL);
+
+    for (i = 0; i < Objects; i++) {
+        SimFree(2, Class, Allocated[i]);
+    }
+
+    SimCheckQuiescent();
+}
+
+/*
+ * Stress: each thread is a processor that allocates random sizes, fills
+ * them with a pattern, checks it before freeing, and hands some objects
+ * to other processors to free, as a completion on another processor does.
+ */
+typedef struct _SIM_OBJECT {
+    PVOID   Object;
+    ULONG   Class;
+    ULONG   Tag;
+} SIM_OBJECT;
+
+static struct {
+    pthread_mutex_t Lock;
+    ULONG           Count;
+    SIM_OBJECT      Objects[SIM_HANDOFF_SIZE];
+} SimHandoff = { PTHREAD_MUTEX_INITIALIZER, 0, { { NULL, 0, 0 } } };
+
+typedef struct _SIM_THREAD {
+    pthread_t   Thread;
+    ULONG       Cpu;
+    ULONG       Iterations;
+    ULONG       Seed;
+} SIM_THREAD;
+
+static ULONG SimRandom(ULONG *Seed)
+{
+    ULONG x = *Seed;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *Seed = x;
+    return x;
+}
+
+static void SimFill(const SIM_OBJECT *Entry)
+{
+    PULONG Words = Entry->Object;
+    ULONG Count = OpteeSlabObjectSize(Entry->Class) / sizeof(ULONG);
+
+    for (ULONG i = 0; i < Count; i++) {
+        Words[i] = Entry->Tag ^ (i * 0x9E3779B9);
+    }
+}
+
+static void SimVerify(const SIM_OBJECT *Entry)
+{
+    PULONG Words = Entry->Object;
+    ULONG Count = OpteeSlabObjectSize(Entry->Class) / sizeof(ULONG);
+
+    for (ULONG i = 0; i < Count; i++) {
+        if (Words[i] != (Entry->Tag ^ (i * 0x9E3779B9))) {
+            InterlockedIncrement(&SimErrors);
+            return;
+        }
+    }
+}
+
+static void SimRelease(ULONG Cpu, const SIM_OBJECT *Entry)
+{
+    SimVerify(Entry);
+    SimFree(Cpu, Entry->Class, Entry->Object);
+}
+
+static void *SimStressThread(void *Context)
+{
+    SIM_THREAD *Thread = Context;
+    SIM_OBJECT Live[SIM_LIVE_MAX];
+    ULONG LiveCount = 0;
+    ULONG Tag = Thread->Cpu << 24;
+
+    for (ULONG n = 0; n < Thread->Iterations; n++) {
+        ULONG r = SimRandom(&Thread->Seed);
+
+        if ((LiveCount < SIM_LIVE_MAX) && ((LiveCount == 0) || (r & 1))) {
+            SIM_OBJECT *Entry = &Live[LiveCount];
+            UINT32 Length = SIM_HEADER_SIZE + (r >> 8) % ((1 << OPTEE_SLAB_MAX_SHIFT) - SIM_HEADER_SIZE + 1);
+
+            Entry->Class = OpteeSlabSizeClass(Length);
+            Entry->Object = SimAlloc(Thread->Cpu, Entry->Class);
+            Entry->Tag = Tag++;
+            if (Entry->Object == NULL) {
+                InterlockedIncrement(&SimErrors);
+                continue;
+            }
+
+            SimFill(Entry);
+            LiveCount++;
+            continue;
+        }
+
+        ULONG Index = (r >> 8) % LiveCount;
+        SIM_OBJECT Entry = Live[Index];
+
+        Live[Index] = Live[--LiveCount];
+
+        // One in four goes to another processor, which also picks one up
+        if ((r & 6) == 0) {
+            SIM_OBJECT Other = { NULL, 0, 0 };
+
+            pthread_mutex_lock(&SimHandoff.Lock);
+            if (SimHandoff.Count != 0) {
+                Other = SimHandoff.Objects[--SimHandoff.Count];
+            }
+            if (SimHandoff.Count < SIM_HANDOFF_SIZE) {
+                SimHandoff.Objects[SimHandoff.Count++] = Entry;
+                Entry.Object = NULL;
+            }
+            pthread_mutex_unlock(&SimHandoff.Lock);
+
+            if (Other.Object != NULL) {
+                SimRelease(Thread->Cpu, &Other);
+            }
+        }
+
+        if (Entry.Object != NULL) {
+            SimRelease(Thread->Cpu, &Entry);
+        }
+    }
+
+    while (LiveCount != 0) {
+        SimRelease(Thread->Cpu, &Live[--LiveCount]);
+    }
+
+    return NULL;
+}
+
+static void TestStress(void)
+{
+    SIM_THREAD Threads[SIM_CPUS_MAX];
+    ULONG Cpu;
+    ULONG Pages = 0;
+
+    SimInit(SIM_POOL_PAGES_MAX);
+    for (Cpu = 0; Cpu < SIM_CPUS_MAX; Cpu++) {
+        Threads[Cpu].Cpu = Cpu;
+        Threads[Cpu].Iterations = SIM_STRESS_ITERATIONS;
+        Threads[Cpu].Seed = 0x12345678 + Cpu * 0x1000193;
+        pthread_create(&Threads[Cpu].Thread, NULL, SimStressThread, &Threads[Cpu]);
+    }
+
+    for (Cpu = 0; Cpu < SIM_CPUS_MAX; Cpu++) {
+        pthread_join(Threads[Cpu].Thread, NULL);
+    }
+
+    while (SimHandoff.Count != 0) {
+        SimRelease(0, &SimHandoff.Objects[--SimHandoff.Count]);
+    }
+
+    for (ULONG Class = 0; Class < OPTEE_SLAB_CLASS_COUNT; Class++) {
+        Pages += SimStats.SlabPages[Class];
+    }
+
+    HOSTTEST_CHECK_EQ(SimStats.AllocFailures, 0);
+    HOSTTEST_CHECK_EQ(SimStats.PagesInUse, Pages);
+    HOSTTEST_CHECK(SimStats.CrossCpuAllocs != 0);
+    SimCheckQuiescent();
+}
+
+/*
+ * Benchmark. The baseline is a page bitmap behind one lock with a page
+ * per allocation, whatever its size.
+ */
+typedef struct _SIM_BENCH {
+    pthread_t   Thread;
+    ULONG       Cpu;
+    BOOLEAN     Slab;
+} SIM_BENCH;
+
+#define SIM_BENCH_ITERATIONS    2000000
+#define SIM_BENCH_LIVE          16
+
+static PVOID SimBaselineAlloc(void)
+{
+    return SimAllocPage();
+}
+
+static void SimBaselineFree(PVOID Page)
+{
+    ULONG Index = (ULONG)(((PUCHAR)Page - SimPool.Base) / PAGE_SIZE);
+
+    pthread_mutex_lock(&SimPool.Lock);
+    SimPool.PageUsed[Index] = FALSE;
+    pthread_mutex_unlock(&SimPool.Lock);
+
+    InterlockedAdd(&SimStats.PagesInUse, -1);
+}
+
+static void *SimBenchThread(void *Context)
+{
+    SIM_BENCH *Bench = Context;
+    PVOID Live[SIM_BENCH_LIVE];
+    ULONG Classes[SIM_BENCH_LIVE];
+    ULONG Seed = 0x2545F491 + Bench->Cpu;
+
+    for (ULONG i = 0; i < SIM_BENCH_LIVE; i++) {
+        Live[i] = NULL;
+    }
+
+    for (ULONG n = 0; n < SIM_BENCH_ITERATIONS; n++) {
+        ULONG i = n % SIM_BENCH_LIVE;
+
+        if (Live[i] != NULL) {
+            if (Bench->Slab) {
+                OpteeSlabFree(SimCaches, SIM_CPUS_MAX, Bench->Cpu, Classes[i], &SimStats, Live[i]);
+            } else {
+                SimBaselineFree(Live[i]);
+            }
+        }
+
+        if (Bench->Slab) {
+            // Mostly small parameter buffers, as TA invocations use
+            Classes[i] = OpteeSlabSizeClass(SIM_HEADER_SIZE + SimRandom(&Seed) % 512);
+            Live[i] = OpteeSlabAlloc(SimCaches, SIM_CPUS_MAX, Bench->Cpu, Classes[i], &SimStats, SimAllocPage);
+        } else {
+            Live[i] = SimBaselineAlloc();
+        }
+    }
+
+    for (ULONG i = 0; i < SIM_BENCH_LIVE; i++) {
+        if (Live[i] == NULL) {
+            continue;
+        }
+
+        if (Bench->Slab) {
+            OpteeSlabFree(SimCaches, SIM_CPUS_MAX, Bench->Cpu, Classes[i], &SimStats, Live[i]);
+        } else {
+            SimBaselineFree(Live[i]);
+        }
+    }
+
+    return NULL;
+}
+
+static double SimNow(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static double SimBenchRun(ULONG CpuCount, BOOLEAN Slab)
+{
+    SIM_BENCH Bench[SIM_CPUS_MAX];
+    double Start;
+    ULONG Cpu;
+
+    SimInit(SIM_POOL_PAGES_MAX);
+    Start = SimNow();
+    for (Cpu = 0; Cpu < CpuCount; Cpu++) {
+        Bench[Cpu].Cpu = Cpu;
+        Bench[Cpu].Slab = Slab;
+        pthread_create(&Bench[Cpu].Thread, NULL, SimBenchThread, &Bench[Cpu]);
+    }
+
+    for (Cpu = 0; Cpu < CpuCount; Cpu++) {
+        pthread_join(Bench[Cpu].Thread, NULL);
+    }
+
+    HOSTTEST_CHECK_EQ(SimStats.AllocFailures, 0);
+
+    // Wall time per allocation and free pair, across all processors
+    return (SimNow() - Start) / ((double)SIM_BENCH_ITERATIONS * CpuCount);
+}
+
+static void Benchmark(void)
+{
+    static const ULONG CpuCounts[] = { 1, 2, 4 };
+
+    printf("\nShared memory allocator benchmark, %u alloc/free pairs per processor, %u live\n",
+           SIM_BENCH_ITERATIONS, SIM_BENCH_LIVE);
+    printf("CPUs   slab ns/op   page bitmap ns/op\n");
+    for (ULONG i = 0; i < ARRAYSIZE(CpuCounts); i++) {
+        double SlabNs = SimBenchRun(CpuCounts[i], TRUE);
+        double BitmapNs = SimBenchRun(CpuCounts[i], FALSE);
+
+        printf("%4u   %10.1f   %17.1f\n", CpuCounts[i], SlabNs, BitmapNs);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    HOSTTEST_RUN(TestSizeClass);
+    HOSTTEST_RUN(TestCarvePage);
+    HOSTTEST_RUN(TestCrossCpu);
+    HOSTTEST_RUN(TestExhaustion);
+    HOSTTEST_RUN(TestStress);
+
+    if ((argc > 1) && (strcmp(argv[1], "bench") == 0)) {
+        Benchmark();
+    }
+    return HostTestExit();
+}
@@ -0,0 +1,734 @@
+/** @file
+Host test of the OP-TEE standard call loop in OpteeClientSmcLoop.h.
+
+A simulated secure world answers the SMCs. It has a fixed number of
+threads and returns TEESMC_RETURN_ETHREAD_LIMIT when none is free. Calls
+do their work in steps that each end in a foreign interrupt RPC, and can
+take a TA mutex, which sleeps and wakes through wait queue RPCs the way
+OP-TEE does. Each normal world processor is a thread that issues calls
+the way OpteeSmcCall does: it takes one of the call slots, runs the loop,
+releases the slot and signals completion.
+
+The tests check that a long call does not hold up calls from other
+processors, that calls beyond the secure world thread count are retried
+until they get a thread, and that calls contending for a TA mutex all
+complete through the wait queue.
+
+Build and run from the repository root:
+
+  cc -std=c11 -Wall -pthread -I driver/shared/hosttest
+     -I driver/TrEE/TrEE/OpteeClientLib
+     driver/TrEE/TrEE/test/OpteeClientSmcTest.c -o OpteeClientSmcTest
+  ./OpteeClientSmcTest
+**/
+
+/*
+* Copyright (c) 2018, Microsoft Corporation.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <time.h>
+
+#include "hosttest.h"
+
+/*
+ * Types of the OP-TEE client library used by the loop
+ */
+#define IN
+#define OUT
+typedef uintptr_t UINTN;
+typedef LARGE_INTEGER PHYSICAL_ADDRESS;
+typedef uint32_t TEEC_Result;
+
+#define TEEC_SUCCESS                0x00000000
+#define TEEC_ERROR_NOT_IMPLEMENTED  0xFFFF0009
+#define TEEC_ERROR_COMMUNICATION    0xFFFF000E
+
+#include "arm/ArmSmcLib.h"
+#include "teesmc.h"
+#include "tee_rpc.h"
+
+static void SimArmCallSmc(ARM_SMC_ARGS *Args);
+static TEEC_Result SimRpcCallback(ARM_SMC_ARGS *Args);
+static void SimWaitThreadReleased(void);
+static void SimSignalThreadReleased(void);
+
+#define OPTEE_SMC_ARM_CALL(Args)            SimArmCallSmc(Args)
+#define OPTEE_SMC_RPC(Args)                 SimRpcCallback(Args)
+#define OPTEE_SMC_WAIT_THREAD_RELEASED()    SimWaitThreadReleased()
+#define OPTEE_SMC_SIGNAL_THREAD_RELEASED()  SimSignalThreadReleased()
+
+#include "OpteeClientSmcLoop.h"
+
+#define SIM_TEE_THREADS_MAX     8
+#define SIM_CLIENTS_MAX         8
+#define SIM_CALLS_MAX           512
+#define SIM_WORK_NS             20000       // Secure world time per step
+#define SIM_LONG_STEPS_MAX      100000      // Bound on a call running until released
+#define SIM_RETRY_NS            10000000    // TEEC_SMC_THREAD_LIMIT_RETRY_100NS
+#define SIM_DEADLINE_S          30
+
+/*
+ * An argument block. Its index is the physical address the call passes.
+ */
+typedef struct _SIM_CALL {
+    ULONG           Steps;              // Work steps, each ending in a foreign interrupt RPC
+    BOOLEAN         UntilReleased;      // Runs until SimTee.LongCallRelease is set
+    BOOLEAN         UsesTaMutex;        // Does its work holding the TA mutex
+    BOOLEAN         BadCommand;         // Secure world rejects the call
+    BOOLEAN         Unsupported;        // Secure world does not know the function
+    volatile BOOLEAN Done;
+    TEEC_Result     Result;
+} SIM_CALL;
+
+typedef struct _SIM_TEE_THREAD {
+    SIM_CALL*       Call;               // NULL while the thread is free
+    ULONG           Step;
+    BOOLEAN         OwnsMutex;
+    BOOLEAN         Queued;             // Sleeping on the TA mutex
+} SIM_TEE_THREAD;
+
+/*
+ * Secure world model
+ */
+static struct {
+    pthread_mutex_t Lock;
+    ULONG           ThreadCount;
+    ULONG           ThreadsBusy;
+    ULONG           PeakThreadsBusy;
+    SIM_TEE_THREAD  Threads[SIM_TEE_THREADS_MAX];
+    LONG            MutexOwner;         // -1 while the TA mutex is free
+    ULONG           MutexQueue[SIM_TEE_THREADS_MAX];
+    ULONG           MutexQueueCount;
+    ULONG           ThreadLimitReturns;
+    ULONG           Interrupts;
+    ULONG           Sleeps;
+    ULONG           Wakeups;
+    BOOLEAN         LongCallRelease;
+} SimTee = { .Lock = PTHREAD_MUTEX_INITIALIZER };
+
+static SIM_CALL SimCalls[SIM_CALLS_MAX];
+static ULONG SimCallCount;
+static volatile LONG SimErrors;
+
+/*
+ * Normal world: the wait blocks of the wait queue RPCs, the call slots and
+ * the thread released event of OpteeClientSMC.c.
+ */
+typedef struct _SIM_EVENT {
+    pthread_mutex_t Lock;
+    pthread_cond_t  Cond;
+    BOOLEAN         Signaled;
+} SIM_EVENT;
+
+static SIM_EVENT SimWaitBlocks[SIM_TEE_THREADS_MAX];
+static SIM_EVENT SimThreadReleased;
+static ULONG SimReleasedWaitsSignaled;
+static ULONG SimReleasedWaitsTimedOut;
+static sem_t SimCallSlots;
+static volatile LONG SimThreadLimitWaiters;
+static volatile LONG SimCompleted;
+
+static void SimEventInit(SIM_EVENT *Event)
+{
+    pthread_mutex_init(&Event->Lock, NULL);
+    pthread_cond_init(&Event->Cond, NULL);
+    Event->Signaled = FALSE;
+}
+
+static void SimEventSet(SIM_EVENT *Event)
+{
+    pthread_mutex_lock(&Event->Lock);
+    Event->Signaled = TRUE;
+    pthread_cond_signal(&Event->Cond);
+    pthread_mutex_unlock(&Event->Lock);
+}
+
+/*
+ * Synchronization event wait, returns FALSE on timeout. TimeoutNs of 0
+ * waits forever.
+ */
+static BOOLEAN SimEventWait(SIM_EVENT *Event, long TimeoutNs)
+{
+    struct timespec Deadline;
+    BOOLEAN Signaled;
+
+    clock_gettime(CLOCK_REALTIME, &Deadline);
+    Deadline.tv_nsec += TimeoutNs;
+    Deadline.tv_sec += Deadline.tv_nsec / 1000000000;
+    Deadline.tv_nsec %= 1000000000;
+
+    pthread_mutex_lock(&Event->Lock);
+    while (!Event->Signaled) {
+        if (TimeoutNs == 0) {
+            pthread_cond_wait(&Event->Cond, &Event->Lock);
+        } else if (pthread_cond_timedwait(&Event->Cond, &Event->Lock, &Deadline) == ETIMEDOUT) {
+            break;
+        }
+    }
+
+    Signaled = Event->Signaled;
+    Event->Signaled = FALSE;
+    pthread_mutex_unlock(&Event->Lock);
+    return Signaled;
+}
+
+static void SimInit(ULONG TeeThreads, ULONG CallSlots)
+{
+    ULONG i;
+
+    ASSERT(TeeThreads <= SIM_TEE_THREADS_MAX);
+
+    RtlZeroMemory(SimTee.Threads, sizeof(SimTee.Threads));
+    SimTee.ThreadCount = TeeThreads;
+    SimTee.ThreadsBusy = 0;
+    SimTee.PeakThreadsBusy = 0;
+    SimTee.MutexOwner = -1;
+    SimTee.MutexQueueCount = 0;
+    SimTee.ThreadLimitReturns = 0;
+    SimTee.Interrupts = 0;
+    SimTee.Sleeps = 0;
+    SimTee.Wakeups = 0;
+    SimTee.LongCallRelease = FALSE;
+
+    RtlZeroMemory(SimCalls, sizeof(SimCalls));
+    SimCallCount = 0;
+    SimErrors = 0;
+
+    for (i = 0; i < SIM_TEE_THREADS_MAX; i++) {
+        SimEventInit(&SimWaitBlocks[i]);
+    }
+
+    SimEventInit(&SimThreadReleased);
+    SimReleasedWaitsSignaled = 0;
+    SimReleasedWaitsTimedOut = 0;
+    sem_init(&SimCallSlots, 0, CallSlots);
+    SimThreadLimitWaiters = 0;
+    SimCompleted = 0;
+}
+
+static ULONG SimAddCall(ULONG Steps, BOOLEAN UsesTaMutex)
+{
+    ASSERT(SimCallCount < SIM_CALLS_MAX);
+
+    SimCalls[SimCallCount].Steps = Steps;
+    SimCalls[SimCallCount].UsesTaMutex = UsesTaMutex;
+    return SimCallCount++;
+}
+
+static void SimWork(void)
+{
+    struct timespec Delay = { 0, SIM_WORK_NS };
+
+    nanosleep(&Delay, NULL);
+}
+
+static void SimTeeThreadExit(ULONG Id)
+{
+    SIM_TEE_THREAD *Thread = &SimTee.Threads[Id];
+
+    Thread->Call->Done = TRUE;
+    Thread->Call = NULL;
+    SimTee.ThreadsBusy--;
+}
+
+/*
+ * Secure world entry. a3 carries the thread of a call suspended by an
+ * RPC, and must come back unchanged with TEESMC32_CALL_RETURN_FROM_RPC.
+ * The wait queue command and key are passed in a1 and a2 rather than in
+ * an RPC argument block.
+ */
+static void SimArmCallSmc(ARM_SMC_ARGS *Args)
+{
+    SIM_TEE_THREAD *Thread;
+    SIM_CALL *Call;
+    ULONG Id;
+
+    pthread_mutex_lock(&SimTee.Lock);
+
+    if (Args->Arg0 == TEESMC32_CALL_WITH_ARG) {
+        if ((Args->Arg1 != 0) || (Args->Arg2 >= SimCallCount)) {
+            Args->Arg0 = TEESMC_RETURN_EBADADDR;
+            goto Exit;
+        }
+
+        for (Id = 0; Id < SimTee.ThreadCount; Id++) {
+            if (SimTee.Threads[Id].Call == NULL) {
+                break;
+            }
+        }
+
+        if (Id == SimTee.ThreadCount) {
+            SimTee.ThreadLimitReturns++;
+            Args->Arg0 = TEESMC_RETURN_ETHREAD_LIMIT;
+            goto Exit;
+        }
+
+        Thread = &SimTee.Threads[Id];
+        Thread->Call = &SimCalls[Args->Arg2];
+        Thread->Step = 0;
+        Thread->OwnsMutex = FALSE;
+        Thread->Queued = FALSE;
+
+        SimTee.ThreadsBusy++;
+        if (SimTee.ThreadsBusy > SimTee.PeakThreadsBusy) {
+            SimTee.PeakThreadsBusy = SimTee.ThreadsBusy;
+        }
+
+    } else if (Args->Arg0 == TEESMC32_CALL_RETURN_FROM_RPC) {
+        Id = (ULONG)Args->Arg3;
+        if ((Id >= SimTee.ThreadCount) || (SimTee.Threads[Id].Call == NULL)) {
+            InterlockedIncrement(&SimErrors);
+            Args->Arg0 = TEESMC_RETURN_ERESUME;
+            goto Exit;
+        }
+
+        Thread = &SimTee.Threads[Id];
+
+    } else {
+        InterlockedIncrement(&SimErrors);
+        Args->Arg0 = TEESMC_RETURN_UNKNOWN_FUNCTION;
+        goto Exit;
+    }
+
+    Call = Thread->Call;
+    Args->Arg3 = Id;
+
+    if (Call->Unsupported || Call->BadCommand) {
+        SimTeeThreadExit(Id);
+        Args->Arg0 = Call->Unsupported ? TEESMC_RETURN_UNKNOWN_FUNCTION : TEESMC_RETURN_EBADCMD;
+        goto Exit;
+    }
+
+    // Take the TA mutex before the work, sleep in normal world while
+    // another thread holds it
+    if (Call->UsesTaMutex && !Thread->OwnsMutex && (Thread->Step < Call->Steps)) {
+        if (SimTee.MutexOwner < 0) {
+            SimTee.MutexOwner = (LONG)Id;
+            Thread->OwnsMutex = TRUE;
+
+        } else {
+            if (!Thread->Queued) {
+                SimTee.MutexQueue[SimTee.MutexQueueCount++] = Id;
+                Thread->Queued = TRUE;
+            }
+
+            SimTee.Sleeps++;
+            Args->Arg0 = TEESMC_RETURN_RPC_CMD;
+            Args->Arg1 = TEE_WAIT_QUEUE_SLEEP;
+            Args->Arg2 = Id;
+            goto Exit;
+        }
+    }
+
+    if ((Thread->Step < Call->Steps) ||
+        (Call->UntilReleased && !SimTee.LongCallRelease && (Thread->Step < SIM_LONG_STEPS_MAX))) {
+
+        if (Call->UsesTaMutex && (SimTee.MutexOwner != (LONG)Id)) {
+            InterlockedIncrement(&SimErrors);
+        }
+
+        Thread->Step++;
+        SimTee.Interrupts++;
+        pthread_mutex_unlock(&SimTee.Lock);
+
+        SimWork();
+        Args->Arg0 = TEESMC_RETURN_RPC_IRQ;
+        return;
+    }
+
+    // Hand the TA mutex to the first waiter and wake it before returning
+    if (Thread->OwnsMutex) {
+        Thread->OwnsMutex = FALSE;
+        SimTee.MutexOwner = -1;
+
+        if (SimTee.MutexQueueCount != 0) {
+            ULONG Next = SimTee.MutexQueue[0];
+
+            SimTee.MutexQueueCount--;
+            memmove(&SimTee.MutexQueue[0],
+                    &SimTee.MutexQueue[1],
+                    SimTee.MutexQueueCount * sizeof(SimTee.MutexQueue[0]));
+
+            SimTee.Threads[Next].OwnsMutex = TRUE;
+            SimTee.Threads[Next].Queued = FALSE;
+            SimTee.MutexOwner = (LONG)Next;
+
+            SimTee.Wakeups++;
+            Args->Arg0 = TEESMC_RETURN_RPC_CMD;
+            Args->Arg1 = TEE_WAIT_QUEUE_WAKEUP;
+            Args->Arg2 = Next;
+            goto Exit;
+        }
+    }
+
+    if (Call->UntilReleased && !SimTee.LongCallRelease) {
+        InterlockedIncrement(&SimErrors);
+    }
+
+    SimTeeThreadExit(Id);
+    Args->Arg0 = TEESMC_RETURN_OK;
+
+Exit:
+    pthread_mutex_unlock(&SimTee.Lock);
+}
+
+/*
+ * Normal world RPC handling, as OpteeRpcCallback and the wait queue
+ * commands do it. A wakeup that arrives before the sleep leaves the wait
+ * block signaled, as OpteeRpcGetWaitBlock creates it on either.
+ */
+static TEEC_Result SimRpcCallback(ARM_SMC_ARGS *Args)
+{
+    TEEC_Result Result = TEEC_SUCCESS;
+
+    switch (TEESMC_RETURN_GET_RPC_FUNC(Args->Arg0)) {
+    case TEESMC_RPC_FUNC_IRQ:
+        break;
+
+    case TEESMC_RPC_FUNC_CMD:
+        if (Args->Arg1 == TEE_WAIT_QUEUE_SLEEP) {
+            (void)SimEventWait(&SimWaitBlocks[Args->Arg2], 0);
+        } else if (Args->Arg1 == TEE_WAIT_QUEUE_WAKEUP) {
+            SimEventSet(&SimWaitBlocks[Args->Arg2]);
+        } else {
+            InterlockedIncrement(&SimErrors);
+        }
+        break;
+
+    default:
+        InterlockedIncrement(&SimErrors);
+        Result = TEEC_ERROR_NOT_IMPLEMENTED;
+        break;
+    }
+
+    Args->Arg0 = TEESMC32_CALL_RETURN_FROM_RPC;
+    return Result;
+}
+
+static void SimWaitThreadReleased(void)
+{
+    if (SimEventWait(&SimThreadReleased, SIM_RETRY_NS)) {
+        __atomic_add_fetch(&SimReleasedWaitsSignaled, 1, __ATOMIC_SEQ_CST);
+    } else {
+        __atomic_add_fetch(&SimReleasedWaitsTimedOut, 1, __ATOMIC_SEQ_CST);
+    }
+}
+
+static void SimSignalThreadReleased(void)
+{
+    SimEventSet(&SimThreadReleased);
+}
+
+/*
+ * OpteeSmcCall
+ */
+static TEEC_Result SimOpteeSmcCall(ULONG CallIndex)
+{
+    PHYSICAL_ADDRESS ArgPA;
+    TEEC_Result Result;
+
+    ArgPA.QuadPart = CallIndex;
+
+    while (sem_wait(&SimCallSlots) != 0) {
+    }
+
+    Result = OpteeSmcCallLoop(&ArgPA, &SimThreadLimitWaiters);
+
+    sem_post(&SimCallSlots);
+    OpteeSmcCallCompleted(&SimThreadLimitWaiters);
+
+    SimCalls[CallIndex].Result = Result;
+    return Result;
+}
+
+/*
+ * A normal world processor issuing a run of calls one after the other
+ */
+typedef struct _SIM_CLIENT {
+    pthread_t   Thread;
+    ULONG       FirstCall;
+    ULONG       CallCount;
+    volatile BOOLEAN Done;
+} SIM_CLIENT;
+
+static SIM_CLIENT SimClients[SIM_CLIENTS_MAX];
+static ULONG SimClientCount;
+
+static void *SimClientThread(void *Context)
+{
+    SIM_CLIENT *Client = Context;
+
+    for (ULONG i = 0; i < Client->CallCount; i++) {
+        (void)SimOpteeSmcCall(Client->FirstCall + i);
+        InterlockedIncrement(&SimCompleted);
+    }
+
+    __atomic_store_n(&Client->Done, TRUE, __ATOMIC_SEQ_CST);
+    return NULL;
+}
+
+static void SimAddClient(ULONG FirstCall, ULONG CallCount)
+{
+    SIM_CLIENT *Client = &SimClients[SimClientCount++];
+
+    ASSERT(SimClientCount <= SIM_CLIENTS_MAX);
+
+    Client->FirstCall = FirstCall;
+    Client->CallCount = CallCount;
+    Client->Done = FALSE;
+}
+
+static void SimStartClients(void)
+{
+    for (ULONG i = 0; i < SimClientCount; i++) {
+        pthread_create(&SimClients[i].Thread, NULL, SimClientThread, &SimClients[i]);
+    }
+}
+
+/*
+ * Waits for the given clients, a hang is reported and ends the test
+ */
+static void SimWaitClients(ULONG First, ULONG Count)
+{
+    struct timespec Poll = { 0, 1000000 };
+    time_t Deadline = time(NULL) + SIM_DEADLINE_S;
+
+    for (ULONG i = First; i < First + Count; i++) {
+        while (!__atomic_load_n(&SimClients[i].Done, __ATOMIC_SEQ_CST)) {
+            if (time(NULL) > Deadline) {
+                fprintf(stderr, "%s(%d): calls did not complete, %d of %u done\n",
+                        __FILE__, __LINE__, (int)SimCompleted, SimCallCount);
+                exit(1);
+            }
+            nanosleep(&Poll, NULL);
+        }
+    }
+}
+
+static void SimJoinClients(void)
+{
+    SimWaitClients(0, SimClientCount);
+    for (ULONG i = 0; i < SimClientCount; i++) {
+        pthread_join(SimClients[i].Thread, NULL);
+    }
+
+    SimClientCount = 0;
+}
+
+/*
+ * After all calls returned, every secure world thread and wait block is
+ * free and every call got its expected result.
+ */
+static void SimCheckIdle(void)
+{
+    ULONG i;
+
+    HOSTTEST_CHECK_EQ(SimTee.ThreadsBusy, 0);
+    HOSTTEST_CHECK_EQ(SimTee.MutexOwner, -1);
+    HOSTTEST_CHECK_EQ(SimTee.MutexQueueCount, 0);
+    HOSTTEST_CHECK_EQ(SimThreadLimitWaiters, 0);
+    HOSTTEST_CHECK_EQ(SimErrors, 0);
+
+    for (i = 0; i < SIM_TEE_THREADS_MAX; i++) {
+        HOSTTEST_CHECK(!SimWaitBlocks[i].Signaled);
+    }
+
+    for (i = 0; i < SimCallCount; i++) {
+        const SIM_CALL *Call = &SimCalls[i];
+
+        HOSTTEST_CHECK(Call->Done);
+        if (Call->Unsupported) {
+            HOSTTEST_CHECK_EQ(Call->Result, TEEC_ERROR_NOT_IMPLEMENTED);
+        } else if (Call->BadCommand) {
+            HOSTTEST_CHECK_EQ(Call->Result, TEEC_ERROR_COMMUNICATION);
+        } else {
+            HOSTTEST_CHECK_EQ(Call->Result, TEEC_SUCCESS);
+        }
+    }
+}
+
+static void TestSingleCall(void)
+{
+    ULONG Call;
+
+    SimInit(4, 4);
+    Call = SimAddCall(3, FALSE);
+
+    HOSTTEST_CHECK_EQ(SimOpteeSmcCall(Call), TEEC_SUCCESS);
+    HOSTTEST_CHECK_EQ(SimTee.Interrupts, 3);
+    HOSTTEST_CHECK_EQ(SimTee.PeakThreadsBusy, 1);
+
+    Call = SimAddCall(1, FALSE);
+    SimCalls[Call].Unsupported = TRUE;
+    HOSTTEST_CHECK_EQ(SimOpteeSmcCall(Call), TEEC_ERROR_NOT_IMPLEMENTED);
+
+    Call = SimAddCall(1, FALSE);
+    SimCalls[Call].BadCommand = TRUE;
+    HOSTTEST_CHECK_EQ(SimOpteeSmcCall(Call), TEEC_ERROR_COMMUNICATION);
+
+    SimCheckIdle();
+}
+
+/*
+ * A call that keeps its secure world thread busy, like a long fTPM
+ * command, does not hold up calls from other processors.
+ */
+static void TestLongCallConcurrency(void)
+{
+    ULONG LongCall;
+    ULONG First;
+
+    SimInit(4, 4);
+    LongCall = SimAddCall(0, FALSE);
+    SimCalls[LongCall].UntilReleased = TRUE;
+    SimAddClient(LongCall, 1);
+
+    First = SimCallCount;
+    for (ULONG i = 0; i < 60; i++) {
+        SimAddCall(2, FALSE);
+    }
+    SimAddClient(First, 20);
+    SimAddClient(First + 20, 20);
+    SimAddClient(First + 40, 20);
+
+    SimStartClients();
+    SimWaitClients(1, 3);
+
+    HOSTTEST_CHECK(!SimCalls[LongCall].Done);
+    HOSTTEST_CHECK(SimTee.PeakThreadsBusy >= 2);
+
+    pthread_mutex_lock(&SimTee.Lock);
+    SimTee.LongCallRelease = TRUE;
+    pthread_mutex_unlock(&SimTee.Lock);
+
+    SimJoinClients();
+    SimCheckIdle();
+}
+
+/*
+ * More call slots than secure world threads: calls that get
+ * TEESMC_RETURN_ETHREAD_LIMIT wait for a completed call and are reissued.
+ */
+static void TestThreadLimit(void)
+{
+    const ULONG Clients = 4;
+    const ULONG PerClient = 25;
+
+    SimInit(2, 4);
+    for (ULONG c = 0; c < Clients; c++) {
+        for (ULONG i = 0; i < PerClient; i++) {
+            SimAddCall(2, FALSE);
+        }
+        SimAddClient(c * PerClient, PerClient);
+    }
+
+    SimStartClients();
+    SimJoinClients();
+
+    HOSTTEST_CHECK_EQ(SimCompleted, Clients * PerClient);
+    HOSTTEST_CHECK_EQ(SimTee.PeakThreadsBusy, 2);
+    HOSTTEST_CHECK(SimTee.ThreadLimitReturns != 0);
+
+    // Most retries are woken by a completed call rather than the timeout
+    HOSTTEST_CHECK(SimReleasedWaitsSignaled != 0);
+    SimCheckIdle();
+}
+
+/*
+ * Calls contending for a TA mutex sleep and are woken through the wait
+ * queue RPCs, and all complete.
+ */
+static void TestWaitQueue(void)
+{
+    const ULONG Clients = 4;
+    const ULONG PerClient = 25;
+
+    SimInit(4, 4);
+    for (ULONG c = 0; c < Clients; c++) {
+        for (ULONG i = 0; i < PerClient; i++) {
+            SimAddCall(3, TRUE);
+        }
+        SimAddClient(c * PerClient, PerClient);
+    }
+
+    SimStartClients();
+    SimJoinClients();
+
+    HOSTTEST_CHECK_EQ(SimCompleted, Clients * PerClient);
+    HOSTTEST_CHECK(SimTee.Sleeps != 0);
+    HOSTTEST_CHECK_EQ(SimTee.Wakeups, SimTee.Sleeps);
+    SimCheckIdle();
+}
+
+/*
+ * Everything at once: more processors than slots, more slots than
+ * secure world threads, TA mutex contention and failing calls.
+ */
+static void TestMixed(void)
+{
+    const ULONG Clients = 6;
+    const ULONG PerClient = 40;
+    ULONG Seed = 0x9E3779B9;
+
+    SimInit(3, 4);
+    for (ULONG c = 0; c < Clients; c++) {
+        for (ULONG i = 0; i < PerClient; i++) {
+            ULONG Call;
+
+            Seed ^= Seed << 13;
+            Seed ^= Seed >> 17;
+            Seed ^= Seed << 5;
+
+            Call = SimAddCall(1 + Seed % 4, (Seed & 0x100) != 0);
+            SimCalls[Call].BadCommand = ((Seed & 0x3E00) == 0);
+        }
+        SimAddClient(c * PerClient, PerClient);
+    }
+
+    SimStartClients();
+    SimJoinClients();
+
+    HOSTTEST_CHECK_EQ(SimCompleted, Clients * PerClient);
+    HOSTTEST_CHECK(SimTee.PeakThreadsBusy <= 3);
+    HOSTTEST_CHECK_EQ(SimTee.Wakeups, SimTee.Sleeps);
+    SimCheckIdle();
+}
+
+int main(void)
+{
+    HOSTTEST_RUN(TestSingleCall);
+    HOSTTEST_RUN(TestLongCallConcurrency);
+    HOSTTEST_RUN(TestThreadLimit);
+    HOSTTEST_RUN(TestWaitQueue);
+    HOSTTEST_RUN(TestMixed);
+
+    return HostTestExit();
+}
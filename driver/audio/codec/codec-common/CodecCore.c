@@ -0,0 +1,524 @@
+/* Copyright (c) Microsoft Corporation. All rights reserved.
+   Licensed under the MIT License.
+
+Module Name:
+
+    CodecCore.c - Cached and batched codec register access via I2c.
+
+Environment:
+
+    User-mode Driver Framework 2
+
+*/
+
+#include "Driver.h"
+#include "CodecCore.h"
+#include "CodecCore.tmh"
+
+//
+// Interval between two reads of a polled register.
+//
+#define CODEC_CORE_POLL_INTERVAL_MS     1
+
+static
+ULONG
+CodecCoreCacheFind(
+    _In_ const CODEC_CORE* Core,
+    USHORT Register,
+    _Out_ BOOLEAN* Found
+    )
+/*++
+
+Routine Description:
+
+    Binary search of the register cache.
+
+Return Value:
+
+    Index of the register's entry if it is cached, otherwise the index at
+    which it would be inserted.
+
+--*/
+{
+    ULONG low = 0;
+    ULONG high = Core->CacheCount;
+
+    while (low < high)
+    {
+        ULONG mid = (low + high) / 2;
+
+        if (Core->Cache[mid].Register == Register)
+        {
+            *Found = TRUE;
+            return mid;
+        }
+
+        if (Core->Cache[mid].Register < Register)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+
+    *Found = FALSE;
+    return low;
+}
+
+static
+VOID
+CodecCoreCacheUpdate(
+    _Inout_ PCODEC_CORE Core,
+    USHORT Register,
+    USHORT Value
+    )
+{
+    BOOLEAN found;
+    ULONG index = CodecCoreCacheFind(Core, Register, &found);
+
+    if (found)
+    {
+        Core->Cache[index].Value = Value;
+        return;
+    }
+
+    if (Core->CacheCount == ARRAYSIZE(Core->Cache))
+    {
+        //
+        // The register is still written, it just can't be skipped or
+        // restored later.
+        //
+        TraceEvents(TRACE_LEVEL_WARNING, TRACE_DEVICE,
+            "Codec register cache full, R%u not cached", Register);
+        return;
+    }
+
+    MoveMemory(&Core->Cache[index + 1],
+               &Core->Cache[index],
+               (Core->CacheCount - index) * sizeof(Core->Cache[0]));
+
+    Core->Cache[index].Register = Register;
+    Core->Cache[index].Value = Value;
+    Core->CacheCount++;
+}
+
+static
+NTSTATUS
+CodecCoreSendSequence(
+    _In_ const CODEC_CORE* Core,
+    _In_ PSPB_TRANSFER_LIST TransferList,
+    ULONG TransferListSize
+    )
+{
+    NTSTATUS status;
+    ULONG_PTR bytesTransferred;
+    WDF_MEMORY_DESCRIPTOR memDescriptor;
+
+    WDF_MEMORY_DESCRIPTOR_INIT_BUFFER(&memDescriptor, TransferList, TransferListSize);
+
+    status = WdfIoTargetSendIoctlSynchronously(Core->I2cTarget,
+                                               NULL,
+                                               IOCTL_SPB_EXECUTE_SEQUENCE,
+                                               &memDescriptor,
+                                               NULL,
+                                               NULL,
+                                               &bytesTransferred);
+    if (!NT_SUCCESS(status))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, TRACE_DEVICE,
+            "IOCTL_SPB_EXECUTE_SEQUENCE failed %!STATUS!", status);
+    }
+
+    return status;
+}
+
+static
+NTSTATUS
+CodecCoreFlush(
+    _Inout_ PCODEC_CORE Core
+    )
+{
+    NTSTATUS status;
+
+    if (Core->TransferCount == 0)
+    {
+        return STATUS_SUCCESS;
+    }
+
+    Core->TransferList.List.Size = sizeof(SPB_TRANSFER_LIST);
+    Core->TransferList.List.TransferCount = Core->TransferCount;
+
+    status = CodecCoreSendSequence(Core,
+                                   &Core->TransferList.List,
+                                   FIELD_OFFSET(SPB_TRANSFER_LIST, Transfers) +
+                                       (Core->TransferCount * sizeof(SPB_TRANSFER_LIST_ENTRY)));
+
+    Core->SequencesSent++;
+    Core->TransferCount = 0;
+    Core->BatchBytes = 0;
+
+    return status;
+}
+
+static
+NTSTATUS
+CodecCoreQueueWrite(
+    _Inout_ PCODEC_CORE Core,
+    USHORT Register,
+    USHORT Value
+    )
+{
+    NTSTATUS status;
+    PUCHAR bytes;
+    PSPB_TRANSFER_LIST_ENTRY lastTransfer;
+
+    //
+    // Extend the previous transfer with the next register's data when the
+    // codec auto-increments the register address.
+    //
+    if ((Core->TransferCount != 0) &&
+        (Core->Config.AutoIncrementStep != 0) &&
+        (Register == (USHORT)(Core->LastRegister + Core->Config.AutoIncrementStep)) &&
+        (Core->BatchBytes + 2 <= sizeof(Core->Batch)))
+    {
+        NT_ASSERT(Core->Config.Format == CodecRegisterFormatA16D16);
+
+        lastTransfer = &Core->TransferList.List.Transfers[Core->TransferCount - 1];
+        bytes = &Core->Batch[Core->BatchBytes];
+        bytes[0] = (UCHAR)(Value >> 8);
+        bytes[1] = (UCHAR)(Value & 0xFF);
+
+        lastTransfer->Buffer.Simple.BufferCb += 2;
+        Core->BatchBytes += 2;
+        Core->LastRegister = Register;
+        Core->WritesSent++;
+        return STATUS_SUCCESS;
+    }
+
+    if ((Core->TransferCount == CODEC_CORE_MAX_TRANSFERS) ||
+        (Core->BatchBytes + 4 > sizeof(Core->Batch)))
+    {
+        status = CodecCoreFlush(Core);
+        if (!NT_SUCCESS(status))
+        {
+            return status;
+        }
+    }
+
+    bytes = &Core->Batch[Core->BatchBytes];
+
+    ULONG length;
+    switch (Core->Config.Format)
+    {
+    case CodecRegisterFormatA16D16:
+        bytes[0] = (UCHAR)(Register >> 8);
+        bytes[1] = (UCHAR)(Register & 0xFF);
+        bytes[2] = (UCHAR)(Value >> 8);
+        bytes[3] = (UCHAR)(Value & 0xFF);
+        length = 4;
+        break;
+
+    case CodecRegisterFormatA7D9:
+        // Address [15:9], Data [8:0]
+        bytes[0] = (UCHAR)((Register << 1) | ((Value & 0x1FF) >> 8));
+        bytes[1] = (UCHAR)(Value & 0xFF);
+        length = 2;
+        break;
+
+    default:
+        NT_ASSERT(FALSE);
+        return STATUS_NOT_SUPPORTED;
+    }
+
+    lastTransfer = &Core->TransferList.List.Transfers[Core->TransferCount];
+    SPB_TRANSFER_LIST_ENTRY_INIT_SIMPLE(lastTransfer,
+                                        SpbTransferDirectionToDevice,
+                                        0,
+                                        bytes,
+                                        length);
+
+    Core->TransferCount++;
+    Core->BatchBytes += length;
+    Core->LastRegister = Register;
+    Core->WritesSent++;
+
+    return STATUS_SUCCESS;
+}
+
+VOID
+CodecCoreInitialize(
+    _Out_ PCODEC_CORE Core,
+    _In_ WDFIOTARGET I2cTarget,
+    _In_ const CODEC_CORE_CONFIG* Config
+    )
+{
+    RtlZeroMemory(Core, sizeof(*Core));
+
+    Core->I2cTarget = I2cTarget;
+    Core->Config = *Config;
+}
+
+VOID
+CodecCoreInvalidateCache(
+    _Inout_ PCODEC_CORE Core
+    )
+{
+    Core->CacheCount = 0;
+}
+
+NTSTATUS
+CodecCoreReadRegister(
+    _Inout_ PCODEC_CORE Core,
+    USHORT Register,
+    _Out_ USHORT* Value
+    )
+{
+    NTSTATUS status;
+    UCHAR address[2];
+    UCHAR data[2];
+    SPB_TRANSFER_LIST_AND_ENTRIES(2) sequence;
+
+    *Value = 0;
+
+    if (Core->Config.Format != CodecRegisterFormatA16D16)
+    {
+        //
+        // The WM8731 control interface is write only.
+        //
+        return STATUS_NOT_SUPPORTED;
+    }
+
+    //
+    // Pending writes have to land before the register is read back.
+    //
+    status = CodecCoreFlush(Core);
+    if (!NT_SUCCESS(status))
+    {
+        return status;
+    }
+
+    address[0] = (UCHAR)(Register >> 8);
+    address[1] = (UCHAR)(Register & 0xFF);
+
+    SPB_TRANSFER_LIST_INIT(&sequence.List, 2);
+    SPB_TRANSFER_LIST_ENTRY_INIT_SIMPLE(&sequence.List.Transfers[0],
+                                        SpbTransferDirectionToDevice,
+                                        0,
+                                        address,
+                                        sizeof(address));
+    SPB_TRANSFER_LIST_ENTRY_INIT_SIMPLE(&sequence.List.Transfers[1],
+                                        SpbTransferDirectionFromDevice,
+                                        0,
+                                        data,
+                                        sizeof(data));
+
+    status = CodecCoreSendSequence(Core, &sequence.List, sizeof(sequence));
+    if (NT_SUCCESS(status))
+    {
+        *Value = (USHORT)((data[0] << 8) | data[1]);
+    }
+
+    return status;
+}
+
+static
+NTSTATUS
+CodecCorePoll(
+    _Inout_ PCODEC_CORE Core,
+    _In_ const CODEC_REGISTER_COMMAND* Command
+    )
+{
+    NTSTATUS status;
+    USHORT value;
+    ULONGLONG start = GetTickCount64();
+
+    for (;;)
+    {
+        status = CodecCoreReadRegister(Core, Command->Register, &value);
+        if (!NT_SUCCESS(status))
+        {
+            return status;
+        }
+
+        if ((value & Command->Mask) == Command->Value)
+        {
+            return STATUS_SUCCESS;
+        }
+
+        if ((GetTickCount64() - start) > Command->TimeoutMs)
+        {
+            TraceEvents(TRACE_LEVEL_ERROR, TRACE_DEVICE,
+                "Timed out polling R%u (value 0x%04x, mask 0x%04x, expected 0x%04x)",
+                Command->Register, value, Command->Mask, Command->Value);
+            return STATUS_IO_TIMEOUT;
+        }
+
+        Sleep(CODEC_CORE_POLL_INTERVAL_MS);
+    }
+}
+
+NTSTATUS
+CodecCoreSendCommands(
+    _Inout_ PCODEC_CORE Core,
+    _In_reads_(NumCommands) const CODEC_REGISTER_COMMAND Commands[],
+    ULONG NumCommands
+    )
+{
+    ULONG i;
+    NTSTATUS status = STATUS_SUCCESS;
+
+    for (i = 0; i < NumCommands; i++)
+    {
+        const CODEC_REGISTER_COMMAND* command = &Commands[i];
+        BOOLEAN found;
+        ULONG index;
+
+        switch (command->Operation)
+        {
+        case CodecOperationWrite:
+            index = CodecCoreCacheFind(Core, command->Register, &found);
+            if (found && (Core->Cache[index].Value == command->Value))
+            {
+                Core->WritesSkipped++;
+                break;
+            }
+
+            status = CodecCoreQueueWrite(Core, command->Register, command->Value);
+            if (NT_SUCCESS(status))
+            {
+                CodecCoreCacheUpdate(Core, command->Register, command->Value);
+            }
+            break;
+
+        case CodecOperationWriteVolatile:
+            status = CodecCoreQueueWrite(Core, command->Register, command->Value);
+            break;
+
+        case CodecOperationReset:
+            status = CodecCoreQueueWrite(Core, command->Register, command->Value);
+            if (NT_SUCCESS(status))
+            {
+                //
+                // Registers written after the reset have to go out even if
+                // they match the pre-reset value, so the reset ends the batch.
+                //
+                status = CodecCoreFlush(Core);
+                CodecCoreInvalidateCache(Core);
+            }
+            break;
+
+        case CodecOperationPoll:
+            status = CodecCorePoll(Core, command);
+            break;
+
+        case CodecOperationDelay:
+            status = CodecCoreFlush(Core);
+            if (NT_SUCCESS(status))
+            {
+                Sleep(command->TimeoutMs);
+            }
+            break;
+
+        default:
+            NT_ASSERT(FALSE);
+            status = STATUS_INVALID_PARAMETER;
+            break;
+        }
+
+        if (!NT_SUCCESS(status))
+        {
+            //
+            // What was written is unknown, don't trust the cache anymore.
+            //
+            Core->TransferCount = 0;
+            Core->BatchBytes = 0;
+            CodecCoreInvalidateCache(Core);
+            return status;
+        }
+    }
+
+    status = CodecCoreFlush(Core);
+    if (!NT_SUCCESS(status))
+    {
+        CodecCoreInvalidateCache(Core);
+    }
+
+    return status;
+}
+
+NTSTATUS
+CodecCoreRestore(
+    _Inout_ PCODEC_CORE Core
+    )
+/*++
+
+Routine Description:
+
+    Brings the codec back to its cached state after it lost it: runs the
+    configured restore commands, then writes back, in ascending register
+    order, each cached register the restore commands did not leave at its
+    cached value. Volatile registers are not part of the image.
+
+--*/
+{
+    ULONG i;
+    NTSTATUS status;
+    ULONG cacheCount = Core->CacheCount;
+    CODEC_CORE_CACHE_ENTRY cache[CODEC_CORE_CACHE_SIZE];
+
+    CopyMemory(cache, Core->Cache, cacheCount * sizeof(cache[0]));
+
+    //
+    // The codec no longer holds the cached values, so none of the restore
+    // commands may be skipped.
+    //
+    CodecCoreInvalidateCache(Core);
+
+    if (Core->Config.NumRestoreCommands != 0)
+    {
+        status = CodecCoreSendCommands(Core,
+                                       Core->Config.RestoreCommands,
+                                       Core->Config.NumRestoreCommands);
+        if (!NT_SUCCESS(status))
+        {
+            return status;
+        }
+    }
+
+    for (i = 0; i < cacheCount; i++)
+    {
+        BOOLEAN found;
+        ULONG index = CodecCoreCacheFind(Core, cache[i].Register, &found);
+
+        if (found && (Core->Cache[index].Value == cache[i].Value))
+        {
+            Core->WritesSkipped++;
+            continue;
+        }
+
+        status = CodecCoreQueueWrite(Core, cache[i].Register, cache[i].Value);
+        if (!NT_SUCCESS(status))
+        {
+            Core->TransferCount = 0;
+            Core->BatchBytes = 0;
+            CodecCoreInvalidateCache(Core);
+            return status;
+        }
+
+        CodecCoreCacheUpdate(Core, cache[i].Register, cache[i].Value);
+    }
+
+    status = CodecCoreFlush(Core);
+    if (!NT_SUCCESS(status))
+    {
+        CodecCoreInvalidateCache(Core);
+    }
+
+    TraceEvents(TRACE_LEVEL_INFORMATION, TRACE_DEVICE,
+        "Codec restore: %u registers, %u writes sent, %u skipped, %u sequences %!STATUS!",
+        cacheCount, Core->WritesSent, Core->WritesSkipped, Core->SequencesSent, status);
+
+    return status;
+}
@@ -0,0 +1,168 @@
+/* Copyright (c) Microsoft Corporation. All rights reserved.
+   Licensed under the MIT License.
+
+Module Name:
+
+    CodecCore.h
+
+Abstract:
+
+    Register access shared by the codec drivers. Register writes go through
+    a cache of the last value written to each register so that redundant
+    writes are skipped and the register image can be written back on resume
+    without reading the codec. Writes are coalesced into a single
+    IOCTL_SPB_EXECUTE_SEQUENCE request, with runs of consecutive registers
+    sent as one transfer on codecs that auto-increment the register address.
+
+Environment:
+
+    User-mode Driver Framework 2
+
+*/
+#pragma once
+
+#include <spb.h>
+
+EXTERN_C_START
+
+//
+// Number of distinct registers the cache can hold.
+//
+#define CODEC_CORE_CACHE_SIZE           64
+
+//
+// Limits of a single IOCTL_SPB_EXECUTE_SEQUENCE request. A batch is sent as
+// soon as either is reached.
+//
+#define CODEC_CORE_MAX_TRANSFERS        32
+#define CODEC_CORE_MAX_BATCH_BYTES      256
+
+typedef enum _CODEC_REGISTER_FORMAT {
+    //
+    // 16-bit register address followed by 16-bit data, big endian
+    // (WM8962, SGTL5000).
+    //
+    CodecRegisterFormatA16D16,
+
+    //
+    // 7-bit register address and 9-bit data packed in two bytes, write only
+    // (WM8731).
+    //
+    CodecRegisterFormatA7D9,
+} CODEC_REGISTER_FORMAT;
+
+typedef enum _CODEC_OPERATION {
+    CodecOperationWrite,            // Cached write, skipped if unchanged
+    CodecOperationWriteVolatile,    // Always written, never cached (triggers)
+    CodecOperationReset,            // Always written, invalidates the cache
+    CodecOperationPoll,             // Wait until (Register & Mask) == Value
+    CodecOperationDelay,            // Fixed delay of TimeoutMs
+} CODEC_OPERATION;
+
+typedef struct _CODEC_REGISTER_COMMAND {
+    CODEC_OPERATION Operation;
+    USHORT Register;
+    USHORT Value;
+    USHORT Mask;
+    DWORD TimeoutMs;
+} CODEC_REGISTER_COMMAND, *PCODEC_REGISTER_COMMAND;
+
+#define CODEC_WRITE(reg, value) \
+    { CodecOperationWrite, (USHORT)(reg), (USHORT)(value), 0, 0 }
+
+#define CODEC_WRITE_VOLATILE(reg, value) \
+    { CodecOperationWriteVolatile, (USHORT)(reg), (USHORT)(value), 0, 0 }
+
+#define CODEC_RESET(reg, value) \
+    { CodecOperationReset, (USHORT)(reg), (USHORT)(value), 0, 0 }
+
+#define CODEC_POLL(reg, mask, value, timeoutMs) \
+    { CodecOperationPoll, (USHORT)(reg), (USHORT)(value), (USHORT)(mask), (DWORD)(timeoutMs) }
+
+#define CODEC_DELAY(ms) \
+    { CodecOperationDelay, 0, 0, 0, (DWORD)(ms) }
+
+typedef struct _CODEC_CORE_CONFIG {
+    CODEC_REGISTER_FORMAT Format;
+
+    //
+    // Address step between consecutive registers when the codec
+    // auto-increments the register address during a multi-word write, or 0
+    // if it does not and every register needs its own transfer.
+    //
+    USHORT AutoIncrementStep;
+
+    //
+    // Commands CodecCoreRestore runs before it writes the cached registers
+    // back: the power up and write sequencer steps whose order matters and
+    // that a write back in register address order would not reproduce. NULL
+    // if the cached registers alone restore the codec.
+    //
+    const CODEC_REGISTER_COMMAND* RestoreCommands;
+    ULONG NumRestoreCommands;
+} CODEC_CORE_CONFIG;
+
+typedef struct _CODEC_CORE_CACHE_ENTRY {
+    USHORT Register;
+    USHORT Value;
+} CODEC_CORE_CACHE_ENTRY;
+
+typedef struct _CODEC_CORE {
+    WDFIOTARGET I2cTarget;
+    CODEC_CORE_CONFIG Config;
+
+    //
+    // Last value written to each register, sorted by register address.
+    //
+    ULONG CacheCount;
+    CODEC_CORE_CACHE_ENTRY Cache[CODEC_CORE_CACHE_SIZE];
+
+    //
+    // Pending batch of writes, flushed as one SPB sequence.
+    //
+    ULONG TransferCount;
+    ULONG BatchBytes;
+    USHORT LastRegister;
+    SPB_TRANSFER_LIST_AND_ENTRIES(CODEC_CORE_MAX_TRANSFERS) TransferList;
+    UCHAR Batch[CODEC_CORE_MAX_BATCH_BYTES];
+
+    //
+    // Statistics
+    //
+    ULONG WritesSkipped;
+    ULONG WritesSent;
+    ULONG SequencesSent;
+} CODEC_CORE, *PCODEC_CORE;
+
+VOID
+CodecCoreInitialize(
+    _Out_ PCODEC_CORE Core,
+    _In_ WDFIOTARGET I2cTarget,
+    _In_ const CODEC_CORE_CONFIG* Config
+    );
+
+NTSTATUS
+CodecCoreSendCommands(
+    _Inout_ PCODEC_CORE Core,
+    _In_reads_(NumCommands) const CODEC_REGISTER_COMMAND Commands[],
+    ULONG NumCommands
+    );
+
+NTSTATUS
+CodecCoreReadRegister(
+    _Inout_ PCODEC_CORE Core,
+    USHORT Register,
+    _Out_ USHORT* Value
+    );
+
+NTSTATUS
+CodecCoreRestore(
+    _Inout_ PCODEC_CORE Core
+    );
+
+VOID
+CodecCoreInvalidateCache(
+    _Inout_ PCODEC_CORE Core
+    );
+
+EXTERN_C_END
@@ -52,6 +52,7 @@ Return Value:
     WDF_PNPPOWER_EVENT_CALLBACKS callbacks;
     WDF_PNPPOWER_EVENT_CALLBACKS_INIT(&callbacks);
     callbacks.EvtDevicePrepareHardware = EvtWm8962DevicePrepareHardware;
+    callbacks.EvtDeviceD0Entry = EvtSgtl5000DeviceD0Entry;
     WdfDeviceInitSetPnpPowerEventCallbacks(DeviceInit, &callbacks);
 
     WDF_OBJECT_ATTRIBUTES_INIT_CONTEXT_TYPE(&deviceAttributes, DEVICE_CONTEXT);
@@ -199,3 +200,24 @@ EvtWm8962DevicePrepareHardware(
 	return status;
 }
 
+NTSTATUS
+EvtSgtl5000DeviceD0Entry(
+    _In_ WDFDEVICE              Device,
+    _In_ WDF_POWER_DEVICE_STATE PreviousState
+    )
+{
+    PDEVICE_CONTEXT deviceContext;
+
+    //
+    // The codec was initialized by PrepareHardware on the first power up.
+    // On resume put back the state it may have lost while powered down.
+    //
+    if (PreviousState == WdfPowerDeviceD3Final)
+    {
+        return STATUS_SUCCESS;
+    }
+
+    deviceContext = DeviceGetContext(Device);
+
+    return CodecResume(deviceContext);
+}
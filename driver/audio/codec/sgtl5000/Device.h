@@ -22,6 +22,8 @@ Environment:
 
 #include <reshub.h>
 
+#include "CodecCore.h"
+
 EXTERN_C_START
 
 //
@@ -32,6 +34,7 @@ typedef struct _DEVICE_CONTEXT
 {   
 	LARGE_INTEGER I2cConnectionId; 
     WDFIOTARGET   I2cTarget;
+    CODEC_CORE    Codec;
     
 } DEVICE_CONTEXT, *PDEVICE_CONTEXT;
 
@@ -51,6 +54,7 @@ Sgtl5000CodecCreateDevice(
     );
 
 EVT_WDF_DEVICE_PREPARE_HARDWARE EvtWm8962DevicePrepareHardware;
+EVT_WDF_DEVICE_D0_ENTRY EvtSgtl5000DeviceD0Entry;
 
 
 EXTERN_C_END
@@ -50,6 +50,7 @@ Return Value:
     WDF_PNPPOWER_EVENT_CALLBACKS callbacks;
     WDF_PNPPOWER_EVENT_CALLBACKS_INIT(&callbacks);
     callbacks.EvtDevicePrepareHardware = EvtWm8731LDevicePrepareHardware;
+    callbacks.EvtDeviceD0Entry = EvtWm8731LDeviceD0Entry;
     WdfDeviceInitSetPnpPowerEventCallbacks(DeviceInit, &callbacks);
 
     WDF_OBJECT_ATTRIBUTES_INIT_CONTEXT_TYPE(&deviceAttributes, DEVICE_CONTEXT);
@@ -190,3 +191,24 @@ EvtWm8731LDevicePrepareHardware(
    return status;
 }
 
+NTSTATUS
+EvtWm8731LDeviceD0Entry(
+    _In_ WDFDEVICE              Device,
+    _In_ WDF_POWER_DEVICE_STATE PreviousState
+    )
+{
+    PDEVICE_CONTEXT deviceContext;
+
+    //
+    // The codec was initialized by PrepareHardware on the first power up.
+    // On resume put back the state it may have lost while powered down.
+    //
+    if (PreviousState == WdfPowerDeviceD3Final)
+    {
+        return STATUS_SUCCESS;
+    }
+
+    deviceContext = DeviceGetContext(Device);
+
+    return CodecResume(deviceContext);
+}
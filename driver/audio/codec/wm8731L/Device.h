@@ -22,6 +22,8 @@ Environment:
 
 #include <reshub.h>
 
+#include "CodecCore.h"
+
 EXTERN_C_START
 
 //
@@ -32,6 +34,7 @@ typedef struct _DEVICE_CONTEXT
 {   
 	LARGE_INTEGER I2cConnectionId; 
     WDFIOTARGET   I2cTarget;
+    CODEC_CORE    Codec;
     
 } DEVICE_CONTEXT, *PDEVICE_CONTEXT;
 
@@ -51,6 +54,7 @@ Wm8731LCodecCreateDevice(
     );
 
 EVT_WDF_DEVICE_PREPARE_HARDWARE EvtWm8731LDevicePrepareHardware;
+EVT_WDF_DEVICE_D0_ENTRY EvtWm8731LDeviceD0Entry;
 
 
 EXTERN_C_END
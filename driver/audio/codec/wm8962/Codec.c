@@ -13,98 +13,84 @@ Environment:
 
 #include "Driver.h"
 #include "Codec.h"
-#include <spb.h>
 #include "codec.tmh"
 
 #define CODEC_I2C_ADDR  (0x1a)
 
-typedef struct {
-    DWORD MsSleepTime;
-    UCHAR CommandBytes[4];
-} CODEC_COMMAND, *PCODEC_COMMAND;
-
-NTSTATUS
-CodecSendCommands(
-    _In_ PDEVICE_CONTEXT DeviceContext,
-    _In_reads_(NumCommands) CODEC_COMMAND CodecCommand[],
-    USHORT NumCommands
-    );
-
-NTSTATUS
-CodecSendCommand(
-    _In_ PDEVICE_CONTEXT DeviceContext,
-    _In_ PCODEC_COMMAND CodecCommand
-    );
+//
+// R90 (5Ah) Write Sequencer Control 2 starts a sequence, R93 (5Dh) Write
+// Sequencer Control 3 reports WSEQ_BUSY while it runs.
+//
+#define WM8962_WSEQ_CONTROL_2           0x5a
+#define WM8962_WSEQ_CONTROL_3           0x5d
+#define WM8962_WSEQ_BUSY                0x0001
+#define WM8962_WSEQ_TIMEOUT_MS          500
+
+//
+// Clocking and input selection the write sequencer depends on, then the
+// sequences themselves. The power up state comes from the sequencer, so
+// these steps also have to run before the cached registers are written
+// back on resume.
+//
+static const CODEC_REGISTER_COMMAND PowerUpCommands[] =
+{
+    CODEC_WRITE(0x08, 0x0820),  // R8 - Clocking2. Set codec to use external clock.
+    CODEC_WRITE(0x1b, 0x0000),  // R27 - Additional control 3. Set the sample rate to 44.1 kHz.
+    CODEC_WRITE(0x26, 0x0013),  // R38 - Right input PGA control - select IN3R/IN4R as the inputs to the input PGA.
+    CODEC_WRITE(0x57, 0x00a0),  // R87 - Write Sequencer Control 1 - enable the sequencer.
+    CODEC_WRITE_VOLATILE(WM8962_WSEQ_CONTROL_2, 0x0080),
+                                // R90 - Write Sequencer Control 2 - run the 'DAC to Headphone Power Up' sequence.
+    CODEC_POLL(WM8962_WSEQ_CONTROL_3, WM8962_WSEQ_BUSY, 0, WM8962_WSEQ_TIMEOUT_MS),
+    CODEC_WRITE_VOLATILE(WM8962_WSEQ_CONTROL_2, 0x0092),
+                                // R90 - Write Sequencer Control 2 - run the 'Analogue Input Power Up' sequence.
+    CODEC_POLL(WM8962_WSEQ_CONTROL_3, WM8962_WSEQ_BUSY, 0, WM8962_WSEQ_TIMEOUT_MS),
+};
+
+static const CODEC_CORE_CONFIG CodecConfig =
+{
+    CodecRegisterFormatA16D16,
+    0,                              // No register address auto-increment
+    PowerUpCommands,
+    ARRAYSIZE(PowerUpCommands),
+};
 
 NTSTATUS
 CodecInitializeHeadphoneOutJack(
     _In_ PDEVICE_CONTEXT DeviceContext
     )
 {
-    CODEC_COMMAND Commands[] =
-    {   
-        { 0,    0x00, 0x08, 0x08, 0x20 },  // R8 - Clocking2. Set codec to use external clock.
-        { 0,    0x00, 0x1b, 0x00, 0x00 },  // R27 - Additional control 3. Set the sample rate to 44.1 kHz.
-        { 0,    0x00, 0x26, 0x00, 0x13 },  // R38 - Right input PGA control - select IN3R/IN4R as the inputs to the input PGA.
-        { 0,    0x00, 0x57, 0x00, 0xa0 },  // R87 - Write Sequencer Control 1 - enable the sequencer.
-        { 100,  0x00, 0x5a, 0x00, 0x80 },  // R90 - Write Sequencer Control 1 - run the 'DAC to Headphone Power Up' sequence.
-        { 100,  0x00, 0x5a, 0x00, 0x92 },  // R90 - Write Sequencer Control 1 - run the 'Analogue Input Power Up' sequence.
-        { 0,    0x00, 0x07, 0x00, 0x0e },  // R7 - Audio interface 0 - set word length to 32 bit. CAUTION: this gets reset by the
-                                           // 'DAC to Headphone Power Up' sequence.
-        { 0,    0x00, 0x01, 0x01, 0x1f },  // R1 - Mic right volume - Set the right mic channel to max volume.
-        { 0,    0x00, 0x02, 0x01, 0xff },  // R2 - HPOUTL volume - Set the left headphone channel to max volume.
-        { 0,    0x00, 0x03, 0x01, 0xff },  // R3 - HPOUTR volume - Set the right headphone channel to max volume.
+    static const CODEC_REGISTER_COMMAND Commands[] =
+    {
+        CODEC_WRITE(0x07, 0x000e),  // R7 - Audio interface 0 - set word length to 32 bit. CAUTION: this gets reset by the
+                                    // 'DAC to Headphone Power Up' sequence.
+        CODEC_WRITE(0x01, 0x011f),  // R1 - Mic right volume - Set the right mic channel to max volume.
+        CODEC_WRITE(0x02, 0x01ff),  // R2 - HPOUTL volume - Set the left headphone channel to max volume.
+        CODEC_WRITE(0x03, 0x01ff),  // R3 - HPOUTR volume - Set the right headphone channel to max volume.
     };
 
     NTSTATUS status;
 
-    status = CodecSendCommands(DeviceContext, Commands, ARRAYSIZE(Commands));
-
-    return status;
-}
-
-NTSTATUS
-CodecSendCommand(
-    _In_ PDEVICE_CONTEXT DeviceContext,
-    _In_ PCODEC_COMMAND CodecCommand
-    )
-{
-    NTSTATUS status;
-
-    ULONG_PTR bytesWritten;
-    
-    WDF_MEMORY_DESCRIPTOR MemDescriptor;
-
-    WDF_MEMORY_DESCRIPTOR_INIT_BUFFER(&MemDescriptor,&CodecCommand->CommandBytes[0], sizeof(CodecCommand->CommandBytes));
+    CodecCoreInitialize(&DeviceContext->Codec, DeviceContext->I2cTarget, &CodecConfig);
 
-    status = WdfIoTargetSendWriteSynchronously(DeviceContext->I2cTarget, NULL, &MemDescriptor, 0, NULL, &bytesWritten);
-    
-    if (CodecCommand->MsSleepTime != 0)
+    status = CodecCoreSendCommands(&DeviceContext->Codec, PowerUpCommands, ARRAYSIZE(PowerUpCommands));
+    if (!NT_SUCCESS(status))
     {
-        Sleep(CodecCommand->MsSleepTime);
+        return status;
     }
 
+    status = CodecCoreSendCommands(&DeviceContext->Codec, Commands, ARRAYSIZE(Commands));
+
     return status;
 }
 
 NTSTATUS
-CodecSendCommands(
-    _In_ PDEVICE_CONTEXT DeviceContext,
-    _In_reads_(NumCommands) CODEC_COMMAND CodecCommand[],
-    USHORT NumCommands
+CodecResume(
+    _In_ PDEVICE_CONTEXT DeviceContext
     )
 {
-    ULONG i;
-    NTSTATUS status;
-
-    for (i = 0; i < NumCommands; i++)
-    {
-        status = CodecSendCommand(DeviceContext, &CodecCommand[i]);
-
-        if (!NT_SUCCESS(status))
-        {
-            return status;
-        }
-    }
-    return STATUS_SUCCESS;
+    //
+    // The power up sequences run first, then the cached registers are
+    // written back, which puts R7 back after the sequencer reset it.
+    //
+    return CodecCoreRestore(&DeviceContext->Codec);
 }
@@ -18,4 +18,9 @@ Environment:
 NTSTATUS
 CodecInitializeHeadphoneOutJack(
     _In_ PDEVICE_CONTEXT DeviceContext
-    );
\ No newline at end of file
+    );
+
+NTSTATUS
+CodecResume(
+    _In_ PDEVICE_CONTEXT DeviceContext
+    );
@@ -828,6 +828,18 @@ Note:
     //
     if (NewState.DeviceState != m_PowerState)
     {
+        // Snapshot the SAI when leaving D0 and replay it when coming back,
+        // instead of rebuilding its configuration.
+        //
+        if (m_PowerState == PowerDeviceD0)
+        {
+            m_Soc.SaveState();
+        }
+        else if (NewState.DeviceState == PowerDeviceD0)
+        {
+            m_Soc.RestoreState();
+        }
+
         // switch on new state
         //
         switch (NewState.DeviceState)
@@ -2229,7 +2241,24 @@ CAdapterCommon::StartDma
     _In_        CMiniportWaveRTStream* Stream
 )
 {
-    return m_Soc.StartDma(Stream);
+    NTSTATUS ntStatus;
+    ULONGLONG latencyUs;
+    BOOLEAN fromSnapshot;
+
+    ntStatus = m_Soc.StartDma(Stream);
+
+    // Spew an event for the first rendered samples after a resume
+    // Event type: eMINIPORT_IHV_DEFINED
+    // Parameter 1: Microseconds from D0 entry to the first samples in the Tx FIFO
+    // Parameter 2: 1 if the SAI was restored from its D3 snapshot, 0 if reconfigured
+    // Parameter 3: 0
+    // Parameter 4: 0
+    if (m_Soc.QueryResumeLatency(&latencyUs, &fromSnapshot))
+    {
+        WriteEtwEvent(eMINIPORT_IHV_DEFINED, latencyUs, fromSnapshot, 0, 0);
+    }
+
+    return ntStatus;
 }
 
 NTSTATUS
@@ -225,9 +225,9 @@ CSoc::UnregisterStream
     return STATUS_SUCCESS;
 }
 
-#pragma code_seg("PAGE")
-NTSTATUS
-CSoc::SetupClocks()
+#pragma code_seg()
+VOID
+CSoc::ConfigureSai()
 {
     SAI_TRANSMIT_CONFIGURATION_REGISTER_1 TransmitConfigReg1;
     SAI_RECEIVE_CONFIGURATION_REGISTER_1 ReceiveConfigReg1;
@@ -243,11 +243,6 @@ CSoc::SetupClocks()
     SAI_TRANSMIT_MASK_REGISTER TransmitMaskRegister;
     SAI_RECEIVE_MASK_REGISTER ReceiveMaskRegister;
 
-    IO_CONNECT_INTERRUPT_PARAMETERS parameters;
-    NTSTATUS status;
-
-    PAGED_CODE();
-
     //
     // Reset SAI controller
     //
@@ -373,6 +368,18 @@ CSoc::SetupClocks()
 
     WRITE_REGISTER_ULONG(&m_pSaiRegisters->TransmitMaskRegister.AsUlong, TransmitMaskRegister.AsUlong);
     WRITE_REGISTER_ULONG(&m_pSaiRegisters->ReceiveMaskRegister.AsUlong, ReceiveMaskRegister.AsUlong);
+}
+
+#pragma code_seg("PAGE")
+NTSTATUS
+CSoc::SetupClocks()
+{
+    IO_CONNECT_INTERRUPT_PARAMETERS parameters;
+    NTSTATUS status;
+
+    PAGED_CODE();
+
+    ConfigureSai();
 
     ASSERT(m_pDescriptor);
 
@@ -401,6 +408,153 @@ CSoc::SetupClocks()
     return status;
 }
 
+#pragma code_seg()
+static
+ULONG
+SaiStateCrc32
+(
+    _In_reads_bytes_(Length) const VOID* Buffer,
+                             ULONG Length
+)
+{
+    const UCHAR* bytes = static_cast<const UCHAR*>(Buffer);
+    ULONG crc = 0xFFFFFFFF;
+
+    for (ULONG i = 0; i < Length; i++)
+    {
+        crc ^= bytes[i];
+        for (ULONG bit = 0; bit < 8; bit++)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+
+    return ~crc;
+}
+
+#pragma code_seg()
+VOID
+CSoc::SaveState()
+/*++
+
+Routine Description:
+
+    Snapshots the SAI configuration registers on D3 entry so that D0 entry
+    can write them back in one pass instead of rebuilding the configuration.
+    PortCls has stopped or paused all streams at this point.
+
+--*/
+{
+    SAI_STATE_SNAPSHOT* snapshot = &m_SaiSnapshot;
+
+    snapshot->TransmitConfig[0] = READ_REGISTER_ULONG(&m_pSaiRegisters->TransmitConfigRegister1.AsUlong);
+    snapshot->TransmitConfig[1] = READ_REGISTER_ULONG(&m_pSaiRegisters->TransmitConfigRegister2.AsUlong);
+    snapshot->TransmitConfig[2] = READ_REGISTER_ULONG(&m_pSaiRegisters->TransmitConfigRegister3.AsUlong);
+    snapshot->TransmitConfig[3] = READ_REGISTER_ULONG(&m_pSaiRegisters->TransmitConfigRegister4.AsUlong);
+    snapshot->TransmitConfig[4] = READ_REGISTER_ULONG(&m_pSaiRegisters->TransmitConfigRegister5.AsUlong);
+    snapshot->ReceiveConfig[0] = READ_REGISTER_ULONG(&m_pSaiRegisters->ReceiveConfigRegister1.AsUlong);
+    snapshot->ReceiveConfig[1] = READ_REGISTER_ULONG(&m_pSaiRegisters->ReceiveConfigRegister2.AsUlong);
+    snapshot->ReceiveConfig[2] = READ_REGISTER_ULONG(&m_pSaiRegisters->ReceiveConfigRegister3.AsUlong);
+    snapshot->ReceiveConfig[3] = READ_REGISTER_ULONG(&m_pSaiRegisters->ReceiveConfigRegister4.AsUlong);
+    snapshot->ReceiveConfig[4] = READ_REGISTER_ULONG(&m_pSaiRegisters->ReceiveConfigRegister5.AsUlong);
+    snapshot->TransmitMask = READ_REGISTER_ULONG(&m_pSaiRegisters->TransmitMaskRegister.AsUlong);
+    snapshot->ReceiveMask = READ_REGISTER_ULONG(&m_pSaiRegisters->ReceiveMaskRegister.AsUlong);
+
+#ifdef _ARM64_
+    // Self-clearing FIFO reset bits must not be written back.
+    SAI_TRANSMIT_CONFIGURATION_REGISTER_3 TransmitConfigReg3;
+
+    TransmitConfigReg3.AsUlong = snapshot->TransmitConfig[2];
+    TransmitConfigReg3.ChannelFifoReset = 0;
+    snapshot->TransmitConfig[2] = TransmitConfigReg3.AsUlong;
+#endif
+
+    snapshot->Crc = SaiStateCrc32(snapshot, FIELD_OFFSET(SAI_STATE_SNAPSHOT, Crc));
+    m_bSaiSnapshotValid = TRUE;
+}
+
+#pragma code_seg()
+VOID
+CSoc::RestoreState()
+/*++
+
+Routine Description:
+
+    Brings the SAI back on D0 entry. The D3 snapshot is written back as is
+    when its CRC matches, otherwise the configuration is rebuilt from
+    scratch. The resume time is recorded to measure the latency to the
+    first rendered sample.
+
+--*/
+{
+    SAI_STATE_SNAPSHOT* snapshot = &m_SaiSnapshot;
+
+    m_ResumeTimestamp = KeQueryPerformanceCounter(NULL);
+
+    m_bResumedFromSnapshot =
+        m_bSaiSnapshotValid &&
+        (SaiStateCrc32(snapshot, FIELD_OFFSET(SAI_STATE_SNAPSHOT, Crc)) == snapshot->Crc);
+
+    if (!m_bResumedFromSnapshot)
+    {
+        DPF(D_TERSE, ("[CSoc::RestoreState] No valid SAI snapshot, reconfiguring"));
+
+        ConfigureSai();
+    }
+    else
+    {
+        TxSoftwareReset();
+        RxSoftwareReset();
+
+        WRITE_REGISTER_ULONG(&m_pSaiRegisters->TransmitConfigRegister1.AsUlong, snapshot->TransmitConfig[0]);
+        WRITE_REGISTER_ULONG(&m_pSaiRegisters->TransmitConfigRegister2.AsUlong, snapshot->TransmitConfig[1]);
+        WRITE_REGISTER_ULONG(&m_pSaiRegisters->TransmitConfigRegister3.AsUlong, snapshot->TransmitConfig[2]);
+        WRITE_REGISTER_ULONG(&m_pSaiRegisters->TransmitConfigRegister4.AsUlong, snapshot->TransmitConfig[3]);
+        WRITE_REGISTER_ULONG(&m_pSaiRegisters->TransmitConfigRegister5.AsUlong, snapshot->TransmitConfig[4]);
+        WRITE_REGISTER_ULONG(&m_pSaiRegisters->ReceiveConfigRegister1.AsUlong, snapshot->ReceiveConfig[0]);
+        WRITE_REGISTER_ULONG(&m_pSaiRegisters->ReceiveConfigRegister2.AsUlong, snapshot->ReceiveConfig[1]);
+        WRITE_REGISTER_ULONG(&m_pSaiRegisters->ReceiveConfigRegister3.AsUlong, snapshot->ReceiveConfig[2]);
+        WRITE_REGISTER_ULONG(&m_pSaiRegisters->ReceiveConfigRegister4.AsUlong, snapshot->ReceiveConfig[3]);
+        WRITE_REGISTER_ULONG(&m_pSaiRegisters->ReceiveConfigRegister5.AsUlong, snapshot->ReceiveConfig[4]);
+        WRITE_REGISTER_ULONG(&m_pSaiRegisters->TransmitMaskRegister.AsUlong, snapshot->TransmitMask);
+        WRITE_REGISTER_ULONG(&m_pSaiRegisters->ReceiveMaskRegister.AsUlong, snapshot->ReceiveMask);
+    }
+
+    m_bSaiSnapshotValid = FALSE;
+
+    EnableInterrupts();
+}
+
+#pragma code_seg()
+BOOLEAN
+CSoc::QueryResumeLatency
+(
+    _Out_ ULONGLONG* LatencyUs,
+    _Out_ BOOLEAN* FromSnapshot
+)
+/*++
+
+Routine Description:
+
+    Returns, once per resume, the time from D0 entry until the first
+    samples were written to the transmit FIFO.
+
+--*/
+{
+    if (m_ResumeLatencyUs == 0)
+    {
+        *LatencyUs = 0;
+        *FromSnapshot = FALSE;
+        return FALSE;
+    }
+
+    *LatencyUs = m_ResumeLatencyUs;
+    *FromSnapshot = m_bResumedFromSnapshot;
+    m_ResumeLatencyUs = 0;
+
+    return TRUE;
+}
+
 #pragma code_seg()
 VOID
 CSoc::DisableInterruptsNoLock()
@@ -549,6 +703,20 @@ CSoc::StartDma
         m_Buffer[eSpeakerHpDevice].ResetTxFifo();
         m_Buffer[eSpeakerHpDevice].FillFifos();
 
+        if (m_ResumeTimestamp.QuadPart != 0)
+        {
+            LARGE_INTEGER frequency;
+            LARGE_INTEGER now = KeQueryPerformanceCounter(&frequency);
+
+            m_ResumeLatencyUs =
+                (ULONGLONG(now.QuadPart - m_ResumeTimestamp.QuadPart) * 1000000) / frequency.QuadPart;
+            if (m_ResumeLatencyUs == 0)
+            {
+                m_ResumeLatencyUs = 1;  // 0 means no measurement pending
+            }
+            m_ResumeTimestamp.QuadPart = 0;
+        }
+
         TransmitControlRegister.AsUlong = READ_REGISTER_ULONG(&m_pSaiRegisters->TransmitControlRegister.AsUlong);
         TransmitControlRegister.TransmitterEnable = 1;
         WRITE_REGISTER_ULONG(&m_pSaiRegisters->TransmitControlRegister.AsUlong, TransmitControlRegister.AsUlong);
@@ -14,6 +14,19 @@ Abstract:
 
 class CSoc;
 
+//
+// SAI configuration registers saved on D3 entry and written back on D0
+// entry. Crc covers every field before it.
+//
+typedef struct _SAI_STATE_SNAPSHOT
+{
+    ULONG TransmitConfig[5];
+    ULONG ReceiveConfig[5];
+    ULONG TransmitMask;
+    ULONG ReceiveMask;
+    ULONG Crc;
+} SAI_STATE_SNAPSHOT;
+
 class CDmaBuffer
 {
 public:
@@ -133,6 +146,16 @@ public:
         _In_        CMiniportWaveRTStream* Stream
     );
 
+    VOID SaveState();
+
+    VOID RestoreState();
+
+    BOOLEAN QueryResumeLatency
+    (
+        _Out_ ULONGLONG* LatencyUs,
+        _Out_ BOOLEAN* FromSnapshot
+    );
+
 private:
 
     CDmaBuffer m_Buffer[eMaxDeviceType];
@@ -147,8 +170,16 @@ private:
     PKINTERRUPT                         m_pInterruptObject;
     static KSERVICE_ROUTINE             ISR;
 
+    SAI_STATE_SNAPSHOT                  m_SaiSnapshot;
+    BOOLEAN                             m_bSaiSnapshotValid;
+    BOOLEAN                             m_bResumedFromSnapshot;
+    LARGE_INTEGER                       m_ResumeTimestamp;
+    ULONGLONG                           m_ResumeLatencyUs;
+
     NTSTATUS SetupClocks();
 
+    VOID ConfigureSai();
+
     VOID DisableInterrupts();
     VOID EnableInterrupts();
 
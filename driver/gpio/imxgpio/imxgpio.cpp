@@ -21,6 +21,7 @@
 
 #include <ImxCpuRev.h>
 #include "imxutility.hpp"
+#include "imxgpiocapture.h"
 #include "imxgpio.hpp"
 
 #include "imx6sx.hpp"
@@ -391,11 +392,23 @@ NTSTATUS IMX_GPIO::QueryActiveInterrupts (
         static_cast<ULONG>(QueryActiveParametersPtr->EnabledMask) & READ_REGISTER_NOFENCE_ULONG(&bank->InterruptStatus));
 #endif
 
+    const ULONG pinShift = getPhysicalPinShift(QueryActiveParametersPtr->BankId);
+    ULONG activeMask =
+        READ_REGISTER_NOFENCE_ULONG(&bank->InterruptStatus) &
+        READ_REGISTER_NOFENCE_ULONG(&bank->InterruptMask) &
+        (0x0FFFF << pinShift);
+
+    // Edges on capture pins are recorded and acknowledged here, and only
+    // reach GpioClx once a pin has accumulated its batch of edges
+    const ULONG captureMask = activeMask & thisPtr->banksCaptureMask[bankId];
+    if (captureMask != 0) {
+        activeMask &= ~captureMask;
+        activeMask |= thisPtr->captureEdges(bankId, captureMask);
+    } // if
+
     // need to shift output results depending on bank ID.
     QueryActiveParametersPtr->ActiveMask = static_cast<ULONG64>(
-        (READ_REGISTER_NOFENCE_ULONG(&bank->InterruptStatus) &
-         READ_REGISTER_NOFENCE_ULONG(&bank->InterruptMask))
-        >> getPhysicalPinShift(QueryActiveParametersPtr->BankId)) & 0x0FFFF;
+        activeMask >> pinShift) & 0x0FFFF;
 
     return STATUS_SUCCESS;
 } // IMX_GPIO::QueryActiveInterrupts (...)
@@ -619,6 +632,7 @@ NTSTATUS IMX_GPIO::StartController (
         WRITE_REGISTER_NOFENCE_ULONG(&bank->InterruptMask, 0);
         WRITE_REGISTER_NOFENCE_ULONG(&bank->InterruptConfig1, 0);
         WRITE_REGISTER_NOFENCE_ULONG(&bank->InterruptConfig2, 0);
+        WRITE_REGISTER_NOFENCE_ULONG(&bank->EdgeSelect, thisPtr->banksEdgeSelectReg[bankId]);
         WRITE_REGISTER_NOFENCE_ULONG(&bank->InterruptStatus, 0xFFFFFFFF);   // clear all interrupts
     } // for (ULONG bankId = ...)
 
@@ -786,6 +800,15 @@ NTSTATUS IMX_GPIO::DisableInterrupt (
         WRITE_REGISTER_NOFENCE_ULONG(&bank->InterruptMask, *bankIMR);
         WRITE_REGISTER_NOFENCE_ULONG(&bank->InterruptStatus, mask);
 
+        // capture does not outlive the interrupt connection
+        if ((thisPtr->banksCaptureMask[bankId] & mask) != 0) {
+            (void)InterlockedAnd(&thisPtr->banksCaptureMask[bankId], ~mask);
+            (void)InterlockedAnd(&thisPtr->banksEdgeSelectReg[bankId], ~mask);
+            WRITE_REGISTER_NOFENCE_ULONG(
+                &bank->EdgeSelect,
+                thisPtr->banksEdgeSelectReg[bankId]);
+        } // if
+
         // No need to configure the disabled interrupt to some state,
         // it will be reconfigured properly next time before enabled
 
@@ -822,6 +845,312 @@ NTSTATUS IMX_GPIO::DisableInterrupt (
     return STATUS_SUCCESS;
 } // IMX_GPIO::DisableInterrupt (...)
 
+_Use_decl_annotations_
+NTSTATUS IMX_GPIO::ControllerSpecificFunction (
+    PVOID ContextPtr,
+    PGPIO_CLIENT_CONTROLLER_SPECIFIC_FUNCTION_PARAMETERS ParametersPtr
+    )
+{
+    IMX_ASSERT_MAX_IRQL(PASSIVE_LEVEL);
+
+    LogEnter();
+
+    auto thisPtr = static_cast<IMX_GPIO*>(ContextPtr);
+
+    ParametersPtr->BytesReturned = 0;
+
+    if ((ParametersPtr->InputBuffer == nullptr) ||
+        (ParametersPtr->InputBufferLength < sizeof(IMX_GPIO_CAPTURE_INPUT))) {
+
+        LogError("Capture input buffer too small");
+        return STATUS_BUFFER_TOO_SMALL;
+    }
+
+    // input and output may share the same system buffer, capture the input
+    // before anything is written back
+    const IMX_GPIO_CAPTURE_INPUT input =
+        *static_cast<const IMX_GPIO_CAPTURE_INPUT*>(ParametersPtr->InputBuffer);
+
+    if ((input.PinNumber >= pinCount) || !thisPtr->isPinMapped(input.PinNumber)) {
+        LogError("Invalid capture pin#%u", input.PinNumber);
+        return STATUS_INVALID_PARAMETER;
+    }
+
+    // GpioClx does not pass the connection to ControllerSpecificFunction,
+    // so the request cannot be tied to the connection that holds the pin.
+    // Only require that some GpioIo connection holds it: any client with a
+    // connection to this controller can use capture on any held pin
+    const BANK_ID bankId = input.PinNumber / IMX_GPIO_PINS_PER_BANK;
+    const ULONG mask = 1 << (input.PinNumber % IMX_GPIO_PINS_PER_BANK);
+    if ((thisPtr->openIoPins[bankId] & mask) == 0) {
+        LogError("Capture pin#%u is not held by an open connection", input.PinNumber);
+        return STATUS_INVALID_PARAMETER;
+    }
+
+    if ((input.Flags & ~IMX_GPIO_CAPTURE_FLAGS_VALID) != 0) {
+        LogError("Invalid capture flags 0x%x", input.Flags);
+        return STATUS_INVALID_PARAMETER;
+    }
+
+    switch (input.Function) {
+    case IMX_GPIO_CAPTURE_FUNCTION_ENABLE:
+        return thisPtr->enableCapture(input);
+
+    case IMX_GPIO_CAPTURE_FUNCTION_DISABLE:
+        return thisPtr->disableCapture(input.PinNumber);
+
+    case IMX_GPIO_CAPTURE_FUNCTION_READ:
+        if (ParametersPtr->OutputBuffer == nullptr) {
+            return STATUS_BUFFER_TOO_SMALL;
+        }
+
+        return thisPtr->readCapture(
+            input.PinNumber,
+            static_cast<IMX_GPIO_CAPTURE_READ_OUTPUT*>(ParametersPtr->OutputBuffer),
+            ParametersPtr->OutputBufferLength,
+            &ParametersPtr->BytesReturned);
+
+    default:
+        LogError("Invalid capture function %u", input.Function);
+        return STATUS_INVALID_PARAMETER;
+    } // switch (input.Function)
+} // IMX_GPIO::ControllerSpecificFunction (...)
+
+// Records one edge for every pin in CaptureMask and returns the subset of
+// pins whose batch is complete and should be reported to GpioClx.
+// Called from QueryActiveInterrupts at DIRQL with the bank interrupt lock held.
+ULONG IMX_GPIO::captureEdges (
+    BANK_ID BankId,
+    ULONG CaptureMask
+    )
+{
+    IMX_GPIO_BANK_REGISTERS* const bank = gpioBankAddr[BankId];
+    const LARGE_INTEGER timestamp = KeQueryPerformanceCounter(nullptr);
+
+    // acknowledge before sampling the pad so that a following edge is
+    // latched again instead of being lost
+    WRITE_REGISTER_NOFENCE_ULONG(&bank->InterruptStatus, CaptureMask);
+    const ULONG padStatus = READ_REGISTER_NOFENCE_ULONG(&bank->PadStatus);
+
+    ULONG notifyMask = 0;
+    ULONG pending = CaptureMask;
+    while (pending != 0) {
+        ULONG bankPinNumber;
+        (void)_BitScanForward(&bankPinNumber, pending);
+        const ULONG mask = 1 << bankPinNumber;
+        pending &= ~mask;
+
+        _CAPTURE_RING* const ring = captureRings[IMX_MAKE_PIN_0(BankId, bankPinNumber)];
+        NT_ASSERT(ring != nullptr);
+
+        const ULONG head = ring->Head;
+        const ULONG tail = static_cast<ULONG>(
+            ReadAcquire(reinterpret_cast<volatile LONG*>(&ring->Tail)));
+        const ULONG sequence = ring->Sequence++;
+
+        if ((head - tail) >= IMX_GPIO_CAPTURE_RING_LENGTH) {
+            (void)InterlockedIncrement(
+                reinterpret_cast<volatile LONG*>(&ring->DroppedCount));
+        } else {
+            IMX_GPIO_CAPTURE_ENTRY* const entryPtr =
+                &ring->Entries[head & (IMX_GPIO_CAPTURE_RING_LENGTH - 1)];
+
+            entryPtr->Timestamp = timestamp;
+            entryPtr->Sequence = sequence;
+            entryPtr->Level = (padStatus >> bankPinNumber) & 1;
+
+            // publish the entry before the new head
+            WriteRelease(reinterpret_cast<volatile LONG*>(&ring->Head), head + 1);
+        } // iff
+
+        if ((ring->Head - ring->ReportedHead) >= ring->BatchThreshold) {
+            ring->ReportedHead = ring->Head;
+            notifyMask |= mask;
+        } // if
+    } // while (pending != 0)
+
+    return notifyMask;
+} // IMX_GPIO::captureEdges (...)
+
+NTSTATUS IMX_GPIO::enableCapture (
+    const IMX_GPIO_CAPTURE_INPUT& Input
+    )
+{
+    IMX_ASSERT_MAX_IRQL(PASSIVE_LEVEL);
+
+    const ULONG absolutePinNumber = Input.PinNumber;
+    const BANK_ID bankId = absolutePinNumber / IMX_GPIO_PINS_PER_BANK;
+    const PIN_NUMBER bankPinNumber = absolutePinNumber % IMX_GPIO_PINS_PER_BANK;
+    const ULONG mask = 1 << bankPinNumber;
+    IMX_GPIO_BANK_REGISTERS* const bank = gpioBankAddr[bankId];
+
+    if ((openInterruptPins[bankId] & mask) == 0) {
+        LogError("Pin#%u is not connected as an interrupt", absolutePinNumber);
+        return STATUS_INVALID_DEVICE_STATE;
+    }
+
+    // capture only makes sense on edge triggered interrupts
+    const ULONG icr = (bankPinNumber < 16) ?
+        banksInterruptConfig[bankId].ICR1 : banksInterruptConfig[bankId].ICR2;
+    const ULONG interruptConfig =
+        (icr >> ((bankPinNumber % 16) * 2)) & IMX_GPIO_INTERRUPT_CONFIG_MASK;
+
+    if ((interruptConfig != IMX_GPIO_INTERRUPT_CONFIG_RISING_EDGE) &&
+        (interruptConfig != IMX_GPIO_INTERRUPT_CONFIG_FALLING_EDGE)) {
+
+        LogError("Pin#%u is not edge triggered", absolutePinNumber);
+        return STATUS_NOT_SUPPORTED;
+    }
+
+    _CAPTURE_RING* ring = captureRings[absolutePinNumber];
+    if (ring == nullptr) {
+        ring = static_cast<_CAPTURE_RING*>(ExAllocatePoolWithTag(
+            NonPagedPoolNx,
+            sizeof(_CAPTURE_RING),
+            IMX_GPIO_ALLOC_TAG));
+        if (ring == nullptr) {
+            LogError("Failed to allocate capture ring for pin#%u", absolutePinNumber);
+            return STATUS_INSUFFICIENT_RESOURCES;
+        }
+
+        RtlZeroMemory(ring, sizeof(_CAPTURE_RING));
+        captureRings[absolutePinNumber] = ring;
+    } // if
+
+    ULONG batchThreshold = Input.BatchThreshold;
+    if (batchThreshold == 0) {
+        batchThreshold = 1;
+    } else if (batchThreshold > IMX_GPIO_CAPTURE_RING_LENGTH) {
+        batchThreshold = IMX_GPIO_CAPTURE_RING_LENGTH;
+    } // iff
+
+    {
+        // synchronize with the ISR of the logical bank owning the pin
+        INTERRUPT_BANK_LOCK lock(this, (bankId * 2) + (bankPinNumber / 16));
+
+        if ((banksCaptureMask[bankId] & mask) == 0) {
+            ring->Head = 0;
+            ring->Tail = 0;
+            ring->DroppedCount = 0;
+            ring->Sequence = 0;
+        } // if
+
+        ring->BatchThreshold = batchThreshold;
+        ring->ReportedHead = ring->Head;
+
+        if ((Input.Flags & IMX_GPIO_CAPTURE_FLAG_BOTH_EDGES) != 0) {
+            (void)InterlockedOr(&banksEdgeSelectReg[bankId], mask);
+        } else {
+            (void)InterlockedAnd(&banksEdgeSelectReg[bankId], ~mask);
+        } // iff
+
+        WRITE_REGISTER_NOFENCE_ULONG(&bank->EdgeSelect, banksEdgeSelectReg[bankId]);
+        WRITE_REGISTER_NOFENCE_ULONG(&bank->InterruptStatus, mask);
+
+        (void)InterlockedOr(&banksCaptureMask[bankId], mask);
+    } // release lock
+
+    LogInfo(
+        "Capture enabled on pin#%u, BatchThreshold=%u, Flags=0x%x",
+        absolutePinNumber,
+        batchThreshold,
+        Input.Flags);
+
+    return STATUS_SUCCESS;
+} // IMX_GPIO::enableCapture (...)
+
+NTSTATUS IMX_GPIO::disableCapture (
+    ULONG AbsolutePinNumber
+    )
+{
+    IMX_ASSERT_MAX_IRQL(PASSIVE_LEVEL);
+
+    const BANK_ID bankId = AbsolutePinNumber / IMX_GPIO_PINS_PER_BANK;
+    const PIN_NUMBER bankPinNumber = AbsolutePinNumber % IMX_GPIO_PINS_PER_BANK;
+    const ULONG mask = 1 << bankPinNumber;
+    IMX_GPIO_BANK_REGISTERS* const bank = gpioBankAddr[bankId];
+
+    if ((banksCaptureMask[bankId] & mask) == 0) {
+        return STATUS_SUCCESS;
+    }
+
+    {
+        INTERRUPT_BANK_LOCK lock(this, (bankId * 2) + (bankPinNumber / 16));
+
+        (void)InterlockedAnd(&banksCaptureMask[bankId], ~mask);
+        (void)InterlockedAnd(&banksEdgeSelectReg[bankId], ~mask);
+        WRITE_REGISTER_NOFENCE_ULONG(&bank->EdgeSelect, banksEdgeSelectReg[bankId]);
+    } // release lock
+
+    LogInfo("Capture disabled on pin#%u", AbsolutePinNumber);
+
+    return STATUS_SUCCESS;
+} // IMX_GPIO::disableCapture (...)
+
+_Use_decl_annotations_
+NTSTATUS IMX_GPIO::readCapture (
+    ULONG AbsolutePinNumber,
+    IMX_GPIO_CAPTURE_READ_OUTPUT* OutputPtr,
+    SIZE_T OutputBufferLength,
+    SIZE_T* BytesReturnedPtr
+    )
+{
+    IMX_ASSERT_MAX_IRQL(PASSIVE_LEVEL);
+
+    *BytesReturnedPtr = 0;
+
+    const BANK_ID bankId = AbsolutePinNumber / IMX_GPIO_PINS_PER_BANK;
+    const ULONG mask = 1 << (AbsolutePinNumber % IMX_GPIO_PINS_PER_BANK);
+    _CAPTURE_RING* const ring = captureRings[AbsolutePinNumber];
+
+    if ((ring == nullptr) || ((banksCaptureMask[bankId] & mask) == 0)) {
+        LogError("Capture is not enabled on pin#%u", AbsolutePinNumber);
+        return STATUS_INVALID_DEVICE_STATE;
+    }
+
+    if (OutputBufferLength < FIELD_OFFSET(IMX_GPIO_CAPTURE_READ_OUTPUT, Entries)) {
+        return STATUS_BUFFER_TOO_SMALL;
+    }
+
+    // the ring has a single consumer, concurrent readers are turned away
+    if (InterlockedCompareExchange(&ring->ReaderActive, 1, 0) != 0) {
+        return STATUS_DEVICE_BUSY;
+    }
+
+    const SIZE_T capacity =
+        (OutputBufferLength - FIELD_OFFSET(IMX_GPIO_CAPTURE_READ_OUTPUT, Entries)) /
+        sizeof(IMX_GPIO_CAPTURE_ENTRY);
+
+    ULONG tail = ring->Tail;
+    const ULONG head = static_cast<ULONG>(
+        ReadAcquire(reinterpret_cast<volatile LONG*>(&ring->Head)));
+
+    ULONG count = 0;
+    while ((tail != head) && (count < capacity)) {
+        OutputPtr->Entries[count] =
+            ring->Entries[tail & (IMX_GPIO_CAPTURE_RING_LENGTH - 1)];
+        ++tail;
+        ++count;
+    } // while (...)
+
+    // release the slots only after they have been copied out
+    WriteRelease(reinterpret_cast<volatile LONG*>(&ring->Tail), tail);
+
+    (void)KeQueryPerformanceCounter(&OutputPtr->Frequency);
+    OutputPtr->DroppedCount = static_cast<ULONG>(InterlockedExchange(
+        reinterpret_cast<volatile LONG*>(&ring->DroppedCount),
+        0));
+    OutputPtr->EntryCount = count;
+
+    (void)InterlockedExchange(&ring->ReaderActive, 0);
+
+    *BytesReturnedPtr =
+        FIELD_OFFSET(IMX_GPIO_CAPTURE_READ_OUTPUT, Entries) +
+        (count * sizeof(IMX_GPIO_CAPTURE_ENTRY));
+
+    return STATUS_SUCCESS;
+} // IMX_GPIO::readCapture (...)
+
 // Resets the pin pull up, muxing function and input select registers of the
 // selected pin to the HW defaults. It releases ownership of any input select
 // registers. It cannot ensure that the InputSelect of the default muxing value
@@ -1528,6 +1857,7 @@ NTSTATUS IMX_GPIO::PrepareController (
                 WRITE_REGISTER_NOFENCE_ULONG(&bank->InterruptConfig1, 0);
                 WRITE_REGISTER_NOFENCE_ULONG(&bank->InterruptConfig2, 0);
                 WRITE_REGISTER_NOFENCE_ULONG(&bank->InterruptMask, 0);
+                WRITE_REGISTER_NOFENCE_ULONG(&bank->EdgeSelect, 0);
                 WRITE_REGISTER_NOFENCE_ULONG(&bank->InterruptStatus, 0xffffffff);
             }
 
@@ -1777,6 +2107,7 @@ NTSTATUS IMX_GPIO::readDeviceProperties (
     IMX_ASSERT_LOW_IRQL();
 
     ACPI_EVAL_OUTPUT_BUFFER UNALIGNED* dsdBufferPtr = nullptr;
+    ACPI_DEVICE_PROPERTIES_INDEX* devicePropertiesIndexPtr = nullptr;
     UINT32 socType;
     NTSTATUS status;
 
@@ -1786,15 +2117,14 @@ NTSTATUS IMX_GPIO::readDeviceProperties (
         goto Cleanup;
     }
 
-    const ACPI_METHOD_ARGUMENT UNALIGNED* devicePropertiesPkgPtr;
-    status = AcpiParseDsdAsDeviceProperties(dsdBufferPtr, &devicePropertiesPkgPtr);
+    status = AcpiParseDsdAsDeviceProperties(dsdBufferPtr, &devicePropertiesIndexPtr);
     if (!NT_SUCCESS(status)) {
         LogError("AcpiParseSdsAsDeviceProperties failed with error %!STATUS!", status);
         goto Cleanup;
     }
 
     status = AcpiDevicePropertiesQueryIntegerValue(
-            devicePropertiesPkgPtr,
+            devicePropertiesIndexPtr,
             "SocType",
             &socType);
     if (!NT_SUCCESS(status)) {
@@ -1808,6 +2138,10 @@ NTSTATUS IMX_GPIO::readDeviceProperties (
 
 Cleanup:
 
+    if (devicePropertiesIndexPtr != nullptr) {
+        AcpiDevicePropertiesFreeIndex(devicePropertiesIndexPtr);
+    }
+
     if (dsdBufferPtr != nullptr) {
         ExFreePoolWithTag(dsdBufferPtr, ACPI_TAG_EVAL_OUTPUT_BUFFER);
     }
@@ -1968,6 +2302,9 @@ IMX_GPIO::IMX_GPIO (
     banksDataReg{},
     banksDirectionReg{},
     banksInterruptConfig{},
+    banksEdgeSelectReg{},
+    banksCaptureMask{},
+    captureRings{},
     wdfDevice(WDF_NO_HANDLE),
     openIoPins{},
     openInterruptPins{},
@@ -2008,6 +2345,13 @@ IMX_GPIO::~IMX_GPIO ()
     NT_ASSERT(iomuxcRegsPtr);
     NT_ASSERT(iomuxcRegsLength);
 
+    for (ULONG pin = 0; pin < IMX_GPIO_PINCOUNT_MAX; ++pin) {
+        if (captureRings[pin]) {
+            ExFreePoolWithTag(captureRings[pin], IMX_GPIO_ALLOC_TAG);
+            captureRings[pin] = nullptr;
+        }
+    }
+
     for (ULONG bankId = 0; bankId < IMX_GPIO_BANKCOUNT_MAX; ++bankId) {
         if (gpioBankAddr[bankId]) {
             MmUnmapIoSpace(gpioBankAddr[bankId], IMX_GPIO_BYTES_PER_BANK);   
@@ -2112,7 +2456,7 @@ NTSTATUS DriverEntry (
         nullptr,    // CLIENT_SaveBankHardwareContext
         nullptr,    // CLIENT_RestoreBankHardwareContext
         nullptr,    // CLIENT_PreProcessControllerInterrupt
-        nullptr,    // CLIENT_ControllerSpecificFunction
+        IMX_GPIO::ControllerSpecificFunction,
         IMX_GPIO::ReconfigureInterrupt,
         IMX_GPIO::QueryEnabledInterrupts,
         IMX_GPIO::ConnectFunctionConfigPins,
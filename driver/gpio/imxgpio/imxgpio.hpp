@@ -212,6 +212,8 @@ public: // NONPAGED
     static GPIO_CLIENT_ENABLE_INTERRUPT EnableInterrupt;
     static GPIO_CLIENT_DISABLE_INTERRUPT DisableInterrupt;
 
+    static GPIO_CLIENT_CONTROLLER_SPECIFIC_FUNCTION ControllerSpecificFunction;
+
 private: // NONPAGED
 
     enum class _SIGNATURE {
@@ -233,6 +235,26 @@ private: // NONPAGED
         ULONG IMR;
     }; // struct _BANK_INTERRUPT_CONFIG_REGISTERS
 
+    //
+    // Single producer (bank ISR) / single consumer (capture READ) ring of
+    // timestamped edges. Head and Tail are free running and only ever
+    // written by their owning side.
+    //
+    struct _CAPTURE_RING {
+        volatile ULONG Head;
+        volatile ULONG Tail;
+        volatile ULONG DroppedCount;
+        volatile LONG ReaderActive;
+        ULONG Sequence;
+        ULONG BatchThreshold;
+        ULONG ReportedHead;
+        IMX_GPIO_CAPTURE_ENTRY Entries[IMX_GPIO_CAPTURE_RING_LENGTH];
+    }; // struct _CAPTURE_RING
+
+    static_assert(
+        (IMX_GPIO_CAPTURE_RING_LENGTH & (IMX_GPIO_CAPTURE_RING_LENGTH - 1)) == 0,
+        "Capture ring length must be a power of 2");
+
     static NTSTATUS GpioPullModeToImxPullMode(
         UCHAR pullConfiguration,
         IMX_GPIO_PULL *pullMode
@@ -248,6 +270,26 @@ private: // NONPAGED
         ULONG AbsolutePinNumber
         );
 
+    ULONG captureEdges (
+        BANK_ID BankId,
+        ULONG CaptureMask
+        );
+
+    NTSTATUS enableCapture (
+        const IMX_GPIO_CAPTURE_INPUT& Input
+        );
+
+    NTSTATUS disableCapture (
+        ULONG AbsolutePinNumber
+        );
+
+    NTSTATUS readCapture (
+        ULONG AbsolutePinNumber,
+        _Out_writes_bytes_(OutputBufferLength) IMX_GPIO_CAPTURE_READ_OUTPUT* OutputPtr,
+        SIZE_T OutputBufferLength,
+        _Out_ SIZE_T* BytesReturnedPtr
+        );
+
     NTSTATUS setPullMode (
         ULONG AbsolutePinNumber,
         IMX_GPIO_PULL PullMode
@@ -317,6 +359,12 @@ private: // NONPAGED
     ULONG banksDataReg[IMX_GPIO_BANKCOUNT_MAX];
     ULONG banksDirectionReg[IMX_GPIO_BANKCOUNT_MAX];
     _BANK_INTERRUPT_CONFIG_REGISTERS banksInterruptConfig[IMX_GPIO_BANKCOUNT_MAX];
+    ULONG banksEdgeSelectReg[IMX_GPIO_BANKCOUNT_MAX];
+
+    // edge capture state, rings are allocated on first enable and kept
+    // until the controller is released so the ISR never sees a stale pointer
+    ULONG banksCaptureMask[IMX_GPIO_BANKCOUNT_MAX];
+    _CAPTURE_RING* captureRings[IMX_GPIO_PINCOUNT_MAX];
 
     WDFDEVICE wdfDevice;
 
@@ -0,0 +1,86 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+//
+// Module Name:
+//
+//   imxgpiocapture.h
+//
+// Abstract:
+//
+//   Edge capture interface of the i.MX GPIO controller driver. Requests are
+//   sent through IOCTL_GPIO_CONTROLLER_SPECIFIC_FUNCTION on a GPIO connection
+//   and are dispatched by GpioClx to IMX_GPIO::ControllerSpecificFunction.
+//
+//   When capture is enabled on an edge-triggered interrupt pin, the bank ISR
+//   records every edge of the pin into a per-pin ring buffer together with a
+//   performance counter timestamp (backed by the GPT on i.MX6), and the edge
+//   is only reported to GpioClx once BatchThreshold edges have accumulated.
+//   The client drains the ring with IMX_GPIO_CAPTURE_FUNCTION_READ.
+//
+// Environment:
+//
+//   User and kernel mode
+//
+
+#ifndef _IMXGPIOCAPTURE_H_
+#define _IMXGPIOCAPTURE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+//
+// Number of edges a pin's capture ring can hold before edges are dropped.
+//
+#define IMX_GPIO_CAPTURE_RING_LENGTH 256
+
+enum IMX_GPIO_CAPTURE_FUNCTION {
+    IMX_GPIO_CAPTURE_FUNCTION_ENABLE = 1,
+    IMX_GPIO_CAPTURE_FUNCTION_DISABLE,
+    IMX_GPIO_CAPTURE_FUNCTION_READ,
+};
+
+//
+// Capture on both rising and falling edges using GPIOx_EDGE_SEL, regardless
+// of the polarity the interrupt was connected with.
+//
+#define IMX_GPIO_CAPTURE_FLAG_BOTH_EDGES 0x00000001
+
+#define IMX_GPIO_CAPTURE_FLAGS_VALID IMX_GPIO_CAPTURE_FLAG_BOTH_EDGES
+
+//
+// PinNumber should be the pin of the GpioIo connection the request is sent
+// on, but GpioClx does not tell the driver which connection that is, so this
+// is not enforced: a request on any connection to the controller may name
+// any pin that is held by an open GpioIo connection. Requests for a pin
+// without an open connection, or with other Flags bits set, fail with
+// STATUS_INVALID_PARAMETER. Capture is therefore only as private as the
+// controller's connections, which must all belong to trusted clients.
+//
+typedef struct _IMX_GPIO_CAPTURE_INPUT {
+    ULONG Function;         // IMX_GPIO_CAPTURE_FUNCTION
+    ULONG PinNumber;        // Absolute pin number, ((bank - 1) * 32) + io
+    ULONG Flags;            // IMX_GPIO_CAPTURE_FLAG_*, ENABLE only
+    ULONG BatchThreshold;   // Edges per interrupt delivered to GpioClx, ENABLE only
+} IMX_GPIO_CAPTURE_INPUT;
+
+typedef struct _IMX_GPIO_CAPTURE_ENTRY {
+    LARGE_INTEGER Timestamp;    // KeQueryPerformanceCounter() at ISR time
+    ULONG Sequence;             // Free running edge counter, gaps mean drops
+    ULONG Level;                // Pad level (GPIOx_PSR) sampled at ISR time
+} IMX_GPIO_CAPTURE_ENTRY;
+
+typedef struct _IMX_GPIO_CAPTURE_READ_OUTPUT {
+    LARGE_INTEGER Frequency;    // Timestamp ticks per second
+    ULONG DroppedCount;         // Edges dropped since the previous READ
+    ULONG EntryCount;
+    IMX_GPIO_CAPTURE_ENTRY Entries[ANYSIZE_ARRAY];
+} IMX_GPIO_CAPTURE_READ_OUTPUT;
+
+#ifdef __cplusplus
+} // extern "C"
+#endif // __cplusplus
+
+#endif // _IMXGPIOCAPTURE_H_
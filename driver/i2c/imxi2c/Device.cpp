@@ -18,6 +18,7 @@ Environment:
 #include "imxi2cinternal.h"
 #include "imxi2cdevice.h"
 #include "imxi2ccontroller.h"
+#include "imxi2cioctl.h"
 #include <devpkey.h>
 #include "device.tmh"
 
@@ -883,6 +884,15 @@ VOID OnOtherInCallerContext(
     // otherwise mark as STATUS_NOT_SUPPORTED and complete.
     //
 
+    // IOCTLs with a plain buffered output are enqueued as they are.
+
+    if (fxParams.Parameters.DeviceIoControl.IoControlCode ==
+        IOCTL_IMXI2C_GET_CONNECTION_SPEED) {
+
+        status = WdfDeviceEnqueueRequest(SpbController, Request);
+        goto exit;
+    }
+
     // For custom IOCTLs that use the SPB transfer list format
     // (i.e. sequence formatting), call SpbRequestCaptureIoOtherTransferList
     // so that the driver can leverage other SPB DDIs for this request.
@@ -957,30 +967,47 @@ VOID OnOther(
     NTSTATUS status = STATUS_SUCCESS;
 
     UNREFERENCED_PARAMETER(SpbController);
-    UNREFERENCED_PARAMETER(SpbTarget);
-    UNREFERENCED_PARAMETER(SpbRequest);
     UNREFERENCED_PARAMETER(OutputBufferLength);
     UNREFERENCED_PARAMETER(InputBufferLength);
-    UNREFERENCED_PARAMETER(IoControlCode);
 
-    //
-    // Option: the driver may take the following steps
-    //
-    //    1. Verify this specific DeviceIoContol code is supported,
-    //       otherwise mark as STATUS_NOT_SUPPORTED and complete.
-    //
-    //    2. If this IOCTL uses SPB_TRANSFER_LIST and the driver has
-    //       called SpbRequestCaptureIoOtherTransferList previously,
-    //       validate the request format. The driver can make use of
-    //       SpbRequestGetTransferParameters to retrieve each transfer
-    //       descriptor.
-    //
-    //       If this IOCTL uses some proprietary buffer formating
-    //       instead of SPB_TRANSFER_LIST, validate appropriately.
-    //
-    //    3. Setup the device, target, and request contexts as necessary,
-    //       and program the hardware for the transfer.
-    //
+    switch (IoControlCode) {
+    case IOCTL_IMXI2C_GET_CONNECTION_SPEED:
+    {
+        PPBC_TARGET targetPtr = GetTargetContext(SpbTarget);
+        IMXI2C_GET_CONNECTION_SPEED_OUTPUT* outputPtr;
+
+        status = WdfRequestRetrieveOutputBuffer((WDFREQUEST)SpbRequest,
+                                                sizeof(*outputPtr),
+                                                (PVOID*)&outputPtr,
+                                                NULL);
+
+        if (!NT_SUCCESS(status)) {
+
+            TraceEvents(TRACE_LEVEL_ERROR, TRACE_DEVICE,
+                "Output buffer too small for connection speed of"
+                " SpbTarget %p - Err=%Xh",
+                SpbTarget, status);
+            break;
+        }
+
+        outputPtr->ConnectionSpeedHz = targetPtr->Settings.ConnectionSpeed;
+        outputPtr->EffectiveConnectionSpeedHz =
+            targetPtr->Settings.EffectiveConnectionSpeed;
+
+        WdfRequestSetInformation((WDFREQUEST)SpbRequest, sizeof(*outputPtr));
+        break;
+    }
+
+    default:
+
+        // No other custom IOCTL is supported
+
+        status = STATUS_NOT_SUPPORTED;
+        TraceEvents(TRACE_LEVEL_ERROR, TRACE_DEVICE,
+            "Unsupported IOCTL %Xh for SpbRequest %p - Err=%Xh",
+            IoControlCode, SpbRequest, status);
+        break;
+    }
 
     SpbRequestComplete(SpbRequest, status);
 
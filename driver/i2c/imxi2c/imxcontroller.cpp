@@ -21,6 +21,7 @@ Revision History:
 #include "imxi2cinternal.h"
 #include "imxi2ccontroller.h"
 #include "imxi2cdevice.h"
+#include "imxi2cdivider.h"
 
 #include "imxcontroller.tmh"
 
@@ -34,21 +35,6 @@ const PBC_TRANSFER_SETTINGS g_TransferSettings[] =
     {BusConditionBusy,      FALSE,   TRUE}   // SpbRequestTypeLast
 };
 
-// fixed clock divider ratios as per Freescale IMX6 programming manual
-// note: only selected fixed I2C clock frequecnies are supported.
-
-static const USHORT I2C_Clock_Rate_Dividers_Table[] =
-{
-    30,  32,  36,  42,  48,  52,  60,  72,   80,   88,  104,  128,  144,  160,  192,  240,
-    288, 320, 384, 480, 576, 640, 768, 960, 1152, 1280, 1536, 1920, 2304, 2560, 3072, 3840,
-    22,  24,  26,  28,  32,  36,  40,  44,   48,   56,   64,   72,   80,   96,  112,  128,
-    160, 192, 224, 256, 320, 384, 448, 512,  640,  768,  896, 1024, 1280, 1536, 1792, 2048
-};
-
-#define I2C_DIV_TAB_SIZE (sizeof(I2C_Clock_Rate_Dividers_Table)/sizeof(I2C_Clock_Rate_Dividers_Table[0]))
-#define I2C_MAXDIVIDER 3840
-#define I2C_MINDIVIDER 22
-
 /*++
 
   Routine Description:
@@ -118,16 +104,16 @@ NTSTATUS ControllerInitialize(PDEVICE_CONTEXT DeviceCtxPtr)
 
   Routine Description:
 
-    This routine finds best fit clock divider for given i2c clock speed in kHz
+    This routine programs the clock divider for given i2c clock speed in Hz
 
   Arguments:
 
     DeviceCtxPtr - a pointer to device context
-    DesiredClockFrequencyHz - desired bus clock frequency in kHz
+    DesiredClockFrequencyHz - desired bus clock frequency in Hz
 
   Return Value:
 
-    status_success if it was possible to find close enough divider in the table
+    status_success if the requested speed is supported
     error if not
 
 --*/
@@ -138,9 +124,8 @@ NTSTATUS SetControllerClockDiv(
     )
 {
     NTSTATUS status = STATUS_SUCCESS;
-    USHORT estimatedDivider = 0;
-    int iFirstRd = 0;
-    int iSecondRd = 0;
+    USHORT dividerIndex = 0;
+    ULONG effectiveClockFrequencyHz = 0;
     TraceEvents(TRACE_LEVEL_INFORMATION, TRACE_CTRLR,
                 "++SetControllerClockDiv(%lu Hz)",
                 DesiredClockFrequencyHz);
@@ -157,85 +142,17 @@ NTSTATUS SetControllerClockDiv(
         goto SetClockFreqDone;
     }
 
-    estimatedDivider=(USHORT)((DeviceCtxPtr->ModuleClock_kHz*1000) / DesiredClockFrequencyHz);
-
-    // round divider up
-
-    if((DeviceCtxPtr->ModuleClock_kHz * 1000 -
-        (DesiredClockFrequencyHz * estimatedDivider)) * 100 >
-            DeviceCtxPtr->ModuleClock_kHz * 1000) {
-
-        estimatedDivider += 1;
-    }
-
-    // now perform a search in imx6 table of dividers
-    // use left part of the table first
-
-    for(iFirstRd = 0; iFirstRd < (I2C_DIV_TAB_SIZE/2 - 1); iFirstRd++) {
-        // Once found a divider greater than the estimate, stop
-
-        if (estimatedDivider <= I2C_Clock_Rate_Dividers_Table[iFirstRd])
-            break;
-    }
-
-    if(estimatedDivider == I2C_Clock_Rate_Dividers_Table[iFirstRd]) {
-
-
-        // If the estimated divider matched one of the array entries, no need
-        // to search further
-
-        estimatedDivider = (USHORT)iFirstRd;
-    } else {
-        // look int the right part of the table
-
-        for (iSecondRd = (I2C_DIV_TAB_SIZE/2); iSecondRd < (I2C_DIV_TAB_SIZE-1); iSecondRd++)
-        {
-            // Again, if a greater entry is found, stop
-
-            if (estimatedDivider <= I2C_Clock_Rate_Dividers_Table[iSecondRd])
-                break;
-        }
-
-        if (estimatedDivider == I2C_Clock_Rate_Dividers_Table[iSecondRd]) {
-
-            // If the estimated divider is found in the second round, stop
-
-            estimatedDivider = (USHORT)iSecondRd;
-
-        } else {
-            // Search for the nearest divider among the 2 portion of the array
-
-            if ((I2C_Clock_Rate_Dividers_Table[iFirstRd] > estimatedDivider) &&
-                            (I2C_Clock_Rate_Dividers_Table[iSecondRd] > estimatedDivider)) {
-
-                if ((I2C_Clock_Rate_Dividers_Table[iFirstRd] - estimatedDivider) <
-                            (I2C_Clock_Rate_Dividers_Table[iSecondRd] - estimatedDivider)) {
-
-                    estimatedDivider = (USHORT)iFirstRd;
-
-                    } else {
-
-                    estimatedDivider = (USHORT)iSecondRd;
-                    }
-            } else {
-                if (I2C_Clock_Rate_Dividers_Table[iSecondRd] > estimatedDivider) {
-
-                    estimatedDivider = (USHORT)iSecondRd;
-                } else {
-                    // Less than setting, use I2CClockRateDividersTable[31] as default
-
-                    estimatedDivider = (USHORT)iFirstRd;
-                }
-            }
-        }
-    }
+    dividerIndex = ControllerFindClockDivider(DeviceCtxPtr->ModuleClock_kHz * 1000,
+                                              DesiredClockFrequencyHz,
+                                              &effectiveClockFrequencyHz);
 
     TraceEvents(TRACE_LEVEL_INFORMATION, TRACE_CTRLR,
-                "SetControllerClockDiv() divider: idx=%u, value=%u",
-                estimatedDivider,
-                I2C_Clock_Rate_Dividers_Table[estimatedDivider]);
+                "SetControllerClockDiv() divider: idx=%u, value=%u, SCL=%lu Hz",
+                dividerIndex,
+                I2C_Clock_Rate_Dividers_Table[dividerIndex],
+                effectiveClockFrequencyHz);
 
-    DeviceCtxPtr->RegistersPtr->FreqDivReg = estimatedDivider;
+    DeviceCtxPtr->RegistersPtr->FreqDivReg = dividerIndex;
 
     TraceEvents(TRACE_LEVEL_INFORMATION, TRACE_CTRLR,
                 "SetControllerClockDiv() ReqDiv Reg=%04Xh",
@@ -526,9 +443,9 @@ NTSTATUS ControllerTransferDataMultp(
 
     // the timeout value depends on i2c clock frequency
     // formula : timeout = 10/Fscl
-    // the minimum timeout for polling IIF bit is 25us at 400 kHz (period 2.5us x 10 )
+    // the minimum timeout for polling IIF bit is 10us at 1 MHz (period 1us x 10 )
 
-    timeoutMax = ( 10 * 1000000 ) / DeviceCtxPtr->CurrentTargetPtr->Settings.ConnectionSpeed;
+    timeoutMax = ( 10 * 1000000 ) / DeviceCtxPtr->CurrentTargetPtr->Settings.EffectiveConnectionSpeed;
 
     TraceEvents(TRACE_LEVEL_INFORMATION, TRACE_CTRLR,
                 "ControllerTransferDataMultp() timeout value=%lu us",
@@ -1149,7 +1066,7 @@ NTSTATUS ControllerGenerateStart(
     NTSTATUS status = STATUS_SUCCESS;
     TraceEvents(TRACE_LEVEL_INFORMATION, TRACE_CTRLR, "++ControllerGenerateStart()");
 
-    timeoutMax = ( 10 * 1000000 ) / DeviceCtxPtr->CurrentTargetPtr->Settings.ConnectionSpeed; // 100us at 100 kHz
+    timeoutMax = ( 10 * 1000000 ) / DeviceCtxPtr->CurrentTargetPtr->Settings.EffectiveConnectionSpeed; // 100us at 100 kHz
 
     // expect i2c bus be Not busy.
     // check if i2c bus is busy - wait until i2c bus becomes not busy
@@ -1327,7 +1244,7 @@ NTSTATUS ControllerGenerateRepeatedStart(
     NTSTATUS status = STATUS_SUCCESS;
     TraceEvents(TRACE_LEVEL_INFORMATION, TRACE_CTRLR, "++ControllerGenerateRepeatedStart()");
 
-    timeoutMax = ( 10 * 1000000 ) / DeviceCtxPtr->CurrentTargetPtr->Settings.ConnectionSpeed;
+    timeoutMax = ( 10 * 1000000 ) / DeviceCtxPtr->CurrentTargetPtr->Settings.EffectiveConnectionSpeed;
 
     // set RSTA bit
 
@@ -1451,7 +1368,7 @@ NTSTATUS ControllerGenerateStop(PDEVICE_CONTEXT DeviceCtxPtr)
 
     // Note: our default is ten*(10) clock cycles (e.g. 100us at 100 kHz).
 
-    timeoutMax = ( 10 * 1000000 ) / DeviceCtxPtr->CurrentTargetPtr->Settings.ConnectionSpeed;
+    timeoutMax = ( 10 * 1000000 ) / DeviceCtxPtr->CurrentTargetPtr->Settings.EffectiveConnectionSpeed;
 
     // bus must be busy to generate stop
 
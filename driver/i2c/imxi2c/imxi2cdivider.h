@@ -0,0 +1,108 @@
+/* Copyright (c) Microsoft Corporation. All rights reserved.
+   Licensed under the MIT License.
+
+Module Name:
+
+    imxi2cdivider.h
+
+Abstract:
+
+    This module contains the i.MX I2C clock divider (IFDR) table and the
+    search for the divider of a requested bus speed. It has no hardware
+    or framework dependencies, so it is also unit tested on the host
+    (test/imxi2cdividertest.cpp).
+
+Environment:
+
+    kernel-mode only
+
+*/
+
+#ifndef _IMXI2CDIVIDER_H_
+#define _IMXI2CDIVIDER_H_
+
+// fixed clock divider ratios as per Freescale IMX6 programming manual
+// note: only selected fixed I2C clock frequecnies are supported.
+
+static const USHORT I2C_Clock_Rate_Dividers_Table[] =
+{
+    30,  32,  36,  42,  48,  52,  60,  72,   80,   88,  104,  128,  144,  160,  192,  240,
+    288, 320, 384, 480, 576, 640, 768, 960, 1152, 1280, 1536, 1920, 2304, 2560, 3072, 3840,
+    22,  24,  26,  28,  32,  36,  40,  44,   48,   56,   64,   72,   80,   96,  112,  128,
+    160, 192, 224, 256, 320, 384, 448, 512,  640,  768,  896, 1024, 1280, 1536, 1792, 2048
+};
+
+#define I2C_DIV_TAB_SIZE (sizeof(I2C_Clock_Rate_Dividers_Table)/sizeof(I2C_Clock_Rate_Dividers_Table[0]))
+
+/*++
+
+  Routine Description:
+
+    This routine finds the clock divider that gives the fastest SCL
+    frequency not exceeding the requested bus speed. Both halves of the
+    divider table are searched, since they interleave. The routine has
+    no side effects.
+
+  Arguments:
+
+    ModuleClockHz - i2c module (IPG) clock frequency in Hz
+    MaxClockFrequencyHz - requested bus clock frequency in Hz
+    EffectiveClockFrequencyHzPtr - optional, receives the resulting
+        SCL frequency in Hz
+
+  Return Value:
+
+    IFDR value (index into divider table). If even the largest divider
+    exceeds the request, the largest divider is returned.
+
+--*/
+FORCEINLINE USHORT ControllerFindClockDivider(
+    _In_ ULONG ModuleClockHz,
+    _In_ ULONG MaxClockFrequencyHz,
+    _Out_opt_ ULONG* EffectiveClockFrequencyHzPtr
+    )
+{
+    USHORT bestIndex = 0;
+    ULONG bestDivider = 0;
+    ULONG maxIndex = 0;
+
+    for(ULONG i = 0; i < I2C_DIV_TAB_SIZE; i++) {
+
+        ULONG divider = I2C_Clock_Rate_Dividers_Table[i];
+
+        if(divider > I2C_Clock_Rate_Dividers_Table[maxIndex]) {
+
+            maxIndex = i;
+        }
+
+        // ModuleClockHz / divider <= MaxClockFrequencyHz, without rounding
+
+        if((ULONGLONG)divider * MaxClockFrequencyHz < ModuleClockHz) {
+
+            continue;
+        }
+
+        // keep the smallest qualifying divider, first index wins on ties
+
+        if((bestDivider == 0) || (divider < bestDivider)) {
+
+            bestDivider = divider;
+            bestIndex = (USHORT)i;
+        }
+    }
+
+    if(bestDivider == 0) {
+
+        bestDivider = I2C_Clock_Rate_Dividers_Table[maxIndex];
+        bestIndex = (USHORT)maxIndex;
+    }
+
+    if(EffectiveClockFrequencyHzPtr != NULL) {
+
+        *EffectiveClockFrequencyHzPtr = ModuleClockHz / bestDivider;
+    }
+
+    return bestIndex;
+}
+
+#endif // _IMXI2CDIVIDER_H_
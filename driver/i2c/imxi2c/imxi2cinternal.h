@@ -76,7 +76,7 @@ typedef struct _PNP_I2C_SERIAL_BUS_DESCRIPTOR {
 #define I2C_MAX_ADDRESS 0x7F
 
 #define IMX_I2C_MIN_CONNECTION_SPEED 100000 // min supported speed is 100 kHz on iMX6 Sabre
-#define IMX_I2C_MAX_CONNECTION_SPEED 400000 // max supported speed is 400 kHz
+#define IMX_I2C_MAX_CONNECTION_SPEED 1000000 // max supported speed is 1 MHz (Fast-mode Plus)
 
 // Settings.
 
@@ -125,6 +125,10 @@ typedef struct PBC_TARGET_SETTINGS {
     ADDRESS_MODE AddressMode;
     USHORT Address;
     ULONG ConnectionSpeed;
+
+    // SCL frequency actually produced by the clock divider for ConnectionSpeed
+
+    ULONG EffectiveConnectionSpeed;
 }
 PBC_TARGET_SETTINGS, *PPBC_TARGET_SETTINGS;
 
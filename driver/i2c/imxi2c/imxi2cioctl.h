@@ -0,0 +1,69 @@
+/* Copyright (c) Microsoft Corporation. All rights reserved.
+   Licensed under the MIT License.
+
+Module Name:
+
+    imxi2cioctl.h
+
+Abstract:
+
+    This module contains the i.MX specific IOCTLs of the I2C controller
+    driver. The IOCTLs are sent to a connection, that is, a handle to an
+    I2C peripheral opened through its SPB resource hub path.
+
+Environment:
+
+    Kernel-mode and user-mode.
+
+*/
+
+#include <winapifamily.h>
+
+#if WINAPI_FAMILY_PARTITION(WINAPI_PARTITION_DESKTOP)
+
+#if (NTDDI_VERSION >= NTDDI_WIN10)
+
+#ifdef _MSC_VER
+#pragma once
+#endif //_MSC_VER
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+//
+// IOCTL codes enumeration
+//
+enum {
+    // Connection IOCTLs
+    IMXI2C_IOCTL_ID_GET_CONNECTION_SPEED = 100,
+};
+
+//
+// IOCTL_IMXI2C_GET_CONNECTION_SPEED
+//
+// Returns the bus speed the connection requested in its I2C serial bus
+// descriptor, and the SCL frequency the controller actually runs at for
+// it. The controller uses the fastest clock divider that does not exceed
+// the requested speed, so the effective speed can be noticeably lower.
+//
+
+#define IOCTL_IMXI2C_GET_CONNECTION_SPEED \
+            CTL_CODE( \
+                FILE_DEVICE_CONTROLLER, \
+                IMXI2C_IOCTL_ID_GET_CONNECTION_SPEED, \
+                METHOD_BUFFERED, \
+                FILE_ANY_ACCESS)
+
+typedef struct _IMXI2C_GET_CONNECTION_SPEED_OUTPUT {
+    ULONG ConnectionSpeedHz;
+    ULONG EffectiveConnectionSpeedHz;
+} IMXI2C_GET_CONNECTION_SPEED_OUTPUT;
+
+#ifdef __cplusplus
+} // extern "C"
+#endif // __cplusplus
+
+#endif // NTDDI_VERSION >= NTDDI_WIN10
+
+#endif // WINAPI_FAMILY_PARTITION(WINAPI_PARTITION_DESKTOP)
@@ -18,6 +18,7 @@ Environment:
 #include "imxi2cinternal.h"
 #include "imxi2cdevice.h"
 #include "imxi2ccontroller.h"
+#include "imxi2cdivider.h"
 #include <devpkey.h>
 #include "pbcrequests.tmh"
 
@@ -153,12 +154,20 @@ NTSTATUS PbcTargetGetSettings(
 
     pSettings->ConnectionSpeed = i2cDescriptorPtr->ConnectionSpeed;
 
+    // bus runs at the fastest divider rate not exceeding the requested speed
+
+    (void)ControllerFindClockDivider(pDevice->ModuleClock_kHz * 1000,
+                                     pSettings->ConnectionSpeed,
+                                     &pSettings->EffectiveConnectionSpeed);
+
     TraceEvents(TRACE_LEVEL_INFORMATION, TRACE_DEVICE,
                 "Connected to SPBTARGET. (SpbTarget = %p, "
-                "targetPtr->Address = %04xh, targetPtr->ConnectionSpeed = %lu)",
+                "targetPtr->Address = %04xh, targetPtr->ConnectionSpeed = %lu, "
+                "effective SCL = %lu Hz)",
                 pSettings,
                 pSettings->Address,
-                pSettings->ConnectionSpeed);
+                pSettings->ConnectionSpeed,
+                pSettings->EffectiveConnectionSpeed);
 
 EndGetTargetSet:
     TraceEvents(TRACE_LEVEL_VERBOSE, TRACE_DEVICE, "--PbcTargetGetSettings()=%Xh", status);
@@ -0,0 +1,188 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// Module Name:
+//
+//   imxi2cdividertest.cpp
+//
+// Abstract:
+//
+//   Host test of the I2C clock divider search in imxi2cdivider.h. Checks
+//   the dividers picked for the standard bus speeds, and compares the
+//   search with a brute force over the divider table for every speed the
+//   driver accepts and several module clocks.
+//
+//   Build and run from the repository root:
+//
+//     c++ -std=c++14 -Wall -Wno-unknown-pragmas -I driver/shared/hosttest
+//         -I driver/i2c/imxi2c
+//         driver/i2c/imxi2c/test/imxi2cdividertest.cpp -o imxi2cdividertest
+//     ./imxi2cdividertest
+//
+// Environment:
+//
+//   User mode, host
+//
+
+#include "hosttest.h"
+#include "imxi2cdivider.h"
+
+namespace { // static
+
+//
+// Default IPG clock, as GetI2cConfigValues sets when the registry has none
+//
+const ULONG MODULE_CLOCK_HZ = 66000000;
+
+const ULONG MIN_CONNECTION_SPEED = 100000;
+const ULONG MAX_CONNECTION_SPEED = 1000000;
+
+ULONG sclHz (ULONG ModuleClockHz, USHORT Index)
+{
+    return ModuleClockHz / I2C_Clock_Rate_Dividers_Table[Index];
+}
+
+void testStandardSpeeds ()
+{
+    struct {
+        ULONG SpeedHz;
+        USHORT Divider;
+        ULONG EffectiveHz;
+    } static const expected[] = {
+        { 100000, 768, 85937 },     // Standard-mode
+        { 400000, 192, 343750 },    // Fast-mode
+        { 1000000, 72, 916666 },    // Fast-mode Plus
+    };
+
+    for (const auto& entry : expected) {
+        ULONG effectiveHz = 0;
+        const USHORT index = ControllerFindClockDivider(
+                MODULE_CLOCK_HZ,
+                entry.SpeedHz,
+                &effectiveHz);
+
+        HOSTTEST_CHECK(index < I2C_DIV_TAB_SIZE);
+        HOSTTEST_CHECK_EQ(I2C_Clock_Rate_Dividers_Table[index], entry.Divider);
+        HOSTTEST_CHECK_EQ(effectiveHz, entry.EffectiveHz);
+    }
+}
+
+//
+// Dividers found in both halves of the table resolve to the first half,
+// whose IFDR values are the ones documented for them
+//
+void testDuplicateDividers ()
+{
+    const USHORT index = ControllerFindClockDivider(72000000, 1000000, NULL);
+
+    HOSTTEST_CHECK_EQ(index, 7);
+    HOSTTEST_CHECK_EQ(I2C_Clock_Rate_Dividers_Table[43], 72);
+
+    // 22 is only in the second half
+    HOSTTEST_CHECK_EQ(
+        ControllerFindClockDivider(MODULE_CLOCK_HZ, MODULE_CLOCK_HZ / 22, NULL),
+        32);
+}
+
+//
+// An exact divider is taken as is, a rate one Hz below it is not
+//
+void testExactRates ()
+{
+    for (USHORT i = 0; i < I2C_DIV_TAB_SIZE; ++i) {
+        const ULONG divider = I2C_Clock_Rate_Dividers_Table[i];
+        const ULONG moduleClockHz = divider * 25000;
+
+        ULONG effectiveHz = 0;
+        USHORT index = ControllerFindClockDivider(
+                moduleClockHz,
+                25000,
+                &effectiveHz);
+
+        HOSTTEST_CHECK_EQ(I2C_Clock_Rate_Dividers_Table[index], divider);
+        HOSTTEST_CHECK_EQ(effectiveHz, 25000);
+
+        index = ControllerFindClockDivider(moduleClockHz, 24999, &effectiveHz);
+        if (divider != 3840) {
+            HOSTTEST_CHECK(I2C_Clock_Rate_Dividers_Table[index] > divider);
+            HOSTTEST_CHECK(effectiveHz < 25000);
+        }
+    }
+}
+
+//
+// When even the largest divider is too fast, the largest is used and the
+// effective rate reports how far off the bus is
+//
+void testBelowSlowestDivider ()
+{
+    ULONG effectiveHz = 0;
+    const USHORT index = ControllerFindClockDivider(
+            MODULE_CLOCK_HZ,
+            10000,
+            &effectiveHz);
+
+    HOSTTEST_CHECK_EQ(index, 31);
+    HOSTTEST_CHECK_EQ(I2C_Clock_Rate_Dividers_Table[index], 3840);
+    HOSTTEST_CHECK_EQ(effectiveHz, MODULE_CLOCK_HZ / 3840);
+}
+
+//
+// For every accepted speed the search returns the fastest table rate not
+// above the request, and no other divider does better
+//
+void testAgainstBruteForce ()
+{
+    static const ULONG moduleClocks[] = {
+        24000000,
+        49500000,
+        66000000,
+        66666666,
+        132000000,
+    };
+
+    for (ULONG moduleClockHz : moduleClocks) {
+        for (ULONG speedHz = MIN_CONNECTION_SPEED;
+             speedHz <= MAX_CONNECTION_SPEED;
+             speedHz += 1000) {
+
+            ULONG effectiveHz = 0;
+            const USHORT index = ControllerFindClockDivider(
+                    moduleClockHz,
+                    speedHz,
+                    &effectiveHz);
+
+            HOSTTEST_CHECK(index < I2C_DIV_TAB_SIZE);
+            HOSTTEST_CHECK_EQ(effectiveHz, sclHz(moduleClockHz, index));
+
+            ULONG bestHz = 0;
+            for (USHORT i = 0; i < I2C_DIV_TAB_SIZE; ++i) {
+                const ULONG divider = I2C_Clock_Rate_Dividers_Table[i];
+                const ULONG hz = sclHz(moduleClockHz, i);
+                if (((ULONGLONG)divider * speedHz >= moduleClockHz) &&
+                    (hz > bestHz)) {
+
+                    bestHz = hz;
+                }
+            }
+
+            if (bestHz != 0) {
+                HOSTTEST_CHECK_EQ(effectiveHz, bestHz);
+                HOSTTEST_CHECK(effectiveHz <= speedHz);
+            }
+        }
+    }
+}
+
+} // namespace "static"
+
+int main ()
+{
+    HOSTTEST_RUN(testStandardSpeeds);
+    HOSTTEST_RUN(testDuplicateDividers);
+    HOSTTEST_RUN(testExactRates);
+    HOSTTEST_RUN(testBelowSlowestDivider);
+    HOSTTEST_RUN(testAgainstBruteForce);
+
+    return HostTestExit();
+}
@@ -37,6 +37,12 @@
 //
 #define ACPI_TAG_IOCTL_INTERMEDIATE_BUFFER      ULONG('BceA')
 
+//
+// Memory allocation tag for memory allocated and used as
+// ACPI_DEVICE_PROPERTIES_INDEX
+//
+#define ACPI_TAG_DEVICE_PROPERTIES_INDEX        ULONG('BxeA')
+
 //
 // Device Specific Data (_DSD) ACPI method name as ULONG
 //
@@ -72,6 +78,37 @@ DEFINE_GUID(
     ACPI_DEVICE_PROPERTIES_DSD_GUID,
     0xDAFFD814, 0x6EBA, 0x4D8C, 0x8A, 0x91, 0xBC, 0x9B, 0xBF, 0x4A, 0xA3, 0x01);
 
+//
+// Minimum number of hash buckets in a Device Properties index
+//
+#define ACPI_DEVICE_PROPERTIES_INDEX_MIN_BUCKETS    8
+
+//
+// Hashed index of a Device Properties _DSD package, key to value argument.
+// It is built once by AcpiParseDsdAsDeviceProperties so that key queries do
+// not rescan the package. Entries point into the _DSD output buffer, so the
+// index must be freed before the buffer.
+//
+// A query returns what a scan of the package would. Indexing stops at the
+// first malformed pair (not a package, empty or with a non-string key), and
+// a key not defined before it fails with that pair's status. A key without
+// a value is indexed with a null ValuePtr and fails only when queried.
+//
+struct ACPI_DEVICE_PROPERTIES_INDEX_ENTRY {
+    const CHAR* KeyPtr;
+    const ACPI_METHOD_ARGUMENT UNALIGNED* ValuePtr;
+    UINT32 KeyHash;
+    USHORT KeyLength;
+};
+
+struct ACPI_DEVICE_PROPERTIES_INDEX {
+    const ACPI_METHOD_ARGUMENT UNALIGNED* DevicePropertiesPkgPtr;
+    NTSTATUS MalformedPairStatus;   // STATUS_SUCCESS if every pair is indexed
+    UINT32 EntryCount;
+    UINT32 BucketMask;
+    ACPI_DEVICE_PROPERTIES_INDEX_ENTRY Buckets[ANYSIZE_ARRAY];
+};
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 NTSTATUS
 AcpiQueryDsd(
@@ -84,6 +121,21 @@ AcpiParseDsdAsDeviceProperties(
     _In_ const ACPI_EVAL_OUTPUT_BUFFER UNALIGNED* DsdBufferPtr,
     _Outptr_ const ACPI_METHOD_ARGUMENT UNALIGNED** DevicePropertiesPkgPptr);
 
+//
+// Parse a Device Properties _DSD and index its key/value pairs.
+// The returned index is freed by AcpiDevicePropertiesFreeIndex.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+NTSTATUS
+AcpiParseDsdAsDeviceProperties(
+    _In_ const ACPI_EVAL_OUTPUT_BUFFER UNALIGNED* DsdBufferPtr,
+    _Outptr_ ACPI_DEVICE_PROPERTIES_INDEX** DevicePropertiesIndexPptr);
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+VOID
+AcpiDevicePropertiesFreeIndex(
+    _In_ ACPI_DEVICE_PROPERTIES_INDEX* DevicePropertiesIndexPtr);
+
 template<class T>
 _IRQL_requires_max_(DISPATCH_LEVEL)
 NTSTATUS
@@ -122,6 +174,44 @@ AcpiDevicePropertiesQueryIntegerValue<UINT32>(
     _In_z_ const CHAR* KeyNamePtr,
     _Out_ UINT32* Value);
 
+template<class T>
+_IRQL_requires_max_(DISPATCH_LEVEL)
+NTSTATUS
+AcpiDevicePropertiesQueryIntegerValue(
+    _In_ const ACPI_DEVICE_PROPERTIES_INDEX* DevicePropertiesIndexPtr,
+    _In_z_ const CHAR* KeyNamePtr,
+    _Out_ T* ValuePtr
+    )
+{
+    if (DevicePropertiesIndexPtr == nullptr) {
+        return STATUS_INVALID_PARAMETER_1;
+    }
+
+    if (KeyNamePtr == nullptr) {
+        return STATUS_INVALID_PARAMETER_2;
+    }
+
+    if (ValuePtr == nullptr) {
+        return STATUS_INVALID_PARAMETER_3;
+    }
+
+    UINT32 Uint32Value;
+    NTSTATUS status = AcpiDevicePropertiesQueryIntegerValue(DevicePropertiesIndexPtr, KeyNamePtr, &Uint32Value);
+    if (NT_SUCCESS(status)) {
+        *ValuePtr = static_cast<T>(Uint32Value);
+    }
+
+    return status;
+}
+
+template<>
+_IRQL_requires_max_(DISPATCH_LEVEL)
+NTSTATUS
+AcpiDevicePropertiesQueryIntegerValue<UINT32>(
+    _In_ const ACPI_DEVICE_PROPERTIES_INDEX* DevicePropertiesIndexPtr,
+    _In_z_ const CHAR* KeyNamePtr,
+    _Out_ UINT32* Value);
+
 _IRQL_requires_max_(APC_LEVEL)
 NTSTATUS
 AcpiQueryDsm(
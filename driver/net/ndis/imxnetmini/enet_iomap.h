@@ -77,7 +77,15 @@
 typedef union {
     UINT32 U;
     struct {
-        unsigned RSRVD_0_14 : 15;
+        unsigned RXB1       :  1;
+        unsigned RXF1       :  1;
+        unsigned TXB1       :  1;
+        unsigned TXF1       :  1;
+        unsigned RXB2       :  1;
+        unsigned RXF2       :  1;
+        unsigned TXB2       :  1;
+        unsigned TXF2       :  1;
+        unsigned RSRVD_8_14 :  7;
         unsigned TS_TIMER   :  1;
         unsigned TS_AVAIL   :  1;
         unsigned WAKEUP     :  1;
@@ -98,6 +106,14 @@ typedef union {
     } B;
 } EIR_t;
                                                
+#define ENET_EIR_RXB1_MASK                     0x00000001
+#define ENET_EIR_RXF1_MASK                     0x00000002
+#define ENET_EIR_TXB1_MASK                     0x00000004
+#define ENET_EIR_TXF1_MASK                     0x00000008
+#define ENET_EIR_RXB2_MASK                     0x00000010
+#define ENET_EIR_RXF2_MASK                     0x00000020
+#define ENET_EIR_TXB2_MASK                     0x00000040
+#define ENET_EIR_TXF2_MASK                     0x00000080
 #define ENET_EIR_TS_TIMER_MASK                 0x00008000
 #define ENET_EIR_TS_AVAIL_MASK                 0x00010000
 #define ENET_EIR_WAKEUP_MASK                   0x00020000
@@ -354,6 +370,28 @@ typedef union {
 #define ENET_OPD_PAUSE_DUR_MASK                0x0000FFFF
 #define ENET_OPD_OPCODE_MASK                   0xFFFF0000
 
+/*
+ * ENET_RCMRn - ENET Receive Classification Match Register for ring 1 and 2 (i.MX6SX, i.MX8M)
+ */
+#define ENET_RCMR_CMP_MASK(n)                  (0x00000007 << ((n) * 4))
+#define ENET_RCMR_CMP_SHIFT(n)                 ((n) * 4)
+#define ENET_RCMR_MATCHEN_MASK                 0x00010000
+
+/*
+ * ENET_DMAnCFG - ENET DMA Class Based Configuration for ring 1 and 2 (i.MX6SX, i.MX8M)
+ */
+#define ENET_DMACFG_IDLE_SLOPE_MASK            0x0000FFFF
+#define ENET_DMACFG_DMA_CLASS_EN_MASK          0x00010000
+#define ENET_DMACFG_CALC_NOIPG_MASK            0x00020000
+
+/*
+ * ENET_QOS - ENET QOS Scheme (i.MX6SX, i.MX8M)
+ */
+#define ENET_QOS_TX_SCHEME_MASK                0x00000007
+#define ENET_QOS_RX_FLUSH0_MASK                0x00000008
+#define ENET_QOS_RX_FLUSH1_MASK                0x00000010
+#define ENET_QOS_RX_FLUSH2_MASK                0x00000020
+
 //------------------------------------------------------------------------------
 // REGISTER LAYOUT
 //------------------------------------------------------------------------------
@@ -386,7 +424,14 @@ typedef struct {
     UINT32  GALR;               // 124
     UINT32  ___RES_128[7];
     TFWR_t  TFWR;               // 144
-    UINT32  ___RES_D148[14];
+    UINT32  ___RES_148[6];
+    UINT32  RDSR1;              // 160
+    UINT32  TDSR1;              // 164
+    UINT32  MRBR1;              // 168
+    UINT32  RDSR2;              // 16C
+    UINT32  TDSR2;              // 170
+    UINT32  MRBR2;              // 174
+    UINT32  ___RES_178[2];
     UINT32  ERDSR;              // 180
     UINT32  ETDSR;              // 184
     UINT32  EMRBR;              // 188
@@ -403,7 +448,17 @@ typedef struct {
     UINT32  ___RES_1B4[3];
     TACC_t  TACC;               // 1C0
     RACC_t  RACC;               // 1C4
-    UINT32  ___RES_1C8[14];
+    UINT32  RCMR1;              // 1C8
+    UINT32  RCMR2;              // 1CC
+    UINT32  ___RES_1D0[2];
+    UINT32  DMA1CFG;            // 1D8
+    UINT32  DMA2CFG;            // 1DC
+    UINT32  RDAR1;              // 1E0
+    UINT32  TDAR1;              // 1E4
+    UINT32  RDAR2;              // 1E8
+    UINT32  TDAR2;              // 1EC
+    UINT32  QOS;                // 1F0
+    UINT32  ___RES_1F4[3];
 
     // statistics
     UINT32  RMON_T_DROP_NI;     // 200
@@ -461,9 +516,45 @@ typedef struct {
     UINT32  IEEE_R_MACERR;      // 2D8
     UINT32  IEEE_R_FDXFC;       // 2DC
     UINT32  IEEE_R_OCTETS_OK;   // 2E0
+    UINT32  ___RES_2E4[71];
+
+    // IEEE 1588 adjustable timer
+    UINT32  ATCR;               // 400
+    UINT32  ATVR;               // 404
+    UINT32  ATOFF;              // 408
+    UINT32  ATPER;              // 40C
+    UINT32  ATCOR;              // 410
+    UINT32  ATINC;              // 414
+    UINT32  ATSTMP;             // 418
 } CSP_ENET_REGS, *PCSP_ENET_REGS;
 
-// the buffer descriptor structure for the ENET Legacy Buffer Descriptor
+/*
+ * ENET_ATCR - ENET Adjustable Timer Control Register
+ */
+#define ENET_ATCR_EN_MASK                      0x00000001
+#define ENET_ATCR_OFFEN_MASK                   0x00000004
+#define ENET_ATCR_OFFRST_MASK                  0x00000008
+#define ENET_ATCR_PEREN_MASK                   0x00000010
+#define ENET_ATCR_PINPER_MASK                  0x00000080
+#define ENET_ATCR_RESTART_MASK                 0x00000200
+#define ENET_ATCR_CAPTURE_MASK                 0x00000800
+#define ENET_ATCR_SLAVE_MASK                   0x00002000
+
+/*
+ * ENET_ATINC - ENET Timer Increment Register
+ */
+#define ENET_ATINC_INC_MASK                    0x0000007F
+#define ENET_ATINC_INC_CORR_MASK               0x00007F00
+#define ENET_ATINC_INC_SHIFT                   0
+#define ENET_ATINC_INC_CORR_SHIFT              8
+
+/*
+ * ENET_ATCOR - ENET Timer Correction Register
+ */
+#define ENET_ATCOR_COR_MASK                    0x7FFFFFFF
+
+// the buffer descriptor structure for the ENET Enhanced Buffer Descriptor (ECR[EN1588] = 1)
+// The first 8 bytes match the Legacy Buffer Descriptor.
 typedef struct  _ENET_BD {
     USHORT  DataLen;
     union {
@@ -497,8 +588,16 @@ typedef struct  _ENET_BD {
         } ControlStatus_tx;
     };
     ULONG BufferAddress;
+    ULONG ExtControlStatus;     // 08 Enhanced control and status
+    USHORT PayloadChecksum;     // 0C Rx only
+    USHORT ProtocolType;        // 0E Rx only, header length and protocol type
+    ULONG Bdu;                  // 10 Last BD update done
+    ULONG Timestamp;            // 14 IEEE 1588 timestamp (ATVR value), nanoseconds part
+    ULONG Reserved[2];          // 18
 } ENET_BD, *PENET_BD;
 
+C_ASSERT(sizeof(ENET_BD) == 32);
+
 #define ENET_RX_BD_E_MASK            ((USHORT)0x8000)
 #define ENET_RX_BD_W_MASK            ((USHORT)0x2000)
 #define ENET_RX_BD_L_MASK            ((USHORT)0x0800)
@@ -516,4 +615,12 @@ typedef struct  _ENET_BD {
 #define ENET_TX_BD_L_MASK            ((USHORT)0x0800)
 #define ENET_TX_BD_TC_MASK           ((USHORT)0x0400)
 
+#define ENET_RX_BD_INT_MASK          ((ULONG)0x00800000)  // ExtControlStatus: generate RXF interrupt
+#define ENET_RX_BD_BDU_MASK          ((ULONG)0x80000000)  // Bdu: set by uDMA when the BD has been updated
+
+#define ENET_TX_BD_INT_MASK          ((ULONG)0x40000000)  // ExtControlStatus: generate TXF interrupt
+#define ENET_TX_BD_TS_MASK           ((ULONG)0x20000000)  // ExtControlStatus: capture transmit timestamp
+#define ENET_TX_BD_FTYPE_MASK        ((ULONG)0x00F00000)  // ExtControlStatus: frame type, the ring (AVB class) the frame is sent from
+#define ENET_TX_BD_FTYPE_SHIFT       20
+
 #endif
\ No newline at end of file
@@ -37,6 +37,8 @@
 typedef struct _MP_ADAPTER           MP_ADAPTER,           *PMP_ADAPTER;
 typedef struct _MP_STATE_MACHINE     MP_STATE_MACHINE,     *PMP_STATE_MACHINE;
 typedef struct _MP_MII_STATE_MACHINE MP_MII_STATE_MACHINE, *PMP_MII_STATE_MACHINE;
+typedef struct _MP_TX_QUEUE          MP_TX_QUEUE,          *PMP_TX_QUEUE;
+typedef struct _MP_RX_QUEUE          MP_RX_QUEUE,          *PMP_RX_QUEUE;
 
 // multicast list size
 #define NIC_MAX_MCAST_LIST              32
@@ -203,6 +205,7 @@ typedef struct _MP_QUEUE {
 typedef struct _MP_TX_BD {
     LIST_ENTRY            Link;            // Queable
     PMP_ADAPTER           pAdapter;        // Adapter private data address
+    PMP_TX_QUEUE          pTxQueue;        // Tx ring the frame is sent from
     PNET_BUFFER           pNB;             // NB address
     PNET_BUFFER_LIST      pNBL;            // MBL address
     LONG                  NBId;            // For debug only
@@ -219,6 +222,8 @@ typedef struct _MP_TX_PAYLOAD_BD {
     PUCHAR                  pBuffer;
     NDIS_PHYSICAL_ADDRESS   BufferPa;
     ULONG                   BufferSize;
+    BOOLEAN                 PtpEvent;       // PTP event message, the transmit timestamp is logged
+    ENET_1588_PTP_ID        PtpId;          // Identification of the PTP event message
 } MP_TX_PAYLOAD_BD, *PMP_TX_PAYLOAD_BD;
 
 // ------------------------------------------------------------------------------------------------
@@ -230,6 +235,8 @@ typedef struct _MP_RX_FRAME_BD {
     PMDL                    pMdl;           // Address of the MDL describing buffer
     PUCHAR                  pBuffer;        // Address of the buffer (in the context of miniport driver)
     NDIS_PHYSICAL_ADDRESS   BufferPa;       // Physical address of the buffer
+    PMP_RX_QUEUE            pRxQueue;       // Rx ring the buffer belongs to
+    struct _MP_RX_FRAME_BD *pNextFrameBD;   // Next buffer of a frame received into several buffers
 } MP_RX_FRAME_BD, *PMP_RX_FRAME_BD;
 
 
@@ -237,11 +244,56 @@ typedef struct _MP_ENET_BD_SW_EXT_ {
     PMP_RX_FRAME_BD         pRxFrameBD;
 } MP_ENET_BD_SW_EXT, *PMP_ENET_BD_SW_EXT;
 
+// ------------------------------------------------------------------------------------------------
+// ENET Tx ring. Ring 0 is the best effort ring, rings 1 and 2 (i.MX6SX, i.MX8M) are the AVB class rings.
+// ------------------------------------------------------------------------------------------------
+typedef struct _MP_TX_QUEUE {
+    ULONG                   Idx;                                // Ring index
+    UINT32                  IntMask;                            // EIR flags handled by this ring
+    volatile UINT32        *pTDAR;                              // Ring transmit descriptor active register
+    ULONG                   CheckForHangCounter;
+    MP_QUEUE                qMpOwnedBDs;                        // Pending (owned by driver) TX ethernet frames (NET_BUFFERs) queue
+    MP_QUEUE                qDmaOwnedBDs;                       // In progress (owned by Enet DMA) TX ethernet frames (NET_BUFFERs) queue
+    NDIS_SPIN_LOCK          SpinLock;                           // Tx ring spin lock
+    LONG                    EnetFreeBDCount;                    // Number of unused Enet Buffer Descriptors
+    LONG                    EnetFreeBDIdx;                      // Index of the first free BD
+    LONG                    EnetPendingBDIdx;                   // Index of first BD submitted to ENET DMA
+    MP_TX_PAYLOAD_BD        EnetSwExtBDT[TX_DESC_COUNT_MAX];    // Table containing Sw related data for each Enet BD
+    PUCHAR                  DataBuffer_Va;                      // Block of Tx_DmaBDT_ItemCount * Tx_BufferSize bytes
+    ULONG                   DataBuffer_Size;                    // Tx_DmaBDT_ItemCount * Tx_BufferSize
+    NDIS_PHYSICAL_ADDRESS   DataBuffer_Pa;
+    volatile ENET_BD       *DmaBDT;                             // ENET peripheral Tx Dma buffer descriptor table (BDT) address
+    ULONG                   DmaBDT_Size;                        // Size of the DmaBDT [Bytes]
+    NDIS_PHYSICAL_ADDRESS   DmaBDT_Pa;                          // DmaBDT physical address
+} MP_TX_QUEUE, *PMP_TX_QUEUE;
+
+// ------------------------------------------------------------------------------------------------
+// ENET Rx ring. Each ring is served by EnetDpc on its own processor.
+// ------------------------------------------------------------------------------------------------
+typedef struct _MP_RX_QUEUE {
+    ULONG                   Idx;                                // Ring index
+    UINT32                  IntMask;                            // EIR flags handled by EnetDpc running for this ring
+    UINT32                  InterruptFlags;                     // Rx flags saved by EnetDpc when the indication was throttled
+    ULONG                   DpcProcessor;                       // Processor EnetDpc is queued on for this ring
+    volatile UINT32        *pRDAR;                              // Ring receive descriptor active register
+    PMP_RX_FRAME_BD         FrameBDT;                           // Rx payload data buffer descriptor table address
+    NDIS_SPIN_LOCK          SpinLock;                           // Rx ring spin lock
+    LONG                    EnetFreeBDIdx;                      // Index of the first free BD
+    LONG                    EnetPendingBDIdx;                   // Index of first BD submitted to ENET DMA
+    LONG                    NdisOwnedBDsCount;                  // Number of buffers owned by NDIS
+    LONG                    DmaBDT_DmaOwnedBDsCount;            // Number of BDs owned by ENET DMA (ready to receive data)
+    PENET_BD                DmaBDT;                             // ENET peripheral Dma buffer descriptor table (BDT) address
+    PMP_ENET_BD_SW_EXT      DmaBDT_SwExt;                       // SW extension of DmaBDT
+    ULONG                   DmaBDT_Size;                        // Size of DmaBDT in bytes
+    NDIS_PHYSICAL_ADDRESS   DmaBDT_Pa;                          // Physical address of DmaBDT
+} MP_RX_QUEUE, *PMP_RX_QUEUE;
+
 // Next state delay periods...
 #define MP_SM_NEXT_STATE_IMMEDIATELY                 -1
 #define MP_SM_NEXT_STATE_SAMPLE_DEALY_MSEC          100
 #define MP_SM_NEXT_STATE_NORMAL_DEALY_MSEC         1000
 #define MP_SM_CABLE_CONNECTED_CHECK_PERIOD_MSEC    1000
+#define MP_SM_PHY_INT_CHECK_PERIOD_MSEC           10000     // Link state check period if the ENET PHY interrupt is connected
 #define MP_SM_WAIT_FOR_SM_EXIT_TIMEOUT_MSEC        2000
 
 typedef union {
@@ -268,6 +320,8 @@ typedef enum {
 _IRQL_requires_max_(DISPATCH_LEVEL)
 NDIS_STATUS SmSetState(_In_ PMP_ADAPTER pAdapter, _In_ LONG State, _In_ LONG DelayMsec, _In_ MP_SM_NEXT_STATE_CALLER_MODE CallerMode);
 BOOLEAN SmIsAdapterRunning(_In_ PMP_ADAPTER pAdapter);
+_IRQL_requires_max_(HIGH_LEVEL)
+void SmRequestLinkUpdate(_In_ PMP_ADAPTER pAdapter);
 
 typedef enum {
     SM_STATE_HALTED         = 0,
@@ -292,19 +346,23 @@ typedef struct _MP_ADAPTER {
         NDIS_SPIN_LOCK      SM_SpinLock;              // State machine spin lock
         NDIS_HANDLE         SM_hTimer;                // State machine timer handle
         NDIS_EVENT          SM_EnetHaltedEvent;       // Enet miniport driver halted event, if signaled, no ISR/DPC are planned and all resources can be freed.
+        KDPC                SM_LinkUpdateDpc;         // Runs the RUNNING state handler immediately when the PHY reports a link change, see SmRequestLinkUpdate()
         MP_STATE            SM_PreviousState;
         MP_STATE            SM_CurrentState;
         MP_STATE            SM_NextState;
         MP_STATE            SM_OnResetPreviousState;  // State machine state at the moment when OnReset state handler is called.
     } StateMachine;
     volatile BOOLEAN        DpcQueued;                // Set to TRUE by ISR id DPC is queued
+    volatile LONG           DpcPendingCount;          // Number of EnetDpc instances queued by ISR and not finished yet, the last one re-enables interrupts
     BOOLEAN                 DpcRunning;               // Set to TRUE at the begin of DPC and to FALSE ad the and of DPC
     MP_NDIS_PEND_OPS        PendingNdisOperations;
     NDIS_STATUS             NdisStatus;
     BOOLEAN                 EnetStarted;              // Set to TRUE(data path is running) by EnetStart() and to FALSE in EnetStop() method. 
     BOOLEAN                 RestartEnetAfterResume;
     volatile CSP_ENET_REGS *ENETRegBase;              // ENET peripheral registers virtual base address
-    UINT32                  InterruptFlags;
+    UINT32                  EnetRxTxIntMask;          // ENET_RX_TX_INT_MASK extended with the interrupts of rings 1 and 2 in use
+    UINT32                  EnetIntMask;              // ENET interrupts enabled by EnetStart() and Enet1588Init(), EIMR is restored to this value at the end of EnetDpc
+    MP_1588_TIMER           Enet1588Timer;            // IEEE 1588 adjustable timer
     UCHAR                   PermanentAddress[ETH_LENGTH_OF_ADDRESS];
     UCHAR                   CurrentAddress[ETH_LENGTH_OF_ADDRESS];
     UCHAR                   FecMacAddress[ETH_LENGTH_OF_ADDRESS];
@@ -317,23 +375,10 @@ typedef struct _MP_ADAPTER {
     NDIS_HANDLE             Tx_DmaHandle;                          // Scatter/Gather DMA handle
     ULONG                   Tx_SGListSize;
     NPAGED_LOOKASIDE_LIST   Tx_MpTxBDLookasideList;                // Tx buffer descriptor lookaside list
-    ULONG                   Tx_CheckForHangCounter;
     LONG                    Tx_PendingNBs;                         // Number of TX frames (NET_BUFFERs) that are owned by the miniport. Total number of queued TX frames and frames that are already setup for DMA transfers.
-    MP_QUEUE                Tx_qMpOwnedBDs;                        // Pending (owned by driver) TX ethernet frames (NET_BUFFERs) queue
-    MP_QUEUE                Tx_qDmaOwnedBDs;                       // In progress (owned by Enet DMA) TX ethernet frames (NET_BUFFERs) queue
-    NDIS_SPIN_LOCK          Tx_SpinLock;                           // Tx path spin lock
-    LONG                    Tx_EnetFreeBDCount;                    // Number of unused Enet Buffer Descriptors
-    LONG                    Tx_EnetFreeBDIdx;                      // Index of the first free BD
-    LONG                    Tx_EnetPendingBDIdx;                   // Index of first BD submitted to ENET DMA
-    MP_TX_PAYLOAD_BD        Tx_EnetSwExtBDT[TX_DESC_COUNT_MAX];    // Table containing Sw related data for each Enet BD
-    PUCHAR                  Tx_DataBuffer_Va;                      // TxBufAlloc points to the block of numTCB*NIC_PACKET_SIZE
-    ULONG                   Tx_DataBuffer_Size;                    // numTCB*NIC_PACKET_SIZE
-    NDIS_PHYSICAL_ADDRESS   Tx_DataBuffer_Pa;
-
-    volatile ENET_BD       *Tx_DmaBDT;                             // ENET peripheral Tx Dma buffer descriptor table (BDT) address
-    LONG                    Tx_DmaBDT_ItemCount;                   // ENET peripheral Tx Dma buffer descriptor table (BDT) item count
-    ULONG                   Tx_DmaBDT_Size;                        // Size of the Tx_DmaBDT [Bytes]
-    NDIS_PHYSICAL_ADDRESS   Tx_DmaBDT_Pa;                          // Tx_DmaBDT physical address
+    LONG                    Tx_DmaBDT_ItemCount;                   // ENET peripheral Tx Dma buffer descriptor table (BDT) item count, the same for all rings
+    ULONG                   Tx_BufferSize;                         // Size of the Tx frame buffer, holds the whole frame
+    MP_TX_QUEUE             TxQueue[QUEUE_COUNT_MAX];              // Tx rings, TxQueue[0] .. TxQueue[QueueCount - 1] are in use
     #if DBG
     LONG                    Tx_NBCounter;                          // For debug only
     LONG                    Tx_NBLCounter;                         // For debug only
@@ -341,19 +386,13 @@ typedef struct _MP_ADAPTER {
 
     // RECV
     NDIS_HANDLE             Rx_NBAndNBLPool;                       // NB and NBL pool handle
-    PMP_RX_FRAME_BD         Rx_FrameBDT;                           // Rx payload data buffer descriptor table address
-    NDIS_SPIN_LOCK          Rx_SpinLock;                           // Rx path spin lock
-    LONG                    Rx_EnetFreeBDIdx;                      // Index of the first free BD
-    LONG                    Rx_EnetPendingBDIdx;                   // Index of first BD submitted to ENET DMA
-    LONG                    Rx_NdisOwnedBDsCount;                  // Number of buffers owned by NDIS
-    LONG                    Rx_DmaBDT_DmaOwnedBDsCount;            // Number of BDs owned by ENET DMA (ready to receive data)
     LONG                    Rx_DmaBDT_DmaOwnedBDsLowWatterMark;    // Number of BDs that must be ready for data reception
-    PENET_BD                Rx_DmaBDT;                             // ENET peripheral Dma buffer descriptor table (BDT) address
-    PMP_ENET_BD_SW_EXT      Rx_DmaBDT_SwExt;                       // SW extension of Rx_DmaBDT
-    LONG                    Rx_DmaBDT_ItemCount;                   // ENET peripheral Dma buffer descriptor table (BDT) item count
-    ULONG                   Rx_DmaBDT_Size;                        // Size of Rx_DmaBDT in bytes
-    NDIS_PHYSICAL_ADDRESS   Rx_DmaBDT_Pa;                          // Physical address of Rx_DmaBDT
+    LONG                    Rx_DmaBDT_ItemCount;                   // ENET peripheral Dma buffer descriptor table (BDT) item count, the same for all rings
+    ULONG                   Rx_BufferSize;                         // Size of the Rx frame buffer, a jumbo frame can span several buffers
+    MP_RX_QUEUE             RxQueue[QUEUE_COUNT_MAX];              // Rx rings, RxQueue[0] .. RxQueue[QueueCount - 1] are in use
     LONG                    Rx_NBLCounter;                         // For debug only
+    ULONG                   QueueCount;                            // Number of Rx/Tx ring pairs in use, from registry
+    ULONG                   JumboPacket;                           // Maximal frame size without CRC, from registry (*JumboPacket)
     NDIS_SPIN_LOCK          Dev_SpinLock;                          // spin locks
     // Packet Filter and look ahead size.
     ULONG                   PacketFilter;
@@ -419,6 +458,7 @@ typedef struct _MP_ADAPTER {
     ULONG                   ENETDev_bmACPISupportedFunctions;         // ACPI _DSM supported methods bitmask.
     MP_PHY_DEVICE           ENETDev_PHYDevice;                        // ENET PHY device data structure.
     MP_MDIO_DEVICE          ENETDev_MDIODevice;                       // MDIO device (ENET PHY) data structure.
+    BOOLEAN                 ENETDev_MDIOBusOwner;                     // TRUE if the MDIO bus controller registers are this ENET device registers (MII interrupt is routed to EnetIsr).
     #if DBG
     char                    ENETDev_DeviceName[MAX_DEVICE_NAME + 1];  // ENET device name.
     NDIS_PHYSICAL_ADDRESS   ENETDev_RegsPhyAddress;                   // ENET device registers physical address.
@@ -436,6 +476,7 @@ MINIPORT_INTERRUPT_DPC EnetDpc;
 NDIS_STATUS MpSetPower           (_In_ PMP_ADAPTER pAdapter, _In_ NDIS_DEVICE_POWER_STATE PowerState);
 
 NDIS_TIMER_FUNCTION MpSmDispatcher;
+KDEFERRED_ROUTINE   MpSmLinkUpdateDpc;
 
 VOID MpCompleteOids(_In_ PMP_ADAPTER pAdapter, _In_ NDIS_STATUS Status);
 
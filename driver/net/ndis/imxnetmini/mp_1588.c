@@ -0,0 +1,341 @@
+/*
+* Copyright 2018 NXP
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted (subject to the limitations in the disclaimer
+* below) provided that the following conditions are met:
+*
+* * Redistributions of source code must retain the above copyright notice, this
+* list of conditions and the following disclaimer.
+*
+* * Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* * Neither the name of NXP nor the names of its contributors may be used to
+* endorse or promote products derived from this software without specific prior
+* written permission.
+*
+* NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY THIS
+* LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+* THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+* GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+* LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+
+#include "precomp.h"
+
+/*++
+Routine Description:
+    Starts the IEEE 1588 adjustable timer and enables the TS_TIMER interrupt.
+    The timer runs independently of the MAC, so it keeps counting while ENET is stopped.
+    Called from EnetInit() before the ENET interrupt is registered.
+Arguments:
+    pAdapter    Pointer to adapter data
+Return Value:
+    None
+--*/
+_Use_decl_annotations_
+void Enet1588Init(PMP_ADAPTER pAdapter)
+{
+    volatile CSP_ENET_REGS  *ENETRegBase = pAdapter->ENETRegBase;
+    PMP_1588_TIMER           pTimer = &pAdapter->Enet1588Timer;
+
+    DBG_SM_METHOD_BEG();
+    ENETRegBase->ATCR  = 0;                                                           // Stop the timer
+    ENETRegBase->ATINC = ENET_1588_INC_NS << ENET_ATINC_INC_SHIFT;                    // Nominal increment, no correction
+    ENETRegBase->ATCOR = 0;                                                           // Correction disabled
+    ENETRegBase->ATPER = ENET_1588_NSEC_PER_SEC;                                      // ATVR wraps every second
+    pTimer->Seconds    = 0;
+    pTimer->FreqAdjPpb = 0;
+    NdisAcquireSpinLock(&pTimer->TimestampLog.Lock);
+    pTimer->TimestampLog.Head      = 0;                                               // Timestamps of the old time base are meaningless
+    pTimer->TimestampLog.Count     = 0;
+    pTimer->TimestampLog.LostCount = 0;
+    NdisReleaseSpinLock(&pTimer->TimestampLog.Lock);
+    ENETRegBase->ATCR  = ENET_ATCR_RESTART_MASK;                                      // Reset ATVR
+    ENETRegBase->ATCR  = ENET_ATCR_EN_MASK | ENET_ATCR_PEREN_MASK | ENET_ATCR_PINPER_MASK;  // Start the timer, TS_TIMER event on each period
+    ENETRegBase->EIR.U = ENET_1588_INT_MASK;                                          // Clear pending TS_TIMER event
+    pAdapter->EnetIntMask |= ENET_1588_INT_MASK;
+    ENETRegBase->EIMR.U |= ENET_1588_INT_MASK;                                        // The interrupt is not registered yet, no need to synchronize
+    DBG_SM_METHOD_END();
+}
+
+/*++
+Routine Description:
+    Disables the TS_TIMER interrupt.
+    It is supposed that this function is called synchronised with EnetIsr by NdisMSynchronizeWithInterruptEx()
+Arguments:
+    SynchronizeContext  The handle to the driver allocated context area.
+Return Value:
+    Always returns TRUE
+--*/
+_Use_decl_annotations_
+BOOLEAN Enet1588DisableInterrupt(NDIS_HANDLE SynchronizeContext) {
+    PMP_ADAPTER  pAdapter = (PMP_ADAPTER)SynchronizeContext;
+
+    pAdapter->EnetIntMask &= ~ENET_1588_INT_MASK;
+    pAdapter->ENETRegBase->EIMR.U &= ~ENET_1588_INT_MASK;
+    return TRUE;
+}
+
+/*++
+Routine Description:
+    Stops the IEEE 1588 adjustable timer.
+Arguments:
+    pAdapter    Pointer to adapter data
+Return Value:
+    None
+--*/
+_Use_decl_annotations_
+void Enet1588Deinit(PMP_ADAPTER pAdapter)
+{
+    DBG_SM_METHOD_BEG();
+    if (pAdapter->NdisInterruptHandle) {
+        NdisMSynchronizeWithInterruptEx(pAdapter->NdisInterruptHandle, 0, Enet1588DisableInterrupt, pAdapter);
+    }
+    pAdapter->ENETRegBase->ATCR = 0;                  // Stop the timer
+    pAdapter->ENETRegBase->EIR.U = ENET_1588_INT_MASK;
+    DBG_SM_METHOD_END();
+}
+
+/*++
+Routine Description:
+    Updates the seconds counter on the TS_TIMER event (ATVR has wrapped). Called from EnetDpc.
+Arguments:
+    pAdapter    Pointer to adapter data
+Return Value:
+    None
+--*/
+_Use_decl_annotations_
+void Enet1588OnTimerEvent(PMP_ADAPTER pAdapter)
+{
+    PMP_1588_TIMER  pTimer = &pAdapter->Enet1588Timer;
+
+    NdisDprAcquireSpinLock(&pTimer->Lock);
+    if (pAdapter->ENETRegBase->EIR.U & ENET_1588_INT_MASK) {      // Not consumed by Enet1588SetTime() meanwhile?
+        pAdapter->ENETRegBase->EIR.U = ENET_1588_INT_MASK;        // Clear the event
+        pTimer->Seconds++;
+    }
+    NdisDprReleaseSpinLock(&pTimer->Lock);
+}
+
+/*++
+Routine Description:
+    Reads the timer value. Must be called with the timer lock held.
+    The TS_TIMER event may still be pending if ATVR has wrapped after the last EnetDpc run, a small ATVR value
+    together with the pending event means that the seconds counter has not been updated yet.
+Arguments:
+    pAdapter    Pointer to adapter data
+Return Value:
+    Timer value in nanoseconds.
+--*/
+static ULONG64 Enet1588ReadTimeLocked(_In_ PMP_ADAPTER pAdapter)
+{
+    volatile CSP_ENET_REGS  *ENETRegBase = pAdapter->ENETRegBase;
+    ULONG64                  Seconds = pAdapter->Enet1588Timer.Seconds;
+    ULONG                    Nanoseconds;
+
+    ENETRegBase->ATCR |= ENET_ATCR_CAPTURE_MASK;                  // Latch the timer value into ATVR
+    (void)ENETRegBase->ATCR;                                      // Wait until the write has reached the timer clock domain
+    Nanoseconds = ENETRegBase->ATVR;
+    if ((ENETRegBase->EIR.U & ENET_1588_INT_MASK) && (Nanoseconds < ENET_1588_NSEC_PER_SEC / 2)) {
+        Seconds++;                                                // Wrapped, EnetDpc has not updated the seconds counter yet
+    }
+    return Seconds * ENET_1588_NSEC_PER_SEC + Nanoseconds;
+}
+
+/*++
+Routine Description:
+    Returns the current timer value.
+Arguments:
+    pAdapter    Pointer to adapter data
+Return Value:
+    Timer value in nanoseconds.
+--*/
+_Use_decl_annotations_
+ULONG64 Enet1588GetTime(PMP_ADAPTER pAdapter)
+{
+    PMP_1588_TIMER  pTimer = &pAdapter->Enet1588Timer;
+    ULONG64         Time;
+
+    NdisAcquireSpinLock(&pTimer->Lock);
+    Time = Enet1588ReadTimeLocked(pAdapter);
+    NdisReleaseSpinLock(&pTimer->Lock);
+    return Time;
+}
+
+/*++
+Routine Description:
+    Sets the timer value. Must be called with the timer lock held.
+Arguments:
+    pAdapter    Pointer to adapter data
+    Time        New timer value in nanoseconds
+Return Value:
+    None
+--*/
+static void Enet1588WriteTimeLocked(_In_ PMP_ADAPTER pAdapter, _In_ ULONG64 Time)
+{
+    volatile CSP_ENET_REGS  *ENETRegBase = pAdapter->ENETRegBase;
+
+    ENETRegBase->ATVR = (ULONG)(Time % ENET_1588_NSEC_PER_SEC);
+    ENETRegBase->EIR.U = ENET_1588_INT_MASK;                      // Drop the TS_TIMER event of the old time base
+    pAdapter->Enet1588Timer.Seconds = Time / ENET_1588_NSEC_PER_SEC;
+}
+
+/*++
+Routine Description:
+    Sets the timer value.
+Arguments:
+    pAdapter    Pointer to adapter data
+    Time        New timer value in nanoseconds
+Return Value:
+    None
+--*/
+_Use_decl_annotations_
+void Enet1588SetTime(PMP_ADAPTER pAdapter, ULONG64 Time)
+{
+    PMP_1588_TIMER  pTimer = &pAdapter->Enet1588Timer;
+
+    NdisAcquireSpinLock(&pTimer->Lock);
+    Enet1588WriteTimeLocked(pAdapter, Time);
+    NdisReleaseSpinLock(&pTimer->Lock);
+}
+
+/*++
+Routine Description:
+    Adds an offset to the timer value.
+Arguments:
+    pAdapter    Pointer to adapter data
+    Offset      Offset in nanoseconds
+Return Value:
+    NDIS_STATUS_SUCCESS
+    NDIS_STATUS_INVALID_DATA if the timer value would become negative.
+--*/
+_Use_decl_annotations_
+NDIS_STATUS Enet1588AdjustTime(PMP_ADAPTER pAdapter, LONG64 Offset)
+{
+    PMP_1588_TIMER  pTimer = &pAdapter->Enet1588Timer;
+    NDIS_STATUS     Status = NDIS_STATUS_SUCCESS;
+    ULONG64         Time;
+
+    NdisAcquireSpinLock(&pTimer->Lock);
+    do {
+        Time = Enet1588ReadTimeLocked(pAdapter);
+        if ((Offset < 0) && ((ULONG64)(-Offset) > Time)) {
+            Status = NDIS_STATUS_INVALID_DATA;
+            break;
+        }
+        Enet1588WriteTimeLocked(pAdapter, Time + Offset);
+    } while (0);
+    NdisReleaseSpinLock(&pTimer->Lock);
+    return Status;
+}
+
+/*++
+Routine Description:
+    Adjusts the timer frequency. The correction is computed by Enet1588ComputeCorrection().
+Arguments:
+    pAdapter    Pointer to adapter data
+    Ppb         Frequency adjustment in parts per billion, positive value speeds the timer up
+Return Value:
+    NDIS_STATUS_SUCCESS
+    NDIS_STATUS_INVALID_DATA if the adjustment is out of range.
+--*/
+_Use_decl_annotations_
+NDIS_STATUS Enet1588AdjustFrequency(PMP_ADAPTER pAdapter, LONG Ppb)
+{
+    volatile CSP_ENET_REGS  *ENETRegBase = pAdapter->ENETRegBase;
+    PMP_1588_TIMER           pTimer = &pAdapter->Enet1588Timer;
+    ULONG                    IncCorr;
+    ULONG                    Atcor;
+
+    if ((Ppb > ENET_1588_MAX_ADJ_PPB) || (Ppb < -ENET_1588_MAX_ADJ_PPB)) {
+        return NDIS_STATUS_INVALID_DATA;
+    }
+    Enet1588ComputeCorrection(Ppb, &IncCorr, &Atcor);
+    NdisAcquireSpinLock(&pTimer->Lock);
+    ENETRegBase->ATINC = (ENET_1588_INC_NS << ENET_ATINC_INC_SHIFT) | ((IncCorr << ENET_ATINC_INC_CORR_SHIFT) & ENET_ATINC_INC_CORR_MASK);
+    ENETRegBase->ATCOR = Atcor;                                                    // 0 disables the correction
+    pTimer->FreqAdjPpb = Ppb;
+    NdisReleaseSpinLock(&pTimer->Lock);
+    return NDIS_STATUS_SUCCESS;
+}
+
+/*++
+Routine Description:
+    Appends the timestamp of a PTP event message to the timestamp log. The oldest record is dropped if the log is full.
+    Called from EnetDpc while the Tx or Rx descriptors are processed.
+Arguments:
+    pAdapter    Pointer to adapter data
+    Flags       ENET_1588_TIMESTAMP_TX or ENET_1588_TIMESTAMP_RX
+    pPtpId      Message the timestamp belongs to
+    Time        Timer value in nanoseconds
+Return Value:
+    None
+--*/
+_Use_decl_annotations_
+void Enet1588LogTimestamp(PMP_ADAPTER pAdapter, ULONG Flags, const ENET_1588_PTP_ID *pPtpId, ULONG64 Time)
+{
+    PMP_1588_TIMESTAMP_LOG  pLog = &pAdapter->Enet1588Timer.TimestampLog;
+    PENET_1588_TIMESTAMP    pRecord;
+
+    NdisDprAcquireSpinLock(&pLog->Lock);
+    if (pLog->Count == ENET_1588_TIMESTAMP_LOG_SIZE) {
+        pLog->Head = (pLog->Head + 1) % ENET_1588_TIMESTAMP_LOG_SIZE;          // Drop the oldest record
+        pLog->Count--;
+        pLog->LostCount++;
+    }
+    pRecord = &pLog->Records[(pLog->Head + pLog->Count) % ENET_1588_TIMESTAMP_LOG_SIZE];
+    pRecord->Time  = Time;
+    pRecord->Flags = Flags;
+    pRecord->PtpId = *pPtpId;
+    pLog->Count++;
+    NdisDprReleaseSpinLock(&pLog->Lock);
+}
+
+/*++
+Routine Description:
+    Moves the logged timestamps, oldest first, into the OID_IMX_ENET_1588_TIMESTAMPS output buffer.
+    Records that do not fit stay in the log.
+Arguments:
+    pAdapter        Pointer to adapter data
+    pTimestamps     Output buffer
+    Size            Size of the output buffer in bytes, at least FIELD_OFFSET(ENET_1588_TIMESTAMPS, Records)
+    pBytesNeeded    Size needed to return all the logged records
+Return Value:
+    Number of bytes written.
+--*/
+_Use_decl_annotations_
+ULONG Enet1588ReadTimestamps(PMP_ADAPTER pAdapter, PENET_1588_TIMESTAMPS pTimestamps, ULONG Size, PULONG pBytesNeeded)
+{
+    PMP_1588_TIMESTAMP_LOG  pLog = &pAdapter->Enet1588Timer.TimestampLog;
+    ULONG                   Count;
+
+    ASSERT(Size >= FIELD_OFFSET(ENET_1588_TIMESTAMPS, Records));
+    NdisAcquireSpinLock(&pLog->Lock);
+    *pBytesNeeded = FIELD_OFFSET(ENET_1588_TIMESTAMPS, Records) + pLog->Count * sizeof(ENET_1588_TIMESTAMP);
+    Count = (Size - FIELD_OFFSET(ENET_1588_TIMESTAMPS, Records)) / sizeof(ENET_1588_TIMESTAMP);
+    if (Count > pLog->Count) {
+        Count = pLog->Count;
+    }
+    for (ULONG i = 0; i < Count; i++) {
+        pTimestamps->Records[i] = pLog->Records[pLog->Head];
+        pLog->Head = (pLog->Head + 1) % ENET_1588_TIMESTAMP_LOG_SIZE;
+    }
+    pLog->Count -= Count;
+    pTimestamps->Count = Count;
+    pTimestamps->LostCount = pLog->LostCount;
+    pLog->LostCount = 0;
+    NdisReleaseSpinLock(&pLog->Lock);
+    return FIELD_OFFSET(ENET_1588_TIMESTAMPS, Records) + Count * sizeof(ENET_1588_TIMESTAMP);
+}
@@ -0,0 +1,102 @@
+/*
+* Copyright 2018 NXP
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted (subject to the limitations in the disclaimer
+* below) provided that the following conditions are met:
+*
+* * Redistributions of source code must retain the above copyright notice, this
+* list of conditions and the following disclaimer.
+*
+* * Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* * Neither the name of NXP nor the names of its contributors may be used to
+* endorse or promote products derived from this software without specific prior
+* written permission.
+*
+* NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY THIS
+* LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+* THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+* GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+* LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+
+#ifndef _MP_1588_H
+#define _MP_1588_H
+
+// IEEE 1588 adjustable timer.
+// ATVR counts nanoseconds and wraps every second (ATPER), the seconds are counted by the driver on the TS_TIMER event.
+// Timestamps captured by ENET into the Rx/Tx buffer descriptors carry only the nanoseconds part, the seconds part
+// is taken from the timer value read at the time the descriptors are processed.
+// The timestamps of PTP event messages are kept in a log read through OID_IMX_ENET_1588_TIMESTAMPS, the NBL timestamp
+// out-of-band data does not exist before NDIS 6.82. Only PTP event messages request a transmit timestamp.
+#define ENET_1588_INT_MASK                (ENET_EIR_TS_TIMER_MASK)
+#define ENET_1588_TIMESTAMP_LOG_SIZE              64  // Timestamps kept until read, the oldest one is dropped on overflow
+
+// Private OIDs
+#define OID_IMX_ENET_1588_TIME            0xFF011588  // Q/S: ULONG64, timer value [ns]
+#define OID_IMX_ENET_1588_ADJUST_TIME     0xFF011589  // S:   LONG64, offset added to the timer value [ns]
+#define OID_IMX_ENET_1588_FREQUENCY       0xFF01158A  // Q/S: LONG, timer frequency adjustment [ppb]
+#define OID_IMX_ENET_1588_TIMESTAMPS      0xFF01158B  // Q:   ENET_1588_TIMESTAMPS, PTP event message timestamps, oldest first. Read records are removed.
+
+#define ENET_1588_TIMESTAMP_TX            0x00000001  // ENET_1588_TIMESTAMP.Flags: transmitted message
+#define ENET_1588_TIMESTAMP_RX            0x00000002  // ENET_1588_TIMESTAMP.Flags: received message
+
+typedef struct _ENET_1588_TIMESTAMP {
+    ULONG64                 Time;                     // Timer value when the message passed the MAC [ns]
+    ULONG                   Flags;                    // ENET_1588_TIMESTAMP_TX or ENET_1588_TIMESTAMP_RX
+    ENET_1588_PTP_ID        PtpId;                    // Message the timestamp belongs to
+} ENET_1588_TIMESTAMP, *PENET_1588_TIMESTAMP;
+
+typedef struct _ENET_1588_TIMESTAMPS {
+    ULONG                   Count;                    // Number of records returned
+    ULONG                   LostCount;                // Records dropped on log overflow since the previous query
+    ENET_1588_TIMESTAMP     Records[ANYSIZE_ARRAY];
+} ENET_1588_TIMESTAMPS, *PENET_1588_TIMESTAMPS;
+
+typedef struct _MP_1588_TIMESTAMP_LOG {
+    NDIS_SPIN_LOCK          Lock;                     // Serializes the Tx and Rx DPCs and the OID request
+    ULONG                   Head;                     // Index of the oldest record
+    ULONG                   Count;                    // Number of records in the log
+    ULONG                   LostCount;                // Records dropped on overflow since the previous query
+    ENET_1588_TIMESTAMP     Records[ENET_1588_TIMESTAMP_LOG_SIZE];
+} MP_1588_TIMESTAMP_LOG, *PMP_1588_TIMESTAMP_LOG;
+
+typedef struct _MP_1588_TIMER {
+    NDIS_SPIN_LOCK          Lock;                     // Serializes timer access with the seconds counter update
+    ULONG64                 Seconds;                  // Seconds part of the timer value
+    LONG                    FreqAdjPpb;               // Current frequency adjustment [ppb]
+    MP_1588_TIMESTAMP_LOG   TimestampLog;             // PTP event message timestamps not read yet
+} MP_1588_TIMER, *PMP_1588_TIMER;
+
+MINIPORT_SYNCHRONIZE_INTERRUPT Enet1588DisableInterrupt;
+
+void        Enet1588Init            (_In_ PMP_ADAPTER pAdapter);
+void        Enet1588Deinit          (_In_ PMP_ADAPTER pAdapter);
+_IRQL_requires_(DISPATCH_LEVEL)
+void        Enet1588OnTimerEvent    (_In_ PMP_ADAPTER pAdapter);
+_IRQL_requires_max_(DISPATCH_LEVEL)
+ULONG64     Enet1588GetTime         (_In_ PMP_ADAPTER pAdapter);
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void        Enet1588SetTime         (_In_ PMP_ADAPTER pAdapter, _In_ ULONG64 Time);
+_IRQL_requires_max_(DISPATCH_LEVEL)
+NDIS_STATUS Enet1588AdjustTime      (_In_ PMP_ADAPTER pAdapter, _In_ LONG64 Offset);
+_IRQL_requires_max_(DISPATCH_LEVEL)
+NDIS_STATUS Enet1588AdjustFrequency (_In_ PMP_ADAPTER pAdapter, _In_ LONG Ppb);
+_IRQL_requires_(DISPATCH_LEVEL)
+void        Enet1588LogTimestamp    (_In_ PMP_ADAPTER pAdapter, _In_ ULONG Flags, _In_ const ENET_1588_PTP_ID *pPtpId, _In_ ULONG64 Time);
+_IRQL_requires_max_(DISPATCH_LEVEL)
+ULONG       Enet1588ReadTimestamps  (_In_ PMP_ADAPTER pAdapter, _Out_writes_bytes_(Size) PENET_1588_TIMESTAMPS pTimestamps, _In_ ULONG Size, _Out_ PULONG pBytesNeeded);
+
+#endif // _MP_1588_H
@@ -0,0 +1,193 @@
+/*
+* Copyright 2018 NXP
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted (subject to the limitations in the disclaimer
+* below) provided that the following conditions are met:
+*
+* * Redistributions of source code must retain the above copyright notice, this
+* list of conditions and the following disclaimer.
+*
+* * Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* * Neither the name of NXP nor the names of its contributors may be used to
+* endorse or promote products derived from this software without specific prior
+* written permission.
+*
+* NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY THIS
+* LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+* THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+* GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+* LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+
+
+#ifndef _MP_1588_UTIL_H
+#define _MP_1588_UTIL_H
+
+// IEEE 1588 helpers that touch neither the registers nor NDIS: timer arithmetic and recognition of the PTP event
+// messages whose timestamps the driver reports. The host test (test/mp_1588_test.c) runs them against a simulated
+// drifting timer.
+
+#define ENET_1588_CLOCK_HZ                 125000000  // Timer input clock (ENET_REF_CLK)
+#define ENET_1588_NSEC_PER_SEC            1000000000
+#define ENET_1588_INC_NS                  (ENET_1588_NSEC_PER_SEC / ENET_1588_CLOCK_HZ)  // Nominal ATINC value (8 ns)
+#define ENET_1588_MAX_ADJ_PPB              250000000  // Frequency adjustment limit
+
+#define ENET_1588_PTP_EVENT_PORT                 319  // UDP port of the PTP event messages
+#define ENET_1588_PTP_ETHERTYPE               0x88F7  // IEEE 802.3 transport of PTP
+#define ENET_1588_PTP_HEADER_LENGTH               34
+#define ENET_1588_PTP_MSG_PDELAY_RESP           0x03  // Highest event message type, general messages follow
+
+// Identification of a PTP message, as carried in its header.
+typedef struct _ENET_1588_PTP_ID {
+    UCHAR                   MessageType;              // Sync, Delay_Req, Pdelay_Req or Pdelay_Resp
+    UCHAR                   DomainNumber;
+    USHORT                  SequenceId;
+    UCHAR                   SourcePortIdentity[10];   // clockIdentity and portNumber, network byte order
+} ENET_1588_PTP_ID, *PENET_1588_PTP_ID;
+
+/*++
+Routine Description:
+    Converts a buffer descriptor timestamp (nanoseconds part of the timer value) to the full timer value.
+    The seconds part closest to Now is used, so the frame must have been timestamped less than half a second
+    before or after Now.
+Arguments:
+    Now         Timer value read while the buffer descriptors are processed
+    Timestamp   Buffer descriptor timestamp
+Return Value:
+    Timer value in nanoseconds.
+--*/
+FORCEINLINE ULONG64 Enet1588ExtendTimestamp(_In_ ULONG64 Now, _In_ ULONG Timestamp)
+{
+    ULONG64  Seconds = Now / ENET_1588_NSEC_PER_SEC;
+    LONG     Diff = (LONG)Timestamp - (LONG)(Now % ENET_1588_NSEC_PER_SEC);
+
+    if ((Diff > ENET_1588_NSEC_PER_SEC / 2) && (Seconds != 0)) {
+        Seconds--;                                                // Timestamped before the ATVR wrap preceding Now
+    } else if (Diff < -(ENET_1588_NSEC_PER_SEC / 2)) {
+        Seconds++;                                                // Timestamped after the ATVR wrap following Now
+    }
+    return Seconds * ENET_1588_NSEC_PER_SEC + Timestamp;
+}
+
+/*++
+Routine Description:
+    Computes the timer correction for a frequency adjustment.
+    Every CorrPeriod timer clocks ATVR is incremented by ENET_1588_INC_NS +/- CorrInc instead of ENET_1588_INC_NS, so the relative
+    frequency change is CorrInc / (CorrPeriod * ENET_1588_INC_NS). Each CorrInc gives its own rounding error of CorrPeriod, the
+    CorrInc with the smallest error is used. CorrPeriod is kept >= 2 as ATCOR = CorrPeriod - 1 and ATCOR = 0 disables the correction.
+Arguments:
+    Ppb         Frequency adjustment in parts per billion, within +/- ENET_1588_MAX_ADJ_PPB
+    pIncCorr    ATINC[INC_CORR] value
+    pAtcor      ATCOR value, 0 if no correction is needed
+Return Value:
+    None
+--*/
+FORCEINLINE void Enet1588ComputeCorrection(_In_ LONG Ppb, _Out_ ULONG *pIncCorr, _Out_ ULONG *pAtcor)
+{
+    ULONG64  Rate = (ULONG64)((Ppb < 0) ? -(LONG64)Ppb : Ppb) * ENET_1588_INC_NS;   // CorrInc / CorrPeriod = Rate / 10^9
+    ULONG64  BestError = (ULONG64)-1;
+    ULONG    BestInc = 0;
+    ULONG    BestPeriod = 0;
+
+    for (ULONG CorrInc = 1; (Rate != 0) && (CorrInc < ENET_1588_INC_NS); CorrInc++) {
+        ULONG64  Scaled = (ULONG64)CorrInc * ENET_1588_NSEC_PER_SEC;
+        ULONG64  CorrPeriod = (Scaled + Rate / 2) / Rate;
+        ULONG64  Error;
+
+        if (CorrPeriod < 2) {
+            continue;                                             // Too coarse, try a larger step
+        }
+        Error = (CorrPeriod * Rate > Scaled) ? (CorrPeriod * Rate - Scaled) : (Scaled - CorrPeriod * Rate);
+        Error = Error * ENET_1588_NSEC_PER_SEC / (CorrPeriod * Rate);  // Relative error of the period, scaled like Rate
+        if (Error < BestError) {
+            BestError = Error;
+            BestInc = CorrInc;
+            BestPeriod = (ULONG)CorrPeriod;
+        }
+    }
+    *pIncCorr = (Ppb < 0) ? ENET_1588_INC_NS - BestInc : ENET_1588_INC_NS + BestInc;
+    *pAtcor = (BestPeriod != 0) ? BestPeriod - 1 : 0;
+}
+
+/*++
+Routine Description:
+    Checks whether a frame carries a PTPv2 event message (the messages whose transmission and reception times PTP uses)
+    and extracts the message identification. IEEE 802.3 (EtherType 0x88F7), UDP/IPv4 and UDP/IPv6 transports are
+    recognized, with an optional 802.1Q tag.
+Arguments:
+    pFrame      Frame, starting with the destination MAC address
+    Length      Frame length in bytes
+    pPtpId      Message identification, valid if TRUE is returned
+Return Value:
+    TRUE if the frame is a PTPv2 event message.
+--*/
+FORCEINLINE BOOLEAN Enet1588ParsePtpEvent(_In_reads_bytes_(Length) const UCHAR *pFrame, _In_ ULONG Length, _Out_ PENET_1588_PTP_ID pPtpId)
+{
+    ULONG        Offset = 12;                                     // EtherType
+    USHORT       EtherType;
+    const UCHAR *pPtp;
+
+    if (Length < Offset + 2) {
+        return FALSE;
+    }
+    EtherType = (USHORT)((pFrame[Offset] << 8) | pFrame[Offset + 1]);
+    if (EtherType == 0x8100) {                                    // 802.1Q tagged
+        Offset += 4;
+        if (Length < Offset + 2) {
+            return FALSE;
+        }
+        EtherType = (USHORT)((pFrame[Offset] << 8) | pFrame[Offset + 1]);
+    }
+    Offset += 2;
+    if (EtherType == 0x0800) {                                    // IPv4
+        if ((Length < Offset + 20) || ((pFrame[Offset] >> 4) != 4) || (pFrame[Offset + 9] != 17)) {
+            return FALSE;                                         // Not UDP
+        }
+        if (((pFrame[Offset + 6] & 0x1F) | pFrame[Offset + 7]) != 0) {
+            return FALSE;                                         // Not the first fragment
+        }
+        Offset += (pFrame[Offset] & 0x0F) * 4;
+        EtherType = 0;
+    } else if (EtherType == 0x86DD) {                             // IPv6, no extension headers
+        if ((Length < Offset + 40) || (pFrame[Offset + 6] != 17)) {
+            return FALSE;
+        }
+        Offset += 40;
+        EtherType = 0;
+    } else if (EtherType != ENET_1588_PTP_ETHERTYPE) {
+        return FALSE;
+    }
+    if (EtherType == 0) {                                         // UDP
+        if ((Length < Offset + 8) || (((pFrame[Offset + 2] << 8) | pFrame[Offset + 3]) != ENET_1588_PTP_EVENT_PORT)) {
+            return FALSE;
+        }
+        Offset += 8;
+    }
+    if (Length < Offset + ENET_1588_PTP_HEADER_LENGTH) {
+        return FALSE;
+    }
+    pPtp = &pFrame[Offset];
+    if (((pPtp[0] & 0x0F) > ENET_1588_PTP_MSG_PDELAY_RESP) || ((pPtp[1] & 0x0F) != 2)) {
+        return FALSE;                                             // General message or not PTPv2
+    }
+    pPtpId->MessageType  = pPtp[0] & 0x0F;
+    pPtpId->DomainNumber = pPtp[4];
+    pPtpId->SequenceId   = (USHORT)((pPtp[30] << 8) | pPtp[31]);
+    RtlCopyMemory(pPtpId->SourcePortIdentity, &pPtp[20], sizeof(pPtpId->SourcePortIdentity));
+    return TRUE;
+}
+
+#endif // _MP_1588_UTIL_H
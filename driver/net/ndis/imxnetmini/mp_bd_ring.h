@@ -0,0 +1,258 @@
+/*
+* Copyright 2018 NXP
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted (subject to the limitations in the disclaimer
+* below) provided that the following conditions are met:
+*
+* * Redistributions of source code must retain the above copyright notice, this
+* list of conditions and the following disclaimer.
+*
+* * Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* * Neither the name of NXP nor the names of its contributors may be used to
+* endorse or promote products derived from this software without specific prior
+* written permission.
+*
+* NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY THIS
+* LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+* THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+* GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+* LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+
+
+#ifndef _MP_BD_RING_H
+#define _MP_BD_RING_H
+
+// ENET Dma buffer descriptor (BD) ring primitives.
+// A ring is an array of ItemCount ENET_BDs, the last BD of the array has the W (wrap) bit set. A Tx BD with the R bit
+// set and an Rx BD with the E bit set are owned by ENET DMA, the driver may modify only the BDs it owns and must write
+// the ControlStatus word last. A ring is (re)started by a write to its descriptor active register (TDARn/RDARn),
+// the register reads non-zero while ENET DMA processes the ring.
+// All the ring index arithmetic, BD ownership handling and ring walks of the data path go through these helpers, the
+// driver supplies the per-BD software bookkeeping through callbacks.
+
+// Returns index of the BD following Idx in the ring of ItemCount BDs.
+FORCEINLINE LONG EnetBdRingNextIdx(_In_ LONG Idx, _In_ LONG ItemCount)
+{
+    return (++Idx == ItemCount) ? 0 : Idx;
+}
+
+// Returns index of the BD Count BDs after Idx in the ring of ItemCount BDs.
+FORCEINLINE LONG EnetBdRingAddIdx(_In_ LONG Idx, _In_ LONG Count, _In_ LONG ItemCount)
+{
+    return (Idx + Count) % ItemCount;
+}
+
+// Returns TRUE if ENET DMA is processing the ring.
+FORCEINLINE BOOLEAN EnetBdRingIsActive(_In_ volatile UINT32 *pDAR)
+{
+    return *pDAR != 0;
+}
+
+// A write to TDARn/RDARn cannot be told apart from the idle register value in memory, so the host ring simulator
+// (test/mp_bd_ring_test.c) observes it through this hook. It expands to nothing in the driver.
+#ifndef ENET_BD_RING_DAR_WRITTEN
+#define ENET_BD_RING_DAR_WRITTEN(pDAR)
+#endif
+
+// Likewise the simulator checks that the driver never changes a BD it has passed to ENET DMA through this hook, invoked
+// right after the ControlStatus word that passes the BD is written.
+#ifndef ENET_BD_RING_BD_PASSED
+#define ENET_BD_RING_BD_PASSED(pBD)
+#endif
+
+// Instructs ENET DMA to (re)start processing of the ring.
+FORCEINLINE void EnetBdRingKick(_In_ volatile UINT32 *pDAR)
+{
+    *pDAR = 0x00000000;
+    ENET_BD_RING_DAR_WRITTEN(pDAR);
+}
+
+// Returns TRUE if the Tx BD is owned by ENET DMA (frame not transmitted yet).
+FORCEINLINE BOOLEAN EnetTxBdIsDmaOwned(_In_ volatile ENET_BD *pBD)
+{
+    return (pBD->ControlStatus & ENET_TX_BD_R_MASK) != 0;
+}
+
+// Passes a single buffer frame to ENET DMA through the Tx BD Idx. The ControlStatus word is written as the last step.
+FORCEINLINE void EnetTxBdSubmit(_Inout_ volatile ENET_BD *pBD, _In_ LONG Idx, _In_ LONG ItemCount, _In_ ULONG BufferAddress, _In_ USHORT DataLen, _In_ ULONG ExtControlStatus)
+{
+    USHORT ControlStatus = ENET_TX_BD_L_MASK | ENET_TX_BD_TC_MASK | ENET_TX_BD_R_MASK;   // Last buffer of the frame, append CRC, owned by ENET DMA
+
+    if (Idx == ItemCount - 1) {
+        ControlStatus |= ENET_TX_BD_W_MASK;                                             // Last BD in BDT must have WRAP bit set
+    }
+    pBD->DataLen          = DataLen;
+    pBD->BufferAddress    = BufferAddress;
+    pBD->ExtControlStatus = ExtControlStatus;
+    pBD->Bdu              = 0;
+    pBD->ControlStatus    = ControlStatus;                                              // Write ControlStatus word of BD as last step
+    ENET_BD_RING_BD_PASSED(pBD);
+    _DataSynchronizationBarrier();                                                      // Wait until write is finished
+}
+
+// Returns TRUE if the Rx BD is owned by ENET DMA (no data received or reception in progress).
+FORCEINLINE BOOLEAN EnetRxBdIsEmpty(_In_ volatile ENET_BD *pBD)
+{
+    return (pBD->ControlStatus & ENET_RX_BD_E_MASK) != 0;
+}
+
+// Returns TRUE if the Rx BD holds the last buffer of a frame. Frame length, error flags and timestamp are valid only in this BD.
+FORCEINLINE BOOLEAN EnetRxBdIsLast(_In_ volatile ENET_BD *pBD)
+{
+    return (pBD->ControlStatus & ENET_RX_BD_L_MASK) != 0;
+}
+
+// Attaches a buffer to the Rx BD Idx and returns the ControlStatus word that passes the BD to ENET DMA. The caller
+// writes the word, so the first BD of a batch can be passed to ENET DMA after all the following ones.
+FORCEINLINE USHORT EnetRxBdPrepare(_Inout_ volatile ENET_BD *pBD, _In_ LONG Idx, _In_ LONG ItemCount, _In_ ULONG BufferAddress)
+{
+    USHORT ControlStatus = ENET_RX_BD_E_MASK | ENET_RX_BD_L_MASK;                       // Empty, ready to receive data
+
+    if (Idx == ItemCount - 1) {
+        ControlStatus |= ENET_RX_BD_W_MASK;                                             // Last BD in BDT must have WRAP bit set
+    }
+    pBD->BufferAddress    = BufferAddress;
+    pBD->ExtControlStatus = ENET_RX_BD_INT_MASK;                                        // Generate RXF interrupt
+    pBD->Bdu              = 0;                                                          // Clear "BD updated" flag
+    return ControlStatus;
+}
+
+// Returns the number of Rx BDs a frame starting at the BD FirstBDIdx occupies, 0 if the frame has not been completely
+// received yet. A frame longer than the Rx buffer is received into several BDs, only the last one has the L bit set.
+// The BD FirstBDIdx must not be empty, DmaOwnedBDsCount is the number of BDs the frame may span at most.
+FORCEINLINE LONG EnetRxBdRingGetFrameBDCount(_In_ volatile ENET_BD *pDmaBDT, _In_ LONG ItemCount, _In_ LONG FirstBDIdx, _In_ LONG DmaOwnedBDsCount)
+{
+    LONG BDIdx        = FirstBDIdx;
+    LONG FrameBDCount = 1;
+
+    while (!EnetRxBdIsLast(&pDmaBDT[BDIdx])) {
+        if (FrameBDCount == DmaOwnedBDsCount) {                                         // No more BDs owned by ENET DMA?
+            return 0;
+        }
+        BDIdx = EnetBdRingNextIdx(BDIdx, ItemCount);
+        if (EnetRxBdIsEmpty(&pDmaBDT[BDIdx])) {                                         // Reception of the frame still in progress?
+            return 0;
+        }
+        FrameBDCount++;
+    }
+    return FrameBDCount;
+}
+
+// Called by EnetRxBdRingWalkFrame() for the BD Idx, the FrameBDIdx-th BD of the frame, holding BufferLength bytes of it.
+typedef void ENET_RX_BD_BUFFER(_In_opt_ void *pContext, _In_ LONG FrameBDIdx, _In_ LONG Idx, _In_ ULONG BufferLength);
+
+// Calls pfnBuffer for each of the FrameBDCount BDs of a received frame, in ring order. A BD without the L bit is full
+// (data length = MRBR), the data length of the last BD is the frame length.
+FORCEINLINE void EnetRxBdRingWalkFrame(_In_ volatile ENET_BD *pDmaBDT, _In_ LONG ItemCount, _In_ LONG FirstBDIdx, _In_ LONG FrameBDCount, _In_ ENET_RX_BD_BUFFER *pfnBuffer, _In_opt_ void *pContext)
+{
+    ULONG BufferedLength = 0;
+    LONG  BDIdx          = FirstBDIdx;
+
+    for (LONG FrameBDIdx = 0; FrameBDIdx < FrameBDCount - 1; ++FrameBDIdx) {
+        pfnBuffer(pContext, FrameBDIdx, BDIdx, pDmaBDT[BDIdx].DataLen);
+        BufferedLength += pDmaBDT[BDIdx].DataLen;
+        BDIdx = EnetBdRingNextIdx(BDIdx, ItemCount);
+    }
+    pfnBuffer(pContext, FrameBDCount - 1, BDIdx, pDmaBDT[BDIdx].DataLen - BufferedLength);
+}
+
+// A batch of buffers returned to an Rx ring. The buffers are attached to consecutive BDs starting at the first free
+// one, each BD is passed to ENET DMA as soon as it is prepared except the first one, which is passed by
+// EnetRxBdBatchCommit() after all the others, so ENET DMA never runs into a partially prepared batch.
+typedef struct _ENET_RX_BD_BATCH {
+    volatile ENET_BD   *pDmaBDT;
+    LONG                ItemCount;
+    LONG                FreeBDIdx;                                                      // Next BD a buffer is attached to
+    volatile ENET_BD   *pFirstBD;                                                       // First BD of the batch, NULL if the batch is empty
+    USHORT              FirstControlStatus;                                             // ControlStatus word of the first BD
+} ENET_RX_BD_BATCH;
+
+FORCEINLINE void EnetRxBdBatchBegin(_Out_ ENET_RX_BD_BATCH *pBatch, _In_ volatile ENET_BD *pDmaBDT, _In_ LONG ItemCount, _In_ LONG FreeBDIdx)
+{
+    pBatch->pDmaBDT            = pDmaBDT;
+    pBatch->ItemCount          = ItemCount;
+    pBatch->FreeBDIdx          = FreeBDIdx;
+    pBatch->pFirstBD           = NULL;
+    pBatch->FirstControlStatus = 0;
+}
+
+// Attaches a buffer to the next free BD of the batch. Returns index of the BD.
+FORCEINLINE LONG EnetRxBdBatchAdd(_Inout_ ENET_RX_BD_BATCH *pBatch, _In_ ULONG BufferAddress)
+{
+    LONG              Idx           = pBatch->FreeBDIdx;
+    volatile ENET_BD *pBD           = &pBatch->pDmaBDT[Idx];
+    USHORT            ControlStatus = EnetRxBdPrepare(pBD, Idx, pBatch->ItemCount, BufferAddress);
+
+    pBatch->FreeBDIdx = EnetBdRingNextIdx(Idx, pBatch->ItemCount);
+    if (pBatch->pFirstBD == NULL) {                                                     // For the first BD do not set the ControlStatus word now, do it as the last step
+        pBatch->pFirstBD           = pBD;
+        pBatch->FirstControlStatus = ControlStatus;
+    } else {
+        pBD->ControlStatus = ControlStatus;
+        ENET_BD_RING_BD_PASSED(pBD);
+    }
+    return Idx;
+}
+
+// Passes the first BD of the batch to ENET DMA and (re)starts the ring if ENET DMA stopped before reaching it.
+// Returns index of the first free BD after the batch.
+FORCEINLINE LONG EnetRxBdBatchCommit(_Inout_ ENET_RX_BD_BATCH *pBatch, _In_ volatile UINT32 *pRDAR)
+{
+    volatile ENET_BD *pFirstBD = pBatch->pFirstBD;
+
+    if (pFirstBD != NULL) {
+        pFirstBD->ControlStatus = pBatch->FirstControlStatus;                           // Mark first BD as empty = ready to receive data
+        ENET_BD_RING_BD_PASSED(pFirstBD);
+        _DataSynchronizationBarrier();                                                  // Wait until write is finished
+        (void)pFirstBD->ControlStatus;                                                  // Read ControlStatus back
+        if (!EnetBdRingIsActive(pRDAR)) {                                               // Receive in progress?
+            if (EnetRxBdIsEmpty(pFirstBD)) {                                            // No, transfer not started yet?
+                EnetBdRingKick(pRDAR);                                                  // No, start transfer
+            }
+        }
+    }
+    return pBatch->FreeBDIdx;
+}
+
+// Called by EnetTxBdRingComplete() for the Tx BD Idx passed back by ENET DMA.
+typedef void ENET_TX_BD_COMPLETE(_In_opt_ void *pContext, _In_ LONG Idx);
+
+// Calls pfnComplete for each Tx BD passed back by ENET DMA, in submission order starting at *pPendingBDIdx, and
+// updates *pPendingBDIdx and *pFreeBDCount after each BD. Stops at the first BD still owned by ENET DMA and restarts
+// the ring if ENET DMA stopped before reaching it (ERR006358). Returns the number of completed BDs.
+FORCEINLINE ULONG EnetTxBdRingComplete(_In_ volatile ENET_BD *pDmaBDT, _In_ LONG ItemCount, _In_ volatile UINT32 *pTDAR, _Inout_ LONG *pPendingBDIdx, _Inout_ LONG *pFreeBDCount, _In_ ENET_TX_BD_COMPLETE *pfnComplete, _In_opt_ void *pContext)
+{
+    ULONG Count = 0;
+
+    while (*pFreeBDCount < ItemCount) {                                                 // Any BD submitted to ENET DMA?
+        LONG Idx = *pPendingBDIdx;
+
+        if (EnetTxBdIsDmaOwned(&pDmaBDT[Idx])) {                                        // BD owned by ENET DMA?
+            if (!EnetBdRingIsActive(pTDAR)) {                                           // DMA stopped? (ERR006358 bug fix)
+                EnetBdRingKick(pTDAR);                                                  // Restart DMA
+            }
+            break;
+        }
+        pfnComplete(pContext, Idx);
+        *pPendingBDIdx = EnetBdRingNextIdx(Idx, ItemCount);
+        (*pFreeBDCount)++;
+        Count++;
+    }
+    return Count;
+}
+
+#endif // _MP_BD_RING_H
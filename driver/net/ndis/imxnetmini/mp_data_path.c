@@ -216,20 +216,19 @@ _Use_decl_annotations_
 BOOLEAN MpCheckForHangEx(NDIS_HANDLE MiniportAdapterContext)
 {
     PMP_ADAPTER pAdapter = (PMP_ADAPTER)MiniportAdapterContext;
-    BOOLEAN     isTxHang = TRUE;
+    BOOLEAN     isTxHang = FALSE;
 
-    NdisAcquireSpinLock(&pAdapter->Tx_SpinLock);
-    for(;;) {
-        if (MpQueueGetDepth(&pAdapter->Tx_qDmaOwnedBDs) > 0) {  // Any Tx frame pending in HW?
-            if (++pAdapter->Tx_CheckForHangCounter > 2) {       // Second call of this function without successful Tx transfer?
-                DBG_ENET_DEV_PRINT_ERROR("TX is hang!");
-                break;
+    for (ULONG QueueIdx = 0; QueueIdx < pAdapter->QueueCount; ++QueueIdx) {
+        PMP_TX_QUEUE pTxQueue = &pAdapter->TxQueue[QueueIdx];
+        NdisAcquireSpinLock(&pTxQueue->SpinLock);
+        if (MpQueueGetDepth(&pTxQueue->qDmaOwnedBDs) > 0) {     // Any Tx frame pending in HW?
+            if (++pTxQueue->CheckForHangCounter > 2) {          // Second call of this function without successful Tx transfer?
+                DBG_ENET_DEV_PRINT_ERROR("TX ring %d is hang!", QueueIdx);
+                isTxHang = TRUE;
             }
         }
-        isTxHang = FALSE;
-        break;
+        NdisReleaseSpinLock(&pTxQueue->SpinLock);
     }
-    NdisReleaseSpinLock(&pAdapter->Tx_SpinLock);
     if (TRUE == isTxHang)
         DBG_ENET_DEV_PRINT_ERROR("Requesting Reset by NDIS");
     return isTxHang;
@@ -293,14 +292,19 @@ BOOLEAN MpTxCancelAll(PMP_ADAPTER pAdapter)
     PLIST_ENTRY pListEntry;
 
     InitializeListHead(&CanceledNetBufferList);
-    NdisAcquireSpinLock(&pAdapter->Tx_SpinLock);
-    while ((pListEntry = MpQueueGetNext(&pAdapter->Tx_qDmaOwnedBDs)) != NULL)
-        InsertHeadList(&CanceledNetBufferList, pListEntry);
-    while ((pListEntry = MpQueueGetNext(&pAdapter->Tx_qMpOwnedBDs)) != NULL)
-        InsertHeadList(&CanceledNetBufferList, pListEntry);
+    for (ULONG QueueIdx = 0; QueueIdx < pAdapter->QueueCount; ++QueueIdx) {
+        PMP_TX_QUEUE pTxQueue = &pAdapter->TxQueue[QueueIdx];
+        NdisAcquireSpinLock(&pTxQueue->SpinLock);
+        while ((pListEntry = MpQueueGetNext(&pTxQueue->qDmaOwnedBDs)) != NULL)
+            InsertHeadList(&CanceledNetBufferList, pListEntry);
+        while ((pListEntry = MpQueueGetNext(&pTxQueue->qMpOwnedBDs)) != NULL)
+            InsertHeadList(&CanceledNetBufferList, pListEntry);
+        NdisReleaseSpinLock(&pTxQueue->SpinLock);
+    }
+    NdisAcquireSpinLock(&pAdapter->TxQueue[0].SpinLock);
     CompletionStatus = pAdapter->NdisStatus;                                 // Get the completion status to use
+    NdisReleaseSpinLock(&pAdapter->TxQueue[0].SpinLock);
     BOOLEAN isAnyTxFrameCanceled = !IsListEmpty(&CanceledNetBufferList);     // The status to return...
-    NdisReleaseSpinLock(&pAdapter->Tx_SpinLock);
     // Unwind all canceled NET_BUFFERs
     while (!IsListEmpty(&CanceledNetBufferList)) {
         pListEntry = RemoveTailList(&CanceledNetBufferList);
@@ -330,21 +334,26 @@ void MpCancelSendNetBufferLists(NDIS_HANDLE MiniportAdapterContext, PVOID Cancel
     PMP_ADAPTER       pAdapter = (PMP_ADAPTER)MiniportAdapterContext;
     LIST_ENTRY        CanceledNBList;       // The list of NET_BUFFERs associated with NET_BUFFER_LISTs that should be cancelled.
 
+    PLIST_ENTRY       pListEntry;
+
     InitializeListHead(&CanceledNBList);
-    NdisAcquireSpinLock(&pAdapter->Tx_SpinLock);
-    PLIST_ENTRY pListEntry = MpQueuePeekFirst(&pAdapter->Tx_qMpOwnedBDs);
-    while (pListEntry != NULL) {
-        PMP_TX_BD pMpTxBD = CONTAINING_RECORD(pListEntry, MP_TX_BD, Link);         // Get pMpTxBD address
-        if (NDIS_GET_NET_BUFFER_LIST_CANCEL_ID(pMpTxBD->pNBL) == CancelId) {       // Compare CancelIds
-            PLIST_ENTRY curpListEntry = pListEntry;                                // Remember current pMpTxBD
-            pListEntry = MpQueuePeekNext(&pAdapter->Tx_qMpOwnedBDs, pListEntry);   // Move to next pMpTxBD, before removing...
-            MpQueueRemoveEntry(&pAdapter->Tx_qMpOwnedBDs, curpListEntry);          // Remove pMpTxBD from Tx_qMpOwnedBDs queue
-            InsertHeadList(&CanceledNBList, &pMpTxBD->Link);                       // Add pMpTxBD to the cancel ready queue
-        } else {
-            pListEntry = MpQueuePeekNext(&pAdapter->Tx_qMpOwnedBDs, pListEntry);   // CancelIds are different, move to the next pMpTxBD
+    for (ULONG QueueIdx = 0; QueueIdx < pAdapter->QueueCount; ++QueueIdx) {
+        PMP_TX_QUEUE pTxQueue = &pAdapter->TxQueue[QueueIdx];
+        NdisAcquireSpinLock(&pTxQueue->SpinLock);
+        pListEntry = MpQueuePeekFirst(&pTxQueue->qMpOwnedBDs);
+        while (pListEntry != NULL) {
+            PMP_TX_BD pMpTxBD = CONTAINING_RECORD(pListEntry, MP_TX_BD, Link);         // Get pMpTxBD address
+            if (NDIS_GET_NET_BUFFER_LIST_CANCEL_ID(pMpTxBD->pNBL) == CancelId) {       // Compare CancelIds
+                PLIST_ENTRY curpListEntry = pListEntry;                                // Remember current pMpTxBD
+                pListEntry = MpQueuePeekNext(&pTxQueue->qMpOwnedBDs, pListEntry);      // Move to next pMpTxBD, before removing...
+                MpQueueRemoveEntry(&pTxQueue->qMpOwnedBDs, curpListEntry);             // Remove pMpTxBD from qMpOwnedBDs queue
+                InsertHeadList(&CanceledNBList, &pMpTxBD->Link);                       // Add pMpTxBD to the cancel ready queue
+            } else {
+                pListEntry = MpQueuePeekNext(&pTxQueue->qMpOwnedBDs, pListEntry);      // CancelIds are different, move to the next pMpTxBD
+            }
         }
+        NdisReleaseSpinLock(&pTxQueue->SpinLock);
     }
-    NdisReleaseSpinLock(&pAdapter->Tx_SpinLock);
     while (!IsListEmpty(&CanceledNBList)) {                                        // Unwind all cancelled NET_BUFFERs
         pListEntry = RemoveTailList(&CanceledNBList);
         ASSERT(pListEntry != NULL);
@@ -420,49 +429,48 @@ ULONG MpCopyNetBuffer(_In_ PMP_TX_BD pMpTxBD, _Inout_ PMP_TX_PAYLOAD_BD pEnetSwE
 
 /*++
 Routine Description:
-    It is called to map all NET_BUFFER scatter gather elements into TX DMA descriptors.
+    It is called to map all NET_BUFFER scatter gather elements into TX DMA descriptors of the given ring.
 Arguments:
     pAdapter    Address of the adapter context
+    pTxQueue    Address of the Tx ring
     pMpTxBD     Address of the TCB to be freed
 Return Value:
     None
 --*/
-void MpTxFillEnetTxBD(_In_ PMP_ADAPTER pAdapter, _In_ PMP_TX_BD pMpTxBD)
+void MpTxFillEnetTxBD(_In_ PMP_ADAPTER pAdapter, _In_ PMP_TX_QUEUE pTxQueue, _In_ PMP_TX_BD pMpTxBD)
 {
     PSCATTER_GATHER_LIST sgListPtr = pMpTxBD->pSGList;
-    LONG                 EnetFreeBDIdx = pAdapter->Tx_EnetFreeBDIdx;            // First free Ethernet packet hw buffer descriptor index
-    volatile ENET_BD    *pFreeEnetBD = &pAdapter->Tx_DmaBDT[EnetFreeBDIdx];    // First free Ethernet packet hw buffer descriptor address
-    USHORT               ControlStatus;
+    LONG                 EnetFreeBDIdx = pTxQueue->EnetFreeBDIdx;               // First free Ethernet packet hw buffer descriptor index
+    volatile ENET_BD    *pFreeEnetBD = &pTxQueue->DmaBDT[EnetFreeBDIdx];       // First free Ethernet packet hw buffer descriptor address
+    PMP_TX_PAYLOAD_BD    pEnetSwExtBD = &pTxQueue->EnetSwExtBDT[EnetFreeBDIdx];
     ULONG                bytesToSent;
 
     ASSERT(sgListPtr != NULL);
     ASSERT(sgListPtr->NumberOfElements > 0);
 
     DBG_ENET_DEV_TX_METHOD_BEG();
-    bytesToSent = MpCopyNetBuffer(pMpTxBD, &pAdapter->Tx_EnetSwExtBDT[EnetFreeBDIdx]);          // Copy data to driver provided buffer
+    bytesToSent = MpCopyNetBuffer(pMpTxBD, pEnetSwExtBD);                                       // Copy data to driver provided buffer
     ASSERT(bytesToSent);
-    ASSERT(!(pFreeEnetBD->ControlStatus & ENET_TX_BD_R_MASK));
-    pAdapter->Tx_EnetSwExtBDT[EnetFreeBDIdx].pMpBD = pMpTxBD;                                   // Associate sw MP_TxBD with current hw ENET_TxBD
-    ControlStatus = ENET_TX_BD_L_MASK | ENET_TX_BD_TC_MASK | ENET_TX_BD_R_MASK;                 // Prepare transfer flags
-    if (++EnetFreeBDIdx == pAdapter->Tx_DmaBDT_ItemCount) {                                     // Update Free BD index
-        ControlStatus |= ENET_TX_BD_W_MASK;                                                     // Last BD in BDT must have WRAP bit set
-        EnetFreeBDIdx = 0;                                                                      // Free BD is the first item of Tx_DmaBDT
-    }
-    pAdapter->Tx_EnetFreeBDIdx = EnetFreeBDIdx;
-    pAdapter->Tx_EnetFreeBDCount--;
+    ASSERT(!EnetTxBdIsDmaOwned(pFreeEnetBD));
+    pEnetSwExtBD->pMpBD = pMpTxBD;                                                              // Associate sw MP_TxBD with current hw ENET_TxBD
+    pEnetSwExtBD->PtpEvent = Enet1588ParsePtpEvent(pEnetSwExtBD->pBuffer, bytesToSent, &pEnetSwExtBD->PtpId);
+    pTxQueue->EnetFreeBDIdx = EnetBdRingNextIdx(EnetFreeBDIdx, pAdapter->Tx_DmaBDT_ItemCount);  // Update Free BD index
+    pTxQueue->EnetFreeBDCount--;
 
-    pFreeEnetBD->DataLen        = (USHORT)sgListPtr->Elements[0].Length;                       // Set ENET_TxBD data length
-    pFreeEnetBD->BufferAddress  = NdisGetPhysicalAddressLow(sgListPtr->Elements[0].Address);   // Set ENET_TxBD data address
-    pFreeEnetBD->ControlStatus  = ControlStatus;                                               // Write ControlStatus word of BD as last step
-    _DataSynchronizationBarrier();                                                             // Wait for read is finished
-    ControlStatus = pFreeEnetBD->ControlStatus;                                                // Read ControlStatus back
+    EnetTxBdSubmit(pFreeEnetBD, EnetFreeBDIdx, pAdapter->Tx_DmaBDT_ItemCount,
+                   NdisGetPhysicalAddressLow(sgListPtr->Elements[0].Address),                  // ENET_TxBD data address
+                   (USHORT)sgListPtr->Elements[0].Length,                                      // ENET_TxBD data length
+                   ENET_TX_BD_INT_MASK |                                                       // Generate TXF interrupt
+                   (pEnetSwExtBD->PtpEvent ? ENET_TX_BD_TS_MASK : 0) |                         // Capture transmit timestamp of PTP event messages
+                   (pTxQueue->Idx << ENET_TX_BD_FTYPE_SHIFT));                                 // Frame class of the ring (AVB rings 1 and 2)
+    (void)pFreeEnetBD->ControlStatus;                                                          // Read ControlStatus back
     _DataSynchronizationBarrier();                                                             // Wait for read is finished
     DBG_ENET_DEV_TX_PRINT_TRACE("NB(%d): Added to ENET_BD, Size: %5d.",pMpTxBD->NBId,(USHORT)sgListPtr->Elements[0].Length);
-    if (pAdapter->ENETRegBase->TDAR == 0) {
+    if (!EnetBdRingIsActive(pTxQueue->pTDAR)) {
         _DataSynchronizationBarrier();                                                         // Wait for read is finished
-        if (pFreeEnetBD->ControlStatus & ENET_TX_BD_R_MASK) {                                  // Transfer not started yet?
-            DBG_ENET_DEV_TX_PRINT_TRACE("NB(%d): Starting transfer. TDAR: 0x%08X, EIR: 0x%08X", pMpTxBD->NBId, pAdapter->ENETRegBase->TDAR, pAdapter->ENETRegBase->EIR.U);
-            pAdapter->ENETRegBase->TDAR = 0x00000000;                                          // No, start transfer
+        if (EnetTxBdIsDmaOwned(pFreeEnetBD)) {                                                 // Transfer not started yet?
+            DBG_ENET_DEV_TX_PRINT_TRACE("NB(%d): Starting transfer. TDAR: 0x%08X, EIR: 0x%08X", pMpTxBD->NBId, *pTxQueue->pTDAR, pAdapter->ENETRegBase->EIR.U);
+            EnetBdRingKick(pTxQueue->pTDAR);                                                   // No, start transfer
         }
     }
     DBG_ENET_DEV_TX_METHOD_END();
@@ -479,34 +487,35 @@ Routine Description:
     pending frames.
 Arguments:
     pAdapter    Address of the adapter context
+    pTxQueue    Address of the Tx ring
 Return Value:
     None
 --*/
-void MpSendNextNB(_In_ PMP_ADAPTER pAdapter)
+void MpSendNextNB(_In_ PMP_ADAPTER pAdapter, _In_ PMP_TX_QUEUE pTxQueue)
 {
     DBG_ENET_DEV_TX_METHOD_BEG();
-    NdisAcquireSpinLock(&pAdapter->Tx_SpinLock);
+    NdisAcquireSpinLock(&pTxQueue->SpinLock);
     do {
         if (pAdapter->NdisStatus != NDIS_STATUS_SUCCESS)  {                       // Make sure the adapter is ready
             DBG_SM_PRINT_TRACE("NIC is not ready ");
             break;
         }
         for (;;) {
-            if ((pAdapter->Tx_EnetFreeBDCount == 0)) {                            // No Dma BD empty?
+            if ((pTxQueue->EnetFreeBDCount == 0)) {                               // No Dma BD empty?
 //TODO                DBG_ENET_DEV_TX_PRINT_TRACE("NB(%d) - OUT of ENET_TxBD", pAdapter->Tx_pCurrentMpBD->NBId);
-                break;                                                            // Do nothing, Tx DPC will dequeue NB from Tx_qMpOwnedBDs
+                break;                                                            // Do nothing, Tx DPC will dequeue NB from qMpOwnedBDs
             }
-            PLIST_ENTRY pListEntry = MpQueueGetNext(&pAdapter->Tx_qMpOwnedBDs);   // Get NB from remove from Miniport queue
+            PLIST_ENTRY pListEntry = MpQueueGetNext(&pTxQueue->qMpOwnedBDs);      // Get NB from remove from Miniport queue
             if (pListEntry == NULL) {                                             // Queue empty?
-                DBG_ENET_DEV_TX_PRINT_TRACE("Tx_qMpOwnedBDs EMPTY");
+                DBG_ENET_DEV_TX_PRINT_TRACE("qMpOwnedBDs EMPTY");
                 break;                                                            // Yes, no more NBs to send.
             }
             PMP_TX_BD Tx_pCurrentMpBD = Tx_pCurrentMpBD = CONTAINING_RECORD(pListEntry, MP_TX_BD, Link);  // Get NB address
-            MpQueueAdd(&pAdapter->Tx_qDmaOwnedBDs, &Tx_pCurrentMpBD->Link);                               // Add NB to the DMA queue
-            MpTxFillEnetTxBD(pAdapter, Tx_pCurrentMpBD);                                                  // Put data to HW add start transfer
+            MpQueueAdd(&pTxQueue->qDmaOwnedBDs, &Tx_pCurrentMpBD->Link);                                  // Add NB to the DMA queue
+            MpTxFillEnetTxBD(pAdapter, pTxQueue, Tx_pCurrentMpBD);                                        // Put data to HW add start transfer
         } // Keep processing queued TX frames
     } while (0);
-    NdisReleaseSpinLock(&pAdapter->Tx_SpinLock);
+    NdisReleaseSpinLock(&pTxQueue->SpinLock);
     DBG_ENET_DEV_TX_METHOD_END();
 }
 
@@ -531,9 +540,43 @@ void MpProcessSGList(PDEVICE_OBJECT DeviceObjectPtr, PVOID Reserved, PSCATTER_GA
     UNREFERENCED_PARAMETER(DeviceObjectPtr);
     UNREFERENCED_PARAMETER(Reserved);
 
-//TODO    DBG_ENET_DEV_TX_PRINT_TRACE("NB(%d) Adding to Tx_qMpOwnedBDs queue", pMpTxBD->NBId);
+//TODO    DBG_ENET_DEV_TX_PRINT_TRACE("NB(%d) Adding to qMpOwnedBDs queue", pMpTxBD->NBId);
     pMpTxBD->pSGList = SGListPtr;
-    MpQueueAdd(&pMpTxBD->pAdapter->Tx_qMpOwnedBDs, &pMpTxBD->Link);
+    MpQueueAdd(&pMpTxBD->pTxQueue->qMpOwnedBDs, &pMpTxBD->Link);
+}
+
+/*++
+Routine Description:
+    Selects the Tx ring of a NET_BUFFER_LIST. The ring is given by the 802.1p priority of the frame, taken from the
+    NBL 802.1Q info or from the VLAN tag in the frame, using the same priority to ring map as the Rx classification.
+Arguments:
+    pAdapter    Address of the adapter context
+    pNBL        The NET_BUFFER_LIST to send
+Return Value:
+    Address of the Tx ring.
+--*/
+static PMP_TX_QUEUE MpTxSelectQueue(_In_ PMP_ADAPTER pAdapter, _In_ PNET_BUFFER_LIST pNBL)
+{
+    static const UCHAR PriorityToQueue[] = ENET_PRIORITY_TO_QUEUE_MAP;
+    NDIS_NET_BUFFER_LIST_8021Q_INFO Ieee8021QInfo;
+    ULONG QueueIdx = 0;
+    UCHAR Header[ETH_LENGTH_OF_ADDRESS * 2 + 4];    // Destination and source address, VLAN tag
+
+    if (pAdapter->QueueCount > 1) {
+        Ieee8021QInfo.Value = NET_BUFFER_LIST_INFO(pNBL, Ieee8021QNetBufferListInfo);
+        if (Ieee8021QInfo.TagHeader.UserPriority != 0) {                                  // Priority given by NDIS?
+            QueueIdx = PriorityToQueue[Ieee8021QInfo.TagHeader.UserPriority];
+        } else {                                                                          // No, check the VLAN tag in the frame
+            PUCHAR pHeader = (PUCHAR)NdisGetDataBuffer(NET_BUFFER_LIST_FIRST_NB(pNBL), sizeof(Header), Header, 1, 0);
+            if ((pHeader != NULL) && (pHeader[12] == 0x81) && (pHeader[13] == 0x00)) {
+                QueueIdx = PriorityToQueue[pHeader[14] >> 5];
+            }
+        }
+        if (QueueIdx >= pAdapter->QueueCount) {
+            QueueIdx = pAdapter->QueueCount - 1;
+        }
+    }
+    return &pAdapter->TxQueue[QueueIdx];
 }
 
 /*++
@@ -558,14 +601,16 @@ void MpSendNetBufferLists(NDIS_HANDLE MiniportAdapterContext, PNET_BUFFER_LIST N
     PNET_BUFFER_LIST  pCurrentNBL;
     PNET_BUFFER       pCurrentNB;
     PMP_TX_BD         pMpTxBD;
+    PMP_TX_QUEUE      pTxQueue;
+    ULONG             QueuedQueueMask      = 0;
 
     UNREFERENCED_PARAMETER(PortNumber);
     DBG_ENET_DEV_TX_METHOD_BEG();
 
     for(;;) {
-        NdisAcquireSpinLock(&pAdapter->Tx_SpinLock);
+        NdisAcquireSpinLock(&pAdapter->TxQueue[0].SpinLock);
         status = pAdapter->NdisStatus;
-        NdisReleaseSpinLock(&pAdapter->Tx_SpinLock);
+        NdisReleaseSpinLock(&pAdapter->TxQueue[0].SpinLock);
         if (status != NDIS_STATUS_SUCCESS)  {                                                 // Make sure the adapter is ready
             DBG_SM_PRINT_TRACE("NIC is not ready ");
             break;
@@ -577,6 +622,7 @@ void MpSendNetBufferLists(NDIS_HANDLE MiniportAdapterContext, PNET_BUFFER_LIST N
             #if DBG
             MP_NBL_SET_ID(pCurrentNBL, NdisInterlockedIncrement(&pAdapter->Tx_NBLCounter));   // Save NBL sequence number
             #endif
+            pTxQueue = MpTxSelectQueue(pAdapter, pCurrentNBL);                                // All NBs of the NBL are sent on the same ring
             // For all NB in current NBL do:
             for (pCurrentNB = NET_BUFFER_LIST_FIRST_NB(pCurrentNBL); pCurrentNB != NULL; pCurrentNB = NET_BUFFER_NEXT_NB(pCurrentNB)) {
                 NdisInterlockedIncrement(&MP_NBL_NB_Counter(pCurrentNBL));                     // Increment pending NB counter in NBL
@@ -594,14 +640,15 @@ void MpSendNetBufferLists(NDIS_HANDLE MiniportAdapterContext, PNET_BUFFER_LIST N
                 #endif
                 DBG_ENET_DEV_TX_PRINT_TRACE("NB(%d) MpTxBD allocated ", pMpTxBD->NBId);
                 pMpTxBD->pAdapter  = pAdapter;
+                pMpTxBD->pTxQueue  = pTxQueue;
                 pMpTxBD->pNBL      = pCurrentNBL;                          // Associate NBL with MpTxBD
                 pMpTxBD->pNB       = pCurrentNB;                           // Associate NB with MpTxBD
                 pMpTxBD->pSGList   = NULL;
                 // Map the buffer to its physically contiguous fragments. NdisMAllocateNetBufferSGList needs to be called at DISPATCH_LEVEL
                 DBG_ENET_DEV_TX_PRINT_TRACE("NB(%d) Calling AllocSGList()", pMpTxBD->NBId);
-                NdisAcquireSpinLock(&pAdapter->Tx_SpinLock);
+                NdisAcquireSpinLock(&pTxQueue->SpinLock);
                 status = NdisMAllocateNetBufferSGList(pAdapter->Tx_DmaHandle, pCurrentNB, pMpTxBD, NDIS_SG_LIST_WRITE_TO_DEVICE, &pMpTxBD->SGList, pAdapter->Tx_SGListSize);
-                NdisReleaseSpinLock(&pAdapter->Tx_SpinLock);
+                NdisReleaseSpinLock(&pTxQueue->SpinLock);
                 if (status != NDIS_STATUS_SUCCESS) {                       // Fail to allocate memory from non-paged pool for SGList
                     DBG_ENET_DEV_PRINT_ERROR("NB(%d) NdisMAllocateNetBufferSGList() failed. Status: 0x%08X", pMpTxBD->NBId, status);
                     break;
@@ -610,6 +657,7 @@ void MpSendNetBufferLists(NDIS_HANDLE MiniportAdapterContext, PNET_BUFFER_LIST N
             }
             if (status == NDIS_STATUS_SUCCESS) {
                 uQueuedPacketCounter++;
+                QueuedQueueMask |= 1UL << pTxQueue->Idx;
             } else {  // handle error case
                 if (pCurrentNB != NULL) {
                     pMpTxBD = MP_NB_pMpTxBD(pCurrentNB);
@@ -647,11 +695,55 @@ void MpSendNetBufferLists(NDIS_HANDLE MiniportAdapterContext, PNET_BUFFER_LIST N
             NdisMSendNetBufferListsComplete(pAdapter->AdapterHandle, pNextNBL, sendCompleteFlags);
         }
     }
-    if (uQueuedPacketCounter != 0) // If at lease one NBL (packet) was queued, kick off the transmission, if it had not been already started.
-        MpSendNextNB(pAdapter);    // Send queued NBs (Ethernet frames)
+    if (uQueuedPacketCounter != 0) { // If at lease one NBL (packet) was queued, kick off the transmission, if it had not been already started.
+        for (ULONG QueueIdx = 0; QueueIdx < pAdapter->QueueCount; ++QueueIdx) {
+            if (QueuedQueueMask & (1UL << QueueIdx)) {
+                MpSendNextNB(pAdapter, &pAdapter->TxQueue[QueueIdx]);   // Send queued NBs (Ethernet frames)
+            }
+        }
+    }
     DBG_ENET_DEV_TX_METHOD_END();
 }
 
+typedef struct _MP_TX_COMPLETE_CTX {
+    PMP_ADAPTER     pAdapter;
+    PMP_TX_QUEUE    pTxQueue;
+    PLIST_ENTRY     pCompletedList;                                                      // Completed MP_TX_BDs
+    ULONG64         Now;                                                                 // Time base for the Tx timestamps, read on the first one
+} MP_TX_COMPLETE_CTX;
+
+/*++
+Routine Description:
+    ENET_TX_BD_COMPLETE callback of MpHandleTxInterrupt(). Moves the Mp Tx BD of a transmitted ENET_TxBD to the
+    completed list and logs the transmit timestamp of a PTP event message.
+    Assumption: Tx ring spin lock has been acquired
+Arguments:
+    pContext    MP_TX_COMPLETE_CTX
+    Idx         Index of the ENET_TxBD passed back by ENET DMA
+Return Value:
+    None
+--*/
+static void MpTxCompleteBD(_In_opt_ void *pContext, _In_ LONG Idx)
+{
+    MP_TX_COMPLETE_CTX *pCtx     = (MP_TX_COMPLETE_CTX *)pContext;
+    PMP_TX_QUEUE        pTxQueue = pCtx->pTxQueue;
+    PMP_TX_PAYLOAD_BD   pSwExtBD = &pTxQueue->EnetSwExtBDT[Idx];
+    PMP_TX_BD           pMpTxBD  = pSwExtBD->pMpBD;                                      // Get Mp NB Tx BD
+
+    ASSERT(pMpTxBD != NULL);
+    pSwExtBD->pMpBD = NULL;                                                              // Mark Mp NB Tx BD as "already processed"
+    if (pSwExtBD->PtpEvent) {                                                            // PTP event message sent?
+        if (pCtx->Now == 0) {
+            pCtx->Now = Enet1588GetTime(pCtx->pAdapter);
+        }
+        Enet1588LogTimestamp(pCtx->pAdapter, ENET_1588_TIMESTAMP_TX, &pSwExtBD->PtpId, Enet1588ExtendTimestamp(pCtx->Now, pTxQueue->DmaBDT[Idx].Timestamp));
+    }
+    DBG_ENET_DEV_TX_PRINT_TRACE("NB(%d) 0x%08X done, adding it to the complete queue.", pMpTxBD->NBId, pMpTxBD->pNB);
+    (void)MpQueueGetNext(&pTxQueue->qDmaOwnedBDs);                                       // Remove the TX BD from the 'in progress' queue
+    InsertHeadList(pCtx->pCompletedList, &pMpTxBD->Link);                                // Put BD to the completed BD queue
+    pTxQueue->CheckForHangCounter = 0;                                                   // Restart "check for hang" counter
+}
+
 /*++
 Routine Description:
     It is called from EnetDpc() to handle 'frame transmission complete' interrupts.
@@ -659,49 +751,31 @@ Routine Description:
     and tries to send the next queued outgoing frame.
 Arguments:
     pAdapter        The miniport adapter context
+    pTxQueue        The Tx ring to serve
     InterruptEvent  The Interrupt Event Register image.
 Return Value:
     None
 --*/
 _Use_decl_annotations_
-void MpHandleTxInterrupt(PMP_ADAPTER pAdapter, UINT32 InterruptEvent)
+void MpHandleTxInterrupt(PMP_ADAPTER pAdapter, PMP_TX_QUEUE pTxQueue, UINT32 InterruptEvent)
 {
-    LIST_ENTRY         completedNetBufferList;
-    LONG               EnetPendingBDIdx;
-    volatile ENET_BD  *pDmaTxBD;
-    PMP_TX_BD          pMpTxBD = NULL;
+    LIST_ENTRY           completedNetBufferList;
+    PMP_TX_BD            pMpTxBD = NULL;
+    MP_TX_COMPLETE_CTX   CompleteCtx;
 
     UNREFERENCED_PARAMETER(InterruptEvent);
     InitializeListHead(&completedNetBufferList);
     DBG_ENET_DEV_DPC_TX_METHOD_BEG();
+    CompleteCtx.pAdapter       = pAdapter;
+    CompleteCtx.pTxQueue       = pTxQueue;
+    CompleteCtx.pCompletedList = &completedNetBufferList;
+    CompleteCtx.Now            = 0;
 
-    NdisDprAcquireSpinLock(&pAdapter->Tx_SpinLock);
-    EnetPendingBDIdx = pAdapter->Tx_EnetPendingBDIdx;
-    DBG_ENET_DEV_TX_PRINT_TRACE("**** ISR,  Tx_EnetPendingBDIdx: %d, Tx_EnetFreeBDIdx: %d, flags: 0x%08X, TDAR: 0x%08X ****", pAdapter->Tx_EnetPendingBDIdx, pAdapter->Tx_EnetFreeBDIdx, InterruptEvent, pAdapter->ENETRegBase->TDAR);
-    do {
-        pMpTxBD = pAdapter->Tx_EnetSwExtBDT[EnetPendingBDIdx].pMpBD;                     // Get Mp NB Tx BD
-        if (pMpTxBD == NULL) {                                                           // Mp NB Tx BD already processed as the first item in this loop?
-            break;                                                                       // Break the loop
-        }
-        pDmaTxBD = &pAdapter->Tx_DmaBDT[EnetPendingBDIdx];                               // Get Dma Tx BD
-        if (pDmaTxBD->ControlStatus & ENET_TX_BD_R_MASK) {                               // Dma Tx BD owned by DMA engine?
-            if (pAdapter->ENETRegBase->TDAR == 0) {                                      // DMA stopped? (ERR006358 bug fix)
-                pAdapter->ENETRegBase->TDAR = 0x0000000;                                 // Restart DMA
-            }
-            break;                                                                       // Break the loop
-        }
-        pAdapter->Tx_EnetSwExtBDT[EnetPendingBDIdx].pMpBD = NULL;                        // Mark Mp NB Tx BD as "already processed"
-        if (++EnetPendingBDIdx >= pAdapter->Tx_DmaBDT_ItemCount)                         // Updated ENET_BDT index
-            EnetPendingBDIdx = 0;
-        pAdapter->Tx_EnetFreeBDCount ++;                                                 // Update Free ENET_TxBD counter
-        pAdapter->Tx_EnetPendingBDIdx = EnetPendingBDIdx;                                // Update pending BD index
-        DBG_ENET_DEV_TX_PRINT_TRACE("NB(%d) 0x%08X done, adding it to the complete queue.", pMpTxBD->NBId, pMpTxBD->pNB);
-        (void)MpQueueGetNext(&pAdapter->Tx_qDmaOwnedBDs);           // Remove the TX BD from the 'in progress' queue
-        InsertHeadList(&completedNetBufferList, &pMpTxBD->Link);                         // Put BD to the completed BD queue
-        pAdapter->Tx_CheckForHangCounter = 0;                                            // Restart "check for hang" counter
-    } while (EnetPendingBDIdx != pAdapter->Tx_EnetFreeBDIdx);
-    DBG_ENET_DEV_TX_PRINT_TRACE("**** ISR, Before release spin lock, Tx_EnetPendingBDIdx: %d, Tx_EnetFreeBDIdx: %d", pAdapter->Tx_EnetPendingBDIdx, pAdapter->Tx_EnetFreeBDIdx);
-    NdisDprReleaseSpinLock(&pAdapter->Tx_SpinLock);
+    NdisDprAcquireSpinLock(&pTxQueue->SpinLock);
+    DBG_ENET_DEV_TX_PRINT_TRACE("**** ISR, ring %d, EnetPendingBDIdx: %d, EnetFreeBDIdx: %d, flags: 0x%08X, TDAR: 0x%08X ****", pTxQueue->Idx, pTxQueue->EnetPendingBDIdx, pTxQueue->EnetFreeBDIdx, InterruptEvent, *pTxQueue->pTDAR);
+    (void)EnetTxBdRingComplete(pTxQueue->DmaBDT, pAdapter->Tx_DmaBDT_ItemCount, pTxQueue->pTDAR, &pTxQueue->EnetPendingBDIdx, &pTxQueue->EnetFreeBDCount, MpTxCompleteBD, &CompleteCtx);
+    DBG_ENET_DEV_TX_PRINT_TRACE("**** ISR, Before release spin lock, EnetPendingBDIdx: %d, EnetFreeBDIdx: %d", pTxQueue->EnetPendingBDIdx, pTxQueue->EnetFreeBDIdx);
+    NdisDprReleaseSpinLock(&pTxQueue->SpinLock);
 
     while (!IsListEmpty(&completedNetBufferList)) {                                      // Unwind all completed NET_BUFFERs
         PLIST_ENTRY pListEntry = RemoveTailList(&completedNetBufferList);
@@ -711,7 +785,7 @@ void MpHandleTxInterrupt(PMP_ADAPTER pAdapter, UINT32 InterruptEvent)
         NDIS_STATUS completionStatus = (InterruptEvent & ENET_TX_ERR_INT_MASK)? NDIS_STATUS_FAILURE : NDIS_STATUS_SUCCESS;   // Get the completion status
         MpTxUnwindNetBuffer(pAdapter, pMpTxBD->pNBL, pMpTxBD->pNB, completionStatus, NDIS_SEND_COMPLETE_FLAGS_DISPATCH_LEVEL);
     } // More completed TX frames
-    MpSendNextNB(pAdapter);            // Send next waiting TX frames, if any...
+    MpSendNextNB(pAdapter, pTxQueue);  // Send next waiting TX frames, if any...
     DBG_ENET_DEV_DPC_TX_METHOD_END();
     return;
 }
@@ -727,11 +801,14 @@ Return Value:
 _Use_decl_annotations_
 VOID MpTxInit(PMP_ADAPTER pAdapter)
 {
-    pAdapter->Tx_CheckForHangCounter = 0;
-    pAdapter->Tx_EnetFreeBDCount     = pAdapter->Tx_DmaBDT_ItemCount;    // Initialize number of unused Ethernet Buffer Descriptors
-    pAdapter->Tx_EnetFreeBDIdx       = 0;
-    pAdapter->Tx_EnetPendingBDIdx    = 0;
-
+    for (ULONG QueueIdx = 0; QueueIdx < pAdapter->QueueCount; ++QueueIdx) {
+        PMP_TX_QUEUE pTxQueue = &pAdapter->TxQueue[QueueIdx];
+        pTxQueue->CheckForHangCounter = 0;
+        pTxQueue->EnetFreeBDCount     = pAdapter->Tx_DmaBDT_ItemCount;   // Initialize number of unused Ethernet Buffer Descriptors
+        pTxQueue->EnetFreeBDIdx       = 0;
+        pTxQueue->EnetPendingBDIdx    = 0;
+        NdisZeroMemory((VOID*)pTxQueue->DmaBDT, pTxQueue->DmaBDT_Size);  // Zero TxBDT
+    }
     pAdapter->TxdStatus.FramesXmitGood            = 0;
     pAdapter->TxdStatus.FramesXmitBad             = 0;
     pAdapter->TxdStatus.FramesXmitHBErrors        = 0;
@@ -739,7 +816,6 @@ VOID MpTxInit(PMP_ADAPTER pAdapter)
     pAdapter->TxdStatus.FramesXmitCollisionErrors = 0;
     pAdapter->TxdStatus.FramesXmitAbortedErrors   = 0;
     pAdapter->TxdStatus.FramsXmitCarrierErrors    = 0;
-    NdisZeroMemory((VOID*)pAdapter->Tx_DmaBDT, pAdapter->Tx_DmaBDT_Size);      // Zero TxBDT
 }
 
 /*++
@@ -753,26 +829,25 @@ Return Value:
 _Use_decl_annotations_
 void MpRxInit(PMP_ADAPTER pAdapter)
 {
-    PENET_BD             pDmaBD = NULL;
-
     ASSERT(pAdapter->Rx_DmaBDT_ItemCount);                                                // There must be at least one Rx buffer
-    pAdapter->Rx_EnetFreeBDIdx           = 0;                                             // Initialize HW Dma buffer descriptor ring index
-    pAdapter->Rx_EnetPendingBDIdx        = 0;                                             
-    pAdapter->Rx_NBLCounter              = 0;
-    pAdapter->Rx_NdisOwnedBDsCount       = 0;                                             // No buffer is owned by NDIS
-    pAdapter->Rx_DmaBDT_DmaOwnedBDsCount = pAdapter->Rx_DmaBDT_ItemCount;                 // All Rx BDs are owned by ENET DMA
+    pAdapter->Rx_NBLCounter = 0;
     NdisZeroMemory(&pAdapter->RcvStatus, sizeof(pAdapter->RcvStatus));
-    for (LONG Idx = 0; Idx < pAdapter->Rx_DmaBDT_ItemCount; ++Idx) {                      // For each DmaBD do:
-        MP_RX_FRAME_BD *pRxFrameBD = &pAdapter->Rx_FrameBDT[Idx];
-        pDmaBD = &pAdapter->Rx_DmaBDT[Idx];                                               // Get DmaBD address
-        pAdapter->Rx_DmaBDT_SwExt[Idx].pRxFrameBD = pRxFrameBD;                           // Create link between Rx frame descriptor and DmaBD
-        NET_BUFFER_LIST_NEXT_NBL(pRxFrameBD->pNBL) = NULL;                                // Not necessary consider removing
-        pDmaBD->BufferAddress = pRxFrameBD->BufferPa.LowPart;                             // Fill DmaBD data buffer address
-        pDmaBD->ControlStatus = ENET_RX_BD_E_MASK | ENET_RX_BD_L_MASK;                    // Fill DMaBD Status (Mark DmaBD as ready to receive data)
-        /* MS-temp */ NdisAdjustMdlLength(pRxFrameBD->pMdl, ENET_RX_FRAME_SIZE);
-    }
-    if (pDmaBD) {
-        pDmaBD->ControlStatus |= ENET_RX_BD_W_MASK;                                       // Mark last DmaBD
+    for (ULONG QueueIdx = 0; QueueIdx < pAdapter->QueueCount; ++QueueIdx) {
+        PMP_RX_QUEUE pRxQueue = &pAdapter->RxQueue[QueueIdx];
+        pRxQueue->EnetFreeBDIdx           = 0;                                            // Initialize HW Dma buffer descriptor ring index
+        pRxQueue->EnetPendingBDIdx        = 0;
+        pRxQueue->NdisOwnedBDsCount       = 0;                                            // No buffer is owned by NDIS
+        pRxQueue->DmaBDT_DmaOwnedBDsCount = pAdapter->Rx_DmaBDT_ItemCount;                // All Rx BDs are owned by ENET DMA
+        for (LONG Idx = 0; Idx < pAdapter->Rx_DmaBDT_ItemCount; ++Idx) {                  // For each DmaBD do:
+            MP_RX_FRAME_BD *pRxFrameBD = &pRxQueue->FrameBDT[Idx];
+            PENET_BD        pDmaBD     = &pRxQueue->DmaBDT[Idx];                          // Get DmaBD address
+            pRxQueue->DmaBDT_SwExt[Idx].pRxFrameBD = pRxFrameBD;                          // Create link between Rx frame descriptor and DmaBD
+            pRxFrameBD->pNextFrameBD = NULL;                                              // No buffer chained
+            pRxFrameBD->pMdl->Next   = NULL;
+            NET_BUFFER_LIST_NEXT_NBL(pRxFrameBD->pNBL) = NULL;                            // Not necessary consider removing
+            pDmaBD->ControlStatus = EnetRxBdPrepare(pDmaBD, Idx, pAdapter->Rx_DmaBDT_ItemCount, pRxFrameBD->BufferPa.LowPart);  // Mark DmaBD as ready to receive data
+            /* MS-temp */ NdisAdjustMdlLength(pRxFrameBD->pMdl, pAdapter->Rx_BufferSize);
+        }
     }
 }
 
@@ -787,17 +862,66 @@ Return Value:
 --*/
 _Use_decl_annotations_
 BOOLEAN IsRxFramePandingInNdis(PMP_ADAPTER pAdapter) {
-    BOOLEAN RxFramePanding;
-    NdisAcquireSpinLock(&pAdapter->Rx_SpinLock);
-    RxFramePanding = pAdapter->Rx_NdisOwnedBDsCount != 0;
-    NdisReleaseSpinLock(&pAdapter->Rx_SpinLock);
+    BOOLEAN RxFramePanding = FALSE;
+    for (ULONG QueueIdx = 0; QueueIdx < pAdapter->QueueCount; ++QueueIdx) {
+        NdisAcquireSpinLock(&pAdapter->RxQueue[QueueIdx].SpinLock);
+        RxFramePanding |= pAdapter->RxQueue[QueueIdx].NdisOwnedBDsCount != 0;
+        NdisReleaseSpinLock(&pAdapter->RxQueue[QueueIdx].SpinLock);
+    }
     return RxFramePanding;
 }
 
+/*++
+Routine Description:
+    Returns a list of RX frames of a single ring to the ring, so the ENET DMA can re-use them for new RX frames.
+Argument:
+    pAdapter
+        Our adapter context
+    pRxQueue
+        The Rx ring all the NBLs belong to
+    pNBL
+        A linked list of NET_BUFFER_LIST objects that we previously indicated to NDIS.
+Return Value:
+    None
+--*/
+static void MpRxQueueReturnNetBufferLists(_In_ PMP_ADAPTER pAdapter, _In_ PMP_RX_QUEUE pRxQueue, _In_ PNET_BUFFER_LIST pNBL)
+{
+    PNET_BUFFER_LIST  pNextNBL;
+    PMP_RX_FRAME_BD   pRxFrameBD, pNextFrameBD;
+    ENET_RX_BD_BATCH  Batch;
+    LONG              Rx_EnetFreeBDIdx;
+
+    NdisAcquireSpinLock(&pRxQueue->SpinLock);
+    EnetRxBdBatchBegin(&Batch, pRxQueue->DmaBDT, pAdapter->Rx_DmaBDT_ItemCount, pRxQueue->EnetFreeBDIdx);
+    // Mark all returned frames as active, so adapter DMA can use them for future RX frames.
+    for (PNET_BUFFER_LIST pCurrentNBL = pNBL; pCurrentNBL != NULL; pCurrentNBL = pNextNBL) {
+        pNextNBL = NET_BUFFER_LIST_NEXT_NBL(pCurrentNBL);
+        for (pRxFrameBD = MP_NBL_RX_FRAME_BD(pCurrentNBL); pRxFrameBD != NULL; pRxFrameBD = pNextFrameBD) {   // For the frame buffer and the chained buffers of a multi-BD frame
+            pNextFrameBD             = pRxFrameBD->pNextFrameBD;
+            pRxFrameBD->pNextFrameBD = NULL;                                        // Unchain the buffer
+            pRxFrameBD->pMdl->Next   = NULL;
+            /* MS-temp */ NdisAdjustMdlLength(pRxFrameBD->pMdl, pAdapter->Rx_BufferSize);
+            pRxQueue->DmaBDT_DmaOwnedBDsCount++;                                        // Increment counter of Rx BDs owned by ENET DMA.
+            pRxQueue->NdisOwnedBDsCount--;
+            if (!pAdapter->EnetStarted) {
+                continue;
+            }
+            ASSERT(!pRxQueue->DmaBDT_SwExt[Batch.FreeBDIdx].pRxFrameBD);
+            /* Reuse frame descriptor */
+            Rx_EnetFreeBDIdx = EnetRxBdBatchAdd(&Batch, pRxFrameBD->BufferPa.LowPart);  // Attach the buffer to the first free Dma BD
+            pRxQueue->DmaBDT_SwExt[Rx_EnetFreeBDIdx].pRxFrameBD = pRxFrameBD;       // Association current Frame BD and the Dma BD
+            DBG_ENET_DEV_RX_PRINT_TRACE("NBL(%4d, 0x%08X) returned,       DmaIdx: %4d, NewDmaIdx: %4d DmaBD ready: %4d, PhyAddr: 0x%08X", MP_NBL_ID(pCurrentNBL), pCurrentNBL, MP_NB_DmaIdx(pCurrentNBL->FirstNetBuffer), Rx_EnetFreeBDIdx, pRxQueue->DmaBDT_DmaOwnedBDsCount, pRxFrameBD->BufferPa.LowPart);
+        }
+    } // More free buffers
+    pRxQueue->EnetFreeBDIdx = EnetRxBdBatchCommit(&Batch, pRxQueue->pRDAR);     // Pass the first Dma BD to ENET DMA, update EnetFreeBDIdx
+    NdisReleaseSpinLock(&pRxQueue->SpinLock);
+}
+
 /*++
 Routine Description:
     MiniportReturnNetBufferLists handler. NDIS will call this function once it is done with the RX frames
     indicated using NdisMIndicateReceiveNetBufferLists(),  so the miniport can re-use them for new RX frames.
+    The list is split by the Rx ring each frame was received on.
 Argument:
     MiniportAdapterContext
         Our adapter context
@@ -812,64 +936,102 @@ _Use_decl_annotations_
 void MpReturnNetBufferLists(NDIS_HANDLE MiniportAdapterContext, PNET_BUFFER_LIST pNBL, ULONG ReturnFlags)
 {
     PMP_ADAPTER       pAdapter = (PMP_ADAPTER)MiniportAdapterContext;
+    PNET_BUFFER_LIST  pQueueNBLHead[QUEUE_COUNT_MAX] = { NULL };
     PNET_BUFFER_LIST  pNextNBL;
-    PMP_RX_FRAME_BD   pRxFrameBD;
-    PENET_BD          pCurrentDmaBD;
-    PENET_BD          pFirstDmaBD = NULL;
-    USHORT            CurrentControlStatus, FirtsControlStatus = 0;
-    LONG              Rx_EnetFreeBDIdx;
 
     UNREFERENCED_PARAMETER(ReturnFlags);
     DBG_ENET_DEV_RX_METHOD_BEG();
-    NdisAcquireSpinLock(&pAdapter->Rx_SpinLock);
-    Rx_EnetFreeBDIdx = pAdapter->Rx_EnetFreeBDIdx;
-    // Mark all returned frames as active, so adapter DMA can use them for future RX frames.
     ASSERT(pNBL);
     for (PNET_BUFFER_LIST pCurrentNBL = pNBL; pCurrentNBL != NULL; pCurrentNBL = pNextNBL) {
+        ULONG QueueIdx = MP_NBL_RX_FRAME_BD(pCurrentNBL)->pRxQueue->Idx;       // Get the ring the frame was received on
         pNextNBL = NET_BUFFER_LIST_NEXT_NBL(pCurrentNBL);
-        pRxFrameBD = MP_NBL_RX_FRAME_BD(pCurrentNBL);                               // Get Frame BD address from the current NBL.
-        /* MS-temp */ NdisAdjustMdlLength(pRxFrameBD->pMdl, ENET_RX_FRAME_SIZE);
-        pAdapter->Rx_DmaBDT_DmaOwnedBDsCount++;                                     // Increment counter of Rx BDs owned by ENET DMA.
-        pAdapter->Rx_NdisOwnedBDsCount--;
-        if (!pAdapter->EnetStarted) {
-            continue;
-        }
-        ASSERT(!pAdapter->Rx_DmaBDT_SwExt[Rx_EnetFreeBDIdx].pRxFrameBD);
-        /* Reuse frame descriptor */
-        pAdapter->Rx_DmaBDT_SwExt[Rx_EnetFreeBDIdx].pRxFrameBD = pRxFrameBD;    // Association current Frame BD and the first free Dma BD
-        DBG_ENET_DEV_RX_PRINT_TRACE("NBL(%4d, 0x%08X) returned,       DmaIdx: %4d, NewDmaIdx: %4d DmaBD ready: %4d, PhyAddr: 0x%08X", MP_NBL_ID(pCurrentNBL), pCurrentNBL, MP_NB_DmaIdx(pCurrentNBL->FirstNetBuffer), Rx_EnetFreeBDIdx, pAdapter->Rx_DmaBDT_DmaOwnedBDsCount, pRxFrameBD->BufferPa.LowPart);
-        pCurrentDmaBD                = &pAdapter->Rx_DmaBDT[Rx_EnetFreeBDIdx];  // Get address of the first free Dma BD
-        pCurrentDmaBD->BufferAddress = pRxFrameBD->BufferPa.LowPart;            // Fill Dma BD data buffer address
-        CurrentControlStatus = ENET_RX_BD_E_MASK;                               // Set EMPTY bit
-        CurrentControlStatus |= ENET_RX_BD_L_MASK;                              // Set LAST bit
-        if (++Rx_EnetFreeBDIdx == pAdapter->Rx_DmaBDT_ItemCount) {              // Compute next Rx_EnetFreeBDIdx
-            Rx_EnetFreeBDIdx = 0;
-            CurrentControlStatus |= ENET_RX_BD_W_MASK;                          // Set WRAP bit in the last Dma BD
-        }
-        if (pFirstDmaBD == NULL) {                                              // For the first returned BD do not set Dma BD control and status word now, do it as the last step
-            pFirstDmaBD = pCurrentDmaBD;                                        // Remember the first free Dma BD address
-            FirtsControlStatus = CurrentControlStatus;                          // Remember Dma BD control and status word for the first free Dma BD
-        } else {
-            pCurrentDmaBD->ControlStatus = CurrentControlStatus;                // Fill Dma BD control and status word
-        }
-    } // More free buffers
-    pAdapter->Rx_EnetFreeBDIdx = Rx_EnetFreeBDIdx;                              // Update Rx_EnetFreeBDIdx
-    if (pFirstDmaBD != NULL) {
-        pFirstDmaBD->ControlStatus = FirtsControlStatus;                        // Mark first Dma BD as empty = ready to receive data
-        _DataSynchronizationBarrier();                                          // Wait until write is finished
-        FirtsControlStatus = pFirstDmaBD->ControlStatus;                        // Read ControlStatus back
-        DBG_ENET_DEV_RX_PRINT_TRACE("NBL(%4d): Added to ENET_BD.",MP_NBL_ID(pNBL));
-        if (pAdapter->ENETRegBase->RDAR == 0) {                                 // Receive in progress?
-            if (pFirstDmaBD->ControlStatus & ENET_RX_BD_E_MASK) {               // No, Transfer not started yet?
-                DBG_ENET_DEV_RX_PRINT_TRACE("NBL(%4d): Starting transfer. TDAR: 0x%08X, EIR: 0x%08X", MP_NBL_ID(pNBL), pAdapter->ENETRegBase->RDAR, pAdapter->ENETRegBase->EIR.U);
-                pAdapter->ENETRegBase->RDAR = 0x00000000;                       // No, start transfer
-            }
+        NET_BUFFER_LIST_NEXT_NBL(pCurrentNBL) = pQueueNBLHead[QueueIdx];        // Move NBL to the ring list
+        pQueueNBLHead[QueueIdx] = pCurrentNBL;
+    }
+    for (ULONG QueueIdx = 0; QueueIdx < QUEUE_COUNT_MAX; ++QueueIdx) {
+        if (pQueueNBLHead[QueueIdx] != NULL) {
+            MpRxQueueReturnNetBufferLists(pAdapter, &pAdapter->RxQueue[QueueIdx], pQueueNBLHead[QueueIdx]);
         }
     }
-    NdisReleaseSpinLock(&pAdapter->Rx_SpinLock);
     DBG_ENET_DEV_RX_METHOD_END();
 }
 
+/*++
+Routine Description:
+    Returns the number of Dma BDs a received frame occupies. A frame longer than the Rx buffer is received into
+    several BDs, only the last one has the L bit set.
+    Assumption: Rx ring spin lock has been acquired
+Arguments:
+    pAdapter    Pointer to the adapter structure.
+    pRxQueue    Pointer to the Rx ring.
+    FirstBDIdx  Index of the first BD of the frame, the BD is not empty.
+Return Value:
+    Number of BDs of the frame, 0 if the frame has not been completely received yet.
+--*/
+static LONG MpRxGetFrameBDCount(_In_ PMP_ADAPTER pAdapter, _In_ PMP_RX_QUEUE pRxQueue, _In_ LONG FirstBDIdx)
+{
+    return EnetRxBdRingGetFrameBDCount(pRxQueue->DmaBDT, pAdapter->Rx_DmaBDT_ItemCount, FirstBDIdx, pRxQueue->DmaBDT_DmaOwnedBDsCount);
+}
+
+typedef struct _MP_RX_CHAIN_CTX {
+    PMP_RX_QUEUE    pRxQueue;
+    PMP_RX_FRAME_BD pPrevFrameBD;                                                              // Last buffer of the chain
+} MP_RX_CHAIN_CTX;
+
+/*++
+Routine Description:
+    ENET_RX_BD_BUFFER callback of MpRxChainFrameBuffers(). Disconnects the buffer of a following BD of the frame from
+    the BD and chains it to the previous buffer, then sets the data length of the buffer.
+    Assumption: Rx ring spin lock has been acquired
+Arguments:
+    pContext      MP_RX_CHAIN_CTX
+    FrameBDIdx    Position of the BD in the frame, the buffer of the first BD is already disconnected.
+    Idx           Index of the BD.
+    BufferLength  Number of frame bytes in the buffer.
+Return Value:
+    None
+--*/
+static void MpRxChainFrameBuffer(_In_opt_ void *pContext, _In_ LONG FrameBDIdx, _In_ LONG Idx, _In_ ULONG BufferLength)
+{
+    MP_RX_CHAIN_CTX *pCtx     = (MP_RX_CHAIN_CTX *)pContext;
+    PMP_RX_QUEUE     pRxQueue = pCtx->pRxQueue;
+
+    if (FrameBDIdx != 0) {
+        PMP_RX_FRAME_BD pNextFrameBD = pRxQueue->DmaBDT_SwExt[Idx].pRxFrameBD;                  // Get the next buffer of the frame
+        ASSERT(pNextFrameBD != NULL);
+        pRxQueue->DmaBDT_SwExt[Idx].pRxFrameBD = NULL;                                         // Disconnect the buffer from ENET DMA BD
+        pRxQueue->DmaBDT_DmaOwnedBDsCount--;                                                   // Decrement counter of Rx BDs owned by ENET DMA
+        pCtx->pPrevFrameBD->pNextFrameBD = pNextFrameBD;                                       // Chain the buffer
+        pCtx->pPrevFrameBD->pMdl->Next   = pNextFrameBD->pMdl;
+        pCtx->pPrevFrameBD               = pNextFrameBD;
+    }
+    /* MS-temp */ NdisAdjustMdlLength(pCtx->pPrevFrameBD->pMdl, BufferLength);
+}
+
+/*++
+Routine Description:
+    Chains the Rx buffers of a frame received into several Dma BDs to the buffer of the first BD. The buffer MDLs
+    are linked, so the NB of the first buffer describes the whole frame. The chain is released by
+    MpRxQueueReturnNetBufferLists().
+    Assumption: Rx ring spin lock has been acquired
+Arguments:
+    pAdapter      Pointer to the adapter structure.
+    pRxQueue      Pointer to the Rx ring.
+    pRxFrameBD    Buffer of the first BD of the frame, already disconnected from the BD.
+    FirstBDIdx    Index of the first BD of the frame.
+    FrameBDCount  Number of BDs of the frame.
+Return Value:
+    None
+--*/
+static void MpRxChainFrameBuffers(_In_ PMP_ADAPTER pAdapter, _In_ PMP_RX_QUEUE pRxQueue, _In_ PMP_RX_FRAME_BD pRxFrameBD, _In_ LONG FirstBDIdx, _In_ LONG FrameBDCount)
+{
+    MP_RX_CHAIN_CTX ChainCtx;
+
+    ChainCtx.pRxQueue     = pRxQueue;
+    ChainCtx.pPrevFrameBD = pRxFrameBD;
+    EnetRxBdRingWalkFrame(pRxQueue->DmaBDT, pAdapter->Rx_DmaBDT_ItemCount, FirstBDIdx, FrameBDCount, MpRxChainFrameBuffer, &ChainCtx);
+}
+
 /*++
 Routine Description:
     Interrupt handler for receive processing. Put the received packets into an array and call
@@ -878,6 +1040,8 @@ Routine Description:
 Arguments:
     pAdapter
         Pointer to the adapter structure.
+    pRxQueue
+        Pointer to the Rx ring to serve.
     pMaxNBLsToIndicate
         A pointer to the maximal number of RX frames we indicate to NDIS
     pRecvThrottleParameters
@@ -887,7 +1051,7 @@ Return Value:
     None
 --*/
 _Use_decl_annotations_
-void MpHandleRecvInterrupt(PMP_ADAPTER pAdapter, PULONG pMaxNBLsToIndicate, PNDIS_RECEIVE_THROTTLE_PARAMETERS pRecvThrottleParameters)
+void MpHandleRecvInterrupt(PMP_ADAPTER pAdapter, PMP_RX_QUEUE pRxQueue, PULONG pMaxNBLsToIndicate, PNDIS_RECEIVE_THROTTLE_PARAMETERS pRecvThrottleParameters)
 {
     PNET_BUFFER_LIST *ppNBLTail;
     PNET_BUFFER_LIST pErrorNBLHead     = NULL;
@@ -898,22 +1062,29 @@ void MpHandleRecvInterrupt(PMP_ADAPTER pAdapter, PULONG pMaxNBLsToIndicate, PNDI
     PNET_BUFFER_LIST pSyncNBLHead      = NULL;
     PNET_BUFFER_LIST pSyncNBLTail      = NULL;
     ULONG            SyncNBLItemCount = 0;
+    LONG             NdisOwnedBDsCount = 0;
+    LONG             FrameBDCount      = 1;
     LONG             Rx_EnetPendingBDIdx;
+    ULONG64          Now = 0;                                                 // Time base for the Rx timestamps, read on the first one
+    ENET_1588_PTP_ID PtpId;
 
     DBG_ENET_DEV_DPC_RX_METHOD_BEG();
-    NdisDprAcquireSpinLock(&pAdapter->Rx_SpinLock);
+    NdisDprAcquireSpinLock(&pRxQueue->SpinLock);
     if (pAdapter->NdisStatus != NDIS_STATUS_SUCCESS) {                        // Mp ready to indicate Rx packets?
-       NdisDprReleaseSpinLock(&pAdapter->Rx_SpinLock);                        // No, do nothing
+       NdisDprReleaseSpinLock(&pRxQueue->SpinLock);                           // No, do nothing
        DBG_ENET_DEV_DPC_RX_METHOD_END();
        return;
     }
-    Rx_EnetPendingBDIdx = pAdapter->Rx_EnetPendingBDIdx;
-    for (LONG Idx = 0; Idx < pAdapter->Rx_DmaBDT_ItemCount; ++Idx) {          // One call of MpHandleRecvInterrupt() will indicate up to pAdapter->Rx_DmaBDT_ItemCount NBLs
-        PENET_BD pDmaBD = &pAdapter->Rx_DmaBDT[Rx_EnetPendingBDIdx];          // Get address of the first not checked BD
-        if (pDmaBD->ControlStatus & ENET_RX_BD_E_MASK) {                      // No data received or reception in progress?
+    Rx_EnetPendingBDIdx = pRxQueue->EnetPendingBDIdx;
+    for (LONG Idx = 0; Idx < pAdapter->Rx_DmaBDT_ItemCount; Idx += FrameBDCount) { // One call of MpHandleRecvInterrupt() will check up to pAdapter->Rx_DmaBDT_ItemCount BDs
+        PENET_BD pDmaBD = &pRxQueue->DmaBDT[Rx_EnetPendingBDIdx];             // Get address of the first not checked BD
+        if (EnetRxBdIsEmpty(pDmaBD)) {                                        // No data received or reception in progress?
             break;                                                            // Stop BD checking
         }
-        if (pAdapter->Rx_DmaBDT_DmaOwnedBDsCount == 0) {                      // All NBL has been already indicated to NDIS, next packet will be lost
+        if (pRxQueue->DmaBDT_DmaOwnedBDsCount == 0) {                         // All NBL has been already indicated to NDIS, next packet will be lost
+            break;
+        }
+        if ((FrameBDCount = MpRxGetFrameBDCount(pAdapter, pRxQueue, Rx_EnetPendingBDIdx)) == 0) {  // Jumbo frame not completely received yet?
             break;
         }
         if ((*pMaxNBLsToIndicate) == 0) {                                     // Did we reach the max number of RX frames we are allowed to indicate to NDIS?
@@ -921,10 +1092,15 @@ void MpHandleRecvInterrupt(PMP_ADAPTER pAdapter, PULONG pMaxNBLsToIndicate, PNDI
             pRecvThrottleParameters->MoreNblsPending = TRUE;                  // No, inform NDIS about it
             break;
         }
-        pAdapter->Rx_DmaBDT_DmaOwnedBDsCount--;                                                    // Decrement counter of Rx BDs owned by ENET DMA
-        PMP_RX_FRAME_BD pRxFrameBD = pAdapter->Rx_DmaBDT_SwExt[Rx_EnetPendingBDIdx].pRxFrameBD;    // Get frame descriptor
+        pRxQueue->DmaBDT_DmaOwnedBDsCount--;                                                       // Decrement counter of Rx BDs owned by ENET DMA
+        PMP_RX_FRAME_BD pRxFrameBD = pRxQueue->DmaBDT_SwExt[Rx_EnetPendingBDIdx].pRxFrameBD;       // Get frame descriptor
         ASSERT(pRxFrameBD != NULL);
-        pAdapter->Rx_DmaBDT_SwExt[Rx_EnetPendingBDIdx].pRxFrameBD = NULL;                          // Disconnect Rx Frame BD from ENET DMA BD
+        pRxQueue->DmaBDT_SwExt[Rx_EnetPendingBDIdx].pRxFrameBD = NULL;                             // Disconnect Rx Frame BD from ENET DMA BD
+        if (FrameBDCount > 1) {                                                                    // Frame received into several BDs?
+            MpRxChainFrameBuffers(pAdapter, pRxQueue, pRxFrameBD, Rx_EnetPendingBDIdx, FrameBDCount);  // Yes, chain the buffers
+            pDmaBD = &pRxQueue->DmaBDT[EnetBdRingAddIdx(Rx_EnetPendingBDIdx, FrameBDCount - 1, pAdapter->Rx_DmaBDT_ItemCount)];  // Frame length, status and timestamp are in the last BD
+        }
+        NdisOwnedBDsCount += FrameBDCount;
         PNET_BUFFER_LIST  pCurrentNBL     = pRxFrameBD->pNBL;                                      // Get NBL
         ULONG             realFrameLength = (ULONG)pDmaBD->DataLen - ETHER_FRAME_CRC_LENGTH - 2;   // Compute real data length
         #if DBG
@@ -934,34 +1110,37 @@ void MpHandleRecvInterrupt(PMP_ADAPTER pAdapter, PULONG pMaxNBLsToIndicate, PNDI
         NET_BUFFER_DATA_LENGTH(pCurrentNBL->FirstNetBuffer) = realFrameLength;                     // Save real data length
         // Is this packet completed and has error bits set?
         if (pDmaBD->ControlStatus & (ENET_RX_BD_TR_MASK | ENET_RX_BD_OV_MASK | ENET_RX_BD_NO_MASK | ENET_RX_BD_CR_MASK)) {
-            /* MS-temp */ NdisAdjustMdlLength(pRxFrameBD->pMdl, ENET_RX_FRAME_SIZE);
             NET_BUFFER_LIST_NEXT_NBL(pCurrentNBL) = pErrorNBLHead;        // Append this NBL to the had of the error NBL list
             pErrorNBLHead = pCurrentNBL;
             pAdapter->RcvStatus.FrameRcvErrors++;
             ErrorNBLItemCount++;
             if (pDmaBD->ControlStatus & ENET_RX_BD_TR_MASK) {             // Truncated frame?
-                DBG_ENET_DEV_PRINT_ERROR(" NBL(%4d) data received, DmaIdx: %4d, DmaOwnedBDs: %4d:, !!! ERROR Truncated frame !!!, status: 0x%08X, Size: %4d, PhyAddr: 0x%08X", MP_NBL_ID(pCurrentNBL), Rx_EnetPendingBDIdx, pAdapter->Rx_DmaBDT_DmaOwnedBDsCount, pDmaBD->ControlStatus, realFrameLength, pRxFrameBD->BufferPa.LowPart);
+                DBG_ENET_DEV_PRINT_ERROR(" NBL(%4d) data received, DmaIdx: %4d, DmaOwnedBDs: %4d:, !!! ERROR Truncated frame !!!, status: 0x%08X, Size: %4d, PhyAddr: 0x%08X", MP_NBL_ID(pCurrentNBL), Rx_EnetPendingBDIdx, pRxQueue->DmaBDT_DmaOwnedBDsCount, pDmaBD->ControlStatus, realFrameLength, pRxFrameBD->BufferPa.LowPart);
                 pAdapter->RcvStatus.FrameRcvLCErrors++;
             } else if (pDmaBD->ControlStatus & ENET_RX_BD_OV_MASK) {      // Receive FIFO overrun?
-                DBG_ENET_DEV_PRINT_ERROR(" NBL(%4d) data received, DmaIdx: %4d, DmaOwnedBDs: %4d:, !!! ERROR Receive FIFO overrun !!!, status: 0x%08X, Size: %4d, PhyAddr: 0x%08X", MP_NBL_ID(pCurrentNBL), Rx_EnetPendingBDIdx, pAdapter->Rx_DmaBDT_DmaOwnedBDsCount, pDmaBD->ControlStatus, realFrameLength, pRxFrameBD->BufferPa.LowPart);
+                DBG_ENET_DEV_PRINT_ERROR(" NBL(%4d) data received, DmaIdx: %4d, DmaOwnedBDs: %4d:, !!! ERROR Receive FIFO overrun !!!, status: 0x%08X, Size: %4d, PhyAddr: 0x%08X", MP_NBL_ID(pCurrentNBL), Rx_EnetPendingBDIdx, pRxQueue->DmaBDT_DmaOwnedBDsCount, pDmaBD->ControlStatus, realFrameLength, pRxFrameBD->BufferPa.LowPart);
                 pAdapter->RcvStatus.FrameRcvOverrunErrors++;
             } else if (pDmaBD->ControlStatus & ENET_RX_BD_NO_MASK) {      // No-octet aligned frame
-                DBG_ENET_DEV_PRINT_ERROR(" NBL(%4d) data received, DmaIdx: %4d, DmaOwnedBDs: %4d:, !!! ERROR No-octet aligned frame !!!, status: 0x%08X, Size: %4d, PhyAddr: 0x%08X", MP_NBL_ID(pCurrentNBL), Rx_EnetPendingBDIdx, pAdapter->Rx_DmaBDT_DmaOwnedBDsCount, pDmaBD->ControlStatus,realFrameLength,  pRxFrameBD->BufferPa.LowPart);
+                DBG_ENET_DEV_PRINT_ERROR(" NBL(%4d) data received, DmaIdx: %4d, DmaOwnedBDs: %4d:, !!! ERROR No-octet aligned frame !!!, status: 0x%08X, Size: %4d, PhyAddr: 0x%08X", MP_NBL_ID(pCurrentNBL), Rx_EnetPendingBDIdx, pRxQueue->DmaBDT_DmaOwnedBDsCount, pDmaBD->ControlStatus,realFrameLength,  pRxFrameBD->BufferPa.LowPart);
                 pAdapter->RcvStatus.FrameRcvAllignmentErrors++;
             } else if (pDmaBD->ControlStatus & ENET_RX_BD_CR_MASK) {      // CRC error?
-                DBG_ENET_DEV_PRINT_ERROR(" NBL(%4d) data received, DmaIdx: %4d, DmaOwnedBDs: %4d:, !!! ERROR CRC !!!, status: 0x%08X, Size: %4d, PhyAddr: 0x%08X", MP_NBL_ID(pCurrentNBL), Rx_EnetPendingBDIdx, pAdapter->Rx_DmaBDT_DmaOwnedBDsCount, pDmaBD->ControlStatus, realFrameLength, pRxFrameBD->BufferPa.LowPart);
+                DBG_ENET_DEV_PRINT_ERROR(" NBL(%4d) data received, DmaIdx: %4d, DmaOwnedBDs: %4d:, !!! ERROR CRC !!!, status: 0x%08X, Size: %4d, PhyAddr: 0x%08X", MP_NBL_ID(pCurrentNBL), Rx_EnetPendingBDIdx, pRxQueue->DmaBDT_DmaOwnedBDsCount, pDmaBD->ControlStatus, realFrameLength, pRxFrameBD->BufferPa.LowPart);
                 pAdapter->RcvStatus.FrameRcvCRCErrors++;
             } else {                                                      // Too long frame
-                DBG_ENET_DEV_PRINT_ERROR(" NBL(%4d) data received, DmaIdx: %4d, DmaOwnedBDs: %4d:, !!! ERROR Frame too long !!!, status: 0x%08X, Size: %4d, PhyAddr: 0x%08X", MP_NBL_ID(pCurrentNBL), Rx_EnetPendingBDIdx, pAdapter->Rx_DmaBDT_DmaOwnedBDsCount, pDmaBD->ControlStatus, realFrameLength, pRxFrameBD->BufferPa.LowPart);
+                DBG_ENET_DEV_PRINT_ERROR(" NBL(%4d) data received, DmaIdx: %4d, DmaOwnedBDs: %4d:, !!! ERROR Frame too long !!!, status: 0x%08X, Size: %4d, PhyAddr: 0x%08X", MP_NBL_ID(pCurrentNBL), Rx_EnetPendingBDIdx, pRxQueue->DmaBDT_DmaOwnedBDsCount, pDmaBD->ControlStatus, realFrameLength, pRxFrameBD->BufferPa.LowPart);
                 pAdapter->RcvStatus.FrameRcvExtraDataErrors++;
             }
         } else {
             (*pMaxNBLsToIndicate)--;                                                   // Decrement MaxNBLsToIndicate counter
-            NdisFlushBuffer(pRxFrameBD->pMdl, FALSE);                                  // Flush Rx buffer
-            /* MS-temp */NdisAdjustMdlLength(pRxFrameBD->pMdl, realFrameLength + 2);   // Update real length in MDL
-            DBG_ENET_DEV_RX_PRINT_TRACE(" NBL(%4d) data received, DmaIdx: %4d, DmaOwnedBDs: %4d:, Size: %d, PhyAddr: 0x%08X", MP_NBL_ID(pCurrentNBL), Rx_EnetPendingBDIdx, pAdapter->Rx_DmaBDT_DmaOwnedBDsCount, realFrameLength, pRxFrameBD->BufferPa.LowPart);
+            for (PMP_RX_FRAME_BD pBufferBD = pRxFrameBD; pBufferBD != NULL; pBufferBD = pBufferBD->pNextFrameBD) {
+                NdisFlushBuffer(pBufferBD->pMdl, FALSE);                               // Flush Rx buffer(s)
+            }
+            if (FrameBDCount == 1) {
+                /* MS-temp */NdisAdjustMdlLength(pRxFrameBD->pMdl, realFrameLength + 2);   // Update real length in MDL
+            }
+            DBG_ENET_DEV_RX_PRINT_TRACE(" NBL(%4d) data received, DmaIdx: %4d, DmaOwnedBDs: %4d:, Size: %d, PhyAddr: 0x%08X", MP_NBL_ID(pCurrentNBL), Rx_EnetPendingBDIdx, pRxQueue->DmaBDT_DmaOwnedBDsCount, realFrameLength, pRxFrameBD->BufferPa.LowPart);
             // Decide how we are going to indicate the RX buffer to NDIS. If we are running low on RX buffers, we will do in synchronously, otherwise we do it asynchronously.
-            if (pAdapter->Rx_DmaBDT_DmaOwnedBDsCount <= pAdapter->Rx_DmaBDT_DmaOwnedBDsLowWatterMark) {
+            if (pRxQueue->DmaBDT_DmaOwnedBDsCount <= pAdapter->Rx_DmaBDT_DmaOwnedBDsLowWatterMark) {
                 ppNBLTail = &pSyncNBLTail;                            // Low RX buffers level, use synchronous RX buffer indication
                 if (pSyncNBLTail == NULL) {                           // Synchronous NBL list empty?
                     pSyncNBLHead = pCurrentNBL;                       // Current NBL is the first item of the Synchronous NBL list
@@ -982,17 +1161,21 @@ void MpHandleRecvInterrupt(PMP_ADAPTER pAdapter, PULONG pMaxNBLsToIndicate, PNDI
             *ppNBLTail = pCurrentNBL;                                 // Remember current tail of the list
             NET_BUFFER_LIST_NEXT_NBL(pCurrentNBL) = NULL;             // Current NBL is the last NBL in the list
             pCurrentNBL->SourceHandle = pAdapter->AdapterHandle;      // Set NBL source handle
+            if (Enet1588ParsePtpEvent(pRxFrameBD->pBuffer + 2, realFrameLength, &PtpId)) {  // PTP event message received? (RACC[SHIFT16] inserts 2 bytes)
+                if (Now == 0) {
+                    Now = Enet1588GetTime(pAdapter);
+                }
+                Enet1588LogTimestamp(pAdapter, ENET_1588_TIMESTAMP_RX, &PtpId, Enet1588ExtendTimestamp(Now, pDmaBD->Timestamp));
+            }
         }
-        if (++Rx_EnetPendingBDIdx == pAdapter->Rx_DmaBDT_ItemCount) { // Compute next Rx_EnetPendingBDIdx
-            Rx_EnetPendingBDIdx = 0;
-        }
+        Rx_EnetPendingBDIdx = EnetBdRingAddIdx(Rx_EnetPendingBDIdx, FrameBDCount, pAdapter->Rx_DmaBDT_ItemCount);  // Compute next Rx_EnetPendingBDIdx
     } // More RFDs
-    pAdapter->Rx_EnetPendingBDIdx = Rx_EnetPendingBDIdx;              // Update Ethernet Dma Rx empty buffer index
-    pAdapter->Rx_NdisOwnedBDsCount += AsyncNBLItemCount + SyncNBLItemCount + ErrorNBLItemCount;
-    NdisDprReleaseSpinLock(&pAdapter->Rx_SpinLock);
+    pRxQueue->EnetPendingBDIdx = Rx_EnetPendingBDIdx;                 // Update Ethernet Dma Rx empty buffer index
+    pRxQueue->NdisOwnedBDsCount += NdisOwnedBDsCount;
+    NdisDprReleaseSpinLock(&pRxQueue->SpinLock);
     if (pErrorNBLHead) {
         DBG_ENET_DEV_RX_PRINT_ERROR(" NBL(%4d) received with error, returning back", MP_NBL_ID(pErrorNBLHead));
-        MpReturnNetBufferLists(pAdapter, pErrorNBLHead, 0);
+        MpRxQueueReturnNetBufferLists(pAdapter, pRxQueue, pErrorNBLHead);
     }
     // Indicate received RX frames to NDIS, if any...
     if (pAsyncNBLHead) {    // Asynchronous list not empty?
@@ -1002,7 +1185,7 @@ void MpHandleRecvInterrupt(PMP_ADAPTER pAdapter, PULONG pMaxNBLsToIndicate, PNDI
         ULONG tcr = ENET_TCR_TFC_PAUSE_MASK | pAdapter->ENETRegBase->TCR.U;
         pAdapter->ENETRegBase->TCR.U = tcr;
         NdisMIndicateReceiveNetBufferLists(pAdapter->AdapterHandle, pSyncNBLHead, NDIS_DEFAULT_PORT_NUMBER, SyncNBLItemCount, NDIS_RECEIVE_FLAGS_DISPATCH_LEVEL | NDIS_RECEIVE_FLAGS_RESOURCES);
-        MpReturnNetBufferLists(pAdapter, pSyncNBLHead, 0);
+        MpRxQueueReturnNetBufferLists(pAdapter, pRxQueue, pSyncNBLHead);
     } // Sync list
     DBG_ENET_DEV_DPC_RX_METHOD_END();
     return;
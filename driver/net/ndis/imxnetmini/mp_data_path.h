@@ -70,9 +70,9 @@ void MpQueueAdd(_In_ PMP_QUEUE QueuePtr, PLIST_ENTRY ListEntryPtr);
 _IRQL_requires_max_(DISPATCH_LEVEL)
 LONG MpQueueGetDepth(PMP_QUEUE pQueue);
 _IRQL_requires_max_(DISPATCH_LEVEL)
-void MpHandleTxInterrupt(_In_ PMP_ADAPTER pAdapter, _In_ UINT32 InterruptEvent);
+void MpHandleTxInterrupt(_In_ PMP_ADAPTER pAdapter, _In_ PMP_TX_QUEUE pTxQueue, _In_ UINT32 InterruptEvent);
 _IRQL_requires_max_(DISPATCH_LEVEL)
-void MpHandleRecvInterrupt(_In_ PMP_ADAPTER pAdapter, _Inout_ PULONG pMaxNBLsToIndicate, _Inout_ PNDIS_RECEIVE_THROTTLE_PARAMETERS pRecvThrottleParameters);
+void MpHandleRecvInterrupt(_In_ PMP_ADAPTER pAdapter, _In_ PMP_RX_QUEUE pRxQueue, _Inout_ PULONG pMaxNBLsToIndicate, _Inout_ PNDIS_RECEIVE_THROTTLE_PARAMETERS pRecvThrottleParameters);
 void MpTxInit(_In_ PMP_ADAPTER pAdapter);
 void MpRxInit(_In_ PMP_ADAPTER pAdapter);
 BOOLEAN IsRxFramePandingInNdis(PMP_ADAPTER pAdapter);
@@ -182,6 +182,12 @@ void Dbg_PrintOidDescription(PMP_ADAPTER pAdapter, PNDIS_OID_REQUEST NdisRequest
         MAKECASE(oidName, OID_802_3_XMIT_TIMES_CRS_LOST)
         MAKECASE(oidName, OID_802_3_XMIT_LATE_COLLISIONS)
 
+        /* IEEE 1588 timer private OIDs */
+        MAKECASE(oidName, OID_IMX_ENET_1588_TIME)
+        MAKECASE(oidName, OID_IMX_ENET_1588_ADJUST_TIME)
+        MAKECASE(oidName, OID_IMX_ENET_1588_FREQUENCY)
+        MAKECASE(oidName, OID_IMX_ENET_1588_TIMESTAMPS)
+
         /*  TCP/IP OIDs */
         MAKECASE(oidName, OID_TCP_TASK_OFFLOAD)
         MAKECASE(oidName, OID_TCP_TASK_IPSEC_ADD_SA)
@@ -700,6 +706,12 @@ const char* Dbg_GetNdisOidName(NDIS_OID i) {
         MAKECASE(OID_802_3_XMIT_TIMES_CRS_LOST)
         MAKECASE(OID_802_3_XMIT_LATE_COLLISIONS)
 
+        /* IEEE 1588 timer private OIDs */
+        MAKECASE(OID_IMX_ENET_1588_TIME)
+        MAKECASE(OID_IMX_ENET_1588_ADJUST_TIME)
+        MAKECASE(OID_IMX_ENET_1588_FREQUENCY)
+        MAKECASE(OID_IMX_ENET_1588_TIMESTAMPS)
+
         /*  TCP/IP OIDs */
         MAKECASE(OID_TCP_TASK_OFFLOAD)
         MAKECASE(OID_TCP_TASK_IPSEC_ADD_SA)
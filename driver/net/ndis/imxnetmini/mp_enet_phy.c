@@ -33,81 +33,6 @@
 
 #include "precomp.h"
 
-// --------------------------------------------------------------------------------------------------------------------
-//  IEEE Standard PHY registers.
-// --------------------------------------------------------------------------------------------------------------------
-
-// Register definitions for the PHY
-#define MII_REG_CR              0x00  // Control Register
-#define MII_REG_SR              0x01  // Status Register
-#define MII_REG_PHYIR1          0x02  // PHY Identification Register 1
-#define MII_REG_PHYIR2          0x03  // PHY Identification Register 2
-#define MII_REG_ANAR            0x04  // A-N Advertisement Register
-#define MII_REG_ANLPAR          0x05  // A-N Link Partner Ability Register
-#define MII_REG_ANER            0x06  // A-N Expansion Register
-#define MII_REG_ANNPTR          0x07  // A-N Next Page Transmit Register
-#define MII_REG_ANLPRNPR        0x08  // A-N Link Partner Received Next Page Register
-#define MII_REG_1000BASETCR     0x09  // 1000 Base-T control Register
-#define MII_REG_1000BASETST     0x0A  // 1000 Base-T status Register
-#define MII_REG_EXTCR           0x0B  // Extended Register -- Control
-#define MII_REG_EXTDW           0x0C  // Extended Register -- Data Write
-#define MII_REG_EXTDR           0x0D  // Extended Register -- Data Read
-#define MII_REG_EXTMIISR        0x0F  // Extended -- MII Status
-#define MII_REG_MMD_CR          0x0D  // MMD Access -- Control
-#define MII_REG_MMD_RD          0x0E  // MMD Access -- Register/Data
-#define MII_REG_EXTSTATUS       0x0F  // Extended Status
-
-//  MII_REG_CR
-#define MII_REG_CR_RESET                    (1 << 15)
-#define MII_REG_CR_LOOPBACK                 (1 << 14)
-#define MII_REG_CR_SPEEDSELECT              (3 << 13)
-#define MII_REG_CR_AN_ENABLE                (1 << 12)
-#define MII_REG_CR_POWERDOWN                (1 << 11)
-#define MII_REG_CR_ISOLATE                  (1 << 10)
-#define MII_REG_CR_RESTART_AN               (1 << 9)
-#define MII_REG_CR_DUPLEXMODE               (1 << 8)
-#define MII_REG_CR_COLLISSION_TEST          (1 << 7)
-
-//  MII_REG_SR
-#define MII_REG_SR_100BASE_T4               (1 << 15)
-#define MII_REG_SR_100BASE_TX_FULLDUPLEX    (1 << 14)
-#define MII_REG_SR_100BASE_TX_HALFDUPLEX    (1 << 13)
-#define MII_REG_SR_10BASE_TX_FULLDUPLEX     (1 << 12)
-#define MII_REG_SR_10BASE_TX_HALFDUPLEX     (1 << 11)
-#define MII_REG_SR_AN_COMPLETE              (1 << 5)
-#define MII_REG_SR_REMOTEFAULT              (1 << 4)
-#define MII_REG_SR_AN_ABILITY               (1 << 3)
-#define MII_REG_SR_LINKSTATUS               (1 << 2)
-#define MII_REG_SR_JABBER_DETECT            (1 << 1)
-#define MII_REG_SR_EXTENDEDCAPABILITY       (1 << 0)
-
-//  MII_REG_ANAR BitFields
-#define MII_REG_ANAR_100BASETX_FD           (1 << 8)    // 100BASE-TX Full Duplex
-#define MII_REG_ANAR_100BASETX_HD           (1 << 7)    // 100BASE-TX Half Duplex
-#define MII_REG_ANAR_10BASETX_FD            (1 << 6)    // 10BASE-TX Full Duplex
-#define MII_REG_ANAR_10BASETX_HD            (1 << 5)    // 10BASE-TX Half Duplex
-
-//  MII_REG_ANLPAR BitFields
-#define MII_REG_ANLPAR_PAUSE                (1 << 10)   // Pause
-#define MII_REG_ANLPAR_100BASETX_FD         (1 << 8)    // 100BASE-TX Full Duplex
-#define MII_REG_ANLPAR_100BASETX_HD         (1 << 7)    // 100BASE-TX Half Duplex
-#define MII_REG_ANLPAR_10BASETX_FD          (1 << 6)    // 10BASE-TX Full Duplex
-#define MII_REG_ANLPAR_10BASETX_HD          (1 << 5)    // 10BASE-TX Half Duplex
-
-//  MII_REG_1000BASETCR BitFields
-#define MII_REG_1000BASETCR_1000BT_FD       (1 << 9)    // 1000BASE-T Full Duplex
-#define MII_REG_1000BASETCR_1000BT_HD       (1 << 8)    // 1000BASE-T Half Duplex
-
-//  MII_REG_1000BASETST BitFields
-#define MII_REG_1000BASETST_MsSl_Fault      (1 << 15)   // Master-Slave fault detected if set to 1
-#define MII_REG_1000BASETST_MsSl_Set        (1 << 14)   // Master-Slave Configuration, Read 1 means PHY is Master, 0 for slave
-#define MII_REG_1000BASETST_LRS             (1 << 13)   // Local Receiver Status, 1 means OK 0 means not OK
-#define MII_REG_1000BASETST_RRS             (1 << 12)   // Remote Receiver Status, 1 means OK 0 means not OK
-#define MII_REG_1000BASETST_LP1000FD        (1 << 11)   // Link partner is 1000Base T Full Duplex capable
-#define MII_REG_1000BASETST_LP1000HD        (1 << 10)   // Link partner is 1000Base T Half  Duplex capable
-#define MII_REG_1000BASETST_IEC_MASK        (0XFF)      // Idle Error Count
-
-
 void EnetParse_MII_C       (_In_ UINT32 RegVal, _In_ NDIS_HANDLE MiniportAdapterHandle);
 void EnetParse_MII_S       (_In_ UINT32 RegVal, _In_ NDIS_HANDLE MiniportAdapterHandle);
 void EnetParse_MII_ANA     (_In_ UINT32 RegVal, _In_ NDIS_HANDLE MiniportAdapterHandle);
@@ -231,6 +156,8 @@ ENET_PHY_CMD PHYCmd1000On[] = {
 #define MII_REG_AR8031_ESR                              0xF  // IEEE Non-Standard -- Extended Status Register
 
 //  Vendor specific PHY registers
+#define MII_REG_AR8031_INT_EN                           0x12  // Vendor -- Interrupt Enable
+#define MII_REG_AR8031_INT_STATUS                       0x13  // Vendor -- Interrupt Status
 #define MII_REG_AR8031_SS                               0x14  // Vendor -- Smart Speed
 #define MII_REG_AR8031_DP_ADDR                          0x1D  // Vendor -- Debug Port (Address Offset Set)
 #define MII_REG_AR8031_DP_RW                            0x1E  // Vendor -- Debug Port2 (R/W Port)
@@ -264,13 +191,26 @@ ENET_PHY_CMD AR8031Actint[] = {
     {ENET_MII_END, NULL }
 };
 
+ENET_PHY_CMD AR8031IntEnable[] = {
+    {MII_READ_COMMAND(MII_REG_AR8031_INT_STATUS),          NULL}, // Clear pending interrupts
+    {MII_WRITE_COMMAND(MII_REG_AR8031_INT_EN, 0x0C00),     NULL}, // Link success, Link fail
+    {ENET_MII_END,                                         NULL}
+};
+
+ENET_PHY_CMD AR8031IntAck[] = {
+    {MII_READ_COMMAND(MII_REG_AR8031_INT_STATUS),          NULL},
+    {ENET_MII_END,                                         NULL}
+};
+
 MP_PHY_INFO AR8031Info = {
     ENET_PHY_AR8031,
     TEXT("AR8031/AR8033"),
     AR8031Config,
     AR8031Startup,
     AR8031Actint,
-    NULL
+    NULL,
+    AR8031IntEnable,
+    AR8031IntAck
 };
 
 //  AR8035 PHY
@@ -287,6 +227,8 @@ MP_PHY_INFO AR8031Info = {
 
 //  Vendor specific PHY registers
 #define MII_REG_AR8035_PHY_SS                           0x11  // Vendor -- PHY-specific status
+#define MII_REG_AR8035_INT_EN                           0x12  // Vendor -- Interrupt Enable
+#define MII_REG_AR8035_INT_STATUS                       0x13  // Vendor -- Interrupt Status
 #define MII_REG_AR8035_SS                               0x14  // Vendor -- Smart Speed
 #define MII_REG_AR8035_DP_ADDR                          0x1D  // Vendor -- Debug Port (Address Offset Set)
 #define MII_REG_AR8035_DP_RW                            0x1E  // Vendor -- Debug Port2 (R/W Port)
@@ -328,13 +270,40 @@ ENET_PHY_CMD AR8035Actint[] = {
     {ENET_MII_END,                            NULL}
 };
 
+ENET_PHY_CMD AR8035IntEnable[] = {
+    {MII_READ_COMMAND(MII_REG_AR8035_INT_STATUS),          NULL}, // Clear pending interrupts
+    {MII_WRITE_COMMAND(MII_REG_AR8035_INT_EN, 0x0C00),     NULL}, // Link success, Link fail
+    {ENET_MII_END,                                         NULL}
+};
+
+ENET_PHY_CMD AR8035IntAck[] = {
+    {MII_READ_COMMAND(MII_REG_AR8035_INT_STATUS),          NULL},
+    {ENET_MII_END,                                         NULL}
+};
+
 MP_PHY_INFO AR8035Info = {
     ENET_PHY_AR8035,
     TEXT("AR8035"),
     AR8035Config,
     AR8035Startup,
     AR8035Actint,
-    NULL
+    NULL,
+    AR8035IntEnable,
+    AR8035IntAck
+};
+
+// Micrel KSZ80x1/KSZ90x1 PHYs
+#define MII_REG_KSZ_INT_CS                              0x1B  // Vendor -- Interrupt Control/Status
+
+ENET_PHY_CMD KSZIntEnable[] = {
+    {MII_READ_COMMAND(MII_REG_KSZ_INT_CS),           NULL},   // Clear pending interrupts
+    {MII_WRITE_COMMAND(MII_REG_KSZ_INT_CS, 0x0500),  NULL},   // Link down, Link up
+    {ENET_MII_END,                                   NULL}
+};
+
+ENET_PHY_CMD KSZIntAck[] = {
+    {MII_READ_COMMAND(MII_REG_KSZ_INT_CS),           NULL},
+    {ENET_MII_END,                                   NULL}
 };
 
 // KSZ8081 PHY
@@ -362,7 +331,9 @@ MP_PHY_INFO KSZ8081Info = {
     KSZ8081Config,
     KSZ8081Startup,
     KSZ8081Actint,
-    NULL
+    NULL,
+    KSZIntEnable,
+    KSZIntAck
 };
 
 // KSZ8091 PHY
@@ -390,7 +361,9 @@ MP_PHY_INFO KSZ8091Info = {
     KSZ8091Config,
     KSZ8091Startup,
     KSZ8091Actint,
-    NULL
+    NULL,
+    KSZIntEnable,
+    KSZIntAck
 };
 
 // KSZ9021 PHY
@@ -418,11 +391,27 @@ MP_PHY_INFO KSZ9021Info = {
 	KSZ9021Config,
 	KSZ9021Startup,
 	KSZ9021Actint,
-	NULL
+	NULL,
+	KSZIntEnable,
+	KSZIntAck
 };
 
 // RTL8211E Phy Add by kmslove
 
+#define MII_REG_RTL8211E_INER                           0x12  // Vendor -- Interrupt Enable
+#define MII_REG_RTL8211E_INSR                           0x13  // Vendor -- Interrupt Status
+
+ENET_PHY_CMD RTL8211EIntEnable[] = {
+    {MII_READ_COMMAND(MII_REG_RTL8211E_INSR),          NULL},  // Clear pending interrupts
+    {MII_WRITE_COMMAND(MII_REG_RTL8211E_INER, 0x0400), NULL},  // Link status changed
+    {ENET_MII_END,                                     NULL}
+};
+
+ENET_PHY_CMD RTL8211EIntAck[] = {
+    {MII_READ_COMMAND(MII_REG_RTL8211E_INSR),          NULL},
+    {ENET_MII_END,                                     NULL}
+};
+
 ENET_PHY_CMD RTL8211EConfig[] = {
     {MII_WRITE_COMMAND(0x00, 0x3140), NULL},
     {MII_WRITE_COMMAND(0x00, 0x3340), NULL},
@@ -452,7 +441,9 @@ MP_PHY_INFO RTL8211EInfo = {
     RTL8211EConfig,
     RTL8211EStartup,
     RTL8211EActint,
-    NULL
+    NULL,
+    RTL8211EIntEnable,
+    RTL8211EIntAck
 };
 
 // RTL8211F Phy
@@ -532,7 +523,9 @@ MP_PHY_INFO KSZ9031Info = {
     KSZ9031Config,
     KSZ9031Startup,
     KSZ9031Actint,
-    NULL
+    NULL,
+    KSZIntEnable,
+    KSZIntAck
 };
 
 // if other PHY(s) need to be supported, add them to this array
@@ -762,20 +755,10 @@ _Use_decl_annotations_
 void EnetParse_MII_S(UINT RegVal, NDIS_HANDLE MiniportAdapterHandle)
 {
     MP_PHY_DEVICE*          pPHYDev = &((PMP_ADAPTER)MiniportAdapterHandle)->ENETDev_PHYDevice;
-    MP_PHY_STATUS           Status;
-    volatile MP_PHY_STATUS  s;
 
     DBG_PHY_DEV_METHOD_BEG_WITH_PARAMS("MII_S (Offset 0x%02X) Reg value: 0x%04X (Link: %s, Remote fault: %s, AutoNego: %s)", MII_REG_SR, (UINT16)RegVal, \
         (RegVal & MII_REG_SR_LINKSTATUS)? "UP":"DOWN", (RegVal & MII_REG_SR_REMOTEFAULT)? "yes":"no", (RegVal & MII_REG_SR_AN_COMPLETE)? "Done":"Pending");
-    s = pPHYDev->PHYDev_PhyStatus;
-    Status.U = pPHYDev->PHYDev_PhyStatus.U & ~(MP_PHY_STATUS_LINK_DETECTED_MASK | MP_PHY_STATUS_REMOTE_FAULT_MASK | MP_PHY_STATUS_AN_COMPLETE_MASK);
-    if (RegVal & MII_REG_SR_LINKSTATUS)
-        Status.B.LINK_DETECTED = 1;
-    if (RegVal & MII_REG_SR_REMOTEFAULT)
-        Status.B.REMOTE_FAULT = 1;
-    if (RegVal & MII_REG_SR_AN_COMPLETE)
-        Status.B.AN_COMPLETE = 1;
-    pPHYDev->PHYDev_PhyStatus = Status;
+    PHYDev_SeqParseStatus(pPHYDev, RegVal);
     DBG_PHY_DEV_METHOD_END();
 }
 
@@ -971,24 +954,9 @@ void EnetParsePHYLink(UINT RegVal, NDIS_HANDLE MiniportAdapterHandle)
     UNREFERENCED_PARAMETER(RegVal);
     DBG_PHY_DEV_METHOD_BEG();
     NdisAcquireSpinLock(&pAdapter->Dev_SpinLock);
-    if ((pPHYDev->PHYDev_LPApause == PHY_LPA_PAUSE_DETECTED) || (pPHYDev->PHYDev_LPApause == PHY_LPA_PAUSE_NOT_DETECTED)) {
-        // do nothing
-    } else {
-        if (pPHYDev->PHYDev_PhyStatus.B.LINK_DETECTED) {
-            pPHYDev->PHYDev_MediaConnectState = MediaConnectStateConnected;
-            if (pAdapter->SpeedSelect == SPEED_FULL_DUPLEX_1G)
-                pAdapter->ENETRegBase->ECR.U |= ENET_ECR_SPEED_MASK;   // Set gigabit speed
-        } else {
-            if ((pPHYDev->PHYDev_LPApause == PHY_LPA_1GB_ON_WAIT) || (pPHYDev->PHYDev_LPApause == PHY_LPA_1GB_OFF_WAIT)) {
-                //
-            } else {
-                pPHYDev->PHYDev_LPApause = PHY_LPA_INIT;
-            }
-            pPHYDev->PHYDev_MediaConnectState = MediaConnectStateDisconnected;
-            pAdapter->ENETRegBase->ECR.U &= ~ENET_ECR_SPEED_MASK;   //Clear gigabit speed mode so we can detect 100Mbps/10mbps links
-        }
+    if (PHYDev_SeqParseLink(pPHYDev, pAdapter->MediaConnectState, pAdapter->SpeedSelect == SPEED_FULL_DUPLEX_1G, &pAdapter->ENETRegBase->ECR.U)) {
+        SmRequestLinkUpdate(pAdapter);                              // Report new link state (or read PHY again) without waiting for the next check period
     }
-    pPHYDev->PHYDev_MIISeqDone = TRUE;
     NdisReleaseSpinLock(&pAdapter->Dev_SpinLock);
     DBG_PHY_DEV_METHOD_END();
 }
@@ -1009,17 +977,122 @@ void PHYDev_UpdateLinkStatus(NDIS_HANDLE MiniportAdapterHandle)
     MP_ADAPTER*     pAdapter= ((PMP_ADAPTER)(MiniportAdapterHandle));
     MP_MDIO_DEVICE* pMDIODev = &pAdapter->ENETDev_MDIODevice;
     MP_PHY_DEVICE*  pPHYDev  = &pAdapter->ENETDev_PHYDevice;
+    PENET_PHY_CMD   CmdLists[MDIO_SEQ_LINK_CMD_LISTS_MAX];
+    ULONG           Count, i;
 
     DBG_PHY_DEV_METHOD_BEG();
-    if (pPHYDev->PHYDev_MIISeqDone == FALSE) {
-        return; // Previous command to the PHY is not done yet
+    Count = PHYDev_SeqGetLinkCommands(pPHYDev, pAdapter->MediaConnectState, PHYCmdLink, CmdLists);   // PhyIntAck, PhyActint, PHYCmdLink(EnetParse_MII_S, EnetParsePHYLink - set MIISeqDone)
+    for (i = 0; i < Count; i++) {
+        MDIODev_QueueCommand(pMDIODev, CmdLists[i]);
     }
-    if (pPHYDev->PHYDev_PhySettings) {
-        pPHYDev->PHYDev_MIISeqDone = FALSE;
-        if (pAdapter->MediaConnectState != MediaConnectStateConnected) {
-            MDIODev_QueueCommand(pMDIODev, pPHYDev->PHYDev_PhySettings->PhyActint);
+    DBG_PHY_DEV_METHOD_END();
+}
+
+/*++
+Routine Description:
+    ENET PHY interrupt service routine. The PHY interrupt output stays asserted until the PHY interrupt status register is read,
+    which is done by PHYDev_UpdateLinkStatus() (PhyIntAck) before the link state is read.
+Arguments:
+    Interrupt
+        Not used
+    ServiceContext
+        Adapter context address
+Return Value:
+    TRUE
+--*/
+_Use_decl_annotations_
+BOOLEAN PHYDev_Isr(PKINTERRUPT Interrupt, PVOID ServiceContext)
+{
+    MP_ADAPTER*     pAdapter = ((PMP_ADAPTER)(ServiceContext));
+
+    UNREFERENCED_PARAMETER(Interrupt);
+    (void)InterlockedExchange(&pAdapter->ENETDev_PHYDevice.PHYDev_IntPending, 1);
+    SmRequestLinkUpdate(pAdapter);
+    return TRUE;
+}
+
+/*++
+Routine Description:
+    Connects the optional ENET PHY link change interrupt. The interrupt is used only if it is described in ACPI as an edge triggered
+    interrupt and the PHY has PhyIntEnable/PhyIntAck commands, otherwise the link state is polled by the state machine.
+Arguments:
+    MiniportAdapterHandle
+        Adapter context address
+Return Value:
+    STATUS_SUCCESS, STATUS_NOT_SUPPORTED or IoConnectInterruptEx() error code
+--*/
+_Use_decl_annotations_
+NTSTATUS PHYDev_ConnectInterrupt(NDIS_HANDLE MiniportAdapterHandle)
+{
+    MP_ADAPTER*                     pAdapter = ((PMP_ADAPTER)(MiniportAdapterHandle));
+    MP_PHY_DEVICE*                  pPHYDev  = &pAdapter->ENETDev_PHYDevice;
+    PCM_PARTIAL_RESOURCE_DESCRIPTOR pResDesc = &pPHYDev->PHYDev_IntResource;
+    IO_CONNECT_INTERRUPT_PARAMETERS Params;
+    NTSTATUS                        Status = STATUS_NOT_SUPPORTED;
+
+    DBG_PHY_DEV_METHOD_BEG();
+    do {
+        if (!pPHYDev->PHYDev_IntResourceFound) {
+            DBG_PHY_DEV_PRINT_INFO("ENET PHY interrupt was not found in ACPI. Link state will be polled.");
+            break;
+        }
+        if ((pPHYDev->PHYDev_PhySettings == NULL) || (pPHYDev->PHYDev_PhySettings->PhyIntEnable == NULL) || (pPHYDev->PHYDev_PhySettings->PhyIntAck == NULL)) {
+            DBG_PHY_DEV_PRINT_INFO("ENET PHY interrupt is not supported by this PHY. Link state will be polled.");
+            break;
+        }
+        if (!(pResDesc->Flags & CM_RESOURCE_INTERRUPT_LATCHED)) {
+            DBG_PHY_DEV_PRINT_WARNING("Level sensitive ENET PHY interrupt is not supported. Link state will be polled.");
+            break;
         }
-        MDIODev_QueueCommand(pMDIODev, PHYCmdLink); // EnetParse_MII_S  EnetParsePHYLink - set MIISeqDone
+        NdisZeroMemory(&Params, sizeof(Params));
+        Params.Version                                  = CONNECT_FULLY_SPECIFIED;
+        Params.FullySpecified.PhysicalDeviceObject      = pAdapter->Pdo;
+        Params.FullySpecified.InterruptObject           = &pPHYDev->PHYDev_pInterrupt;
+        Params.FullySpecified.ServiceRoutine            = PHYDev_Isr;
+        Params.FullySpecified.ServiceContext            = pAdapter;
+        Params.FullySpecified.SpinLock                  = NULL;
+        Params.FullySpecified.SynchronizeIrql           = (KIRQL)pResDesc->u.Interrupt.Level;
+        Params.FullySpecified.FloatingSave              = FALSE;
+        Params.FullySpecified.ShareVector               = (pResDesc->ShareDisposition == CmResourceShareShared);
+        Params.FullySpecified.Vector                    = pResDesc->u.Interrupt.Vector;
+        Params.FullySpecified.Irql                      = (KIRQL)pResDesc->u.Interrupt.Level;
+        Params.FullySpecified.InterruptMode             = Latched;
+        Params.FullySpecified.ProcessorEnableMask       = pResDesc->u.Interrupt.Affinity;
+        Params.FullySpecified.Group                     = 0;
+        if (!NT_SUCCESS(Status = IoConnectInterruptEx(&Params))) {
+            pPHYDev->PHYDev_pInterrupt = NULL;
+            DBG_PHY_DEV_PRINT_ERROR_WITH_STATUS("IoConnectInterruptEx() failed. Link state will be polled.");
+            break;
+        }
+        DBG_PHY_DEV_PRINT_INFO("ENET PHY interrupt connected.");
+    } while (0);
+    DBG_PHY_DEV_METHOD_END_WITH_STATUS(Status);
+    return Status;
+}
+
+/*++
+Routine Description:
+    Disconnects the ENET PHY link change interrupt if connected.
+Arguments:
+    MiniportAdapterHandle
+        Adapter context address
+Return Value:
+    None
+--*/
+_Use_decl_annotations_
+void PHYDev_DisconnectInterrupt(NDIS_HANDLE MiniportAdapterHandle)
+{
+    MP_ADAPTER*                        pAdapter = ((PMP_ADAPTER)(MiniportAdapterHandle));
+    MP_PHY_DEVICE*                     pPHYDev  = &pAdapter->ENETDev_PHYDevice;
+    IO_DISCONNECT_INTERRUPT_PARAMETERS Params;
+
+    DBG_PHY_DEV_METHOD_BEG();
+    if (pPHYDev->PHYDev_pInterrupt != NULL) {
+        NdisZeroMemory(&Params, sizeof(Params));
+        Params.Version                            = CONNECT_FULLY_SPECIFIED;
+        Params.ConnectionContext.InterruptObject  = pPHYDev->PHYDev_pInterrupt;
+        IoDisconnectInterruptEx(&Params);
+        pPHYDev->PHYDev_pInterrupt = NULL;
     }
     DBG_PHY_DEV_METHOD_END();
 }
@@ -1122,6 +1195,9 @@ BOOLEAN PHYDev_ConfigurePhy(NDIS_HANDLE MiniportAdapterHandle)
                 break;
         }
         MDIODev_QueueCommand(pMDIODev, pPHYDev->PHYDev_PhySettings->PhyActint);
+        if (pPHYDev->PHYDev_pInterrupt != NULL) {
+            MDIODev_QueueCommand(pMDIODev, pPHYDev->PHYDev_PhySettings->PhyIntEnable);
+        }
         MDIODev_QueueCommand(pMDIODev, PHYCmdCfg);
     } else {
         DBG_PHY_DEV_METHOD_END();
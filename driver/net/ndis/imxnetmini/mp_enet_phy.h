@@ -34,6 +34,80 @@
 #ifndef _MP_ENET_PHY_H
 #define _MP_ENET_PHY_H
 
+// --------------------------------------------------------------------------------------------------------------------
+//  IEEE Standard PHY registers.
+// --------------------------------------------------------------------------------------------------------------------
+
+// Register definitions for the PHY
+#define MII_REG_CR              0x00  // Control Register
+#define MII_REG_SR              0x01  // Status Register
+#define MII_REG_PHYIR1          0x02  // PHY Identification Register 1
+#define MII_REG_PHYIR2          0x03  // PHY Identification Register 2
+#define MII_REG_ANAR            0x04  // A-N Advertisement Register
+#define MII_REG_ANLPAR          0x05  // A-N Link Partner Ability Register
+#define MII_REG_ANER            0x06  // A-N Expansion Register
+#define MII_REG_ANNPTR          0x07  // A-N Next Page Transmit Register
+#define MII_REG_ANLPRNPR        0x08  // A-N Link Partner Received Next Page Register
+#define MII_REG_1000BASETCR     0x09  // 1000 Base-T control Register
+#define MII_REG_1000BASETST     0x0A  // 1000 Base-T status Register
+#define MII_REG_EXTCR           0x0B  // Extended Register -- Control
+#define MII_REG_EXTDW           0x0C  // Extended Register -- Data Write
+#define MII_REG_EXTDR           0x0D  // Extended Register -- Data Read
+#define MII_REG_EXTMIISR        0x0F  // Extended -- MII Status
+#define MII_REG_MMD_CR          0x0D  // MMD Access -- Control
+#define MII_REG_MMD_RD          0x0E  // MMD Access -- Register/Data
+#define MII_REG_EXTSTATUS       0x0F  // Extended Status
+
+//  MII_REG_CR
+#define MII_REG_CR_RESET                    (1 << 15)
+#define MII_REG_CR_LOOPBACK                 (1 << 14)
+#define MII_REG_CR_SPEEDSELECT              (3 << 13)
+#define MII_REG_CR_AN_ENABLE                (1 << 12)
+#define MII_REG_CR_POWERDOWN                (1 << 11)
+#define MII_REG_CR_ISOLATE                  (1 << 10)
+#define MII_REG_CR_RESTART_AN               (1 << 9)
+#define MII_REG_CR_DUPLEXMODE               (1 << 8)
+#define MII_REG_CR_COLLISSION_TEST          (1 << 7)
+
+//  MII_REG_SR
+#define MII_REG_SR_100BASE_T4               (1 << 15)
+#define MII_REG_SR_100BASE_TX_FULLDUPLEX    (1 << 14)
+#define MII_REG_SR_100BASE_TX_HALFDUPLEX    (1 << 13)
+#define MII_REG_SR_10BASE_TX_FULLDUPLEX     (1 << 12)
+#define MII_REG_SR_10BASE_TX_HALFDUPLEX     (1 << 11)
+#define MII_REG_SR_AN_COMPLETE              (1 << 5)
+#define MII_REG_SR_REMOTEFAULT              (1 << 4)
+#define MII_REG_SR_AN_ABILITY               (1 << 3)
+#define MII_REG_SR_LINKSTATUS               (1 << 2)
+#define MII_REG_SR_JABBER_DETECT            (1 << 1)
+#define MII_REG_SR_EXTENDEDCAPABILITY       (1 << 0)
+
+//  MII_REG_ANAR BitFields
+#define MII_REG_ANAR_100BASETX_FD           (1 << 8)    // 100BASE-TX Full Duplex
+#define MII_REG_ANAR_100BASETX_HD           (1 << 7)    // 100BASE-TX Half Duplex
+#define MII_REG_ANAR_10BASETX_FD            (1 << 6)    // 10BASE-TX Full Duplex
+#define MII_REG_ANAR_10BASETX_HD            (1 << 5)    // 10BASE-TX Half Duplex
+
+//  MII_REG_ANLPAR BitFields
+#define MII_REG_ANLPAR_PAUSE                (1 << 10)   // Pause
+#define MII_REG_ANLPAR_100BASETX_FD         (1 << 8)    // 100BASE-TX Full Duplex
+#define MII_REG_ANLPAR_100BASETX_HD         (1 << 7)    // 100BASE-TX Half Duplex
+#define MII_REG_ANLPAR_10BASETX_FD          (1 << 6)    // 10BASE-TX Full Duplex
+#define MII_REG_ANLPAR_10BASETX_HD          (1 << 5)    // 10BASE-TX Half Duplex
+
+//  MII_REG_1000BASETCR BitFields
+#define MII_REG_1000BASETCR_1000BT_FD       (1 << 9)    // 1000BASE-T Full Duplex
+#define MII_REG_1000BASETCR_1000BT_HD       (1 << 8)    // 1000BASE-T Half Duplex
+
+//  MII_REG_1000BASETST BitFields
+#define MII_REG_1000BASETST_MsSl_Fault      (1 << 15)   // Master-Slave fault detected if set to 1
+#define MII_REG_1000BASETST_MsSl_Set        (1 << 14)   // Master-Slave Configuration, Read 1 means PHY is Master, 0 for slave
+#define MII_REG_1000BASETST_LRS             (1 << 13)   // Local Receiver Status, 1 means OK 0 means not OK
+#define MII_REG_1000BASETST_RRS             (1 << 12)   // Remote Receiver Status, 1 means OK 0 means not OK
+#define MII_REG_1000BASETST_LP1000FD        (1 << 11)   // Link partner is 1000Base T Full Duplex capable
+#define MII_REG_1000BASETST_LP1000HD        (1 << 10)   // Link partner is 1000Base T Half  Duplex capable
+#define MII_REG_1000BASETST_IEC_MASK        (0XFF)      // Idle Error Count
+
 // values for PHY status
 
 #define PHY_CONF_ANE        0x0001  /* 1 auto-negotiation enabled */
@@ -101,6 +175,8 @@ typedef struct _MP_PHY_INFO {
     PENET_PHY_CMD            PhyStartup;
     PENET_PHY_CMD            PhyActint;
     PENET_PHY_CMD            PhyShutdown;
+    PENET_PHY_CMD            PhyIntEnable;      // Enables link up/down interrupt output, NULL if not supported
+    PENET_PHY_CMD            PhyIntAck;         // Reads (clears) interrupt status, releases the interrupt output
 } MP_PHY_INFO, *PMP_PHY_INFO;
 
 // The Enet Phy device driver structure
@@ -117,6 +193,11 @@ typedef struct _MP_PHY_DEVICE {
     UINT                     PHYDev_PhyConfig;
     BOOLEAN                  PHYDev_MIISeqDone;
     MP_PHY_LPA               PHYDev_LPApause;
+    // Optional link change interrupt (GpioInt resource following the ENET interrupt in ACPI _CRS)
+    CM_PARTIAL_RESOURCE_DESCRIPTOR PHYDev_IntResource;
+    BOOLEAN                  PHYDev_IntResourceFound;
+    PKINTERRUPT              PHYDev_pInterrupt;
+    volatile LONG            PHYDev_IntPending;          // Set by PHYDev_Isr, PHY interrupt status has to be read
     #if DBG
     char                     PHYDev_DeviceName[MAX_DEVICE_NAME + 1];         // MDIO bus device name.
     #endif
@@ -126,5 +207,10 @@ typedef struct _MP_PHY_DEVICE {
 NTSTATUS PHYDev_GetPhyId(_In_ MP_PHY_DEVICE *pPHYDev);
 BOOLEAN  PHYDev_ConfigurePhy(_In_ NDIS_HANDLE MiniportAdapterHandle);
 void     PHYDev_UpdateLinkStatus(_In_ NDIS_HANDLE MiniportAdapterHandle);
+_IRQL_requires_(PASSIVE_LEVEL)
+NTSTATUS PHYDev_ConnectInterrupt(_In_ NDIS_HANDLE MiniportAdapterHandle);
+_IRQL_requires_(PASSIVE_LEVEL)
+void     PHYDev_DisconnectInterrupt(_In_ NDIS_HANDLE MiniportAdapterHandle);
+KSERVICE_ROUTINE PHYDev_Isr;
 
 #endif // _MP_ENET_PHY_H
@@ -123,9 +123,39 @@ void ClearAllMultiCast(PMP_ADAPTER pAdapter)
     pAdapter->ENETRegBase->GALR = 0;
 }
 
+/*++
+Routine Description:
+    Returns the ENET interrupt flags served by EnetDpc running on the given processor.
+    Each ring is served on its own processor (see NICAllocAdapterMemory()), ring 0 also serves the events not related
+    to any ring. If EnetDpc runs on a processor no ring is assigned to, it serves all rings.
+Arguments:
+    pAdapter    Pointer to adapter data
+    Processor   Current processor number
+Return Value:
+    EIR flags served by the DPC.
+--*/
+static UINT32 EnetGetDpcIntMask(_In_ PMP_ADAPTER pAdapter, _In_ ULONG Processor)
+{
+    UINT32 DpcIntMask = 0;
+
+    for (ULONG QueueIdx = 0; QueueIdx < pAdapter->QueueCount; ++QueueIdx) {
+        if (pAdapter->RxQueue[QueueIdx].DpcProcessor == Processor) {
+            DpcIntMask |= pAdapter->RxQueue[QueueIdx].IntMask;
+        }
+    }
+    if (DpcIntMask == 0) {
+        for (ULONG QueueIdx = 0; QueueIdx < pAdapter->QueueCount; ++QueueIdx) {
+            DpcIntMask |= pAdapter->RxQueue[QueueIdx].IntMask;
+        }
+    }
+    return DpcIntMask;
+}
+
 /*++
 Routine Description:
     MiniportHandleInterrupt handler
+    If more than one ring is in use, EnetIsr queues this DPC on the processors of the rings with pending events and
+    each instance serves only the rings assigned to its processor.
 Arguments:
     MiniportInterruptContext
         Pointer to the interrupt context. In this is a pointer to the adapter structure.
@@ -143,9 +173,10 @@ _Use_decl_annotations_
 VOID EnetDpc(NDIS_HANDLE  MiniportInterruptContext, PVOID MiniportDpcContext, PVOID ReceiveThrottleParameters, PVOID NdisReserved2)
 {
     PMP_ADAPTER                        pAdapter = (PMP_ADAPTER)MiniportInterruptContext;
-    UINT32                             InterruptEvent, InterruptFlags;
+    UINT32                             InterruptEvent, InterruptFlags, DpcIntMask;
     PNDIS_RECEIVE_THROTTLE_PARAMETERS  pRecvThrottleParameters = (PNDIS_RECEIVE_THROTTLE_PARAMETERS)ReceiveThrottleParameters;
     ULONG                              MaxNBLsToIndicate;
+    ULONG                              QueueIdx;
 
     UNREFERENCED_PARAMETER(MiniportDpcContext);
     UNREFERENCED_PARAMETER(NdisReserved2);
@@ -156,14 +187,26 @@ VOID EnetDpc(NDIS_HANDLE  MiniportInterruptContext, PVOID MiniportDpcContext, PV
         MaxNBLsToIndicate = MAXULONG;
     }
     pRecvThrottleParameters->MoreNblsPending = FALSE;
+    DpcIntMask = EnetGetDpcIntMask(pAdapter, KeGetCurrentProcessorNumberEx(NULL));       // Rings served by this DPC instance
+    if ((DpcIntMask & ENET_1588_INT_MASK) && (pAdapter->ENETRegBase->EIR.U & ENET_1588_INT_MASK)) {   // 1588 timer period elapsed?
+        Enet1588OnTimerEvent(pAdapter);                                                        // Yes, update seconds counter.
+    }
+    if (pAdapter->ENETDev_MDIOBusOwner && (DpcIntMask & ENET_MII_INT_MASK) && (pAdapter->ENETRegBase->EIR.U & ENET_MII_INT_MASK)) {  // MDIO frame done?
+        MDIOBus_OnTransferDone(pAdapter->ENETDev_MDIODevice.MDIODev_pBus);                     // Yes, let MDIO bus thread start the next one.
+    }
     do {
         NdisDprAcquireSpinLock(&pAdapter->Dev_SpinLock);
         pAdapter->DpcQueued          = FALSE;
         pAdapter->DpcRunning         = TRUE;
-        InterruptFlags               = pAdapter->ENETRegBase->EIR.U & ENET_RX_TX_INT_MASK;  // Get current interrupt flags from HW register
+        InterruptFlags               = pAdapter->ENETRegBase->EIR.U & pAdapter->EnetRxTxIntMask & DpcIntMask;  // Get current interrupt flags of served rings from HW register
         pAdapter->ENETRegBase->EIR.U = InterruptFlags;                                      // Clear current interrupt flags in HW register
-        InterruptFlags              |= pAdapter->InterruptFlags;                            // Add saved interrupt flags
-        pAdapter->InterruptFlags     = 0;                                                   // Clear saved interrupt flags
+        for (QueueIdx = 0; QueueIdx < pAdapter->QueueCount; ++QueueIdx) {
+            PMP_RX_QUEUE pRxQueue = &pAdapter->RxQueue[QueueIdx];
+            if (pRxQueue->IntMask & DpcIntMask) {
+                InterruptFlags          |= pRxQueue->InterruptFlags;                        // Add saved interrupt flags
+                pRxQueue->InterruptFlags = 0;                                               // Clear saved interrupt flags
+            }
+        }
         NdisDprReleaseSpinLock(&pAdapter->Dev_SpinLock);
         InterruptEvent               = InterruptFlags;  // Compute new interrupt flags
         if (!InterruptEvent)                                            // An interrupt ready to be served?
@@ -172,24 +215,29 @@ VOID EnetDpc(NDIS_HANDLE  MiniportInterruptContext, PVOID MiniportDpcContext, PV
             DBG_ENET_DEV_DPC_PRINT_ERROR("Bus error, reset required.");
             return;
         }
-        if (InterruptEvent & ENET_TX_INT_MASK) {                        // Handle frame(s) sent or sent error interrupt
-            MpHandleTxInterrupt(pAdapter, InterruptEvent);
-        }
-        if (InterruptEvent & ENET_RX_INT_MASK) {                        // Handle frame(s) received or receive error interrupt
-            MpHandleRecvInterrupt(pAdapter, &MaxNBLsToIndicate, pRecvThrottleParameters);
-            if (pRecvThrottleParameters->MoreNblsPending) {
-                NdisDprAcquireSpinLock(&pAdapter->Dev_SpinLock);
-                pAdapter->InterruptFlags |= (InterruptEvent & ENET_RX_INT_MASK); // We have to prepare interrupt flags for NDIS called EnetDPC
-                NdisDprReleaseSpinLock(&pAdapter->Dev_SpinLock);
-                break;
+        for (QueueIdx = 0; QueueIdx < pAdapter->QueueCount; ++QueueIdx) {
+            PMP_TX_QUEUE pTxQueue = &pAdapter->TxQueue[QueueIdx];
+            PMP_RX_QUEUE pRxQueue = &pAdapter->RxQueue[QueueIdx];
+            if (InterruptEvent & pTxQueue->IntMask) {                   // Handle frame(s) sent or sent error interrupt
+                MpHandleTxInterrupt(pAdapter, pTxQueue, InterruptEvent);
+            }
+            if (InterruptEvent & pRxQueue->IntMask & ENET_RX_ALL_INT_MASK) {   // Handle frame(s) received or receive error interrupt
+                MpHandleRecvInterrupt(pAdapter, pRxQueue, &MaxNBLsToIndicate, pRecvThrottleParameters);
+                if (pRecvThrottleParameters->MoreNblsPending) {
+                    NdisDprAcquireSpinLock(&pAdapter->Dev_SpinLock);
+                    pRxQueue->InterruptFlags |= (InterruptEvent & pRxQueue->IntMask & ENET_RX_ALL_INT_MASK); // We have to prepare interrupt flags for NDIS called EnetDPC
+                    NdisDprReleaseSpinLock(&pAdapter->Dev_SpinLock);
+                }
             }
         }
         if (InterruptEvent & ENET_EIR_GRA_MASK) {                       // Restart Tx path after pause frame transmit
-            pAdapter->ENETRegBase->TDAR = 0x0000000;
+            for (QueueIdx = 0; QueueIdx < pAdapter->QueueCount; ++QueueIdx) {
+                EnetBdRingKick(pAdapter->TxQueue[QueueIdx].pTDAR);
+            }
         }
     } while (0);
     if (!pRecvThrottleParameters->MoreNblsPending) {
-      NdisMSynchronizeWithInterruptEx(pAdapter->NdisInterruptHandle, 0, EnetEnableRxAndTxInterrupts, pAdapter);
+      NdisMSynchronizeWithInterruptEx(pAdapter->NdisInterruptHandle, 0, EnetRestoreInterrupts, pAdapter);
     }
     NdisDprAcquireSpinLock(&pAdapter->Dev_SpinLock);
     pAdapter->DpcRunning = FALSE;
@@ -200,7 +248,8 @@ VOID EnetDpc(NDIS_HANDLE  MiniportInterruptContext, PVOID MiniportDpcContext, PV
 /*++
 Routine Description:
     Miniport ISR callback function.
-    Disables all ENET peripheral interrupts and queues DPC.
+    Disables all ENET peripheral interrupts and queues DPC. If more than one ring is in use, the DPC is queued on
+    the processor of each ring with a pending event, otherwise on the current processor.
 Arguments:
     MiniportInterruptContext  Pointer to the miniport adapter data structure.
     QueueDefaultInterruptDpc  Set to TRUE value to queue DPC on default(this) CPU.
@@ -213,25 +262,46 @@ _Use_decl_annotations_
 BOOLEAN EnetIsr(NDIS_HANDLE MiniportInterruptContext, PBOOLEAN QueueDefaultInterruptDpc, PULONG TargetProcessors)
 {
     PMP_ADAPTER pAdapter = (PMP_ADAPTER)MiniportInterruptContext;
+    BOOLEAN     Recognized = FALSE;
 
-    UNREFERENCED_PARAMETER(TargetProcessors);
     DBG_ENET_DEV_ISR_METHOD_BEG();
     if (pAdapter->ENETRegBase->EIMR.U != 0U) {
+        UINT32 InterruptEvent = pAdapter->ENETRegBase->EIR.U & pAdapter->ENETRegBase->EIMR.U;
         pAdapter->ENETRegBase->EIMR.U = 0x00;  // Disable all ENET interrupts. (EnetIsr will not be called again until interrupts are enabled in EnetDpc)
         pAdapter->DpcQueued = TRUE;            // Remember that EnetDpc is queued
-        *QueueDefaultInterruptDpc = TRUE;      // Schedule EnetDpc on the current CPU to complete the operation
+        Recognized = TRUE;
+        if (pAdapter->QueueCount == 1) {
+            pAdapter->DpcPendingCount++;
+            *QueueDefaultInterruptDpc = TRUE;  // Schedule EnetDpc on the current CPU to complete the operation
+        } else {
+            ULONG DpcTargets = 0;
+            for (ULONG QueueIdx = 0; QueueIdx < pAdapter->QueueCount; ++QueueIdx) {
+                ULONG DpcTarget = 1UL << pAdapter->RxQueue[QueueIdx].DpcProcessor;
+                if ((InterruptEvent & pAdapter->RxQueue[QueueIdx].IntMask) && !(DpcTargets & DpcTarget)) {
+                    DpcTargets |= DpcTarget;
+                    pAdapter->DpcPendingCount++;
+                }
+            }
+            if (DpcTargets == 0) {             // No ring event (the flag has been already cleared), let ring 0 DPC re-enable interrupts
+                DpcTargets = 1UL << pAdapter->RxQueue[0].DpcProcessor;
+                pAdapter->DpcPendingCount++;
+            }
+            *QueueDefaultInterruptDpc = FALSE;
+            *TargetProcessors = DpcTargets;    // Schedule EnetDpc on the processors of the rings with pending events
+        }
     } else {
         *QueueDefaultInterruptDpc = FALSE;     // Do not schedule Dpc
         *TargetProcessors = 0;
         DBG_ENET_DEV_ISR_PRINT_WARNING("Spurious Interrupt.");
     }
     DBG_ENET_DEV_ISR_METHOD_END();
-    return *QueueDefaultInterruptDpc;
+    return Recognized;
 }
 
 /*++
 Routine Description:
-    Enables TxF, RxF and MII interrupts
+    Enables TxF, RxF and MII interrupts. The 1588 timer interrupt is managed by Enet1588Init()/Enet1588Deinit().
+    MII interrupt is enabled only if this ENET device owns the MDIO bus controller, the MII interrupt is not generated while ENET is disabled.
 Arguments:
     SynchronizeContext  The handle to the driver allocated context area.
     Return Value:
@@ -242,13 +312,39 @@ BOOLEAN EnetEnableRxAndTxInterrupts(NDIS_HANDLE SynchronizeContext) {
     PMP_ADAPTER  pAdapter = (PMP_ADAPTER)SynchronizeContext;
     volatile CSP_ENET_REGS  *ENETRegBase = pAdapter->ENETRegBase;
 
-    ENETRegBase->EIMR.U |= ENET_RX_TX_INT_MASK;   // Enable Rx and Tx interrupts
+    pAdapter->EnetIntMask |= pAdapter->EnetRxTxIntMask;           // Enable Rx and Tx interrupts of all rings
+    if (pAdapter->ENETDev_MDIOBusOwner) {
+        pAdapter->EnetIntMask |= ENET_MII_INT_MASK;               // Enable MII interrupt
+    }
+    ENETRegBase->EIMR.U |= pAdapter->EnetIntMask;
     return TRUE;
 }
 
 /*++
 Routine Description:
-    Disables all ENET peripheral interrupt and returns TRUE if Dpc is queued or running.
+    Re-enables ENET interrupts disabled by EnetIsr. Called at the end of EnetDpc.
+    Interrupts are re-enabled by the last of the DPCs queued by EnetIsr.
+Arguments:
+    SynchronizeContext  The handle to the driver allocated context area.
+    Return Value:
+        Always returns TRUE
+--*/
+_Use_decl_annotations_
+BOOLEAN EnetRestoreInterrupts(NDIS_HANDLE SynchronizeContext) {
+    PMP_ADAPTER  pAdapter = (PMP_ADAPTER)SynchronizeContext;
+
+    if (pAdapter->DpcPendingCount > 0) {
+        pAdapter->DpcPendingCount--;
+    }
+    if (pAdapter->DpcPendingCount == 0) {
+        pAdapter->ENETRegBase->EIMR.U = pAdapter->EnetIntMask;    // Enable interrupts enabled by EnetStart()
+    }
+    return TRUE;
+}
+
+/*++
+Routine Description:
+    Disables Rx, Tx and MII interrupts and returns TRUE if Dpc is queued or running.
     It is supposed that this function is called synchronised with EnetIsr by NdisMSynchronizeWithInterruptEx()
 Arguments:
     SynchronizeContext  The handle to the driver allocated context area.
@@ -261,11 +357,44 @@ BOOLEAN EnetDisableRxAndTxInterrupts(NDIS_HANDLE SynchronizeContext) {
     PMP_ADAPTER  pAdapter = (PMP_ADAPTER)SynchronizeContext;
     volatile CSP_ENET_REGS  *ENETRegBase = pAdapter->ENETRegBase;
 
-    ENETRegBase->EIMR.U &= ~((ENET_RX_TX_INT_MASK));         // Disable Rx and Tx interrupts
-    ENETRegBase->EIR.U = (ENET_RX_TX_INT_MASK);              // Clear Rx and Tx interrupts flags
+    pAdapter->EnetIntMask &= ~((pAdapter->EnetRxTxIntMask | ENET_MII_INT_MASK));
+    ENETRegBase->EIMR.U &= ~((pAdapter->EnetRxTxIntMask | ENET_MII_INT_MASK));  // Disable Rx, Tx and MII interrupts
+    ENETRegBase->EIR.U = (pAdapter->EnetRxTxIntMask);        // Clear Rx and Tx interrupts flags (MII flag is owned by the MDIO bus thread)
     return pAdapter->DpcQueued;
 }
 
+/*++
+Routine Description:
+    Acquires Rx and Tx spin locks of all rings in use.
+Arguments:
+    pAdapter    Pointer to adapter data
+Return Value:
+    None
+--*/
+static void EnetAcquireQueueLocks(_In_ PMP_ADAPTER pAdapter)
+{
+    for (ULONG QueueIdx = 0; QueueIdx < pAdapter->QueueCount; ++QueueIdx) {
+        NdisAcquireSpinLock(&pAdapter->RxQueue[QueueIdx].SpinLock);
+        NdisAcquireSpinLock(&pAdapter->TxQueue[QueueIdx].SpinLock);
+    }
+}
+
+/*++
+Routine Description:
+    Releases Rx and Tx spin locks acquired by EnetAcquireQueueLocks(), in the reverse order.
+Arguments:
+    pAdapter    Pointer to adapter data
+Return Value:
+    None
+--*/
+static void EnetReleaseQueueLocks(_In_ PMP_ADAPTER pAdapter)
+{
+    for (ULONG QueueIdx = pAdapter->QueueCount; QueueIdx-- > 0;) {
+        NdisReleaseSpinLock(&pAdapter->TxQueue[QueueIdx].SpinLock);
+        NdisReleaseSpinLock(&pAdapter->RxQueue[QueueIdx].SpinLock);
+    }
+}
+
 /*++
 Routine Description:
     This function stops the ENET hardware.
@@ -282,8 +411,7 @@ void EnetStop(PMP_ADAPTER pAdapter, NDIS_STATUS NdisStatus)
     volatile CSP_ENET_REGS  *ENETRegBase = pAdapter->ENETRegBase;
 
     NdisAcquireSpinLock(&pAdapter->Dev_SpinLock);
-    NdisAcquireSpinLock(&pAdapter->Rx_SpinLock);
-    NdisAcquireSpinLock(&pAdapter->Tx_SpinLock);
+    EnetAcquireQueueLocks(pAdapter);
     DBG_SM_PRINT_TRACE("Stopping ENET, all spinlocks acquired");
     NdisMSynchronizeWithInterruptEx(pAdapter->NdisInterruptHandle, 0, EnetDisableRxAndTxInterrupts, pAdapter);
     ENETRegBase->ECR.U &= ~ENET_ECR_ETHER_EN_MASK;        // Disable Enet MAC (Clear "Enable" bit)
@@ -291,8 +419,7 @@ void EnetStop(PMP_ADAPTER pAdapter, NDIS_STATUS NdisStatus)
     pAdapter->NdisStatus = NdisStatus;                    // Remember new NDIS status
     pAdapter->EnetStarted = FALSE;                        // Remember new Enet state
     DBG_SM_PRINT_TRACE("ENET stopped, status: %s, releasing all spinlocks", Dbg_GetNdisStatusName(NdisStatus));
-    NdisReleaseSpinLock(&pAdapter->Tx_SpinLock);
-    NdisReleaseSpinLock(&pAdapter->Rx_SpinLock);
+    EnetReleaseQueueLocks(pAdapter);
     NdisReleaseSpinLock(&pAdapter->Dev_SpinLock);
 }
 
@@ -311,25 +438,41 @@ void EnetStart(PMP_ADAPTER pAdapter)
     volatile CSP_ENET_REGS  *ENETRegBase = pAdapter->ENETRegBase;
 
     NdisAcquireSpinLock(&pAdapter->Dev_SpinLock);
-    NdisAcquireSpinLock(&pAdapter->Rx_SpinLock);
-    NdisAcquireSpinLock(&pAdapter->Tx_SpinLock);
+    EnetAcquireQueueLocks(pAdapter);
     DBG_SM_PRINT_TRACE("Starting ENET, all spinlocks acquired");
     MpTxInit(pAdapter);                                               // Initialize Tx data structures
     MpRxInit(pAdapter);                                               // Initialize Rx data structures
     pAdapter->EnetStarted = TRUE;                                     // Remember new Enet state
     pAdapter->NdisStatus = NDIS_STATUS_SUCCESS;                       // Remember new NDIS status
-    pAdapter->InterruptFlags = 0;                                     // No interrupt flags pending from previous call of DPC
-    ENETRegBase->ERDSR = (ULONG)pAdapter->Rx_DmaBDT_Pa.QuadPart;      // Set the Rx_DmaBDT physical address
-    ENETRegBase->ETDSR = (ULONG)pAdapter->Tx_DmaBDT_Pa.QuadPart;      // Set the Tx_DmaBDT physical address
-    ENETRegBase->EMRBR = 0x7f0;                                       //
-    ENETRegBase->EIR.U = (ENET_RX_TX_INT_MASK);                       // Clear Rx and Tx interrupts flags
+    for (ULONG QueueIdx = 0; QueueIdx < pAdapter->QueueCount; ++QueueIdx) {
+        pAdapter->RxQueue[QueueIdx].InterruptFlags = 0;               // No interrupt flags pending from previous call of DPC
+    }
+    ENETRegBase->ERDSR = (ULONG)pAdapter->RxQueue[0].DmaBDT_Pa.QuadPart;  // Set the ring 0 Rx DmaBDT physical address
+    ENETRegBase->ETDSR = (ULONG)pAdapter->TxQueue[0].DmaBDT_Pa.QuadPart;  // Set the ring 0 Tx DmaBDT physical address
+    ENETRegBase->EMRBR = pAdapter->Rx_BufferSize - 16;                // Maximum receive buffer size, must be a multiple of 16
+    if (pAdapter->QueueCount > 1) {
+        ENETRegBase->RDSR1   = (ULONG)pAdapter->RxQueue[1].DmaBDT_Pa.QuadPart;  // Set the ring 1 Rx DmaBDT physical address
+        ENETRegBase->TDSR1   = (ULONG)pAdapter->TxQueue[1].DmaBDT_Pa.QuadPart;  // Set the ring 1 Tx DmaBDT physical address
+        ENETRegBase->MRBR1   = pAdapter->Rx_BufferSize - 16;
+        ENETRegBase->RCMR1   = ENET_RCMR1_VALUE;                      // Steer VLAN priorities 2-4 to ring 1
+        ENETRegBase->DMA1CFG = ENET_DMACFG_VALUE;
+    }
+    if (pAdapter->QueueCount > 2) {
+        ENETRegBase->RDSR2   = (ULONG)pAdapter->RxQueue[2].DmaBDT_Pa.QuadPart;  // Set the ring 2 Rx DmaBDT physical address
+        ENETRegBase->TDSR2   = (ULONG)pAdapter->TxQueue[2].DmaBDT_Pa.QuadPart;  // Set the ring 2 Tx DmaBDT physical address
+        ENETRegBase->MRBR2   = pAdapter->Rx_BufferSize - 16;
+        ENETRegBase->RCMR2   = ENET_RCMR2_VALUE;                      // Steer VLAN priorities 5-7 to ring 2
+        ENETRegBase->DMA2CFG = ENET_DMACFG_VALUE;
+    }
+    ENETRegBase->EIR.U = (pAdapter->EnetRxTxIntMask);                 // Clear Rx and Tx interrupts flags
     NdisMSynchronizeWithInterruptEx(pAdapter->NdisInterruptHandle, 0, EnetEnableRxAndTxInterrupts, pAdapter);
     _DataSynchronizationBarrier();                                    // Wait until mem-io accesses are finished 
     ENETRegBase->ECR.U |= ENET_ECR_ETHER_EN_MASK;                     // Start Enet (ENET must be running in order to invoke MII interrupt)
-    ENETRegBase->RDAR = 0x00000000;                                   // Start data reception
+    for (ULONG QueueIdx = 0; QueueIdx < pAdapter->QueueCount; ++QueueIdx) {
+        EnetBdRingKick(pAdapter->RxQueue[QueueIdx].pRDAR);            // Start data reception
+    }
     DBG_SM_PRINT_TRACE("ENET started, releasing all spinlocks");
-    NdisReleaseSpinLock(&pAdapter->Tx_SpinLock);
-    NdisReleaseSpinLock(&pAdapter->Rx_SpinLock);
+    EnetReleaseQueueLocks(pAdapter);
     NdisReleaseSpinLock(&pAdapter->Dev_SpinLock);
 }
 
@@ -349,6 +492,7 @@ void EnetDeinit(PMP_ADAPTER pAdapter)
     NdisMSynchronizeWithInterruptEx(pAdapter->NdisInterruptHandle, 0, EnetDisableRxAndTxInterrupts, pAdapter);
     ENETRegBase->ECR.U &= ~ENET_ECR_ETHER_EN_MASK;        // Disable Enet MAC (Clear "Enable" bit)
     while (ENETRegBase->ECR.U & ENET_ECR_ETHER_EN_MASK);  // Wait until Enet MAC is disabled
+    Enet1588Deinit(pAdapter);
     DBG_SM_PRINT_TRACE("ENET reset done");
 }
 
@@ -364,8 +508,8 @@ _Use_decl_annotations_
 void EnetInit(PMP_ADAPTER pAdapter, MP_MDIO_PHY_INTERFACE_TYPE EnetPhyInterfaceType)
 {
     volatile CSP_ENET_REGS* ENETRegBase = pAdapter->ENETRegBase;
-    UINT32                  ECR_RegMask = ENET_ECR_DBSW_MASK;
-    UINT32                  RCR_RegMask = ETHER_FRAME_MAX_LENGTH << ENET_RCR_MAX_FL_SHIFT | ENET_RCR_MII_MODE_MASK | ENET_RCR_FCE_MASK;  // Set maximum Ethernet frame length and enable MII mode and Flow control;
+    UINT32                  ECR_RegMask = ENET_ECR_DBSW_MASK | ENET_ECR_EN1588_EN_MASK;  // Little endian, enhanced buffer descriptors
+    UINT32                  RCR_RegMask = (pAdapter->JumboPacket + ETHER_FRAME_CRC_LENGTH) << ENET_RCR_MAX_FL_SHIFT | ENET_RCR_MII_MODE_MASK | ENET_RCR_FCE_MASK;  // Set maximum Ethernet frame length and enable MII mode and Flow control;
     UINT32                  TCR_RegMask = 0;
 
     DBG_SM_METHOD_BEG();
@@ -399,6 +543,7 @@ void EnetInit(PMP_ADAPTER pAdapter, MP_MDIO_PHY_INTERFACE_TYPE EnetPhyInterfaceT
     ENETRegBase->ECR.U = ECR_RegMask;
     ENETRegBase->RCR.U = RCR_RegMask;
     ENETRegBase->TCR.U = TCR_RegMask;
+    ENETRegBase->FTRL  = max(pAdapter->JumboPacket + ETHER_FRAME_CRC_LENGTH, 0x7FF);                 // Frame truncation length must not be less than MAX_FL
     ENETRegBase->MIBC.U = 0;                                                                         // Enable statistic counters
     ENETRegBase->RACC.U = ENET_RACC_SHIFT16_MASK;                                                    // Instructs the MAC to write two additional bytes in front of each frame received into the RX FIFO.
     ENETRegBase->PALR = pAdapter->FecMacAddress[3] | pAdapter->FecMacAddress[2] << 8 | pAdapter->FecMacAddress[1] << 16 | pAdapter->FecMacAddress[0] << 24;
@@ -426,6 +571,7 @@ void EnetInit(PMP_ADAPTER pAdapter, MP_MDIO_PHY_INTERFACE_TYPE EnetPhyInterfaceT
     ENETRegBase->TSEM = ENET_MAC_TX_SECTION_EMPTY_DEFAULT_VALUE; // 8~480?
 #endif
     SetUnicast(pAdapter);
+    Enet1588Init(pAdapter);
     //Dbg_DumpFifoTrasholdsAndPauseFrameDuration(pAdapter);
     DBG_SM_METHOD_END();
 }
\ No newline at end of file
@@ -88,8 +88,15 @@ extern "C" {
 #define SPEED_SELECT_DEFAULT             SPEED_AUTO  // Speed select
 #define SPEED_SELECT_MIN                 SPEED_AUTO
 #define SPEED_SELECT_MAX     SPEED_FULL_DUPLEX_100M
+#define QUEUE_COUNT_DEFAULT                       1  // Number of ENET Rx/Tx ring pairs, i.MX6Q/DL has only ring 0
+#define QUEUE_COUNT_MIN                           1
+#define QUEUE_COUNT_MAX                           3  // i.MX6SX and i.MX8M have rings 0, 1 and 2 (AVB class A and B rings)
+#define JUMBO_PACKET_DEFAULT                   1514  // Maximal Ethernet frame size without CRC (*JumboPacket), 1514 = jumbo frames disabled
+#define JUMBO_PACKET_MIN                       1514
+#define JUMBO_PACKET_MAX                       9014
 
 #define ENET_RX_FRAME_SIZE                     2048
+#define ENET_RX_JUMBO_FRAME_SIZE               4096  // Rx buffer size if jumbo frames are enabled, longer frames are received into several buffers
 #define ENET_TX_FRAME_SIZE                     2048
 
 #define MMI_DATA_MASK                         0xFFFF
@@ -98,6 +105,19 @@ extern "C" {
 #define ENET_RX_INT_MASK     (ENET_EIR_RXF_MASK)
 #define ENET_TX_INT_MASK     (ENET_EIR_TXF_MASK | ENET_TX_ERR_INT_MASK)
 #define ENET_RX_TX_INT_MASK  (ENET_RX_INT_MASK | ENET_TX_INT_MASK | ENET_EIR_GRA_MASK)
+#define ENET_MII_INT_MASK    (ENET_EIR_MII_MASK)
+#define ENET_RX1_INT_MASK    (ENET_EIR_RXF1_MASK)
+#define ENET_TX1_INT_MASK    (ENET_EIR_TXF1_MASK)
+#define ENET_RX2_INT_MASK    (ENET_EIR_RXF2_MASK)
+#define ENET_TX2_INT_MASK    (ENET_EIR_TXF2_MASK)
+#define ENET_RX_ALL_INT_MASK (ENET_RX_INT_MASK | ENET_RX1_INT_MASK | ENET_RX2_INT_MASK)
+
+// Ring 1 and 2 configuration (i.MX6SX, i.MX8M). VLAN priorities 2-4 are received to ring 1 and 5-7 to ring 2,
+// untagged frames and priorities 0-1 go to ring 0. Tx frames are classified the same way.
+#define ENET_RCMR1_VALUE     (ENET_RCMR_MATCHEN_MASK | (2 << ENET_RCMR_CMP_SHIFT(0)) | (3 << ENET_RCMR_CMP_SHIFT(1)) | (4 << ENET_RCMR_CMP_SHIFT(2)) | (4 << ENET_RCMR_CMP_SHIFT(3)))
+#define ENET_RCMR2_VALUE     (ENET_RCMR_MATCHEN_MASK | (5 << ENET_RCMR_CMP_SHIFT(0)) | (6 << ENET_RCMR_CMP_SHIFT(1)) | (7 << ENET_RCMR_CMP_SHIFT(2)) | (7 << ENET_RCMR_CMP_SHIFT(3)))
+#define ENET_DMACFG_VALUE    (ENET_DMACFG_DMA_CLASS_EN_MASK | 0x200)   // Credit based shaping, idle slope 0x200 = 50% of the bandwidth for each class ring
+#define ENET_PRIORITY_TO_QUEUE_MAP  { 0, 0, 1, 1, 1, 2, 2, 2 }         // 802.1p priority -> Tx ring index
 
 // statistic counters for the frames which have been received by the ENET
 typedef struct  _FRAME_RCV_STATUS
@@ -127,6 +147,7 @@ typedef struct  _FRAME_TXD_STATUS
 MINIPORT_ISR EnetIsr;
 MINIPORT_SYNCHRONIZE_INTERRUPT EnetEnableRxAndTxInterrupts;
 MINIPORT_SYNCHRONIZE_INTERRUPT EnetDisableRxAndTxInterrupts;
+MINIPORT_SYNCHRONIZE_INTERRUPT EnetRestoreInterrupts;
 
 typedef struct _MP_ADAPTER MP_ADAPTER,*PMP_ADAPTER;
 
@@ -64,10 +64,18 @@ NDIS_STATUS MpAllocAdapterBlock(PMP_ADAPTER *ppAdapter, NDIS_HANDLE MiniportAdap
         InitializeListHead(&pAdapter->PoMgmt.PatternList);
         NdisAllocateSpinLock(&pAdapter->Dev_SpinLock);
 
-        MpQueueInit(&pAdapter->Tx_qMpOwnedBDs);                // Initialize pending Tx Ethernet frames (NET_BUFFERs) queue
-        MpQueueInit(&pAdapter->Tx_qDmaOwnedBDs);               // Initialize in-progress Tx Ethernet frames (NET_BUFFERs) queue
-        NdisAllocateSpinLock(&pAdapter->Tx_SpinLock);          // Initialize Tx path spin lock
-        NdisAllocateSpinLock(&pAdapter->Rx_SpinLock);          // Initialize Rx path spin lock
+        for (ULONG QueueIdx = 0; QueueIdx < QUEUE_COUNT_MAX; ++QueueIdx) {
+            PMP_TX_QUEUE pTxQueue = &pAdapter->TxQueue[QueueIdx];
+            PMP_RX_QUEUE pRxQueue = &pAdapter->RxQueue[QueueIdx];
+            pTxQueue->Idx = QueueIdx;
+            pRxQueue->Idx = QueueIdx;
+            MpQueueInit(&pTxQueue->qMpOwnedBDs);               // Initialize pending Tx Ethernet frames (NET_BUFFERs) queue
+            MpQueueInit(&pTxQueue->qDmaOwnedBDs);              // Initialize in-progress Tx Ethernet frames (NET_BUFFERs) queue
+            NdisAllocateSpinLock(&pTxQueue->SpinLock);         // Initialize Tx ring spin lock
+            NdisAllocateSpinLock(&pRxQueue->SpinLock);         // Initialize Rx ring spin lock
+        }
+        NdisAllocateSpinLock(&pAdapter->Enet1588Timer.Lock);   // Initialize 1588 timer spin lock
+        NdisAllocateSpinLock(&pAdapter->Enet1588Timer.TimestampLog.Lock);  // Initialize 1588 timestamp log spin lock
 
         // State machine initialization
         PMP_STATE_MACHINE pSM = &pAdapter->StateMachine;
@@ -75,6 +83,7 @@ NDIS_STATUS MpAllocAdapterBlock(PMP_ADAPTER *ppAdapter, NDIS_HANDLE MiniportAdap
         pSM->SM_NextState = SM_STATE_PAUSED;
         NdisAllocateSpinLock(&pSM->SM_SpinLock);               // Initialize state machine spin lock
         NdisInitializeEvent(&pSM->SM_EnetHaltedEvent);         // Initialize Halted state event
+        KeInitializeDpc(&pSM->SM_LinkUpdateDpc, MpSmLinkUpdateDpc, pAdapter);  // Initialize link update request DPC
 
         NDIS_TIMER_CHARACTERISTICS  Timer;
         NdisZeroMemory(&Timer, sizeof(Timer));
@@ -100,112 +109,55 @@ NDIS_STATUS MpAllocAdapterBlock(PMP_ADAPTER *ppAdapter, NDIS_HANDLE MiniportAdap
 
 /*++
 Routine Description:
-    Allocate all the memory blocks for send, receive and others
+    Allocates the Dma buffer descriptor table and the receive buffers of one Rx ring.
 Arguments:
     pAdapter    Pointer to our adapter
+    pRxQueue    Rx ring
 Return Value:
     NDIS_STATUS_SUCCESS
-    NDIS_STATUS_FAILURE
     NDIS_STATUS_RESOURCES
 --*/
-_Use_decl_annotations_
-NDIS_STATUS NICAllocAdapterMemory(PMP_ADAPTER pAdapter)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static NDIS_STATUS NICAllocRxQueueMemory(_In_ PMP_ADAPTER pAdapter, _Inout_ PMP_RX_QUEUE pRxQueue)
 {
-    NDIS_STATUS                     Status = NDIS_STATUS_SUCCESS;
-    PMP_TX_PAYLOAD_BD               pEnetSwExtBD;
-    LONG                            index;
-    NDIS_SG_DMA_DESCRIPTION         DmaDescription;
-    PUCHAR                          AllocVa;
-    NDIS_PHYSICAL_ADDRESS           AllocPa;
-    NET_BUFFER_LIST_POOL_PARAMETERS PoolParameters;
+    NDIS_STATUS Status = NDIS_STATUS_SUCCESS;
 
-    DBG_ENET_DEV_METHOD_BEG();
     for(;;) {
-
-        // Initialize DMA system
-        NdisZeroMemory(&DmaDescription, sizeof(DmaDescription));
-        DmaDescription.Header.Type                      = NDIS_OBJECT_TYPE_SG_DMA_DESCRIPTION;
-        DmaDescription.Header.Revision                  = NDIS_SG_DMA_DESCRIPTION_REVISION_1;
-        DmaDescription.Header.Size                      = sizeof(NDIS_SG_DMA_DESCRIPTION);
-        DmaDescription.Flags                            = 0;                    // we don't do 64 bit DMA
-        DmaDescription.MaximumPhysicalMapping           = ENET_TX_FRAME_SIZE;   // Even if offload is enabled, the packet size for mapping shouldn't change
-        DmaDescription.ProcessSGListHandler             = MpProcessSGList;      //
-        DmaDescription.SharedMemAllocateCompleteHandler = NULL;                 // ENET does not call NdisMAllocateSharedMemoryAsyncEx, hence no need for complete handler
-        if ((Status = NdisMRegisterScatterGatherDma(pAdapter->AdapterHandle, &DmaDescription, &pAdapter->Tx_DmaHandle)) == NDIS_STATUS_SUCCESS) {
-            pAdapter->Tx_SGListSize = DmaDescription.ScatterGatherListSize;
-        } else {
-            DBG_ENET_DEV_PRINT_ERROR_WITH_STATUS("NdisMRegisterScatterGatherDma() failed.");
-            break;
-        }
-        pAdapter->CacheFillSize = NdisMGetDmaAlignment(pAdapter->AdapterHandle);
-
-        //  Allocates a pool of NBL(and NB) structures for Rx path. Each allocated NBL structure is initialized with one NB structure.
-        NdisZeroMemory(&PoolParameters, sizeof(NET_BUFFER_LIST_POOL_PARAMETERS));
-        PoolParameters.Header.Type        = NDIS_OBJECT_TYPE_DEFAULT;
-        PoolParameters.Header.Revision    = NET_BUFFER_LIST_POOL_PARAMETERS_REVISION_1;
-        PoolParameters.Header.Size        = sizeof(PoolParameters);
-        PoolParameters.fAllocateNetBuffer = TRUE;                     // Allocate one NB for each NBL
-        // PoolParameters.DataSize        = 0;                        // Do not allocate data buffer
-        // PoolParameters.ProtocolId      = NDIS_PROTOCOL_ID_DEFAULT; // NDIS_PROTOCOL_ID_DEFAULT = 0;
-        PoolParameters.PoolTag            = MP_TAG_TX_NBL_AND_NB;
-        pAdapter->Rx_NBAndNBLPool         = NdisAllocateNetBufferListPool(pAdapter->AdapterHandle,&PoolParameters);
-        if (pAdapter->Rx_NBAndNBLPool == NULL)  {
-            Status = NDIS_STATUS_RESOURCES;
-            break;
-        }
-
-        // Initialize Tx Lookaside lists
-        NdisInitializeNPagedLookasideList(&pAdapter->Tx_MpTxBDLookasideList, NULL, NULL, 0, sizeof(MP_TX_BD) - sizeof(SCATTER_GATHER_LIST) + pAdapter->Tx_SGListSize, MP_TAG_TX_BD, 0);
-
-        pAdapter->Rx_DmaBDT_DmaOwnedBDsLowWatterMark = (pAdapter->Rx_DmaBDT_ItemCount * MAC_RX_BUFFER_LOW_WATER_PERCENT) / 100;
-
         /* ************************************************************************************************************************************ */
-        /* Allocated memory for ENET DMA Receive Descriptors Table(Rx_DmaBDT). Note: This memory must be 8 bytes aligned!                       */
+        /* Allocated memory for ENET DMA Receive Descriptors Table(DmaBDT). Note: This memory must be 8 bytes aligned!                          */
         /* ************************************************************************************************************************************ */
-        pAdapter->Rx_DmaBDT_Size = pAdapter->Rx_DmaBDT_ItemCount * sizeof(ENET_BD);
-        NdisMAllocateSharedMemory(pAdapter->AdapterHandle, pAdapter->Rx_DmaBDT_Size, FALSE, (PVOID) &pAdapter->Rx_DmaBDT, &pAdapter->Rx_DmaBDT_Pa);
-        ASSERT(!((uintptr_t)pAdapter->Rx_DmaBDT & 0x7));   // This memory must be 8 bytes aligned!
-        if (!pAdapter->Rx_DmaBDT) {
+        pRxQueue->DmaBDT_Size = pAdapter->Rx_DmaBDT_ItemCount * sizeof(ENET_BD);
+        NdisMAllocateSharedMemory(pAdapter->AdapterHandle, pRxQueue->DmaBDT_Size, FALSE, (PVOID) &pRxQueue->DmaBDT, &pRxQueue->DmaBDT_Pa);
+        ASSERT(!((uintptr_t)pRxQueue->DmaBDT & 0x7));   // This memory must be 8 bytes aligned!
+        if (!pRxQueue->DmaBDT) {
             Status = NDIS_STATUS_RESOURCES;
-            DBG_ENET_DEV_PRINT_ERROR_WITH_STATUS("NdisMAllocateSharedMemory() failed to allocate memory for Rx_DmaBDT.");
+            DBG_ENET_DEV_PRINT_ERROR_WITH_STATUS("NdisMAllocateSharedMemory() failed to allocate memory for Rx DmaBDT.");
             break;
         }
-        NdisZeroMemory((PVOID)pAdapter->Rx_DmaBDT, pAdapter->Rx_DmaBDT_Size);
-
-        /* ************************************************************************************************************************************ */
-        /* Allocated memory for ENET DMA Transmit Descriptors Table(Tx_DmaBDT). Note: This memory must be 8 bytes aligned!                      */
-        /* ************************************************************************************************************************************ */
-        pAdapter->Tx_DmaBDT_Size = pAdapter->Tx_DmaBDT_ItemCount * sizeof(ENET_BD);
-        NdisMAllocateSharedMemory(pAdapter->AdapterHandle, pAdapter->Tx_DmaBDT_Size, FALSE, (PVOID) &pAdapter->Tx_DmaBDT, &pAdapter->Tx_DmaBDT_Pa);
-        ASSERT(!((uintptr_t)pAdapter->Tx_DmaBDT & 0x7));   // This memory must be 8 bytes aligned!
-        if (!pAdapter->Tx_DmaBDT) {
-            Status = NDIS_STATUS_RESOURCES;
-            DBG_ENET_DEV_PRINT_ERROR_WITH_STATUS("NdisMAllocateSharedMemory() failed to allocate memory for Tx_DmaBDT.");
-            break;
-        }
-        NdisZeroMemory((PVOID)pAdapter->Tx_DmaBDT, pAdapter->Tx_DmaBDT_Size);
+        NdisZeroMemory((PVOID)pRxQueue->DmaBDT, pRxQueue->DmaBDT_Size);
 
         // Allocate RX DMA SW extension buffer descriptors array.
-        ULONG Rx_DmaBDT_SwExtSize =  sizeof(PMP_RX_FRAME_BD) * pAdapter->Rx_DmaBDT_ItemCount;
-        if ((pAdapter->Rx_DmaBDT_SwExt = NdisAllocateMemoryWithTagPriority(pAdapter->AdapterHandle, Rx_DmaBDT_SwExtSize, MP_TAG_RX_PAYLOAD_DESC, NormalPoolPriority)) == NULL) {
+        ULONG DmaBDT_SwExtSize =  sizeof(PMP_RX_FRAME_BD) * pAdapter->Rx_DmaBDT_ItemCount;
+        if ((pRxQueue->DmaBDT_SwExt = NdisAllocateMemoryWithTagPriority(pAdapter->AdapterHandle, DmaBDT_SwExtSize, MP_TAG_RX_PAYLOAD_DESC, NormalPoolPriority)) == NULL) {
             Status = NDIS_STATUS_RESOURCES;
             DBG_ENET_DEV_PRINT_ERROR_WITH_STATUS("NdisMAllocateSharedMemory() failed to allocated RX Dma SW extension descriptors table.");
             break;
         }
-        NdisZeroMemory(pAdapter->Rx_DmaBDT_SwExt, Rx_DmaBDT_SwExtSize);
+        NdisZeroMemory(pRxQueue->DmaBDT_SwExt, DmaBDT_SwExtSize);
         // Allocate RX frame buffer descriptors array.
-        ULONG Rx_FrameBDTSize =  sizeof(MP_RX_FRAME_BD) * pAdapter->Rx_DmaBDT_ItemCount;
-        if ((pAdapter->Rx_FrameBDT = NdisAllocateMemoryWithTagPriority(pAdapter->AdapterHandle, Rx_FrameBDTSize, MP_TAG_RX_PAYLOAD_DESC, NormalPoolPriority)) == NULL) {
+        ULONG FrameBDTSize =  sizeof(MP_RX_FRAME_BD) * pAdapter->Rx_DmaBDT_ItemCount;
+        if ((pRxQueue->FrameBDT = NdisAllocateMemoryWithTagPriority(pAdapter->AdapterHandle, FrameBDTSize, MP_TAG_RX_PAYLOAD_DESC, NormalPoolPriority)) == NULL) {
             Status = NDIS_STATUS_RESOURCES;
             DBG_ENET_DEV_PRINT_ERROR_WITH_STATUS("NdisAllocateMemoryWithTagPriority() failed to allocated RX frame descriptors table.");
             break;
         }
-        NdisZeroMemory(pAdapter->Rx_FrameBDT, Rx_FrameBDTSize);
+        NdisZeroMemory(pRxQueue->FrameBDT, FrameBDTSize);
         // Allocate RX frame date buffers. Allocate buffer memory, MDL, NBL, NB
         for (LONG RxBuffIdx = 0; RxBuffIdx < pAdapter->Rx_DmaBDT_ItemCount; ++RxBuffIdx) {
-            MP_RX_FRAME_BD *pRxFrameBD = &pAdapter->Rx_FrameBDT[RxBuffIdx];
+            MP_RX_FRAME_BD *pRxFrameBD = &pRxQueue->FrameBDT[RxBuffIdx];
+            pRxFrameBD->pRxQueue = pRxQueue;
             #if 0 //MVa
-            NdisMAllocateSharedMemory(pAdapter->AdapterHandle, pAdapter->ENET_RX_FRAME_SIZE, TRUE, &pRxFrameBD->pBuffer, &pRxFrameBD->BufferPa);
+            NdisMAllocateSharedMemory(pAdapter->AdapterHandle, pAdapter->Rx_BufferSize, TRUE, &pRxFrameBD->pBuffer, &pRxFrameBD->BufferPa);
             if (pRxFrameBD->pBuffer == NULL) {
                 DBG_PRINT_ERROR(ZONE_INIT, "Failed to allocate memory for ENET receive buffer descriptor.");
                 Status = NDIS_STATUS_RESOURCES;
@@ -216,7 +168,7 @@ NDIS_STATUS NICAllocAdapterMemory(PMP_ADAPTER pAdapter)
                 PHYSICAL_ADDRESS highestAcceptableAddress; highestAcceptableAddress.QuadPart = (LONGLONG)-1;
                 PHYSICAL_ADDRESS lowestAcceptableAddress; lowestAcceptableAddress.QuadPart = 0;
                 PHYSICAL_ADDRESS boundaryAddress; boundaryAddress.QuadPart = 0;
-                pRxFrameBD->pBuffer = (PUCHAR)MmAllocateContiguousMemorySpecifyCache(ENET_RX_FRAME_SIZE,lowestAcceptableAddress,highestAcceptableAddress,boundaryAddress,MmCached);
+                pRxFrameBD->pBuffer = (PUCHAR)MmAllocateContiguousMemorySpecifyCache(pAdapter->Rx_BufferSize,lowestAcceptableAddress,highestAcceptableAddress,boundaryAddress,MmCached);
                 if (pRxFrameBD->pBuffer == NULL) {
                     DBG_ENET_DEV_PRINT_ERROR_WITH_STATUS("MmAllocateContiguousMemorySpecifyCache() failed to allocate memory for receive buffer.");
                     Status = NDIS_STATUS_RESOURCES;
@@ -225,7 +177,7 @@ NDIS_STATUS NICAllocAdapterMemory(PMP_ADAPTER pAdapter)
                 pRxFrameBD->BufferPa = MmGetPhysicalAddress(pRxFrameBD->pBuffer);
             } // MS-temp fix end
             // Allocate MDL
-            if ((pRxFrameBD->pMdl = NdisAllocateMdl(pAdapter->AdapterHandle, pRxFrameBD->pBuffer, ENET_RX_FRAME_SIZE)) == NULL) {
+            if ((pRxFrameBD->pMdl = NdisAllocateMdl(pAdapter->AdapterHandle, pRxFrameBD->pBuffer, pAdapter->Rx_BufferSize)) == NULL) {
                 Status = NDIS_STATUS_RESOURCES;
                 DBG_ENET_DEV_PRINT_ERROR_WITH_STATUS("NdisAllocateMdl() failed to allocate Mdl for receive buffer.");
                 break;
@@ -238,26 +190,60 @@ NDIS_STATUS NICAllocAdapterMemory(PMP_ADAPTER pAdapter)
             }
             MP_NBL_SET_RX_FRAME_BD(pRxFrameBD->pNBL, pRxFrameBD);       // Associate NBL and payload buffer descriptor
         }
-        if (Status != NDIS_STATUS_SUCCESS) {
+        break;
+    }
+    return Status;
+}
+
+/*++
+Routine Description:
+    Allocates the Dma buffer descriptor table and the transmit buffers of one Tx ring.
+Arguments:
+    pAdapter    Pointer to our adapter
+    pTxQueue    Tx ring
+Return Value:
+    NDIS_STATUS_SUCCESS
+    NDIS_STATUS_RESOURCES
+--*/
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static NDIS_STATUS NICAllocTxQueueMemory(_In_ PMP_ADAPTER pAdapter, _Inout_ PMP_TX_QUEUE pTxQueue)
+{
+    NDIS_STATUS                     Status = NDIS_STATUS_SUCCESS;
+    PMP_TX_PAYLOAD_BD               pEnetSwExtBD;
+    LONG                            index;
+    PUCHAR                          AllocVa;
+    NDIS_PHYSICAL_ADDRESS           AllocPa;
+
+    for(;;) {
+        /* ************************************************************************************************************************************ */
+        /* Allocated memory for ENET DMA Transmit Descriptors Table(DmaBDT). Note: This memory must be 8 bytes aligned!                         */
+        /* ************************************************************************************************************************************ */
+        pTxQueue->DmaBDT_Size = pAdapter->Tx_DmaBDT_ItemCount * sizeof(ENET_BD);
+        NdisMAllocateSharedMemory(pAdapter->AdapterHandle, pTxQueue->DmaBDT_Size, FALSE, (PVOID) &pTxQueue->DmaBDT, &pTxQueue->DmaBDT_Pa);
+        ASSERT(!((uintptr_t)pTxQueue->DmaBDT & 0x7));   // This memory must be 8 bytes aligned!
+        if (!pTxQueue->DmaBDT) {
+            Status = NDIS_STATUS_RESOURCES;
+            DBG_ENET_DEV_PRINT_ERROR_WITH_STATUS("NdisMAllocateSharedMemory() failed to allocate memory for Tx DmaBDT.");
             break;
         }
+        NdisZeroMemory((PVOID)pTxQueue->DmaBDT, pTxQueue->DmaBDT_Size);
 
         /* ************************************************************************************************************************************ */
         // Allocate memory for tx Ethernet frames
         /* ************************************************************************************************************************************ */
-        pAdapter->Tx_DataBuffer_Size = pAdapter->Tx_DmaBDT_ItemCount * (ENET_TX_FRAME_SIZE/*+ pAdapter->CacheFillSize*/ );
-        NdisMAllocateSharedMemory(pAdapter->AdapterHandle, pAdapter->Tx_DataBuffer_Size, TRUE, &pAdapter->Tx_DataBuffer_Va, &pAdapter->Tx_DataBuffer_Pa);
-        if (pAdapter->Tx_DataBuffer_Va == NULL) {
+        pTxQueue->DataBuffer_Size = pAdapter->Tx_DmaBDT_ItemCount * (pAdapter->Tx_BufferSize/*+ pAdapter->CacheFillSize*/ );
+        NdisMAllocateSharedMemory(pAdapter->AdapterHandle, pTxQueue->DataBuffer_Size, TRUE, &pTxQueue->DataBuffer_Va, &pTxQueue->DataBuffer_Pa);
+        if (pTxQueue->DataBuffer_Va == NULL) {
             Status = NDIS_STATUS_RESOURCES;
             DBG_ENET_DEV_PRINT_ERROR_WITH_STATUS("NdisMAllocateSharedMemory() failed to allocate a big Tx data buffer");
             break;
         }
         // For each Tx buffer initialize buffer description
-        AllocVa = pAdapter->Tx_DataBuffer_Va;
-        AllocPa = pAdapter->Tx_DataBuffer_Pa;
+        AllocVa = pTxQueue->DataBuffer_Va;
+        AllocPa = pTxQueue->DataBuffer_Pa;
         for (index = 0; index < pAdapter->Tx_DmaBDT_ItemCount; index++) {
-            pEnetSwExtBD = &pAdapter->Tx_EnetSwExtBDT[index];
-            pEnetSwExtBD->BufferSize        = ENET_TX_FRAME_SIZE;
+            pEnetSwExtBD = &pTxQueue->EnetSwExtBDT[index];
+            pEnetSwExtBD->BufferSize        = pAdapter->Tx_BufferSize;
             pEnetSwExtBD->pBuffer           = MP_ALIGNMEM(AllocVa, pAdapter->CacheFillSize); // Align the buffer on the cache line boundary
             pEnetSwExtBD->BufferPa.QuadPart = MP_ALIGNMEM_PA(AllocPa, pAdapter->CacheFillSize);
             #pragma prefast(disable:6385, "pEnetSwExtBD->pBuffer")
@@ -267,8 +253,182 @@ NDIS_STATUS NICAllocAdapterMemory(PMP_ADAPTER pAdapter)
                 Status = NDIS_STATUS_RESOURCES;
                 break;
             }
-            AllocVa += ENET_TX_FRAME_SIZE;
-            AllocPa.QuadPart += ENET_TX_FRAME_SIZE;
+            AllocVa += pAdapter->Tx_BufferSize;
+            AllocPa.QuadPart += pAdapter->Tx_BufferSize;
+        }
+        break;
+    }
+    return Status;
+}
+
+/*++
+Routine Description:
+    Frees the memory allocated by NICAllocRxQueueMemory().
+Arguments:
+    pAdapter    Pointer to our adapter
+    pRxQueue    Rx ring
+Return Value:
+    None
+--*/
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static void NICFreeRxQueueMemory(_In_ PMP_ADAPTER pAdapter, _Inout_ PMP_RX_QUEUE pRxQueue)
+{
+    if (pRxQueue->DmaBDT) { // Free ENET Rx DmaBDT
+        NdisMFreeSharedMemory(pAdapter->AdapterHandle, pRxQueue->DmaBDT_Size, FALSE, (PVOID)pRxQueue->DmaBDT, pRxQueue->DmaBDT_Pa);
+        pRxQueue->DmaBDT = NULL;
+    }
+    // Free DmaBDT_SwExt
+    if (pRxQueue->DmaBDT_SwExt != NULL) {
+        NdisFreeMemory(pRxQueue->DmaBDT_SwExt, 0, 0);
+        pRxQueue->DmaBDT_SwExt = NULL;
+    }
+    // Free RX payload buffer descriptors
+    if (pRxQueue->FrameBDT != NULL) {
+        for (LONG RxBuffIdx = 0; RxBuffIdx < pAdapter->Rx_DmaBDT_ItemCount; ++RxBuffIdx) {
+            MP_RX_FRAME_BD *pRxFrameBD = &pRxQueue->FrameBDT[RxBuffIdx];
+            if (pRxFrameBD->pMdl != NULL) {
+                NdisFreeMdl(pRxFrameBD->pMdl);
+            }
+            if (pRxFrameBD->pNBL != NULL) {
+                NdisFreeNetBufferList(pRxFrameBD->pNBL);
+            }
+            if (pRxFrameBD->pBuffer != NULL) {
+                // MVa NdisMFreeSharedMemory(pAdapter->AdapterHandle, pAdapter->Rx_BufferSize, TRUE, pRxFrameBD->pBuffer, pRxFrameBD->BufferPa);
+                /* MS temp fix*/ MmFreeContiguousMemory(pRxFrameBD->pBuffer);
+            }
+        }
+        NdisFreeMemory(pRxQueue->FrameBDT, 0, 0);
+        pRxQueue->FrameBDT = NULL;
+    }
+}
+
+/*++
+Routine Description:
+    Frees the memory allocated by NICAllocTxQueueMemory().
+Arguments:
+    pAdapter    Pointer to our adapter
+    pTxQueue    Tx ring
+Return Value:
+    None
+--*/
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static void NICFreeTxQueueMemory(_In_ PMP_ADAPTER pAdapter, _Inout_ PMP_TX_QUEUE pTxQueue)
+{
+    for (int i = 0; i < pAdapter->Tx_DmaBDT_ItemCount; i++) { // Free all Tx packet buffer MDL
+        if (pTxQueue->EnetSwExtBDT[i].pMdl != NULL) {
+             NdisFreeMdl(pTxQueue->EnetSwExtBDT[i].pMdl);
+             pTxQueue->EnetSwExtBDT[i].pMdl = NULL;
+        }
+    }
+    if (pTxQueue->DataBuffer_Va != NULL)  { // Free Tx packets memory
+        NdisMFreeSharedMemory(pAdapter->AdapterHandle, pTxQueue->DataBuffer_Size, TRUE, pTxQueue->DataBuffer_Va, pTxQueue->DataBuffer_Pa);
+        pTxQueue->DataBuffer_Va = NULL;
+    }
+    if (pTxQueue->DmaBDT) { // Free Tx DmaBDT
+        NdisMFreeSharedMemory(pAdapter->AdapterHandle, pTxQueue->DmaBDT_Size, FALSE, (PVOID)pTxQueue->DmaBDT, pTxQueue->DmaBDT_Pa);
+        pTxQueue->DmaBDT = NULL;
+    }
+}
+
+/*++
+Routine Description:
+    Allocate all the memory blocks for send, receive and others
+Arguments:
+    pAdapter    Pointer to our adapter
+Return Value:
+    NDIS_STATUS_SUCCESS
+    NDIS_STATUS_FAILURE
+    NDIS_STATUS_RESOURCES
+--*/
+_Use_decl_annotations_
+NDIS_STATUS NICAllocAdapterMemory(PMP_ADAPTER pAdapter)
+{
+    NDIS_STATUS                     Status = NDIS_STATUS_SUCCESS;
+    NDIS_SG_DMA_DESCRIPTION         DmaDescription;
+    NET_BUFFER_LIST_POOL_PARAMETERS PoolParameters;
+
+    DBG_ENET_DEV_METHOD_BEG();
+    for(;;) {
+        // Frame buffer sizes. Rx buffers are limited to one page, a longer jumbo frame is received into several buffers (MRBR = buffer size - 16).
+        pAdapter->Rx_BufferSize = ENET_RX_FRAME_SIZE;
+        if (pAdapter->JumboPacket + ETHER_FRAME_CRC_LENGTH + 2 > ENET_RX_FRAME_SIZE - 16) {
+            pAdapter->Rx_BufferSize = ENET_RX_JUMBO_FRAME_SIZE;
+        }
+        pAdapter->Tx_BufferSize = ALIGN_UP_BY(pAdapter->JumboPacket, ENET_TX_FRAME_SIZE);   // Tx frame is always copied to a single buffer
+
+        // Initialize DMA system
+        NdisZeroMemory(&DmaDescription, sizeof(DmaDescription));
+        DmaDescription.Header.Type                      = NDIS_OBJECT_TYPE_SG_DMA_DESCRIPTION;
+        DmaDescription.Header.Revision                  = NDIS_SG_DMA_DESCRIPTION_REVISION_1;
+        DmaDescription.Header.Size                      = sizeof(NDIS_SG_DMA_DESCRIPTION);
+        DmaDescription.Flags                            = 0;                    // we don't do 64 bit DMA
+        DmaDescription.MaximumPhysicalMapping           = pAdapter->Tx_BufferSize;  // Even if offload is enabled, the packet size for mapping shouldn't change
+        DmaDescription.ProcessSGListHandler             = MpProcessSGList;      //
+        DmaDescription.SharedMemAllocateCompleteHandler = NULL;                 // ENET does not call NdisMAllocateSharedMemoryAsyncEx, hence no need for complete handler
+        if ((Status = NdisMRegisterScatterGatherDma(pAdapter->AdapterHandle, &DmaDescription, &pAdapter->Tx_DmaHandle)) == NDIS_STATUS_SUCCESS) {
+            pAdapter->Tx_SGListSize = DmaDescription.ScatterGatherListSize;
+        } else {
+            DBG_ENET_DEV_PRINT_ERROR_WITH_STATUS("NdisMRegisterScatterGatherDma() failed.");
+            break;
+        }
+        pAdapter->CacheFillSize = NdisMGetDmaAlignment(pAdapter->AdapterHandle);
+
+        //  Allocates a pool of NBL(and NB) structures for Rx path. Each allocated NBL structure is initialized with one NB structure.
+        NdisZeroMemory(&PoolParameters, sizeof(NET_BUFFER_LIST_POOL_PARAMETERS));
+        PoolParameters.Header.Type        = NDIS_OBJECT_TYPE_DEFAULT;
+        PoolParameters.Header.Revision    = NET_BUFFER_LIST_POOL_PARAMETERS_REVISION_1;
+        PoolParameters.Header.Size        = sizeof(PoolParameters);
+        PoolParameters.fAllocateNetBuffer = TRUE;                     // Allocate one NB for each NBL
+        // PoolParameters.DataSize        = 0;                        // Do not allocate data buffer
+        // PoolParameters.ProtocolId      = NDIS_PROTOCOL_ID_DEFAULT; // NDIS_PROTOCOL_ID_DEFAULT = 0;
+        PoolParameters.PoolTag            = MP_TAG_TX_NBL_AND_NB;
+        pAdapter->Rx_NBAndNBLPool         = NdisAllocateNetBufferListPool(pAdapter->AdapterHandle,&PoolParameters);
+        if (pAdapter->Rx_NBAndNBLPool == NULL)  {
+            Status = NDIS_STATUS_RESOURCES;
+            break;
+        }
+
+        // Initialize Tx Lookaside lists
+        NdisInitializeNPagedLookasideList(&pAdapter->Tx_MpTxBDLookasideList, NULL, NULL, 0, sizeof(MP_TX_BD) - sizeof(SCATTER_GATHER_LIST) + pAdapter->Tx_SGListSize, MP_TAG_TX_BD, 0);
+
+        pAdapter->Rx_DmaBDT_DmaOwnedBDsLowWatterMark = (pAdapter->Rx_DmaBDT_ItemCount * MAC_RX_BUFFER_LOW_WATER_PERCENT) / 100;
+
+        // Set up ring registers and interrupt steering. Ring q is served by EnetDpc on processor q (modulo number of processors).
+        ULONG ProcessorCount = KeQueryActiveProcessorCountEx(0);
+        pAdapter->EnetRxTxIntMask = ENET_RX_TX_INT_MASK;
+        for (ULONG QueueIdx = 0; QueueIdx < pAdapter->QueueCount; ++QueueIdx) {
+            PMP_TX_QUEUE pTxQueue = &pAdapter->TxQueue[QueueIdx];
+            PMP_RX_QUEUE pRxQueue = &pAdapter->RxQueue[QueueIdx];
+            switch (QueueIdx) {
+                case 0:
+                    pTxQueue->pTDAR    = &pAdapter->ENETRegBase->TDAR;
+                    pRxQueue->pRDAR    = &pAdapter->ENETRegBase->RDAR;
+                    pTxQueue->IntMask  = ENET_TX_INT_MASK;
+                    pRxQueue->IntMask  = ENET_RX_TX_INT_MASK | ENET_1588_INT_MASK | ENET_MII_INT_MASK | ENET_EIR_EBERR_MASK;  // Ring 0 DPC also handles the events not related to any ring
+                    break;
+                case 1:
+                    pTxQueue->pTDAR    = &pAdapter->ENETRegBase->TDAR1;
+                    pRxQueue->pRDAR    = &pAdapter->ENETRegBase->RDAR1;
+                    pTxQueue->IntMask  = ENET_TX1_INT_MASK;
+                    pRxQueue->IntMask  = ENET_RX1_INT_MASK | ENET_TX1_INT_MASK;
+                    break;
+                default:
+                    pTxQueue->pTDAR    = &pAdapter->ENETRegBase->TDAR2;
+                    pRxQueue->pRDAR    = &pAdapter->ENETRegBase->RDAR2;
+                    pTxQueue->IntMask  = ENET_TX2_INT_MASK;
+                    pRxQueue->IntMask  = ENET_RX2_INT_MASK | ENET_TX2_INT_MASK;
+                    break;
+            }
+            pRxQueue->DpcProcessor = QueueIdx % ProcessorCount;
+            if (QueueIdx != 0) {
+                pAdapter->EnetRxTxIntMask |= pRxQueue->IntMask;
+            }
+            if ((Status = NICAllocRxQueueMemory(pAdapter, pRxQueue)) != NDIS_STATUS_SUCCESS) {
+                break;
+            }
+            if ((Status = NICAllocTxQueueMemory(pAdapter, pTxQueue)) != NDIS_STATUS_SUCCESS) {
+                break;
+            }
         }
         break;
     }
@@ -294,6 +454,10 @@ void MpFreeAdapter(PMP_ADAPTER  pAdapter)
     if (pAdapter) {
         // Free hardware resources
 
+        PHYDev_DisconnectInterrupt(pAdapter);
+        if (pAdapter->ENETRegBase) {
+            Enet1588Deinit(pAdapter);
+        }
         if (pAdapter->NdisInterruptHandle)  {
             NdisMDeregisterInterruptEx(pAdapter->NdisInterruptHandle);
         }
@@ -302,50 +466,12 @@ void MpFreeAdapter(PMP_ADAPTER  pAdapter)
         }
 
         MDIODev_DeinitDevice(&pAdapter->ENETDev_MDIODevice);
+        KeRemoveQueueDpc(&pAdapter->StateMachine.SM_LinkUpdateDpc);  // No more MII callbacks, make sure that MpSmLinkUpdateDpc is not running
+        KeFlushQueuedDpcs();
 
-        for (int i = 0; i < pAdapter->Tx_DmaBDT_ItemCount; i++) { // Free all Tx packet buffer MDL
-            if (pAdapter->Tx_EnetSwExtBDT[i].pMdl != NULL) {
-                 NdisFreeMdl(pAdapter->Tx_EnetSwExtBDT[i].pMdl);
-                 pAdapter->Tx_EnetSwExtBDT[i].pMdl = NULL;
-            }
-        }
-        if (pAdapter->Tx_DataBuffer_Va != NULL)  { // Free Tx packets memory
-            NdisMFreeSharedMemory(pAdapter->AdapterHandle, pAdapter->Tx_DataBuffer_Size, TRUE, pAdapter->Tx_DataBuffer_Va, pAdapter->Tx_DataBuffer_Pa);
-            pAdapter->Tx_DataBuffer_Va = NULL;
-        }
-        if (pAdapter->Tx_DmaBDT) { // Free Tx_DmaBDT
-            NdisMFreeSharedMemory(pAdapter->AdapterHandle, pAdapter->Tx_DmaBDT_Size, FALSE, (PVOID)pAdapter->Tx_DmaBDT, pAdapter->Tx_DmaBDT_Pa);
-            pAdapter->Tx_DmaBDT = NULL;
-        }
-        if (pAdapter->Rx_DmaBDT) { // Free ENET Rx_DmaBDT
-            NdisMFreeSharedMemory(pAdapter->AdapterHandle, pAdapter->Rx_DmaBDT_Size, FALSE, (PVOID)pAdapter->Rx_DmaBDT, pAdapter->Rx_DmaBDT_Pa);
-            pAdapter->Rx_DmaBDT = NULL;
-        }
-        // Free Rx_DmaBDT_SwExt
-        if (pAdapter->Rx_DmaBDT_SwExt != NULL) {
-            NdisFreeMemory(pAdapter->Rx_DmaBDT_SwExt, 0, 0);
-            pAdapter->Rx_DmaBDT_SwExt = NULL;
-        }
-        // Free RX payload buffer descriptors
-        if (pAdapter->Rx_FrameBDT != NULL) {
-            for (LONG RxBuffIdx = 0; RxBuffIdx < pAdapter->Rx_DmaBDT_ItemCount; ++RxBuffIdx) {
-                MP_RX_FRAME_BD *pRxFrameBD = &pAdapter->Rx_FrameBDT[RxBuffIdx];
-                if (pRxFrameBD != NULL) {
-                    if (pRxFrameBD->pMdl != NULL) {
-                        NdisFreeMdl(pRxFrameBD->pMdl);
-                    }
-                    if (pRxFrameBD->pNBL != NULL) {
-                        NdisFreeNetBufferList(pRxFrameBD->pNBL);
-                    }
-                    if (pRxFrameBD->pBuffer != NULL) {
-                        // MVa NdisMFreeSharedMemory(pAdapter->AdapterHandle, ENET_RX_FRAME_SIZE, TRUE, pRxFrameBD->pBuffer, pRxFrameBD->BufferPa);
-                        /* MS temp fix*/ MmFreeContiguousMemory(pRxFrameBD->pBuffer);
-                    }
-                }
-            }
-            NdisFreeMemory(pAdapter->Rx_FrameBDT, 0, 0);
-            pAdapter->Rx_FrameBDT = NULL;
-
+        for (ULONG QueueIdx = 0; QueueIdx < QUEUE_COUNT_MAX; ++QueueIdx) {  // Free all Tx and Rx ring buffers
+            NICFreeTxQueueMemory(pAdapter, &pAdapter->TxQueue[QueueIdx]);
+            NICFreeRxQueueMemory(pAdapter, &pAdapter->RxQueue[QueueIdx]);
         }
         // Free NB and NBL pool
         if (pAdapter->Rx_NBAndNBLPool) {
@@ -412,6 +538,22 @@ NDIS_STATUS NICReadRegParameters(PMP_ADAPTER pAdapter)
             SPEED_SELECT_MIN,
             SPEED_SELECT_MAX
         },
+        {
+            NDIS_STRING_CONST("QueueCount"),
+            MP_OFFSET(QueueCount),
+            MP_SIZE(QueueCount),
+            QUEUE_COUNT_DEFAULT,
+            QUEUE_COUNT_MIN,
+            QUEUE_COUNT_MAX
+        },
+        {
+            NDIS_STRING_CONST("*JumboPacket"),
+            MP_OFFSET(JumboPacket),
+            MP_SIZE(JumboPacket),
+            JUMBO_PACKET_DEFAULT,
+            JUMBO_PACKET_MIN,
+            JUMBO_PACKET_MAX
+        },
 #if DBG
         {
             NDIS_STRING_CONST("OpcodePauseDuration"),
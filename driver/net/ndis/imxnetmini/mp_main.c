@@ -225,14 +225,14 @@ NDIS_STATUS MpInitializeEx(NDIS_HANDLE MiniportAdapterHandle, NDIS_HANDLE Minipo
         GeneralAttributes.Header.Revision   = NDIS_MINIPORT_ADAPTER_GENERAL_ATTRIBUTES_REVISION_2;
         GeneralAttributes.Header.Size       = NDIS_SIZEOF_MINIPORT_ADAPTER_GENERAL_ATTRIBUTES_REVISION_2;
         GeneralAttributes.MediaType         = NIC_MEDIA_TYPE;
-        GeneralAttributes.MtuSize           = ETHER_FRAME_MAX_PAYLOAD_LENGTH;
+        GeneralAttributes.MtuSize           = pAdapter->JumboPacket - ETHER_FRAME_HEADER_LENGTH;
         GeneralAttributes.MaxXmitLinkSpeed  = NIC_MEDIA_MAX_SPEED;
         GeneralAttributes.MaxRcvLinkSpeed   = NIC_MEDIA_MAX_SPEED;
         GeneralAttributes.XmitLinkSpeed     = NDIS_LINK_SPEED_UNKNOWN;
         GeneralAttributes.RcvLinkSpeed      = NDIS_LINK_SPEED_UNKNOWN;
         GeneralAttributes.MediaConnectState = MediaConnectStateUnknown;
         GeneralAttributes.MediaDuplexState  = MediaDuplexStateUnknown;
-        GeneralAttributes.LookaheadSize     = ETHER_FRAME_MAX_PAYLOAD_LENGTH;
+        GeneralAttributes.LookaheadSize     = pAdapter->JumboPacket - ETHER_FRAME_HEADER_LENGTH;
 
         NdisZeroMemory(&PowerManagementCapabilities, sizeof(PowerManagementCapabilities));
         PowerManagementCapabilities.Header.Type     = NDIS_OBJECT_TYPE_DEFAULT;
@@ -284,7 +284,13 @@ NDIS_STATUS MpInitializeEx(NDIS_HANDLE MiniportAdapterHandle, NDIS_HANDLE Minipo
                 pResDesc = &MiniportInitParameters->AllocatedResources->PartialDescriptors[index];
                 switch (pResDesc->Type) {
                     case CmResourceTypeInterrupt:
-                        DBG_CODE(if (!GotInterrupt) pAdapter->ENETDev_Irq = pResDesc->u.Interrupt.Level);
+                        if (GotInterrupt) {                                                  // The second interrupt is optional ENET PHY interrupt (GpioInt in ACPI).
+                            pAdapter->ENETDev_PHYDevice.PHYDev_IntResource = *pResDesc;
+                            pAdapter->ENETDev_PHYDevice.PHYDev_IntResourceFound = TRUE;
+                            DBG_ENET_DEV_PRINT_INFO("PHY InterruptVector = 0x%x", pResDesc->u.Interrupt.Vector);
+                            break;
+                        }
+                        DBG_CODE(pAdapter->ENETDev_Irq = pResDesc->u.Interrupt.Level);
                         GotInterrupt = TRUE;
                         DBG_ENET_DEV_PRINT_INFO("InterruptLevel  = 0x%x", pResDesc->u.Interrupt.Level);
                         DBG_ENET_DEV_PRINT_INFO("InterruptVector = 0x%x", pResDesc->u.Interrupt.Vector);
@@ -328,6 +334,7 @@ NDIS_STATUS MpInitializeEx(NDIS_HANDLE MiniportAdapterHandle, NDIS_HANDLE Minipo
         if (!NT_SUCCESS(Acpi_GetValue(pAdapter, IMX_ENET_DSM_FUNCTION_GET_MDIO_BASE_ADDRESS_INDEX, &EnetPhyConfig.MDIOCfg_RegsPhyAddress.LowPart, sizeof(ULONG)))) {
             DBG_ENET_DEV_PRINT_INFO("MDIO Controller address was not found in ACPI. ENET Controller address will be used.");
         }
+        pAdapter->ENETDev_MDIOBusOwner = (EnetPhyConfig.MDIOCfg_RegsPhyAddress.QuadPart == ENETRegBase.QuadPart);  // MII interrupt of the MDIO bus is handled by EnetIsr?
         DBG_ENET_DEV_PRINT_INFO("ENET Controller Physical Address = 0x%08x_%08x", NdisGetPhysicalAddressHigh(ENETRegBase), NdisGetPhysicalAddressLow(ENETRegBase));
         DBG_ENET_DEV_PRINT_INFO("MDIO Controller Physical Address = 0x%08x_%08x", NdisGetPhysicalAddressHigh(EnetPhyConfig.MDIOCfg_RegsPhyAddress), NdisGetPhysicalAddressLow(EnetPhyConfig.MDIOCfg_RegsPhyAddress));
         if (!NT_SUCCESS(Acpi_GetValue(pAdapter, IMX_ENET_DSM_FUNCTION_GET_MDIO_BUS_ENET_PHY_ADDRESS_INDEX, &EnetPhyConfig.MDIOCfg_EnetPhyAddress, sizeof(EnetPhyConfig.MDIOCfg_EnetPhyAddress)))) {
@@ -372,6 +379,7 @@ NDIS_STATUS MpInitializeEx(NDIS_HANDLE MiniportAdapterHandle, NDIS_HANDLE Minipo
             break;
         }
 
+        (void)PHYDev_ConnectInterrupt(pAdapter);                                 // Optional, link state is polled if it fails
         if (!PHYDev_ConfigurePhy(pAdapter)) {
             Status = NDIS_STATUS_DEVICE_FAILED;
             break;
@@ -72,11 +72,13 @@ Routine Description:
                 Yes, find new MDIO device ready to transfer a frame (round-robin priority).
                 New frame found?
                     Yes, Start transfer (See below).
-                    No, Stop MDIO clock.
+                    No, Stop MDIO clock and timer.
         case StartTransfer:
             Write frame command (MMFR register).
             Start MDIO clock (MMCR register).
             Start timer (MDIO_TransferTimeout_ms).
+    The Start transfer event is also signaled by MDIOBus_OnTransferDone() as soon as the MII interrupt reports the end of the active frame,
+    the timer is only a fallback for the periods when the MII interrupt is masked (ENET not running). The thread does not run while no frame is pending.
 Arguments:
     pMDIOBus - MDIO bus data structure address.
 Return Value:
@@ -88,8 +90,7 @@ VOID MDIOBus_Main(_In_ MP_MDIO_BUS *pMDIOBus)
     #define  MDIO_Events_Count 3
 
     MP_MDIO_DEVICE*         pMDIODev;
-    MP_MDIO_DEVICE*         pMDIONextDev;
-    MP_MDIO_FRAME*          pActiveFrame, Frame;
+    MP_MDIO_FRAME           Frame;
     volatile CSP_ENET_REGS* MDIORegs = pMDIOBus->MDIOBus_pRegBase;
     NTSTATUS                Status;
     PVOID                   MII_Events[MDIO_Events_Count];
@@ -115,72 +116,47 @@ VOID MDIOBus_Main(_In_ MP_MDIO_BUS *pMDIOBus)
         } else {
             // Timer has expirad or new command has been queued
             NdisAcquireSpinLock(&pMDIOBus->MDIOBus_BusSpinLock);                                              // Acquire MDIO bus spin lock.
-            if (MDIORegs->EIR.U & ENET_EIR_MII_MASK) {                                                        // Transfer done?
-                MDIORegs->EIR.U = ENET_EIR_MII_MASK;                                                          // Clear Transfer done flag.
-                if ((pMDIODev = pMDIOBus->MDIOBus_pActiveDevice) != NULL) {                                   // Is there a device waiting for transfer end?
-                    Frame.MIIFunction = NULL;                                                                 
-                    NdisAcquireSpinLock(&pMDIODev->MDIODev_DeviceSpinLock);                                   // Yes, acquire MDIO device frame list spin lock.
-                    if ((pActiveFrame = pMDIODev->MDIODev_pPendingFrameListHead) != NULL) {                   // Is there a frame waiting for transfer end?
-                        DBG_MDIO_DEV_CMD_PRINT_TRACE("Transfer done. Frame: 0x%p.", pActiveFrame);
-                        pMDIODev->MDIODev_pPendingFrameListHead = pActiveFrame->MDIOFrm_pNextFrame;           // Update pending frame list head.
-                        pActiveFrame->MDIOFrm_pNextFrame = pMDIODev->MDIODev_pFreeFrameListHead;              // Return frame to the free frame list.
-                        pMDIODev->MDIODev_pFreeFrameListHead = pActiveFrame;                                  
-                        Frame = *pActiveFrame;                                                                // Create local copy of active frame.
-                    } else {
-                        DBG_MDIO_DEV_CMD_PRINT_TRACE("Transfer done. No frame is active.");
-                    }
-                    pMDIOBus->MDIOBus_TransferInProgress = FALSE;                                             // Remember that no transfer is pending now.
-                    NdisReleaseSpinLock(&pMDIODev->MDIODev_DeviceSpinLock);                                   // Release MDIO device spin lock.
-                    if (Frame.MIIFunction) {                                                                  // Callback required?
-                        DBG_MDIO_DEV_CMD_PRINT_TRACE("Invoking callback. Frame: 0x%p, Callback: %s", pActiveFrame, Dbg_GetMIICallbackName(Frame.MIIFunction));
-                        (*Frame.MIIFunction)(MDIORegs->MMFR.U, (NDIS_HANDLE)pMDIODev->MDIODev_pEnetAdapter);  // Yes, call callback.
-                    }
-                    pMDIOBus->MDIOBus_pActiveDevice = pMDIOBus->MDIOBus_pActiveDevice->MDIODev_pNextDevice;   // Mark next device in the list as a candiadte to send new frame.
-                } else {
-                    DBG_MDIO_BUS_PRINT_WARNING("NO device is waiting for transfer done !!!.");
+            if ((pMDIODev = MDIOBus_SeqCompleteTransfer(pMDIOBus, &Frame)) != NULL) {                         // Transfer done (MII interrupt or timer)?
+                if (Frame.MIIFunction) {                                                                      // Callback required?
+                    DBG_MDIO_DEV_CMD_PRINT_TRACE("Invoking callback. MMFR: 0x%08X, Callback: %s", Frame.MDIOFrm_MMFRRegVal, Dbg_GetMIICallbackName(Frame.MIIFunction));
+                    (*Frame.MIIFunction)(MDIORegs->MMFR.U, (NDIS_HANDLE)pMDIODev->MDIODev_pEnetAdapter);      // Yes, call callback.
                 }
-            }
-            if (!pMDIOBus->MDIOBus_TransferInProgress) {                                                      // If no transfer is pending, try to start new transfer.
-                if ((pMDIODev = pMDIOBus->MDIOBus_pActiveDevice) == NULL) {                                   // No device selected for transfer?
-                    pMDIODev = pMDIOBus->MDIOBus_pFirstDevice;                                                // Select first device in the list.
-                }
-                if (pMDIODev) {
-                    pMDIONextDev = pMDIODev;
-                    do {
-                        NdisAcquireSpinLock(&pMDIODev->MDIODev_DeviceSpinLock);                               // Acquire MDIO device spin lock.
-                        if ((pActiveFrame = pMDIODev->MDIODev_pPendingFrameListHead) != NULL) {               // Get new frame from pending frame list.
-                            DBG_MDIO_DEV_CMD_PRINT_TRACE("Starting new frame 0x%p.", pActiveFrame);
-                            pMDIOBus->MDIOBus_pRegBase->MMFR.U = pActiveFrame->MDIOFrm_MMFRRegVal;            // Write frame register.
-                            pMDIOBus->MDIOBus_pRegBase->MSCR.U = pMDIODev->MDIODev_MSCR.U;                    // Write speed and control register.
-                            pMDIOBus->MDIOBus_pActiveDevice = pMDIODev;                                       // Mark current device as active device.
-                            pMDIOBus->MDIOBus_TransferInProgress = TRUE;                                      // Remember that transfer is in progress.
-                            NdisReleaseSpinLock(&pMDIODev->MDIODev_DeviceSpinLock);                           // Release MDIO device frame list spin lock.
-                            break;                                                                            
-                        }                                                                                     
-                        NdisReleaseSpinLock(&pMDIODev->MDIODev_DeviceSpinLock);                               // Release MDIO device spin lock.
-                        if ((pMDIODev = pMDIODev->MDIODev_pNextDevice) == NULL) {                             // Current device has no frame ready to sent, select next device.
-                            pMDIODev = pMDIOBus->MDIOBus_pFirstDevice;                                        
-                        }                                                                                     
-                    } while (pMDIODev != pMDIONextDev);                                                       // Stop if no device has frame ready to transfer.
-                }                                                                                             
-            } else {
+            } else if (pMDIOBus->MDIOBus_TransferInProgress) {
                 DBG_MDIO_BUS_PRINT_WARNING("Previous transfer is still in progress, consider timer period increase.");
             }
-            if (pMDIOBus->MDIOBus_TransferInProgress) {                                                       
+            if (MDIOBus_SeqStartTransfer(pMDIOBus)) {                                                         // Start next frame (round-robin) if no transfer is pending.
                 KeSetTimerEx(&pMDIOBus->MDIOBus_Timer, DueTime, 0, NULL);                                     // Restart timer.
             }  else {
-                pMDIOBus->MDIOBus_pRegBase->MSCR.U = 0;                                                       // Write speed and control register.
-                DBG_MDIO_DEV_CODE(pMDIODev = NULL);
+                KeCancelTimer(&pMDIOBus->MDIOBus_Timer);                                                      // Nothing to wait for, do not wake up the thread.
                 DBG_MDIO_BUS_PRINT_TRACE("No transfer request, stopping MCIO clock.");
             }
             NdisReleaseSpinLock(&pMDIOBus->MDIOBus_BusSpinLock);                                              // Release MDIO bus spin lock.
-        }                                                                                                     
+        }
     } while (1);                                                                                              
     KeCancelTimer(&pMDIOBus->MDIOBus_Timer);
     DBG_MDIO_BUS_METHOD_END_WITH_STATUS(Status);
     PsTerminateSystemThread(STATUS_SUCCESS);
 }
 
+/*++
+Routine Description:
+    MII interrupt handler. Called from EnetDpc() of the ENET device that owns the MDIO bus controller registers when EIR[MII] is set.
+    Clears the Transfer done flag and wakes up the MDIO bus thread to complete the active frame and start the next one.
+Arguments:
+    pMDIOBus - MDIO bus data structure address.
+Return Value:
+    none
+--*/
+_Use_decl_annotations_
+void MDIOBus_OnTransferDone(MP_MDIO_BUS *pMDIOBus)
+{
+    NdisDprAcquireSpinLock(&pMDIOBus->MDIOBus_BusSpinLock);                                                      // Acquire MDIO bus spin lock.
+    if (MDIOBus_SeqOnMiiInterrupt(pMDIOBus)) {                                                                   // Transfer done and not yet handled by the thread?
+        KeSetEvent(&pMDIOBus->MDIOBus_StartTransferEvent, 0, FALSE);                                             // Yes, wake up MDIO bus thread.
+    }
+    NdisDprReleaseSpinLock(&pMDIOBus->MDIOBus_BusSpinLock);                                                      // Release MDIO bus spin lock.
+}
+
 /*++
 Routine Description:
     Starts MDIO bus controller main thread.
@@ -405,20 +381,13 @@ Return Value:
 _Use_decl_annotations_
 NTSTATUS MDIODev_InitDevice(MP_MDIO_DRIVER *pMDIODrv, MP_MDIO_ENET_PHY_CFG *pEnetPhyConfig, MP_MDIO_DEVICE *pMDIODev) {
     NTSTATUS Status = STATUS_SUCCESS;
-    ULONG MDIODev_Frequency_kHz, MDIODev_STAHoldTime_ns, i, MII_Div, MII_Hold, tmpTime;
+    ULONG MDIODev_Frequency_kHz, MDIODev_STAHoldTime_ns, MII_Div, MII_Hold, tmpTime;
 
     DBG_MDIO_DEV_METHOD_BEG_WITH_PARAMS("MDIO bus: 0x%08X_%08X, Phy: %d", NdisGetPhysicalAddressHigh(pEnetPhyConfig->MDIOCfg_RegsPhyAddress), NdisGetPhysicalAddressLow(pEnetPhyConfig->MDIOCfg_RegsPhyAddress), pEnetPhyConfig->MDIOCfg_EnetPhyAddress);
     do {
         KeInitializeEvent((PVOID)&pMDIODev->MDIODev_CmdDoneEvent, SynchronizationEvent, FALSE);
         NdisAllocateSpinLock(&pMDIODev->MDIODev_DeviceSpinLock);                                                 // Initialize device spin lock.
-        // Initilaize MDIO frame lists.
-        pMDIODev->MDIODev_pPendingFrameListHead = NULL;                                                          // Initialize pending frame list head pointer.
-        pMDIODev->MDIODev_pPendingFrameListTail = NULL;                                                          // Initialize pending frame list tail pointer.
-        pMDIODev->MDIODev_pFreeFrameListHead = &pMDIODev->MDIODev_FrameListArray[0];                             // Initialize free frame list head pointer.
-        for (i = 0; i < MDIO_FRAME_LIST_SIZE - 1; i++) {                                                         // Initialize free frame list.
-            pMDIODev->MDIODev_FrameListArray[i].MDIOFrm_pNextFrame = &pMDIODev->MDIODev_FrameListArray[i + 1];
-        }
-        pMDIODev->MDIODev_FrameListArray[MDIO_FRAME_LIST_SIZE - 1].MDIOFrm_pNextFrame = NULL;                    // Initialize the last item of free frame list.
+        MDIODev_SeqInitFrameLists(pMDIODev);                                                                     // Initilaize MDIO frame lists.
         pMDIODev->MDIODev_EnetPhyAddress = BIT_FIELD_VAL(ENET_MMFR_PA, pEnetPhyConfig->MDIOCfg_EnetPhyAddress);  // Remember ENET PHY device address.
         pMDIODev->MDIODev_PhyInterfaceType = pEnetPhyConfig->MDIOCfg_PhyInterfaceType;                           // Remember ENET PHY Interface type
         // Compute MII speed divider.
@@ -497,8 +466,8 @@ void MDIODev_DeinitDevice(MP_MDIO_DEVICE *pMDIODev) {
 
 /*++
 Routine Description:
-    This function will call MDIODev_QueueFrame to queue all the requested MII management
-    commands to the sending list.
+    This function will call MDIODev_SeqQueueCommand to queue all the requested MII management
+    commands to the sending list. Either all or none of the commands are queued.
 Arguments:
     pAdapter  - Points to a structure which contains the status and control information for the ENET controller and MII 
     pCmd      - Points to a ENET_PHY_CMD array which specifies the MII management commands and the parsing functions
@@ -508,44 +477,20 @@ Return Value:
 _Use_decl_annotations_
 NTSTATUS MDIODev_QueueCommand(MP_MDIO_DEVICE* pMDIODev, PENET_PHY_CMD pCmd)
 {
-    NTSTATUS        Status = NDIS_STATUS_SUCCESS;
-    MP_MDIO_FRAME*  pMDIOFrame = NULL;
-    MP_MDIO_FRAME*  pMDIOCmdFrameListHead;
-    MP_MDIO_FRAME*  pMDIOCmdLastFrame = NULL;
+    NTSTATUS        Status;
     MP_MDIO_BUS*    pMDIOBus = pMDIODev->MDIODev_pBus;
-    UINT            i;
+    BOOLEAN         StartTransfer;
 
     DBG_MDIO_DEV_CMD_METHOD_BEG();
     NdisAcquireSpinLock(&pMDIODev->MDIODev_DeviceSpinLock);                                           // Acquire MDIO device spin lock.
-    pMDIOCmdFrameListHead = pMDIODev->MDIODev_pFreeFrameListHead;
-    for (i = 0; (pCmd + i)->MIIData != ENET_MII_END; i++) {
-        if ((pMDIOFrame = pMDIODev->MDIODev_pFreeFrameListHead) != NULL) {                            // Free frame item list empty?
-            pMDIODev->MDIODev_pFreeFrameListHead = pMDIOFrame->MDIOFrm_pNextFrame;                    // No, get free item and update free item list.
-            pMDIOFrame->MDIOFrm_MMFRRegVal = (pCmd + i)->MIIData | pMDIODev->MDIODev_EnetPhyAddress;  // Fill new item.
-            pMDIOFrame->MIIFunction = (pCmd + i)->MIIFunct;
-            pMDIOFrame->MDIOFrm_pNextFrame = NULL;
-            if (pMDIOCmdLastFrame != NULL) {                                                          // Add frame to the tail of list
-                pMDIOCmdLastFrame->MDIOFrm_pNextFrame = pMDIOFrame;
-            }
-            pMDIOCmdLastFrame = pMDIOFrame;
-            DBG_MDIO_DEV_CMD_PRINT_TRACE("Frame 0x%p queued. MMFR: 0x%08X, Callback: %s", pMDIOFrame, pMDIOFrame->MDIOFrm_MMFRRegVal, Dbg_GetMIICallbackName(pMDIOFrame->MIIFunction));
-        }  else {
-            Status = NDIS_STATUS_RESOURCES;
-            DBG_MDIO_DEV_CMD_PRINT_ERROR_WITH_STATUS("Failed to get free Frame descriptor. Increase MDIO_FRAME_LIST_SIZE constant.");
-            break;
-        }
-    }
-    if (pMDIOFrame != NULL) {                                                                         // Frame added?
-        if (pMDIODev->MDIODev_pPendingFrameListHead == NULL) {                                        // Pending list empty?
-            pMDIODev->MDIODev_pPendingFrameListHead = pMDIOCmdFrameListHead;                          // Add frame list as the first item.
-            pMDIODev->MDIODev_pPendingFrameListTail = pMDIOFrame;                                     
-            KeSetEvent(&pMDIOBus->MDIOBus_StartTransferEvent, 0, FALSE);
-        } else {
-            pMDIODev->MDIODev_pPendingFrameListTail->MDIOFrm_pNextFrame = pMDIOCmdFrameListHead;      // Append frame to the tail of the list.
-            pMDIODev->MDIODev_pPendingFrameListTail = pMDIOFrame;                                     
-        }
+    Status = MDIODev_SeqQueueCommand(pMDIODev, pCmd, &StartTransfer);                                 // Queue all the frames of the command or none.
+    if (StartTransfer) {                                                                              // Pending list was empty?
+        KeSetEvent(&pMDIOBus->MDIOBus_StartTransferEvent, 0, FALSE);                                  // Yes, wake up MDIO bus thread.
     }
     NdisReleaseSpinLock(&pMDIODev->MDIODev_DeviceSpinLock);                                           // Release MDIO device spin lock.
+    if (Status != NDIS_STATUS_SUCCESS) {
+        DBG_MDIO_DEV_CMD_PRINT_ERROR_WITH_STATUS("Failed to get free Frame descriptors. Increase MDIO_FRAME_LIST_SIZE constant.");
+    }
     DBG_MDIO_DEV_CMD_METHOD_END_WITH_STATUS(Status);
     return Status;
 }
@@ -38,7 +38,7 @@
 #define MAX_DEVICE_NAME 32
 
 #define MDIO_FRAME_LIST_SIZE        64
-#define MDIO_TransferTimeout_ms      3
+#define MDIO_TransferTimeout_ms      3                                      // Fallback if the MII interrupt is not available (ENET not running).
 #define MDIO_GetPhyIdCmdTimout_ms  500
 
 // MII read/write commands for the external PHY
@@ -112,6 +112,7 @@ typedef struct _MP_MDIO_BUS {
     MP_MDIO_DEVICE*                MDIOBus_pFirstDevice;                            // MDIO device list head.
     MP_MDIO_DEVICE*                MDIOBus_pActiveDevice;                           // MDIO device with active frame.
     BOOLEAN                        MDIOBus_TransferInProgress;
+    BOOLEAN                        MDIOBus_TransferDone;                            // Set by MDIOBus_OnTransferDone() when the MII interrupt has completed the active frame.
     // State machine variables
     KTIMER                         MDIOBus_Timer;                                   // MDIO bus timer.
     KEVENT                         MDIOBus_KillEvent;                               // Event used to stop MDIO bus.
@@ -147,5 +148,7 @@ typedef struct _ENET_PHY_CMD {
 NTSTATUS MDIODev_InitDevice  (_In_ MP_MDIO_DRIVER *pMDIODrv, _In_ MP_MDIO_ENET_PHY_CFG *pEnetPhyConfig, _In_ MP_MDIO_DEVICE *pMDIODev);
 void     MDIODev_DeinitDevice(_In_ MP_MDIO_DEVICE *pMDIODev);
 NTSTATUS MDIODev_QueueCommand(_In_ MP_MDIO_DEVICE *pMDIODev, _In_ PENET_PHY_CMD pCmd);
+_IRQL_requires_(DISPATCH_LEVEL)
+void     MDIOBus_OnTransferDone(_In_ MP_MDIO_BUS *pMDIOBus);
 
 #endif // _MP_MDIO_H
\ No newline at end of file
@@ -0,0 +1,266 @@
+/*
+* Copyright 2018 NXP
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted (subject to the limitations in the disclaimer
+* below) provided that the following conditions are met:
+*
+* * Redistributions of source code must retain the above copyright notice, this
+* list of conditions and the following disclaimer.
+*
+* * Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* * Neither the name of NXP nor the names of its contributors may be used to
+* endorse or promote products derived from this software without specific prior
+* written permission.
+*
+* NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY THIS
+* LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+* THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+* GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+* LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+
+
+#ifndef _MP_MDIO_SEQ_H
+#define _MP_MDIO_SEQ_H
+
+// MDIO sequencer core.
+// Each MDIO device (ENET PHY) has a list of pending MII management frames. The MDIO bus transfers one frame at a time and
+// serves the devices round-robin. MDIOBus_Main() and MDIOBus_OnTransferDone() (mp_mdio.c) and the PHY link update path
+// (mp_enet_phy.c) wrap these helpers with the kernel objects: thread, events, timer and interrupts. The helpers touch
+// only the MDIO/PHY structures and the ENET MMFR, MSCR and EIR registers, so the host test (test/mp_mdio_test.c) runs
+// them against a simulated PHY register file.
+
+// The device frame lists are protected by the device spin lock. The host test replaces the lock with a balance check.
+#ifndef MDIO_SEQ_LOCK_DEVICE
+#define MDIO_SEQ_LOCK_DEVICE(pMDIODev)        NdisAcquireSpinLock(&(pMDIODev)->MDIODev_DeviceSpinLock)
+#define MDIO_SEQ_UNLOCK_DEVICE(pMDIODev)      NdisReleaseSpinLock(&(pMDIODev)->MDIODev_DeviceSpinLock)
+#endif
+
+// Writing MMFR with a non-zero MSCR starts a frame on the bus. The host PHY simulator observes it through this hook,
+// it expands to nothing in the driver.
+#ifndef MDIO_SEQ_FRAME_STARTED
+#define MDIO_SEQ_FRAME_STARTED(pMDIORegs)
+#endif
+
+// EIR flags are write-1-to-clear.
+#ifndef MDIO_SEQ_CLEAR_MII_FLAG
+#define MDIO_SEQ_CLEAR_MII_FLAG(pMDIORegs)    ((pMDIORegs)->EIR.U = ENET_EIR_MII_MASK)
+#endif
+
+// Maximum number of command lists returned by PHYDev_SeqGetLinkCommands().
+#define MDIO_SEQ_LINK_CMD_LISTS_MAX           3
+
+// Puts all the frames of the device to the free frame list.
+FORCEINLINE void MDIODev_SeqInitFrameLists(_Inout_ MP_MDIO_DEVICE *pMDIODev)
+{
+    ULONG i;
+
+    pMDIODev->MDIODev_pPendingFrameListHead = NULL;                                                      // Initialize pending frame list head pointer.
+    pMDIODev->MDIODev_pPendingFrameListTail = NULL;                                                      // Initialize pending frame list tail pointer.
+    pMDIODev->MDIODev_pFreeFrameListHead = &pMDIODev->MDIODev_FrameListArray[0];                         // Initialize free frame list head pointer.
+    for (i = 0; i < MDIO_FRAME_LIST_SIZE - 1; i++) {                                                     // Initialize free frame list.
+        pMDIODev->MDIODev_FrameListArray[i].MDIOFrm_pNextFrame = &pMDIODev->MDIODev_FrameListArray[i + 1];
+    }
+    pMDIODev->MDIODev_FrameListArray[MDIO_FRAME_LIST_SIZE - 1].MDIOFrm_pNextFrame = NULL;                // Initialize the last item of free frame list.
+}
+
+// Appends one frame per command of pCmd (terminated by ENET_MII_END) to the device pending frame list. Either all or none
+// of the frames are queued, so a sequence is never cut short. *pStartTransfer is set to TRUE if the pending list was
+// empty, the bus thread has to be woken up then. Must be called with the device spin lock held.
+FORCEINLINE NTSTATUS MDIODev_SeqQueueCommand(_Inout_ MP_MDIO_DEVICE *pMDIODev, _In_ PENET_PHY_CMD pCmd, _Out_ BOOLEAN *pStartTransfer)
+{
+    MP_MDIO_FRAME* pFirstFrame = pMDIODev->MDIODev_pFreeFrameListHead;
+    MP_MDIO_FRAME* pLastFrame = NULL;
+    MP_MDIO_FRAME* pFrame = pFirstFrame;
+    UINT           i;
+
+    *pStartTransfer = FALSE;
+    for (i = 0; (pCmd + i)->MIIData != ENET_MII_END; i++) {
+        if (pFrame == NULL) {                                                                            // Free frame list too short?
+            return NDIS_STATUS_RESOURCES;                                                                // Yes, leave both lists as they are.
+        }
+        pFrame->MDIOFrm_MMFRRegVal = (pCmd + i)->MIIData | pMDIODev->MDIODev_EnetPhyAddress;             // Fill new item.
+        pFrame->MIIFunction = (pCmd + i)->MIIFunct;
+        pLastFrame = pFrame;
+        pFrame = pFrame->MDIOFrm_pNextFrame;
+    }
+    if (pLastFrame != NULL) {                                                                            // Frame added?
+        pMDIODev->MDIODev_pFreeFrameListHead = pLastFrame->MDIOFrm_pNextFrame;                           // Yes, detach frames from the free frame list.
+        pLastFrame->MDIOFrm_pNextFrame = NULL;
+        if (pMDIODev->MDIODev_pPendingFrameListHead == NULL) {                                           // Pending list empty?
+            pMDIODev->MDIODev_pPendingFrameListHead = pFirstFrame;                                       // Add frame list as the first item.
+            *pStartTransfer = TRUE;
+        } else {
+            pMDIODev->MDIODev_pPendingFrameListTail->MDIOFrm_pNextFrame = pFirstFrame;                   // Append frame to the tail of the list.
+        }
+        pMDIODev->MDIODev_pPendingFrameListTail = pLastFrame;
+    }
+    return NDIS_STATUS_SUCCESS;
+}
+
+// MII interrupt handling. Returns TRUE if the MII interrupt ended the active frame, the bus thread has to be woken up
+// then to complete it. Must be called with the bus spin lock held.
+FORCEINLINE BOOLEAN MDIOBus_SeqOnMiiInterrupt(_Inout_ MP_MDIO_BUS *pMDIOBus)
+{
+    volatile CSP_ENET_REGS* MDIORegs = pMDIOBus->MDIOBus_pRegBase;
+
+    if (pMDIOBus->MDIOBus_TransferInProgress && (MDIORegs->EIR.U & ENET_EIR_MII_MASK)) {                 // Transfer done and not yet handled by the thread?
+        MDIO_SEQ_CLEAR_MII_FLAG(MDIORegs);                                                               // Yes, clear Transfer done flag.
+        pMDIOBus->MDIOBus_TransferDone = TRUE;                                                           // Remember it for MDIOBus_Main().
+        return TRUE;
+    }
+    return FALSE;
+}
+
+// Completes the active frame if the MII interrupt or EIR[MII] (timer fallback) reports its end. The frame is returned to
+// the free frame list and the next device becomes the round-robin candidate. A flag left over while no frame is in
+// progress is cleared without completing anything. Returns the device of the completed frame,
+// or NULL if no frame has been completed. *pFrame receives a copy of the frame, MIIFunction is NULL if no callback is
+// required. The caller invokes the callback with the MMFR value. Must be called with the bus spin lock held.
+FORCEINLINE MP_MDIO_DEVICE* MDIOBus_SeqCompleteTransfer(_Inout_ MP_MDIO_BUS *pMDIOBus, _Out_ MP_MDIO_FRAME *pFrame)
+{
+    volatile CSP_ENET_REGS* MDIORegs = pMDIOBus->MDIOBus_pRegBase;
+    MP_MDIO_DEVICE*         pMDIODev;
+    MP_MDIO_FRAME*          pActiveFrame;
+
+    pFrame->MIIFunction = NULL;
+    if (!pMDIOBus->MDIOBus_TransferDone && !(MDIORegs->EIR.U & ENET_EIR_MII_MASK)) {                     // Transfer done (MII interrupt or timer)?
+        return NULL;
+    }
+    MDIO_SEQ_CLEAR_MII_FLAG(MDIORegs);                                                                   // Yes, clear Transfer done flag.
+    pMDIOBus->MDIOBus_TransferDone = FALSE;
+    if (!pMDIOBus->MDIOBus_TransferInProgress) {                                                         // Stale flag, no frame has been started?
+        return NULL;                                                                                     // Yes, the pending frames have not been sent yet.
+    }
+    if ((pMDIODev = pMDIOBus->MDIOBus_pActiveDevice) == NULL) {                                          // Is there a device waiting for transfer end?
+        return NULL;
+    }
+    MDIO_SEQ_LOCK_DEVICE(pMDIODev);
+    if ((pActiveFrame = pMDIODev->MDIODev_pPendingFrameListHead) != NULL) {                              // Is there a frame waiting for transfer end?
+        pMDIODev->MDIODev_pPendingFrameListHead = pActiveFrame->MDIOFrm_pNextFrame;                      // Update pending frame list head.
+        pActiveFrame->MDIOFrm_pNextFrame = pMDIODev->MDIODev_pFreeFrameListHead;                         // Return frame to the free frame list.
+        pMDIODev->MDIODev_pFreeFrameListHead = pActiveFrame;
+        *pFrame = *pActiveFrame;                                                                         // Create local copy of active frame.
+    }
+    pMDIOBus->MDIOBus_TransferInProgress = FALSE;                                                        // Remember that no transfer is pending now.
+    MDIO_SEQ_UNLOCK_DEVICE(pMDIODev);
+    pMDIOBus->MDIOBus_pActiveDevice = pMDIODev->MDIODev_pNextDevice;                                     // Mark next device in the list as a candidate to send new frame.
+    return pMDIODev;
+}
+
+// Starts the first pending frame of the next device that has one (round-robin from the candidate device), unless a frame
+// is still in progress. The MDIO clock is stopped when there is nothing to transfer. Returns TRUE if a frame is in
+// progress. Must be called with the bus spin lock held.
+FORCEINLINE BOOLEAN MDIOBus_SeqStartTransfer(_Inout_ MP_MDIO_BUS *pMDIOBus)
+{
+    volatile CSP_ENET_REGS* MDIORegs = pMDIOBus->MDIOBus_pRegBase;
+    MP_MDIO_DEVICE*         pMDIODev;
+    MP_MDIO_DEVICE*         pFirstDev;
+
+    if (!pMDIOBus->MDIOBus_TransferInProgress) {                                                         // If no transfer is pending, try to start new transfer.
+        if ((pMDIODev = pMDIOBus->MDIOBus_pActiveDevice) == NULL) {                                      // No device selected for transfer?
+            pMDIODev = pMDIOBus->MDIOBus_pFirstDevice;                                                   // Select first device in the list.
+        }
+        if (pMDIODev) {
+            pFirstDev = pMDIODev;
+            do {
+                MDIO_SEQ_LOCK_DEVICE(pMDIODev);
+                if (pMDIODev->MDIODev_pPendingFrameListHead != NULL) {                                   // Get new frame from pending frame list.
+                    MDIORegs->MMFR.U = pMDIODev->MDIODev_pPendingFrameListHead->MDIOFrm_MMFRRegVal;      // Write frame register.
+                    MDIORegs->MSCR.U = pMDIODev->MDIODev_MSCR.U;                                         // Write speed and control register.
+                    MDIO_SEQ_FRAME_STARTED(MDIORegs);
+                    pMDIOBus->MDIOBus_pActiveDevice = pMDIODev;                                          // Mark current device as active device.
+                    pMDIOBus->MDIOBus_TransferInProgress = TRUE;                                         // Remember that transfer is in progress.
+                    MDIO_SEQ_UNLOCK_DEVICE(pMDIODev);
+                    break;
+                }
+                MDIO_SEQ_UNLOCK_DEVICE(pMDIODev);
+                if ((pMDIODev = pMDIODev->MDIODev_pNextDevice) == NULL) {                                // Current device has no frame ready to sent, select next device.
+                    pMDIODev = pMDIOBus->MDIOBus_pFirstDevice;
+                }
+            } while (pMDIODev != pFirstDev);                                                             // Stop if no device has frame ready to transfer.
+        }
+    }
+    if (!pMDIOBus->MDIOBus_TransferInProgress) {
+        MDIORegs->MSCR.U = 0;                                                                            // Nothing to transfer, stop MDIO clock.
+    }
+    return pMDIOBus->MDIOBus_TransferInProgress;
+}
+
+// Converts the flags of the PHY Status register (offset 0x01) to the unified MP_PHY_STATUS.
+FORCEINLINE void PHYDev_SeqParseStatus(_Inout_ MP_PHY_DEVICE *pPHYDev, _In_ UINT32 RegVal)
+{
+    MP_PHY_STATUS Status;
+
+    Status.U = pPHYDev->PHYDev_PhyStatus.U & ~(MP_PHY_STATUS_LINK_DETECTED_MASK | MP_PHY_STATUS_REMOTE_FAULT_MASK | MP_PHY_STATUS_AN_COMPLETE_MASK);
+    if (RegVal & MII_REG_SR_LINKSTATUS)
+        Status.B.LINK_DETECTED = 1;
+    if (RegVal & MII_REG_SR_REMOTEFAULT)
+        Status.B.REMOTE_FAULT = 1;
+    if (RegVal & MII_REG_SR_AN_COMPLETE)
+        Status.B.AN_COMPLETE = 1;
+    pPHYDev->PHYDev_PhyStatus = Status;
+}
+
+// Starts a link update sequence. Returns the number of command lists written to CmdLists, to be queued in this order:
+// the PHY interrupt acknowledge if the PHY interrupt is pending (it releases the interrupt output before the link state
+// is read), the auto-negotiation result if the link is not reported connected, and pLinkCmd, whose last callback calls
+// PHYDev_SeqParseLink(). Returns 0 if the previous sequence has not ended yet.
+FORCEINLINE ULONG PHYDev_SeqGetLinkCommands(_Inout_ MP_PHY_DEVICE *pPHYDev, _In_ NDIS_MEDIA_CONNECT_STATE ReportedState, _In_ PENET_PHY_CMD pLinkCmd, _Out_writes_(MDIO_SEQ_LINK_CMD_LISTS_MAX) PENET_PHY_CMD *CmdLists)
+{
+    ULONG Count = 0;
+
+    if (!pPHYDev->PHYDev_MIISeqDone || (pPHYDev->PHYDev_PhySettings == NULL)) {
+        return 0;                                                                                        // Previous command to the PHY is not done yet
+    }
+    pPHYDev->PHYDev_MIISeqDone = FALSE;
+    if (InterlockedExchange(&pPHYDev->PHYDev_IntPending, 0) && pPHYDev->PHYDev_PhySettings->PhyIntAck) {
+        CmdLists[Count++] = pPHYDev->PHYDev_PhySettings->PhyIntAck;
+    }
+    if (ReportedState != MediaConnectStateConnected) {
+        CmdLists[Count++] = pPHYDev->PHYDev_PhySettings->PhyActint;
+    }
+    CmdLists[Count++] = pLinkCmd;
+    return Count;
+}
+
+// Ends a link update sequence: updates the PHY media connect state from the status read by PHYDev_SeqParseStatus() and
+// the ENET gigabit mode (ECR[SPEED]). Returns TRUE if the state machine has to run again right away, because the state
+// differs from ReportedState or the PHY interrupt fired during the sequence.
+FORCEINLINE BOOLEAN PHYDev_SeqParseLink(_Inout_ MP_PHY_DEVICE *pPHYDev, _In_ NDIS_MEDIA_CONNECT_STATE ReportedState, _In_ BOOLEAN Gigabit, _Inout_ volatile UINT32 *pECR)
+{
+    if ((pPHYDev->PHYDev_LPApause == PHY_LPA_PAUSE_DETECTED) || (pPHYDev->PHYDev_LPApause == PHY_LPA_PAUSE_NOT_DETECTED)) {
+        // do nothing, 1000BASE-T advertisement is being changed
+    } else {
+        if (pPHYDev->PHYDev_PhyStatus.B.LINK_DETECTED) {
+            pPHYDev->PHYDev_MediaConnectState = MediaConnectStateConnected;
+            if (Gigabit)
+                *pECR |= ENET_ECR_SPEED_MASK;                                                            // Set gigabit speed
+        } else {
+            if ((pPHYDev->PHYDev_LPApause == PHY_LPA_1GB_ON_WAIT) || (pPHYDev->PHYDev_LPApause == PHY_LPA_1GB_OFF_WAIT)) {
+                //
+            } else {
+                pPHYDev->PHYDev_LPApause = PHY_LPA_INIT;
+            }
+            pPHYDev->PHYDev_MediaConnectState = MediaConnectStateDisconnected;
+            *pECR &= ~ENET_ECR_SPEED_MASK;                                                               // Clear gigabit speed mode so we can detect 100Mbps/10mbps links
+        }
+    }
+    pPHYDev->PHYDev_MIISeqDone = TRUE;
+    return (pPHYDev->PHYDev_MediaConnectState != ReportedState) || pPHYDev->PHYDev_IntPending;
+}
+
+#endif // _MP_MDIO_SEQ_H
@@ -59,6 +59,11 @@ NDIS_OID ENETSupportedOids[] = {
     OID_802_3_RCV_OVERRUN,
     OID_802_3_XMIT_UNDERRUN,
     OID_PNP_SET_POWER,                             // Q: ""   S: "O"  RH
+    // IEEE 1588 timer private OIDs
+    OID_IMX_ENET_1588_TIME,
+    OID_IMX_ENET_1588_ADJUST_TIME,
+    OID_IMX_ENET_1588_FREQUENCY,
+    OID_IMX_ENET_1588_TIMESTAMPS,
 };
 
 ULONG ENETSupportedOidsSize = sizeof(ENETSupportedOids);
@@ -390,17 +395,17 @@ NDIS_STATUS MpQueryInformation(NDIS_HANDLE MiniportAdapterContext, PNDIS_OID_REQ
             // Specifies the minimum number of bytes that a single net packet occupies in the transmit buffer space of the NIC.
         case OID_GEN_RECEIVE_BLOCK_SIZE:
             // Specifies the amount of storage, in bytes, that a single packet occupies in the receive buffer space of the NIC.
-            ulInfo = (ULONG) ETHER_FRAME_MAX_LENGTH - ETHER_FRAME_CRC_LENGTH;
+            ulInfo = pAdapter->JumboPacket;
             break;
 
         case OID_GEN_TRANSMIT_BUFFER_SPACE:
             // Specifies the amount of memory, in bytes, on the NIC that is available for buffering transmit data.
-            ulInfo = ETHER_FRAME_MAX_LENGTH * pAdapter->Tx_DmaBDT_ItemCount;
+            ulInfo = (pAdapter->JumboPacket + ETHER_FRAME_CRC_LENGTH) * pAdapter->Tx_DmaBDT_ItemCount;
             break;
 
         case OID_GEN_RECEIVE_BUFFER_SPACE:
             // Specifies the amount of memory on the NIC that is available for buffering receive data.
-            ulInfo = ETHER_FRAME_MAX_LENGTH * pAdapter->Rx_DmaBDT_ItemCount;
+            ulInfo = (pAdapter->JumboPacket + ETHER_FRAME_CRC_LENGTH) * pAdapter->Rx_DmaBDT_ItemCount;
             break;
 
         case OID_GEN_VENDOR_ID:
@@ -479,6 +484,28 @@ NDIS_STATUS MpQueryInformation(NDIS_HANDLE MiniportAdapterContext, PNDIS_OID_REQ
             ulBytesAvailable = sizeof(ndisIntModParams);
             break;
 
+        case OID_IMX_ENET_1588_TIME:
+            // IEEE 1588 timer value in nanoseconds.
+            ul64Info = Enet1588GetTime(pAdapter);
+            pInfo = &ul64Info;
+            ulBytesAvailable = ulInfoLen = sizeof(ul64Info);
+            break;
+
+        case OID_IMX_ENET_1588_FREQUENCY:
+            // IEEE 1588 timer frequency adjustment in parts per billion.
+            ulInfo = (ULONG)pAdapter->Enet1588Timer.FreqAdjPpb;
+            break;
+
+        case OID_IMX_ENET_1588_TIMESTAMPS:
+            // Timestamps of the transmitted and received PTP event messages, written directly to InformationBuffer.
+            DoCopy = FALSE;
+            ulBytesAvailable = ulInfoLen = FIELD_OFFSET(ENET_1588_TIMESTAMPS, Records);
+            if (InformationBufferLength < ulInfoLen) {
+                break;
+            }
+            ulInfoLen = Enet1588ReadTimestamps(pAdapter, (PENET_1588_TIMESTAMPS)InformationBuffer, InformationBufferLength, &ulBytesAvailable);
+            break;
+
         default:
             Status = NDIS_STATUS_NOT_SUPPORTED;
             DBG_ENET_DEV_OIDS_PRINT_INFO("%s not supported", Dbg_GetNdisOidName(Oid));
@@ -581,7 +608,7 @@ NDIS_STATUS MpSetInformation(NDIS_HANDLE MiniportAdapterContext, PNDIS_OID_REQUE
                 Status = NDIS_STATUS_INVALID_LENGTH;
                 break;
             }
-            if (*(UNALIGNED PULONG)InformationBuffer > ETHER_FRAME_MAX_PAYLOAD_LENGTH) {
+            if (*(UNALIGNED PULONG)InformationBuffer > pAdapter->JumboPacket - ETHER_FRAME_HEADER_LENGTH) {
                 Status = NDIS_STATUS_INVALID_DATA;
                 break;
             }
@@ -600,6 +627,36 @@ NDIS_STATUS MpSetInformation(NDIS_HANDLE MiniportAdapterContext, PNDIS_OID_REQUE
               BytesRead = sizeof(NDIS_DEVICE_POWER_STATE);
           }
           break;
+
+        case OID_IMX_ENET_1588_TIME:
+            if (InformationBufferLength < sizeof(ULONG64)) {  // Verify the Length
+                BytesNeeded = sizeof(ULONG64);
+                Status = NDIS_STATUS_INVALID_LENGTH;
+                break;
+            }
+            Enet1588SetTime(pAdapter, *(UNALIGNED PULONG64)InformationBuffer);
+            BytesRead = sizeof(ULONG64);
+            break;
+
+        case OID_IMX_ENET_1588_ADJUST_TIME:
+            if (InformationBufferLength < sizeof(LONG64)) {  // Verify the Length
+                BytesNeeded = sizeof(LONG64);
+                Status = NDIS_STATUS_INVALID_LENGTH;
+                break;
+            }
+            Status = Enet1588AdjustTime(pAdapter, *(UNALIGNED PLONG64)InformationBuffer);
+            BytesRead = sizeof(LONG64);
+            break;
+
+        case OID_IMX_ENET_1588_FREQUENCY:
+            if (InformationBufferLength < sizeof(LONG)) {  // Verify the Length
+                BytesNeeded = sizeof(LONG);
+                Status = NDIS_STATUS_INVALID_LENGTH;
+                break;
+            }
+            Status = Enet1588AdjustFrequency(pAdapter, *(UNALIGNED PLONG)InformationBuffer);
+            BytesRead = sizeof(LONG);
+            break;
         default:
             Status = NDIS_STATUS_NOT_SUPPORTED;
             DBG_ENET_DEV_OIDS_PRINT_INFO("%s not supported", Dbg_GetNdisOidName(Oid));
@@ -164,6 +164,9 @@ void MpOnRunningStateHandler(_In_ PMP_ADAPTER pAdapter, _In_ MP_STATE PreviousSt
     if (pAdapter->MediaConnectState != MediaConnectStateConnected) {
         NextDelayMsec = MP_SM_CABLE_CONNECTED_CHECK_PERIOD_MSEC;
     }
+    if (pAdapter->ENETDev_PHYDevice.PHYDev_pInterrupt != NULL) {                            // Link changes are reported by the PHY interrupt,
+        NextDelayMsec = MP_SM_PHY_INT_CHECK_PERIOD_MSEC;                                    // poll only as a fallback.
+    }
     (void)SmSetState(pAdapter, SM_STATE_RUNNING, NextDelayMsec, SM_CALLED_BY_DISPATCHER);  // Set next state
     DBG_SM_METHOD_END();
 }
@@ -457,3 +460,48 @@ BOOLEAN SmIsAdapterRunning(PMP_ADAPTER pAdapter)
     NdisReleaseSpinLock(&pAdapter->Dev_SpinLock);
     return isRunning;
 }
+
+/*++
+Routine Description:
+    Requests an immediate link status update. The RUNNING state handler is run as soon as possible instead of at the next check period.
+    Called from the ENET PHY ISR and from MDIO callbacks, the request is forwarded to MpSmLinkUpdateDpc.
+Arguments:
+    pAdapter    Pointer to adapter data
+Return Value:
+    None
+--*/
+_Use_decl_annotations_
+void SmRequestLinkUpdate(PMP_ADAPTER pAdapter)
+{
+    (void)KeInsertQueueDpc(&pAdapter->StateMachine.SM_LinkUpdateDpc, NULL, NULL);
+}
+
+/*++
+Routine Description:
+    Link update request DPC. Restarts the state machine timer with no delay if the state machine is in the RUNNING state
+    and no other state change is pending, so that the PHY link status is read (or its result is applied) right away.
+Arguments:
+    Dpc                 Not used
+    DeferredContext     Pointer to our adapter
+    SystemArgument1     Not used
+    SystemArgument2     Not used
+Return Value:
+    None
+--*/
+_Use_decl_annotations_
+VOID MpSmLinkUpdateDpc(struct _KDPC *Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2)
+{
+    PMP_ADAPTER       pAdapter = (PMP_ADAPTER)DeferredContext;
+    PMP_STATE_MACHINE pSM      = &pAdapter->StateMachine;
+    LARGE_INTEGER     delayPeriod100nSec = { .QuadPart = -1 };
+
+    UNREFERENCED_PARAMETER(Dpc);
+    UNREFERENCED_PARAMETER(SystemArgument1);
+    UNREFERENCED_PARAMETER(SystemArgument2);
+    NdisDprAcquireSpinLock(&pSM->SM_SpinLock);
+    if ((pSM->SM_CurrentState == SM_STATE_RUNNING) && (pSM->SM_NextState == SM_STATE_RUNNING)) {
+        DBG_SM_PRINT_TRACE("Link update requested");
+        (void)NdisSetTimerObject(pSM->SM_hTimer, delayPeriod100nSec, 0, pAdapter);
+    }
+    NdisDprReleaseSpinLock(&pSM->SM_SpinLock);
+}
@@ -40,8 +40,12 @@
 #include "enet_iomap.h"
 #include "mp_mdio.h"
 #include "mp_enet_phy.h"
+#include "mp_mdio_seq.h"
 #include "mp_hw.h"
+#include "mp_1588_util.h"
+#include "mp_1588.h"
 #include "mp.h"
+#include "mp_bd_ring.h"
 #include "mp_data_path.h"
 #include "mp_dbg.h"
 #include "mp_acpi.h"
@@ -0,0 +1,321 @@
+/*
+* Copyright 2018 NXP
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted (subject to the limitations in the disclaimer
+* below) provided that the following conditions are met:
+*
+* * Redistributions of source code must retain the above copyright notice, this
+* list of conditions and the following disclaimer.
+*
+* * Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* * Neither the name of NXP nor the names of its contributors may be used to
+* endorse or promote products derived from this software without specific prior
+* written permission.
+*
+* NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY THIS
+* LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+* THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+* GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+* LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+
+
+// Host test of the IEEE 1588 helpers in mp_1588_util.h.
+//
+// A model of the ENET adjustable timer runs from a drifting oscillator: ATVR advances by ATINC[INC] on each timer
+// clock and by ATINC[INC_CORR] on every (ATCOR + 1)th clock, the same reading of ATCOR as Enet1588AdjustFrequency().
+// The tests check the frequency correction against the model, the extension of the nanoseconds captured in the
+// buffer descriptors around the ATVR wrap, and that a PI servo fed with extended Sync timestamps locks the drifting
+// timer to a master clock through Enet1588ComputeCorrection(). The PTP event message parser is checked on the
+// transports the driver recognizes.
+//
+// Build and run from the repository root:
+//
+//   cc -std=c11 -Wall -I driver/shared/hosttest -I driver/net/ndis/imxnetmini
+//      driver/net/ndis/imxnetmini/test/mp_1588_test.c -o mp_1588_test -lm
+//   ./mp_1588_test
+
+#include "hosttest.h"
+#include <math.h>
+#include "mp_1588_util.h"
+
+/*
+ * ENET adjustable timer model
+ */
+typedef struct _SIM_TIMER {
+    double      DriftPpb;           // Oscillator error
+    double      ClockPhase;         // Fraction of a timer clock not elapsed yet
+    ULONG64     CorrPhase;          // Correction counter
+    ULONG       IncCorr;            // ATINC[INC_CORR]
+    ULONG       Atcor;              // ATCOR
+    ULONG64     Time;               // Seconds counter * 10^9 + ATVR [ns]
+} SIM_TIMER;
+
+static void SimTimerInit(SIM_TIMER *pTimer, double DriftPpb, ULONG64 Time)
+{
+    memset(pTimer, 0, sizeof(*pTimer));
+    pTimer->DriftPpb = DriftPpb;
+    pTimer->IncCorr  = ENET_1588_INC_NS;
+    pTimer->Time     = Time;
+}
+
+static void SimTimerAdjustFrequency(SIM_TIMER *pTimer, LONG Ppb)
+{
+    Enet1588ComputeCorrection(Ppb, &pTimer->IncCorr, &pTimer->Atcor);
+}
+
+// Advances the timer by Ns nanoseconds of true time.
+static void SimTimerRun(SIM_TIMER *pTimer, double Ns)
+{
+    double   Clocks = Ns * (ENET_1588_CLOCK_HZ / 1e9) * (1.0 + pTimer->DriftPpb * 1e-9) + pTimer->ClockPhase;
+    ULONG64  Count = (ULONG64)Clocks;
+
+    pTimer->ClockPhase = Clocks - (double)Count;
+    pTimer->Time += Count * ENET_1588_INC_NS;
+    if (pTimer->Atcor != 0) {
+        ULONG64  Corrections = (pTimer->CorrPhase + Count) / (pTimer->Atcor + 1);
+
+        pTimer->CorrPhase = (pTimer->CorrPhase + Count) % (pTimer->Atcor + 1);
+        pTimer->Time += Corrections * pTimer->IncCorr - Corrections * ENET_1588_INC_NS;
+    }
+}
+
+// Frequency offset applied by the correction [ppb].
+static double SimCorrectionPpb(ULONG IncCorr, ULONG Atcor)
+{
+    if (Atcor == 0) {
+        return 0.0;
+    }
+    return ((double)IncCorr - ENET_1588_INC_NS) * 1e9 / ((double)(Atcor + 1) * ENET_1588_INC_NS);
+}
+
+/*
+ * Tests
+ */
+static void TestCorrectionAccuracy(void)
+{
+    static const LONG Ppbs[] = { 1, 7, 100, 1000, 12345, 37000, 100000, 999999, 10000000, 123456789, ENET_1588_MAX_ADJ_PPB };
+
+    for (ULONG i = 0; i < ARRAYSIZE(Ppbs); ++i) {
+        for (LONG Sign = -1; Sign <= 1; Sign += 2) {
+            LONG   Ppb = Sign * Ppbs[i];
+            ULONG  IncCorr;
+            ULONG  Atcor;
+            double Applied;
+            double RelError;
+
+            Enet1588ComputeCorrection(Ppb, &IncCorr, &Atcor);
+            HOSTTEST_CHECK(Atcor >= 1);                                // ATCOR = 0 would disable the correction
+            HOSTTEST_CHECK((IncCorr >= 1) && (IncCorr < 2 * ENET_1588_INC_NS));
+            Applied  = SimCorrectionPpb(IncCorr, Atcor);
+            RelError = fabs(Applied - Ppb) / fabs((double)Ppb);
+            if (Ppbs[i] <= 10000000) {
+                HOSTTEST_CHECK(RelError < 1e-5);
+            } else {
+                HOSTTEST_CHECK(RelError < 5e-2);                       // Correction every few clocks, coarse steps
+            }
+        }
+    }
+
+    ULONG IncCorr;
+    ULONG Atcor;
+
+    Enet1588ComputeCorrection(0, &IncCorr, &Atcor);
+    HOSTTEST_CHECK_EQ(IncCorr, ENET_1588_INC_NS);
+    HOSTTEST_CHECK_EQ(Atcor, 0);
+}
+
+// The correction measured on the timer model over 10 s matches the requested frequency.
+static void TestCorrectionOnModel(void)
+{
+    static const LONG Ppbs[] = { -ENET_1588_MAX_ADJ_PPB, -2000000, -50000, -1000, 500, 40000, 2000000, ENET_1588_MAX_ADJ_PPB };
+
+    for (ULONG i = 0; i < ARRAYSIZE(Ppbs); ++i) {
+        SIM_TIMER Timer;
+        double    Measured;
+
+        SimTimerInit(&Timer, 0.0, 0);
+        SimTimerAdjustFrequency(&Timer, Ppbs[i]);
+        for (ULONG Step = 0; Step < 1000; ++Step) {
+            SimTimerRun(&Timer, 1e7);
+        }
+        Measured = ((double)Timer.Time - 1e10) / 10.0;                   // ns per second = ppb
+        HOSTTEST_CHECK(fabs(Measured - Ppbs[i]) < 2.0);
+    }
+}
+
+static void TestExtendTimestamp(void)
+{
+    static const LONG Deltas[] = { 0, 1, -1, 8, -8, 1000000, -1000000, 499999999, -499999999 };
+    static const ULONG64 Nows[] = {
+        5ULL * ENET_1588_NSEC_PER_SEC,                                  // Just after a wrap
+        5ULL * ENET_1588_NSEC_PER_SEC - 1,                              // Just before a wrap
+        5ULL * ENET_1588_NSEC_PER_SEC + ENET_1588_NSEC_PER_SEC / 2,
+        123456789012345ULL,
+    };
+
+    for (ULONG n = 0; n < ARRAYSIZE(Nows); ++n) {
+        for (ULONG d = 0; d < ARRAYSIZE(Deltas); ++d) {
+            ULONG64 Time = Nows[n] + Deltas[d];                        // Frame timestamped Delta before or after Now
+
+            HOSTTEST_CHECK_EQ(Enet1588ExtendTimestamp(Nows[n], (ULONG)(Time % ENET_1588_NSEC_PER_SEC)), Time);
+        }
+    }
+    HOSTTEST_CHECK_EQ(Enet1588ExtendTimestamp(1000, ENET_1588_NSEC_PER_SEC - 1000), ENET_1588_NSEC_PER_SEC - 1000);  // No seconds to borrow from
+}
+
+// A drifting slave timer is locked to a master clock with one Sync message per second, the way a PTP servo drives
+// the driver: BD timestamps extended against a later timer read, a step for large offsets, a PI loop on the frequency.
+static void TestServoLocksDriftingTimer(void)
+{
+    static const double Drifts[] = { 37000.0, -85000.0, 3.5, 100000.0 };
+
+    for (ULONG i = 0; i < ARRAYSIZE(Drifts); ++i) {
+        SIM_TIMER Timer;
+        ULONG64   Master = 1000ULL * ENET_1588_NSEC_PER_SEC;           // Master time of the first Sync
+        double    Integral = 0.0;
+        LONG64    Offset = 0;
+        LONG      Ppb = 0;
+
+        SimTimerInit(&Timer, Drifts[i], Master + 2500000);              // 2.5 ms off
+        for (ULONG Sync = 0; Sync < 120; ++Sync) {
+            ULONG   BdTimestamp = (ULONG)(Timer.Time % ENET_1588_NSEC_PER_SEC);    // Captured by ENET into the Rx BD
+            ULONG64 Received;
+
+            SimTimerRun(&Timer, 3e6);                                    // EnetDpc runs 3 ms later
+            Received = Enet1588ExtendTimestamp(Timer.Time, BdTimestamp);
+            Offset = (LONG64)(Received - Master);
+            if ((Offset > 1000000) || (Offset < -1000000)) {
+                Timer.Time -= Offset;                                    // OID_IMX_ENET_1588_ADJUST_TIME
+                Integral = 0.0;
+            } else {
+                double Adj = -(0.7 * (double)Offset + 0.3 * (Integral += (double)Offset));
+
+                Ppb = (LONG)fmax(-ENET_1588_MAX_ADJ_PPB, fmin(ENET_1588_MAX_ADJ_PPB, Adj));
+                SimTimerAdjustFrequency(&Timer, Ppb);                    // OID_IMX_ENET_1588_FREQUENCY
+            }
+            SimTimerRun(&Timer, 1e9 - 3e6);
+            Master += ENET_1588_NSEC_PER_SEC;
+        }
+        HOSTTEST_CHECK((Offset > -50) && (Offset < 50));
+        HOSTTEST_CHECK(fabs(Ppb + Drifts[i]) < fmax(20.0, fabs(Drifts[i]) * 1e-3));
+    }
+}
+
+/*
+ * PTP event message parser
+ */
+static ULONG BuildPtpFrame(UCHAR *pFrame, USHORT EtherType, BOOLEAN Vlan, UCHAR MessageType, UCHAR Version, USHORT UdpPort)
+{
+    ULONG  Offset = 12;
+    UCHAR *pPtp;
+
+    memset(pFrame, 0, 256);
+    if (Vlan) {
+        pFrame[Offset++] = 0x81;
+        pFrame[Offset++] = 0x00;
+        pFrame[Offset++] = 0x00;
+        pFrame[Offset++] = 0x05;
+    }
+    pFrame[Offset++] = (UCHAR)(EtherType >> 8);
+    pFrame[Offset++] = (UCHAR)EtherType;
+    if (EtherType == 0x0800) {
+        pFrame[Offset + 0] = 0x46;                                       // IPv4 with 4 bytes of options
+        pFrame[Offset + 9] = 17;
+        Offset += 24;
+    } else if (EtherType == 0x86DD) {
+        pFrame[Offset + 0] = 0x60;
+        pFrame[Offset + 6] = 17;
+        Offset += 40;
+    }
+    if (EtherType != ENET_1588_PTP_ETHERTYPE) {
+        pFrame[Offset + 2] = (UCHAR)(UdpPort >> 8);
+        pFrame[Offset + 3] = (UCHAR)UdpPort;
+        Offset += 8;
+    }
+    pPtp = &pFrame[Offset];
+    pPtp[0] = 0x10 | MessageType;                                        // transportSpecific 1
+    pPtp[1] = Version;
+    pPtp[4] = 24;                                                        // domainNumber
+    for (ULONG i = 0; i < 10; ++i) {
+        pPtp[20 + i] = (UCHAR)(0xA0 + i);
+    }
+    pPtp[30] = 0x12;
+    pPtp[31] = 0x34;
+    return Offset + 44;
+}
+
+static void TestParsePtpEvent(void)
+{
+    UCHAR            Frame[256];
+    ENET_1588_PTP_ID PtpId;
+    ULONG            Length;
+
+    Length = BuildPtpFrame(Frame, ENET_1588_PTP_ETHERTYPE, FALSE, 0x0, 2, 0);   // Sync over IEEE 802.3
+    HOSTTEST_CHECK(Enet1588ParsePtpEvent(Frame, Length, &PtpId));
+    HOSTTEST_CHECK_EQ(PtpId.MessageType, 0x0);
+    HOSTTEST_CHECK_EQ(PtpId.DomainNumber, 24);
+    HOSTTEST_CHECK_EQ(PtpId.SequenceId, 0x1234);
+    HOSTTEST_CHECK_EQ(PtpId.SourcePortIdentity[0], 0xA0);
+    HOSTTEST_CHECK_EQ(PtpId.SourcePortIdentity[9], 0xA9);
+
+    Length = BuildPtpFrame(Frame, ENET_1588_PTP_ETHERTYPE, TRUE, 0x3, 2, 0);    // Pdelay_Resp, VLAN tagged
+    HOSTTEST_CHECK(Enet1588ParsePtpEvent(Frame, Length, &PtpId));
+    HOSTTEST_CHECK_EQ(PtpId.MessageType, 0x3);
+
+    Length = BuildPtpFrame(Frame, 0x0800, FALSE, 0x1, 2, ENET_1588_PTP_EVENT_PORT);   // Delay_Req over UDP/IPv4
+    HOSTTEST_CHECK(Enet1588ParsePtpEvent(Frame, Length, &PtpId));
+    HOSTTEST_CHECK_EQ(PtpId.MessageType, 0x1);
+    HOSTTEST_CHECK_EQ(PtpId.SequenceId, 0x1234);
+
+    Length = BuildPtpFrame(Frame, 0x86DD, TRUE, 0x2, 2, ENET_1588_PTP_EVENT_PORT);    // Pdelay_Req over UDP/IPv6
+    HOSTTEST_CHECK(Enet1588ParsePtpEvent(Frame, Length, &PtpId));
+    HOSTTEST_CHECK_EQ(PtpId.MessageType, 0x2);
+
+    // Not timestamped: general messages, the general port, PTPv1, fragments, other protocols and truncated frames
+    Length = BuildPtpFrame(Frame, ENET_1588_PTP_ETHERTYPE, FALSE, 0x8, 2, 0);   // Follow_Up
+    HOSTTEST_CHECK(!Enet1588ParsePtpEvent(Frame, Length, &PtpId));
+    Length = BuildPtpFrame(Frame, 0x0800, FALSE, 0x0, 2, 320);
+    HOSTTEST_CHECK(!Enet1588ParsePtpEvent(Frame, Length, &PtpId));
+    Length = BuildPtpFrame(Frame, ENET_1588_PTP_ETHERTYPE, FALSE, 0x0, 1, 0);
+    HOSTTEST_CHECK(!Enet1588ParsePtpEvent(Frame, Length, &PtpId));
+    Length = BuildPtpFrame(Frame, 0x0800, FALSE, 0x0, 2, ENET_1588_PTP_EVENT_PORT);
+    Frame[14 + 7] = 0x10;                                                // Fragment offset != 0
+    HOSTTEST_CHECK(!Enet1588ParsePtpEvent(Frame, Length, &PtpId));
+    Frame[14 + 7] = 0x00;
+    Frame[14 + 9] = 6;                                                   // TCP
+    HOSTTEST_CHECK(!Enet1588ParsePtpEvent(Frame, Length, &PtpId));
+    Length = BuildPtpFrame(Frame, 0x0806, FALSE, 0x0, 2, 0);             // ARP
+    HOSTTEST_CHECK(!Enet1588ParsePtpEvent(Frame, Length, &PtpId));
+    Length = BuildPtpFrame(Frame, ENET_1588_PTP_ETHERTYPE, FALSE, 0x0, 2, 0);
+    HOSTTEST_CHECK(!Enet1588ParsePtpEvent(Frame, 14 + ENET_1588_PTP_HEADER_LENGTH - 1, &PtpId));
+    HOSTTEST_CHECK(!Enet1588ParsePtpEvent(Frame, 13, &PtpId));
+    Length = BuildPtpFrame(Frame, 0x0800, FALSE, 0x0, 2, ENET_1588_PTP_EVENT_PORT);
+    for (ULONG Cut = 0; Cut < Length - 10; ++Cut) {                      // Every truncation within the headers
+        HOSTTEST_CHECK(!Enet1588ParsePtpEvent(Frame, Cut, &PtpId));
+    }
+    HOSTTEST_CHECK(Enet1588ParsePtpEvent(Frame, Length - 10, &PtpId));
+}
+
+int main(void)
+{
+    HOSTTEST_RUN(TestCorrectionAccuracy);
+    HOSTTEST_RUN(TestCorrectionOnModel);
+    HOSTTEST_RUN(TestExtendTimestamp);
+    HOSTTEST_RUN(TestServoLocksDriftingTimer);
+    HOSTTEST_RUN(TestParsePtpEvent);
+    return HostTestExit();
+}
@@ -0,0 +1,680 @@
+/*
+* Copyright 2018 NXP
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted (subject to the limitations in the disclaimer
+* below) provided that the following conditions are met:
+*
+* * Redistributions of source code must retain the above copyright notice, this
+* list of conditions and the following disclaimer.
+*
+* * Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* * Neither the name of NXP nor the names of its contributors may be used to
+* endorse or promote products derived from this software without specific prior
+* written permission.
+*
+* NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY THIS
+* LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+* THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+* GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+* LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+// Host test of the ENET BD ring primitives in mp_bd_ring.h.
+//
+// A model of the ENET uDMA runs against the ring primitives and ring walks, driven through the same calls the data path
+// in mp_data_path.c makes (MpTxFillEnetTxBD, MpHandleTxInterrupt, MpRxQueueReturnNetBufferLists, MpHandleRecvInterrupt),
+// only the per-BD bookkeeping of the callbacks is the test's own. The model
+// follows the R/E ownership bits and the W bit rather than the ring size, only (re)starts on a TDARn/RDARn write,
+// raises TXF/RXF for BDs with the INT bit, and checks that the driver never changes a BD it has passed to the DMA.
+// It can also model ERR006358 (TDAR cleared while BDs are still ready).
+//
+// Build and run from the repository root:
+//
+//   cc -std=c11 -O2 -Wall -I driver/shared/hosttest -I driver/net/ndis/imxnetmini
+//      driver/net/ndis/imxnetmini/test/mp_bd_ring_test.c -o mp_bd_ring_test
+//   ./mp_bd_ring_test
+//
+// "./mp_bd_ring_test bench" also runs a pktgen-style benchmark that reports ns/packet and the average and peak number of
+// BDs owned by the DMA for several frame sizes. The DMA model runs on the same CPU as the driver side, so the numbers
+// compare ring handling between builds on one machine, they are not a line rate.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "hosttest.h"
+#include <time.h>
+
+static void SimDarWritten(volatile UINT32 *pDAR);
+#define ENET_BD_RING_DAR_WRITTEN(pDAR) SimDarWritten(pDAR)
+static void SimBdPassed(volatile void *pBD);
+#define ENET_BD_RING_BD_PASSED(pBD) SimBdPassed(pBD)
+
+#include "enet_iomap.h"
+#include "mp_bd_ring.h"
+
+#define SIM_RING_SIZE_MAX        256
+#define SIM_RX_BUFFER_SIZE       1536                       // MRBR
+#define SIM_FRAME_SIZE_MAX       (3 * SIM_RX_BUFFER_SIZE)   // Jumbo frames span several Rx BDs
+#define SIM_BUFFER_PA_BASE       0x10000000                 // "Physical" address of the first buffer
+#define SIM_DAR_ACTIVE           0x01000000                 // TDAR/RDAR value while the DMA processes the ring
+
+/*
+ * ENET uDMA model of one ring
+ */
+typedef struct _SIM_DMA {
+    ENET_BD             DmaBDT[SIM_RING_SIZE_MAX];
+    ENET_BD             Handed[SIM_RING_SIZE_MAX];      // BD contents when the driver passed the BD to the DMA
+    LONG                ItemCount;
+    volatile UINT32     DAR;                            // TDARn/RDARn
+    LONG                DmaIdx;                         // BD the DMA processes next, follows the W bits
+    BOOLEAN             Kicked;
+    BOOLEAN             Err006358;                      // Clear DAR after each frame even if more BDs are ready
+    ULONG               InterruptCount;                 // TXF/RXF
+    ULONG               FrameCount;
+    ULONG               DropCount;
+    ULONG               WrapErrors;                     // W bit missing on the last BD or set on another one
+    ULONG               OwnershipErrors;                // BD changed by the driver while owned by the DMA
+    ULONG               Timestamp;
+    LONG                FilledBDs;                      // Rx: BDs filled and not yet processed by the driver
+    UCHAR               Buffers[SIM_RING_SIZE_MAX][SIM_FRAME_SIZE_MAX];
+} SIM_DMA;
+
+static SIM_DMA TxDma;
+static SIM_DMA RxDma;
+static UCHAR   Wire[SIM_FRAME_SIZE_MAX];
+
+static void SimRxSampleOccupancy(void);
+
+static ULONG SimBufferPa(LONG Idx)
+{
+    return SIM_BUFFER_PA_BASE + (ULONG)Idx * SIM_FRAME_SIZE_MAX;
+}
+
+static UCHAR *SimBufferVa(SIM_DMA *pDma, ULONG BufferAddress)
+{
+    ULONG Idx = (BufferAddress - SIM_BUFFER_PA_BASE) / SIM_FRAME_SIZE_MAX;
+
+    NT_ASSERT(Idx < SIM_RING_SIZE_MAX);
+    return pDma->Buffers[Idx];
+}
+
+static void SimDarWritten(volatile UINT32 *pDAR)
+{
+    SIM_DMA *pDma = (pDAR == &TxDma.DAR) ? &TxDma : &RxDma;
+
+    pDma->Kicked = TRUE;
+    pDma->DAR    = SIM_DAR_ACTIVE;
+}
+
+static void SimDmaInit(SIM_DMA *pDma, LONG ItemCount)
+{
+    NT_ASSERT(ItemCount <= SIM_RING_SIZE_MAX);
+    memset(pDma->DmaBDT, 0, sizeof(pDma->DmaBDT));
+    memset(pDma->Handed, 0, sizeof(pDma->Handed));
+    pDma->ItemCount       = ItemCount;
+    pDma->DAR             = 0;
+    pDma->DmaIdx          = 0;
+    pDma->Kicked          = FALSE;
+    pDma->Err006358       = FALSE;
+    pDma->InterruptCount  = 0;
+    pDma->FrameCount      = 0;
+    pDma->DropCount       = 0;
+    pDma->WrapErrors      = 0;
+    pDma->OwnershipErrors = 0;
+    pDma->Timestamp       = 0;
+    pDma->FilledBDs       = 0;
+}
+
+// Checks the BD the DMA is about to consume against the copy taken when the driver handed it over.
+static void SimDmaCheckBD(SIM_DMA *pDma, LONG Idx, USHORT WrapMask)
+{
+    ENET_BD *pBD     = &pDma->DmaBDT[Idx];
+    BOOLEAN  Wrap    = (pBD->ControlStatus & WrapMask) != 0;
+
+    if (Wrap != (Idx == pDma->ItemCount - 1)) {
+        pDma->WrapErrors++;
+    }
+    if (memcmp(pBD, &pDma->Handed[Idx], FIELD_OFFSET(ENET_BD, PayloadChecksum)) != 0) {
+        pDma->OwnershipErrors++;
+    }
+}
+
+// Records the BD as handed to the DMA, called by the ring primitives right after they set R or E.
+static void SimBdPassed(volatile void *pBD)
+{
+    ENET_BD *pDmaBD = (ENET_BD *)pBD;
+    SIM_DMA *pDma   = ((pDmaBD >= TxDma.DmaBDT) && (pDmaBD < TxDma.DmaBDT + SIM_RING_SIZE_MAX)) ? &TxDma : &RxDma;
+
+    pDma->Handed[pDmaBD - pDma->DmaBDT] = *pDmaBD;
+}
+
+static LONG SimDmaAdvance(SIM_DMA *pDma, LONG Idx, USHORT WrapMask)
+{
+    return (pDma->DmaBDT[Idx].ControlStatus & WrapMask) ? 0 : Idx + 1;
+}
+
+// Transmits up to Budget frames. Returns the number of frames transmitted.
+static ULONG SimTxDmaRun(ULONG Budget)
+{
+    SIM_DMA *pDma  = &TxDma;
+    ULONG    Count = 0;
+
+    while ((Count < Budget) && (pDma->DAR != 0)) {
+        LONG     Idx = pDma->DmaIdx;
+        ENET_BD *pBD = &pDma->DmaBDT[Idx];
+
+        if ((pBD->ControlStatus & ENET_TX_BD_R_MASK) == 0) {        // No more ready BDs
+            pDma->DAR = 0;
+            break;
+        }
+        SimDmaCheckBD(pDma, Idx, ENET_TX_BD_W_MASK);
+        memcpy(Wire, SimBufferVa(pDma, pBD->BufferAddress), pBD->DataLen);
+        if (pBD->ExtControlStatus & ENET_TX_BD_TS_MASK) {
+            pBD->Timestamp = pDma->Timestamp;
+        }
+        pDma->Timestamp += 1000;
+        pBD->Bdu = ENET_RX_BD_BDU_MASK;
+        pBD->ControlStatus &= (USHORT)~ENET_TX_BD_R_MASK;          // Pass the BD back to the driver
+        if (pBD->ExtControlStatus & ENET_TX_BD_INT_MASK) {
+            pDma->InterruptCount++;
+        }
+        pDma->DmaIdx = SimDmaAdvance(pDma, Idx, ENET_TX_BD_W_MASK);
+        pDma->FrameCount++;
+        Count++;
+        if (pDma->Err006358) {
+            pDma->DAR = 0;
+        }
+    }
+    return Count;
+}
+
+// Receives a frame of FrameLength bytes. Returns FALSE if it has been dropped for lack of empty BDs.
+static BOOLEAN SimRxDmaReceive(ULONG FrameLength, UCHAR Pattern)
+{
+    SIM_DMA *pDma      = &RxDma;
+    LONG     BDCount   = (LONG)((FrameLength + SIM_RX_BUFFER_SIZE - 1) / SIM_RX_BUFFER_SIZE);
+    LONG     Idx       = pDma->DmaIdx;
+    ULONG    Remaining = FrameLength;
+
+    SimRxSampleOccupancy();
+    if (pDma->DAR == 0) {
+        pDma->DropCount++;
+        return FALSE;
+    }
+    for (LONG i = 0; i < BDCount; ++i) {                             // The whole frame must fit into empty BDs
+        if ((pDma->DmaBDT[Idx].ControlStatus & ENET_RX_BD_E_MASK) == 0) {
+            pDma->DAR = 0;                                           // uDMA stops on a BD that is not empty
+            pDma->DropCount++;
+            return FALSE;
+        }
+        Idx = SimDmaAdvance(pDma, Idx, ENET_RX_BD_W_MASK);
+    }
+    Idx = pDma->DmaIdx;
+    for (LONG i = 0; i < BDCount; ++i) {
+        ENET_BD *pBD   = &pDma->DmaBDT[Idx];
+        ULONG    Chunk = (Remaining > SIM_RX_BUFFER_SIZE) ? SIM_RX_BUFFER_SIZE : Remaining;
+        USHORT   ControlStatus = pBD->ControlStatus & (USHORT)~(ENET_RX_BD_E_MASK | ENET_RX_BD_L_MASK);
+
+        SimDmaCheckBD(pDma, Idx, ENET_RX_BD_W_MASK);
+        memset(SimBufferVa(pDma, pBD->BufferAddress), Pattern, Chunk);
+        Remaining -= Chunk;
+        if (i == BDCount - 1) {
+            pBD->DataLen   = (USHORT)FrameLength;                    // Last BD holds the frame length
+            pBD->Timestamp = pDma->Timestamp;
+            ControlStatus |= ENET_RX_BD_L_MASK;
+        } else {
+            pBD->DataLen = SIM_RX_BUFFER_SIZE;
+        }
+        pBD->Bdu           = ENET_RX_BD_BDU_MASK;
+        pBD->ControlStatus = ControlStatus;
+        Idx = SimDmaAdvance(pDma, Idx, ENET_RX_BD_W_MASK);
+    }
+    pDma->DmaIdx = Idx;
+    pDma->FilledBDs += BDCount;
+    pDma->Timestamp += 1000;
+    pDma->FrameCount++;
+    if (pDma->DmaBDT[pDma->DmaIdx].ControlStatus & ENET_RX_BD_E_MASK) {
+        // Next BD ready, keep going
+    } else {
+        pDma->DAR = 0;
+    }
+    if (pDma->DmaBDT[(Idx == 0 ? pDma->ItemCount : Idx) - 1].ExtControlStatus & ENET_RX_BD_INT_MASK) {
+        pDma->InterruptCount++;
+    }
+    return TRUE;
+}
+
+/*
+ * Driver side, same use of the ring primitives as mp_data_path.c
+ */
+typedef struct _SIM_TX_QUEUE {
+    LONG    EnetFreeBDIdx;
+    LONG    EnetPendingBDIdx;
+    LONG    EnetFreeBDCount;
+    ULONG   InFlight[SIM_RING_SIZE_MAX];                    // Frame sequence number + 1, 0 if the BD is free
+    ULONG   NextSeq;
+    ULONG   CompletedSeq;                                   // Frames are completed in order
+    ULONG   OutOfOrder;
+    ULONGLONG DmaOwnedSum;                                  // Occupancy samples, one per submitted frame
+    LONG    DmaOwnedMax;
+} SIM_TX_QUEUE;
+
+typedef struct _SIM_RX_QUEUE {
+    LONG    EnetFreeBDIdx;                                  // Next BD a returned buffer is attached to
+    LONG    EnetPendingBDIdx;                               // Next BD to check for a received frame
+    LONG    DmaOwnedBDsCount;
+    LONG    HeldBuffers;                                    // Buffers indicated and not returned yet
+    LONG    HeldBufferIdx[SIM_RING_SIZE_MAX];               // Buffer of each held BD, in indication order
+    LONG    HeldHead;
+    LONG    BufferOfBD[SIM_RING_SIZE_MAX];                  // Buffer attached to each BD, -1 if none
+    ULONG   FrameCount;
+    ULONG   ByteCount;
+    ULONG   BadFrames;
+    ULONGLONG EmptyBDsSum;                                  // Occupancy samples, one per frame on the wire
+    ULONG   EmptyBDsSamples;
+    LONG    EmptyBDsMin;
+} SIM_RX_QUEUE;
+
+static SIM_TX_QUEUE TxQueue;
+static SIM_RX_QUEUE RxQueue;
+
+static void SimTxInit(LONG ItemCount)
+{
+    SimDmaInit(&TxDma, ItemCount);
+    memset(&TxQueue, 0, sizeof(TxQueue));
+    TxQueue.EnetFreeBDCount = ItemCount;
+}
+
+// MpTxFillEnetTxBD(). Returns FALSE if the ring is full.
+static BOOLEAN SimTxSend(ULONG FrameLength)
+{
+    LONG              EnetFreeBDIdx = TxQueue.EnetFreeBDIdx;
+    volatile ENET_BD *pFreeEnetBD   = &TxDma.DmaBDT[EnetFreeBDIdx];
+    LONG              DmaOwned      = TxDma.ItemCount - TxQueue.EnetFreeBDCount;
+
+    if (TxQueue.EnetFreeBDCount == 0) {
+        return FALSE;
+    }
+    TxQueue.DmaOwnedSum += DmaOwned;
+    if (DmaOwned > TxQueue.DmaOwnedMax) {
+        TxQueue.DmaOwnedMax = DmaOwned;
+    }
+    HOSTTEST_CHECK(!EnetTxBdIsDmaOwned(pFreeEnetBD));
+    memset(TxDma.Buffers[EnetFreeBDIdx], (UCHAR)TxQueue.NextSeq, FrameLength);   // MpCopyNetBuffer()
+    TxQueue.InFlight[EnetFreeBDIdx] = ++TxQueue.NextSeq;
+    TxQueue.EnetFreeBDIdx = EnetBdRingNextIdx(EnetFreeBDIdx, TxDma.ItemCount);
+    TxQueue.EnetFreeBDCount--;
+    EnetTxBdSubmit(pFreeEnetBD, EnetFreeBDIdx, TxDma.ItemCount, SimBufferPa(EnetFreeBDIdx), (USHORT)FrameLength,
+                   ENET_TX_BD_INT_MASK | ENET_TX_BD_TS_MASK);
+    if (!EnetBdRingIsActive(&TxDma.DAR)) {
+        if (EnetTxBdIsDmaOwned(pFreeEnetBD)) {
+            EnetBdRingKick(&TxDma.DAR);
+        }
+    }
+    return TRUE;
+}
+
+// ENET_TX_BD_COMPLETE callback of SimTxComplete(), checks the frames are completed in order.
+static void SimTxCompleteBD(void *pContext, LONG Idx)
+{
+    UNREFERENCED_PARAMETER(pContext);
+    HOSTTEST_CHECK(TxQueue.InFlight[Idx] != 0);
+    if (TxQueue.InFlight[Idx] != TxQueue.CompletedSeq + 1) {
+        TxQueue.OutOfOrder++;
+    }
+    TxQueue.CompletedSeq = TxQueue.InFlight[Idx];
+    TxQueue.InFlight[Idx] = 0;
+}
+
+// MpHandleTxInterrupt(). Returns the number of frames completed.
+static ULONG SimTxComplete(void)
+{
+    return EnetTxBdRingComplete(TxDma.DmaBDT, TxDma.ItemCount, &TxDma.DAR, &TxQueue.EnetPendingBDIdx, &TxQueue.EnetFreeBDCount,
+                                SimTxCompleteBD, NULL);
+}
+
+// MpRxQueueReturnNetBufferLists() for the Count oldest held buffers.
+static void SimRxReturn(LONG Count)
+{
+    ENET_RX_BD_BATCH Batch;
+
+    EnetRxBdBatchBegin(&Batch, RxDma.DmaBDT, RxDma.ItemCount, RxQueue.EnetFreeBDIdx);
+    for (LONG i = 0; (i < Count) && (RxQueue.HeldBuffers != 0); ++i) {
+        LONG Buffer = RxQueue.HeldBufferIdx[RxQueue.HeldHead];
+        LONG Idx;
+
+        RxQueue.HeldHead = EnetBdRingNextIdx(RxQueue.HeldHead, RxDma.ItemCount);
+        RxQueue.HeldBuffers--;
+        RxQueue.DmaOwnedBDsCount++;
+        HOSTTEST_CHECK(RxQueue.BufferOfBD[Batch.FreeBDIdx] == -1);
+        Idx = EnetRxBdBatchAdd(&Batch, SimBufferPa(Buffer));
+        RxQueue.BufferOfBD[Idx] = Buffer;
+    }
+    RxQueue.EnetFreeBDIdx = EnetRxBdBatchCommit(&Batch, &RxDma.DAR);
+}
+
+// MpRxInit() and EnetStart(): every BD gets a buffer and the ring is started.
+static void SimRxInit(LONG ItemCount)
+{
+    SimDmaInit(&RxDma, ItemCount);
+    memset(&RxQueue, 0, sizeof(RxQueue));
+    for (LONG Idx = 0; Idx < ItemCount; ++Idx) {
+        RxQueue.BufferOfBD[Idx]    = -1;
+        RxQueue.HeldBufferIdx[Idx] = Idx;
+    }
+    RxQueue.HeldBuffers = ItemCount;
+    RxQueue.EmptyBDsMin = ItemCount;
+    SimRxReturn(ItemCount);
+}
+
+// Samples the number of empty BDs the DMA can still fill, each time a frame arrives.
+static void SimRxSampleOccupancy(void)
+{
+    LONG EmptyBDs = RxQueue.DmaOwnedBDsCount - RxDma.FilledBDs;
+
+    RxQueue.EmptyBDsSum += EmptyBDs;
+    RxQueue.EmptyBDsSamples++;
+    if (EmptyBDs < RxQueue.EmptyBDsMin) {
+        RxQueue.EmptyBDsMin = EmptyBDs;
+    }
+}
+
+typedef struct _SIM_RX_FRAME {
+    UCHAR   Pattern;                                        // Byte the frame has been filled with
+    ULONG   Length;
+} SIM_RX_FRAME;
+
+// ENET_RX_BD_BUFFER callback of SimRxPoll(), checks the data of each buffer and holds it.
+static void SimRxFrameBuffer(void *pContext, LONG FrameBDIdx, LONG Idx, ULONG BufferLength)
+{
+    SIM_RX_FRAME *pFrame = (SIM_RX_FRAME *)pContext;
+    LONG          Buffer = RxQueue.BufferOfBD[Idx];
+    UCHAR        *pData  = RxDma.Buffers[Buffer];
+
+    if (FrameBDIdx == 0) {
+        pFrame->Pattern = pData[0];
+    }
+    if ((pData[0] != pFrame->Pattern) || (pData[BufferLength - 1] != pFrame->Pattern)) {
+        RxQueue.BadFrames++;
+    }
+    pFrame->Length += BufferLength;
+    RxQueue.BufferOfBD[Idx] = -1;
+    RxQueue.HeldBufferIdx[EnetBdRingAddIdx(RxQueue.HeldHead, RxQueue.HeldBuffers, RxDma.ItemCount)] = Buffer;
+    RxQueue.HeldBuffers++;
+}
+
+// MpHandleRecvInterrupt(). Indicated buffers are held until SimRxReturn(). Returns the number of frames indicated.
+static ULONG SimRxPoll(ULONG MaxFrames)
+{
+    LONG  Rx_EnetPendingBDIdx = RxQueue.EnetPendingBDIdx;
+    ULONG Count               = 0;
+
+    while (Count < MaxFrames) {
+        volatile ENET_BD *pDmaBD = &RxDma.DmaBDT[Rx_EnetPendingBDIdx];
+        LONG              FrameBDCount;
+        SIM_RX_FRAME      Frame  = { 0, 0 };
+
+        if (EnetRxBdIsEmpty(pDmaBD) || (RxQueue.DmaOwnedBDsCount == 0)) {
+            break;
+        }
+        if ((FrameBDCount = EnetRxBdRingGetFrameBDCount(RxDma.DmaBDT, RxDma.ItemCount, Rx_EnetPendingBDIdx, RxQueue.DmaOwnedBDsCount)) == 0) {
+            break;
+        }
+        pDmaBD = &RxDma.DmaBDT[EnetBdRingAddIdx(Rx_EnetPendingBDIdx, FrameBDCount - 1, RxDma.ItemCount)];
+        HOSTTEST_CHECK(EnetRxBdIsLast(pDmaBD));
+        EnetRxBdRingWalkFrame(RxDma.DmaBDT, RxDma.ItemCount, Rx_EnetPendingBDIdx, FrameBDCount, SimRxFrameBuffer, &Frame);
+        HOSTTEST_CHECK_EQ(Frame.Length, pDmaBD->DataLen);
+        RxQueue.DmaOwnedBDsCount -= FrameBDCount;
+        RxDma.FilledBDs -= FrameBDCount;
+        RxQueue.FrameCount++;
+        RxQueue.ByteCount += pDmaBD->DataLen;
+        Rx_EnetPendingBDIdx = EnetBdRingAddIdx(Rx_EnetPendingBDIdx, FrameBDCount, RxDma.ItemCount);
+        RxQueue.EnetPendingBDIdx = Rx_EnetPendingBDIdx;
+        Count++;
+    }
+    return Count;
+}
+
+/*
+ * Tests
+ */
+static ULONG SimRandomState = 2463534242u;
+
+static ULONG SimRandom(ULONG Range)
+{
+    SimRandomState ^= SimRandomState << 13;
+    SimRandomState ^= SimRandomState >> 17;
+    SimRandomState ^= SimRandomState << 5;
+    return SimRandomState % Range;
+}
+
+static const LONG RingSizes[] = { 2, 3, 16, 31, 64, SIM_RING_SIZE_MAX };
+
+static void TestTxWrap(void)
+{
+    for (ULONG r = 0; r < ARRAYSIZE(RingSizes); ++r) {
+        LONG  ItemCount = RingSizes[r];
+        ULONG Frames    = 20 * ItemCount;
+        ULONG Sent      = 0;
+        ULONG Completed = 0;
+
+        SimTxInit(ItemCount);
+        while (Completed < Frames) {
+            while ((Sent < Frames) && (SimRandom(4) != 0) && SimTxSend(60 + SimRandom(1455))) {
+                Sent++;
+            }
+            SimTxDmaRun(SimRandom(ItemCount + 1));
+            Completed += SimTxComplete();
+        }
+        HOSTTEST_CHECK_EQ(TxDma.FrameCount, Frames);
+        HOSTTEST_CHECK_EQ(TxDma.InterruptCount, Frames);
+        HOSTTEST_CHECK_EQ(TxDma.WrapErrors, 0);
+        HOSTTEST_CHECK_EQ(TxDma.OwnershipErrors, 0);
+        HOSTTEST_CHECK_EQ(TxQueue.OutOfOrder, 0);
+        HOSTTEST_CHECK_EQ(TxQueue.EnetFreeBDCount, ItemCount);
+        HOSTTEST_CHECK_EQ(TxDma.DmaIdx, TxQueue.EnetFreeBDIdx);
+    }
+}
+
+static void TestTxRingFull(void)
+{
+    SimTxInit(16);
+    for (LONG i = 0; i < 16; ++i) {
+        HOSTTEST_CHECK(SimTxSend(60));
+    }
+    HOSTTEST_CHECK(!SimTxSend(60));
+    HOSTTEST_CHECK(EnetBdRingIsActive(&TxDma.DAR));
+    HOSTTEST_CHECK_EQ(SimTxComplete(), 0);                          // Nothing transmitted yet
+    HOSTTEST_CHECK_EQ(SimTxDmaRun(100), 16);
+    HOSTTEST_CHECK(!EnetBdRingIsActive(&TxDma.DAR));
+    HOSTTEST_CHECK_EQ(SimTxComplete(), 16);
+    HOSTTEST_CHECK_EQ(TxQueue.EnetFreeBDCount, 16);
+    HOSTTEST_CHECK(SimTxSend(60));                                   // Ring restarts on the TDAR write
+    HOSTTEST_CHECK(EnetBdRingIsActive(&TxDma.DAR));
+    HOSTTEST_CHECK_EQ(SimTxDmaRun(100), 1);
+}
+
+// ERR006358: TDAR is cleared while BDs are still ready. The Tx interrupt handler restarts the ring.
+static void TestTxErr006358(void)
+{
+    ULONG Completed = 0;
+
+    SimTxInit(8);
+    TxDma.Err006358 = TRUE;
+    for (LONG i = 0; i < 8; ++i) {
+        HOSTTEST_CHECK(SimTxSend(100));
+    }
+    while (Completed < 8) {
+        ULONG Transmitted = SimTxDmaRun(8);
+
+        HOSTTEST_CHECK(Transmitted <= 1);
+        Completed += SimTxComplete();
+        if ((Transmitted == 0) && (Completed < 8)) {
+            HOSTTEST_CHECK(!"Tx ring stalled");
+            break;
+        }
+    }
+    HOSTTEST_CHECK_EQ(TxDma.FrameCount, 8);
+    HOSTTEST_CHECK_EQ(TxQueue.OutOfOrder, 0);
+}
+
+static void TestRxWrapAndJumbo(void)
+{
+    for (ULONG r = 1; r < ARRAYSIZE(RingSizes); ++r) {           // A jumbo frame needs 3 BDs
+        LONG  ItemCount = RingSizes[r];
+        ULONG Frames    = 20 * ItemCount;
+        ULONG Received  = 0;
+        ULONG Bytes     = 0;
+
+        SimRxInit(ItemCount);
+        HOSTTEST_CHECK(EnetBdRingIsActive(&RxDma.DAR));
+        for (ULONG i = 0; i < Frames; ++i) {
+            ULONG Length = (SimRandom(8) == 0) ? (SIM_RX_BUFFER_SIZE + 1 + SimRandom(SIM_RX_BUFFER_SIZE)) : (64 + SimRandom(1400));
+
+            if (ItemCount < 3) {
+                Length = 64 + SimRandom(1400);
+            }
+            while (!SimRxDmaReceive(Length, (UCHAR)i)) {             // Driver keeps up: drain and retry
+                RxDma.DropCount--;
+                Received += SimRxPoll(MAXULONG);
+                SimRxReturn(ItemCount);
+            }
+            Bytes += Length;
+            if (SimRandom(3) == 0) {
+                Received += SimRxPoll(1 + SimRandom(4));
+                SimRxReturn(SimRandom(ItemCount));
+            }
+        }
+        Received += SimRxPoll(MAXULONG);
+        SimRxReturn(ItemCount);
+        HOSTTEST_CHECK_EQ(Received, Frames);
+        HOSTTEST_CHECK_EQ(RxQueue.ByteCount, Bytes);
+        HOSTTEST_CHECK_EQ(RxQueue.BadFrames, 0);
+        HOSTTEST_CHECK_EQ(RxDma.InterruptCount, Frames);
+        HOSTTEST_CHECK_EQ(RxDma.WrapErrors, 0);
+        HOSTTEST_CHECK_EQ(RxDma.OwnershipErrors, 0);
+        HOSTTEST_CHECK_EQ(RxQueue.DmaOwnedBDsCount, ItemCount);
+    }
+}
+
+// The driver holds every buffer: the DMA stops and drops frames, returning buffers restarts it through RDAR.
+static void TestRxOverrun(void)
+{
+    SimRxInit(8);
+    for (ULONG i = 0; i < 8; ++i) {
+        HOSTTEST_CHECK(SimRxDmaReceive(100, (UCHAR)i));
+    }
+    HOSTTEST_CHECK(!EnetBdRingIsActive(&RxDma.DAR));
+    HOSTTEST_CHECK(!SimRxDmaReceive(100, 0xAA));
+    HOSTTEST_CHECK_EQ(SimRxPoll(MAXULONG), 8);
+    HOSTTEST_CHECK(!SimRxDmaReceive(100, 0xAA));                     // Buffers not returned yet
+    HOSTTEST_CHECK_EQ(RxDma.DropCount, 2);
+    RxDma.Kicked = FALSE;
+    SimRxReturn(2);
+    HOSTTEST_CHECK(RxDma.Kicked);
+    HOSTTEST_CHECK(SimRxDmaReceive(100, 0x55));
+    HOSTTEST_CHECK(SimRxDmaReceive(100, 0x56));
+    HOSTTEST_CHECK(!SimRxDmaReceive(100, 0x57));
+    HOSTTEST_CHECK_EQ(SimRxPoll(MAXULONG), 2);
+    HOSTTEST_CHECK_EQ(RxQueue.BadFrames, 0);
+    HOSTTEST_CHECK_EQ(RxDma.OwnershipErrors, 0);
+}
+
+static void TestRingIndex(void)
+{
+    HOSTTEST_CHECK_EQ(EnetBdRingNextIdx(0, 1), 0);
+    HOSTTEST_CHECK_EQ(EnetBdRingNextIdx(14, 16), 15);
+    HOSTTEST_CHECK_EQ(EnetBdRingNextIdx(15, 16), 0);
+    HOSTTEST_CHECK_EQ(EnetBdRingAddIdx(14, 3, 16), 1);
+    HOSTTEST_CHECK_EQ(EnetBdRingAddIdx(0, 16, 16), 0);
+}
+
+/*
+ * pktgen-style benchmark
+ */
+static double SimNow(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void Benchmark(void)
+{
+    static const ULONG FrameSizes[] = { 64, 128, 256, 512, 1024, 1518 };
+    const LONG         ItemCount    = 64;
+    const ULONG        Frames       = 1000000;
+    const ULONG        Burst        = 16;                              // Frames sent or received per DPC
+    const ULONG        DmaBudget    = 8;                               // Frames the DMA handles between two DPCs
+
+    printf("\nENET BD ring benchmark, %d BDs per ring, %u frames\n", (int)ItemCount, Frames);
+    printf("Tx: BDs owned by the DMA when a frame is queued. Rx: empty BDs left when a frame arrives.\n");
+    printf("Frame size   Tx ns/pkt   Tx BDs avg/max   Rx ns/pkt   Rx BDs avg/min\n");
+    for (ULONG s = 0; s < ARRAYSIZE(FrameSizes); ++s) {
+        ULONG  Size = FrameSizes[s];
+        ULONG  Sent = 0;
+        ULONG  Completed = 0;
+        ULONG  Received = 0;
+        ULONG  Offered = 0;
+        double Start, TxNs, RxNs;
+
+        SimTxInit(ItemCount);
+        Start = SimNow();
+        while (Completed < Frames) {
+            for (ULONG i = 0; (i < Burst) && (Sent < Frames) && SimTxSend(Size); ++i) {
+                Sent++;
+            }
+            SimTxDmaRun(DmaBudget);
+            Completed += SimTxComplete();
+        }
+        TxNs = (SimNow() - Start) / Frames;
+
+        SimRxInit(ItemCount);
+        Start = SimNow();
+        while (Received < Frames) {
+            for (ULONG i = 0; (i < DmaBudget) && (Offered < Frames); ++i, ++Offered) {
+                SimRxDmaReceive(Size, (UCHAR)Offered);
+            }
+            ULONG Indicated = SimRxPoll(Burst);
+
+            Received += Indicated;
+            SimRxReturn((LONG)Indicated);
+            if ((Offered == Frames) && (Indicated == 0)) {
+                break;                                                  // The rest has been dropped
+            }
+        }
+        RxNs = (SimNow() - Start) / (Received ? Received : 1);
+
+        printf("%10u   %9.1f   %6.1f / %3d     %9.1f   %6.1f / %3d%s\n", Size,
+               TxNs, (double)TxQueue.DmaOwnedSum / Sent, (int)TxQueue.DmaOwnedMax,
+               RxNs, (double)RxQueue.EmptyBDsSum / RxQueue.EmptyBDsSamples, (int)RxQueue.EmptyBDsMin,
+               RxDma.DropCount ? "  (Rx drops)" : "");
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    HOSTTEST_RUN(TestRingIndex);
+    HOSTTEST_RUN(TestTxWrap);
+    HOSTTEST_RUN(TestTxRingFull);
+    HOSTTEST_RUN(TestTxErr006358);
+    HOSTTEST_RUN(TestRxWrapAndJumbo);
+    HOSTTEST_RUN(TestRxOverrun);
+
+    if ((argc > 1) && (strcmp(argv[1], "bench") == 0)) {
+        Benchmark();
+    }
+    return HostTestExit();
+}
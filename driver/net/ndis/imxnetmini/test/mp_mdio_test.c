@@ -0,0 +1,929 @@
+/*
+* Copyright 2018 NXP
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted (subject to the limitations in the disclaimer
+* below) provided that the following conditions are met:
+*
+* * Redistributions of source code must retain the above copyright notice, this
+* list of conditions and the following disclaimer.
+*
+* * Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* * Neither the name of NXP nor the names of its contributors may be used to
+* endorse or promote products derived from this software without specific prior
+* written permission.
+*
+* NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY THIS
+* LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+* THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+* GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+* LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+
+// Host test of the MDIO sequencer core in mp_mdio_seq.h.
+//
+// A simulated PHY register file (IEEE registers 0x00-0x0A, AR8031 style interrupt enable 0x12 and clear-on-read
+// interrupt status 0x13 driving an edge triggered interrupt line) answers the MII management frames the sequencer
+// starts. The bus thread, the MII interrupt, the PHY ISR and the RUNNING state of the state machine are modelled the
+// way MDIOBus_Main, MDIOBus_OnTransferDone, PHYDev_Isr and MpSmDispatcher drive the core. The tests cover link flaps
+// (also while a link sequence is in flight and faster than the state machine period), auto-negotiation restart with a
+// new advertisement, the round-robin between PHYs on one bus, the all-or-nothing command queueing and the timer
+// fallback used when the MII interrupt is not available.
+//
+// Build and run from the repository root:
+//
+//   cc -std=c11 -Wall -I driver/shared/hosttest -I driver/net/ndis/imxnetmini
+//      driver/net/ndis/imxnetmini/test/mp_mdio_test.c -o mp_mdio_test
+//   ./mp_mdio_test
+
+#include "hosttest.h"
+
+/*
+ * NDIS and kernel types used by the MDIO and PHY structures
+ */
+typedef PVOID NDIS_HANDLE;
+typedef PVOID PKTHREAD;
+typedef PVOID PKINTERRUPT;
+typedef LARGE_INTEGER NDIS_PHYSICAL_ADDRESS;
+typedef char TCHAR;
+typedef struct { LONG Dummy; } NDIS_SPIN_LOCK, KEVENT, KTIMER, CM_PARTIAL_RESOURCE_DESCRIPTOR;
+typedef BOOLEAN KSERVICE_ROUTINE(PKINTERRUPT Interrupt, PVOID ServiceContext);
+
+typedef enum {
+    MediaConnectStateUnknown,
+    MediaConnectStateConnected,
+    MediaConnectStateDisconnected
+} NDIS_MEDIA_CONNECT_STATE;
+
+typedef enum {
+    MediaDuplexStateUnknown,
+    MediaDuplexStateHalf,
+    MediaDuplexStateFull
+} NDIS_MEDIA_DUPLEX_STATE;
+
+#define TEXT(s)                  s
+#define NDIS_STATUS_SUCCESS      STATUS_SUCCESS
+#define NDIS_STATUS_RESOURCES    STATUS_INSUFFICIENT_RESOURCES
+
+#include "enet_iomap.h"
+#include "mp_mdio.h"
+#include "mp_enet_phy.h"
+
+static void SimLockDevice(MP_MDIO_DEVICE *pMDIODev);
+static void SimUnlockDevice(MP_MDIO_DEVICE *pMDIODev);
+static void SimFrameStarted(volatile CSP_ENET_REGS *pRegs);
+
+#define MDIO_SEQ_LOCK_DEVICE(pMDIODev)        SimLockDevice(pMDIODev)
+#define MDIO_SEQ_UNLOCK_DEVICE(pMDIODev)      SimUnlockDevice(pMDIODev)
+#define MDIO_SEQ_FRAME_STARTED(pMDIORegs)     SimFrameStarted(pMDIORegs)
+#define MDIO_SEQ_CLEAR_MII_FLAG(pMDIORegs)    ((pMDIORegs)->EIR.U &= ~ENET_EIR_MII_MASK)   // W1C modelled as a plain clear
+
+#include "mp_mdio_seq.h"
+
+#define SIM_ADAPTERS_MAX         2
+#define SIM_AN_PERIODS           3          // State machine periods auto-negotiation takes once the cable is plugged
+#define SIM_BUS_STEPS_MAX        10000
+#define SIM_SETTLE_MAX           100
+#define SIM_TRACE_SIZE           256
+#define SIM_RECORD_SIZE          64
+
+#define SIM_REG_INT_EN           0x12
+#define SIM_REG_INT_STATUS       0x13
+#define SIM_INT_LINK_FAIL        0x0800
+#define SIM_INT_LINK_SUCCESS     0x0400
+
+#define SIM_SR_ABILITY           (MII_REG_SR_100BASE_TX_FULLDUPLEX | MII_REG_SR_100BASE_TX_HALFDUPLEX | MII_REG_SR_10BASE_TX_FULLDUPLEX | \
+                                  MII_REG_SR_10BASE_TX_HALFDUPLEX | MII_REG_SR_AN_ABILITY | MII_REG_SR_EXTENDEDCAPABILITY)
+#define SIM_AN_TECHNOLOGY_MASK   (MII_REG_ANAR_100BASETX_FD | MII_REG_ANAR_100BASETX_HD | MII_REG_ANAR_10BASETX_FD | MII_REG_ANAR_10BASETX_HD)
+
+/*
+ * PHY register file model
+ */
+typedef struct _SIM_PHY {
+    UINT16      Regs[32];
+    BOOLEAN     Cable;                      // Link partner connected
+    UINT16      PartnerAbility;             // ANLPAR once auto-negotiation completes
+    ULONG       AnCountdown;                // State machine periods until auto-negotiation completes, 0 if not running
+    BOOLEAN     AnComplete;
+    BOOLEAN     LinkUp;
+    BOOLEAN     LinkLatchedLow;             // SR link status is latched low until read
+    BOOLEAN     IntLine;                    // Interrupt output, released by reading the interrupt status
+    ULONG       IntEdges;
+} SIM_PHY;
+
+typedef struct _MP_ADAPTER {
+    MP_MDIO_DEVICE              MDIODev;
+    MP_PHY_DEVICE               PHYDev;
+    SIM_PHY                     Phy;
+    NDIS_MEDIA_CONNECT_STATE    MediaConnectState;      // State reported to NDIS
+    ULONG                       LinkChanges;            // Number of reported state changes
+    BOOLEAN                     LinkUpdateRequested;    // SmRequestLinkUpdate() called
+    BOOLEAN                     Gigabit;
+    volatile UINT32             ECR;
+    UINT16                      Recorded[SIM_RECORD_SIZE];
+    ULONG                       RecordedCount;
+} MP_ADAPTER, *PMP_ADAPTER;
+
+typedef struct _SIM_TRACE {
+    UINT32      PhyAddress;
+    UINT32      Op;
+    UINT32      Reg;
+} SIM_TRACE;
+
+static MP_MDIO_BUS      SimBus;
+static CSP_ENET_REGS    SimRegs;
+static MP_ADAPTER       SimAdapters[SIM_ADAPTERS_MAX];
+static ULONG            SimAdapterCount;
+static BOOLEAN          SimMiiInterrupt;        // FALSE: MDIO_TransferTimeout_ms timer fallback
+static BOOLEAN          SimEvent;               // MDIOBus_StartTransferEvent
+static BOOLEAN          SimTimerArmed;          // MDIOBus_Timer
+static BOOLEAN          SimFrameOnBus;
+static int              SimDeviceLocks;
+static SIM_TRACE        SimTrace[SIM_TRACE_SIZE];
+static ULONG            SimTraceCount;
+
+static void SimParse_MII_S(UINT RegVal, NDIS_HANDLE MiniportAdapterHandle);
+static void SimParsePHYLink(UINT RegVal, NDIS_HANDLE MiniportAdapterHandle);
+static void SimParse_MII_LPA(UINT RegVal, NDIS_HANDLE MiniportAdapterHandle);
+static void SimRecord(UINT RegVal, NDIS_HANDLE MiniportAdapterHandle);
+
+/*
+ * Commands, as in mp_enet_phy.c for the AR8031
+ */
+static ENET_PHY_CMD SimCmdLink[] = {
+    {MII_READ_COMMAND(MII_REG_SR), SimParse_MII_S},
+    {MII_READ_COMMAND(MII_REG_SR), SimParsePHYLink},
+    {ENET_MII_END,                 NULL}
+};
+
+static ENET_PHY_CMD SimCmdActint[] = {
+    {MII_READ_COMMAND(MII_REG_SR),     SimParse_MII_S},
+    {MII_READ_COMMAND(MII_REG_ANLPAR), SimParse_MII_LPA},
+    {ENET_MII_END,                     NULL}
+};
+
+static ENET_PHY_CMD SimCmdIntEnable[] = {
+    {MII_READ_COMMAND(SIM_REG_INT_STATUS),      NULL},                            // Clear pending interrupts
+    {MII_WRITE_COMMAND(SIM_REG_INT_EN, 0x0C00), NULL},                            // Link success, Link fail
+    {ENET_MII_END,                              NULL}
+};
+
+static ENET_PHY_CMD SimCmdIntAck[] = {
+    {MII_READ_COMMAND(SIM_REG_INT_STATUS), NULL},
+    {ENET_MII_END,                         NULL}
+};
+
+static ENET_PHY_CMD SimCmdRestartAN[] = {
+    {MII_WRITE_COMMAND(MII_REG_ANAR, 0x01E1), NULL},
+    {MII_WRITE_COMMAND(MII_REG_CR, 0x1300),   NULL},
+    {ENET_MII_END,                            NULL}
+};
+
+static MP_PHY_INFO SimPhyInfoInt = {
+    ENET_PHY_AR8031, TEXT("SIM INT"), NULL, NULL, SimCmdActint, NULL, SimCmdIntEnable, SimCmdIntAck
+};
+
+static MP_PHY_INFO SimPhyInfoPoll = {
+    ENET_PHY_AR8031, TEXT("SIM POLL"), NULL, NULL, SimCmdActint, NULL, NULL, NULL
+};
+
+static void SimLockDevice(MP_MDIO_DEVICE *pMDIODev)
+{
+    UNREFERENCED_PARAMETER(pMDIODev);
+    HOSTTEST_CHECK_EQ(SimDeviceLocks, 0);
+    SimDeviceLocks++;
+}
+
+static void SimUnlockDevice(MP_MDIO_DEVICE *pMDIODev)
+{
+    UNREFERENCED_PARAMETER(pMDIODev);
+    HOSTTEST_CHECK_EQ(SimDeviceLocks, 1);
+    SimDeviceLocks--;
+}
+
+/*
+ * PHYDev_Isr(), the interrupt line is edge triggered
+ */
+static void SimPhyRaiseInterrupt(PMP_ADAPTER pAdapter, UINT16 Event)
+{
+    SIM_PHY *pPhy = &pAdapter->Phy;
+
+    if (!(pPhy->Regs[SIM_REG_INT_EN] & Event)) {
+        return;
+    }
+    pPhy->Regs[SIM_REG_INT_STATUS] |= Event;
+    if (!pPhy->IntLine) {
+        pPhy->IntLine = TRUE;
+        pPhy->IntEdges++;
+        (void)InterlockedExchange(&pAdapter->PHYDev.PHYDev_IntPending, 1);
+        pAdapter->LinkUpdateRequested = TRUE;
+    }
+}
+
+static void SimPhySetLink(PMP_ADAPTER pAdapter, BOOLEAN LinkUp)
+{
+    SIM_PHY *pPhy = &pAdapter->Phy;
+
+    if (pPhy->LinkUp == LinkUp) {
+        return;
+    }
+    pPhy->LinkUp = LinkUp;
+    if (!LinkUp) {
+        pPhy->LinkLatchedLow = TRUE;
+    }
+    SimPhyRaiseInterrupt(pAdapter, LinkUp ? SIM_INT_LINK_SUCCESS : SIM_INT_LINK_FAIL);
+}
+
+static void SimPhyRestartAN(PMP_ADAPTER pAdapter)
+{
+    SIM_PHY *pPhy = &pAdapter->Phy;
+
+    SimPhySetLink(pAdapter, FALSE);
+    pPhy->AnComplete = FALSE;
+    pPhy->Regs[MII_REG_ANLPAR] = 0;
+    pPhy->AnCountdown = pPhy->Cable ? SIM_AN_PERIODS : 0;
+}
+
+static void SimPhySetCable(PMP_ADAPTER pAdapter, BOOLEAN Cable)
+{
+    pAdapter->Phy.Cable = Cable;
+    SimPhyRestartAN(pAdapter);
+}
+
+// One state machine period passes for the PHY.
+static void SimPhyTime(PMP_ADAPTER pAdapter)
+{
+    SIM_PHY *pPhy = &pAdapter->Phy;
+
+    if ((pPhy->AnCountdown != 0) && (--pPhy->AnCountdown == 0)) {
+        pPhy->AnComplete = TRUE;
+        pPhy->Regs[MII_REG_ANLPAR] = pPhy->PartnerAbility;
+        SimPhySetLink(pAdapter, (pPhy->Regs[MII_REG_ANAR] & pPhy->PartnerAbility & SIM_AN_TECHNOLOGY_MASK) != 0);
+    }
+}
+
+static UINT16 SimPhyRead(PMP_ADAPTER pAdapter, UINT32 Reg)
+{
+    SIM_PHY *pPhy = &pAdapter->Phy;
+    UINT16   Val = pPhy->Regs[Reg];
+
+    switch (Reg) {
+        case MII_REG_SR:
+            Val = SIM_SR_ABILITY;
+            if (pPhy->AnComplete)
+                Val |= MII_REG_SR_AN_COMPLETE;
+            if (pPhy->LinkUp && !pPhy->LinkLatchedLow)
+                Val |= MII_REG_SR_LINKSTATUS;
+            pPhy->LinkLatchedLow = FALSE;
+            break;
+        case SIM_REG_INT_STATUS:
+            pPhy->Regs[SIM_REG_INT_STATUS] = 0;
+            pPhy->IntLine = FALSE;
+            break;
+        default:
+            break;
+    }
+    return Val;
+}
+
+static void SimPhyWrite(PMP_ADAPTER pAdapter, UINT32 Reg, UINT16 Val)
+{
+    SIM_PHY *pPhy = &pAdapter->Phy;
+
+    switch (Reg) {
+        case MII_REG_CR:
+            pPhy->Regs[MII_REG_CR] = Val & ~(MII_REG_CR_RESET | MII_REG_CR_RESTART_AN);    // Self clearing bits
+            if ((Val & MII_REG_CR_AN_ENABLE) && (Val & MII_REG_CR_RESTART_AN)) {
+                SimPhyRestartAN(pAdapter);
+            }
+            break;
+        case MII_REG_SR:
+        case MII_REG_ANLPAR:
+        case SIM_REG_INT_STATUS:
+            break;                                                                       // Read only
+        default:
+            pPhy->Regs[Reg] = Val;
+            break;
+    }
+}
+
+static PMP_ADAPTER SimFindAdapter(UINT32 Mmfr)
+{
+    for (ULONG i = 0; i < SimAdapterCount; ++i) {
+        if ((UINT32)SimAdapters[i].MDIODev.MDIODev_EnetPhyAddress == (Mmfr & ENET_MMFR_PA_MASK)) {
+            return &SimAdapters[i];
+        }
+    }
+    return NULL;
+}
+
+/*
+ * MDIO_SEQ_FRAME_STARTED(), the frame goes on the bus
+ */
+static void SimFrameStarted(volatile CSP_ENET_REGS *pRegs)
+{
+    HOSTTEST_CHECK(!SimFrameOnBus);                                 // One frame at a time
+    HOSTTEST_CHECK(pRegs->MSCR.U != 0);                             // MDC running
+    HOSTTEST_CHECK(!(pRegs->EIR.U & ENET_EIR_MII_MASK));            // Previous frame completed
+    HOSTTEST_CHECK_EQ(SimDeviceLocks, 1);
+    SimFrameOnBus = TRUE;
+}
+
+// The frame on the bus ends: the PHY executes it and EIR[MII] is set.
+static void SimFrameEnd(void)
+{
+    UINT32      Mmfr = SimRegs.MMFR.U;
+    UINT32      Op = (Mmfr & ENET_MMFR_OP_MASK) >> ENET_MMFR_OP_SHIFT;
+    UINT32      Reg = (Mmfr & ENET_MMFR_RA_MASK) >> ENET_MMFR_RA_SHIFT;
+    PMP_ADAPTER pAdapter = SimFindAdapter(Mmfr);
+
+    HOSTTEST_CHECK(pAdapter != NULL);
+    HOSTTEST_CHECK_EQ((Mmfr & ENET_MMFR_ST_MASK) >> ENET_MMFR_ST_SHIFT, ENET_MMFR_ST_VALUE);
+    HOSTTEST_CHECK_EQ((Mmfr & ENET_MMFR_TA_MASK) >> ENET_MMFR_TA_SHIFT, ENET_MMFR_TA_VALUE);
+    if (pAdapter != NULL) {
+        if (Op == ENET_MMFR_OP_READ) {
+            SimRegs.MMFR.U = (Mmfr & ~ENET_MMFR_DATA_MASK) | SimPhyRead(pAdapter, Reg);
+        } else {
+            HOSTTEST_CHECK_EQ(Op, ENET_MMFR_OP_WRITE);
+            SimPhyWrite(pAdapter, Reg, (UINT16)(Mmfr & ENET_MMFR_DATA_MASK));
+        }
+    }
+    if (SimTraceCount < SIM_TRACE_SIZE) {
+        SimTrace[SimTraceCount].PhyAddress = (Mmfr & ENET_MMFR_PA_MASK) >> ENET_MMFR_PA_SHIFT;
+        SimTrace[SimTraceCount].Op = Op;
+        SimTrace[SimTraceCount].Reg = Reg;
+    }
+    SimTraceCount++;
+    SimFrameOnBus = FALSE;
+    SimRegs.EIR.U |= ENET_EIR_MII_MASK;
+}
+
+/*
+ * MDIOBus_Main() loop body
+ */
+static void SimBusThread(void)
+{
+    MP_MDIO_FRAME   Frame;
+    MP_MDIO_DEVICE* pMDIODev;
+
+    if ((pMDIODev = MDIOBus_SeqCompleteTransfer(&SimBus, &Frame)) != NULL) {
+        if (Frame.MIIFunction) {
+            (*Frame.MIIFunction)(SimRegs.MMFR.U, (NDIS_HANDLE)pMDIODev->MDIODev_pEnetAdapter);
+        }
+    }
+    SimTimerArmed = MDIOBus_SeqStartTransfer(&SimBus);
+    if (!SimTimerArmed) {
+        HOSTTEST_CHECK_EQ(SimRegs.MSCR.U, 0);                       // MDC stopped when idle
+    }
+}
+
+// One MDIO frame time. Returns FALSE once the bus thread waits with nothing to do.
+static BOOLEAN SimBusStep(void)
+{
+    if (SimFrameOnBus) {
+        SimFrameEnd();
+    }
+    if (SimMiiInterrupt && (SimRegs.EIR.U & ENET_EIR_MII_MASK)) {   // MDIOBus_OnTransferDone()
+        if (MDIOBus_SeqOnMiiInterrupt(&SimBus)) {
+            SimEvent = TRUE;
+        }
+    }
+    if (SimEvent || (!SimMiiInterrupt && SimTimerArmed)) {          // With the MII interrupt the event always beats the timer
+        SimEvent = FALSE;
+        SimBusThread();
+        return TRUE;
+    }
+    return FALSE;
+}
+
+static ULONG SimRunBus(ULONG MaxSteps)
+{
+    ULONG Steps = 0;
+
+    while ((Steps < MaxSteps) && SimBusStep()) {
+        Steps++;
+    }
+    return Steps;
+}
+
+/*
+ * MDIODev_QueueCommand()
+ */
+static NTSTATUS SimQueueCommand(PMP_ADAPTER pAdapter, PENET_PHY_CMD pCmd)
+{
+    NTSTATUS Status;
+    BOOLEAN  StartTransfer;
+
+    SimLockDevice(&pAdapter->MDIODev);
+    Status = MDIODev_SeqQueueCommand(&pAdapter->MDIODev, pCmd, &StartTransfer);
+    SimUnlockDevice(&pAdapter->MDIODev);
+    if (StartTransfer) {
+        SimEvent = TRUE;
+    }
+    return Status;
+}
+
+/*
+ * Callbacks, as EnetParse_MII_S, EnetParsePHYLink and EnetParse_MII_LPA
+ */
+static void SimParse_MII_S(UINT RegVal, NDIS_HANDLE MiniportAdapterHandle)
+{
+    PHYDev_SeqParseStatus(&((PMP_ADAPTER)MiniportAdapterHandle)->PHYDev, RegVal);
+}
+
+static void SimParsePHYLink(UINT RegVal, NDIS_HANDLE MiniportAdapterHandle)
+{
+    PMP_ADAPTER pAdapter = (PMP_ADAPTER)MiniportAdapterHandle;
+
+    UNREFERENCED_PARAMETER(RegVal);
+    if (PHYDev_SeqParseLink(&pAdapter->PHYDev, pAdapter->MediaConnectState, pAdapter->Gigabit, &pAdapter->ECR)) {
+        pAdapter->LinkUpdateRequested = TRUE;                       // SmRequestLinkUpdate()
+    }
+}
+
+static void SimParse_MII_LPA(UINT RegVal, NDIS_HANDLE MiniportAdapterHandle)
+{
+    PMP_ADAPTER pAdapter = (PMP_ADAPTER)MiniportAdapterHandle;
+
+    if (pAdapter->PHYDev.PHYDev_PhyStatus.B.AN_COMPLETE) {
+        pAdapter->PHYDev.PHYDev_DuplexMode = (RegVal & (MII_REG_ANLPAR_100BASETX_FD | MII_REG_ANLPAR_10BASETX_FD)) ? MediaDuplexStateFull : MediaDuplexStateHalf;
+    }
+}
+
+static void SimRecord(UINT RegVal, NDIS_HANDLE MiniportAdapterHandle)
+{
+    PMP_ADAPTER pAdapter = (PMP_ADAPTER)MiniportAdapterHandle;
+
+    if (pAdapter->RecordedCount < SIM_RECORD_SIZE) {
+        pAdapter->Recorded[pAdapter->RecordedCount] = (UINT16)(RegVal & ENET_MMFR_DATA_MASK);
+    }
+    pAdapter->RecordedCount++;
+}
+
+/*
+ * MpSmDispatcher() in the RUNNING state: PHYDev_UpdateLinkStatus() and MpUpdateLinkStatus()
+ */
+static void SimSmTick(PMP_ADAPTER pAdapter)
+{
+    PENET_PHY_CMD CmdLists[MDIO_SEQ_LINK_CMD_LISTS_MAX];
+    ULONG         Count;
+
+    pAdapter->LinkUpdateRequested = FALSE;
+    Count = PHYDev_SeqGetLinkCommands(&pAdapter->PHYDev, pAdapter->MediaConnectState, SimCmdLink, CmdLists);
+    for (ULONG i = 0; i < Count; ++i) {
+        HOSTTEST_CHECK_EQ(SimQueueCommand(pAdapter, CmdLists[i]), NDIS_STATUS_SUCCESS);
+    }
+    if (pAdapter->MediaConnectState != pAdapter->PHYDev.PHYDev_MediaConnectState) {
+        pAdapter->MediaConnectState = pAdapter->PHYDev.PHYDev_MediaConnectState;
+        pAdapter->LinkChanges++;
+    }
+}
+
+// Runs the bus and the link update requests until nothing is left to do.
+static void SimSettle(void)
+{
+    for (ULONG n = 0; n < SIM_SETTLE_MAX; ++n) {
+        BOOLEAN Requested = FALSE;
+
+        HOSTTEST_CHECK(SimRunBus(SIM_BUS_STEPS_MAX) < SIM_BUS_STEPS_MAX);
+        for (ULONG i = 0; i < SimAdapterCount; ++i) {
+            if (SimAdapters[i].LinkUpdateRequested) {
+                SimSmTick(&SimAdapters[i]);
+                Requested = TRUE;
+            }
+        }
+        if (!Requested) {
+            return;
+        }
+    }
+    HOSTTEST_CHECK(!"link update requests do not settle");
+}
+
+// Check period of the state machine.
+static void SimPeriods(ULONG Count)
+{
+    while (Count--) {
+        for (ULONG i = 0; i < SimAdapterCount; ++i) {
+            SimPhyTime(&SimAdapters[i]);
+        }
+        for (ULONG i = 0; i < SimAdapterCount; ++i) {
+            SimSmTick(&SimAdapters[i]);
+        }
+        SimSettle();
+    }
+}
+
+static void SimInit(BOOLEAN MiiInterrupt)
+{
+    RtlZeroMemory(&SimBus, sizeof(SimBus));
+    RtlZeroMemory(&SimRegs, sizeof(SimRegs));
+    RtlZeroMemory(SimAdapters, sizeof(SimAdapters));
+    SimBus.MDIOBus_pRegBase = &SimRegs;
+    SimAdapterCount = 0;
+    SimMiiInterrupt = MiiInterrupt;
+    SimEvent = FALSE;
+    SimTimerArmed = FALSE;
+    SimFrameOnBus = FALSE;
+    SimDeviceLocks = 0;
+    SimTraceCount = 0;
+}
+
+// MDIODev_InitDevice() and the PHY part of MpInitializeEx().
+static PMP_ADAPTER SimAddAdapter(LONG PhyAddress, MP_PHY_INFO *pPhyInfo)
+{
+    PMP_ADAPTER pAdapter = &SimAdapters[SimAdapterCount++];
+    MP_MDIO_DEVICE *pMDIODev = &pAdapter->MDIODev;
+
+    pMDIODev->MDIODev_pBus = &SimBus;
+    pMDIODev->MDIODev_EnetPhyAddress = BIT_FIELD_VAL(ENET_MMFR_PA, PhyAddress);
+    pMDIODev->MDIODev_pEnetAdapter = pAdapter;
+    pMDIODev->MDIODev_MSCR.U = 0x1A;
+    MDIODev_SeqInitFrameLists(pMDIODev);
+    if (SimBus.MDIOBus_pFirstDevice == NULL) {
+        SimBus.MDIOBus_pFirstDevice = pMDIODev;
+    } else {
+        SimAdapters[SimAdapterCount - 2].MDIODev.MDIODev_pNextDevice = pMDIODev;
+    }
+
+    pAdapter->PHYDev.PHYDev_pMDIODev = pMDIODev;
+    pAdapter->PHYDev.PHYDev_PhySettings = pPhyInfo;
+    pAdapter->PHYDev.PHYDev_MediaConnectState = MediaConnectStateUnknown;
+    pAdapter->PHYDev.PHYDev_MIISeqDone = TRUE;
+    pAdapter->PHYDev.PHYDev_LPApause = PHY_LPA_INIT;
+    pAdapter->MediaConnectState = MediaConnectStateUnknown;
+
+    pAdapter->Phy.Regs[MII_REG_CR] = MII_REG_CR_AN_ENABLE;
+    pAdapter->Phy.Regs[MII_REG_PHYIR1] = 0x004D;
+    pAdapter->Phy.Regs[MII_REG_PHYIR2] = 0xD074;
+    pAdapter->Phy.Regs[MII_REG_ANAR] = 0x01E1;
+    pAdapter->Phy.PartnerAbility = 0x45E1;
+    if (pPhyInfo->PhyIntEnable) {
+        HOSTTEST_CHECK_EQ(SimQueueCommand(pAdapter, pPhyInfo->PhyIntEnable), NDIS_STATUS_SUCCESS);
+    }
+    return pAdapter;
+}
+
+static ULONG SimFrameListLength(MP_MDIO_FRAME *pFrame)
+{
+    ULONG Length = 0;
+
+    for (; pFrame != NULL; pFrame = pFrame->MDIOFrm_pNextFrame) {
+        Length++;
+    }
+    return Length;
+}
+
+// Everything done: no frame lost or pending, the sequence ended, the PHY interrupt released.
+static void SimCheckIdle(PMP_ADAPTER pAdapter)
+{
+    HOSTTEST_CHECK(!SimFrameOnBus);
+    HOSTTEST_CHECK(!SimBus.MDIOBus_TransferInProgress);
+    HOSTTEST_CHECK_EQ(SimDeviceLocks, 0);
+    HOSTTEST_CHECK_EQ(SimFrameListLength(pAdapter->MDIODev.MDIODev_pFreeFrameListHead), MDIO_FRAME_LIST_SIZE);
+    HOSTTEST_CHECK(pAdapter->MDIODev.MDIODev_pPendingFrameListHead == NULL);
+    HOSTTEST_CHECK(pAdapter->PHYDev.PHYDev_MIISeqDone);
+    HOSTTEST_CHECK(!pAdapter->Phy.IntLine);
+    HOSTTEST_CHECK_EQ(pAdapter->PHYDev.PHYDev_IntPending, 0);
+    HOSTTEST_CHECK(!pAdapter->LinkUpdateRequested);
+}
+
+// Brings the link up and checks it is reported only once auto-negotiation is complete.
+static void SimConnect(PMP_ADAPTER pAdapter)
+{
+    SimPhySetCable(pAdapter, TRUE);
+    SimSettle();
+    for (ULONG i = 1; i < SIM_AN_PERIODS; ++i) {
+        SimPeriods(1);
+        HOSTTEST_CHECK_EQ(pAdapter->MediaConnectState, MediaConnectStateDisconnected);
+        HOSTTEST_CHECK_EQ(pAdapter->PHYDev.PHYDev_PhyStatus.B.AN_COMPLETE, 0);
+    }
+    SimPeriods(1);
+    HOSTTEST_CHECK_EQ(pAdapter->MediaConnectState, MediaConnectStateConnected);
+    HOSTTEST_CHECK_EQ(pAdapter->PHYDev.PHYDev_PhyStatus.B.AN_COMPLETE, 1);
+}
+
+/*
+ * Tests
+ */
+
+// Cable plugged after start: the link is reported once auto-negotiation is done, the PHY interrupt brings it up before
+// the next check period.
+static void TestAutoNegLinkUp(void)
+{
+    for (int Mode = 0; Mode < 2; ++Mode) {
+        SimInit(Mode == 0);
+        PMP_ADAPTER pAdapter = SimAddAdapter(1, &SimPhyInfoInt);
+
+        pAdapter->Gigabit = TRUE;
+        SimSettle();
+        HOSTTEST_CHECK_EQ(pAdapter->Phy.Regs[SIM_REG_INT_EN], SIM_INT_LINK_FAIL | SIM_INT_LINK_SUCCESS);
+
+        SimPeriods(1);
+        HOSTTEST_CHECK_EQ(pAdapter->MediaConnectState, MediaConnectStateDisconnected);
+        HOSTTEST_CHECK_EQ(pAdapter->ECR & ENET_ECR_SPEED_MASK, 0);
+
+        SimPhySetCable(pAdapter, TRUE);
+        SimPeriods(SIM_AN_PERIODS - 1);
+        HOSTTEST_CHECK_EQ(pAdapter->MediaConnectState, MediaConnectStateDisconnected);
+
+        SimPhyTime(pAdapter);                                       // AN completes between two periods
+        HOSTTEST_CHECK(pAdapter->Phy.IntLine);
+        SimSettle();
+        HOSTTEST_CHECK_EQ(pAdapter->MediaConnectState, MediaConnectStateConnected);
+        HOSTTEST_CHECK_EQ(pAdapter->PHYDev.PHYDev_DuplexMode, MediaDuplexStateFull);
+        HOSTTEST_CHECK(pAdapter->ECR & ENET_ECR_SPEED_MASK);
+        HOSTTEST_CHECK_EQ(pAdapter->LinkChanges, 2);                // Unknown -> Disconnected -> Connected
+        SimCheckIdle(pAdapter);
+
+        SimPeriods(3);                                              // Steady state: nothing changes
+        HOSTTEST_CHECK_EQ(pAdapter->LinkChanges, 2);
+        SimCheckIdle(pAdapter);
+    }
+}
+
+// Auto-negotiation without a common technology does not bring the link up. A new advertisement followed by an
+// auto-negotiation restart does, and the link is not reported while the restarted negotiation runs.
+static void TestAutoNegAdvertisement(void)
+{
+    static ENET_PHY_CMD Advertise100[] = {
+        {MII_WRITE_COMMAND(MII_REG_ANAR, 0x0181), NULL},
+        {ENET_MII_END,                            NULL}
+    };
+
+    SimInit(TRUE);
+    PMP_ADAPTER pAdapter = SimAddAdapter(4, &SimPhyInfoInt);
+
+    pAdapter->Phy.PartnerAbility = 0x0061;                          // 10BASE-T only
+    HOSTTEST_CHECK_EQ(SimQueueCommand(pAdapter, Advertise100), NDIS_STATUS_SUCCESS);
+    SimSettle();
+    HOSTTEST_CHECK_EQ(pAdapter->Phy.Regs[MII_REG_ANAR], 0x0181);
+
+    SimPhySetCable(pAdapter, TRUE);
+    SimPeriods(SIM_AN_PERIODS + 2);
+    HOSTTEST_CHECK_EQ(pAdapter->MediaConnectState, MediaConnectStateDisconnected);
+    HOSTTEST_CHECK_EQ(pAdapter->PHYDev.PHYDev_PhyStatus.B.AN_COMPLETE, 1);
+    HOSTTEST_CHECK_EQ(pAdapter->PHYDev.PHYDev_PhyStatus.B.LINK_DETECTED, 0);
+
+    HOSTTEST_CHECK_EQ(SimQueueCommand(pAdapter, SimCmdRestartAN), NDIS_STATUS_SUCCESS);
+    SimSettle();
+    HOSTTEST_CHECK_EQ(pAdapter->Phy.Regs[MII_REG_ANAR], 0x01E1);
+    HOSTTEST_CHECK_EQ(pAdapter->Phy.Regs[MII_REG_CR] & MII_REG_CR_RESTART_AN, 0);
+    HOSTTEST_CHECK_EQ(pAdapter->Phy.AnCountdown, SIM_AN_PERIODS);
+
+    SimPeriods(1);
+    HOSTTEST_CHECK_EQ(pAdapter->MediaConnectState, MediaConnectStateDisconnected);
+    HOSTTEST_CHECK_EQ(pAdapter->PHYDev.PHYDev_PhyStatus.B.AN_COMPLETE, 0);
+
+    SimPeriods(SIM_AN_PERIODS - 1);
+    HOSTTEST_CHECK_EQ(pAdapter->MediaConnectState, MediaConnectStateConnected);
+    HOSTTEST_CHECK_EQ(pAdapter->Phy.Regs[MII_REG_ANLPAR], 0x0061);
+    SimCheckIdle(pAdapter);
+}
+
+// Repeated unplug/plug, with the MII interrupt and with the timer fallback. Each change is reported, the PHY interrupt
+// is acknowledged every time so no edge is lost, and no frame leaks.
+static void TestLinkFlap(void)
+{
+    for (int Mode = 0; Mode < 2; ++Mode) {
+        SimInit(Mode == 0);
+        PMP_ADAPTER pAdapter = SimAddAdapter(1, &SimPhyInfoInt);
+
+        pAdapter->Gigabit = TRUE;
+        SimSettle();
+        SimPeriods(1);
+        SimConnect(pAdapter);
+        HOSTTEST_CHECK(pAdapter->ECR & ENET_ECR_SPEED_MASK);
+
+        for (ULONG Flap = 0; Flap < 4; ++Flap) {
+            ULONG Changes = pAdapter->LinkChanges;
+            ULONG Edges = pAdapter->Phy.IntEdges;
+
+            SimPhySetCable(pAdapter, FALSE);
+            SimSettle();                                            // PHY interrupt, no check period needed
+            HOSTTEST_CHECK_EQ(pAdapter->Phy.IntEdges, Edges + 1);
+            HOSTTEST_CHECK_EQ(pAdapter->MediaConnectState, MediaConnectStateDisconnected);
+            HOSTTEST_CHECK_EQ(pAdapter->ECR & ENET_ECR_SPEED_MASK, 0);
+            SimCheckIdle(pAdapter);
+
+            SimConnect(pAdapter);
+            HOSTTEST_CHECK_EQ(pAdapter->Phy.IntEdges, Edges + 2);
+            HOSTTEST_CHECK_EQ(pAdapter->LinkChanges, Changes + 2);
+            HOSTTEST_CHECK(pAdapter->ECR & ENET_ECR_SPEED_MASK);
+            SimCheckIdle(pAdapter);
+        }
+    }
+}
+
+// A link drop while the link sequence is on the bus: the update request made by the PHY ISR cannot start a new sequence,
+// the pending interrupt makes the running sequence request another one, which acknowledges the interrupt and reports
+// the drop.
+static void TestLinkFlapDuringSequence(void)
+{
+    for (int Mode = 0; Mode < 2; ++Mode) {
+        SimInit(Mode == 0);
+        PMP_ADAPTER pAdapter = SimAddAdapter(1, &SimPhyInfoInt);
+
+        SimSettle();
+        SimPeriods(1);
+        SimConnect(pAdapter);
+
+        for (ULONG Steps = 0; Steps < 3; ++Steps) {
+            SimSmTick(pAdapter);                                    // PHYCmdLink queued
+            HOSTTEST_CHECK(!pAdapter->PHYDev.PHYDev_MIISeqDone);
+            SimRunBus(Steps);
+
+            SimPhySetCable(pAdapter, FALSE);                        // PHY ISR
+            HOSTTEST_CHECK(pAdapter->LinkUpdateRequested);
+            SimSmTick(pAdapter);                                    // Link update DPC while the sequence runs
+            HOSTTEST_CHECK_EQ(pAdapter->PHYDev.PHYDev_IntPending, 1);
+            HOSTTEST_CHECK(pAdapter->Phy.IntLine);
+
+            SimSettle();
+            HOSTTEST_CHECK_EQ(pAdapter->MediaConnectState, MediaConnectStateDisconnected);
+            SimCheckIdle(pAdapter);
+
+            SimConnect(pAdapter);
+            SimCheckIdle(pAdapter);
+        }
+    }
+}
+
+// Without the PHY interrupt the link is polled. A drop and recovery between two check periods is still reported, as
+// the Status register latches the link failure until it is read.
+static void TestLinkFlapPolled(void)
+{
+    SimInit(TRUE);
+    PMP_ADAPTER pAdapter = SimAddAdapter(1, &SimPhyInfoPoll);
+
+    SimPeriods(1);
+    SimPhySetCable(pAdapter, TRUE);
+    SimPeriods(SIM_AN_PERIODS);
+    HOSTTEST_CHECK_EQ(pAdapter->MediaConnectState, MediaConnectStateConnected);
+    HOSTTEST_CHECK_EQ(pAdapter->Phy.IntEdges, 0);
+
+    ULONG Changes = pAdapter->LinkChanges;
+
+    SimPhySetCable(pAdapter, FALSE);
+    SimPhySetCable(pAdapter, TRUE);
+    for (ULONG i = 0; i < SIM_AN_PERIODS; ++i) {
+        SimPhyTime(pAdapter);
+    }
+    HOSTTEST_CHECK(pAdapter->Phy.LinkUp);
+    HOSTTEST_CHECK(!pAdapter->LinkUpdateRequested);
+
+    SimSmTick(pAdapter);
+    SimSettle();
+    HOSTTEST_CHECK_EQ(pAdapter->MediaConnectState, MediaConnectStateConnected);
+    HOSTTEST_CHECK_EQ(pAdapter->LinkChanges, Changes + 2);          // Drop reported, then the link again
+    SimCheckIdle(pAdapter);
+}
+
+// Two PHYs on one bus are served one frame each in turn, a device with a longer list finishes alone.
+static void TestRoundRobin(void)
+{
+    static ENET_PHY_CMD Read6[] = {
+        {MII_READ_COMMAND(MII_REG_PHYIR1), SimRecord},
+        {MII_READ_COMMAND(MII_REG_PHYIR2), SimRecord},
+        {MII_READ_COMMAND(MII_REG_PHYIR1), SimRecord},
+        {MII_READ_COMMAND(MII_REG_PHYIR2), SimRecord},
+        {MII_READ_COMMAND(MII_REG_PHYIR1), SimRecord},
+        {MII_READ_COMMAND(MII_REG_PHYIR2), SimRecord},
+        {ENET_MII_END,                     NULL}
+    };
+    static ENET_PHY_CMD Read2[] = {
+        {MII_READ_COMMAND(MII_REG_PHYIR1), SimRecord},
+        {MII_READ_COMMAND(MII_REG_PHYIR2), SimRecord},
+        {ENET_MII_END,                     NULL}
+    };
+    static const UINT32 Expected[] = { 1, 2, 1, 2, 1, 1, 1, 1 };
+
+    for (int Mode = 0; Mode < 2; ++Mode) {
+        SimInit(Mode == 0);
+        PMP_ADAPTER pAdapter0 = SimAddAdapter(1, &SimPhyInfoPoll);
+        PMP_ADAPTER pAdapter1 = SimAddAdapter(2, &SimPhyInfoPoll);
+
+        pAdapter1->Phy.Regs[MII_REG_PHYIR2] = 0xD072;
+        HOSTTEST_CHECK_EQ(SimQueueCommand(pAdapter0, Read6), NDIS_STATUS_SUCCESS);
+        HOSTTEST_CHECK_EQ(SimQueueCommand(pAdapter1, Read2), NDIS_STATUS_SUCCESS);
+        SimSettle();
+
+        HOSTTEST_CHECK_EQ(SimTraceCount, ARRAYSIZE(Expected));
+        for (ULONG i = 0; (i < ARRAYSIZE(Expected)) && (i < SimTraceCount); ++i) {
+            HOSTTEST_CHECK_EQ(SimTrace[i].PhyAddress, Expected[i]);
+            HOSTTEST_CHECK_EQ(SimTrace[i].Op, ENET_MMFR_OP_READ);
+        }
+        HOSTTEST_CHECK_EQ(pAdapter0->RecordedCount, 6);
+        HOSTTEST_CHECK_EQ(pAdapter1->RecordedCount, 2);
+        for (ULONG i = 0; i < 6; ++i) {
+            HOSTTEST_CHECK_EQ(pAdapter0->Recorded[i], (i & 1) ? 0xD074 : 0x004D);
+        }
+        HOSTTEST_CHECK_EQ(pAdapter1->Recorded[1], 0xD072);
+        SimCheckIdle(pAdapter0);
+        SimCheckIdle(pAdapter1);
+    }
+}
+
+// A command is queued whole or not at all, a failed attempt leaves both frame lists as they were.
+static void TestQueueAllOrNothing(void)
+{
+    ENET_PHY_CMD Cmd[MDIO_FRAME_LIST_SIZE + 1];
+
+    SimInit(TRUE);
+    PMP_ADAPTER pAdapter = SimAddAdapter(3, &SimPhyInfoPoll);
+    MP_MDIO_DEVICE *pMDIODev = &pAdapter->MDIODev;
+
+    for (ULONG i = 0; i < MDIO_FRAME_LIST_SIZE; ++i) {
+        Cmd[i].MIIData = MII_READ_COMMAND(MII_REG_PHYIR1);
+        Cmd[i].MIIFunct = SimRecord;
+    }
+    Cmd[MDIO_FRAME_LIST_SIZE].MIIData = ENET_MII_END;
+    Cmd[MDIO_FRAME_LIST_SIZE].MIIFunct = NULL;
+
+    // 60 frames queued, 4 left
+    for (ULONG i = 0; i < 6; ++i) {
+        HOSTTEST_CHECK_EQ(SimQueueCommand(pAdapter, &Cmd[MDIO_FRAME_LIST_SIZE - 10]), NDIS_STATUS_SUCCESS);
+    }
+    HOSTTEST_CHECK(SimEvent);
+    MP_MDIO_FRAME *pTail = pMDIODev->MDIODev_pPendingFrameListTail;
+
+    HOSTTEST_CHECK_EQ(SimQueueCommand(pAdapter, &Cmd[MDIO_FRAME_LIST_SIZE - 5]), NDIS_STATUS_RESOURCES);
+    HOSTTEST_CHECK_EQ(SimFrameListLength(pMDIODev->MDIODev_pFreeFrameListHead), 4);
+    HOSTTEST_CHECK_EQ(SimFrameListLength(pMDIODev->MDIODev_pPendingFrameListHead), 60);
+    HOSTTEST_CHECK(pMDIODev->MDIODev_pPendingFrameListTail == pTail);
+    HOSTTEST_CHECK(pTail->MDIOFrm_pNextFrame == NULL);
+
+    HOSTTEST_CHECK_EQ(SimQueueCommand(pAdapter, &Cmd[MDIO_FRAME_LIST_SIZE - 4]), NDIS_STATUS_SUCCESS);
+    HOSTTEST_CHECK(pMDIODev->MDIODev_pFreeFrameListHead == NULL);
+    HOSTTEST_CHECK_EQ(SimQueueCommand(pAdapter, &Cmd[MDIO_FRAME_LIST_SIZE]), NDIS_STATUS_SUCCESS);     // Empty command
+    HOSTTEST_CHECK_EQ(SimQueueCommand(pAdapter, &Cmd[MDIO_FRAME_LIST_SIZE - 1]), NDIS_STATUS_RESOURCES);
+
+    SimSettle();
+    HOSTTEST_CHECK_EQ(SimTraceCount, MDIO_FRAME_LIST_SIZE);
+    HOSTTEST_CHECK_EQ(pAdapter->RecordedCount, MDIO_FRAME_LIST_SIZE);
+    SimCheckIdle(pAdapter);
+
+    // The whole list fits once the frames are back
+    HOSTTEST_CHECK_EQ(SimQueueCommand(pAdapter, Cmd), NDIS_STATUS_SUCCESS);
+    SimSettle();
+    HOSTTEST_CHECK_EQ(pAdapter->RecordedCount, 2 * MDIO_FRAME_LIST_SIZE);
+    SimCheckIdle(pAdapter);
+}
+
+// The MII interrupt ends only the frame in progress. A flag left over while the bus is idle neither completes the
+// next frame before it has been sent, nor loses its callback.
+static void TestStaleMiiFlag(void)
+{
+    static ENET_PHY_CMD Read1[] = {
+        {MII_READ_COMMAND(MII_REG_PHYIR2), SimRecord},
+        {ENET_MII_END,                     NULL}
+    };
+
+    for (int Mode = 0; Mode < 2; ++Mode) {
+        SimInit(Mode == 0);
+        PMP_ADAPTER pAdapter0 = SimAddAdapter(1, &SimPhyInfoPoll);
+        PMP_ADAPTER pAdapter1 = SimAddAdapter(2, &SimPhyInfoPoll);
+
+        HOSTTEST_CHECK_EQ(SimQueueCommand(pAdapter0, Read1), NDIS_STATUS_SUCCESS);
+        SimSettle();
+        HOSTTEST_CHECK(SimBus.MDIOBus_pActiveDevice == &pAdapter1->MDIODev);   // Next round-robin candidate
+
+        SimRegs.EIR.U |= ENET_EIR_MII_MASK;
+        HOSTTEST_CHECK(!MDIOBus_SeqOnMiiInterrupt(&SimBus));
+        HOSTTEST_CHECK(!SimBus.MDIOBus_TransferDone);
+
+        HOSTTEST_CHECK_EQ(SimQueueCommand(pAdapter1, Read1), NDIS_STATUS_SUCCESS);
+        SimSettle();
+        HOSTTEST_CHECK_EQ(SimTraceCount, 2);
+        HOSTTEST_CHECK_EQ(pAdapter0->RecordedCount, 1);
+        HOSTTEST_CHECK_EQ(pAdapter1->RecordedCount, 1);
+        HOSTTEST_CHECK_EQ(pAdapter1->Recorded[0], 0xD074);
+        SimCheckIdle(pAdapter0);
+        SimCheckIdle(pAdapter1);
+    }
+}
+
+int main(void)
+{
+    HOSTTEST_RUN(TestAutoNegLinkUp);
+    HOSTTEST_RUN(TestAutoNegAdvertisement);
+    HOSTTEST_RUN(TestLinkFlap);
+    HOSTTEST_RUN(TestLinkFlapDuringSequence);
+    HOSTTEST_RUN(TestLinkFlapPolled);
+    HOSTTEST_RUN(TestRoundRobin);
+    HOSTTEST_RUN(TestQueueAllOrNothing);
+    HOSTTEST_RUN(TestStaleMiiFlag);
+
+    return HostTestExit();
+}
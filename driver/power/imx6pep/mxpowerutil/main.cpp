@@ -584,6 +584,136 @@ int HandleSetGateCommand (int argc, _In_reads_(argc) wchar_t *argv[])
     return 0;
 }
 
+PCWSTR StringFromMx6ClkNode (MX6_CLK_NODE Node)
+{
+    switch (Node) {
+    case MX6_CLK_NODE_I2C1: return L"I2C1";
+    case MX6_CLK_NODE_I2C2: return L"I2C2";
+    case MX6_CLK_NODE_I2C3: return L"I2C3";
+    case MX6_CLK_NODE_ECSPI1: return L"ECSPI1";
+    case MX6_CLK_NODE_ECSPI2: return L"ECSPI2";
+    case MX6_CLK_NODE_ECSPI3: return L"ECSPI3";
+    case MX6_CLK_NODE_ECSPI4: return L"ECSPI4";
+    case MX6_CLK_NODE_ECSPI5: return L"ECSPI5";
+    case MX6_CLK_NODE_UART: return L"UART";
+    case MX6_CLK_NODE_USDHC1: return L"USDHC1";
+    case MX6_CLK_NODE_USDHC2: return L"USDHC2";
+    case MX6_CLK_NODE_USDHC3: return L"USDHC3";
+    case MX6_CLK_NODE_USDHC4: return L"USDHC4";
+    case MX6_CLK_NODE_VPU: return L"VPU";
+    case MX6_CLK_NODE_SSI1: return L"SSI1";
+    case MX6_CLK_NODE_SSI2: return L"SSI2";
+    case MX6_CLK_NODE_SSI3: return L"SSI3";
+    case MX6_CLK_NODE_ASRC: return L"ASRC";
+    case MX6_CLK_NODE_ENET: return L"ENET";
+    case MX6_CLK_NODE_GPU: return L"GPU";
+    default: return L"[invalid clock node]";
+    }
+}
+
+int HandleClkNodesCommand (int argc, _In_reads_(argc) wchar_t *argv[])
+{
+    // mxpowerutil clknodes [-delay us]
+    ULONG gateDelayMicros = ULONG(-1);
+    for (int optind = 2; optind < argc; ++optind) {
+        if (_wcsicmp(argv[optind], L"-delay") == 0) {
+            ++optind;
+            if (optind == argc) {
+                fwprintf(stderr, L"Missing required parameter for -delay option\n");
+                return 1;
+            }
+
+            wchar_t* endptr;
+            gateDelayMicros = wcstoul(argv[optind], &endptr, 0);
+            if ((*endptr != L'\0') ||
+                (gateDelayMicros > MX6_CLOCK_GATE_DELAY_MAX_MICROS)) {
+
+                fwprintf(
+                    stderr,
+                    L"Invalid gate delay: %s. Must be in the range [0, %d]\n",
+                    argv[optind],
+                    MX6_CLOCK_GATE_DELAY_MAX_MICROS);
+
+                return 1;
+            }
+        } else {
+            fwprintf(stderr, L"Unrecognized option: %s.\n", argv[optind]);
+            return 1;
+        }
+    }
+
+    auto pepHandle = OpenMx6PepHandle();
+    DWORD information;
+
+    if (gateDelayMicros != ULONG(-1)) {
+        MX6PEP_SET_CLOCK_GATE_DELAY_INPUT input = {};
+        input.GateDelayMicros = gateDelayMicros;
+        if (!DeviceIoControl(
+                pepHandle.Get(),
+                IOCTL_MX6PEP_SET_CLOCK_GATE_DELAY,
+                &input,
+                sizeof(input),
+                nullptr,
+                0,
+                &information,
+                nullptr)) {
+
+            throw wexception::make(
+                HRESULT_FROM_WIN32(GetLastError()),
+                L"IOCTL_MX6PEP_SET_CLOCK_GATE_DELAY failed. "
+                L"(GetLastError() = 0x%x)",
+                GetLastError());
+        }
+    }
+
+    MX6PEP_GET_CLOCK_NODE_STATS_OUTPUT output;
+    if (!DeviceIoControl(
+            pepHandle.Get(),
+            IOCTL_MX6PEP_GET_CLOCK_NODE_STATS,
+            nullptr,
+            0,
+            &output,
+            sizeof(output),
+            &information,
+            nullptr) || (information != sizeof(output))) {
+
+        throw wexception::make(
+            HRESULT_FROM_WIN32(GetLastError()),
+            L"IOCTL_MX6PEP_GET_CLOCK_NODE_STATS failed. "
+            L"(GetLastError() = 0x%x, information = %d)",
+            GetLastError(),
+            information);
+    }
+
+    wprintf(L"Gate delay: %uus\n\n", output.GateDelayMicros);
+    wprintf(L"          Node  Refs  State    Ungated      Gated  Cancelled\n");
+    for (int i = 0; i < MX6_CLK_NODE_MAX; ++i) {
+        const MX6PEP_CLOCK_NODE_STATS& node = output.Nodes[i];
+        wprintf(
+            L"%14s  %4u  %-5s %10u %10u %10u\n",
+            StringFromMx6ClkNode(static_cast<MX6_CLK_NODE>(i)),
+            node.RefCount,
+            node.Ungated ? L"on" : L"off",
+            node.UngateCount,
+            node.GateCount,
+            node.GateCancelCount);
+    }
+
+    wprintf(L"\n         Clock  Refs\n");
+    for (int i = 0; i < MX6_CLK_MAX; ++i) {
+        if (output.ClockRefCount[i] == 0) {
+            continue;
+        }
+
+        wprintf(
+            L"%14s  %4u\n",
+            StringFromMx6Clk(static_cast<MX6_CLK>(i)),
+            output.ClockRefCount[i]);
+    }
+
+    return 0;
+}
+
 //
 // MMDC Profiling
 //
@@ -801,6 +931,259 @@ int HandleDdrProfCommand (int argc, _In_reads_(argc) wchar_t *argv[])
     return 0;
 }
 
+//
+// Background MMDC sampling
+//
+
+volatile bool DdrMonitorStopRequested;
+
+BOOL WINAPI DdrMonitorCtrlHandler (DWORD CtrlType)
+{
+    switch (CtrlType) {
+    case CTRL_C_EVENT:
+    case CTRL_BREAK_EVENT:
+        DdrMonitorStopRequested = true;
+        return TRUE;
+    default:
+        return FALSE;
+    }
+}
+
+void ConfigureMmdcSampling (
+    HANDLE PepHandle,
+    bool ProfileAllDevices,
+    unsigned int IntervalMillis
+    )
+{
+    static_assert(
+        MX6_AXI_ID::_COUNT <= MX6_MMDC_SAMPLING_FILTER_MAX,
+        "Verifying every AXI ID fits in the sampling filter list");
+
+    MX6PEP_CONFIGURE_MMDC_SAMPLING_INPUT input = {};
+    input.IntervalMillis = IntervalMillis;
+
+    if (ProfileAllDevices) {
+        for (int i = MX6_AXI_ID::ALL_DEVICES; i < MX6_AXI_ID::_COUNT; ++i) {
+            const auto axiFilter = GetAxiFilter(static_cast<MX6_AXI_ID>(i));
+            input.Filters[i].AxiId = axiFilter.AxiId;
+            input.Filters[i].AxiIdMask = axiFilter.AxiIdMask;
+        }
+
+        input.FilterCount = MX6_AXI_ID::_COUNT;
+    }
+
+    DWORD information;
+    if (!DeviceIoControl(
+            PepHandle,
+            IOCTL_MX6PEP_CONFIGURE_MMDC_SAMPLING,
+            &input,
+            sizeof(input),
+            nullptr,
+            0,
+            &information,
+            nullptr)) {
+
+        throw wexception::make(
+            HRESULT_FROM_WIN32(GetLastError()),
+            L"IOCTL_MX6PEP_CONFIGURE_MMDC_SAMPLING failed. "
+            L"(GetLastError() = 0x%x)",
+            GetLastError());
+    }
+}
+
+PCWSTR StringFromAxiFilter (const MX6PEP_MMDC_AXI_FILTER& Filter)
+{
+    for (int i = MX6_AXI_ID::ALL_DEVICES; i < MX6_AXI_ID::_COUNT; ++i) {
+        const auto axiId = static_cast<MX6_AXI_ID>(i);
+        const auto axiFilter = GetAxiFilter(axiId);
+        if ((axiFilter.AxiId == Filter.AxiId) &&
+            (axiFilter.AxiIdMask == Filter.AxiIdMask)) {
+
+            return StringFromAxiId(axiId);
+        }
+    }
+
+    return L"[Custom filter]";
+}
+
+void PrintMmdcSample (
+    const MX6PEP_GET_MMDC_SAMPLES_OUTPUT& Output,
+    const MX6PEP_MMDC_SAMPLE& Sample,
+    ULONGLONG BaseTime
+    )
+{
+    PCWSTR block = L"[Invalid filter]";
+    if (Sample.FilterIndex < Output.FilterCount) {
+        block = StringFromAxiFilter(Output.Filters[Sample.FilterIndex]);
+    }
+
+    const double seconds = (Sample.Timestamp - BaseTime) / 10000000.0;
+    const double busy = (Sample.TotalProfilingCount == 0) ? 0.0 :
+        100.0 * Sample.BusyCycleCount / Sample.TotalProfilingCount;
+
+    // bytes per microsecond is decimal MB/s
+    const double micros =
+        (Sample.DurationMicros == 0) ? 1.0 : double(Sample.DurationMicros);
+
+    wprintf(
+        L"%10.3f %14s %6.1f%% %11.2f %12.2f%s\n",
+        seconds,
+        block,
+        busy,
+        Sample.BytesRead / micros,
+        Sample.BytesWritten / micros,
+        ((Sample.Flags & MX6PEP_MMDC_SAMPLE_FLAG_OVERFLOW) != 0) ?
+            L" (overflow)" : L"");
+}
+
+//
+// Print samples as they are collected until sampling stops or Ctrl+C is
+// pressed. If HistoryOnly is true, print the samples collected so far and
+// return.
+//
+void MonitorMmdc (HANDLE PepHandle, bool HistoryOnly)
+{
+    const DWORD bufferSize =
+        FIELD_OFFSET(MX6PEP_GET_MMDC_SAMPLES_OUTPUT, Samples) +
+        (MX6_MMDC_SAMPLE_RING_LENGTH * sizeof(MX6PEP_MMDC_SAMPLE));
+
+    std::unique_ptr<BYTE[]> buffer(new BYTE[bufferSize]);
+    auto outputPtr =
+        reinterpret_cast<MX6PEP_GET_MMDC_SAMPLES_OUTPUT*>(buffer.get());
+
+    MX6PEP_GET_MMDC_SAMPLES_INPUT input = {};
+    ULONGLONG baseTime = 0;
+    bool haveBaseTime = false;
+
+    wprintf(L"   Time(s)          Block    Busy  Read(MB/s)  Write(MB/s)\n");
+
+    for (;;) {
+        DWORD information;
+        if (!DeviceIoControl(
+                PepHandle,
+                IOCTL_MX6PEP_GET_MMDC_SAMPLES,
+                &input,
+                sizeof(input),
+                outputPtr,
+                bufferSize,
+                &information,
+                nullptr)) {
+
+            throw wexception::make(
+                HRESULT_FROM_WIN32(GetLastError()),
+                L"IOCTL_MX6PEP_GET_MMDC_SAMPLES failed. "
+                L"(GetLastError() = 0x%x)",
+                GetLastError());
+        }
+
+        if ((input.SessionId != 0) && (outputPtr->SessionId != input.SessionId)) {
+            wprintf(L"Sampling was restarted by another client.\n");
+        }
+
+        if (outputPtr->LostCount != 0) {
+            wprintf(L"  (%d samples lost)\n", outputPtr->LostCount);
+        }
+
+        for (ULONG i = 0; i < outputPtr->SampleCount; ++i) {
+            const MX6PEP_MMDC_SAMPLE& sample = outputPtr->Samples[i];
+            if (!haveBaseTime) {
+                baseTime = sample.Timestamp - (sample.DurationMicros * 10ULL);
+                haveBaseTime = true;
+            }
+
+            PrintMmdcSample(*outputPtr, sample, baseTime);
+        }
+
+        input.SessionId = outputPtr->SessionId;
+        input.StartSequence = outputPtr->NextSequence;
+
+        if (HistoryOnly ||
+            (outputPtr->IntervalMillis == 0) ||
+            DdrMonitorStopRequested) {
+
+            break;
+        }
+
+        Sleep(outputPtr->IntervalMillis);
+    }
+}
+
+int HandleDdrMonCommand (int argc, _In_reads_(argc) wchar_t *argv[])
+{
+    // mxpowerutil ddrmon [-all] [-detach] [-history] [-stop] [ms]
+    bool all = false;
+    bool detach = false;
+    bool history = false;
+    bool stop = false;
+    int optind;
+    for (optind = 2; optind < argc; ++optind) {
+        if (argv[optind][0] != L'-') {
+            break;
+        }
+
+        if (_wcsicmp(argv[optind], L"-all") == 0) {
+            all = true;
+        } else if (_wcsicmp(argv[optind], L"-detach") == 0) {
+            detach = true;
+        } else if (_wcsicmp(argv[optind], L"-history") == 0) {
+            history = true;
+        } else if (_wcsicmp(argv[optind], L"-stop") == 0) {
+            stop = true;
+        } else {
+            fwprintf(
+                stderr,
+                L"Invalid option: '%s'. Run mxpowerutil /? for usage.\n",
+                argv[optind]);
+
+            return 1;
+        }
+    }
+
+    unsigned int interval;
+    if (optind < argc) {
+        interval = wcstoul(argv[optind], nullptr, 10);
+        if ((interval < MX6_MMDC_SAMPLING_INTERVAL_MIN) ||
+            (interval > MX6_MMDC_SAMPLING_INTERVAL_MAX)) {
+
+            fwprintf(
+                stderr,
+                L"Invalid sampling interval: '%s'. "
+                "Please specify an integer between %d and %d.\n",
+                argv[optind],
+                MX6_MMDC_SAMPLING_INTERVAL_MIN,
+                MX6_MMDC_SAMPLING_INTERVAL_MAX);
+
+            return 1;
+        }
+    } else {
+        // default sampling interval is 1s
+        interval = 1000;
+    }
+
+    auto pepHandle = OpenMx6PepHandle();
+
+    if (stop) {
+        ConfigureMmdcSampling(pepHandle.Get(), false, 0);
+        return 0;
+    }
+
+    if (history) {
+        MonitorMmdc(pepHandle.Get(), true);
+        return 0;
+    }
+
+    ConfigureMmdcSampling(pepHandle.Get(), all, interval);
+    if (detach) {
+        return 0;
+    }
+
+    SetConsoleCtrlHandler(DdrMonitorCtrlHandler, TRUE);
+    MonitorMmdc(pepHandle.Get(), false);
+    ConfigureMmdcSampling(pepHandle.Get(), false, 0);
+
+    return 0;
+}
+
 void PinOutClock (HANDLE PepHandle, MX6_CLK Clock, ULONG Divider)
 {
     enum : ULONG { CCOSR_DIVIDER_MAX = 8 };
@@ -1792,18 +2175,142 @@ int HandleDumpCommand (int argc, _In_reads_(argc) wchar_t * /*argv*/ [])
     return 0;
 }
 
+void PrintIdleStateStats (PCWSTR Name, const MX6PEP_IDLE_STATE_STATS& Stats)
+{
+    if (Stats.EntryCount == 0) {
+        return;
+    }
+
+    wprintf(
+        L"    %-12s %12llu %14llu %10llu\n",
+        Name,
+        Stats.EntryCount,
+        Stats.TotalResidencyMicros / 1000,
+        Stats.TotalResidencyMicros / Stats.EntryCount);
+
+    for (ULONG i = 0; i < ARRAYSIZE(Stats.ResidencyHistogram); ++i) {
+        if (Stats.ResidencyHistogram[i] == 0) {
+            continue;
+        }
+
+        if (i == 0) {
+            wprintf(L"                 < 1us: %u\n", Stats.ResidencyHistogram[i]);
+        } else if (i == (ARRAYSIZE(Stats.ResidencyHistogram) - 1)) {
+            wprintf(
+                L"          >= %10uus: %u\n",
+                1UL << (i - 1),
+                Stats.ResidencyHistogram[i]);
+        } else {
+            wprintf(
+                L"          < %11uus: %u\n",
+                1UL << i,
+                Stats.ResidencyHistogram[i]);
+        }
+    }
+}
+
+int HandleIdleCommand (int argc, _In_reads_(argc) wchar_t * /*argv*/ [])
+{
+    // mxpowerutil idle
+    if (argc > 2) {
+        fwprintf(stderr, L"Too many arguments to 'idle' command\n");
+        return 1;
+    }
+
+    auto pepHandle = OpenMx6PepHandle();
+
+    MX6PEP_GET_IDLE_STATS_OUTPUT output;
+    DWORD information;
+    if (!DeviceIoControl(
+            pepHandle.Get(),
+            IOCTL_MX6PEP_GET_IDLE_STATS,
+            nullptr,
+            0,
+            &output,
+            sizeof(output),
+            &information,
+            nullptr) || (information != sizeof(output))) {
+
+        throw wexception::make(
+            HRESULT_FROM_WIN32(GetLastError()),
+            L"IOCTL_MX6PEP_GET_IDLE_STATS failed. "
+            L"(GetLastError() = 0x%x, information = %d)",
+            GetLastError(),
+            information);
+    }
+
+    const PCWSTR processorStateNames[MX6PEP_CPU_IDLE_STATE_COUNT] = {
+        L"WFI",
+        L"WFI2",
+        L"POWER_GATED",
+    };
+
+    const PCWSTR platformStateNames[MX6PEP_PLATFORM_IDLE_STATE_COUNT] = {
+        L"WAIT",
+        L"STOP_LIGHT",
+        L"ARM_OFF",
+    };
+
+    for (ULONG cpu = 0; cpu < output.CpuCount; ++cpu) {
+        const MX6PEP_CPU_IDLE_STATS& stats = output.Cpus[cpu];
+
+        wprintf(L"CPU%u\n", cpu);
+        wprintf(L"    State             Entries  Residency(ms)  Avg(us)\n");
+        for (ULONG i = 0; i < ARRAYSIZE(stats.ProcessorStates); ++i) {
+            PrintIdleStateStats(processorStateNames[i], stats.ProcessorStates[i]);
+        }
+
+        for (ULONG i = 0; i < ARRAYSIZE(stats.PlatformStates); ++i) {
+            PrintIdleStateStats(platformStateNames[i], stats.PlatformStates[i]);
+        }
+
+        bool header = false;
+        for (ULONG i = 0; i < ARRAYSIZE(stats.PlatformWakeSourceCount); ++i) {
+            if (stats.PlatformWakeSourceCount[i] == 0) {
+                continue;
+            }
+
+            if (!header) {
+                wprintf(L"    Platform idle wake sources:\n");
+                header = true;
+            }
+
+            if (i == MX6PEP_WAKE_SOURCE_UNKNOWN) {
+                wprintf(L"        Unknown: %u\n", stats.PlatformWakeSourceCount[i]);
+            } else {
+                wprintf(L"        IRQ %3u: %u\n", i, stats.PlatformWakeSourceCount[i]);
+            }
+        }
+
+        wprintf(L"\n");
+    }
+
+    return 0;
+}
+
 void PrintUsage ()
 {
     PCWSTR Usage =
 L"mxpowerutil: IMX6 Clock and Power Utility\n"
-L"Usage: mxpowerutil [clocks|gates|setgate|ddrprof|pinout|pad|padmux|padctl|pads]\n"
+L"Usage: mxpowerutil [clocks|gates|setgate|clknodes|ddrprof|ddrmon|pinout|pad|padmux|padctl|pads|dump|idle]\n"
 L"\n"
 L" clocks                      Dump clock tree\n"
 L" gates                       Dump state of all clock gates\n"
 L" setgate gate off|on|run     Configure a clock gate to the specified state\n"
+L" clknodes [-delay us]        Dump reference counts and gate transition counts\n"
+L"                             of the clock nodes managed by the PEP\n"
+L"   -delay us                 Set how long a released node stays ungated\n"
 L" ddrprof [-all] [ms]         Run MMDC profiling. Measures DDR usage.\n"
 L"   -all                      Profile each AXI device individually\n"
 L"   ms                        Profiling duration in milliseconds (default 1000)\n"
+L" ddrmon [options] [ms]       Sample MMDC profiling counters in the background\n"
+L"                             and display DDR usage as it is collected, until\n"
+L"                             Ctrl+C is pressed.\n"
+L"   -all                      Cycle through each AXI device, one per sample\n"
+L"   -detach                   Start sampling and exit without stopping it\n"
+L"   -history                  Display the samples collected so far\n"
+L"   -stop                     Stop background sampling\n"
+L"   ms                        Sampling interval in milliseconds (default 1000)\n"
 L" pinout clock_name           Pin out clock_name / 8 on CCM_CLKO1\n"
 L" pad pad_id [options]        Dump pad settings\n"
 L"  where pad_id is pad_name|pad_hex:\n"
@@ -1826,6 +2333,7 @@ L"       60|50|40|33\n"
 L"  -sre slow|fast             Specify slew rate (default: slow)\n"
 L" pads                        Dump the friendly names of supported pads\n"
 L" dump                        Dump miscellaneous information about the CCM/GPC\n"
+L" idle                        Dump idle state residency and wake sources\n"
 L"\n"
 L"Examples:\n"
 L"  Dump all clocks:\n"
@@ -1843,6 +2351,10 @@ L"\n"
 L"  Profile each peripheral's DDR activity (takes ~30 seconds):\n"
 L"    mxpowerutil ddrprof -all\n"
 L"\n"
+L"  Record DDR activity every 100ms in the background, and display it later:\n"
+L"    mxpowerutil ddrmon -detach 100\n"
+L"    mxpowerutil ddrmon -history\n"
+L"\n"
 L"  Expose AXI_CLK_ROOT / 8 on CCM_CLKO1:\n"
 L"    mxpowerutil pinout AXI_CLK_ROOT\n"
 L"\n"
@@ -1887,8 +2399,12 @@ int mainexcpt (_In_ int argc, _In_reads_(argc) wchar_t* argv[])
         return 0;
     } else if (!_wcsicmp(command, L"setgate")) {
         return HandleSetGateCommand(argc, argv);
+    } else if (!_wcsicmp(command, L"clknodes")) {
+        return HandleClkNodesCommand(argc, argv);
     } else if (!_wcsicmp(command, L"ddrprof")) {
         return HandleDdrProfCommand(argc, argv);
+    } else if (!_wcsicmp(command, L"ddrmon")) {
+        return HandleDdrMonCommand(argc, argv);
     } else if (!_wcsicmp(command, L"pinout")) {
         return HandlePinoutCommand(argc, argv);
     } else if (!_wcsicmp(command, L"pad")) {
@@ -1901,6 +2417,8 @@ int mainexcpt (_In_ int argc, _In_reads_(argc) wchar_t* argv[])
         return HandlePadsCommand(argc, argv);
     } else if (!_wcsicmp(command, L"dump")) {
         return HandleDumpCommand(argc, argv);
+    } else if (!_wcsicmp(command, L"idle")) {
+        return HandleIdleCommand(argc, argv);
     } else {
         fwprintf(
             stderr,
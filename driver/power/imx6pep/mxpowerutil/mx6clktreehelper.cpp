@@ -15,6 +15,7 @@
 #include <winioctl.h>
 #include <mx6pephw.h>
 #include <mx6pepioctl.h>
+#include <mx6clktree.h>
 #include "util.h"
 #include "mx6clktreehelper.h"
 
@@ -141,21 +142,20 @@ HRESULT Mx6ClockTreeHelper::GetClockInfo (
     return hr;
 }
 
-MX6_CLK Mx6ClockTreeHelper::MX6ClkFromBypassClkSource (
-    MX6_PLL_BYPASS_CLK_SRC BypassClockSource
-    )
+//
+// The clock tree topology is shared with the PEP, see mx6clktree.h
+//
+MX6_CLK Mx6ClockTreeHelper::GetParent (MX6_CLK ClockId)
 {
-    switch (BypassClockSource) {
-    case MX6_PLL_BYPASS_CLK_SRC_REF_CLK_24M: return MX6_OSC_CLK;
-    case MX6_PLL_BYPASS_CLK_SRC_CLK1: return MX6_CLK1;
-    case MX6_PLL_BYPASS_CLK_SRC_CLK2: return MX6_CLK2;
-    case MX6_PLL_BYPASS_CLK_SRC_XOR:
-    default:
+    const MX6_CLK parent = Mx6ClkTreeGetParent(this->registers, ClockId);
+    if (parent == MX6_CLK_MAX) {
         throw wexception::make(
             E_INVALIDARG,
-            L"Invalid MX6_PLL_BYPASS_CLK_SRC value. (BypassClockSource = %d)",
-            BypassClockSource);
+            L"Clock mux holds an invalid value. (ClockId = %d)",
+            ClockId);
     }
+
+    return parent;
 }
 
 _Use_decl_annotations_
@@ -171,8 +171,7 @@ HRESULT Mx6ClockTreeHelper::GetPll1MainClkInfo (MX6_CLK_INFO* ClockInfoPtr)
     const MX6_CCM_ANALOG_PLL_ARM_REG pllArmReg =
         {this->registers.Analog.PLL_ARM};
 
-    const MX6_CLK parent = this->MX6ClkFromBypassClkSource(
-            static_cast<MX6_PLL_BYPASS_CLK_SRC>(pllArmReg.BYPASS_CLK_SRC));
+    const MX6_CLK parent = this->GetParent(MX6_PLL1_MAIN_CLK);
 
     MX6_CLK_INFO parentInfo;
     HRESULT hr = this->GetClockInfo(parent, &parentInfo);
@@ -201,8 +200,7 @@ HRESULT Mx6ClockTreeHelper::GetPll2MainClkInfo (MX6_CLK_INFO* ClockInfoPtr)
         {this->registers.Analog.PLL_SYS};
 
     // Determine the reference clock source
-    const MX6_CLK parent = this->MX6ClkFromBypassClkSource (
-        static_cast<MX6_PLL_BYPASS_CLK_SRC>(pllSysReg.BYPASS_CLK_SRC));
+    const MX6_CLK parent = this->GetParent(MX6_PLL2_MAIN_CLK);
 
     MX6_CLK_INFO parentInfo;
     HRESULT hr = this->GetClockInfo(parent, &parentInfo);
@@ -283,8 +281,7 @@ HRESULT Mx6ClockTreeHelper::GetPll3MainClkInfo (MX6_CLK_INFO* ClockInfoPtr)
     const MX6_CCM_ANALOG_PLL_USB1_REG pllUsb1Reg =
         {this->registers.Analog.PLL_USB1};
 
-    const MX6_CLK parent = this->MX6ClkFromBypassClkSource (
-        static_cast<MX6_PLL_BYPASS_CLK_SRC>(pllUsb1Reg.BYPASS_CLK_SRC));
+    const MX6_CLK parent = this->GetParent(MX6_PLL3_MAIN_CLK);
 
     MX6_CLK_INFO parentInfo;
     HRESULT hr = this->GetClockInfo(parent, &parentInfo);
@@ -359,13 +356,9 @@ HRESULT Mx6ClockTreeHelper::GetPll3PfdClkInfo (
 _Use_decl_annotations_
 HRESULT Mx6ClockTreeHelper::GetPll3SwClkInfo (MX6_CLK_INFO* ClockInfoPtr)
 {
-    const MX6_CCM_CCSR_REG ccsrReg =
-        {this->registers.Ccm.CCSR};
-
-    MX6_CLK parent;
-    if (ccsrReg.pll3_sw_clk_sel == MX6_CCM_PLL3_SW_CLK_SEL_PLL3_MAIN_CLK) {
-        parent = MX6_PLL3_MAIN_CLK;
-    } else {
+    // Only the PLL3 main clock input is modeled
+    const MX6_CLK parent = Mx6ClkTreeGetParent(this->registers, MX6_PLL3_SW_CLK);
+    if (parent == MX6_CLK_MAX) {
         return E_NOTIMPL;
     }
 
@@ -401,12 +394,7 @@ HRESULT Mx6ClockTreeHelper::GetAxiClkRootInfo (MX6_CLK_INFO* ClockInfoPtr)
     const MX6_CCM_CBCDR_REG cbcdrReg =
         {this->registers.Ccm.CBCDR};
 
-    MX6_CLK parent;
-    if (cbcdrReg.axi_sel == MX6_CCM_AXI_SEL_PERIPH_CLK) {
-        parent = MX6_PERIPH_CLK;
-    } else {
-        parent = MX6_AXI_ALT;
-    }
+    const MX6_CLK parent = this->GetParent(MX6_AXI_CLK_ROOT);
 
     MX6_CLK_INFO parentInfo;
     HRESULT hr = this->GetClockInfo(parent, &parentInfo);
@@ -426,15 +414,7 @@ HRESULT Mx6ClockTreeHelper::GetPeriphClkInfo (MX6_CLK_INFO* ClockInfoPtr)
     const MX6_CCM_CBCDR_REG cbcdrReg =
         {this->registers.Ccm.CBCDR};
 
-    MX6_CLK parent;
-
-    // NOTE: periph_clk_sel is OR'd with PLL_bypass_en2 (from jtag) to
-    //       produce the input value to the MUX. We assume PLL_bypass_en2 is 0.
-    if (cbcdrReg.periph_clk_sel == 0) {
-        parent = MX6_PRE_PERIPH_CLK;
-    } else {
-        parent = MX6_PERIPH_CLK2;
-    }
+    const MX6_CLK parent = this->GetParent(MX6_PERIPH_CLK);
 
     MX6_CLK_INFO parentInfo;
     HRESULT hr = this->GetClockInfo(parent, &parentInfo);
@@ -454,26 +434,7 @@ HRESULT Mx6ClockTreeHelper::GetPrePeriphClkInfo (MX6_CLK_INFO* ClockInfoPtr)
     const MX6_CCM_CBCMR_REG cbcmrReg =
         {this->registers.Ccm.CBCMR};
 
-    MX6_CLK parent;
-    switch (cbcmrReg.pre_periph_clk_sel) {
-    case MX6_CCM_PRE_PERIPH_CLK_SEL_PLL2:
-        parent = MX6_PLL2_MAIN_CLK;
-        break;
-    case MX6_CCM_PRE_PERIPH_CLK_SEL_PLL2_PFD2:
-        parent = MX6_PLL2_PFD2;
-        break;
-    case MX6_CCM_PRE_PERIPH_CLK_SEL_PLL2_PFD0:
-        parent = MX6_PLL2_PFD0;
-        break;
-    case MX6_CCM_PRE_PERIPH_CLK_SEL_PLL2_PFD2_DIV2:
-        parent = MX6_PLL2_PFD2;
-        break;
-    default:
-        throw wexception::make(
-            E_INVALIDARG,
-            L"cbcmrReg.pre_periph_clk_sel is invalid (%d)",
-            cbcmrReg.pre_periph_clk_sel);
-    }
+    const MX6_CLK parent = this->GetParent(MX6_PRE_PERIPH_CLK);
 
     MX6_CLK_INFO parentInfo;
     HRESULT hr = this->GetClockInfo(parent, &parentInfo);
@@ -495,26 +456,7 @@ HRESULT Mx6ClockTreeHelper::GetPrePeriphClkInfo (MX6_CLK_INFO* ClockInfoPtr)
 _Use_decl_annotations_
 HRESULT Mx6ClockTreeHelper::GetPeriphClk2Info (MX6_CLK_INFO* ClockInfoPtr)
 {
-    const MX6_CCM_CBCMR_REG cbcmrReg =
-        {this->registers.Ccm.CBCMR};
-
-    MX6_CLK parent;
-    switch (cbcmrReg.periph_clk2_sel) {
-    case MX6_CCM_PERIPH_CLK2_SEL_PLL3_SW_CLK:
-        parent = MX6_PLL3_SW_CLK;
-        break;
-    case MX6_CCM_PERIPH_CLK2_SEL_OSC_CLK:
-        parent = MX6_OSC_CLK;
-        break;
-    case MX6_CCM_PERIPH_CLK2_SEL_PLL2:
-        parent = MX6_PLL2_MAIN_CLK;
-        break;
-    default:
-        throw wexception::make(
-            E_INVALIDARG,
-            L"cbcmrReg.periph_clk2_sel is invalid (%d)",
-            cbcmrReg.periph_clk2_sel);
-    }
+    const MX6_CLK parent = this->GetParent(MX6_PERIPH_CLK2);
 
     const MX6_CCM_CBCDR_REG cbcdrReg =
         {this->registers.Ccm.CBCDR};
@@ -636,35 +578,26 @@ HRESULT Mx6ClockTreeHelper::GetUsdhcClkRootInfo (
             Index);
     }
 
-    // get muxing info from CSCMR1 : usdhcN_clk_sel
-    const MX6_CCM_CSCMR1_REG cscmr1Reg =
-        {this->registers.Ccm.CSCMR1};
-
     // get divider into from CSCDR1 : usdhcN_podf
     const MX6_CCM_CSCDR1_REG cscdr1Reg =
         {this->registers.Ccm.CSCDR1};
 
-    ULONG clockSel;
     ULONG podf;
     MX6_CLK_GATE gate;
     switch (Index) {
     case 0:
-        clockSel = cscmr1Reg.usdhc1_clk_sel;
         podf = cscdr1Reg.usdhc1_podf;
         gate = MX6_USDHC1_CLK_ENABLE;
         break;
     case 1:
-        clockSel = cscmr1Reg.usdhc2_clk_sel;
         podf = cscdr1Reg.usdhc2_podf;
         gate = MX6_USDHC2_CLK_ENABLE;
         break;
     case 2:
-        clockSel = cscmr1Reg.usdhc3_clk_sel;
         podf = cscdr1Reg.usdhc3_podf;
         gate = MX6_USDHC3_CLK_ENABLE;
         break;
     case 3:
-        clockSel = cscmr1Reg.usdhc4_clk_sel;
         podf = cscdr1Reg.usdhc4_podf;
         gate = MX6_USDHC4_CLK_ENABLE;
         break;
@@ -672,12 +605,8 @@ HRESULT Mx6ClockTreeHelper::GetUsdhcClkRootInfo (
         return E_FAIL;
     }
 
-    MX6_CLK parent;
-    if (clockSel == MX6_CCM_USDHC_CLK_SEL_PLL2_PFD2) {
-        parent = MX6_PLL2_PFD2;
-    } else {
-        parent = MX6_PLL2_PFD0;
-    }
+    const MX6_CLK parent =
+        this->GetParent(static_cast<MX6_CLK>(MX6_USDHC1_CLK_ROOT + Index));
 
     MX6_CLK_INFO parentInfo;
     HRESULT hr = this->GetClockInfo(parent, &parentInfo);
@@ -705,23 +634,15 @@ HRESULT Mx6ClockTreeHelper::GetSsiClkRootInfo (
             Index);
     }
 
-    // Get muxing info from CSCMR1[ssiN_clk_sel]
-    const MX6_CCM_CSCMR1_REG cscmr1Reg =
-        {this->registers.Ccm.CSCMR1};
-
-    ULONG clockSel;
     MX6_CLK_GATE gate;
     switch (Index) {
     case 0:
-        clockSel = cscmr1Reg.ssi1_clk_sel;
         gate = MX6_SSI1_CLK_ENABLE;
         break;
     case 1:
-        clockSel = cscmr1Reg.ssi2_clk_sel;
         gate = MX6_SSI2_CLK_ENABLE;
         break;
     case 2:
-        clockSel = cscmr1Reg.ssi3_clk_sel;
         gate = MX6_SSI3_CLK_ENABLE;
         break;
     default:
@@ -751,23 +672,8 @@ HRESULT Mx6ClockTreeHelper::GetSsiClkRootInfo (
         }
     }
 
-    MX6_CLK parent;
-    switch (clockSel) {
-    case MX6_CCM_SSI_CLK_SEL_PLL3_PFD2:
-        parent = MX6_PLL3_PFD2;
-        break;
-    case MX6_CCM_SSI_CLK_SEL_PLL3_PFD3:
-        parent = MX6_PLL3_PFD3;
-        break;
-    case MX6_CCM_SSI_CLK_SEL_PLL4:
-        parent = MX6_PLL4_MAIN_CLK;
-        break;
-    default:
-        throw wexception::make(
-            E_INVALIDARG,
-            L"Invalid clock selection value (clockSel = %u)",
-            clockSel);
-    }
+    const MX6_CLK parent =
+        this->GetParent(static_cast<MX6_CLK>(MX6_SSI1_CLK_ROOT + Index));
 
     MX6_CLK_INFO parentInfo;
     HRESULT hr = this->GetClockInfo(parent, &parentInfo);
@@ -786,15 +692,7 @@ HRESULT Mx6ClockTreeHelper::GetSsiClkRootInfo (
 _Use_decl_annotations_
 HRESULT Mx6ClockTreeHelper::GetGpu2dAxiClkRootInfo (MX6_CLK_INFO* ClockInfoPtr)
 {
-    const MX6_CCM_CBCMR_REG cbcmrReg =
-        {this->registers.Ccm.CBCMR};
-
-    MX6_CLK parent;
-    if (cbcmrReg.gpu2d_axi_clk_sel == MX6_CCM_GPU2D_AXI_CLK_SEL_AXI) {
-        parent = MX6_AXI_CLK_ROOT;
-    } else {
-        parent = MX6_AHB_CLK_ROOT;
-    }
+    const MX6_CLK parent = this->GetParent(MX6_GPU2D_AXI_CLK_ROOT);
 
     MX6_CLK_INFO parentInfo;
     HRESULT hr = this->GetClockInfo(parent, &parentInfo);
@@ -811,14 +709,7 @@ HRESULT Mx6ClockTreeHelper::GetGpu2dAxiClkRootInfo (MX6_CLK_INFO* ClockInfoPtr)
 _Use_decl_annotations_
 HRESULT Mx6ClockTreeHelper::GetGpu3dAxiClkRootInfo (MX6_CLK_INFO* ClockInfoPtr)
 {
-    const MX6_CCM_CBCMR_REG cbcmrReg = {this->registers.Ccm.CBCMR};
-
-    MX6_CLK parent;
-    if (cbcmrReg.gpu3d_axi_clk_sel == MX6_CCM_GPU3D_AXI_CLK_SEL_AXI) {
-        parent = MX6_AXI_CLK_ROOT;
-    } else {
-        parent = MX6_AHB_CLK_ROOT;
-    }
+    const MX6_CLK parent = this->GetParent(MX6_GPU3D_AXI_CLK_ROOT);
 
     MX6_CLK_INFO parentInfo;
     HRESULT hr = this->GetClockInfo(parent, &parentInfo);
@@ -838,26 +729,7 @@ HRESULT Mx6ClockTreeHelper::GetGpu2dCoreClkInfo (MX6_CLK_INFO* ClockInfoPtr)
     const MX6_CCM_CBCMR_REG cbcmrReg =
         {this->registers.Ccm.CBCMR};
 
-    MX6_CLK parent;
-    switch (cbcmrReg.gpu2d_core_clk_sel) {
-    case MX6_CCM_GPU2D_CORE_CLK_SEL_AXI:
-        parent = MX6_AXI_CLK_ROOT;
-        break;
-    case MX6_CCM_GPU2D_CORE_CLK_SEL_PLL3_SW:
-        parent = MX6_PLL3_SW_CLK;
-        break;
-    case MX6_CCM_GPU2D_CORE_CLK_SEL_PLL2_PFD0:
-        parent = MX6_PLL2_PFD0;
-        break;
-    case MX6_CCM_GPU2D_CORE_CLK_SEL_PLL2_PFD2:
-        parent = MX6_PLL2_PFD2;
-        break;
-    default:
-        throw wexception::make(
-            E_INVALIDARG,
-            L"cbcmrReg.gpu2d_core_clk_sel is invalid (%d)",
-            cbcmrReg.gpu2d_core_clk_sel);
-    }
+    const MX6_CLK parent = this->GetParent(MX6_GPU2D_CORE_CLK_ROOT);
 
     MX6_CLK_INFO parentInfo;
     HRESULT hr = this->GetClockInfo(parent, &parentInfo);
@@ -879,26 +751,7 @@ HRESULT Mx6ClockTreeHelper::GetGpu3dCoreClkInfo (MX6_CLK_INFO* ClockInfoPtr)
     const MX6_CCM_CBCMR_REG cbcmrReg =
         {this->registers.Ccm.CBCMR};
 
-    MX6_CLK parent;
-    switch (cbcmrReg.gpu3d_core_clk_sel) {
-    case MX6_CCM_GPU3D_CORE_CLK_SEL_MMDC_CH0_AXI:
-        parent = MX6_MMDC_CH0_CLK_ROOT;
-        break;
-    case MX6_CCM_GPU3D_CORE_CLK_SEL_PLL3_SW:
-        parent = MX6_PLL3_SW_CLK;
-        break;
-    case MX6_CCM_GPU3D_CORE_CLK_SEL_PLL2_PFD1:
-        parent = MX6_PLL2_PFD1;
-        break;
-    case MX6_CCM_GPU3D_CORE_CLK_SEL_PLL2_PFD2:
-        parent = MX6_PLL2_PFD2;
-        break;
-    default:
-        throw wexception::make(
-            E_INVALIDARG,
-            L"cbcmrReg.gpu3d_core_clk_sel is invalid (%d)",
-            cbcmrReg.gpu3d_core_clk_sel);
-    }
+    const MX6_CLK parent = this->GetParent(MX6_GPU3D_CORE_CLK_ROOT);
 
     MX6_CLK_INFO parentInfo;
     HRESULT hr = this->GetClockInfo(parent, &parentInfo);
@@ -918,26 +771,7 @@ HRESULT Mx6ClockTreeHelper::GetGpu3dShaderClkInfo (MX6_CLK_INFO* ClockInfoPtr)
     const MX6_CCM_CBCMR_REG cbcmrReg =
         {this->registers.Ccm.CBCMR};
 
-    MX6_CLK parent;
-    switch (cbcmrReg.gpu3d_shader_clk_sel) {
-    case MX6_CCM_GPU3D_SHADER_CLK_SEL_MMDC_CH0_AXI:
-        parent = MX6_MMDC_CH0_CLK_ROOT;
-        break;
-    case MX6_CCM_GPU3D_SHADER_CLK_SEL_PLL3_SW:
-        parent = MX6_PLL3_SW_CLK;
-        break;
-    case MX6_CCM_GPU3D_SHADER_CLK_SEL_PLL2_PFD1:
-        parent = MX6_PLL2_PFD1;
-        break;
-    case MX6_CCM_GPU3D_SHADER_CLK_SEL_PLL3_PFD0:
-        parent = MX6_PLL3_PFD0;
-        break;
-    default:
-        throw wexception::make(
-            E_INVALIDARG,
-            L"cbcmrReg.gpu3d_shader_clk_sel is invalid (%d)",
-            cbcmrReg.gpu3d_shader_clk_sel);
-    }
+    const MX6_CLK parent = this->GetParent(MX6_GPU3D_SHADER_CLK_ROOT);
 
     MX6_CLK_INFO parentInfo;
     HRESULT hr = this->GetClockInfo(parent, &parentInfo);
@@ -975,26 +809,7 @@ HRESULT Mx6ClockTreeHelper::GetUartClkRootInfo (MX6_CLK_INFO* ClockInfoPtr)
 _Use_decl_annotations_
 HRESULT Mx6ClockTreeHelper::GetVpuAxiClkInfo (MX6_CLK_INFO* ClockInfoPtr)
 {
-    const MX6_CCM_CBCMR_REG cbcmrReg =
-        {this->registers.Ccm.CBCMR};
-
-    MX6_CLK parent;
-    switch (cbcmrReg.vpu_axi_clk_sel) {
-    case VPU_AXI_CLK_SEL_AXI_CLK_ROOT:
-        parent = MX6_AXI_CLK_ROOT;
-        break;
-    case VPU_AXI_CLK_SEL_PLL2_PFD2:
-        parent = MX6_PLL2_PFD2;
-        break;
-    case VPU_AXI_CLK_SEL_PLL2_PFD0:
-        parent = MX6_PLL2_PFD0;
-        break;
-    default:
-        throw wexception::make(
-            E_INVALIDARG,
-            L"cbcmrReg.vpu_axi_clk_sel is invalid. (%d)",
-            cbcmrReg.vpu_axi_clk_sel);
-    }
+    const MX6_CLK parent = this->GetParent(MX6_VPU_AXI_CLK_ROOT);
 
     MX6_CLK_INFO parentInfo;
     HRESULT hr = this->GetClockInfo(parent, &parentInfo);
@@ -39,9 +39,7 @@ private:
         MX6_PLL_PFD3,
     };
 
-    static MX6_CLK MX6ClkFromBypassClkSource (
-        MX6_PLL_BYPASS_CLK_SRC BypassClockSource
-        );
+    MX6_CLK GetParent (MX6_CLK ClockId);
 
     static void GetOsc24ClkInfo (_Out_ MX6_CLK_INFO* ClockInfo);
 
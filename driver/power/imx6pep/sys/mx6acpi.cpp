@@ -19,6 +19,8 @@
 #include "mx6peputil.h"
 #include "mx6pepioctl.h"
 #include "mx6pephw.h"
+#include "mx6dvfs.h"
+#include "mx6clktree.h"
 #include "mx6pep.h"
 
 MX6_NONPAGED_SEGMENT_BEGIN; //==============================================
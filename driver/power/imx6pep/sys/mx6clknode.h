@@ -0,0 +1,116 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+//
+// Module Name:
+//
+//   mx6clknode.h
+//
+// Abstract:
+//
+//   IMX6 clock node descriptions. A clock node is the set of CCGR gates a
+//   block needs in order to run, and the clock root that feeds the block.
+//   The clocks between the root and its source are not listed here; they
+//   are resolved from the clock muxes with Mx6ClkTreeGetParent() when the
+//   node is ungated. Nodes are reference counted by
+//   MX6_PEP::referenceClockNode() and MX6_PEP::unreferenceClockNode().
+//
+
+#ifndef _MX6CLKNODE_H_
+#define _MX6CLKNODE_H_
+
+enum : ULONG { MX6_CLK_NODE_GATE_COUNT_MAX = 3 };
+
+struct MX6_CLK_NODE_DESCRIPTOR {
+    MX6_CLK Root;
+    ULONG GateCount;
+    MX6_CLK_GATE Gates[MX6_CLK_NODE_GATE_COUNT_MAX];    // Ungated and gated in this order
+};
+
+//
+// Indexed by MX6_CLK_NODE. A single pair of gates clocks all UART
+// instances. Blocks whose serial clock has no root of its own in MX6_CLK
+// (I2C, ASRC, ENET) list the bus clock root they are fed from.
+//
+static const MX6_CLK_NODE_DESCRIPTOR Mx6ClkNodeDescriptors[] = {
+    // MX6_CLK_NODE_I2C1
+    { MX6_PERCLK_CLK_ROOT, 1, { MX6_I2C1_SERIAL_CLK_ENABLE } },
+
+    // MX6_CLK_NODE_I2C2
+    { MX6_PERCLK_CLK_ROOT, 1, { MX6_I2C2_SERIAL_CLK_ENABLE } },
+
+    // MX6_CLK_NODE_I2C3
+    { MX6_PERCLK_CLK_ROOT, 1, { MX6_I2C3_SERIAL_CLK_ENABLE } },
+
+    // MX6_CLK_NODE_ECSPI1
+    { MX6_ECSPI_CLK_ROOT, 1, { MX6_ECSPI1_CLK_ENABLE } },
+
+    // MX6_CLK_NODE_ECSPI2
+    { MX6_ECSPI_CLK_ROOT, 1, { MX6_ECSPI2_CLK_ENABLE } },
+
+    // MX6_CLK_NODE_ECSPI3
+    { MX6_ECSPI_CLK_ROOT, 1, { MX6_ECSPI3_CLK_ENABLE } },
+
+    // MX6_CLK_NODE_ECSPI4
+    { MX6_ECSPI_CLK_ROOT, 1, { MX6_ECSPI4_CLK_ENABLE } },
+
+    // MX6_CLK_NODE_ECSPI5
+    { MX6_ECSPI_CLK_ROOT, 1, { MX6_ECSPI5_CLK_ENABLE } },
+
+    // MX6_CLK_NODE_UART
+    {
+        MX6_UART_CLK_ROOT,
+        2,
+        {
+            MX6_UART_CLK_ENABLE,
+            MX6_UART_SERIAL_CLK_ENABLE,
+        },
+    },
+
+    // MX6_CLK_NODE_USDHC1
+    { MX6_USDHC1_CLK_ROOT, 1, { MX6_USDHC1_CLK_ENABLE } },
+
+    // MX6_CLK_NODE_USDHC2
+    { MX6_USDHC2_CLK_ROOT, 1, { MX6_USDHC2_CLK_ENABLE } },
+
+    // MX6_CLK_NODE_USDHC3
+    { MX6_USDHC3_CLK_ROOT, 1, { MX6_USDHC3_CLK_ENABLE } },
+
+    // MX6_CLK_NODE_USDHC4
+    { MX6_USDHC4_CLK_ROOT, 1, { MX6_USDHC4_CLK_ENABLE } },
+
+    // MX6_CLK_NODE_VPU
+    { MX6_VPU_AXI_CLK_ROOT, 1, { MX6_VPU_CLK_ENABLE } },
+
+    // MX6_CLK_NODE_SSI1
+    { MX6_SSI1_CLK_ROOT, 1, { MX6_SSI1_CLK_ENABLE } },
+
+    // MX6_CLK_NODE_SSI2
+    { MX6_SSI2_CLK_ROOT, 1, { MX6_SSI2_CLK_ENABLE } },
+
+    // MX6_CLK_NODE_SSI3
+    { MX6_SSI3_CLK_ROOT, 1, { MX6_SSI3_CLK_ENABLE } },
+
+    // MX6_CLK_NODE_ASRC
+    { MX6_IPG_CLK_ROOT, 1, { MX6_ASRC_CLK_ENABLE } },
+
+    // MX6_CLK_NODE_ENET
+    { MX6_IPG_CLK_ROOT, 1, { MX6_ENET_CLK_ENABLE } },
+
+    // MX6_CLK_NODE_GPU
+    {
+        MX6_GPU3D_CORE_CLK_ROOT,
+        3,
+        {
+            MX6_GPU3D_CLK_ENABLE,
+            MX6_GPU2D_CLK_ENABLE,
+            MX6_OPENVGAXICLK_CLK_ROOT_ENABLE,
+        },
+    },
+};
+
+static_assert(
+    ARRAYSIZE(Mx6ClkNodeDescriptors) == MX6_CLK_NODE_MAX,
+    "Mx6ClkNodeDescriptors must have an entry for each MX6_CLK_NODE");
+
+#endif // _MX6CLKNODE_H_
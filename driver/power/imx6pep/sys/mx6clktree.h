@@ -0,0 +1,278 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+//
+// Module Name:
+//
+//   mx6clktree.h
+//
+// Abstract:
+//
+//   IMX6 clock tree topology. Resolves the parent of a clock from the
+//   current values of the CCM and CCM Analog mux registers. Shared by the
+//   PEP, which uses it to find the clocks feeding a clock node, and by
+//   mxpowerutil, which also computes frequencies. Must not throw or
+//   allocate, so that it can run at DISPATCH_LEVEL.
+//
+
+#ifndef _MX6CLKTREE_H_
+#define _MX6CLKTREE_H_
+
+//
+// Longest chain from a clock root to MX6_OSC_CLK, e.g.
+// PERCLK -> IPG -> AHB -> PERIPH -> PRE_PERIPH -> PLL2_PFD2 -> PLL2 -> OSC
+//
+enum : ULONG { MX6_CLK_TREE_DEPTH_MAX = 8 };
+
+inline MX6_CLK Mx6ClkTreeParentFromBypassClkSource (ULONG BypassClockSource)
+{
+    switch (BypassClockSource) {
+    case MX6_PLL_BYPASS_CLK_SRC_REF_CLK_24M: return MX6_OSC_CLK;
+    case MX6_PLL_BYPASS_CLK_SRC_CLK1: return MX6_CLK1;
+    case MX6_PLL_BYPASS_CLK_SRC_CLK2: return MX6_CLK2;
+    default: return MX6_CLK_MAX;
+    }
+}
+
+//
+// Returns the parent of ClockId, MX6_CLK_NONE if ClockId is a source
+// clock, or MX6_CLK_MAX if ClockId is not modeled or its mux holds a
+// reserved value.
+//
+inline MX6_CLK Mx6ClkTreeGetParent (
+    const MX6PEP_DUMP_REGISTERS_OUTPUT& Registers,
+    MX6_CLK ClockId
+    )
+{
+    switch (ClockId) {
+    case MX6_OSC_CLK:
+        return MX6_CLK_NONE;
+
+    case MX6_PLL1_MAIN_CLK:
+    {
+        const MX6_CCM_ANALOG_PLL_ARM_REG pllArmReg = {Registers.Analog.PLL_ARM};
+        return Mx6ClkTreeParentFromBypassClkSource(pllArmReg.BYPASS_CLK_SRC);
+    }
+
+    case MX6_PLL2_MAIN_CLK:
+    {
+        const MX6_CCM_ANALOG_PLL_SYS_REG pllSysReg = {Registers.Analog.PLL_SYS};
+        return Mx6ClkTreeParentFromBypassClkSource(pllSysReg.BYPASS_CLK_SRC);
+    }
+
+    case MX6_PLL3_MAIN_CLK:
+    {
+        const MX6_CCM_ANALOG_PLL_USB1_REG pllUsb1Reg =
+            {Registers.Analog.PLL_USB1};
+
+        return Mx6ClkTreeParentFromBypassClkSource(pllUsb1Reg.BYPASS_CLK_SRC);
+    }
+
+    case MX6_PLL2_PFD0:
+    case MX6_PLL2_PFD1:
+    case MX6_PLL2_PFD2:
+        return MX6_PLL2_MAIN_CLK;
+
+    case MX6_PLL3_PFD0:
+    case MX6_PLL3_PFD1:
+    case MX6_PLL3_PFD2:
+    case MX6_PLL3_PFD3:
+        return MX6_PLL3_MAIN_CLK;
+
+    case MX6_PLL3_SW_CLK:
+    {
+        const MX6_CCM_CCSR_REG ccsrReg = {Registers.Ccm.CCSR};
+        if (ccsrReg.pll3_sw_clk_sel == MX6_CCM_PLL3_SW_CLK_SEL_PLL3_MAIN_CLK) {
+            return MX6_PLL3_MAIN_CLK;
+        }
+
+        return MX6_CLK_MAX;
+    }
+
+    case MX6_PLL3_80M:
+        return MX6_PLL3_SW_CLK;
+
+    case MX6_AXI_CLK_ROOT:
+    {
+        const MX6_CCM_CBCDR_REG cbcdrReg = {Registers.Ccm.CBCDR};
+        if (cbcdrReg.axi_sel == MX6_CCM_AXI_SEL_PERIPH_CLK) {
+            return MX6_PERIPH_CLK;
+        }
+
+        return MX6_AXI_ALT;
+    }
+
+    case MX6_PERIPH_CLK:
+    {
+        // periph_clk_sel is OR'd with PLL_bypass_en2 (from jtag) to produce
+        // the input value to the MUX. PLL_bypass_en2 is assumed to be 0.
+        const MX6_CCM_CBCDR_REG cbcdrReg = {Registers.Ccm.CBCDR};
+        if (cbcdrReg.periph_clk_sel == 0) {
+            return MX6_PRE_PERIPH_CLK;
+        }
+
+        return MX6_PERIPH_CLK2;
+    }
+
+    case MX6_PRE_PERIPH_CLK:
+    {
+        const MX6_CCM_CBCMR_REG cbcmrReg = {Registers.Ccm.CBCMR};
+        switch (cbcmrReg.pre_periph_clk_sel) {
+        case MX6_CCM_PRE_PERIPH_CLK_SEL_PLL2: return MX6_PLL2_MAIN_CLK;
+        case MX6_CCM_PRE_PERIPH_CLK_SEL_PLL2_PFD2: return MX6_PLL2_PFD2;
+        case MX6_CCM_PRE_PERIPH_CLK_SEL_PLL2_PFD0: return MX6_PLL2_PFD0;
+        case MX6_CCM_PRE_PERIPH_CLK_SEL_PLL2_PFD2_DIV2: return MX6_PLL2_PFD2;
+        default: return MX6_CLK_MAX;
+        }
+    }
+
+    case MX6_PERIPH_CLK2:
+    {
+        const MX6_CCM_CBCMR_REG cbcmrReg = {Registers.Ccm.CBCMR};
+        switch (cbcmrReg.periph_clk2_sel) {
+        case MX6_CCM_PERIPH_CLK2_SEL_PLL3_SW_CLK: return MX6_PLL3_SW_CLK;
+        case MX6_CCM_PERIPH_CLK2_SEL_OSC_CLK: return MX6_OSC_CLK;
+        case MX6_CCM_PERIPH_CLK2_SEL_PLL2: return MX6_PLL2_MAIN_CLK;
+        default: return MX6_CLK_MAX;
+        }
+    }
+
+    case MX6_ARM_CLK_ROOT:
+        return MX6_PLL1_MAIN_CLK;
+
+    case MX6_MMDC_CH0_CLK_ROOT:
+    case MX6_AHB_CLK_ROOT:
+        return MX6_PERIPH_CLK;
+
+    case MX6_IPG_CLK_ROOT:
+        return MX6_AHB_CLK_ROOT;
+
+    case MX6_PERCLK_CLK_ROOT:
+        return MX6_IPG_CLK_ROOT;
+
+    case MX6_USDHC1_CLK_ROOT:
+    case MX6_USDHC2_CLK_ROOT:
+    case MX6_USDHC3_CLK_ROOT:
+    case MX6_USDHC4_CLK_ROOT:
+    {
+        const MX6_CCM_CSCMR1_REG cscmr1Reg = {Registers.Ccm.CSCMR1};
+
+        ULONG clockSel;
+        switch (ClockId) {
+        case MX6_USDHC1_CLK_ROOT: clockSel = cscmr1Reg.usdhc1_clk_sel; break;
+        case MX6_USDHC2_CLK_ROOT: clockSel = cscmr1Reg.usdhc2_clk_sel; break;
+        case MX6_USDHC3_CLK_ROOT: clockSel = cscmr1Reg.usdhc3_clk_sel; break;
+        default: clockSel = cscmr1Reg.usdhc4_clk_sel; break;
+        }
+
+        if (clockSel == MX6_CCM_USDHC_CLK_SEL_PLL2_PFD2) {
+            return MX6_PLL2_PFD2;
+        }
+
+        return MX6_PLL2_PFD0;
+    }
+
+    case MX6_SSI1_CLK_ROOT:
+    case MX6_SSI2_CLK_ROOT:
+    case MX6_SSI3_CLK_ROOT:
+    {
+        const MX6_CCM_CSCMR1_REG cscmr1Reg = {Registers.Ccm.CSCMR1};
+
+        ULONG clockSel;
+        switch (ClockId) {
+        case MX6_SSI1_CLK_ROOT: clockSel = cscmr1Reg.ssi1_clk_sel; break;
+        case MX6_SSI2_CLK_ROOT: clockSel = cscmr1Reg.ssi2_clk_sel; break;
+        default: clockSel = cscmr1Reg.ssi3_clk_sel; break;
+        }
+
+        switch (clockSel) {
+        case MX6_CCM_SSI_CLK_SEL_PLL3_PFD2: return MX6_PLL3_PFD2;
+        case MX6_CCM_SSI_CLK_SEL_PLL3_PFD3: return MX6_PLL3_PFD3;
+        case MX6_CCM_SSI_CLK_SEL_PLL4: return MX6_PLL4_MAIN_CLK;
+        default: return MX6_CLK_MAX;
+        }
+    }
+
+    case MX6_GPU2D_AXI_CLK_ROOT:
+    {
+        const MX6_CCM_CBCMR_REG cbcmrReg = {Registers.Ccm.CBCMR};
+        if (cbcmrReg.gpu2d_axi_clk_sel == MX6_CCM_GPU2D_AXI_CLK_SEL_AXI) {
+            return MX6_AXI_CLK_ROOT;
+        }
+
+        return MX6_AHB_CLK_ROOT;
+    }
+
+    case MX6_GPU3D_AXI_CLK_ROOT:
+    {
+        const MX6_CCM_CBCMR_REG cbcmrReg = {Registers.Ccm.CBCMR};
+        if (cbcmrReg.gpu3d_axi_clk_sel == MX6_CCM_GPU3D_AXI_CLK_SEL_AXI) {
+            return MX6_AXI_CLK_ROOT;
+        }
+
+        return MX6_AHB_CLK_ROOT;
+    }
+
+    case MX6_GPU2D_CORE_CLK_ROOT:
+    {
+        const MX6_CCM_CBCMR_REG cbcmrReg = {Registers.Ccm.CBCMR};
+        switch (cbcmrReg.gpu2d_core_clk_sel) {
+        case MX6_CCM_GPU2D_CORE_CLK_SEL_AXI: return MX6_AXI_CLK_ROOT;
+        case MX6_CCM_GPU2D_CORE_CLK_SEL_PLL3_SW: return MX6_PLL3_SW_CLK;
+        case MX6_CCM_GPU2D_CORE_CLK_SEL_PLL2_PFD0: return MX6_PLL2_PFD0;
+        case MX6_CCM_GPU2D_CORE_CLK_SEL_PLL2_PFD2: return MX6_PLL2_PFD2;
+        default: return MX6_CLK_MAX;
+        }
+    }
+
+    case MX6_GPU3D_CORE_CLK_ROOT:
+    {
+        const MX6_CCM_CBCMR_REG cbcmrReg = {Registers.Ccm.CBCMR};
+        switch (cbcmrReg.gpu3d_core_clk_sel) {
+        case MX6_CCM_GPU3D_CORE_CLK_SEL_MMDC_CH0_AXI: return MX6_MMDC_CH0_CLK_ROOT;
+        case MX6_CCM_GPU3D_CORE_CLK_SEL_PLL3_SW: return MX6_PLL3_SW_CLK;
+        case MX6_CCM_GPU3D_CORE_CLK_SEL_PLL2_PFD1: return MX6_PLL2_PFD1;
+        case MX6_CCM_GPU3D_CORE_CLK_SEL_PLL2_PFD2: return MX6_PLL2_PFD2;
+        default: return MX6_CLK_MAX;
+        }
+    }
+
+    case MX6_GPU3D_SHADER_CLK_ROOT:
+    {
+        const MX6_CCM_CBCMR_REG cbcmrReg = {Registers.Ccm.CBCMR};
+        switch (cbcmrReg.gpu3d_shader_clk_sel) {
+        case MX6_CCM_GPU3D_SHADER_CLK_SEL_MMDC_CH0_AXI: return MX6_MMDC_CH0_CLK_ROOT;
+        case MX6_CCM_GPU3D_SHADER_CLK_SEL_PLL3_SW: return MX6_PLL3_SW_CLK;
+        case MX6_CCM_GPU3D_SHADER_CLK_SEL_PLL2_PFD1: return MX6_PLL2_PFD1;
+        case MX6_CCM_GPU3D_SHADER_CLK_SEL_PLL3_PFD0: return MX6_PLL3_PFD0;
+        default: return MX6_CLK_MAX;
+        }
+    }
+
+    case MX6_VPU_AXI_CLK_ROOT:
+    {
+        const MX6_CCM_CBCMR_REG cbcmrReg = {Registers.Ccm.CBCMR};
+        switch (cbcmrReg.vpu_axi_clk_sel) {
+        case VPU_AXI_CLK_SEL_AXI_CLK_ROOT: return MX6_AXI_CLK_ROOT;
+        case VPU_AXI_CLK_SEL_PLL2_PFD2: return MX6_PLL2_PFD2;
+        case VPU_AXI_CLK_SEL_PLL2_PFD0: return MX6_PLL2_PFD0;
+        default: return MX6_CLK_MAX;
+        }
+    }
+
+    case MX6_ECSPI_CLK_ROOT:
+        // pll3_60m, a fixed divide by 8 of pll3_sw_clk
+        return MX6_PLL3_SW_CLK;
+
+    case MX6_UART_CLK_ROOT:
+        return MX6_PLL3_80M;
+
+    case MX6_VIDEO_27M_CLK_ROOT:
+        return MX6_PLL3_PFD1;
+
+    default:
+        return MX6_CLK_MAX;
+    }
+}
+
+#endif // _MX6CLKTREE_H_
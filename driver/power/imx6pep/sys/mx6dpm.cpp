@@ -20,6 +20,9 @@
 #include "mx6peputil.h"
 #include "mx6pepioctl.h"
 #include "mx6pephw.h"
+#include "mx6dvfs.h"
+#include "mx6clktree.h"
+#include "mx6clknode.h"
 #include "mx6pep.h"
 
 MX6_NONPAGED_SEGMENT_BEGIN; //==============================================
@@ -229,7 +232,7 @@ BOOLEAN MX6_PEP::DpmPrepareDevice (PEP_PREPARE_DEVICE* ArgsPtr)
     case _DEVICE_ID::USDHC2:
     case _DEVICE_ID::USDHC3:
     case _DEVICE_ID::USDHC4:
-        this->setSdhcClockGate(pepDeviceId, true);
+        this->setDeviceClocks(pepDeviceId, true);
         break;
     }
 
@@ -364,7 +367,8 @@ BOOLEAN MX6_PEP::DpmRegisterDebugger (PEP_REGISTER_DEBUGGER* ArgsPtr)
         return FALSE;
     }
 
-    this->setUartD0(contextFromDeviceId(deviceId));
+    this->setDeviceClocks(deviceId, true);
+    this->contextFromDeviceId(deviceId)->PowerState = PowerDeviceD0;
 
     //
     // Map base address of UART block
@@ -716,36 +720,25 @@ void MX6_PEP::setDeviceD0 (_DEVICE_ID DeviceId)
     _DEVICE_CONTEXT* contextPtr = this->contextFromDeviceId(DeviceId);
     switch (DeviceId) {
     case _DEVICE_ID::I2C1:
-        this->setClockGate(MX6_I2C1_SERIAL_CLK_ENABLE, MX6_CCM_CCGR_ON);
-        break;
     case _DEVICE_ID::I2C2:
-        this->setClockGate(MX6_I2C2_SERIAL_CLK_ENABLE, MX6_CCM_CCGR_ON);
-        break;
     case _DEVICE_ID::I2C3:
-        this->setClockGate(MX6_I2C3_SERIAL_CLK_ENABLE, MX6_CCM_CCGR_ON);
-        break;
     case _DEVICE_ID::SPI1:
-        this->setClockGate(MX6_ECSPI1_CLK_ENABLE, MX6_CCM_CCGR_ON);
-        break;
     case _DEVICE_ID::SPI2:
-        this->setClockGate(MX6_ECSPI2_CLK_ENABLE, MX6_CCM_CCGR_ON);
-        break;
     case _DEVICE_ID::SPI3:
-        this->setClockGate(MX6_ECSPI3_CLK_ENABLE, MX6_CCM_CCGR_ON);
-        break;
     case _DEVICE_ID::SPI4:
-        this->setClockGate(MX6_ECSPI4_CLK_ENABLE, MX6_CCM_CCGR_ON);
-        break;
     case _DEVICE_ID::SPI5:
-        this->setClockGate(MX6_ECSPI5_CLK_ENABLE, MX6_CCM_CCGR_ON);
-        break;
     case _DEVICE_ID::UART1:
     case _DEVICE_ID::UART2:
     case _DEVICE_ID::UART3:
     case _DEVICE_ID::UART4:
     case _DEVICE_ID::UART5:
-        this->setUartD0(contextPtr);
-        return;
+    case _DEVICE_ID::SSI1:
+    case _DEVICE_ID::SSI2:
+    case _DEVICE_ID::SSI3:
+    case _DEVICE_ID::ASRC:
+    case _DEVICE_ID::ENET:
+        this->setDeviceClocks(DeviceId, true);
+        break;
     case _DEVICE_ID::VPU:
     {
         // Reference the power domain if we're coming from D3 or below.
@@ -757,24 +750,9 @@ void MX6_PEP::setDeviceD0 (_DEVICE_ID DeviceId)
             this->referenceGpuVpuPowerDomain();
         }
 
-        this->setClockGate(MX6_VPU_CLK_ENABLE, MX6_CCM_CCGR_ON);
+        this->setDeviceClocks(DeviceId, true);
         break;
     }
-    case _DEVICE_ID::SSI1:
-        this->setClockGate(MX6_SSI1_CLK_ENABLE, MX6_CCM_CCGR_ON);
-        break;
-    case _DEVICE_ID::SSI2:
-        this->setClockGate(MX6_SSI2_CLK_ENABLE, MX6_CCM_CCGR_ON);
-        break;
-    case _DEVICE_ID::SSI3:
-        this->setClockGate(MX6_SSI3_CLK_ENABLE, MX6_CCM_CCGR_ON);
-        break;
-    case _DEVICE_ID::ASRC:
-        this->setClockGate(MX6_ASRC_CLK_ENABLE, MX6_CCM_CCGR_ON);
-        break;
-    case _DEVICE_ID::ENET:
-        this->setClockGate(MX6_ENET_CLK_ENABLE, MX6_CCM_CCGR_ON);
-        break;
     default:
         MX6_LOG_TRACE(
             "Taking default behavior for device. (DeviceId = %d)",
@@ -806,64 +784,38 @@ void MX6_PEP::setDeviceDx (_DEVICE_ID DeviceId, DEVICE_POWER_STATE NewPowerState
 
     switch (DeviceId) {
     case _DEVICE_ID::I2C1:
-        this->setClockGate(MX6_I2C1_SERIAL_CLK_ENABLE, MX6_CCM_CCGR_OFF);
-        break;
     case _DEVICE_ID::I2C2:
-        this->setClockGate(MX6_I2C2_SERIAL_CLK_ENABLE, MX6_CCM_CCGR_OFF);
-        break;
     case _DEVICE_ID::I2C3:
-        this->setClockGate(MX6_I2C3_SERIAL_CLK_ENABLE, MX6_CCM_CCGR_OFF);
-        break;
     case _DEVICE_ID::SPI1:
-        this->setClockGate(MX6_ECSPI1_CLK_ENABLE, MX6_CCM_CCGR_OFF);
-        break;
     case _DEVICE_ID::SPI2:
-        this->setClockGate(MX6_ECSPI2_CLK_ENABLE, MX6_CCM_CCGR_OFF);
-        break;
     case _DEVICE_ID::SPI3:
-        this->setClockGate(MX6_ECSPI3_CLK_ENABLE, MX6_CCM_CCGR_OFF);
-        break;
     case _DEVICE_ID::SPI4:
-        this->setClockGate(MX6_ECSPI4_CLK_ENABLE, MX6_CCM_CCGR_OFF);
-        break;
     case _DEVICE_ID::SPI5:
-        this->setClockGate(MX6_ECSPI5_CLK_ENABLE, MX6_CCM_CCGR_OFF);
-        break;
     case _DEVICE_ID::UART1:
     case _DEVICE_ID::UART2:
     case _DEVICE_ID::UART3:
     case _DEVICE_ID::UART4:
     case _DEVICE_ID::UART5:
-    {
-        this->unreferenceUartClocks();
+    case _DEVICE_ID::SSI1:
+    case _DEVICE_ID::SSI2:
+    case _DEVICE_ID::SSI3:
+    case _DEVICE_ID::ASRC:
+    case _DEVICE_ID::ENET:
+        this->setDeviceClocks(DeviceId, false);
         break;
-    }
     case _DEVICE_ID::VPU:
     {
-        this->setClockGate(MX6_VPU_CLK_ENABLE, MX6_CCM_CCGR_OFF);
+        // The VPU clock must be gated before its power domain goes down
+        const bool powerDomainOff = NewPowerState >= PowerDeviceD3;
+        this->setDeviceClocks(DeviceId, false, powerDomainOff);
 
         // Unreference the GPU/VPU power domain if we're going to D3 or below
-        if (NewPowerState >= PowerDeviceD3) {
+        if (powerDomainOff) {
             this->unreferenceGpuVpuPowerDomain();
         }
 
         break;
     }
-    case _DEVICE_ID::SSI1:
-        this->setClockGate(MX6_SSI1_CLK_ENABLE, MX6_CCM_CCGR_OFF);
-        break;
-    case _DEVICE_ID::SSI2:
-        this->setClockGate(MX6_SSI2_CLK_ENABLE, MX6_CCM_CCGR_OFF);
-        break;
-    case _DEVICE_ID::SSI3:
-        this->setClockGate(MX6_SSI3_CLK_ENABLE, MX6_CCM_CCGR_OFF);
-        break;
-    case _DEVICE_ID::ASRC:
-        this->setClockGate(MX6_ASRC_CLK_ENABLE, MX6_CCM_CCGR_OFF);
-        break;
-    case _DEVICE_ID::ENET:
-        this->setClockGate(MX6_ENET_CLK_ENABLE, MX6_CCM_CCGR_OFF);
-        break;
     default:
         MX6_LOG_TRACE(
             "Taking default behavior for device. (DeviceId = %d)",
@@ -950,9 +902,7 @@ void MX6_PEP::setGpuF0 ()
     }
 
     // Ungate GPU clocks
-    this->setClockGate(MX6_GPU3D_CLK_ENABLE, MX6_CCM_CCGR_ON);
-    this->setClockGate(MX6_GPU2D_CLK_ENABLE, MX6_CCM_CCGR_ON);
-    this->setClockGate(MX6_OPENVGAXICLK_CLK_ROOT_ENABLE, MX6_CCM_CCGR_ON);
+    this->setDeviceClocks(_DEVICE_ID::GPU, true);
 
     contextPtr->IdleState = 0;
 }
@@ -967,10 +917,8 @@ void MX6_PEP::setGpuFx (ULONG NewIdleState)
     // transitions to idle states always come from F0
     NT_ASSERT(contextPtr->IdleState == 0);
 
-    // Gate GPU clocks
-    this->setClockGate(MX6_GPU3D_CLK_ENABLE, MX6_CCM_CCGR_OFF);
-    this->setClockGate(MX6_GPU2D_CLK_ENABLE, MX6_CCM_CCGR_OFF);
-    this->setClockGate(MX6_OPENVGAXICLK_CLK_ROOT_ENABLE, MX6_CCM_CCGR_OFF);
+    // Gate GPU clocks, right away if the power domain is going down
+    this->setDeviceClocks(_DEVICE_ID::GPU, false, NewIdleState >= 2);
 
     // Unreference power domain if we're going to F2 or below
     if (NewIdleState >= 2) {
@@ -1048,16 +996,27 @@ void MX6_PEP::turnOnGpuVpuPowerDomain ()
 
     // Turn on LDO_PU to 1.250V
     {
-        MX6_PMU_REG_CORE_REG pmuCoreReg =
-            {READ_REGISTER_NOFENCE_ULONG(&analogRegistersTempPtr->PMU_REG_CORE)};
+        bool ldoChanged = false;
+
+        // PMU_REG_CORE also holds the LDO_ARM target set by setOperatingPoint()
+        {
+            MX6_SPINLOCK_GUARD lock(&this->dvfs.Lock);
 
-        if (pmuCoreReg.REG1_TARG != 22) {
-            pmuCoreReg.REG1_TARG = 22;
+            MX6_PMU_REG_CORE_REG pmuCoreReg =
+                {READ_REGISTER_NOFENCE_ULONG(&analogRegistersTempPtr->PMU_REG_CORE)};
 
-            WRITE_REGISTER_NOFENCE_ULONG(
-                &analogRegistersTempPtr->PMU_REG_CORE,
-                pmuCoreReg.AsUlong);
+            if (pmuCoreReg.REG1_TARG != 22) {
+                pmuCoreReg.REG1_TARG = 22;
 
+                WRITE_REGISTER_NOFENCE_ULONG(
+                    &analogRegistersTempPtr->PMU_REG_CORE,
+                    pmuCoreReg.AsUlong);
+
+                ldoChanged = true;
+            }
+        }
+
+        if (ldoChanged) {
             LARGE_INTEGER interval;
             interval.QuadPart = -500 * 10LL;  // 500us (arbitrary)
             NTSTATUS status = KeDelayExecutionThread(KernelMode, FALSE, &interval);
@@ -1199,40 +1158,354 @@ void MX6_PEP::configureGpuClockTree ()
     WRITE_REGISTER_NOFENCE_ULONG(&ccmRegistersTempPtr->CBCMR, cbcmrReg.AsUlong);
 }
 
+//
+// Clock node of the blocks whose clocks the PEP gates on behalf of their
+// driver. Gating the UART clocks saves about 3mW in the VDD_SOC domain; a
+// single pair of gates serves all UART instances.
+//
 _Use_decl_annotations_
-void MX6_PEP::setUartD0 (_DEVICE_CONTEXT* ContextPtr)
+MX6_CLK_NODE MX6_PEP::clockNodeFromDeviceId (_DEVICE_ID DeviceId)
 {
-    // Only reference UART clock if device is not already in D0
-    if (ContextPtr->PowerState == PowerDeviceD0) {
+    switch (DeviceId) {
+    case _DEVICE_ID::I2C1: return MX6_CLK_NODE_I2C1;
+    case _DEVICE_ID::I2C2: return MX6_CLK_NODE_I2C2;
+    case _DEVICE_ID::I2C3: return MX6_CLK_NODE_I2C3;
+    case _DEVICE_ID::SPI1: return MX6_CLK_NODE_ECSPI1;
+    case _DEVICE_ID::SPI2: return MX6_CLK_NODE_ECSPI2;
+    case _DEVICE_ID::SPI3: return MX6_CLK_NODE_ECSPI3;
+    case _DEVICE_ID::SPI4: return MX6_CLK_NODE_ECSPI4;
+    case _DEVICE_ID::SPI5: return MX6_CLK_NODE_ECSPI5;
+    case _DEVICE_ID::UART1:
+    case _DEVICE_ID::UART2:
+    case _DEVICE_ID::UART3:
+    case _DEVICE_ID::UART4:
+    case _DEVICE_ID::UART5: return MX6_CLK_NODE_UART;
+    case _DEVICE_ID::USDHC1: return MX6_CLK_NODE_USDHC1;
+    case _DEVICE_ID::USDHC2: return MX6_CLK_NODE_USDHC2;
+    case _DEVICE_ID::USDHC3: return MX6_CLK_NODE_USDHC3;
+    case _DEVICE_ID::USDHC4: return MX6_CLK_NODE_USDHC4;
+    case _DEVICE_ID::VPU: return MX6_CLK_NODE_VPU;
+    case _DEVICE_ID::SSI1: return MX6_CLK_NODE_SSI1;
+    case _DEVICE_ID::SSI2: return MX6_CLK_NODE_SSI2;
+    case _DEVICE_ID::SSI3: return MX6_CLK_NODE_SSI3;
+    case _DEVICE_ID::ASRC: return MX6_CLK_NODE_ASRC;
+    case _DEVICE_ID::ENET: return MX6_CLK_NODE_ENET;
+    case _DEVICE_ID::GPU: return MX6_CLK_NODE_GPU;
+    default: return MX6_CLK_NODE_NONE;
+    }
+}
+
+//
+// Take or release the device's reference on its clock node. A device holds
+// at most one reference, so repeated D0 or F0 notifications are harmless.
+// Transitions of a given device are serialized by the power framework.
+//
+_Use_decl_annotations_
+void MX6_PEP::setDeviceClocks (_DEVICE_ID DeviceId, bool On, bool GateNow)
+{
+    const MX6_CLK_NODE node = clockNodeFromDeviceId(DeviceId);
+    if (node == MX6_CLK_NODE_NONE) {
+        NT_ASSERT(!"Device has no clock node");
+        return;
+    }
+
+    _DEVICE_CONTEXT* contextPtr = this->contextFromDeviceId(DeviceId);
+    if (contextPtr->ClockNodeReferenced == On) {
         return;
     }
 
-    this->referenceUartClocks();
-    ContextPtr->PowerState = PowerDeviceD0;
+    contextPtr->ClockNodeReferenced = On;
+    if (On) {
+        this->referenceClockNode(node);
+    } else {
+        this->unreferenceClockNode(node, GateNow);
+    }
+}
+
+_Use_decl_annotations_
+void MX6_PEP::referenceClockNode (MX6_CLK_NODE Node)
+{
+    MX6_SPINLOCK_GUARD lock(&this->clockNodes.Lock);
+    this->referenceClockNodeLocked(Node);
 }
 
 //
-// Gating the UART clocks saves about 3mW in the VDD_SOC domain.
-// A single clock gate controls gating for all UART instances.
+// Release a reference on a clock node. When the last reference goes away
+// the node is gated after the gate delay, or right away if GateNow is set,
+// for instance because the power domain of the block is about to go down.
 //
 _Use_decl_annotations_
-void MX6_PEP::referenceUartClocks ()
+void MX6_PEP::unreferenceClockNode (MX6_CLK_NODE Node, bool GateNow)
 {
-    MX6_SPINLOCK_GUARD lock(&this->uartClockSpinLock);
-    if (++(this->uartClockRefCount) == 1) {
-        this->setClockGate(MX6_UART_CLK_ENABLE, MX6_CCM_CCGR_ON);
-        this->setClockGate(MX6_UART_SERIAL_CLK_ENABLE, MX6_CCM_CCGR_ON);
+    auto clockNodesPtr = &this->clockNodes;
+
+    MX6_SPINLOCK_GUARD lock(&clockNodesPtr->Lock);
+
+    NT_ASSERT(clockNodesPtr->RefCount[Node] != 0);
+    if (--clockNodesPtr->RefCount[Node] != 0) {
+        return;
+    }
+
+    if (GateNow || (clockNodesPtr->GateDelayMicros == 0)) {
+        this->gateClockNodeLocked(Node);
+        return;
+    }
+
+    const ULONGLONG gateDelay = ULONGLONG(clockNodesPtr->GateDelayMicros) * 10;
+    clockNodesPtr->GateDeadline[Node] = KeQueryInterruptTime() + gateDelay;
+
+    //
+    // Pending deadlines are never later than now plus the gate delay, since
+    // setClockGateDelay() reschedules them when the delay changes, so a
+    // timer that is already armed expires no later than this node's deadline.
+    //
+    if (!clockNodesPtr->TimerArmed) {
+        LARGE_INTEGER dueTime;
+        dueTime.QuadPart = -LONGLONG(gateDelay);
+        KeSetTimer(&clockNodesPtr->Timer, dueTime, &clockNodesPtr->Dpc);
+        clockNodesPtr->TimerArmed = true;
     }
 }
 
 _Use_decl_annotations_
-void MX6_PEP::unreferenceUartClocks ()
+void MX6_PEP::referenceClockNodeLocked (MX6_CLK_NODE Node)
 {
-    MX6_SPINLOCK_GUARD lock(&this->uartClockSpinLock);
-    if (--(this->uartClockRefCount) == 0) {
-        this->setClockGate(MX6_UART_CLK_ENABLE, MX6_CCM_CCGR_OFF);
-        this->setClockGate(MX6_UART_SERIAL_CLK_ENABLE, MX6_CCM_CCGR_OFF);
+    auto clockNodesPtr = &this->clockNodes;
+
+    if (++clockNodesPtr->RefCount[Node] != 1) {
+        return;
     }
+
+    // Still ungated if the node was waiting for its gate delay to expire
+    if (clockNodesPtr->Ungated[Node]) {
+        clockNodesPtr->Stats[Node].GateCancelCount += 1;
+        return;
+    }
+
+    this->referenceClockTreeLocked(Node);
+
+    const MX6_CLK_NODE_DESCRIPTOR& descriptor = Mx6ClkNodeDescriptors[Node];
+    for (ULONG i = 0; i < descriptor.GateCount; ++i) {
+        this->setClockGate(descriptor.Gates[i], MX6_CCM_CCGR_ON);
+    }
+
+    clockNodesPtr->Ungated[Node] = true;
+    clockNodesPtr->Stats[Node].UngateCount += 1;
+}
+
+//
+// Gate an unreferenced node and release its references on the clock tree.
+//
+_Use_decl_annotations_
+void MX6_PEP::gateClockNodeLocked (MX6_CLK_NODE Node)
+{
+    auto clockNodesPtr = &this->clockNodes;
+
+    NT_ASSERT(clockNodesPtr->RefCount[Node] == 0);
+    NT_ASSERT(clockNodesPtr->Ungated[Node]);
+
+    const MX6_CLK_NODE_DESCRIPTOR& descriptor = Mx6ClkNodeDescriptors[Node];
+    for (ULONG i = 0; i < descriptor.GateCount; ++i) {
+        this->setClockGate(descriptor.Gates[i], MX6_CCM_CCGR_OFF);
+    }
+
+    clockNodesPtr->Ungated[Node] = false;
+    clockNodesPtr->Stats[Node].GateCount += 1;
+
+    this->unreferenceClockTreeLocked(Node);
+}
+
+//
+// Reference the clocks that feed a node, from its clock root up to the
+// source clock, following the current clock mux settings. The chain is
+// kept with the node so that the same clocks are released when it is
+// gated, even if a mux was switched in the meantime. The references are
+// bookkeeping only: the PLLs and dividers are left running.
+//
+_Use_decl_annotations_
+void MX6_PEP::referenceClockTreeLocked (MX6_CLK_NODE Node)
+{
+    auto clockNodesPtr = &this->clockNodes;
+
+    NT_ASSERT(clockNodesPtr->ClockCount[Node] == 0);
+
+    MX6PEP_DUMP_REGISTERS_OUTPUT registers;
+    this->readClockMuxRegisters(&registers);
+
+    MX6_CLK* clocksPtr = clockNodesPtr->Clocks[Node];
+    ULONG count = 0;
+    MX6_CLK clock = Mx6ClkNodeDescriptors[Node].Root;
+    while ((clock != MX6_CLK_NONE) && (clock != MX6_CLK_MAX)) {
+        if (count == MX6_CLK_TREE_DEPTH_MAX) {
+            NT_ASSERT(!"Clock tree is deeper than MX6_CLK_TREE_DEPTH_MAX");
+            break;
+        }
+
+        clocksPtr[count++] = clock;
+        clockNodesPtr->ClockRefCount[clock] += 1;
+        clock = Mx6ClkTreeGetParent(registers, clock);
+    }
+
+    clockNodesPtr->ClockCount[Node] = count;
+}
+
+_Use_decl_annotations_
+void MX6_PEP::unreferenceClockTreeLocked (MX6_CLK_NODE Node)
+{
+    auto clockNodesPtr = &this->clockNodes;
+
+    const MX6_CLK* clocksPtr = clockNodesPtr->Clocks[Node];
+    for (ULONG i = 0; i < clockNodesPtr->ClockCount[Node]; ++i) {
+        NT_ASSERT(clockNodesPtr->ClockRefCount[clocksPtr[i]] != 0);
+        clockNodesPtr->ClockRefCount[clocksPtr[i]] -= 1;
+    }
+
+    clockNodesPtr->ClockCount[Node] = 0;
+}
+
+//
+// Snapshot of the registers Mx6ClkTreeGetParent() reads. The other fields
+// are left zero.
+//
+_Use_decl_annotations_
+void MX6_PEP::readClockMuxRegisters (MX6PEP_DUMP_REGISTERS_OUTPUT* RegistersPtr)
+{
+    RtlZeroMemory(RegistersPtr, sizeof(*RegistersPtr));
+
+    RegistersPtr->Ccm.CCSR =
+        READ_REGISTER_NOFENCE_ULONG(&this->ccmRegistersPtr->CCSR);
+
+    RegistersPtr->Ccm.CBCDR =
+        READ_REGISTER_NOFENCE_ULONG(&this->ccmRegistersPtr->CBCDR);
+
+    RegistersPtr->Ccm.CBCMR =
+        READ_REGISTER_NOFENCE_ULONG(&this->ccmRegistersPtr->CBCMR);
+
+    RegistersPtr->Ccm.CSCMR1 =
+        READ_REGISTER_NOFENCE_ULONG(&this->ccmRegistersPtr->CSCMR1);
+
+    RegistersPtr->Analog.PLL_ARM =
+        READ_REGISTER_NOFENCE_ULONG(&this->analogRegistersPtr->PLL_ARM);
+
+    RegistersPtr->Analog.PLL_USB1 =
+        READ_REGISTER_NOFENCE_ULONG(&this->analogRegistersPtr->PLL_USB1);
+
+    RegistersPtr->Analog.PLL_SYS =
+        READ_REGISTER_NOFENCE_ULONG(&this->analogRegistersPtr->PLL_SYS);
+}
+
+//
+// Arm the gate timer for the earliest deadline of the nodes waiting to be
+// gated, or cancel it if there are none.
+//
+_Use_decl_annotations_
+void MX6_PEP::armClockNodeGateTimerLocked (ULONGLONG Now)
+{
+    auto clockNodesPtr = &this->clockNodes;
+
+    ULONGLONG nextDeadline = MAXULONGLONG;
+    for (ULONG i = 0; i < MX6_CLK_NODE_MAX; ++i) {
+        if ((clockNodesPtr->RefCount[i] == 0) && clockNodesPtr->Ungated[i]) {
+            nextDeadline = min(nextDeadline, clockNodesPtr->GateDeadline[i]);
+        }
+    }
+
+    if (nextDeadline == MAXULONGLONG) {
+        if (clockNodesPtr->TimerArmed) {
+            KeCancelTimer(&clockNodesPtr->Timer);
+            clockNodesPtr->TimerArmed = false;
+        }
+
+        return;
+    }
+
+    LARGE_INTEGER dueTime;
+    dueTime.QuadPart = (nextDeadline > Now) ? -LONGLONG(nextDeadline - Now) : -1;
+    KeSetTimer(&clockNodesPtr->Timer, dueTime, &clockNodesPtr->Dpc);
+    clockNodesPtr->TimerArmed = true;
+}
+
+_Use_decl_annotations_
+VOID
+MX6_PEP::clockNodeGateDpcRoutine (
+    struct _KDPC * /*Dpc*/,
+    PVOID DeferredContext,
+    PVOID /*SystemArgument1*/,
+    PVOID /*SystemArgument2*/
+    )
+{
+    auto thisPtr = static_cast<MX6_PEP*>(DeferredContext);
+    auto clockNodesPtr = &thisPtr->clockNodes;
+
+    MX6_SPINLOCK_GUARD lock(&clockNodesPtr->Lock);
+
+    clockNodesPtr->TimerArmed = false;
+
+    const ULONGLONG now = KeQueryInterruptTime();
+    for (ULONG i = 0; i < MX6_CLK_NODE_MAX; ++i) {
+        const auto node = static_cast<MX6_CLK_NODE>(i);
+        if ((clockNodesPtr->RefCount[node] == 0) &&
+            clockNodesPtr->Ungated[node] &&
+            (clockNodesPtr->GateDeadline[node] <= now)) {
+
+            thisPtr->gateClockNodeLocked(node);
+        }
+    }
+
+    thisPtr->armClockNodeGateTimerLocked(now);
+}
+
+_Use_decl_annotations_
+void MX6_PEP::getClockNodeStats (MX6PEP_GET_CLOCK_NODE_STATS_OUTPUT* OutputPtr)
+{
+    auto clockNodesPtr = &this->clockNodes;
+
+    MX6_SPINLOCK_GUARD lock(&clockNodesPtr->Lock);
+
+    OutputPtr->GateDelayMicros = clockNodesPtr->GateDelayMicros;
+    for (ULONG i = 0; i < ARRAYSIZE(OutputPtr->Nodes); ++i) {
+        OutputPtr->Nodes[i] = clockNodesPtr->Stats[i];
+        OutputPtr->Nodes[i].RefCount = clockNodesPtr->RefCount[i];
+        OutputPtr->Nodes[i].Ungated = clockNodesPtr->Ungated[i];
+    }
+
+    for (ULONG i = 0; i < ARRAYSIZE(OutputPtr->ClockRefCount); ++i) {
+        OutputPtr->ClockRefCount[i] = clockNodesPtr->ClockRefCount[i];
+    }
+}
+
+//
+// Change the gate delay and reschedule the nodes already waiting to be
+// gated, so that a shorter delay takes effect right away instead of after
+// the previous, possibly much longer, delay expires.
+//
+_Use_decl_annotations_
+void MX6_PEP::setClockGateDelay (ULONG GateDelayMicros)
+{
+    auto clockNodesPtr = &this->clockNodes;
+
+    MX6_SPINLOCK_GUARD lock(&clockNodesPtr->Lock);
+
+    clockNodesPtr->GateDelayMicros = GateDelayMicros;
+
+    const ULONGLONG now = KeQueryInterruptTime();
+    const ULONGLONG deadline = now + ULONGLONG(GateDelayMicros) * 10;
+    for (ULONG i = 0; i < MX6_CLK_NODE_MAX; ++i) {
+        const auto node = static_cast<MX6_CLK_NODE>(i);
+        if ((clockNodesPtr->RefCount[node] != 0) ||
+            !clockNodesPtr->Ungated[node]) {
+
+            continue;
+        }
+
+        if (GateDelayMicros == 0) {
+            this->gateClockNodeLocked(node);
+        } else {
+            clockNodesPtr->GateDeadline[node] = deadline;
+        }
+    }
+
+    this->armClockNodeGateTimerLocked(now);
 }
 
 _Use_decl_annotations_
@@ -1299,7 +1572,7 @@ BOOLEAN MX6_PEP::setComponentF0 (PEP_NOTIFY_COMPONENT_IDLE_STATE* ArgsPtr)
     case _DEVICE_ID::USDHC3:
     case _DEVICE_ID::USDHC4:
     {
-        this->setSdhcClockGate(deviceId, true);
+        this->setDeviceClocks(deviceId, true);
         ArgsPtr->Completed = TRUE;
         return TRUE;
     } // USDHC
@@ -1335,7 +1608,7 @@ BOOLEAN MX6_PEP::setComponentFx (PEP_NOTIFY_COMPONENT_IDLE_STATE* ArgsPtr)
     case _DEVICE_ID::USDHC3:
     case _DEVICE_ID::USDHC4:
     {
-        this->setSdhcClockGate(deviceId, false);
+        this->setDeviceClocks(deviceId, false);
         ArgsPtr->Completed = TRUE;
         return TRUE;
     } // USDHC
@@ -1345,32 +1618,6 @@ BOOLEAN MX6_PEP::setComponentFx (PEP_NOTIFY_COMPONENT_IDLE_STATE* ArgsPtr)
     } // switch (deviceId)
 }
 
-void MX6_PEP::setSdhcClockGate (_DEVICE_ID DeviceId, bool On)
-{
-    MX6_CLK_GATE gate;
-    switch (DeviceId) {
-    case _DEVICE_ID::USDHC1:
-        gate = MX6_USDHC1_CLK_ENABLE;
-        break;
-    case _DEVICE_ID::USDHC2:
-        gate = MX6_USDHC2_CLK_ENABLE;
-        break;
-    case _DEVICE_ID::USDHC3:
-        gate = MX6_USDHC3_CLK_ENABLE;
-        break;
-    case _DEVICE_ID::USDHC4:
-        gate = MX6_USDHC4_CLK_ENABLE;
-        break;
-    default:
-        NT_ASSERT(!"Invalid DeviceId");
-        return;
-    }
-
-    this->setClockGate(
-        gate,
-        On ? MX6_CCM_CCGR_ON : MX6_CCM_CCGR_OFF);
-}
-
 //
 // ERR006687 ENET: Only the ENET wake-up interrupt request can wake the system
 // from Wait mode. When the system enters Wait mode, a normal RX Done or
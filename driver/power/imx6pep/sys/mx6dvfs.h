@@ -0,0 +1,253 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+//
+// Module Name:
+//
+//   mx6dvfs.h
+//
+// Abstract:
+//
+//   IMX6 ARM core operating points and transition planning. This module only
+//   describes the clock tree and regulator settings of each operating point
+//   and the order in which they must be changed; it does not touch hardware.
+//   The steps are carried out by MX6_PEP::setOperatingPoint(), and by the
+//   clock tree model of the host test in ../test/mx6dvfstest.cpp.
+//
+//   ARM clock = PLL1 / (CACRR.arm_podf + 1)
+//   PLL1      = 24MHz * PLL_ARM.DIV_SELECT / 2
+//   VDD_ARM   = 0.7V + 25mV * PMU_REG_CORE.REG0_TARG (LDO_ARM enabled)
+//
+
+#ifndef _MX6DVFS_H_
+#define _MX6DVFS_H_
+
+struct MX6_DVFS_OPERATING_POINT {
+    ULONG FrequencyMhz;
+    ULONG PllDivSelect;
+    ULONG ArmPodf;
+    ULONG VddArmMv;
+};
+
+enum : ULONG {
+    MX6_DVFS_REF_CLK_MHZ = 24,
+    MX6_DVFS_VDD_ARM_BASE_MV = 700,
+    MX6_DVFS_VDD_ARM_STEP_MV = 25,
+
+    // REG0_TARG values that do not select a regulated voltage
+    MX6_DVFS_REG_TARG_POWER_GATED = 0x00,
+    MX6_DVFS_REG_TARG_BYPASS = 0x1f,
+
+    // Budget for PLL1 relock, the reference manual quotes < 50us
+    MX6_DVFS_PLL_LOCK_US = 50,
+
+    // Budget for the CCM arm_podf divider handshake
+    MX6_DVFS_PODF_HANDSHAKE_US = 2,
+
+    // Settling margin added after the last LDO_ARM step
+    MX6_DVFS_VOLTAGE_SETTLE_US = 10,
+
+    MX6_DVFS_MAX_OPERATING_POINTS = 4,
+
+    // Step clock (PLL2 PFD2) the ARM clock is parked on while PLL1 relocks
+    MX6_DVFS_STEP_CLK_MHZ = 396,
+
+    MX6_DVFS_MAX_STEPS = 6,
+};
+
+//
+// Operating points in increasing order of frequency. The 396MHz point runs
+// PLL1 at 792MHz so that moving between it and 792MHz only changes the
+// divider. i.MX6 DualLite/Solo needs a higher VDD_ARM at the low point than
+// Dual/Quad.
+//
+static const MX6_DVFS_OPERATING_POINT Mx6DvfsOperatingPointsQuad[] = {
+    { 396, 66, 1,  975},
+    { 792, 66, 0, 1175},
+    { 996, 83, 0, 1250},
+};
+
+static const MX6_DVFS_OPERATING_POINT Mx6DvfsOperatingPointsDualLite[] = {
+    { 396, 66, 1, 1150},
+    { 792, 66, 0, 1175},
+    { 996, 83, 0, 1250},
+};
+
+static_assert(
+    ARRAYSIZE(Mx6DvfsOperatingPointsQuad) <= MX6_DVFS_MAX_OPERATING_POINTS,
+    "Operating point table exceeds MX6_DVFS_MAX_OPERATING_POINTS");
+
+static_assert(
+    ARRAYSIZE(Mx6DvfsOperatingPointsDualLite) <= MX6_DVFS_MAX_OPERATING_POINTS,
+    "Operating point table exceeds MX6_DVFS_MAX_OPERATING_POINTS");
+
+__forceinline ULONG Mx6DvfsArmFrequencyMhz (ULONG PllDivSelect, ULONG ArmPodf)
+{
+    return (MX6_DVFS_REF_CLK_MHZ * PllDivSelect / 2) / (ArmPodf + 1);
+}
+
+//
+// Rounds up so that the regulated voltage is never below the requirement.
+//
+__forceinline ULONG Mx6DvfsRegTargFromMv (ULONG Millivolts)
+{
+    return (Millivolts - MX6_DVFS_VDD_ARM_BASE_MV +
+            MX6_DVFS_VDD_ARM_STEP_MV - 1) / MX6_DVFS_VDD_ARM_STEP_MV;
+}
+
+//
+// Index of the slowest operating point that delivers at least
+// TargetFrequencyMhz, or the fastest one if none does.
+//
+inline ULONG Mx6DvfsSelectOperatingPoint (
+    _In_reads_(Count) const MX6_DVFS_OPERATING_POINT* OperatingPoints,
+    ULONG Count,
+    ULONG TargetFrequencyMhz
+    )
+{
+    NT_ASSERT(Count != 0);
+
+    for (ULONG i = 0; i < Count; ++i) {
+        if (OperatingPoints[i].FrequencyMhz >= TargetFrequencyMhz) {
+            return i;
+        }
+    }
+
+    return Count - 1;
+}
+
+//
+// Index of the operating point matching the given clock tree settings, or
+// Count if the ARM clock is not running from one of them.
+//
+inline ULONG Mx6DvfsFindOperatingPoint (
+    _In_reads_(Count) const MX6_DVFS_OPERATING_POINT* OperatingPoints,
+    ULONG Count,
+    ULONG PllDivSelect,
+    ULONG ArmPodf
+    )
+{
+    for (ULONG i = 0; i < Count; ++i) {
+        if ((OperatingPoints[i].PllDivSelect == PllDivSelect) &&
+            (OperatingPoints[i].ArmPodf == ArmPodf)) {
+
+            return i;
+        }
+    }
+
+    return Count;
+}
+
+//
+// Steps of a transition between two operating points. Voltage is raised
+// before the clock is sped up and lowered after it is slowed down. When PLL1
+// has to be reprogrammed the ARM clock is parked on the step clock
+// (PLL2 PFD2, 396MHz) while PLL1 relocks, which is no faster than any
+// operating point.
+//
+struct MX6_DVFS_TRANSITION {
+    ULONG RegTargBefore;    // REG0_TARG to program before the clock change, 0 if none
+    ULONG RegTargAfter;     // REG0_TARG to program after the clock change, 0 if none
+    ULONG VoltageSteps;     // Number of 25mV regulator steps
+    bool ChangePll;
+    bool ChangePodf;
+    ULONG LatencyUs;
+};
+
+inline void Mx6DvfsPlanTransition (
+    const MX6_DVFS_OPERATING_POINT* FromPtr,
+    const MX6_DVFS_OPERATING_POINT* ToPtr,
+    bool VoltageScaling,
+    ULONG VoltageStepTimeNs,
+    _Out_ MX6_DVFS_TRANSITION* PlanPtr
+    )
+{
+    RtlZeroMemory(PlanPtr, sizeof(*PlanPtr));
+
+    PlanPtr->ChangePll = FromPtr->PllDivSelect != ToPtr->PllDivSelect;
+    PlanPtr->ChangePodf = FromPtr->ArmPodf != ToPtr->ArmPodf;
+
+    if (VoltageScaling) {
+        const ULONG fromTarg = Mx6DvfsRegTargFromMv(FromPtr->VddArmMv);
+        const ULONG toTarg = Mx6DvfsRegTargFromMv(ToPtr->VddArmMv);
+        if (toTarg > fromTarg) {
+            PlanPtr->RegTargBefore = toTarg;
+            PlanPtr->VoltageSteps = toTarg - fromTarg;
+        } else if (toTarg < fromTarg) {
+            PlanPtr->RegTargAfter = toTarg;
+            PlanPtr->VoltageSteps = fromTarg - toTarg;
+        }
+    }
+
+    ULONG latencyUs = 0;
+    if (PlanPtr->VoltageSteps != 0) {
+        latencyUs += (PlanPtr->VoltageSteps * VoltageStepTimeNs + 999) / 1000;
+        latencyUs += MX6_DVFS_VOLTAGE_SETTLE_US;
+    }
+
+    if (PlanPtr->ChangePll) {
+        latencyUs += MX6_DVFS_PLL_LOCK_US;
+    }
+
+    if (PlanPtr->ChangePodf) {
+        latencyUs += MX6_DVFS_PODF_HANDSHAKE_US;
+    }
+
+    PlanPtr->LatencyUs = latencyUs;
+}
+
+//
+// Register changes of a transition, in the order they have to be made.
+//
+enum MX6_DVFS_STEP_TYPE : ULONG {
+    MX6_DVFS_STEP_SET_REG_TARG,     // PMU_REG_CORE.REG0_TARG = Value, wait for the ramp
+    MX6_DVFS_STEP_PARK_ARM_CLK,     // CCSR.step_sel = PLL2 PFD2, pll1_sw_clk_sel = step_clk
+    MX6_DVFS_STEP_SET_ARM_PODF,     // CACRR.arm_podf = Value, wait for the handshake
+    MX6_DVFS_STEP_SET_PLL_DIV,      // PLL_ARM.DIV_SELECT = Value, wait for lock
+    MX6_DVFS_STEP_UNPARK_ARM_CLK,   // CCSR.pll1_sw_clk_sel = pll1_main_clk
+};
+
+struct MX6_DVFS_STEP {
+    MX6_DVFS_STEP_TYPE Type;
+    ULONG Value;
+};
+
+//
+// Turns a transition plan into register steps and returns their number. The
+// divider is changed while the ARM clock is still parked, so it never runs
+// faster than the slower operating point from the relocked PLL1.
+//
+inline ULONG Mx6DvfsSequenceTransition (
+    const MX6_DVFS_TRANSITION* PlanPtr,
+    const MX6_DVFS_OPERATING_POINT* ToPtr,
+    _Out_writes_(MX6_DVFS_MAX_STEPS) MX6_DVFS_STEP* StepsPtr
+    )
+{
+    ULONG count = 0;
+
+    if (PlanPtr->RegTargBefore != 0) {
+        StepsPtr[count++] = {MX6_DVFS_STEP_SET_REG_TARG, PlanPtr->RegTargBefore};
+    }
+
+    if (PlanPtr->ChangePll) {
+        StepsPtr[count++] = {MX6_DVFS_STEP_PARK_ARM_CLK, 0};
+    }
+
+    if (PlanPtr->ChangePodf) {
+        StepsPtr[count++] = {MX6_DVFS_STEP_SET_ARM_PODF, ToPtr->ArmPodf};
+    }
+
+    if (PlanPtr->ChangePll) {
+        StepsPtr[count++] = {MX6_DVFS_STEP_SET_PLL_DIV, ToPtr->PllDivSelect};
+        StepsPtr[count++] = {MX6_DVFS_STEP_UNPARK_ARM_CLK, 0};
+    }
+
+    if (PlanPtr->RegTargAfter != 0) {
+        StepsPtr[count++] = {MX6_DVFS_STEP_SET_REG_TARG, PlanPtr->RegTargAfter};
+    }
+
+    NT_ASSERT(count <= MX6_DVFS_MAX_STEPS);
+    return count;
+}
+
+#endif // _MX6DVFS_H_
@@ -19,6 +19,8 @@
 #include "mx6peputil.h"
 #include "mx6pepioctl.h"
 #include "mx6pephw.h"
+#include "mx6dvfs.h"
+#include "mx6clktree.h"
 #include "mx6pep.h"
 
 MX6_NONPAGED_SEGMENT_BEGIN; //==============================================
@@ -327,13 +329,23 @@ BOOLEAN MX6_PEP::AcceptProcessorNotification (
             Handle,
             static_cast<PEP_PPM_TEST_IDLE_STATE*>(DataPtr));
 
+    case PEP_NOTIFY_PPM_QUERY_PERF_CAPABILITIES:
+        MX6_ASSERT_MAX_IRQL(PASSIVE_LEVEL);
+        return thisPtr->PpmQueryPerfCapabilities(
+            Handle,
+            static_cast<PEP_PPM_QUERY_PERF_CAPABILITIES*>(DataPtr));
+
+    case PEP_NOTIFY_PPM_PERF_SET:
+        MX6_ASSERT_MAX_IRQL(DISPATCH_LEVEL);
+        return thisPtr->PpmPerfSet(
+            Handle,
+            static_cast<PEP_PPM_PERF_SET*>(DataPtr));
+
     case PEP_NOTIFY_PPM_IS_PROCESSOR_HALTED:
     case PEP_NOTIFY_PPM_INITIATE_WAKE:
     case PEP_NOTIFY_PPM_QUERY_FEEDBACK_COUNTERS:
     case PEP_NOTIFY_PPM_FEEDBACK_READ:
-    case PEP_NOTIFY_PPM_QUERY_PERF_CAPABILITIES:
     case PEP_NOTIFY_PPM_PERF_CONSTRAINTS:
-    case PEP_NOTIFY_PPM_PERF_SET:
     case PEP_NOTIFY_PPM_PARK_SELECTION:
     case PEP_NOTIFY_PPM_CST_STATES:
     case PEP_NOTIFY_PPM_QUERY_PLATFORM_STATE:
@@ -408,15 +420,30 @@ NTSTATUS MX6_PEP::DispatchDeviceIoControl (DEVICE_OBJECT* DeviceObjectPtr, IRP*
     case IOCTL_MX6PEP_DUMP_REGISTERS:
         return thisPtr->ioctlDumpRegisters(DeviceObjectPtr, IrpPtr);
 
+    case IOCTL_MX6PEP_GET_IDLE_STATS:
+        return thisPtr->ioctlGetIdleStats(DeviceObjectPtr, IrpPtr);
+
     case IOCTL_MX6PEP_GET_CLOCK_GATE_REGISTERS:
         return thisPtr->ioctlGetClockGateRegisters(DeviceObjectPtr, IrpPtr);
 
     case IOCTL_MX6PEP_SET_CLOCK_GATE:
         return thisPtr->ioctlSetClockGate(DeviceObjectPtr, IrpPtr);
 
+    case IOCTL_MX6PEP_GET_CLOCK_NODE_STATS:
+        return thisPtr->ioctlGetClockNodeStats(DeviceObjectPtr, IrpPtr);
+
+    case IOCTL_MX6PEP_SET_CLOCK_GATE_DELAY:
+        return thisPtr->ioctlSetClockGateDelay(DeviceObjectPtr, IrpPtr);
+
     case IOCTL_MX6PEP_PROFILE_MMDC:
         return thisPtr->ioctlProfileMmdc(DeviceObjectPtr, IrpPtr);
 
+    case IOCTL_MX6PEP_CONFIGURE_MMDC_SAMPLING:
+        return thisPtr->ioctlConfigureMmdcSampling(DeviceObjectPtr, IrpPtr);
+
+    case IOCTL_MX6PEP_GET_MMDC_SAMPLES:
+        return thisPtr->ioctlGetMmdcSamples(DeviceObjectPtr, IrpPtr);
+
     case IOCTL_MX6PEP_WRITE_CCOSR:
         return thisPtr->ioctlWriteCcosr(DeviceObjectPtr, IrpPtr);
 
@@ -445,6 +472,112 @@ NTSTATUS MX6_PEP::DispatchUnhandledIrp (DEVICE_OBJECT* DeviceObjectPtr, IRP* Irp
     return IoCallDriver(thisPtr->lowerDeviceObjectPtr, IrpPtr);
 }
 
+//
+// Resets the MMDC profiling counters and starts counting the transactions
+// that match Filter.
+//
+_Use_decl_annotations_
+void MX6_PEP::restartMmdcProfiling (const MX6PEP_MMDC_AXI_FILTER& Filter)
+{
+    volatile MX6_MMDC_REGISTERS* registersPtr = this->mmdcRegistersPtr;
+
+    // reset
+    {
+        MX6_MMDC_MADPCR0_REG madpcr0 = {0};
+        madpcr0.DBG_RST = 1;
+        madpcr0.CYC_OVF = 1;
+        WRITE_REGISTER_NOFENCE_ULONG(&registersPtr->MADPCR0, madpcr0.AsUlong);
+    }
+
+    // configure AXI ID
+    {
+        MX6_MMDC_MADPCR1_REG madpcr1 = {0};
+        madpcr1.PRF_AXI_ID = Filter.AxiId;
+        madpcr1.PRF_AXI_ID_MASK = Filter.AxiIdMask;
+        WRITE_REGISTER_NOFENCE_ULONG(&registersPtr->MADPCR1, madpcr1.AsUlong);
+    }
+
+    // start profiling
+    {
+        MX6_MMDC_MADPCR0_REG madpcr0 = {0};
+        madpcr0.DBG_EN = 1;
+        WRITE_REGISTER_NOFENCE_ULONG(&registersPtr->MADPCR0, madpcr0.AsUlong);
+    }
+}
+
+_Use_decl_annotations_
+VOID
+MX6_PEP::mmdcSamplerDpcRoutine (
+    struct _KDPC * /*Dpc*/,
+    PVOID DeferredContext,
+    PVOID /*SystemArgument1*/,
+    PVOID /*SystemArgument2*/
+    )
+{
+    auto thisPtr = static_cast<MX6_PEP*>(DeferredContext);
+    auto samplerPtr = &thisPtr->mmdcSampler;
+    volatile MX6_MMDC_REGISTERS* registersPtr = thisPtr->mmdcRegistersPtr;
+
+    // Freeze profile so that the status registers are consistent
+    {
+        MX6_MMDC_MADPCR0_REG madpcr0 = {0};
+        madpcr0.DBG_EN = 1;
+        madpcr0.PRF_FRZ = 1;
+        WRITE_REGISTER_NOFENCE_ULONG(&registersPtr->MADPCR0, madpcr0.AsUlong);
+    }
+
+    const ULONGLONG now = KeQueryInterruptTime();
+
+    const MX6_MMDC_MADPCR0_REG madpcr0Reg =
+        {READ_REGISTER_NOFENCE_ULONG(&registersPtr->MADPCR0)};
+
+    const ULONG sequence = ULONG(samplerPtr->NextSequence);
+    MX6PEP_MMDC_SAMPLE* samplePtr =
+        &samplerPtr->RingPtr[sequence % MX6_MMDC_SAMPLE_RING_LENGTH];
+
+    auto sequencePtr = reinterpret_cast<volatile LONG*>(&samplePtr->Sequence);
+    InterlockedExchange(sequencePtr, LONG(MAXULONG));
+
+    samplePtr->FilterIndex = samplerPtr->FilterIndex;
+    samplePtr->Flags =
+        (madpcr0Reg.CYC_OVF != 0) ? MX6PEP_MMDC_SAMPLE_FLAG_OVERFLOW : 0;
+
+    samplePtr->DurationMicros =
+        static_cast<ULONG>((now - samplerPtr->IntervalStartTime) / 10);
+
+    samplePtr->Timestamp = now;
+    samplePtr->TotalProfilingCount =
+        READ_REGISTER_NOFENCE_ULONG(&registersPtr->MADPSR0);
+
+    samplePtr->BusyCycleCount =
+        READ_REGISTER_NOFENCE_ULONG(&registersPtr->MADPSR1);
+
+    samplePtr->ReadAccessCount =
+        READ_REGISTER_NOFENCE_ULONG(&registersPtr->MADPSR2);
+
+    samplePtr->WriteAccessCount =
+        READ_REGISTER_NOFENCE_ULONG(&registersPtr->MADPSR3);
+
+    samplePtr->BytesRead =
+        READ_REGISTER_NOFENCE_ULONG(&registersPtr->MADPSR4);
+
+    samplePtr->BytesWritten =
+        READ_REGISTER_NOFENCE_ULONG(&registersPtr->MADPSR5);
+
+    // Publish the sample
+    InterlockedExchange(sequencePtr, LONG(sequence));
+    InterlockedExchange(&samplerPtr->NextSequence, LONG(sequence + 1));
+
+    // Move on to the next filter
+    if (samplerPtr->FilterCount > 1) {
+        samplerPtr->FilterIndex =
+            (samplerPtr->FilterIndex + 1) % samplerPtr->FilterCount;
+    }
+
+    thisPtr->restartMmdcProfiling(samplerPtr->Filters[samplerPtr->FilterIndex]);
+    samplerPtr->IntervalStartTime = now;
+}
+
 MX6_NONPAGED_SEGMENT_END; //================================================
 MX6_PAGED_SEGMENT_BEGIN; //=================================================
 
@@ -718,6 +851,38 @@ NTSTATUS MX6_PEP::ioctlDumpRegisters (DEVICE_OBJECT* /*DeviceObjectPtr*/, IRP* I
     return MX6CompleteRequest(IrpPtr, STATUS_SUCCESS, sizeof(*outputBufferPtr));
 }
 
+_Use_decl_annotations_
+NTSTATUS MX6_PEP::ioctlGetIdleStats (DEVICE_OBJECT* /*DeviceObjectPtr*/, IRP* IrpPtr)
+{
+    MX6_ASSERT_MAX_IRQL(PASSIVE_LEVEL);
+    PAGED_CODE();
+
+    MX6PEP_GET_IDLE_STATS_OUTPUT* outputBufferPtr;
+    NTSTATUS status = MX6RetrieveOutputBuffer(IrpPtr, &outputBufferPtr);
+    if (!NT_SUCCESS(status)) {
+        return MX6CompleteRequest(IrpPtr, status);
+    }
+
+    //
+    // The idle path updates these counters concurrently; a torn read only
+    // skews the snapshot by the transition in progress.
+    //
+    outputBufferPtr->CpuCount = min(
+        KeQueryActiveProcessorCount(nullptr),
+        ULONG(ARRAYSIZE(outputBufferPtr->Cpus)));
+
+    static_assert(
+        sizeof(outputBufferPtr->Cpus) == sizeof(this->idleStats.Cpus),
+        "Verifying size of idle statistics");
+
+    RtlCopyMemory(
+        outputBufferPtr->Cpus,
+        this->idleStats.Cpus,
+        sizeof(outputBufferPtr->Cpus));
+
+    return MX6CompleteRequest(IrpPtr, STATUS_SUCCESS, sizeof(*outputBufferPtr));
+}
+
 _Use_decl_annotations_
 NTSTATUS MX6_PEP::ioctlGetClockGateRegisters (
     DEVICE_OBJECT* /*DeviceObjectPtr*/,
@@ -779,6 +944,58 @@ NTSTATUS MX6_PEP::ioctlSetClockGate (
     return MX6CompleteRequest(IrpPtr, STATUS_SUCCESS);
 }
 
+_Use_decl_annotations_
+NTSTATUS MX6_PEP::ioctlGetClockNodeStats (
+    DEVICE_OBJECT* /*DeviceObjectPtr*/,
+    IRP* IrpPtr
+    )
+{
+    MX6_ASSERT_MAX_IRQL(PASSIVE_LEVEL);
+    PAGED_CODE();
+
+    MX6PEP_GET_CLOCK_NODE_STATS_OUTPUT* outputBufferPtr;
+    NTSTATUS status = MX6RetrieveOutputBuffer(IrpPtr, &outputBufferPtr);
+    if (!NT_SUCCESS(status)) {
+        return MX6CompleteRequest(IrpPtr, status);
+    }
+
+    this->getClockNodeStats(outputBufferPtr);
+
+    return MX6CompleteRequest(IrpPtr, STATUS_SUCCESS, sizeof(*outputBufferPtr));
+}
+
+_Use_decl_annotations_
+NTSTATUS MX6_PEP::ioctlSetClockGateDelay (
+    DEVICE_OBJECT* /*DeviceObjectPtr*/,
+    IRP* IrpPtr
+    )
+{
+    MX6_ASSERT_MAX_IRQL(PASSIVE_LEVEL);
+    PAGED_CODE();
+
+    MX6PEP_SET_CLOCK_GATE_DELAY_INPUT* inputBufferPtr;
+    NTSTATUS status = MX6RetrieveInputBuffer(IrpPtr, &inputBufferPtr);
+    if (!NT_SUCCESS(status)) {
+        return MX6CompleteRequest(IrpPtr, status);
+    }
+
+    if (inputBufferPtr->GateDelayMicros > MX6_CLOCK_GATE_DELAY_MAX_MICROS) {
+        MX6_LOG_ERROR(
+            "Clock gate delay is out of range. (GateDelayMicros = %lu)",
+            inputBufferPtr->GateDelayMicros);
+
+        return MX6CompleteRequest(IrpPtr, STATUS_INVALID_PARAMETER);
+    }
+
+    this->setClockGateDelay(inputBufferPtr->GateDelayMicros);
+
+    MX6_LOG_INFORMATION(
+        "Set clock gate delay. (GateDelayMicros = %lu)",
+        inputBufferPtr->GateDelayMicros);
+
+    return MX6CompleteRequest(IrpPtr, STATUS_SUCCESS);
+}
+
 _Use_decl_annotations_
 NTSTATUS MX6_PEP::ioctlProfileMmdc (
     DEVICE_OBJECT* /*DeviceObjectPtr*/,
@@ -806,6 +1023,17 @@ NTSTATUS MX6_PEP::ioctlProfileMmdc (
         return MX6CompleteRequest(IrpPtr, STATUS_INVALID_PARAMETER);
     }
 
+    // The counters belong to the background sampler while it is running,
+    // hold the sampler lock so that it cannot be started under us
+    this->acquireMmdcSamplerLock();
+    auto releaseSamplerLock = MX6_FINALLY::Do([&] {
+        this->releaseMmdcSamplerLock();
+    });
+
+    if (this->mmdcSampler.IntervalMillis != 0) {
+        return MX6CompleteRequest(IrpPtr, STATUS_DEVICE_BUSY);
+    }
+
     volatile MX6_MMDC_REGISTERS* registersPtr = this->mmdcRegistersPtr;
 
     // reset
@@ -894,6 +1122,259 @@ NTSTATUS MX6_PEP::ioctlProfileMmdc (
     return MX6CompleteRequest(IrpPtr, STATUS_SUCCESS, sizeof(*outputBufferPtr));
 }
 
+_Use_decl_annotations_
+NTSTATUS MX6_PEP::ioctlConfigureMmdcSampling (
+    DEVICE_OBJECT* /*DeviceObjectPtr*/,
+    IRP* IrpPtr
+    )
+{
+    MX6_ASSERT_MAX_IRQL(PASSIVE_LEVEL);
+    PAGED_CODE();
+
+    MX6PEP_CONFIGURE_MMDC_SAMPLING_INPUT* inputBufferPtr;
+    NTSTATUS status = MX6RetrieveInputBuffer(IrpPtr, &inputBufferPtr);
+    if (!NT_SUCCESS(status)) {
+        return MX6CompleteRequest(IrpPtr, status);
+    }
+
+    const ULONG intervalMillis = inputBufferPtr->IntervalMillis;
+    if ((intervalMillis != 0) &&
+        ((intervalMillis < MX6_MMDC_SAMPLING_INTERVAL_MIN) ||
+         (intervalMillis > MX6_MMDC_SAMPLING_INTERVAL_MAX) ||
+         (inputBufferPtr->FilterCount > MX6_MMDC_SAMPLING_FILTER_MAX))) {
+
+        return MX6CompleteRequest(IrpPtr, STATUS_INVALID_PARAMETER);
+    }
+
+    auto samplerPtr = &this->mmdcSampler;
+
+    this->acquireMmdcSamplerLock();
+    auto releaseSamplerLock = MX6_FINALLY::Do([&] {
+        this->releaseMmdcSamplerLock();
+    });
+
+    // Allocate before stopping, so that a failure leaves sampling running
+    MX6PEP_MMDC_SAMPLE* ringPtr = samplerPtr->RingPtr;
+    if ((intervalMillis != 0) && (ringPtr == nullptr)) {
+        ringPtr = static_cast<MX6PEP_MMDC_SAMPLE*>(
+            ExAllocatePoolWithTag(
+                NonPagedPoolNx,
+                MX6_MMDC_SAMPLE_RING_LENGTH * sizeof(MX6PEP_MMDC_SAMPLE),
+                MX6PEP_POOL_TAG));
+
+        if (ringPtr == nullptr) {
+            MX6_LOG_LOW_MEMORY("Failed to allocate MMDC sample ring.");
+            return MX6CompleteRequest(IrpPtr, STATUS_INSUFFICIENT_RESOURCES);
+        }
+    }
+
+    // No sampler DPC runs past this point, so the configuration and the
+    // ring can change
+    this->stopMmdcSampling();
+    if (intervalMillis == 0) {
+        MX6_LOG_INFORMATION("Stopped MMDC sampling.");
+        return MX6CompleteRequest(IrpPtr, STATUS_SUCCESS);
+    }
+
+    samplerPtr->RingPtr = ringPtr;
+
+    if (inputBufferPtr->FilterCount == 0) {
+        // Profile the whole system
+        samplerPtr->FilterCount = 1;
+        samplerPtr->Filters[0] = MX6PEP_MMDC_AXI_FILTER();
+    } else {
+        samplerPtr->FilterCount = inputBufferPtr->FilterCount;
+        RtlCopyMemory(
+            samplerPtr->Filters,
+            inputBufferPtr->Filters,
+            inputBufferPtr->FilterCount * sizeof(MX6PEP_MMDC_AXI_FILTER));
+    }
+
+    ++samplerPtr->SessionId;
+    if (samplerPtr->SessionId == 0) {
+        samplerPtr->SessionId = 1;
+    }
+
+    samplerPtr->NextSequence = 0;
+    samplerPtr->FilterIndex = 0;
+    samplerPtr->IntervalMillis = intervalMillis;
+
+    this->restartMmdcProfiling(samplerPtr->Filters[0]);
+    samplerPtr->IntervalStartTime = KeQueryInterruptTime();
+
+    LARGE_INTEGER dueTime;
+    dueTime.QuadPart = -10000LL * intervalMillis;
+    KeSetTimerEx(
+        &samplerPtr->Timer,
+        dueTime,
+        LONG(intervalMillis),
+        &samplerPtr->Dpc);
+
+    MX6_LOG_INFORMATION(
+        "Started MMDC sampling. (SessionId = %d, IntervalMillis = %d, FilterCount = %d)",
+        samplerPtr->SessionId,
+        intervalMillis,
+        samplerPtr->FilterCount);
+
+    return MX6CompleteRequest(IrpPtr, STATUS_SUCCESS);
+}
+
+_Use_decl_annotations_
+NTSTATUS MX6_PEP::ioctlGetMmdcSamples (
+    DEVICE_OBJECT* /*DeviceObjectPtr*/,
+    IRP* IrpPtr
+    )
+{
+    MX6_ASSERT_MAX_IRQL(PASSIVE_LEVEL);
+    PAGED_CODE();
+
+    NTSTATUS status;
+
+    MX6PEP_GET_MMDC_SAMPLES_INPUT* inputBufferPtr;
+    status = MX6RetrieveInputBuffer(IrpPtr, &inputBufferPtr);
+    if (!NT_SUCCESS(status)) {
+        return MX6CompleteRequest(IrpPtr, status);
+    }
+
+    MX6PEP_GET_MMDC_SAMPLES_OUTPUT* outputBufferPtr;
+    status = MX6RetrieveOutputBuffer(IrpPtr, &outputBufferPtr);
+    if (!NT_SUCCESS(status)) {
+        return MX6CompleteRequest(IrpPtr, status);
+    }
+
+    auto samplerPtr = &this->mmdcSampler;
+
+    // The configuration and the ring only change under the lock, the ring
+    // slots are read without it
+    this->acquireMmdcSamplerLock();
+    auto releaseSamplerLock = MX6_FINALLY::Do([&] {
+        this->releaseMmdcSamplerLock();
+    });
+
+    // Input and output share the system buffer
+    ULONG startSequence = inputBufferPtr->StartSequence;
+    if ((inputBufferPtr->SessionId != 0) &&
+        (inputBufferPtr->SessionId != samplerPtr->SessionId)) {
+
+        startSequence = 0;
+    }
+
+    const ULONG outputLength = IoGetCurrentIrpStackLocation(IrpPtr)->
+        Parameters.DeviceIoControl.OutputBufferLength;
+
+    const ULONG capacity =
+        (outputLength - FIELD_OFFSET(MX6PEP_GET_MMDC_SAMPLES_OUTPUT, Samples)) /
+        sizeof(MX6PEP_MMDC_SAMPLE);
+
+    outputBufferPtr->SessionId = samplerPtr->SessionId;
+    outputBufferPtr->IntervalMillis = samplerPtr->IntervalMillis;
+    outputBufferPtr->FilterCount = samplerPtr->FilterCount;
+    RtlCopyMemory(
+        outputBufferPtr->Filters,
+        samplerPtr->Filters,
+        sizeof(outputBufferPtr->Filters));
+
+    ULONG nextSequence = 0;
+    if (samplerPtr->RingPtr != nullptr) {
+        nextSequence = ULONG(ReadAcquire(&samplerPtr->NextSequence));
+    }
+
+    if (startSequence > nextSequence) {
+        startSequence = nextSequence;
+    }
+
+    ULONG lostCount = 0;
+    if ((nextSequence - startSequence) > MX6_MMDC_SAMPLE_RING_LENGTH) {
+        lostCount = nextSequence - startSequence - MX6_MMDC_SAMPLE_RING_LENGTH;
+        startSequence = nextSequence - MX6_MMDC_SAMPLE_RING_LENGTH;
+    }
+
+    ULONG sampleCount = 0;
+    ULONG sequence = startSequence;
+    for (; (sequence != nextSequence) && (sampleCount < capacity); ++sequence) {
+        const MX6PEP_MMDC_SAMPLE* slotPtr =
+            &samplerPtr->RingPtr[sequence % MX6_MMDC_SAMPLE_RING_LENGTH];
+
+        auto sequencePtr =
+            reinterpret_cast<volatile LONG*>(
+                const_cast<ULONG*>(&slotPtr->Sequence));
+
+        const ULONG before = ULONG(ReadAcquire(sequencePtr));
+        const MX6PEP_MMDC_SAMPLE sample = *slotPtr;
+        KeMemoryBarrier();
+        const ULONG after = ULONG(ReadNoFence(sequencePtr));
+
+        // Overwritten by the sampler while it was being copied
+        if ((before != sequence) || (after != sequence)) {
+            ++lostCount;
+            continue;
+        }
+
+        outputBufferPtr->Samples[sampleCount] = sample;
+        outputBufferPtr->Samples[sampleCount].Sequence = sequence;
+        ++sampleCount;
+    }
+
+    outputBufferPtr->NextSequence = sequence;
+    outputBufferPtr->LostCount = lostCount;
+    outputBufferPtr->SampleCount = sampleCount;
+
+    return MX6CompleteRequest(
+        IrpPtr,
+        STATUS_SUCCESS,
+        FIELD_OFFSET(MX6PEP_GET_MMDC_SAMPLES_OUTPUT, Samples) +
+            (sampleCount * sizeof(MX6PEP_MMDC_SAMPLE)));
+}
+
+_Use_decl_annotations_
+void MX6_PEP::stopMmdcSampling ()
+{
+    MX6_ASSERT_MAX_IRQL(PASSIVE_LEVEL);
+    PAGED_CODE();
+
+    auto samplerPtr = &this->mmdcSampler;
+    if (samplerPtr->IntervalMillis == 0) {
+        return;
+    }
+
+    // A periodic timer may have queued the DPC again before it was
+    // cancelled, wait for every queued instance to finish
+    KeCancelTimer(&samplerPtr->Timer);
+    KeFlushQueuedDpcs();
+    samplerPtr->IntervalMillis = 0;
+
+    MX6_MMDC_MADPCR0_REG madpcr0 = {0};
+    WRITE_REGISTER_NOFENCE_ULONG(
+        &this->mmdcRegistersPtr->MADPCR0,
+        madpcr0.AsUlong);
+}
+
+_Use_decl_annotations_
+void MX6_PEP::acquireMmdcSamplerLock ()
+{
+    MX6_ASSERT_MAX_IRQL(PASSIVE_LEVEL);
+    PAGED_CODE();
+
+    NTSTATUS status = KeWaitForSingleObject(
+            &this->mmdcSampler.Lock,
+            Executive,
+            KernelMode,
+            FALSE,
+            nullptr);
+
+    UNREFERENCED_PARAMETER(status);
+    NT_ASSERT(status == STATUS_SUCCESS);
+}
+
+_Use_decl_annotations_
+void MX6_PEP::releaseMmdcSamplerLock ()
+{
+    MX6_ASSERT_MAX_IRQL(PASSIVE_LEVEL);
+    PAGED_CODE();
+
+    KeReleaseSemaphore(&this->mmdcSampler.Lock, IO_NO_INCREMENT, 1, FALSE);
+}
+
 _Use_decl_annotations_
 NTSTATUS MX6_PEP::ioctlWriteCcosr (
     DEVICE_OBJECT* /*DeviceObjectPtr*/,
@@ -1393,7 +1874,10 @@ MX6_PEP::MX6_PEP () :
     pepKernelInfo(),
     debugger(),
     workQueue(),
-    uartClockRefCount(0),
+    clockNodes(),
+    dvfs(),
+    idleStats(),
+    mmdcSampler(),
     gpuVpuDomainRefCount(0)
 {
     PAGED_CODE();
@@ -1404,7 +1888,15 @@ MX6_PEP::MX6_PEP () :
 
     KeInitializeSemaphore(&this->ioRequestSemaphore, 1, 1);
     KeInitializeSpinLock(&this->ccgrRegistersSpinLock);
-    KeInitializeSpinLock(&this->uartClockSpinLock);
+    KeInitializeSpinLock(&this->clockNodes.Lock);
+    KeInitializeTimer(&this->clockNodes.Timer);
+    KeInitializeDpc(&this->clockNodes.Dpc, clockNodeGateDpcRoutine, this);
+    this->clockNodes.GateDelayMicros = MX6_CLOCK_GATE_DELAY_DEFAULT_MICROS;
+    KeInitializeSpinLock(&this->dvfs.Lock);
+    KeQueryPerformanceCounter(&this->idleStats.Frequency);
+    KeInitializeSemaphore(&this->mmdcSampler.Lock, 1, 1);
+    KeInitializeTimer(&this->mmdcSampler.Timer);
+    KeInitializeDpc(&this->mmdcSampler.Dpc, mmdcSamplerDpcRoutine, this);
     KeInitializeEvent(&this->gpuVpuDomainStableEvent, SynchronizationEvent, TRUE);
     RtlZeroMemory(this->deviceData, sizeof(this->deviceData));
     KeInitializeSpinLock(&this->workQueue.ListLock);
@@ -1420,6 +1912,17 @@ MX6_PEP::~MX6_PEP ()
     // This destructed object should not be accessible
     NT_ASSERT(pepGlobalContextPtr == nullptr);
 
+    KeCancelTimer(&this->clockNodes.Timer);
+    KeFlushQueuedDpcs();
+
+    if (this->mmdcSampler.RingPtr != nullptr) {
+        this->acquireMmdcSamplerLock();
+        this->stopMmdcSampling();
+        ExFreePoolWithTag(this->mmdcSampler.RingPtr, MX6PEP_POOL_TAG);
+        this->mmdcSampler.RingPtr = nullptr;
+        this->releaseMmdcSamplerLock();
+    }
+
     // Disable device interface
     if (this->deviceInterfaceName.Buffer != nullptr) {
         NTSTATUS status = IoSetDeviceInterfaceState(
@@ -230,6 +230,18 @@ public: // NONPAGED
         _Inout_ PEP_PPM_TEST_IDLE_STATE* ArgsPtr
         );
 
+    _IRQL_requires_max_(PASSIVE_LEVEL)
+    BOOLEAN PpmQueryPerfCapabilities (
+        PEPHANDLE Handle,
+        _Inout_ PEP_PPM_QUERY_PERF_CAPABILITIES* ArgsPtr
+        );
+
+    _IRQL_requires_max_(DISPATCH_LEVEL)
+    BOOLEAN PpmPerfSet (
+        PEPHANDLE Handle,
+        _In_ PEP_PPM_PERF_SET* ArgsPtr
+        );
+
     //
     // Nonpaged WDM Dispatch Functions
     //
@@ -254,6 +266,7 @@ private: // NONPAGED
         POHANDLE KernelHandle;
         DEVICE_POWER_STATE PowerState;
         BOOLEAN isDeviceReserved;
+        bool ClockNodeReferenced;
     };
 
     typedef
@@ -325,14 +338,47 @@ private: // NONPAGED
 
     void configureGpuClockTree ();
 
+    static MX6_CLK_NODE clockNodeFromDeviceId (_DEVICE_ID DeviceId);
+
+    _IRQL_requires_max_(DISPATCH_LEVEL)
+    void setDeviceClocks (_DEVICE_ID DeviceId, bool On, bool GateNow = false);
+
+    _IRQL_requires_max_(DISPATCH_LEVEL)
+    void referenceClockNode (MX6_CLK_NODE Node);
+
+    _IRQL_requires_max_(DISPATCH_LEVEL)
+    void unreferenceClockNode (MX6_CLK_NODE Node, bool GateNow);
+
+    _IRQL_requires_(DISPATCH_LEVEL)
+    _Requires_lock_held_(this->clockNodes.Lock)
+    void referenceClockNodeLocked (MX6_CLK_NODE Node);
+
+    _IRQL_requires_(DISPATCH_LEVEL)
+    _Requires_lock_held_(this->clockNodes.Lock)
+    void gateClockNodeLocked (MX6_CLK_NODE Node);
+
+    _IRQL_requires_(DISPATCH_LEVEL)
+    _Requires_lock_held_(this->clockNodes.Lock)
+    void referenceClockTreeLocked (MX6_CLK_NODE Node);
+
+    _IRQL_requires_(DISPATCH_LEVEL)
+    _Requires_lock_held_(this->clockNodes.Lock)
+    void unreferenceClockTreeLocked (MX6_CLK_NODE Node);
+
+    _IRQL_requires_(DISPATCH_LEVEL)
+    _Requires_lock_held_(this->clockNodes.Lock)
+    void armClockNodeGateTimerLocked (ULONGLONG Now);
+
     _IRQL_requires_max_(DISPATCH_LEVEL)
-    void setUartD0 (_DEVICE_CONTEXT* ContextPtr);
+    void readClockMuxRegisters (_Out_ MX6PEP_DUMP_REGISTERS_OUTPUT* RegistersPtr);
+
+    static KDEFERRED_ROUTINE clockNodeGateDpcRoutine;
 
     _IRQL_requires_max_(DISPATCH_LEVEL)
-    void referenceUartClocks ();
+    void getClockNodeStats (_Out_ MX6PEP_GET_CLOCK_NODE_STATS_OUTPUT* OutputPtr);
 
     _IRQL_requires_max_(DISPATCH_LEVEL)
-    void unreferenceUartClocks ();
+    void setClockGateDelay (ULONG GateDelayMicros);
 
     _IRQL_requires_max_(PASSIVE_LEVEL)
     NTSTATUS connectUartInterrupt ();
@@ -343,15 +389,17 @@ private: // NONPAGED
     _IRQL_requires_max_(DISPATCH_LEVEL)
     BOOLEAN setComponentFx (PEP_NOTIFY_COMPONENT_IDLE_STATE* ArgsPtr);
 
-    _IRQL_requires_max_(DISPATCH_LEVEL)
-    void setSdhcClockGate (_DEVICE_ID DeviceId, bool On);
-
     _IRQL_requires_max_(DISPATCH_LEVEL)
     void applyEnetWorkaround ();
 
     _IRQL_requires_max_(DISPATCH_LEVEL)
     void queueWorkItem (_PWORKITEM_ROUTINE WorkRoutine, PVOID ContextPtr);
 
+    static KDEFERRED_ROUTINE mmdcSamplerDpcRoutine;
+
+    _IRQL_requires_max_(DISPATCH_LEVEL)
+    void restartMmdcProfiling (const MX6PEP_MMDC_AXI_FILTER& Filter);
+
     //
     // PPM Functions
     //
@@ -378,6 +426,15 @@ private: // NONPAGED
     _IRQL_requires_max_(HIGH_LEVEL)
     NTSTATUS updateGpcInterruptController ();
 
+    _IRQL_requires_max_(HIGH_LEVEL)
+    ULONG readWakeSource ();
+
+    _IRQL_requires_max_(HIGH_LEVEL)
+    void recordIdleExit (
+        ULONG Cpu,
+        _In_ const PEP_PPM_IDLE_COMPLETE_V2* ArgsPtr
+        );
+
     void writeClpcrWaitStop (ULONG Clpcr);
 
     void enableDebuggerWake ();
@@ -386,6 +443,13 @@ private: // NONPAGED
 
     void unmaskGpcInterrupts ();
 
+    _IRQL_requires_max_(PASSIVE_LEVEL)
+    void initializeDvfs ();
+
+    _IRQL_requires_max_(DISPATCH_LEVEL)
+    _Requires_lock_held_(this->dvfs.Lock)
+    NTSTATUS setOperatingPoint (ULONG Index);
+
     //
     // private members
     //
@@ -423,9 +487,72 @@ private: // NONPAGED
     KSPIN_LOCK ccgrRegistersSpinLock;
     ULONG ccgrRegistersShadow[ARRAYSIZE(MX6_CCM_REGISTERS::CCGR)];
 
-    // Stores number of references to UART_CLK_ENABLE and UART_SERIAL_CLK_ENABLE
-    KSPIN_LOCK uartClockSpinLock;
-    ULONG uartClockRefCount;
+    // Reference counted clock nodes, see mx6clknode.h. A node whose last
+    // reference is released stays ungated until GateDeadline so that devices
+    // cycling quickly between D0 and Dx do not toggle their gates every time.
+    // Clocks[Node] is the chain from the node's clock root towards its
+    // source, resolved when the node was ungated, and ClockRefCount counts
+    // the ungated nodes on each clock.
+    // Lock is acquired before ccgrRegistersSpinLock.
+    struct {
+        KSPIN_LOCK Lock;
+        KTIMER Timer;
+        KDPC Dpc;
+        bool TimerArmed;
+        ULONG GateDelayMicros;
+        ULONG RefCount[MX6_CLK_NODE_MAX];
+        bool Ungated[MX6_CLK_NODE_MAX];
+        ULONGLONG GateDeadline[MX6_CLK_NODE_MAX];   // Interrupt time
+        MX6PEP_CLOCK_NODE_STATS Stats[MX6_CLK_NODE_MAX];
+        MX6_CLK Clocks[MX6_CLK_NODE_MAX][MX6_CLK_TREE_DEPTH_MAX];
+        ULONG ClockCount[MX6_CLK_NODE_MAX];
+        ULONG ClockRefCount[MX6_CLK_MAX];
+    } clockNodes;
+
+    // ARM core operating point (P-state) of the shared CPU clock domain.
+    // OperatingPointCount is 0 when P-states are not supported. Lock also
+    // serializes read-modify-write of PMU_REG_CORE.
+    struct {
+        KSPIN_LOCK Lock;
+        const MX6_DVFS_OPERATING_POINT* OperatingPoints;
+        ULONG OperatingPointCount;
+        ULONG CurrentIndex;
+        bool VoltageScaling;
+        bool Initialized;
+        ULONG VoltageStepTimeNs;
+        ULONG MaxTransitionLatencyUs;
+        ULONG TransitionCount;
+        ULONG RequestedFrequencyMhz[4];     // Per CPU, 0 if no request yet
+    } dvfs;
+
+    // Idle state telemetry. Each CPU only updates its own entry, from the
+    // idle path.
+    struct {
+        LARGE_INTEGER Frequency;
+        ULONGLONG EntryTime[MX6PEP_CPU_COUNT_MAX];
+        MX6PEP_CPU_IDLE_STATS Cpus[MX6PEP_CPU_COUNT_MAX];
+    } idleStats;
+
+    // Background MMDC profiling. The sampler DPC is the only writer of the
+    // ring. A slot's Sequence is MAXULONG while it is being written, so
+    // readers can detect a sample that changed under them without a lock.
+    // Lock serializes configuring, reading and stopping the sampler, and
+    // one-shot profiling, which uses the same counters. The timer is
+    // cancelled and queued DPCs are flushed before the configuration or the
+    // ring change, so the DPC never sees them change.
+    struct {
+        KSEMAPHORE Lock;
+        KTIMER Timer;
+        KDPC Dpc;
+        MX6PEP_MMDC_SAMPLE* RingPtr;
+        volatile LONG NextSequence;
+        ULONG SessionId;
+        ULONG IntervalMillis;               // 0 when sampling is stopped
+        ULONG FilterCount;
+        ULONG FilterIndex;
+        ULONGLONG IntervalStartTime;
+        MX6PEP_MMDC_AXI_FILTER Filters[MX6_MMDC_SAMPLING_FILTER_MAX];
+    } mmdcSampler;
 
     // Stores refcount of the VDD_PU power domain
     KEVENT gpuVpuDomainStableEvent;
@@ -488,10 +615,22 @@ private: // PAGED
     _Requires_lock_held_(this->ioRequestSemaphore)
     NTSTATUS ioctlDumpRegisters (DEVICE_OBJECT* DeviceObjectPtr, IRP* IrpPtr);
 
+    _IRQL_requires_max_(PASSIVE_LEVEL)
+    _Requires_lock_held_(this->ioRequestSemaphore)
+    NTSTATUS ioctlGetIdleStats (DEVICE_OBJECT* DeviceObjectPtr, IRP* IrpPtr);
+
     _IRQL_requires_max_(PASSIVE_LEVEL)
     _Requires_lock_held_(this->ioRequestSemaphore)
     NTSTATUS ioctlGetClockGateRegisters (DEVICE_OBJECT* DeviceObjectPtr, IRP* IrpPtr);
 
+    _IRQL_requires_max_(PASSIVE_LEVEL)
+    _Requires_lock_held_(this->ioRequestSemaphore)
+    NTSTATUS ioctlGetClockNodeStats (DEVICE_OBJECT* DeviceObjectPtr, IRP* IrpPtr);
+
+    _IRQL_requires_max_(PASSIVE_LEVEL)
+    _Requires_lock_held_(this->ioRequestSemaphore)
+    NTSTATUS ioctlSetClockGateDelay (DEVICE_OBJECT* DeviceObjectPtr, IRP* IrpPtr);
+
     _IRQL_requires_max_(PASSIVE_LEVEL)
     _Requires_lock_held_(this->ioRequestSemaphore)
     NTSTATUS ioctlSetClockGate (DEVICE_OBJECT* DeviceObjectPtr, IRP* IrpPtr);
@@ -500,6 +639,26 @@ private: // PAGED
     _Requires_lock_held_(this->ioRequestSemaphore)
     NTSTATUS ioctlProfileMmdc (DEVICE_OBJECT* DeviceObjectPtr, IRP* IrpPtr);
 
+    _IRQL_requires_max_(PASSIVE_LEVEL)
+    _Requires_lock_held_(this->ioRequestSemaphore)
+    NTSTATUS ioctlConfigureMmdcSampling (DEVICE_OBJECT* DeviceObjectPtr, IRP* IrpPtr);
+
+    _IRQL_requires_max_(PASSIVE_LEVEL)
+    _Requires_lock_held_(this->ioRequestSemaphore)
+    NTSTATUS ioctlGetMmdcSamples (DEVICE_OBJECT* DeviceObjectPtr, IRP* IrpPtr);
+
+    _IRQL_requires_max_(PASSIVE_LEVEL)
+    _Requires_lock_held_(this->mmdcSampler.Lock)
+    void stopMmdcSampling ();
+
+    _IRQL_requires_max_(PASSIVE_LEVEL)
+    _Acquires_lock_(this->mmdcSampler.Lock)
+    void acquireMmdcSamplerLock ();
+
+    _IRQL_requires_max_(PASSIVE_LEVEL)
+    _Releases_lock_(this->mmdcSampler.Lock)
+    void releaseMmdcSamplerLock ();
+
     _IRQL_requires_max_(PASSIVE_LEVEL)
     _Requires_lock_held_(this->ioRequestSemaphore)
     NTSTATUS ioctlWriteCcosr (DEVICE_OBJECT* DeviceObjectPtr, IRP* IrpPtr);
@@ -92,6 +92,22 @@ union MX6_CCM_CACRR_REG {
     };
 } ;
 
+enum MX6_CCM_CDHIPR_BITS : ULONG {
+    MX6_CCM_CDHIPR_ARM_PODF_BUSY            = (1 << 16)
+};
+
+// CCSR.step_sel
+enum MX6_CCM_STEP_SEL {
+    MX6_CCM_STEP_SEL_OSC_CLK,
+    MX6_CCM_STEP_SEL_PLL2_PFD2,
+};
+
+// CCSR.pll1_sw_clk_sel
+enum MX6_CCM_PLL1_SW_CLK_SEL {
+    MX6_CCM_PLL1_SW_CLK_SEL_PLL1_MAIN_CLK,
+    MX6_CCM_PLL1_SW_CLK_SEL_STEP_CLK,
+};
+
 // CBCMR.gpu2d_axi_clk_sel
 enum MX6_CCM_GPU2D_AXI_CLK_SEL {
     MX6_CCM_GPU2D_AXI_CLK_SEL_AXI,
@@ -697,6 +713,19 @@ enum MX6_PMU_MISC0_BITS : ULONG {
     MX6_PMU_MISC0_STOP_MODE_CONFIG          = (1 << 12)
 };
 
+union MX6_PMU_MISC2_REG {
+    ULONG AsUlong;
+    struct {
+        // LSB
+        ULONG reserved1 : 24;               // 0-23
+        ULONG REG0_STEP_TIME : 2;           // 24-25 LDO_ARM ramp time per 25mV step, 64 << n cycles of the 24MHz clock
+        ULONG REG1_STEP_TIME : 2;           // 26-27 LDO_PU ramp time per 25mV step
+        ULONG REG2_STEP_TIME : 2;           // 28-29 LDO_SOC ramp time per 25mV step
+        ULONG reserved2 : 2;                // 30-31
+        // MSB
+    };
+};
+
 struct MX6_CCM_ANALOG_REGISTERS {
     ULONG PLL_ARM;                         // 0x000 Analog ARM PLL control Register (CCM_ANALOG_PLL_ARM)
     ULONG PLL_ARM_SET;                     // 0x004 Analog ARM PLL control Register (CCM_ANALOG_PLL_ARM_SET)
@@ -937,6 +966,23 @@ struct MX6_SCU_REGISTERS {
     ULONG FpgaRev;
 };
 
+//
+// GIC CPU Interface, offset from ARM MP base. Registers are banked per CPU.
+//
+#define MX6_GICC_OFFSET 0x100
+
+enum : ULONG { MX6_GICC_INTERRUPT_ID_MASK = 0x3ff };
+
+struct MX6_GICC_REGISTERS {
+    ULONG CTLR;                            // 0x00 CPU Interface Control Register (ICCICR)
+    ULONG PMR;                             // 0x04 Interrupt Priority Mask Register (ICCPMR)
+    ULONG BPR;                             // 0x08 Binary Point Register (ICCBPR)
+    ULONG IAR;                             // 0x0C Interrupt Acknowledge Register (ICCIAR)
+    ULONG EOIR;                            // 0x10 End of Interrupt Register (ICCEOIR)
+    ULONG RPR;                             // 0x14 Running Priority Register (ICCRPR)
+    ULONG HPPIR;                           // 0x18 Highest Pending Interrupt Register (ICCHPIR)
+};
+
 //
 // IOMUXC Registers
 //
@@ -32,6 +32,11 @@ enum {
     MX6PEP_IOCTL_ID_WRITE_CCOSR,
     MX6PEP_IOCTL_ID_GET_PAD_CONFIG,
     MX6PEP_IOCTL_ID_SET_PAD_CONFIG,
+    MX6PEP_IOCTL_ID_CONFIGURE_MMDC_SAMPLING,
+    MX6PEP_IOCTL_ID_GET_MMDC_SAMPLES,
+    MX6PEP_IOCTL_ID_GET_IDLE_STATS,
+    MX6PEP_IOCTL_ID_GET_CLOCK_NODE_STATS,
+    MX6PEP_IOCTL_ID_SET_CLOCK_GATE_DELAY,
 };
 
 enum MX6_CLK {
@@ -212,6 +217,38 @@ enum MX6_CCM_CCGR {
     MX6_CCM_CCGR_ON = 0x3,                  // Clock is on during all modes, except STOP mode.
 };
 
+//
+// Reference counted clock nodes managed by the PEP on behalf of devices.
+// A node groups the clock gates of a block. While a node is ungated, the
+// PEP also holds a reference on each clock between the node's clock root
+// and its source, as selected by the clock muxes.
+//
+enum MX6_CLK_NODE {
+    MX6_CLK_NODE_I2C1,
+    MX6_CLK_NODE_I2C2,
+    MX6_CLK_NODE_I2C3,
+    MX6_CLK_NODE_ECSPI1,
+    MX6_CLK_NODE_ECSPI2,
+    MX6_CLK_NODE_ECSPI3,
+    MX6_CLK_NODE_ECSPI4,
+    MX6_CLK_NODE_ECSPI5,
+    MX6_CLK_NODE_UART,
+    MX6_CLK_NODE_USDHC1,
+    MX6_CLK_NODE_USDHC2,
+    MX6_CLK_NODE_USDHC3,
+    MX6_CLK_NODE_USDHC4,
+    MX6_CLK_NODE_VPU,
+    MX6_CLK_NODE_SSI1,
+    MX6_CLK_NODE_SSI2,
+    MX6_CLK_NODE_SSI3,
+    MX6_CLK_NODE_ASRC,
+    MX6_CLK_NODE_ENET,
+    MX6_CLK_NODE_GPU,
+
+    MX6_CLK_NODE_MAX,
+    MX6_CLK_NODE_NONE = MX6_CLK_NODE_MAX,
+};
+
 //
 // IOCTL_MX6PEP_DUMP_REGISTERS
 //
@@ -462,6 +499,223 @@ typedef struct _MX6PEP_SET_PAD_CONFIG_INPUT {
     ULONG PadControlRegister;
 } MX6PEP_SET_PAD_CONFIG_INPUT, *PMX6PEP_SET_PAD_CONFIG_INPUT;
 
+//
+// IOCTL_MX6PEP_CONFIGURE_MMDC_SAMPLING
+//
+// Start, restart or stop background MMDC profiling. Every IntervalMillis a
+// timer DPC snapshots the MMDC profiling counters into a ring buffer and
+// resets them, so intervals are short enough that the counters cannot
+// overflow. The MMDC can only filter on one AXI ID at a time; when several
+// filters are given they are applied in turn, one per interval, and each
+// sample records which filter it was taken with.
+//
+// Restarting sampling discards the samples collected so far. While sampling
+// is active IOCTL_MX6PEP_PROFILE_MMDC fails with STATUS_DEVICE_BUSY.
+//
+// Input: MX6PEP_CONFIGURE_MMDC_SAMPLING_INPUT (IntervalMillis = 0 stops sampling)
+// Output: none
+//
+enum {
+    IOCTL_MX6PEP_CONFIGURE_MMDC_SAMPLING = ULONG(
+        CTL_CODE(
+            MX6PEP_FILE_DEVICE,
+            MX6PEP_IOCTL_ID_CONFIGURE_MMDC_SAMPLING,
+            METHOD_BUFFERED,
+            FILE_READ_DATA | FILE_WRITE_DATA))
+};
+
+enum {
+    MX6_MMDC_SAMPLING_INTERVAL_MIN = 10,
+    MX6_MMDC_SAMPLING_INTERVAL_MAX = MX6_MMDC_PROFILE_DURATION_MAX,
+    MX6_MMDC_SAMPLING_FILTER_MAX = 32,
+    MX6_MMDC_SAMPLE_RING_LENGTH = 2048,
+};
+
+typedef struct _MX6PEP_MMDC_AXI_FILTER {
+    UINT16 AxiId;
+    UINT16 AxiIdMask;
+} MX6PEP_MMDC_AXI_FILTER, *PMX6PEP_MMDC_AXI_FILTER;
+
+typedef struct _MX6PEP_CONFIGURE_MMDC_SAMPLING_INPUT {
+    ULONG IntervalMillis;
+    ULONG FilterCount;                      // 0 profiles the whole system
+    MX6PEP_MMDC_AXI_FILTER Filters[MX6_MMDC_SAMPLING_FILTER_MAX];
+} MX6PEP_CONFIGURE_MMDC_SAMPLING_INPUT, *PMX6PEP_CONFIGURE_MMDC_SAMPLING_INPUT;
+
+//
+// IOCTL_MX6PEP_GET_MMDC_SAMPLES
+//
+// Retrieve samples collected by background MMDC profiling, starting with
+// sample StartSequence. As many samples as fit in the output buffer are
+// returned. Samples that were overwritten before they could be retrieved are
+// counted in LostCount. Pass NextSequence as StartSequence of the following
+// request to continue where this one left off. SessionId changes each time
+// sampling is restarted, at which point sequence numbers start again at 0.
+//
+// Input: MX6PEP_GET_MMDC_SAMPLES_INPUT
+// Output: MX6PEP_GET_MMDC_SAMPLES_OUTPUT
+//
+enum {
+    IOCTL_MX6PEP_GET_MMDC_SAMPLES = ULONG(
+        CTL_CODE(
+            MX6PEP_FILE_DEVICE,
+            MX6PEP_IOCTL_ID_GET_MMDC_SAMPLES,
+            METHOD_BUFFERED,
+            FILE_READ_DATA))
+};
+
+enum { MX6PEP_MMDC_SAMPLE_FLAG_OVERFLOW = 0x1 };
+
+typedef struct _MX6PEP_MMDC_SAMPLE {
+    ULONG Sequence;
+    ULONG FilterIndex;                      // Index into Filters, 0 if FilterCount is 0
+    ULONG Flags;                            // MX6PEP_MMDC_SAMPLE_FLAG_*
+    ULONG DurationMicros;
+    ULONGLONG Timestamp;                    // KeQueryInterruptTime() at end of interval
+    ULONG TotalProfilingCount;
+    ULONG BusyCycleCount;
+    ULONG ReadAccessCount;
+    ULONG WriteAccessCount;
+    ULONG BytesRead;
+    ULONG BytesWritten;
+} MX6PEP_MMDC_SAMPLE, *PMX6PEP_MMDC_SAMPLE;
+
+typedef struct _MX6PEP_GET_MMDC_SAMPLES_INPUT {
+    ULONG SessionId;                        // 0 matches any session
+    ULONG StartSequence;
+} MX6PEP_GET_MMDC_SAMPLES_INPUT, *PMX6PEP_GET_MMDC_SAMPLES_INPUT;
+
+typedef struct _MX6PEP_GET_MMDC_SAMPLES_OUTPUT {
+    ULONG SessionId;                        // 0 if sampling was never started
+    ULONG IntervalMillis;                   // 0 if sampling is stopped
+    ULONG FilterCount;
+    MX6PEP_MMDC_AXI_FILTER Filters[MX6_MMDC_SAMPLING_FILTER_MAX];
+    ULONG NextSequence;
+    ULONG LostCount;
+    ULONG SampleCount;
+    MX6PEP_MMDC_SAMPLE Samples[ANYSIZE_ARRAY];
+} MX6PEP_GET_MMDC_SAMPLES_OUTPUT, *PMX6PEP_GET_MMDC_SAMPLES_OUTPUT;
+
+//
+// IOCTL_MX6PEP_GET_IDLE_STATS
+//
+// Retrieve idle state telemetry collected since boot: per CPU entry counts
+// and residency histograms of each processor and platform idle state, and
+// the interrupt that woke the SoC from each platform idle state. Platform
+// state statistics are kept by the CPU that entered the platform state.
+// Counters are updated without synchronization with this IOCTL, so a
+// snapshot may be off by the transitions in progress.
+//
+// Residency histogram bucket 0 counts residencies below 1us, bucket i counts
+// residencies in [2^(i-1), 2^i) microseconds, and the last bucket also counts
+// everything longer.
+//
+// Input: none
+// Output: MX6PEP_GET_IDLE_STATS_OUTPUT
+//
+enum {
+    IOCTL_MX6PEP_GET_IDLE_STATS = ULONG(
+        CTL_CODE(
+            MX6PEP_FILE_DEVICE,
+            MX6PEP_IOCTL_ID_GET_IDLE_STATS,
+            METHOD_BUFFERED,
+            FILE_READ_DATA))
+};
+
+enum {
+    MX6PEP_CPU_COUNT_MAX = 4,
+    MX6PEP_CPU_IDLE_STATE_COUNT = 3,        // WFI, WFI2, POWER_GATED
+    MX6PEP_PLATFORM_IDLE_STATE_COUNT = 3,   // WAIT, STOP_LIGHT, ARM_OFF
+    MX6PEP_IDLE_RESIDENCY_BUCKET_COUNT = 24,
+
+    // Wake sources are GIC interrupt IDs. Interrupts 32-159 are identified
+    // from the GPC, lower IDs from the GIC CPU interface.
+    MX6PEP_WAKE_SOURCE_UNKNOWN = 160,
+    MX6PEP_WAKE_SOURCE_COUNT,
+};
+
+typedef struct _MX6PEP_IDLE_STATE_STATS {
+    ULONGLONG EntryCount;
+    ULONGLONG TotalResidencyMicros;
+    ULONG ResidencyHistogram[MX6PEP_IDLE_RESIDENCY_BUCKET_COUNT];
+} MX6PEP_IDLE_STATE_STATS, *PMX6PEP_IDLE_STATE_STATS;
+
+typedef struct _MX6PEP_CPU_IDLE_STATS {
+    MX6PEP_IDLE_STATE_STATS ProcessorStates[MX6PEP_CPU_IDLE_STATE_COUNT];
+    MX6PEP_IDLE_STATE_STATS PlatformStates[MX6PEP_PLATFORM_IDLE_STATE_COUNT];
+    ULONG PlatformWakeSourceCount[MX6PEP_WAKE_SOURCE_COUNT];
+    ULONG LastPlatformWakeSource;
+} MX6PEP_CPU_IDLE_STATS, *PMX6PEP_CPU_IDLE_STATS;
+
+typedef struct _MX6PEP_GET_IDLE_STATS_OUTPUT {
+    ULONG CpuCount;
+    MX6PEP_CPU_IDLE_STATS Cpus[MX6PEP_CPU_COUNT_MAX];
+} MX6PEP_GET_IDLE_STATS_OUTPUT, *PMX6PEP_GET_IDLE_STATS_OUTPUT;
+
+//
+// IOCTL_MX6PEP_GET_CLOCK_NODE_STATS
+//
+// Retrieve the reference count, state and transition counts of each clock
+// node. When the last reference to a node is released, the node is gated
+// after GateDelayMicros unless it is referenced again in the meantime,
+// which is counted in GateCancelCount. ClockRefCount is the number of
+// ungated nodes fed by each clock of the clock tree.
+//
+// Input: none
+// Output: MX6PEP_GET_CLOCK_NODE_STATS_OUTPUT
+//
+enum {
+    IOCTL_MX6PEP_GET_CLOCK_NODE_STATS = ULONG(
+        CTL_CODE(
+            MX6PEP_FILE_DEVICE,
+            MX6PEP_IOCTL_ID_GET_CLOCK_NODE_STATS,
+            METHOD_BUFFERED,
+            FILE_READ_DATA))
+};
+
+typedef struct _MX6PEP_CLOCK_NODE_STATS {
+    ULONG RefCount;
+    ULONG Ungated;
+    ULONG UngateCount;
+    ULONG GateCount;
+    ULONG GateCancelCount;
+} MX6PEP_CLOCK_NODE_STATS, *PMX6PEP_CLOCK_NODE_STATS;
+
+typedef struct _MX6PEP_GET_CLOCK_NODE_STATS_OUTPUT {
+    ULONG GateDelayMicros;
+    MX6PEP_CLOCK_NODE_STATS Nodes[MX6_CLK_NODE_MAX];
+    ULONG ClockRefCount[MX6_CLK_MAX];
+} MX6PEP_GET_CLOCK_NODE_STATS_OUTPUT, *PMX6PEP_GET_CLOCK_NODE_STATS_OUTPUT;
+
+//
+// IOCTL_MX6PEP_SET_CLOCK_GATE_DELAY
+//
+// Set how long a clock node stays ungated after its last reference is
+// released. A delay of 0 gates nodes as soon as they are released. Nodes
+// already waiting to be gated are rescheduled to be gated the new delay
+// after the call, or right away if the new delay is 0.
+//
+// Input: MX6PEP_SET_CLOCK_GATE_DELAY_INPUT
+// Output: none
+//
+enum {
+    IOCTL_MX6PEP_SET_CLOCK_GATE_DELAY = ULONG(
+        CTL_CODE(
+            MX6PEP_FILE_DEVICE,
+            MX6PEP_IOCTL_ID_SET_CLOCK_GATE_DELAY,
+            METHOD_BUFFERED,
+            FILE_WRITE_DATA))
+};
+
+enum : ULONG {
+    MX6_CLOCK_GATE_DELAY_DEFAULT_MICROS = 10000,
+    MX6_CLOCK_GATE_DELAY_MAX_MICROS = 1000000,
+};
+
+typedef struct _MX6PEP_SET_CLOCK_GATE_DELAY_INPUT {
+    ULONG GateDelayMicros;
+} MX6PEP_SET_CLOCK_GATE_DELAY_INPUT, *PMX6PEP_SET_CLOCK_GATE_DELAY_INPUT;
+
 #ifdef __cplusplus
 } // extern "C"
 #endif // __cplusplus
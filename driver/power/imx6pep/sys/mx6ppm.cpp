@@ -19,6 +19,8 @@
 #include "mx6peputil.h"
 #include "mx6pepioctl.h"
 #include "mx6pephw.h"
+#include "mx6dvfs.h"
+#include "mx6clktree.h"
 #include "mx6pep.h"
 
 MX6_NONPAGED_SEGMENT_BEGIN; //==============================================
@@ -59,9 +61,14 @@ BOOLEAN MX6_PEP::PpmQueryCapabilities (
             (deviceId == _DEVICE_ID::CPU3));
     }
 
+    if (!this->dvfs.Initialized) {
+        this->initializeDvfs();
+    }
+
     ArgsPtr->FeedbackCounterCount = 0;
     ArgsPtr->IdleStateCount = CPU_IDLE_STATE_COUNT;
-    ArgsPtr->PerformanceStatesSupported = FALSE;
+    ArgsPtr->PerformanceStatesSupported =
+        (this->dvfs.OperatingPointCount > 1) ? TRUE : FALSE;
     ArgsPtr->ParkingSupported = FALSE;
 
     ++this->activeProcessorCount;
@@ -316,14 +323,31 @@ BOOLEAN MX6_PEP::PpmQueryCoordinatedDependency (
     return TRUE;
 }
 
+static_assert(
+    ULONG(MX6_PEP::CPU_IDLE_STATE_COUNT) == MX6PEP_CPU_IDLE_STATE_COUNT,
+    "MX6PEP_CPU_IDLE_STATE_COUNT must match CPU_IDLE_STATE_COUNT");
+
+static_assert(
+    ULONG(MX6_PEP::PLATFORM_IDLE_STATE_COUNT) ==
+        MX6PEP_PLATFORM_IDLE_STATE_COUNT,
+    "MX6PEP_PLATFORM_IDLE_STATE_COUNT must match PLATFORM_IDLE_STATE_COUNT");
+
 _Use_decl_annotations_
 BOOLEAN MX6_PEP::PpmIdleExecute (
-    PEPHANDLE /*Handle*/,
+    PEPHANDLE Handle,
     PEP_PPM_IDLE_EXECUTE_V2* ArgsPtr
     )
 {
     NT_ASSERT(ArgsPtr->Status == STATUS_SUCCESS);
 
+    const ULONG cpu =
+        ULONG(pepDeviceIdFromPepHandle(Handle)) - ULONG(_DEVICE_ID::CPU0);
+
+    if (cpu < ARRAYSIZE(this->idleStats.EntryTime)) {
+        this->idleStats.EntryTime[cpu] =
+            KeQueryPerformanceCounter(nullptr).QuadPart;
+    }
+
     switch (ArgsPtr->PlatformState) {
     case PEP_PLATFORM_IDLE_STATE_NONE:
     {
@@ -370,10 +394,18 @@ BOOLEAN MX6_PEP::PpmIdleExecute (
 
 _Use_decl_annotations_
 BOOLEAN MX6_PEP::PpmIdleComplete (
-    PEPHANDLE /*Handle*/,
+    PEPHANDLE Handle,
     PEP_PPM_IDLE_COMPLETE_V2* ArgsPtr
     )
 {
+    //
+    // Record statistics first so that the wake interrupt is still pending
+    // and residency does not include the exit work below.
+    //
+    this->recordIdleExit(
+        ULONG(pepDeviceIdFromPepHandle(Handle)) - ULONG(_DEVICE_ID::CPU0),
+        ArgsPtr);
+
     switch (ArgsPtr->PlatformState) {
     case PLATFORM_IDLE_STATE_ARM_OFF:
 
@@ -508,6 +540,107 @@ BOOLEAN MX6_PEP::PpmTestIdleState (
     return TRUE;
 }
 
+//
+// Performance is expressed as the ARM core clock in MHz. The OS sees a
+// continuous range between the slowest and fastest operating point, and each
+// request is rounded up to the next operating point.
+//
+_Use_decl_annotations_
+BOOLEAN MX6_PEP::PpmQueryPerfCapabilities (
+    PEPHANDLE /*Handle*/,
+    PEP_PPM_QUERY_PERF_CAPABILITIES* ArgsPtr
+    )
+{
+    const ULONG count = this->dvfs.OperatingPointCount;
+    if (count < 2) {
+        return FALSE;
+    }
+
+    const MX6_DVFS_OPERATING_POINT* operatingPoints =
+        this->dvfs.OperatingPoints;
+
+    ArgsPtr->HighestPerformance = operatingPoints[count - 1].FrequencyMhz;
+    ArgsPtr->NominalPerformance = operatingPoints[count - 1].FrequencyMhz;
+    ArgsPtr->LowestNonlinearPerformance = operatingPoints[0].FrequencyMhz;
+    ArgsPtr->LowestPerformance = operatingPoints[0].FrequencyMhz;
+
+    //
+    // All cores are clocked from PLL1 and supplied by VDD_ARM, so they form
+    // a single performance domain.
+    //
+    ArgsPtr->DomainId = 0;
+    ArgsPtr->DomainMembers = KeQueryActiveProcessorCount(nullptr);
+
+    return TRUE;
+}
+
+_Use_decl_annotations_
+BOOLEAN MX6_PEP::PpmPerfSet (
+    PEPHANDLE Handle,
+    PEP_PPM_PERF_SET* ArgsPtr
+    )
+{
+    const ULONG cpu =
+        ULONG(pepDeviceIdFromPepHandle(Handle)) - ULONG(_DEVICE_ID::CPU0);
+
+    if ((this->dvfs.OperatingPointCount < 2) ||
+        (cpu >= ARRAYSIZE(this->dvfs.RequestedFrequencyMhz))) {
+
+        return FALSE;
+    }
+
+    //
+    // A desired performance of 0 leaves the choice to the platform within
+    // the given limits. There is no autonomous control on i.MX6, so run at
+    // the upper limit.
+    //
+    ULONG targetMhz = ArgsPtr->DesiredPerformance;
+    if (targetMhz == 0) {
+        targetMhz = ArgsPtr->MaximumPerformance;
+    }
+
+    if ((ArgsPtr->MaximumPerformance != 0) &&
+        (targetMhz > ArgsPtr->MaximumPerformance)) {
+
+        targetMhz = ArgsPtr->MaximumPerformance;
+    }
+
+    if (targetMhz < ArgsPtr->MinimumPerformance) {
+        targetMhz = ArgsPtr->MinimumPerformance;
+    }
+
+    MX6_SPINLOCK_GUARD lock(&this->dvfs.Lock);
+
+    this->dvfs.RequestedFrequencyMhz[cpu] = targetMhz;
+
+    //
+    // The domain runs fast enough for its most demanding core
+    //
+    ULONG domainTargetMhz = 0;
+    for (ULONG i = 0; i < ARRAYSIZE(this->dvfs.RequestedFrequencyMhz); ++i) {
+        if (this->dvfs.RequestedFrequencyMhz[i] > domainTargetMhz) {
+            domainTargetMhz = this->dvfs.RequestedFrequencyMhz[i];
+        }
+    }
+
+    // P-states may have been disabled by a failed transition
+    if (this->dvfs.OperatingPointCount < 2) {
+        return TRUE;
+    }
+
+    const ULONG index = Mx6DvfsSelectOperatingPoint(
+            this->dvfs.OperatingPoints,
+            this->dvfs.OperatingPointCount,
+            domainTargetMhz);
+
+    if (index != this->dvfs.CurrentIndex) {
+        NTSTATUS status = this->setOperatingPoint(index);
+        UNREFERENCED_PARAMETER(status);
+    }
+
+    return TRUE;
+}
+
 MX6_PEP::_DEVICE_ID MX6_PEP::deviceIdFromDependencyIndex (ULONG DependencyIndex)
 {
     switch (DependencyIndex) {
@@ -831,6 +964,112 @@ NTSTATUS MX6_PEP::updateGpcInterruptController ()
     return STATUS_SUCCESS;
 }
 
+//
+// Identify the interrupt that brought the SoC out of a platform idle state.
+// Must be called on the woken CPU before interrupts are reenabled.
+//
+_Use_decl_annotations_
+ULONG MX6_PEP::readWakeSource ()
+{
+    //
+    // Interrupts 32-159 wake the SoC through the GPC. IRQ 32 is the IOMUXC
+    // GINT line, which is held asserted for the ERR007265 workaround and
+    // says nothing about the wake source.
+    //
+    const ULONG iomuxcIrqNum = 32;
+    for (ULONG i = 0; i < ARRAYSIZE(this->gpcRegistersPtr->ISR); ++i) {
+        ULONG pending =
+            READ_REGISTER_NOFENCE_ULONG(&this->gpcRegistersPtr->ISR[i]) &
+            this->unmaskedInterruptsCopy.Mask[i];
+
+        if (i == 0) {
+            pending &= ~(1 << (iomuxcIrqNum % 32));
+        }
+
+        ULONG bit;
+        if (_BitScanForward(&bit, pending) != 0) {
+            return 32 + (i * 32) + bit;
+        }
+    }
+
+    //
+    // SGIs and PPIs do not go through the GPC, ask the GIC
+    //
+    auto giccRegistersPtr = reinterpret_cast<volatile MX6_GICC_REGISTERS*>(
+        static_cast<volatile char*>(this->armMpRegistersPtr) +
+        MX6_GICC_OFFSET);
+
+    const ULONG interruptId =
+        READ_REGISTER_NOFENCE_ULONG(&giccRegistersPtr->HPPIR) &
+        MX6_GICC_INTERRUPT_ID_MASK;
+
+    if (interruptId < MX6PEP_WAKE_SOURCE_UNKNOWN) {
+        return interruptId;
+    }
+
+    return MX6PEP_WAKE_SOURCE_UNKNOWN;
+}
+
+//
+// Account the residency of the idle state this CPU is leaving. Each CPU
+// only touches its own statistics, and runs here with interrupts disabled,
+// so no lock is needed. Platform states are accounted to the CPU that
+// executed the coordinated transition.
+//
+_Use_decl_annotations_
+void MX6_PEP::recordIdleExit (
+    ULONG Cpu,
+    const PEP_PPM_IDLE_COMPLETE_V2* ArgsPtr
+    )
+{
+    if (Cpu >= ARRAYSIZE(this->idleStats.Cpus)) {
+        return;
+    }
+
+    auto cpuStatsPtr = &this->idleStats.Cpus[Cpu];
+    MX6PEP_IDLE_STATE_STATS* stateStatsPtr;
+    if (ArgsPtr->PlatformState == PEP_PLATFORM_IDLE_STATE_NONE) {
+        if (ArgsPtr->ProcessorState >= ARRAYSIZE(cpuStatsPtr->ProcessorStates)) {
+            return;
+        }
+
+        stateStatsPtr = &cpuStatsPtr->ProcessorStates[ArgsPtr->ProcessorState];
+    } else {
+        if (ArgsPtr->PlatformState >= ARRAYSIZE(cpuStatsPtr->PlatformStates)) {
+            return;
+        }
+
+        stateStatsPtr = &cpuStatsPtr->PlatformStates[ArgsPtr->PlatformState];
+
+        const ULONG wakeSource = this->readWakeSource();
+        cpuStatsPtr->PlatformWakeSourceCount[wakeSource] += 1;
+        cpuStatsPtr->LastPlatformWakeSource = wakeSource;
+    }
+
+    const ULONGLONG ticks =
+        ULONGLONG(KeQueryPerformanceCounter(nullptr).QuadPart) -
+        this->idleStats.EntryTime[Cpu];
+
+    const ULONGLONG residencyMicros =
+        (ticks * 1000000) / ULONGLONG(this->idleStats.Frequency.QuadPart);
+
+    //
+    // Bucket 0 is below 1us, bucket i is [2^(i-1), 2^i) microseconds
+    //
+    const ULONG clampedMicros = ULONG(min(residencyMicros, ULONGLONG(MAXULONG)));
+    ULONG bucket = 0;
+    ULONG highBit;
+    if (_BitScanReverse(&highBit, clampedMicros) != 0) {
+        bucket = min(
+            highBit + 1,
+            ULONG(ARRAYSIZE(stateStatsPtr->ResidencyHistogram) - 1));
+    }
+
+    stateStatsPtr->EntryCount += 1;
+    stateStatsPtr->TotalResidencyMicros += residencyMicros;
+    stateStatsPtr->ResidencyHistogram[bucket] += 1;
+}
+
 //
 // Use the sequence in Errata ERR007265 to set LPM to WAIT or STOP mode.
 //
@@ -905,5 +1144,311 @@ void MX6_PEP::unmaskGpcInterrupts ()
     }
 }
 
+//
+// Chooses the operating point table for the part and finds the operating
+// point firmware booted at. Operating points faster than the boot one are
+// not exposed since the speed grade fuse is not consulted, and firmware is
+// expected to boot at the fastest point the part is rated for.
+//
+_Use_decl_annotations_
+void MX6_PEP::initializeDvfs ()
+{
+    MX6_ASSERT_MAX_IRQL(PASSIVE_LEVEL);
+
+    this->dvfs.Initialized = true;
+    this->dvfs.OperatingPointCount = 0;
+
+    UINT32 cpuRev;
+    NTSTATUS status = ImxGetCpuRev(&cpuRev);
+    if (!NT_SUCCESS(status)) {
+        MX6_LOG_ERROR(
+            "Failed to get CPU rev/type, P-states are disabled. (status = %!STATUS!)",
+            status);
+
+        return;
+    }
+
+    const MX6_DVFS_OPERATING_POINT* operatingPoints;
+    ULONG count;
+    switch (IMX_CPU_TYPE(cpuRev)) {
+    case IMX_CPU_MX6Q:
+    case IMX_CPU_MX6D:
+        operatingPoints = Mx6DvfsOperatingPointsQuad;
+        count = ARRAYSIZE(Mx6DvfsOperatingPointsQuad);
+        break;
+
+    case IMX_CPU_MX6DL:
+    case IMX_CPU_MX6SOLO:
+        operatingPoints = Mx6DvfsOperatingPointsDualLite;
+        count = ARRAYSIZE(Mx6DvfsOperatingPointsDualLite);
+        break;
+
+    default:
+        MX6_LOG_INFORMATION(
+            "No operating points for this CPU type, P-states are disabled. "
+            "(cpuRev = 0x%x)",
+            cpuRev);
+
+        return;
+    }
+
+    const MX6_CCM_CCSR_REG ccsrReg =
+        {READ_REGISTER_NOFENCE_ULONG(&this->ccmRegistersPtr->CCSR)};
+
+    const MX6_CCM_CACRR_REG cacrrReg =
+        {READ_REGISTER_NOFENCE_ULONG(&this->ccmRegistersPtr->CACRR)};
+
+    const MX6_CCM_ANALOG_PLL_ARM_REG pllArmReg =
+        {READ_REGISTER_NOFENCE_ULONG(&this->analogRegistersPtr->PLL_ARM)};
+
+    if ((ccsrReg.pll1_sw_clk_sel != MX6_CCM_PLL1_SW_CLK_SEL_PLL1_MAIN_CLK) ||
+        (pllArmReg.BYPASS != 0) ||
+        (pllArmReg.POWERDOWN != 0) ||
+        (pllArmReg.ENABLE == 0)) {
+
+        MX6_LOG_WARNING(
+            "ARM clock is not running from PLL1, P-states are disabled. "
+            "(CCSR = 0x%x, PLL_ARM = 0x%x)",
+            ccsrReg.AsUlong,
+            pllArmReg.AsUlong);
+
+        return;
+    }
+
+    const ULONG bootIndex = Mx6DvfsFindOperatingPoint(
+            operatingPoints,
+            count,
+            pllArmReg.DIV_SELECT,
+            cacrrReg.arm_podf);
+
+    if (bootIndex == count) {
+        MX6_LOG_WARNING(
+            "Boot ARM clock is not a known operating point, P-states are disabled. "
+            "(FrequencyMhz = %d, DIV_SELECT = %d, arm_podf = %d)",
+            Mx6DvfsArmFrequencyMhz(pllArmReg.DIV_SELECT, cacrrReg.arm_podf),
+            pllArmReg.DIV_SELECT,
+            cacrrReg.arm_podf);
+
+        return;
+    }
+
+    if (bootIndex == 0) {
+        MX6_LOG_INFORMATION(
+            "Booted at the slowest operating point, P-states are disabled. "
+            "(FrequencyMhz = %d)",
+            operatingPoints[0].FrequencyMhz);
+
+        return;
+    }
+
+    //
+    // When LDO_ARM is bypassed VDD_ARM comes from an external regulator that
+    // the PEP does not control. Firmware has set it for the boot operating
+    // point, which is also sufficient for every slower one.
+    //
+    const MX6_PMU_REG_CORE_REG pmuCoreReg =
+        {READ_REGISTER_NOFENCE_ULONG(&this->analogRegistersPtr->PMU_REG_CORE)};
+
+    this->dvfs.VoltageScaling =
+        (pmuCoreReg.REG0_TARG != MX6_DVFS_REG_TARG_BYPASS) &&
+        (pmuCoreReg.REG0_TARG != MX6_DVFS_REG_TARG_POWER_GATED);
+
+    // LDO_ARM ramps 25mV every (64 << REG0_STEP_TIME) cycles of the 24MHz clock
+    const MX6_PMU_MISC2_REG misc2Reg =
+        {READ_REGISTER_NOFENCE_ULONG(&this->analogRegistersPtr->MISC2)};
+
+    this->dvfs.VoltageStepTimeNs =
+        ((64UL << misc2Reg.REG0_STEP_TIME) * 1000) / MX6_DVFS_REF_CLK_MHZ;
+
+    this->dvfs.OperatingPoints = operatingPoints;
+    this->dvfs.CurrentIndex = bootIndex;
+    this->dvfs.OperatingPointCount = bootIndex + 1;
+
+    //
+    // The slowest to fastest transition and back bound the latency of any
+    // other transition.
+    //
+    MX6_DVFS_TRANSITION up;
+    Mx6DvfsPlanTransition(
+        &operatingPoints[0],
+        &operatingPoints[bootIndex],
+        this->dvfs.VoltageScaling,
+        this->dvfs.VoltageStepTimeNs,
+        &up);
+
+    MX6_DVFS_TRANSITION down;
+    Mx6DvfsPlanTransition(
+        &operatingPoints[bootIndex],
+        &operatingPoints[0],
+        this->dvfs.VoltageScaling,
+        this->dvfs.VoltageStepTimeNs,
+        &down);
+
+    this->dvfs.MaxTransitionLatencyUs = max(up.LatencyUs, down.LatencyUs);
+
+    MX6_LOG_INFORMATION(
+        "P-states enabled. (OperatingPointCount = %d, BootFrequencyMhz = %d, "
+        "VoltageScaling = %d, VoltageStepTimeNs = %d, MaxTransitionLatencyUs = %d)",
+        this->dvfs.OperatingPointCount,
+        operatingPoints[bootIndex].FrequencyMhz,
+        this->dvfs.VoltageScaling ? 1 : 0,
+        this->dvfs.VoltageStepTimeNs,
+        this->dvfs.MaxTransitionLatencyUs);
+}
+
+//
+// Moves the ARM core to another operating point. If the clock tree does not
+// respond the core is left on a clock no faster than the slower of the two
+// operating points, at the voltage of the faster one, and P-states are
+// disabled.
+//
+_Use_decl_annotations_
+NTSTATUS MX6_PEP::setOperatingPoint (ULONG Index)
+{
+    enum : ULONG {
+        ARM_PODF_TIMEOUT_US = 100,
+        PLL_LOCK_TIMEOUT_US = 1000,
+    };
+
+    NT_ASSERT(Index < this->dvfs.OperatingPointCount);
+
+    volatile MX6_CCM_REGISTERS* ccmRegistersTempPtr = this->ccmRegistersPtr;
+    volatile MX6_CCM_ANALOG_REGISTERS* analogRegistersTempPtr =
+        this->analogRegistersPtr;
+
+    const MX6_DVFS_OPERATING_POINT* fromPtr =
+        &this->dvfs.OperatingPoints[this->dvfs.CurrentIndex];
+
+    const MX6_DVFS_OPERATING_POINT* toPtr = &this->dvfs.OperatingPoints[Index];
+
+    MX6_DVFS_TRANSITION plan;
+    Mx6DvfsPlanTransition(
+        fromPtr,
+        toPtr,
+        this->dvfs.VoltageScaling,
+        this->dvfs.VoltageStepTimeNs,
+        &plan);
+
+    auto setVddArm = [&] (ULONG RegTarg) {
+        MX6_PMU_REG_CORE_REG pmuCoreReg =
+            {READ_REGISTER_NOFENCE_ULONG(&analogRegistersTempPtr->PMU_REG_CORE)};
+
+        pmuCoreReg.REG0_TARG = RegTarg;
+        WRITE_REGISTER_NOFENCE_ULONG(
+            &analogRegistersTempPtr->PMU_REG_CORE,
+            pmuCoreReg.AsUlong);
+
+        KeStallExecutionProcessor(
+            (plan.VoltageSteps * this->dvfs.VoltageStepTimeNs + 999) / 1000 +
+            MX6_DVFS_VOLTAGE_SETTLE_US);
+    };
+
+    MX6_DVFS_STEP steps[MX6_DVFS_MAX_STEPS];
+    const ULONG stepCount = Mx6DvfsSequenceTransition(&plan, toPtr, steps);
+
+    NTSTATUS status = STATUS_SUCCESS;
+    MX6_CCM_CCSR_REG ccsrReg =
+        {READ_REGISTER_NOFENCE_ULONG(&ccmRegistersTempPtr->CCSR)};
+
+    for (ULONG i = 0; i < stepCount; ++i) {
+        switch (steps[i].Type) {
+        case MX6_DVFS_STEP_SET_REG_TARG:
+            setVddArm(steps[i].Value);
+            break;
+
+        case MX6_DVFS_STEP_PARK_ARM_CLK:
+            ccsrReg.step_sel = MX6_CCM_STEP_SEL_PLL2_PFD2;
+            WRITE_REGISTER_NOFENCE_ULONG(&ccmRegistersTempPtr->CCSR, ccsrReg.AsUlong);
+
+            ccsrReg.pll1_sw_clk_sel = MX6_CCM_PLL1_SW_CLK_SEL_STEP_CLK;
+            WRITE_REGISTER_NOFENCE_ULONG(&ccmRegistersTempPtr->CCSR, ccsrReg.AsUlong);
+            break;
+
+        case MX6_DVFS_STEP_SET_ARM_PODF:
+        {
+            MX6_CCM_CACRR_REG cacrrReg =
+                {READ_REGISTER_NOFENCE_ULONG(&ccmRegistersTempPtr->CACRR)};
+
+            cacrrReg.arm_podf = steps[i].Value;
+            WRITE_REGISTER_NOFENCE_ULONG(&ccmRegistersTempPtr->CACRR, cacrrReg.AsUlong);
+
+            ULONG waitUs = 0;
+            while ((READ_REGISTER_NOFENCE_ULONG(&ccmRegistersTempPtr->CDHIPR) &
+                    MX6_CCM_CDHIPR_ARM_PODF_BUSY) != 0) {
+
+                if (waitUs == ARM_PODF_TIMEOUT_US) {
+                    MX6_LOG_ERROR("Timed out waiting for the arm_podf handshake.");
+                    status = STATUS_IO_TIMEOUT;
+                    goto End;
+                }
+
+                KeStallExecutionProcessor(1);
+                ++waitUs;
+            }
+            break;
+        }
+
+        case MX6_DVFS_STEP_SET_PLL_DIV:
+        {
+            MX6_CCM_ANALOG_PLL_ARM_REG pllArmReg =
+                {READ_REGISTER_NOFENCE_ULONG(&analogRegistersTempPtr->PLL_ARM)};
+
+            pllArmReg.DIV_SELECT = steps[i].Value;
+            WRITE_REGISTER_NOFENCE_ULONG(
+                &analogRegistersTempPtr->PLL_ARM,
+                pllArmReg.AsUlong);
+
+            ULONG waitUs = 0;
+            for (;;) {
+                pllArmReg.AsUlong =
+                    READ_REGISTER_NOFENCE_ULONG(&analogRegistersTempPtr->PLL_ARM);
+
+                if (pllArmReg.LOCK != 0) {
+                    break;
+                }
+
+                if (waitUs == PLL_LOCK_TIMEOUT_US) {
+                    MX6_LOG_ERROR(
+                        "Timed out waiting for PLL1 to lock. (PLL_ARM = 0x%x)",
+                        pllArmReg.AsUlong);
+
+                    status = STATUS_IO_TIMEOUT;
+                    goto End;
+                }
+
+                KeStallExecutionProcessor(1);
+                ++waitUs;
+            }
+            break;
+        }
+
+        case MX6_DVFS_STEP_UNPARK_ARM_CLK:
+            ccsrReg.pll1_sw_clk_sel = MX6_CCM_PLL1_SW_CLK_SEL_PLL1_MAIN_CLK;
+            WRITE_REGISTER_NOFENCE_ULONG(&ccmRegistersTempPtr->CCSR, ccsrReg.AsUlong);
+            break;
+
+        default:
+            NT_ASSERT(!"Unknown DVFS step");
+            break;
+        }
+    }
+
+    this->dvfs.CurrentIndex = Index;
+    ++this->dvfs.TransitionCount;
+
+    MX6_LOG_TRACE(
+        "Changed operating point. (FromMhz = %d, ToMhz = %d, LatencyUs = %d)",
+        fromPtr->FrequencyMhz,
+        toPtr->FrequencyMhz,
+        plan.LatencyUs);
+
+End:
+    if (!NT_SUCCESS(status)) {
+        this->dvfs.OperatingPointCount = 0;
+    }
+
+    return status;
+}
+
 MX6_NONPAGED_SEGMENT_END; //================================================
 
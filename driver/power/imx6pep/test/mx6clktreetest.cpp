@@ -0,0 +1,257 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// Module Name:
+//
+//   mx6clktreetest.cpp
+//
+// Abstract:
+//
+//   Host test of the clock tree topology in mx6clktree.h and of the clock
+//   roots of the PEP clock nodes in mx6clknode.h. Walks the chain of each
+//   clock node from its root to its source, the way the PEP does when it
+//   ungates the node, for every setting of the muxes on the way.
+//
+//   Build and run from the repository root:
+//
+//     c++ -std=c++14 -Wall -Wno-unknown-pragmas -I driver/shared/hosttest
+//         -I driver/power/imx6pep/sys
+//         driver/power/imx6pep/test/mx6clktreetest.cpp -o mx6clktreetest
+//     ./mx6clktreetest
+//
+// Environment:
+//
+//   User mode, host
+//
+
+#include "hosttest.h"
+#include "mx6pephw.h"
+#include "mx6pepioctl.h"
+#include "mx6clktree.h"
+#include "mx6clknode.h"
+
+namespace { // static
+
+//
+// Same walk as MX6_PEP::referenceClockTreeLocked(). Returns the number of
+// clocks in the chain, or MX6_CLK_TREE_DEPTH_MAX + 1 if the chain does not
+// fit.
+//
+ULONG walkClockTree (
+    const MX6PEP_DUMP_REGISTERS_OUTPUT& Registers,
+    MX6_CLK Root,
+    MX6_CLK* ChainPtr
+    )
+{
+    ULONG count = 0;
+    MX6_CLK clock = Root;
+    while ((clock != MX6_CLK_NONE) && (clock != MX6_CLK_MAX)) {
+        if (count == MX6_CLK_TREE_DEPTH_MAX) {
+            return MX6_CLK_TREE_DEPTH_MAX + 1;
+        }
+
+        ChainPtr[count++] = clock;
+        clock = Mx6ClkTreeGetParent(Registers, clock);
+    }
+
+    return count;
+}
+
+//
+// Mux settings out of reset on i.MX6Quad, as programmed by the firmware
+//
+void initRegisters (MX6PEP_DUMP_REGISTERS_OUTPUT* RegistersPtr)
+{
+    RtlZeroMemory(RegistersPtr, sizeof(*RegistersPtr));
+
+    MX6_CCM_CBCMR_REG cbcmrReg = {0};
+    cbcmrReg.pre_periph_clk_sel = MX6_CCM_PRE_PERIPH_CLK_SEL_PLL2_PFD2;
+    cbcmrReg.periph_clk2_sel = MX6_CCM_PERIPH_CLK2_SEL_PLL3_SW_CLK;
+    cbcmrReg.gpu3d_core_clk_sel = MX6_CCM_GPU3D_CORE_CLK_SEL_MMDC_CH0_AXI;
+    cbcmrReg.gpu3d_shader_clk_sel = MX6_CCM_GPU3D_SHADER_CLK_SEL_MMDC_CH0_AXI;
+    RegistersPtr->Ccm.CBCMR = cbcmrReg.AsUlong;
+}
+
+void testUartChain ()
+{
+    MX6PEP_DUMP_REGISTERS_OUTPUT registers;
+    initRegisters(&registers);
+
+    MX6_CLK chain[MX6_CLK_TREE_DEPTH_MAX];
+    const ULONG count = walkClockTree(
+            registers,
+            Mx6ClkNodeDescriptors[MX6_CLK_NODE_UART].Root,
+            chain);
+
+    static const MX6_CLK expected[] = {
+        MX6_UART_CLK_ROOT,
+        MX6_PLL3_80M,
+        MX6_PLL3_SW_CLK,
+        MX6_PLL3_MAIN_CLK,
+        MX6_OSC_CLK,
+    };
+
+    HOSTTEST_CHECK_EQ(count, ARRAYSIZE(expected));
+    for (ULONG i = 0; (i < count) && (i < ARRAYSIZE(expected)); ++i) {
+        HOSTTEST_CHECK_EQ(chain[i], expected[i]);
+    }
+}
+
+void testPeriphMux ()
+{
+    MX6PEP_DUMP_REGISTERS_OUTPUT registers;
+    initRegisters(&registers);
+
+    MX6_CLK chain[MX6_CLK_TREE_DEPTH_MAX];
+    ULONG count = walkClockTree(registers, MX6_PERCLK_CLK_ROOT, chain);
+    HOSTTEST_CHECK_EQ(count, 8);
+    HOSTTEST_CHECK_EQ(chain[4], MX6_PRE_PERIPH_CLK);
+    HOSTTEST_CHECK_EQ(chain[5], MX6_PLL2_PFD2);
+
+    // Switching periph_clk to periph_clk2, as done around MMDC frequency
+    // changes, moves the whole bus tree to PLL3
+    MX6_CCM_CBCDR_REG cbcdrReg = {registers.Ccm.CBCDR};
+    cbcdrReg.periph_clk_sel = 1;
+    registers.Ccm.CBCDR = cbcdrReg.AsUlong;
+
+    count = walkClockTree(registers, MX6_PERCLK_CLK_ROOT, chain);
+    HOSTTEST_CHECK_EQ(count, 8);
+    HOSTTEST_CHECK_EQ(chain[4], MX6_PERIPH_CLK2);
+    HOSTTEST_CHECK_EQ(chain[5], MX6_PLL3_SW_CLK);
+}
+
+void testUsdhcAndSsiMux ()
+{
+    MX6PEP_DUMP_REGISTERS_OUTPUT registers;
+    initRegisters(&registers);
+
+    MX6_CCM_CSCMR1_REG cscmr1Reg = {0};
+    cscmr1Reg.usdhc2_clk_sel = MX6_CCM_USDHC_CLK_SEL_PLL2_PFD0;
+    cscmr1Reg.ssi3_clk_sel = MX6_CCM_SSI_CLK_SEL_PLL4;
+    registers.Ccm.CSCMR1 = cscmr1Reg.AsUlong;
+
+    HOSTTEST_CHECK_EQ(
+        Mx6ClkTreeGetParent(registers, MX6_USDHC1_CLK_ROOT),
+        MX6_PLL2_PFD2);
+
+    HOSTTEST_CHECK_EQ(
+        Mx6ClkTreeGetParent(registers, MX6_USDHC2_CLK_ROOT),
+        MX6_PLL2_PFD0);
+
+    HOSTTEST_CHECK_EQ(
+        Mx6ClkTreeGetParent(registers, MX6_SSI1_CLK_ROOT),
+        MX6_PLL3_PFD2);
+
+    HOSTTEST_CHECK_EQ(
+        Mx6ClkTreeGetParent(registers, MX6_SSI3_CLK_ROOT),
+        MX6_PLL4_MAIN_CLK);
+}
+
+void testReservedMuxValues ()
+{
+    MX6PEP_DUMP_REGISTERS_OUTPUT registers;
+    initRegisters(&registers);
+
+    MX6_CCM_ANALOG_PLL_SYS_REG pllSysReg = {0};
+    pllSysReg.BYPASS_CLK_SRC = MX6_PLL_BYPASS_CLK_SRC_XOR;
+    registers.Analog.PLL_SYS = pllSysReg.AsUlong;
+
+    HOSTTEST_CHECK_EQ(
+        Mx6ClkTreeGetParent(registers, MX6_PLL2_MAIN_CLK),
+        MX6_CLK_MAX);
+
+    // The chain stops at the clock whose parent cannot be resolved
+    MX6_CLK chain[MX6_CLK_TREE_DEPTH_MAX];
+    const ULONG count = walkClockTree(registers, MX6_USDHC1_CLK_ROOT, chain);
+    HOSTTEST_CHECK_EQ(count, 3);
+    HOSTTEST_CHECK_EQ(chain[2], MX6_PLL2_MAIN_CLK);
+
+    HOSTTEST_CHECK_EQ(
+        Mx6ClkTreeGetParent(registers, MX6_CLK_NONE),
+        MX6_CLK_MAX);
+}
+
+//
+// Every node resolves to the oscillator within MX6_CLK_TREE_DEPTH_MAX
+// clocks, whichever input the bus muxes select
+//
+void testNodeChainsFit ()
+{
+    static const ULONG prePeriphSels[] = {
+        MX6_CCM_PRE_PERIPH_CLK_SEL_PLL2,
+        MX6_CCM_PRE_PERIPH_CLK_SEL_PLL2_PFD2,
+        MX6_CCM_PRE_PERIPH_CLK_SEL_PLL2_PFD0,
+        MX6_CCM_PRE_PERIPH_CLK_SEL_PLL2_PFD2_DIV2,
+    };
+
+    static const ULONG periphClk2Sels[] = {
+        MX6_CCM_PERIPH_CLK2_SEL_PLL3_SW_CLK,
+        MX6_CCM_PERIPH_CLK2_SEL_OSC_CLK,
+        MX6_CCM_PERIPH_CLK2_SEL_PLL2,
+    };
+
+    for (ULONG periphSel = 0; periphSel < 2; ++periphSel) {
+        for (ULONG i = 0; i < ARRAYSIZE(prePeriphSels); ++i) {
+            for (ULONG j = 0; j < ARRAYSIZE(periphClk2Sels); ++j) {
+                MX6PEP_DUMP_REGISTERS_OUTPUT registers;
+                initRegisters(&registers);
+
+                MX6_CCM_CBCDR_REG cbcdrReg = {0};
+                cbcdrReg.periph_clk_sel = periphSel;
+                registers.Ccm.CBCDR = cbcdrReg.AsUlong;
+
+                MX6_CCM_CBCMR_REG cbcmrReg = {registers.Ccm.CBCMR};
+                cbcmrReg.pre_periph_clk_sel = prePeriphSels[i];
+                cbcmrReg.periph_clk2_sel = periphClk2Sels[j];
+                registers.Ccm.CBCMR = cbcmrReg.AsUlong;
+
+                for (ULONG node = 0; node < MX6_CLK_NODE_MAX; ++node) {
+                    MX6_CLK chain[MX6_CLK_TREE_DEPTH_MAX];
+                    const ULONG count = walkClockTree(
+                            registers,
+                            Mx6ClkNodeDescriptors[node].Root,
+                            chain);
+
+                    HOSTTEST_CHECK((count >= 1) &&
+                                   (count <= MX6_CLK_TREE_DEPTH_MAX));
+
+                    if ((count >= 1) && (count <= MX6_CLK_TREE_DEPTH_MAX)) {
+                        HOSTTEST_CHECK_EQ(chain[count - 1], MX6_OSC_CLK);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void testNodeGates ()
+{
+    for (ULONG node = 0; node < MX6_CLK_NODE_MAX; ++node) {
+        const MX6_CLK_NODE_DESCRIPTOR& descriptor = Mx6ClkNodeDescriptors[node];
+        HOSTTEST_CHECK((descriptor.GateCount >= 1) &&
+                       (descriptor.GateCount <= MX6_CLK_NODE_GATE_COUNT_MAX));
+
+        HOSTTEST_CHECK((descriptor.Root != MX6_CLK_NONE) &&
+                       (descriptor.Root < MX6_CLK_MAX));
+    }
+
+    // Both UART gates follow the single UART node
+    const MX6_CLK_NODE_DESCRIPTOR& uart = Mx6ClkNodeDescriptors[MX6_CLK_NODE_UART];
+    HOSTTEST_CHECK_EQ(uart.GateCount, 2);
+    HOSTTEST_CHECK_EQ(uart.Gates[0], MX6_UART_CLK_ENABLE);
+    HOSTTEST_CHECK_EQ(uart.Gates[1], MX6_UART_SERIAL_CLK_ENABLE);
+}
+
+} // namespace "static"
+
+int main ()
+{
+    HOSTTEST_RUN(testUartChain);
+    HOSTTEST_RUN(testPeriphMux);
+    HOSTTEST_RUN(testUsdhcAndSsiMux);
+    HOSTTEST_RUN(testReservedMuxValues);
+    HOSTTEST_RUN(testNodeChainsFit);
+    HOSTTEST_RUN(testNodeGates);
+
+    return HostTestExit();
+}
@@ -0,0 +1,308 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// Module Name:
+//
+//   mx6dvfstest.cpp
+//
+// Abstract:
+//
+//   Host test of the i.MX6 ARM operating point tables and transition
+//   planning in mx6dvfs.h. Every transition is run step by step against a
+//   model of the ARM clock root (PLL1, step clock, arm_podf) and LDO_ARM,
+//   checking that the core is never clocked faster than the voltage in
+//   effect allows or faster than both operating points.
+//
+//   Build and run from the repository root:
+//
+//     c++ -std=c++14 -Wall -I driver/shared/hosttest -I driver/power/imx6pep/sys
+//         driver/power/imx6pep/test/mx6dvfstest.cpp -o mx6dvfstest
+//     ./mx6dvfstest
+//
+// Environment:
+//
+//   User mode, host
+//
+
+#include "hosttest.h"
+#include "mx6dvfs.h"
+
+namespace { // static
+
+//
+// ARM clock root and LDO_ARM registers touched by a transition
+//
+struct MX6_DVFS_MODEL {
+    ULONG RegTarg;
+    bool Parked;
+    ULONG ArmPodf;
+    ULONG PllDivSelect;
+    ULONG FixedVddArmMv;    // VDD_ARM when LDO_ARM is bypassed, 0 otherwise
+};
+
+ULONG modelArmMhz (const MX6_DVFS_MODEL& Model)
+{
+    const ULONG sourceMhz = Model.Parked ?
+        ULONG(MX6_DVFS_STEP_CLK_MHZ) :
+        (MX6_DVFS_REF_CLK_MHZ * Model.PllDivSelect / 2);
+
+    return sourceMhz / (Model.ArmPodf + 1);
+}
+
+ULONG modelVddArmMv (const MX6_DVFS_MODEL& Model)
+{
+    if (Model.FixedVddArmMv != 0) {
+        return Model.FixedVddArmMv;
+    }
+
+    return MX6_DVFS_VDD_ARM_BASE_MV + (Model.RegTarg * MX6_DVFS_VDD_ARM_STEP_MV);
+}
+
+//
+// Lowest VDD_ARM the table allows at FrequencyMhz, or MAXULONG if the
+// frequency is above every operating point.
+//
+ULONG requiredVddArmMv (
+    const MX6_DVFS_OPERATING_POINT* OperatingPoints,
+    ULONG Count,
+    ULONG FrequencyMhz
+    )
+{
+    for (ULONG i = 0; i < Count; ++i) {
+        if (OperatingPoints[i].FrequencyMhz >= FrequencyMhz) {
+            return OperatingPoints[i].VddArmMv;
+        }
+    }
+
+    return MAXULONG;
+}
+
+void modelSetOperatingPoint (
+    MX6_DVFS_MODEL* ModelPtr,
+    const MX6_DVFS_OPERATING_POINT& OperatingPoint
+    )
+{
+    ModelPtr->RegTarg = Mx6DvfsRegTargFromMv(OperatingPoint.VddArmMv);
+    ModelPtr->Parked = false;
+    ModelPtr->ArmPodf = OperatingPoint.ArmPodf;
+    ModelPtr->PllDivSelect = OperatingPoint.PllDivSelect;
+}
+
+void runTransition (
+    const MX6_DVFS_OPERATING_POINT* OperatingPoints,
+    ULONG Count,
+    ULONG From,
+    ULONG To,
+    bool VoltageScaling
+    )
+{
+    const MX6_DVFS_OPERATING_POINT& from = OperatingPoints[From];
+    const MX6_DVFS_OPERATING_POINT& to = OperatingPoints[To];
+    const ULONG maxMhz = (from.FrequencyMhz > to.FrequencyMhz) ?
+        from.FrequencyMhz : to.FrequencyMhz;
+
+    MX6_DVFS_MODEL model = {};
+    modelSetOperatingPoint(&model, from);
+    if (!VoltageScaling) {
+        // firmware set VDD_ARM for the fastest point, see initializeDvfs()
+        model.FixedVddArmMv = OperatingPoints[Count - 1].VddArmMv;
+    }
+
+    MX6_DVFS_TRANSITION plan;
+    Mx6DvfsPlanTransition(&from, &to, VoltageScaling, 1000, &plan);
+
+    MX6_DVFS_STEP steps[MX6_DVFS_MAX_STEPS];
+    const ULONG stepCount = Mx6DvfsSequenceTransition(&plan, &to, steps);
+    HOSTTEST_CHECK(stepCount <= MX6_DVFS_MAX_STEPS);
+
+    for (ULONG i = 0; i < stepCount; ++i) {
+        switch (steps[i].Type) {
+        case MX6_DVFS_STEP_SET_REG_TARG:
+            HOSTTEST_CHECK(VoltageScaling);
+            model.RegTarg = steps[i].Value;
+            break;
+
+        case MX6_DVFS_STEP_PARK_ARM_CLK:
+            HOSTTEST_CHECK(!model.Parked);
+            model.Parked = true;
+            break;
+
+        case MX6_DVFS_STEP_SET_ARM_PODF:
+            model.ArmPodf = steps[i].Value;
+            break;
+
+        case MX6_DVFS_STEP_SET_PLL_DIV:
+            // PLL1 must not be relocked under the running core
+            HOSTTEST_CHECK(model.Parked);
+            model.PllDivSelect = steps[i].Value;
+            break;
+
+        case MX6_DVFS_STEP_UNPARK_ARM_CLK:
+            HOSTTEST_CHECK(model.Parked);
+            model.Parked = false;
+            break;
+
+        default:
+            HOSTTEST_CHECK(!"Unknown step");
+            break;
+        }
+
+        const ULONG armMhz = modelArmMhz(model);
+        HOSTTEST_CHECK(armMhz <= maxMhz);
+        HOSTTEST_CHECK(
+            modelVddArmMv(model) >=
+            requiredVddArmMv(OperatingPoints, Count, armMhz));
+    }
+
+    HOSTTEST_CHECK(!model.Parked);
+    HOSTTEST_CHECK_EQ(model.PllDivSelect, to.PllDivSelect);
+    HOSTTEST_CHECK_EQ(model.ArmPodf, to.ArmPodf);
+    HOSTTEST_CHECK_EQ(modelArmMhz(model), to.FrequencyMhz);
+    if (VoltageScaling) {
+        HOSTTEST_CHECK_EQ(model.RegTarg, Mx6DvfsRegTargFromMv(to.VddArmMv));
+    }
+}
+
+void runAllTransitions (
+    const MX6_DVFS_OPERATING_POINT* OperatingPoints,
+    ULONG Count
+    )
+{
+    for (ULONG from = 0; from < Count; ++from) {
+        for (ULONG to = 0; to < Count; ++to) {
+            runTransition(OperatingPoints, Count, from, to, true);
+            runTransition(OperatingPoints, Count, from, to, false);
+        }
+    }
+}
+
+void testOperatingPointTables ()
+{
+    const struct {
+        const MX6_DVFS_OPERATING_POINT* OperatingPoints;
+        ULONG Count;
+    } tables[] = {
+        {Mx6DvfsOperatingPointsQuad, ARRAYSIZE(Mx6DvfsOperatingPointsQuad)},
+        {Mx6DvfsOperatingPointsDualLite, ARRAYSIZE(Mx6DvfsOperatingPointsDualLite)},
+    };
+
+    for (const auto& table : tables) {
+        for (ULONG i = 0; i < table.Count; ++i) {
+            const MX6_DVFS_OPERATING_POINT& op = table.OperatingPoints[i];
+
+            HOSTTEST_CHECK_EQ(
+                Mx6DvfsArmFrequencyMhz(op.PllDivSelect, op.ArmPodf),
+                op.FrequencyMhz);
+
+            // the regulator must reach at least the requested voltage
+            const ULONG regTarg = Mx6DvfsRegTargFromMv(op.VddArmMv);
+            HOSTTEST_CHECK(
+                MX6_DVFS_VDD_ARM_BASE_MV + regTarg * MX6_DVFS_VDD_ARM_STEP_MV >=
+                op.VddArmMv);
+            HOSTTEST_CHECK(regTarg != MX6_DVFS_REG_TARG_POWER_GATED);
+            HOSTTEST_CHECK(regTarg < MX6_DVFS_REG_TARG_BYPASS);
+
+            if (i != 0) {
+                const MX6_DVFS_OPERATING_POINT& slower = table.OperatingPoints[i - 1];
+                HOSTTEST_CHECK(slower.FrequencyMhz < op.FrequencyMhz);
+                HOSTTEST_CHECK(slower.VddArmMv <= op.VddArmMv);
+            }
+        }
+
+        // the step clock is no faster than any operating point
+        HOSTTEST_CHECK(
+            ULONG(MX6_DVFS_STEP_CLK_MHZ) <= table.OperatingPoints[0].FrequencyMhz);
+    }
+}
+
+void testSelectOperatingPoint ()
+{
+    const ULONG count = ARRAYSIZE(Mx6DvfsOperatingPointsQuad);
+
+    HOSTTEST_CHECK_EQ(Mx6DvfsSelectOperatingPoint(Mx6DvfsOperatingPointsQuad, count, 0), 0);
+    HOSTTEST_CHECK_EQ(Mx6DvfsSelectOperatingPoint(Mx6DvfsOperatingPointsQuad, count, 396), 0);
+    HOSTTEST_CHECK_EQ(Mx6DvfsSelectOperatingPoint(Mx6DvfsOperatingPointsQuad, count, 397), 1);
+    HOSTTEST_CHECK_EQ(Mx6DvfsSelectOperatingPoint(Mx6DvfsOperatingPointsQuad, count, 792), 1);
+    HOSTTEST_CHECK_EQ(Mx6DvfsSelectOperatingPoint(Mx6DvfsOperatingPointsQuad, count, 996), 2);
+    HOSTTEST_CHECK_EQ(Mx6DvfsSelectOperatingPoint(Mx6DvfsOperatingPointsQuad, count, 1200), 2);
+
+    // the P-state domain may be limited to the boot operating point
+    HOSTTEST_CHECK_EQ(Mx6DvfsSelectOperatingPoint(Mx6DvfsOperatingPointsQuad, 2, 996), 1);
+}
+
+void testFindOperatingPoint ()
+{
+    const ULONG count = ARRAYSIZE(Mx6DvfsOperatingPointsQuad);
+
+    HOSTTEST_CHECK_EQ(Mx6DvfsFindOperatingPoint(Mx6DvfsOperatingPointsQuad, count, 66, 1), 0);
+    HOSTTEST_CHECK_EQ(Mx6DvfsFindOperatingPoint(Mx6DvfsOperatingPointsQuad, count, 66, 0), 1);
+    HOSTTEST_CHECK_EQ(Mx6DvfsFindOperatingPoint(Mx6DvfsOperatingPointsQuad, count, 83, 0), 2);
+    HOSTTEST_CHECK_EQ(Mx6DvfsFindOperatingPoint(Mx6DvfsOperatingPointsQuad, count, 83, 1), count);
+    HOSTTEST_CHECK_EQ(Mx6DvfsFindOperatingPoint(Mx6DvfsOperatingPointsQuad, count, 88, 0), count);
+}
+
+void testPlanLatency ()
+{
+    const MX6_DVFS_OPERATING_POINT* ops = Mx6DvfsOperatingPointsQuad;
+    MX6_DVFS_TRANSITION plan;
+
+    // 396 -> 792: divider only, 975mV -> 1175mV is 8 steps
+    Mx6DvfsPlanTransition(&ops[0], &ops[1], true, 2667, &plan);
+    HOSTTEST_CHECK(!plan.ChangePll);
+    HOSTTEST_CHECK(plan.ChangePodf);
+    HOSTTEST_CHECK_EQ(plan.VoltageSteps, 8);
+    HOSTTEST_CHECK_EQ(plan.RegTargBefore, Mx6DvfsRegTargFromMv(1175));
+    HOSTTEST_CHECK_EQ(plan.RegTargAfter, 0);
+    HOSTTEST_CHECK_EQ(
+        plan.LatencyUs,
+        (8 * 2667 + 999) / 1000 + MX6_DVFS_VOLTAGE_SETTLE_US +
+            MX6_DVFS_PODF_HANDSHAKE_US);
+
+    // 996 -> 792: PLL only, voltage lowered after the clock
+    Mx6DvfsPlanTransition(&ops[2], &ops[1], true, 2667, &plan);
+    HOSTTEST_CHECK(plan.ChangePll);
+    HOSTTEST_CHECK(!plan.ChangePodf);
+    HOSTTEST_CHECK_EQ(plan.RegTargBefore, 0);
+    HOSTTEST_CHECK_EQ(plan.RegTargAfter, Mx6DvfsRegTargFromMv(1175));
+
+    // without voltage scaling only the clock changes
+    Mx6DvfsPlanTransition(&ops[0], &ops[2], false, 2667, &plan);
+    HOSTTEST_CHECK_EQ(plan.VoltageSteps, 0);
+    HOSTTEST_CHECK_EQ(
+        plan.LatencyUs,
+        MX6_DVFS_PLL_LOCK_US + MX6_DVFS_PODF_HANDSHAKE_US);
+
+    // same point, nothing to do
+    Mx6DvfsPlanTransition(&ops[1], &ops[1], true, 2667, &plan);
+    MX6_DVFS_STEP steps[MX6_DVFS_MAX_STEPS];
+    HOSTTEST_CHECK_EQ(Mx6DvfsSequenceTransition(&plan, &ops[1], steps), 0);
+    HOSTTEST_CHECK_EQ(plan.LatencyUs, 0);
+}
+
+void testTransitionsQuad ()
+{
+    runAllTransitions(
+        Mx6DvfsOperatingPointsQuad,
+        ARRAYSIZE(Mx6DvfsOperatingPointsQuad));
+}
+
+void testTransitionsDualLite ()
+{
+    runAllTransitions(
+        Mx6DvfsOperatingPointsDualLite,
+        ARRAYSIZE(Mx6DvfsOperatingPointsDualLite));
+}
+
+} // namespace "static"
+
+int main ()
+{
+    HOSTTEST_RUN(testOperatingPointTables);
+    HOSTTEST_RUN(testSelectOperatingPoint);
+    HOSTTEST_RUN(testFindOperatingPoint);
+    HOSTTEST_RUN(testPlanLatency);
+    HOSTTEST_RUN(testTransitionsQuad);
+    HOSTTEST_RUN(testTransitionsDualLite);
+
+    return HostTestExit();
+}
@@ -189,6 +189,15 @@ ImxPwmSoftReset (
     IMXPWM_DEVICE_CONTEXT* DeviceContextPtr
     )
 {
+    //
+    // The reset flushes the Fifo and disables PWM, so a streaming waveform
+    // cannot survive it. Stop it first, so that its samples are released and
+    // the waveform status reports it stopped instead of still running.
+    //
+    if (DeviceContextPtr->Waveform.SamplesPtr != nullptr) {
+        ImxPwmStopWaveform(DeviceContextPtr);
+    }
+
     IMXPWM_REGISTERS *registersPtr = DeviceContextPtr->RegistersPtr;
     IMXPWM_PWMCR_REG pwmCr = { READ_REGISTER_ULONG(&registersPtr->PWMCR) };
 
@@ -281,6 +290,16 @@ ImxPwmSetDesiredPeriod (
     IMXPWM_REGISTERS *registersPtr = DeviceContextPtr->RegistersPtr;
     IMXPWM_PWMCR_REG pwmCr = { READ_REGISTER_ULONG(&registersPtr->PWMCR) };
 
+    //
+    // Nothing to do if the period is unchanged and the hardware still holds
+    // its prescaler, i.e. no soft-reset happened since it was programmed.
+    //
+    if ((DesiredPeriod == DeviceContextPtr->DesiredPeriod) &&
+        (DeviceContextPtr->ClockPrescaler > 0) &&
+        (pwmCr.PRESCALER == ULONG(DeviceContextPtr->ClockPrescaler - 1))) {
+        return STATUS_SUCCESS;
+    }
+
     USHORT prescaler;
     NTSTATUS status =
         ImxPwmCalculatePrescaler(DeviceContextPtr, DesiredPeriod, &prescaler);
@@ -309,8 +328,18 @@ ImxPwmSetDesiredPeriod (
         return status;
     }
 
+    static_assert(
+        (ULONGLONG(IMXPWM_PWMPR_PERIOD_MAX) + 2) <
+            (1ull << (64 - IMXPWM_DUTY_CYCLE_SCALE_SHIFT)),
+        "Duty cycle scale factor should fit in 64-bit");
+
     DeviceContextPtr->DesiredPeriod = DesiredPeriod;
     DeviceContextPtr->ActualPeriod = actualPeriod;
+    DeviceContextPtr->ClockPrescaler = prescaler;
+    DeviceContextPtr->DutyCycleScale =
+        (ULONGLONG(DeviceContextPtr->RovEventCounterCompare) <<
+            IMXPWM_DUTY_CYCLE_SCALE_SHIFT) /
+        (PWM_PERCENTAGE_MAX >> 32);
 
     IMXPWM_LOG_INFORMATION(
         "Setting new period. (DesiredPeriod = %llups(%lluHz), ActualPeriod = %llups(%lluHz))",
@@ -324,27 +353,18 @@ ImxPwmSetDesiredPeriod (
 
 _Use_decl_annotations_
 NTSTATUS
-ImxPwmSetActiveDutyCycle (
-    IMXPWM_DEVICE_CONTEXT* DeviceContextPtr,
-    PWM_PERCENTAGE ActiveDutyCycle
+ImxPwmDutyCycleToSample (
+    const IMXPWM_DEVICE_CONTEXT* DeviceContextPtr,
+    PWM_PERCENTAGE ActiveDutyCycle,
+    USHORT* SamplePtr
     )
 {
-    IMXPWM_PIN_STATE* pinPtr = &DeviceContextPtr->Pin;
     //
-    // Delay hardware setting of duty cycle till PWM starts. That avoids filling the
-    // Fifo unnecessarily with stale duty cycles. If PWM is stopped, then do nothing
-    // on the hardware level, otherwise do the duty cycle hardware setting.
-    //
-    if (!pinPtr->IsStarted) {
-        pinPtr->ActiveDutyCycle = ActiveDutyCycle;
-        return STATUS_SUCCESS;
-    }
-
-    //
-    // Scale down the desired duty cycle from 64-bit to 32-bit to avoid overflow
-    // errors that may result from multiplying 64-bit by 32-bit operands, which will
-    // require a 96-bit intermediate value, otherwise the multiply divide operation
-    // will overflow.
+    // Scale down the desired duty cycle from 64-bit to 32-bit, then scale it
+    // by the fixed-point factor cached for the current period. That computes
+    // round((ActiveDutyCycle >> 32) * RovEventCounterCompare /
+    // (PWM_PERCENTAGE_MAX >> 32)) without a 64-bit division, and since the
+    // 32-bit duty cycle times the scale factor fits in 64-bit it can't overflow.
     //
     ULONGLONG cmpEventCounterCompare;
 
@@ -353,20 +373,11 @@ ImxPwmSetActiveDutyCycle (
     } else if (ActiveDutyCycle == PWM_PERCENTAGE_MAX) {
         cmpEventCounterCompare = DeviceContextPtr->RovEventCounterCompare + 1;
     } else {
-        NTSTATUS status =
-            SafeDivRound64x64(
-                (ActiveDutyCycle >> 32) *
-                    DeviceContextPtr->RovEventCounterCompare,
-                PWM_PERCENTAGE_MAX >> 32,
-                &cmpEventCounterCompare);
-        if (!NT_SUCCESS(status)) {
-            IMXPWM_LOG_ERROR(
-                "Unexpected failure computing CmpEventCounterCompare. "
-                "(ActiveDutyCycle = %llu, status = %!STATUS!)",
-                ActiveDutyCycle,
-                status);
-            return status;
-        }
+        NT_ASSERT(DeviceContextPtr->DutyCycleScale != 0);
+        cmpEventCounterCompare =
+            ((ActiveDutyCycle >> 32) * DeviceContextPtr->DutyCycleScale +
+                (1ull << (IMXPWM_DUTY_CYCLE_SCALE_SHIFT - 1))) >>
+            IMXPWM_DUTY_CYCLE_SCALE_SHIFT;
     }
 
     if (cmpEventCounterCompare >
@@ -385,6 +396,46 @@ ImxPwmSetActiveDutyCycle (
         "Sample should fit in 16-bit");
     NT_ASSERT(cmpEventCounterCompare <= IMXPWM_ROV_EVT_COUNTER_COMPARE + 1);
 
+    *SamplePtr = static_cast<USHORT>(cmpEventCounterCompare);
+
+    return STATUS_SUCCESS;
+}
+
+_Use_decl_annotations_
+NTSTATUS
+ImxPwmSetActiveDutyCycle (
+    IMXPWM_DEVICE_CONTEXT* DeviceContextPtr,
+    PWM_PERCENTAGE ActiveDutyCycle
+    )
+{
+    IMXPWM_PIN_STATE* pinPtr = &DeviceContextPtr->Pin;
+    //
+    // Delay hardware setting of duty cycle till PWM starts. That avoids filling the
+    // Fifo unnecessarily with stale duty cycles. If PWM is stopped, then do nothing
+    // on the hardware level, otherwise do the duty cycle hardware setting.
+    //
+    if (!pinPtr->IsStarted) {
+        pinPtr->ActiveDutyCycle = ActiveDutyCycle;
+        return STATUS_SUCCESS;
+    }
+
+    //
+    // A streaming waveform owns the Fifo, an explicit duty cycle replaces it.
+    //
+    if (DeviceContextPtr->Waveform.SamplesPtr != nullptr) {
+        ImxPwmStopWaveform(DeviceContextPtr);
+    }
+
+    USHORT cmpEventCounterCompare;
+    NTSTATUS status =
+        ImxPwmDutyCycleToSample(
+            DeviceContextPtr,
+            ActiveDutyCycle,
+            &cmpEventCounterCompare);
+    if (!NT_SUCCESS(status)) {
+        return status;
+    }
+
     IMXPWM_REGISTERS *registersPtr = DeviceContextPtr->RegistersPtr;
     IMXPWM_PWMSR_REG pwmSr = { READ_REGISTER_ULONG(&registersPtr->PWMSR) };
 
@@ -395,10 +446,7 @@ ImxPwmSetActiveDutyCycle (
     }
 
     pinPtr->ActiveDutyCycle = ActiveDutyCycle;
-    DeviceContextPtr->CmpEventCounterCompare =
-            static_cast<USHORT>(cmpEventCounterCompare);
-
-    NTSTATUS status;
+    DeviceContextPtr->CmpEventCounterCompare = cmpEventCounterCompare;
 
     //
     // Clear status bits
@@ -514,6 +562,10 @@ ImxPwmStop (
     IMXPWM_PIN_STATE* pinPtr = &DeviceContextPtr->Pin;
     NT_ASSERT(pinPtr->IsStarted);
 
+    if (DeviceContextPtr->Waveform.SamplesPtr != nullptr) {
+        ImxPwmStopWaveform(DeviceContextPtr);
+    }
+
     IMXPWM_REGISTERS *registersPtr = DeviceContextPtr->RegistersPtr;
     IMXPWM_PWMCR_REG pwmCr = { READ_REGISTER_ULONG(&registersPtr->PWMCR) };
 
@@ -560,6 +612,172 @@ ImxPwmStop (
     return STATUS_SUCCESS;
 }
 
+_Use_decl_annotations_
+NTSTATUS
+ImxPwmStartWaveform (
+    IMXPWM_DEVICE_CONTEXT* DeviceContextPtr,
+    const IMXPWM_PIN_START_WAVEFORM_INPUT* InputPtr
+    )
+{
+    NT_ASSERT(
+        (InputPtr->SampleCount > 0) &&
+        (InputPtr->SampleCount <= IMXPWM_WAVEFORM_SAMPLE_COUNT_MAX));
+
+    IMXPWM_WAVEFORM_STATE* waveformPtr = &DeviceContextPtr->Waveform;
+    IMXPWM_PIN_STATE* pinPtr = &DeviceContextPtr->Pin;
+
+    if (waveformPtr->SamplesPtr != nullptr) {
+        ImxPwmStopWaveform(DeviceContextPtr);
+    }
+
+    //
+    // Convert the whole waveform up front, so that refilling the Fifo from
+    // the ISR is only register writes.
+    //
+    USHORT* samplesPtr = static_cast<USHORT*>(
+        ExAllocatePoolWithTag(
+            NonPagedPoolNx,
+            InputPtr->SampleCount * sizeof(USHORT),
+            IMXPWM_POOL_TAG));
+    if (samplesPtr == nullptr) {
+        IMXPWM_LOG_LOW_MEMORY(
+            "Failed to allocate waveform samples. (SampleCount = %lu)",
+            InputPtr->SampleCount);
+        return STATUS_INSUFFICIENT_RESOURCES;
+    }
+
+    for (ULONG i = 0; i < InputPtr->SampleCount; ++i) {
+        NTSTATUS status =
+            ImxPwmDutyCycleToSample(
+                DeviceContextPtr,
+                InputPtr->Samples[i],
+                &samplesPtr[i]);
+        if (!NT_SUCCESS(status)) {
+            ExFreePoolWithTag(samplesPtr, IMXPWM_POOL_TAG);
+            return status;
+        }
+    }
+
+    IMXPWM_REGISTERS *registersPtr = DeviceContextPtr->RegistersPtr;
+    IMXPWM_PWMCR_REG pwmCr = { READ_REGISTER_ULONG(&registersPtr->PWMCR) };
+    pwmCr.REPEAT = InputPtr->SampleRepeat;
+    WRITE_REGISTER_ULONG(&registersPtr->PWMCR, pwmCr.AsUlong);
+
+    WdfInterruptAcquireLock(DeviceContextPtr->WdfInterrupt);
+
+    waveformPtr->SamplesPtr = samplesPtr;
+    waveformPtr->SampleCount = InputPtr->SampleCount;
+    waveformPtr->NextSample = 0;
+    waveformPtr->LoopCount = 0;
+    waveformPtr->SamplesWritten = 0;
+    waveformPtr->IsLooping = (InputPtr->Flags & IMXPWM_WAVEFORM_FLAG_LOOP) != 0;
+    waveformPtr->IsActive = true;
+
+    //
+    // Prime the Fifo, the FE interrupt keeps it topped up from here on.
+    //
+    ImxPwmWaveformFill(DeviceContextPtr);
+    if (waveformPtr->IsActive) {
+        ImxPwmInterruptEnable(DeviceContextPtr);
+    }
+
+    WdfInterruptReleaseLock(DeviceContextPtr->WdfInterrupt);
+
+    if (!pinPtr->IsStarted) {
+        pwmCr.AsUlong = READ_REGISTER_ULONG(&registersPtr->PWMCR);
+        NT_ASSERTMSG("PWM is expected to be disabled", pwmCr.EN == 0);
+        pwmCr.EN = 1;
+        WRITE_REGISTER_ULONG(&registersPtr->PWMCR, pwmCr.AsUlong);
+
+        pinPtr->IsStarted = true;
+    }
+
+    IMXPWM_LOG_INFORMATION(
+        "Waveform started. (SampleCount = %lu, SampleRepeat = %lu, IsLooping = %!bool!)",
+        InputPtr->SampleCount,
+        ULONG(InputPtr->SampleRepeat),
+        waveformPtr->IsLooping);
+
+    return STATUS_SUCCESS;
+}
+
+_Use_decl_annotations_
+void
+ImxPwmStopWaveform (
+    IMXPWM_DEVICE_CONTEXT* DeviceContextPtr
+    )
+{
+    IMXPWM_WAVEFORM_STATE* waveformPtr = &DeviceContextPtr->Waveform;
+
+    WdfInterruptAcquireLock(DeviceContextPtr->WdfInterrupt);
+
+    USHORT* samplesPtr = waveformPtr->SamplesPtr;
+    waveformPtr->SamplesPtr = nullptr;
+    waveformPtr->IsActive = false;
+
+    //
+    // A pending duty cycle request still needs the FE interrupt.
+    //
+    if (DeviceContextPtr->CurrentRequest == NULL) {
+        ImxPwmInterruptDisable(DeviceContextPtr);
+    }
+
+    WdfInterruptReleaseLock(DeviceContextPtr->WdfInterrupt);
+
+    IMXPWM_REGISTERS *registersPtr = DeviceContextPtr->RegistersPtr;
+    IMXPWM_PWMCR_REG pwmCr = { READ_REGISTER_ULONG(&registersPtr->PWMCR) };
+    pwmCr.REPEAT = 0;
+    WRITE_REGISTER_ULONG(&registersPtr->PWMCR, pwmCr.AsUlong);
+
+    if (samplesPtr != nullptr) {
+        ExFreePoolWithTag(samplesPtr, IMXPWM_POOL_TAG);
+    }
+
+    IMXPWM_LOG_TRACE(
+        "Waveform stopped. (SamplesWritten = %llu, LoopCount = %lu)",
+        waveformPtr->SamplesWritten,
+        waveformPtr->LoopCount);
+}
+
+//
+// Write waveform samples until the Fifo is full. Called from the ISR or with
+// the interrupt lock held.
+//
+_Use_decl_annotations_
+void
+ImxPwmWaveformFill (
+    IMXPWM_DEVICE_CONTEXT* DeviceContextPtr
+    )
+{
+    IMXPWM_WAVEFORM_STATE* waveformPtr = &DeviceContextPtr->Waveform;
+    IMXPWM_REGISTERS* registersPtr = DeviceContextPtr->RegistersPtr;
+
+    IMXPWM_PWMSR_REG pwmSr = { READ_REGISTER_ULONG(&registersPtr->PWMSR) };
+    ULONG freeSlots = IMXPWM_FIFO_SAMPLE_COUNT - pwmSr.FIFOAV;
+
+    while ((freeSlots > 0) && waveformPtr->IsActive) {
+        IMXPWM_PWMSAR_REG pwmSar = { 0 };
+        pwmSar.SAMPLE = waveformPtr->SamplesPtr[waveformPtr->NextSample];
+        WRITE_REGISTER_ULONG(&registersPtr->PWMSAR, pwmSar.AsUlong);
+
+        waveformPtr->SamplesWritten += 1;
+        waveformPtr->NextSample += 1;
+        freeSlots -= 1;
+
+        if (waveformPtr->NextSample == waveformPtr->SampleCount) {
+            if (waveformPtr->IsLooping) {
+                waveformPtr->NextSample = 0;
+                waveformPtr->LoopCount += 1;
+            } else {
+                //
+                // The last sample keeps playing once the Fifo drains.
+                //
+                waveformPtr->IsActive = false;
+            }
+        }
+    }
+}
+
 _Use_decl_annotations_
 void
 ImxPwmInterruptDisable (
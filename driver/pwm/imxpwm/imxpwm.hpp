@@ -72,6 +72,15 @@ static_assert(
     IMXPWM_ROV_EVT_COUNTER_COMPARE <= IMXPWM_PWMPR_PERIOD_MAX,
     "Counter compare for ROV should be less than or equal PWMPR max value");
 
+enum : ULONG {
+    //
+    // Fractional bits of the fixed-point duty cycle to sample scale factor.
+    // (PWMPR_PERIOD_MAX << 44) and (32-bit duty cycle * scale) both fit in
+    // 64-bit.
+    //
+    IMXPWM_DUTY_CYCLE_SCALE_SHIFT = 44,
+};
+
 enum : ULONGLONG {
     PICOSECONDS_IN_1_SECOND = 1000000000000
 };
@@ -87,6 +96,24 @@ struct IMXPWM_PIN_STATE {
     WDFWAITLOCK Lock;
 }; // struct IMXPWM_PIN_STATE
 
+//
+// Duty cycle waveform streamed into the Fifo from the FE interrupt. Fields
+// are owned by the ISR while IsActive is set, and are otherwise modified only
+// with the interrupt lock held.
+//
+struct IMXPWM_WAVEFORM_STATE {
+    //
+    // Precomputed CMP event counter compare samples
+    //
+    USHORT* SamplesPtr;
+    ULONG SampleCount;
+    ULONG NextSample;
+    ULONG LoopCount;
+    ULONGLONG SamplesWritten;
+    bool IsLooping;
+    bool IsActive;
+}; // struct IMXPWM_WAVEFORM_STATE
+
 struct IMXPWM_DEVICE_CONTEXT {
     IMXPWM_REGISTERS* RegistersPtr;
     WDFDEVICE WdfDevice;
@@ -107,6 +134,12 @@ struct IMXPWM_DEVICE_CONTEXT {
     USHORT RovEventCounterCompare;
     USHORT ClockPrescaler;
     //
+    // RovEventCounterCompare / (PWM_PERCENTAGE_MAX >> 32) in fixed-point with
+    // IMXPWM_DUTY_CYCLE_SCALE_SHIFT fractional bits, computed when the period
+    // is set so that converting a duty cycle is a multiply and a shift.
+    //
+    ULONGLONG DutyCycleScale;
+    //
     // Last sample value in the closed range [0, PWMPR + 1]
     //
     USHORT CmpEventCounterCompare;
@@ -126,6 +159,7 @@ struct IMXPWM_DEVICE_CONTEXT {
     PWM_PERIOD DesiredPeriod;
     PWM_PERIOD ActualPeriod;
     IMXPWM_PIN_STATE Pin;
+    IMXPWM_WAVEFORM_STATE Waveform;
 
     //
     // Controller Info
@@ -266,6 +300,27 @@ ImxPwmIoctlPinIsStarted (
     _In_ WDFREQUEST WdfRequest
     );
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+VOID
+ImxPwmIoctlPinStartWaveform (
+    _In_ IMXPWM_DEVICE_CONTEXT* DeviceContextPtr,
+    _In_ WDFREQUEST WdfRequest
+    );
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+VOID
+ImxPwmIoctlPinStopWaveform (
+    _In_ IMXPWM_DEVICE_CONTEXT* DeviceContextPtr,
+    _In_ WDFREQUEST WdfRequest
+    );
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+VOID
+ImxPwmIoctlPinGetWaveformStatus (
+    _In_ IMXPWM_DEVICE_CONTEXT* DeviceContextPtr,
+    _In_ WDFREQUEST WdfRequest
+    );
+
 _IRQL_requires_same_
 NTSTATUS
 ImxPwmSoftReset (
@@ -286,6 +341,33 @@ ImxPwmSetActiveDutyCycle (
     _In_ PWM_PERCENTAGE ActiveDutyCycle
     );
 
+_IRQL_requires_same_
+NTSTATUS
+ImxPwmDutyCycleToSample (
+    _In_ const IMXPWM_DEVICE_CONTEXT* DeviceContextPtr,
+    _In_ PWM_PERCENTAGE ActiveDutyCycle,
+    _Out_ USHORT* SamplePtr
+    );
+
+_IRQL_requires_same_
+NTSTATUS
+ImxPwmStartWaveform (
+    _In_ IMXPWM_DEVICE_CONTEXT* DeviceContextPtr,
+    _In_ const IMXPWM_PIN_START_WAVEFORM_INPUT* InputPtr
+    );
+
+_IRQL_requires_same_
+void
+ImxPwmStopWaveform (
+    _In_ IMXPWM_DEVICE_CONTEXT* DeviceContextPtr
+    );
+
+_IRQL_requires_same_
+void
+ImxPwmWaveformFill (
+    _In_ IMXPWM_DEVICE_CONTEXT* DeviceContextPtr
+    );
+
 _IRQL_requires_same_
 NTSTATUS
 ImxPwmSetPolarity (
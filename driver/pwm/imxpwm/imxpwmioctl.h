@@ -0,0 +1,125 @@
+/* Copyright (c) Microsoft Corporation. All rights reserved.
+   Licensed under the MIT License.
+
+Module Name:
+
+    imxpwmioctl.h
+
+Abstract:
+
+    This module contains the i.MX specific extensions to the Pulse Width
+    Modulator (PWM) IOCTL interface defined in pwm.h. The IOCTLs are sent to
+    a pin interface opened through GUID_DEVINTERFACE_PWM_CONTROLLER.
+
+Environment:
+
+    Kernel-mode and user-mode.
+
+*/
+
+#include <winapifamily.h>
+
+#if WINAPI_FAMILY_PARTITION(WINAPI_PARTITION_DESKTOP)
+
+#if (NTDDI_VERSION >= NTDDI_WIN10)
+
+#ifdef _MSC_VER
+#pragma once
+#endif //_MSC_VER
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+//
+// IOCTL codes enumeration
+//
+enum {
+    // Pin IOCTLs
+    IMXPWM_IOCTL_ID_PIN_START_WAVEFORM = 200,
+    IMXPWM_IOCTL_ID_PIN_STOP_WAVEFORM,
+    IMXPWM_IOCTL_ID_PIN_GET_WAVEFORM_STATUS,
+};
+
+//
+// Maximum number of duty cycle samples in a single waveform.
+//
+#define IMXPWM_WAVEFORM_SAMPLE_COUNT_MAX 65536
+
+//
+// IOCTL_IMXPWM_PIN_START_WAVEFORM
+//
+// Streams a buffer of duty cycle samples into the PWM sample Fifo, one sample
+// per PWM period (times SampleRepeat). The samples are copied into the driver
+// and the request completes once streaming has started; the Fifo is refilled
+// from the Fifo Empty interrupt. A one-shot waveform holds its last sample
+// once the buffer is exhausted, a looping waveform restarts from the first
+// sample until it is stopped.
+//
+// The pin is started if it is not already. Streaming is stopped by
+// IOCTL_IMXPWM_PIN_STOP_WAVEFORM, IOCTL_PWM_PIN_STOP, setting a duty cycle
+// through IOCTL_PWM_PIN_SET_ACTIVE_DUTY_CYCLE_PERCENTAGE, starting another
+// waveform or closing the pin.
+//
+
+#define IOCTL_IMXPWM_PIN_START_WAVEFORM \
+            CTL_CODE( \
+                FILE_DEVICE_CONTROLLER, \
+                IMXPWM_IOCTL_ID_PIN_START_WAVEFORM, \
+                METHOD_BUFFERED, \
+                FILE_WRITE_DATA)
+
+#define IMXPWM_WAVEFORM_FLAG_LOOP   0x00000001
+
+typedef enum _IMXPWM_WAVEFORM_REPEAT {
+    IMXPWM_WAVEFORM_REPEAT_1,
+    IMXPWM_WAVEFORM_REPEAT_2,
+    IMXPWM_WAVEFORM_REPEAT_4,
+    IMXPWM_WAVEFORM_REPEAT_8,
+} IMXPWM_WAVEFORM_REPEAT;
+
+typedef struct _IMXPWM_PIN_START_WAVEFORM_INPUT {
+    ULONG Flags;
+    IMXPWM_WAVEFORM_REPEAT SampleRepeat;
+    ULONG SampleCount;
+    PWM_PERCENTAGE Samples[ANYSIZE_ARRAY];
+} IMXPWM_PIN_START_WAVEFORM_INPUT;
+
+//
+// IOCTL_IMXPWM_PIN_STOP_WAVEFORM
+//
+// Stops streaming. The pin keeps running with the sample that was playing
+// when the waveform was stopped.
+//
+
+#define IOCTL_IMXPWM_PIN_STOP_WAVEFORM \
+            CTL_CODE( \
+                FILE_DEVICE_CONTROLLER, \
+                IMXPWM_IOCTL_ID_PIN_STOP_WAVEFORM, \
+                METHOD_NEITHER, \
+                FILE_WRITE_DATA)
+
+//
+// IOCTL_IMXPWM_PIN_GET_WAVEFORM_STATUS
+//
+
+#define IOCTL_IMXPWM_PIN_GET_WAVEFORM_STATUS \
+            CTL_CODE( \
+                FILE_DEVICE_CONTROLLER, \
+                IMXPWM_IOCTL_ID_PIN_GET_WAVEFORM_STATUS, \
+                METHOD_BUFFERED, \
+                FILE_ANY_ACCESS)
+
+typedef struct _IMXPWM_PIN_GET_WAVEFORM_STATUS_OUTPUT {
+    BOOLEAN IsActive;
+    ULONG LoopCount;
+    ULONGLONG SamplesWritten;
+} IMXPWM_PIN_GET_WAVEFORM_STATUS_OUTPUT;
+
+#ifdef __cplusplus
+} // extern "C"
+#endif // __cplusplus
+
+#endif // NTDDI_VERSION >= NTDDI_WIN10
+
+#endif // WINAPI_FAMILY_PARTITION(WINAPI_PARTITION_DESKTOP)
@@ -76,6 +76,15 @@ ImxPwmEvtIoDeviceControl (
         case IOCTL_PWM_PIN_IS_STARTED:
             ImxPwmIoctlPinIsStarted(deviceContextPtr, WdfRequest);
             break;
+        case IOCTL_IMXPWM_PIN_START_WAVEFORM:
+            ImxPwmIoctlPinStartWaveform(deviceContextPtr, WdfRequest);
+            break;
+        case IOCTL_IMXPWM_PIN_STOP_WAVEFORM:
+            ImxPwmIoctlPinStopWaveform(deviceContextPtr, WdfRequest);
+            break;
+        case IOCTL_IMXPWM_PIN_GET_WAVEFORM_STATUS:
+            ImxPwmIoctlPinGetWaveformStatus(deviceContextPtr, WdfRequest);
+            break;
         default:
             IMXPWM_LOG_INFORMATION("IOCTL not supported. (IoControlCode = 0x%x)", IoControlCode);
             WdfRequestComplete(WdfRequest, STATUS_NOT_SUPPORTED);
@@ -102,6 +111,9 @@ ImxPwmEvtIoDeviceControl (
         case IOCTL_PWM_PIN_START:
         case IOCTL_PWM_PIN_STOP:
         case IOCTL_PWM_PIN_IS_STARTED:
+        case IOCTL_IMXPWM_PIN_START_WAVEFORM:
+        case IOCTL_IMXPWM_PIN_STOP_WAVEFORM:
+        case IOCTL_IMXPWM_PIN_GET_WAVEFORM_STATUS:
             IMXPWM_LOG_INFORMATION(
                 "Pin IOCTL directed to a controller. (IoControlCode = 0x%x)",
                 IoControlCode);
@@ -512,4 +524,127 @@ ImxPwmIoctlPinIsStarted (
         sizeof(*outputBufferPtr));
 }
 
+_Use_decl_annotations_
+VOID
+ImxPwmIoctlPinStartWaveform (
+    IMXPWM_DEVICE_CONTEXT* DeviceContextPtr,
+    WDFREQUEST WdfRequest
+    )
+{
+    IMXPWM_ASSERT_MAX_IRQL(DISPATCH_LEVEL);
+    IMXPWM_LOG_TRACE("()");
+
+    IMXPWM_PIN_START_WAVEFORM_INPUT* inputBufferPtr;
+    size_t inputBufferLength;
+    NTSTATUS status = WdfRequestRetrieveInputBuffer(
+        WdfRequest,
+        FIELD_OFFSET(IMXPWM_PIN_START_WAVEFORM_INPUT, Samples),
+        reinterpret_cast<PVOID*>(&inputBufferPtr),
+        &inputBufferLength);
+    if (!NT_SUCCESS(status)) {
+        IMXPWM_LOG_ERROR(
+            "WdfRequestRetrieveInputBuffer(..) failed. (status = %!STATUS!)",
+            status);
+
+        WdfRequestComplete(WdfRequest, status);
+        return;
+    }
+
+    const ULONG sampleCount = inputBufferPtr->SampleCount;
+    if ((sampleCount == 0) ||
+        (sampleCount > IMXPWM_WAVEFORM_SAMPLE_COUNT_MAX) ||
+        (inputBufferLength <
+            FIELD_OFFSET(IMXPWM_PIN_START_WAVEFORM_INPUT, Samples) +
+            (sampleCount * sizeof(PWM_PERCENTAGE)))) {
+        IMXPWM_LOG_INFORMATION(
+            "Invalid waveform sample count. "
+            "(SampleCount = %lu, InputBufferLength = %Iu)",
+            sampleCount,
+            inputBufferLength);
+        WdfRequestComplete(WdfRequest, STATUS_INVALID_PARAMETER);
+        return;
+    }
+
+    switch (inputBufferPtr->SampleRepeat) {
+    case IMXPWM_WAVEFORM_REPEAT_1:
+    case IMXPWM_WAVEFORM_REPEAT_2:
+    case IMXPWM_WAVEFORM_REPEAT_4:
+    case IMXPWM_WAVEFORM_REPEAT_8:
+        break;
+
+    default:
+        WdfRequestComplete(WdfRequest, STATUS_INVALID_PARAMETER);
+        return;
+    }
+
+    if ((inputBufferPtr->Flags & ~ULONG(IMXPWM_WAVEFORM_FLAG_LOOP)) != 0) {
+        WdfRequestComplete(WdfRequest, STATUS_INVALID_PARAMETER);
+        return;
+    }
+
+    status = ImxPwmStartWaveform(DeviceContextPtr, inputBufferPtr);
+    if (!NT_SUCCESS(status)) {
+        WdfRequestComplete(WdfRequest, status);
+        return;
+    }
+
+    WdfRequestComplete(WdfRequest, STATUS_SUCCESS);
+}
+
+_Use_decl_annotations_
+VOID
+ImxPwmIoctlPinStopWaveform (
+    IMXPWM_DEVICE_CONTEXT* DeviceContextPtr,
+    WDFREQUEST WdfRequest
+    )
+{
+    IMXPWM_ASSERT_MAX_IRQL(DISPATCH_LEVEL);
+    IMXPWM_LOG_TRACE("()");
+
+    if (DeviceContextPtr->Waveform.SamplesPtr != nullptr) {
+        ImxPwmStopWaveform(DeviceContextPtr);
+    }
+
+    WdfRequestComplete(WdfRequest, STATUS_SUCCESS);
+}
+
+_Use_decl_annotations_
+VOID
+ImxPwmIoctlPinGetWaveformStatus (
+    IMXPWM_DEVICE_CONTEXT* DeviceContextPtr,
+    WDFREQUEST WdfRequest
+    )
+{
+    IMXPWM_ASSERT_MAX_IRQL(DISPATCH_LEVEL);
+    IMXPWM_LOG_TRACE("()");
+
+    IMXPWM_PIN_GET_WAVEFORM_STATUS_OUTPUT* outputBufferPtr;
+    NTSTATUS status = WdfRequestRetrieveOutputBuffer(
+            WdfRequest,
+            sizeof(*outputBufferPtr),
+            reinterpret_cast<PVOID*>(&outputBufferPtr),
+            nullptr);
+    if (!NT_SUCCESS(status)) {
+        IMXPWM_LOG_ERROR(
+            "WdfRequestRetrieveOutputBuffer(..) failed. (status = %!STATUS!)",
+            status);
+
+        WdfRequestComplete(WdfRequest, status);
+        return;
+    }
+
+    const IMXPWM_WAVEFORM_STATE* waveformPtr = &DeviceContextPtr->Waveform;
+
+    WdfInterruptAcquireLock(DeviceContextPtr->WdfInterrupt);
+    outputBufferPtr->IsActive = waveformPtr->IsActive;
+    outputBufferPtr->LoopCount = waveformPtr->LoopCount;
+    outputBufferPtr->SamplesWritten = waveformPtr->SamplesWritten;
+    WdfInterruptReleaseLock(DeviceContextPtr->WdfInterrupt);
+
+    WdfRequestCompleteWithInformation(
+        WdfRequest,
+        STATUS_SUCCESS,
+        sizeof(*outputBufferPtr));
+}
+
 IMXPWM_NONPAGED_SEGMENT_END; //=================================================
\ No newline at end of file
@@ -46,6 +46,21 @@ ImxPwmEvtInterruptIsr (
         return FALSE;
     }
 
+    //
+    // A streaming waveform is refilled right here, the interrupt stays
+    // enabled until the last sample has been written.
+    //
+    if (deviceContextPtr->Waveform.IsActive && (pwmSr.FE != 0)) {
+        WRITE_REGISTER_ULONG(&registersPtr->PWMSR, pwmSr.AsUlong);
+
+        ImxPwmWaveformFill(deviceContextPtr);
+        if (!deviceContextPtr->Waveform.IsActive) {
+            ImxPwmInterruptDisable(deviceContextPtr);
+        }
+
+        return TRUE;
+    }
+
     //
     // Disable interrupts. It will be re-enabled later on-demand.
     //
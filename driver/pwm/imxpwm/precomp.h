@@ -8,4 +8,5 @@
 #include <ntintsafe.h>
 #include <ntstrsafe.h>
 #include <pwm.h>
-#include <pwmutil.h>
\ No newline at end of file
+#include <pwmutil.h>
+#include "imxpwmioctl.h"
\ No newline at end of file
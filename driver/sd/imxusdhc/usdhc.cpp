@@ -2488,6 +2488,7 @@ SdhcReadDeviceProperties(
     ASSERT_MAX_IRQL(APC_LEVEL);
 
     ACPI_EVAL_OUTPUT_BUFFER UNALIGNED* dsdBufferPtr = nullptr;
+    ACPI_DEVICE_PROPERTIES_INDEX* devicePropertiesIndexPtr = nullptr;
     NTSTATUS status;
 
     USDHC_DEVICE_PROPERTIES* devPropsPtr =
@@ -2514,15 +2515,14 @@ SdhcReadDeviceProperties(
         goto Cleanup;
     }
 
-    const ACPI_METHOD_ARGUMENT UNALIGNED* devicePropertiesPkgPtr;
-    status = AcpiParseDsdAsDeviceProperties(dsdBufferPtr, &devicePropertiesPkgPtr);
+    status = AcpiParseDsdAsDeviceProperties(dsdBufferPtr, &devicePropertiesIndexPtr);
     if (!NT_SUCCESS(status)) {
         goto Cleanup;
     }
 
     status =
         AcpiDevicePropertiesQueryIntegerValue(
-            devicePropertiesPkgPtr,
+            devicePropertiesIndexPtr,
             "RegisterBasePA",
             &devPropsPtr->Key);
     if (!NT_SUCCESS(status)) {
@@ -2536,7 +2536,7 @@ SdhcReadDeviceProperties(
 
     status =
         AcpiDevicePropertiesQueryIntegerValue(
-            devicePropertiesPkgPtr,
+            devicePropertiesIndexPtr,
             "BaseClockFrequencyHz",
             &devPropsPtr->BaseClockFrequencyHz);
     if (!NT_SUCCESS(status)) {
@@ -2550,7 +2550,7 @@ SdhcReadDeviceProperties(
 
     status =
         AcpiDevicePropertiesQueryIntegerValue(
-            devicePropertiesPkgPtr,
+            devicePropertiesIndexPtr,
             "Regulator1V8Exist",
             &devPropsPtr->Regulator1V8Exist);
     if (!NT_SUCCESS(status)) {
@@ -2564,7 +2564,7 @@ SdhcReadDeviceProperties(
 
     status =
         AcpiDevicePropertiesQueryIntegerValue(
-            devicePropertiesPkgPtr,
+            devicePropertiesIndexPtr,
             "SlotCount",
             &devPropsPtr->SlotCount);
     if (!NT_SUCCESS(status)) {
@@ -2595,6 +2595,10 @@ SdhcReadDeviceProperties(
 
 Cleanup:
 
+    if (devicePropertiesIndexPtr != nullptr) {
+        AcpiDevicePropertiesFreeIndex(devicePropertiesIndexPtr);
+    }
+
     if (dsdBufferPtr != nullptr) {
         ExFreePoolWithTag(dsdBufferPtr, ACPI_TAG_EVAL_OUTPUT_BUFFER);
     }
@@ -2794,8 +2794,8 @@ NTSTATUS IMXUartReadDeviceProperties (
         return status;
     }
 
-    const ACPI_METHOD_ARGUMENT UNALIGNED* devicePropertiesPkgPtr;
-    status = AcpiParseDsdAsDeviceProperties(dsdBufferPtr, &devicePropertiesPkgPtr);
+    ACPI_DEVICE_PROPERTIES_INDEX* devicePropertiesIndexPtr;
+    status = AcpiParseDsdAsDeviceProperties(dsdBufferPtr, &devicePropertiesIndexPtr);
     if (!NT_SUCCESS(status)) {
         if (dsdBufferPtr != nullptr) {
             ExFreePoolWithTag(dsdBufferPtr, ACPI_TAG_EVAL_OUTPUT_BUFFER);
@@ -2805,7 +2805,7 @@ NTSTATUS IMXUartReadDeviceProperties (
     }
 
     status = AcpiDevicePropertiesQueryIntegerValue(
-        devicePropertiesPkgPtr,
+        devicePropertiesIndexPtr,
         "dte-mode",
         &dteMode);
     if (!NT_SUCCESS(status)) {
@@ -2817,6 +2817,8 @@ NTSTATUS IMXUartReadDeviceProperties (
         DeviceContextPtr->DTEModeSelected = (dteMode != 0);
     }
 
+    AcpiDevicePropertiesFreeIndex(devicePropertiesIndexPtr);
+
     if (dsdBufferPtr != nullptr) {
         ExFreePoolWithTag(dsdBufferPtr, ACPI_TAG_EVAL_OUTPUT_BUFFER);
     }
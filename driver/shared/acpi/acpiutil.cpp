@@ -78,6 +78,26 @@ AcpiArgumentParseInteger(
     _In_ const ACPI_METHOD_ARGUMENT UNALIGNED* ArgumentPtr,
     _Out_ UINT32* ValuePtr);
 
+_IRQL_requires_same_
+UINT32
+AcpiDevicePropertiesHashKey(
+    _In_reads_or_z_(MaxKeyLength) const CHAR* KeyPtr,
+    _In_ SIZE_T MaxKeyLength,
+    _Out_ USHORT* KeyLengthPtr);
+
+_IRQL_requires_same_
+VOID
+AcpiDevicePropertiesIndexInsert(
+    _Inout_ ACPI_DEVICE_PROPERTIES_INDEX* IndexPtr,
+    _In_ const ACPI_METHOD_ARGUMENT UNALIGNED* KeyArgumentPtr,
+    _In_opt_ const ACPI_METHOD_ARGUMENT UNALIGNED* ValueArgumentPtr);
+
+_IRQL_requires_same_
+const ACPI_DEVICE_PROPERTIES_INDEX_ENTRY*
+AcpiDevicePropertiesIndexLookup(
+    _In_ const ACPI_DEVICE_PROPERTIES_INDEX* IndexPtr,
+    _In_ const ANSI_STRING* KeyNameStrPtr);
+
 _IRQL_requires_max_(APC_LEVEL)
 NTSTATUS
 AcpiFormatDsmFunctionNoParamsInputBuffer(
@@ -143,7 +163,7 @@ AcpiQueryDsd(
     }
 
     NTSTATUS status;
-    ACPI_EVAL_OUTPUT_BUFFER UNALIGNED* dsdBufferPtr;
+    ACPI_EVAL_OUTPUT_BUFFER UNALIGNED* dsdBufferPtr = nullptr;
     ACPI_EVAL_INPUT_BUFFER inputBuffer;
 
     RtlZeroMemory(&inputBuffer, sizeof(inputBuffer));
@@ -282,6 +302,56 @@ AcpiDevicePropertiesQueryIntegerValue<UINT32>(
     return STATUS_SUCCESS;
 }
 
+template<>
+_Use_decl_annotations_
+NTSTATUS
+AcpiDevicePropertiesQueryIntegerValue<UINT32>(
+    const ACPI_DEVICE_PROPERTIES_INDEX* DevicePropertiesIndexPtr,
+    const CHAR* KeyNamePtr,
+    UINT32* ValuePtr
+    )
+{
+    if (!ARGUMENT_PRESENT(DevicePropertiesIndexPtr)) {
+        return STATUS_INVALID_PARAMETER_1;
+    }
+
+    if (!ARGUMENT_PRESENT(KeyNamePtr)) {
+        return STATUS_INVALID_PARAMETER_2;
+    }
+
+    if (!ARGUMENT_PRESENT(ValuePtr)) {
+        return STATUS_INVALID_PARAMETER_3;
+    }
+
+    NTSTATUS status;
+    ANSI_STRING keyNameStr;
+    __analysis_assume_nullterminated(KeyNamePtr);
+    status = RtlInitAnsiStringEx(&keyNameStr, KeyNamePtr);
+    if (!NT_SUCCESS(status)) {
+        return status;
+    }
+
+    //
+    // Fail the same way the package scan would, see
+    // AcpiParseDsdAsDeviceProperties
+    //
+    const ACPI_DEVICE_PROPERTIES_INDEX_ENTRY* entryPtr =
+        AcpiDevicePropertiesIndexLookup(DevicePropertiesIndexPtr, &keyNameStr);
+    if (entryPtr == nullptr) {
+        if (!NT_SUCCESS(DevicePropertiesIndexPtr->MalformedPairStatus)) {
+            return DevicePropertiesIndexPtr->MalformedPairStatus;
+        }
+
+        return STATUS_NOT_FOUND;
+    }
+
+    if (entryPtr->ValuePtr == nullptr) {
+        return STATUS_ACPI_INCORRECT_ARGUMENT_COUNT;
+    }
+
+    return AcpiArgumentParseInteger(entryPtr->ValuePtr, ValuePtr);
+}
+
 _Use_decl_annotations_
 NTSTATUS
 AcpiSendIoctlSynchronously(
@@ -306,6 +376,7 @@ AcpiSendIoctlSynchronously(
 
     NTSTATUS status;
     VOID* intermediateBufferPtr = nullptr;
+    IO_STACK_LOCATION* irpStackPtr;
 
     IRP* irpPtr = IoAllocateIrp(PdoPtr->StackSize, FALSE);
     if (irpPtr == nullptr) {
@@ -331,7 +402,7 @@ AcpiSendIoctlSynchronously(
     irpPtr->IoStatus.Information = 0;
     irpPtr->UserBuffer = nullptr;
 
-    IO_STACK_LOCATION* irpStackPtr = IoGetNextIrpStackLocation(irpPtr);
+    irpStackPtr = IoGetNextIrpStackLocation(irpPtr);
     NT_ASSERT(irpStackPtr != nullptr);
     irpStackPtr->MajorFunction = IRP_MJ_DEVICE_CONTROL;
     irpStackPtr->Parameters.DeviceIoControl.IoControlCode = IoControlCode;
@@ -458,6 +529,140 @@ AcpiParseDsdAsDeviceProperties(
     return STATUS_SUCCESS;
 }
 
+_Use_decl_annotations_
+NTSTATUS
+AcpiParseDsdAsDeviceProperties(
+    const ACPI_EVAL_OUTPUT_BUFFER UNALIGNED* DsdBufferPtr,
+    ACPI_DEVICE_PROPERTIES_INDEX** DevicePropertiesIndexPptr
+    )
+{
+    if (!ARGUMENT_PRESENT(DsdBufferPtr)) {
+        return STATUS_INVALID_PARAMETER_1;
+    }
+
+    if (!ARGUMENT_PRESENT(DevicePropertiesIndexPptr)) {
+        return STATUS_INVALID_PARAMETER_2;
+    }
+
+    NTSTATUS status;
+    const ACPI_METHOD_ARGUMENT UNALIGNED* devicePropertiesPkgPtr;
+    ACPI_DEVICE_PROPERTIES_INDEX* indexPtr;
+
+    status = AcpiParseDsdAsDeviceProperties(DsdBufferPtr, &devicePropertiesPkgPtr);
+    if (!NT_SUCCESS(status)) {
+        return status;
+    }
+
+    //
+    // Size the hash table so it is at most half full
+    //
+    UINT32 pairCount = 0;
+    const ACPI_METHOD_ARGUMENT UNALIGNED* currentListEntryPtr = nullptr;
+    while (NT_SUCCESS(
+               AcpiPackageGetNextArgument(
+                   devicePropertiesPkgPtr,
+                   &currentListEntryPtr))) {
+        ++pairCount;
+    }
+
+    UINT32 bucketCount = ACPI_DEVICE_PROPERTIES_INDEX_MIN_BUCKETS;
+    while (bucketCount < (pairCount * 2)) {
+        bucketCount <<= 1;
+    }
+
+    const SIZE_T indexSize =
+        FIELD_OFFSET(ACPI_DEVICE_PROPERTIES_INDEX, Buckets) +
+        (bucketCount * sizeof(ACPI_DEVICE_PROPERTIES_INDEX_ENTRY));
+
+    indexPtr =
+        static_cast<ACPI_DEVICE_PROPERTIES_INDEX*>(
+            ExAllocatePoolWithTag(
+                NonPagedPoolNx,
+                indexSize,
+                ACPI_TAG_DEVICE_PROPERTIES_INDEX));
+    if (indexPtr == nullptr) {
+        return STATUS_INSUFFICIENT_RESOURCES;
+    }
+
+    RtlZeroMemory(indexPtr, indexSize);
+    indexPtr->DevicePropertiesPkgPtr = devicePropertiesPkgPtr;
+    indexPtr->MalformedPairStatus = STATUS_SUCCESS;
+    indexPtr->BucketMask = bucketCount - 1;
+
+    //
+    // Each element in the Device Properties package is a package
+    // key/value pair, see AcpiDevicePropertiesQueryIntegerValue. A package
+    // scan fails on a malformed pair when it gets to it, so a malformed pair
+    // does not fail the parse: indexing stops there and the queries of the
+    // keys that are not indexed return its status.
+    //
+    currentListEntryPtr = nullptr;
+    for (;;) {
+
+        status =
+            AcpiPackageGetNextArgument(
+                devicePropertiesPkgPtr,
+                &currentListEntryPtr);
+        if (!NT_SUCCESS(status)) {
+            NT_ASSERT(status == STATUS_NO_MORE_ENTRIES);
+            break;
+        }
+
+        if (currentListEntryPtr->Type != ACPI_METHOD_ARGUMENT_PACKAGE) {
+            indexPtr->MalformedPairStatus = STATUS_ACPI_INVALID_ARGTYPE;
+            break;
+        }
+
+        const ACPI_METHOD_ARGUMENT UNALIGNED* keyArgumentPtr = nullptr;
+
+        status =
+            AcpiPackageGetNextArgument(
+                currentListEntryPtr,
+                &keyArgumentPtr);
+        if (!NT_SUCCESS(status)) {
+            indexPtr->MalformedPairStatus = STATUS_ACPI_INCORRECT_ARGUMENT_COUNT;
+            break;
+        }
+
+        if (keyArgumentPtr->Type != ACPI_METHOD_ARGUMENT_STRING) {
+            indexPtr->MalformedPairStatus = STATUS_ACPI_INVALID_DATA;
+            break;
+        }
+
+        //
+        // A key without a value fails only the queries of that key
+        //
+        const ACPI_METHOD_ARGUMENT UNALIGNED* valueArgumentPtr = keyArgumentPtr;
+
+        status =
+            AcpiPackageGetNextArgument(
+                currentListEntryPtr,
+                &valueArgumentPtr);
+        if (!NT_SUCCESS(status)) {
+            valueArgumentPtr = nullptr;
+        }
+
+        AcpiDevicePropertiesIndexInsert(indexPtr, keyArgumentPtr, valueArgumentPtr);
+    }
+
+    *DevicePropertiesIndexPptr = indexPtr;
+
+    return STATUS_SUCCESS;
+}
+
+_Use_decl_annotations_
+VOID
+AcpiDevicePropertiesFreeIndex(
+    ACPI_DEVICE_PROPERTIES_INDEX* DevicePropertiesIndexPtr
+    )
+{
+    NT_ASSERT(ARGUMENT_PRESENT(DevicePropertiesIndexPtr));
+
+    ExFreePoolWithTag(
+        DevicePropertiesIndexPtr,
+        ACPI_TAG_DEVICE_PROPERTIES_INDEX);
+}
+
 _Use_decl_annotations_
 NTSTATUS
 AcpiQueryDsm(
@@ -704,6 +909,7 @@ AcpiFormatDsmFunctionNoParamsInputBuffer(
 
     NTSTATUS status;
     ACPI_EVAL_INPUT_BUFFER_COMPLEX* inputBufferPtr;
+    ACPI_METHOD_ARGUMENT UNALIGNED* argumentPtr;
 
     //
     // Device Specific Method (_DSM) takes 4 args:
@@ -738,7 +944,7 @@ AcpiFormatDsmFunctionNoParamsInputBuffer(
     //
     // Argument 0: UUID
     //
-    ACPI_METHOD_ARGUMENT UNALIGNED* argumentPtr = &inputBufferPtr->Argument[0];
+    argumentPtr = &inputBufferPtr->Argument[0];
     ACPI_METHOD_SET_ARGUMENT_BUFFER(argumentPtr, GuidPtr, sizeof(GUID));
 
     //
@@ -891,4 +1097,126 @@ AcpiArgumentParseInteger(
     return STATUS_SUCCESS;
 }
 
+//
+// FNV-1a hash of a key string, stopping at the terminating NUL or at
+// MaxKeyLength characters
+//
+_Use_decl_annotations_
+UINT32
+AcpiDevicePropertiesHashKey(
+    const CHAR* KeyPtr,
+    SIZE_T MaxKeyLength,
+    USHORT* KeyLengthPtr
+    )
+{
+    NT_ASSERT(ARGUMENT_PRESENT(KeyPtr));
+    NT_ASSERT(ARGUMENT_PRESENT(KeyLengthPtr));
+
+    UINT32 hash = 2166136261;
+    SIZE_T keyLength = 0;
+
+    if (MaxKeyLength > MAXUSHORT) {
+        MaxKeyLength = MAXUSHORT;
+    }
+
+    while ((keyLength < MaxKeyLength) && (KeyPtr[keyLength] != ANSI_NULL)) {
+        hash ^= static_cast<UCHAR>(KeyPtr[keyLength]);
+        hash *= 16777619;
+        ++keyLength;
+    }
+
+    *KeyLengthPtr = static_cast<USHORT>(keyLength);
+    return hash;
+}
+
+_Use_decl_annotations_
+VOID
+AcpiDevicePropertiesIndexInsert(
+    ACPI_DEVICE_PROPERTIES_INDEX* IndexPtr,
+    const ACPI_METHOD_ARGUMENT UNALIGNED* KeyArgumentPtr,
+    const ACPI_METHOD_ARGUMENT UNALIGNED* ValueArgumentPtr
+    )
+{
+    NT_ASSERT(ARGUMENT_PRESENT(IndexPtr));
+    NT_ASSERT(KeyArgumentPtr->Type == ACPI_METHOD_ARGUMENT_STRING);
+    NT_ASSERT(IndexPtr->EntryCount < IndexPtr->BucketMask);
+
+    const CHAR* keyPtr = reinterpret_cast<const CHAR*>(KeyArgumentPtr->Data);
+    USHORT keyLength;
+    const UINT32 keyHash =
+        AcpiDevicePropertiesHashKey(
+            keyPtr,
+            KeyArgumentPtr->DataLength,
+            &keyLength);
+
+    //
+    // Linear probing, the table is never more than half full
+    //
+    for (UINT32 bucket = keyHash & IndexPtr->BucketMask;
+         ;
+         bucket = (bucket + 1) & IndexPtr->BucketMask) {
+
+        ACPI_DEVICE_PROPERTIES_INDEX_ENTRY* entryPtr = &IndexPtr->Buckets[bucket];
+
+        if (entryPtr->KeyPtr == nullptr) {
+            entryPtr->KeyPtr = keyPtr;
+            entryPtr->ValuePtr = ValueArgumentPtr;
+            entryPtr->KeyHash = keyHash;
+            entryPtr->KeyLength = keyLength;
+            ++IndexPtr->EntryCount;
+            return;
+        }
+
+        //
+        // Keep the first definition of a key, as a package scan would
+        //
+        if ((entryPtr->KeyHash == keyHash) &&
+            (entryPtr->KeyLength == keyLength) &&
+            RtlEqualMemory(entryPtr->KeyPtr, keyPtr, keyLength)) {
+            return;
+        }
+    }
+}
+
+_Use_decl_annotations_
+const ACPI_DEVICE_PROPERTIES_INDEX_ENTRY*
+AcpiDevicePropertiesIndexLookup(
+    const ACPI_DEVICE_PROPERTIES_INDEX* IndexPtr,
+    const ANSI_STRING* KeyNameStrPtr
+    )
+{
+    NT_ASSERT(ARGUMENT_PRESENT(IndexPtr));
+    NT_ASSERT(ARGUMENT_PRESENT(KeyNameStrPtr));
+
+    //
+    // A key name is shorter than MAXUSHORT, so it never matches an indexed
+    // key that was cut at MAXUSHORT characters
+    //
+    const CHAR* keyNamePtr = KeyNameStrPtr->Buffer;
+    USHORT keyLength;
+    const UINT32 keyHash =
+        AcpiDevicePropertiesHashKey(
+            keyNamePtr,
+            KeyNameStrPtr->Length,
+            &keyLength);
+    NT_ASSERT(keyLength == KeyNameStrPtr->Length);
+
+    for (UINT32 bucket = keyHash & IndexPtr->BucketMask;
+         ;
+         bucket = (bucket + 1) & IndexPtr->BucketMask) {
+
+        const ACPI_DEVICE_PROPERTIES_INDEX_ENTRY* entryPtr = &IndexPtr->Buckets[bucket];
+
+        if (entryPtr->KeyPtr == nullptr) {
+            return nullptr;
+        }
+
+        if ((entryPtr->KeyHash == keyHash) &&
+            (entryPtr->KeyLength == keyLength) &&
+            RtlEqualMemory(entryPtr->KeyPtr, keyNamePtr, keyLength)) {
+            return entryPtr;
+        }
+    }
+}
+
 NONPAGED_SEGMENT_END //===================================================
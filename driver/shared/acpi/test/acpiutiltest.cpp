@@ -0,0 +1,742 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// Module Name:
+//
+//   acpiutiltest.cpp
+//
+// Abstract:
+//
+//   Host test of the Device Properties index in acpiutil.cpp. Builds _DSD
+//   output buffers and checks that a query through the index returns what
+//   the package scan returns, for well formed and malformed key/value
+//   pairs, duplicate keys and long keys, and that the hash table is sized
+//   and probed within its bounds, including keys that share a bucket or a
+//   full hash.
+//
+//   "bench" prints the cost of a key query through the package scan and
+//   through the index for _DSD packages of 4 to 256 pairs.
+//
+//   Build and run from the repository root:
+//
+//     c++ -std=c++14 -O2 -Wall -Wno-multichar
+//         -I driver/shared/hosttest -I driver/include
+//         driver/shared/acpi/test/acpiutiltest.cpp -o acpiutiltest
+//     ./acpiutiltest [bench]
+//
+// Environment:
+//
+//   User mode, host
+//
+
+#include "hosttest.h"
+
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../acpiutil.cpp"
+
+namespace { // static
+
+//
+// An ACPI method argument as laid out in an output buffer
+//
+typedef std::vector<UCHAR> ARGUMENT;
+
+ARGUMENT makeArgument (USHORT Type, const void* DataPtr, size_t DataLength)
+{
+    assert(DataLength <= MAXUSHORT);
+
+    ARGUMENT argument(ACPI_METHOD_ARGUMENT_LENGTH(DataLength), 0);
+    const USHORT dataLength = USHORT(DataLength);
+
+    memcpy(&argument[FIELD_OFFSET(ACPI_METHOD_ARGUMENT, Type)], &Type, sizeof(Type));
+    memcpy(
+        &argument[FIELD_OFFSET(ACPI_METHOD_ARGUMENT, DataLength)],
+        &dataLength,
+        sizeof(dataLength));
+    if (DataLength != 0) {
+        memcpy(&argument[FIELD_OFFSET(ACPI_METHOD_ARGUMENT, Data)], DataPtr, DataLength);
+    }
+
+    return argument;
+}
+
+ARGUMENT integerArgument (ULONG Value)
+{
+    return makeArgument(ACPI_METHOD_ARGUMENT_INTEGER, &Value, sizeof(Value));
+}
+
+//
+// ACPI strings include their terminating NUL
+//
+ARGUMENT stringArgument (const std::string& String)
+{
+    return makeArgument(ACPI_METHOD_ARGUMENT_STRING, String.c_str(), String.size() + 1);
+}
+
+ARGUMENT packageArgument (const std::vector<ARGUMENT>& Elements)
+{
+    ARGUMENT data;
+
+    for (const ARGUMENT& element : Elements) {
+        data.insert(data.end(), element.begin(), element.end());
+    }
+
+    return makeArgument(ACPI_METHOD_ARGUMENT_PACKAGE, data.data(), data.size());
+}
+
+ARGUMENT pairArgument (const std::string& Key, ULONG Value)
+{
+    return packageArgument({ stringArgument(Key), integerArgument(Value) });
+}
+
+//
+// A Device Properties _DSD, its package and its index
+//
+struct TEST_DSD {
+    std::vector<ULONG> Buffer;
+    const ACPI_METHOD_ARGUMENT UNALIGNED* PkgPtr;
+    ACPI_DEVICE_PROPERTIES_INDEX* IndexPtr;
+};
+
+const ACPI_EVAL_OUTPUT_BUFFER* dsdBuffer (const TEST_DSD& Dsd)
+{
+    return reinterpret_cast<const ACPI_EVAL_OUTPUT_BUFFER*>(Dsd.Buffer.data());
+}
+
+void dsdBuild (TEST_DSD* DsdPtr, const GUID& Guid, const ARGUMENT& Properties)
+{
+    const ARGUMENT guid = makeArgument(ACPI_METHOD_ARGUMENT_BUFFER, &Guid, sizeof(Guid));
+    const size_t length =
+        FIELD_OFFSET(ACPI_EVAL_OUTPUT_BUFFER, Argument) + guid.size() + Properties.size();
+
+    DsdPtr->Buffer.assign((length + sizeof(ULONG) - 1) / sizeof(ULONG), 0);
+    DsdPtr->PkgPtr = nullptr;
+    DsdPtr->IndexPtr = nullptr;
+
+    auto bufferPtr = reinterpret_cast<ACPI_EVAL_OUTPUT_BUFFER*>(DsdPtr->Buffer.data());
+    bufferPtr->Signature = ACPI_EVAL_OUTPUT_BUFFER_SIGNATURE;
+    bufferPtr->Length = ULONG(length);
+    bufferPtr->Count = 2;
+
+    auto argumentsPtr = reinterpret_cast<UCHAR*>(bufferPtr->Argument);
+    memcpy(argumentsPtr, guid.data(), guid.size());
+    memcpy(argumentsPtr + guid.size(), Properties.data(), Properties.size());
+}
+
+//
+// Builds a Device Properties _DSD and parses it both ways, the parse is
+// expected to succeed
+//
+void dsdInit (TEST_DSD* DsdPtr, const std::vector<ARGUMENT>& Pairs)
+{
+    dsdBuild(DsdPtr, ACPI_DEVICE_PROPERTIES_DSD_GUID, packageArgument(Pairs));
+
+    HOSTTEST_CHECK_EQ(
+        AcpiParseDsdAsDeviceProperties(dsdBuffer(*DsdPtr), &DsdPtr->PkgPtr),
+        STATUS_SUCCESS);
+    HOSTTEST_CHECK_EQ(
+        AcpiParseDsdAsDeviceProperties(dsdBuffer(*DsdPtr), &DsdPtr->IndexPtr),
+        STATUS_SUCCESS);
+    assert((DsdPtr->PkgPtr != nullptr) && (DsdPtr->IndexPtr != nullptr));
+}
+
+void dsdFree (TEST_DSD* DsdPtr)
+{
+    if (DsdPtr->IndexPtr != nullptr) {
+        AcpiDevicePropertiesFreeIndex(DsdPtr->IndexPtr);
+        DsdPtr->IndexPtr = nullptr;
+    }
+}
+
+NTSTATUS queryIndex (const TEST_DSD& Dsd, const std::string& Key, UINT32* ValuePtr)
+{
+    *ValuePtr = 0xDEADBEEF;
+    return AcpiDevicePropertiesQueryIntegerValue(Dsd.IndexPtr, Key.c_str(), ValuePtr);
+}
+
+NTSTATUS queryScan (const TEST_DSD& Dsd, const std::string& Key, UINT32* ValuePtr)
+{
+    *ValuePtr = 0xDEADBEEF;
+    return AcpiDevicePropertiesQueryIntegerValue(Dsd.PkgPtr, Key.c_str(), ValuePtr);
+}
+
+//
+// The index answers a query as the package scan does, returns the status
+//
+NTSTATUS checkSameAsScan (const TEST_DSD& Dsd, const std::string& Key)
+{
+    UINT32 indexValue;
+    UINT32 scanValue;
+    const NTSTATUS indexStatus = queryIndex(Dsd, Key, &indexValue);
+    const NTSTATUS scanStatus = queryScan(Dsd, Key, &scanValue);
+
+    HOSTTEST_CHECK_EQ(indexStatus, scanStatus);
+    if (NT_SUCCESS(scanStatus)) {
+        HOSTTEST_CHECK_EQ(indexValue, scanValue);
+    }
+
+    if ((indexStatus != scanStatus) ||
+        (NT_SUCCESS(scanStatus) && (indexValue != scanValue))) {
+        fprintf(stderr, "  key \"%.32s\" (%zu characters)\n", Key.c_str(), Key.size());
+    }
+
+    return indexStatus;
+}
+
+void testWellFormed ()
+{
+    TEST_DSD dsd;
+    UINT32 value;
+
+    dsdInit(&dsd, {
+        pairArgument("clock-frequency", 66000000),
+        pairArgument("bus-width", 4),
+        pairArgument("x", 0),
+        });
+
+    HOSTTEST_CHECK_EQ(dsd.IndexPtr->EntryCount, 3);
+    HOSTTEST_CHECK_EQ(dsd.IndexPtr->MalformedPairStatus, STATUS_SUCCESS);
+
+    HOSTTEST_CHECK_EQ(queryIndex(dsd, "clock-frequency", &value), STATUS_SUCCESS);
+    HOSTTEST_CHECK_EQ(value, 66000000);
+    HOSTTEST_CHECK_EQ(queryIndex(dsd, "bus-width", &value), STATUS_SUCCESS);
+    HOSTTEST_CHECK_EQ(value, 4);
+    HOSTTEST_CHECK_EQ(queryIndex(dsd, "x", &value), STATUS_SUCCESS);
+    HOSTTEST_CHECK_EQ(value, 0);
+
+    static const char* const keys[] = {
+        "clock-frequency", "bus-width", "x", "", "bus-widt", "bus-width2", "X",
+    };
+    for (const char* key : keys) {
+        checkSameAsScan(dsd, key);
+    }
+    HOSTTEST_CHECK_EQ(queryIndex(dsd, "bus-widt", &value), STATUS_NOT_FOUND);
+
+    //
+    // Narrower types go through the UINT32 query
+    //
+    UCHAR busWidth = 0;
+    HOSTTEST_CHECK_EQ(
+        AcpiDevicePropertiesQueryIntegerValue(dsd.IndexPtr, "bus-width", &busWidth),
+        STATUS_SUCCESS);
+    HOSTTEST_CHECK_EQ(busWidth, 4);
+
+    HOSTTEST_CHECK_EQ(
+        AcpiDevicePropertiesQueryIntegerValue(
+            static_cast<const ACPI_DEVICE_PROPERTIES_INDEX*>(nullptr),
+            "x",
+            &value),
+        STATUS_INVALID_PARAMETER_1);
+    HOSTTEST_CHECK_EQ(
+        AcpiDevicePropertiesQueryIntegerValue(dsd.IndexPtr, nullptr, &value),
+        STATUS_INVALID_PARAMETER_2);
+
+    dsdFree(&dsd);
+}
+
+//
+// A _DSD that is not Device Properties fails both parses the same way
+//
+void testNotDeviceProperties ()
+{
+    static const GUID otherGuid =
+        { 0xDAFFD814, 0x6EBA, 0x4D8C, { 0x8A, 0x91, 0xBC, 0x9B, 0xBF, 0x4A, 0xA3, 0x02 } };
+    const ACPI_METHOD_ARGUMENT UNALIGNED* pkgPtr;
+    ACPI_DEVICE_PROPERTIES_INDEX* indexPtr;
+    TEST_DSD dsd;
+
+    dsdBuild(&dsd, otherGuid, packageArgument({ pairArgument("a", 1) }));
+    HOSTTEST_CHECK_EQ(
+        AcpiParseDsdAsDeviceProperties(dsdBuffer(dsd), &pkgPtr),
+        STATUS_ACPI_INVALID_DATA);
+    HOSTTEST_CHECK_EQ(
+        AcpiParseDsdAsDeviceProperties(dsdBuffer(dsd), &indexPtr),
+        STATUS_ACPI_INVALID_DATA);
+
+    dsdBuild(&dsd, ACPI_DEVICE_PROPERTIES_DSD_GUID, integerArgument(1));
+    HOSTTEST_CHECK_EQ(
+        AcpiParseDsdAsDeviceProperties(dsdBuffer(dsd), &pkgPtr),
+        STATUS_ACPI_INVALID_ARGTYPE);
+    HOSTTEST_CHECK_EQ(
+        AcpiParseDsdAsDeviceProperties(dsdBuffer(dsd), &indexPtr),
+        STATUS_ACPI_INVALID_ARGTYPE);
+}
+
+//
+// A malformed pair fails the keys a package scan does not find before it,
+// the parse itself succeeds
+//
+void testMalformedPairs ()
+{
+    struct MALFORMED_CASE {
+        const char* Name;
+        std::vector<ARGUMENT> Pairs;
+        NTSTATUS MalformedPairStatus;
+        NTSTATUS AfterStatus;       // Status of the "after" key
+    };
+
+    const MALFORMED_CASE cases[] = {
+        {
+            "non-package entry",
+            { pairArgument("before", 1), integerArgument(7), pairArgument("after", 2) },
+            STATUS_ACPI_INVALID_ARGTYPE,
+            STATUS_ACPI_INVALID_ARGTYPE,
+        },
+        {
+            "empty pair",
+            { pairArgument("before", 1), packageArgument({}), pairArgument("after", 2) },
+            STATUS_ACPI_INCORRECT_ARGUMENT_COUNT,
+            STATUS_ACPI_INCORRECT_ARGUMENT_COUNT,
+        },
+        {
+            "integer key",
+            {
+                pairArgument("before", 1),
+                packageArgument({ integerArgument(5), integerArgument(6) }),
+                pairArgument("after", 2),
+            },
+            STATUS_ACPI_INVALID_DATA,
+            STATUS_ACPI_INVALID_DATA,
+        },
+        {
+            "key without value",
+            {
+                pairArgument("before", 1),
+                packageArgument({ stringArgument("keyonly") }),
+                pairArgument("after", 2),
+            },
+            STATUS_SUCCESS,
+            STATUS_SUCCESS,
+        },
+        {
+            "string value",
+            {
+                pairArgument("before", 1),
+                packageArgument({ stringArgument("string"), stringArgument("text") }),
+                pairArgument("after", 2),
+            },
+            STATUS_SUCCESS,
+            STATUS_SUCCESS,
+        },
+        {
+            "extra elements",
+            {
+                packageArgument({ stringArgument("before"), integerArgument(1), integerArgument(9) }),
+                pairArgument("after", 2),
+            },
+            STATUS_SUCCESS,
+            STATUS_SUCCESS,
+        },
+        {
+            "malformed first",
+            { integerArgument(7), pairArgument("before", 1), pairArgument("after", 2) },
+            STATUS_ACPI_INVALID_ARGTYPE,
+            STATUS_ACPI_INVALID_ARGTYPE,
+        },
+        {
+            "key without value, then malformed",
+            {
+                pairArgument("before", 1),
+                packageArgument({ stringArgument("keyonly") }),
+                packageArgument({}),
+                pairArgument("after", 2),
+            },
+            STATUS_ACPI_INCORRECT_ARGUMENT_COUNT,
+            STATUS_ACPI_INCORRECT_ARGUMENT_COUNT,
+        },
+        {
+            "two malformed",
+            {
+                pairArgument("before", 1),
+                packageArgument({ integerArgument(5) }),
+                integerArgument(7),
+                pairArgument("after", 2),
+            },
+            STATUS_ACPI_INVALID_DATA,
+            STATUS_ACPI_INVALID_DATA,
+        },
+    };
+
+    static const char* const keys[] = {
+        "before", "after", "keyonly", "string", "missing",
+    };
+
+    for (const MALFORMED_CASE& testCase : cases) {
+        const int failuresBefore = HostTestFailureCount;
+        TEST_DSD dsd;
+        UINT32 value;
+
+        dsdInit(&dsd, testCase.Pairs);
+        HOSTTEST_CHECK_EQ(dsd.IndexPtr->MalformedPairStatus, testCase.MalformedPairStatus);
+
+        for (const char* key : keys) {
+            checkSameAsScan(dsd, key);
+        }
+
+        HOSTTEST_CHECK_EQ(queryIndex(dsd, "after", &value), testCase.AfterStatus);
+        if (NT_SUCCESS(testCase.AfterStatus)) {
+            HOSTTEST_CHECK_EQ(value, 2);
+        }
+
+        if (HostTestFailureCount != failuresBefore) {
+            fprintf(stderr, "  case \"%s\"\n", testCase.Name);
+        }
+
+        dsdFree(&dsd);
+    }
+
+    //
+    // The statuses the index keeps for the keys it holds
+    //
+    TEST_DSD dsd;
+    UINT32 value;
+
+    dsdInit(&dsd, {
+        pairArgument("before", 1),
+        packageArgument({ stringArgument("keyonly") }),
+        packageArgument({ stringArgument("string"), stringArgument("text") }),
+        integerArgument(7),
+        });
+    HOSTTEST_CHECK_EQ(dsd.IndexPtr->EntryCount, 3);
+    HOSTTEST_CHECK_EQ(queryIndex(dsd, "before", &value), STATUS_SUCCESS);
+    HOSTTEST_CHECK_EQ(value, 1);
+    HOSTTEST_CHECK_EQ(queryIndex(dsd, "keyonly", &value), STATUS_ACPI_INCORRECT_ARGUMENT_COUNT);
+    HOSTTEST_CHECK_EQ(queryIndex(dsd, "string", &value), STATUS_ACPI_INVALID_ARGTYPE);
+    HOSTTEST_CHECK_EQ(queryIndex(dsd, "missing", &value), STATUS_ACPI_INVALID_ARGTYPE);
+    dsdFree(&dsd);
+}
+
+//
+// The first definition of a key wins, as in a package scan
+//
+void testDuplicateKeys ()
+{
+    TEST_DSD dsd;
+    UINT32 value;
+
+    dsdInit(&dsd, {
+        pairArgument("a", 1),
+        pairArgument("b", 2),
+        pairArgument("a", 3),
+        packageArgument({ stringArgument("b") }),
+        packageArgument({ stringArgument("k") }),
+        pairArgument("k", 5),
+        pairArgument("s", 6),
+        packageArgument({ stringArgument("s"), stringArgument("text") }),
+        });
+
+    HOSTTEST_CHECK_EQ(dsd.IndexPtr->EntryCount, 4);
+    HOSTTEST_CHECK_EQ(queryIndex(dsd, "a", &value), STATUS_SUCCESS);
+    HOSTTEST_CHECK_EQ(value, 1);
+    HOSTTEST_CHECK_EQ(queryIndex(dsd, "b", &value), STATUS_SUCCESS);
+    HOSTTEST_CHECK_EQ(value, 2);
+    HOSTTEST_CHECK_EQ(queryIndex(dsd, "k", &value), STATUS_ACPI_INCORRECT_ARGUMENT_COUNT);
+    HOSTTEST_CHECK_EQ(queryIndex(dsd, "s", &value), STATUS_SUCCESS);
+    HOSTTEST_CHECK_EQ(value, 6);
+
+    static const char* const keys[] = { "a", "b", "k", "s", "c" };
+    for (const char* key : keys) {
+        checkSameAsScan(dsd, key);
+    }
+
+    dsdFree(&dsd);
+
+    //
+    // Many definitions of one key take one entry, the table is still sized
+    // for all the pairs
+    //
+    std::vector<ARGUMENT> pairs;
+    for (ULONG i = 0; i < 100; ++i) {
+        pairs.push_back(pairArgument("dup", 1000 + i));
+    }
+
+    dsdInit(&dsd, pairs);
+    HOSTTEST_CHECK_EQ(dsd.IndexPtr->EntryCount, 1);
+    HOSTTEST_CHECK_EQ(dsd.IndexPtr->BucketMask + 1, 256);
+    HOSTTEST_CHECK_EQ(queryIndex(dsd, "dup", &value), STATUS_SUCCESS);
+    HOSTTEST_CHECK_EQ(value, 1000);
+    checkSameAsScan(dsd, "dup");
+    dsdFree(&dsd);
+}
+
+void testLongKeys ()
+{
+    TEST_DSD dsd;
+    UINT32 value;
+
+    //
+    // Two keys as long as a package allows for two pairs, differing only in
+    // their last character
+    //
+    const std::string longKey(32000, 'k');
+    const std::string otherLongKey = longKey.substr(0, longKey.size() - 1) + "j";
+
+    dsdInit(&dsd, { pairArgument(longKey, 1), pairArgument(otherLongKey, 2) });
+    HOSTTEST_CHECK_EQ(dsd.IndexPtr->EntryCount, 2);
+    HOSTTEST_CHECK_EQ(queryIndex(dsd, longKey, &value), STATUS_SUCCESS);
+    HOSTTEST_CHECK_EQ(value, 1);
+    HOSTTEST_CHECK_EQ(queryIndex(dsd, otherLongKey, &value), STATUS_SUCCESS);
+    HOSTTEST_CHECK_EQ(value, 2);
+
+    const std::string queries[] = {
+        longKey,
+        otherLongKey,
+        longKey + "k",
+        longKey.substr(0, longKey.size() - 1),
+        std::string(MAXUSHORT - 1, 'k'),
+    };
+    for (const std::string& query : queries) {
+        checkSameAsScan(dsd, query);
+    }
+    HOSTTEST_CHECK_EQ(queryIndex(dsd, longKey + "k", &value), STATUS_NOT_FOUND);
+
+    //
+    // A key name an ANSI_STRING cannot hold fails before the lookup
+    //
+    HOSTTEST_CHECK_EQ(
+        checkSameAsScan(dsd, std::string(MAXUSHORT, 'k')),
+        STATUS_NAME_TOO_LONG);
+    HOSTTEST_CHECK_EQ(
+        checkSameAsScan(dsd, std::string(70000, 'k')),
+        STATUS_NAME_TOO_LONG);
+    dsdFree(&dsd);
+
+    //
+    // The key ends at its first NUL, or at the end of its data if it has
+    // none. The argument padding terminates it for the package scan.
+    //
+    dsdInit(&dsd, {
+        packageArgument({
+            makeArgument(ACPI_METHOD_ARGUMENT_STRING, "ab", 2),
+            integerArgument(1),
+            }),
+        packageArgument({
+            makeArgument(ACPI_METHOD_ARGUMENT_STRING, "wxyz", 4),
+            integerArgument(2),
+            }),
+        pairArgument(std::string("cd\0ef", 5), 3),
+        pairArgument("", 4),
+        });
+    HOSTTEST_CHECK_EQ(dsd.IndexPtr->EntryCount, 4);
+
+    static const char* const keys[] = { "ab", "wxyz", "cd", "cd\0ef", "", "a", "wxy" };
+    for (const char* key : keys) {
+        checkSameAsScan(dsd, key);
+    }
+
+    HOSTTEST_CHECK_EQ(queryIndex(dsd, "wxyz", &value), STATUS_SUCCESS);
+    HOSTTEST_CHECK_EQ(value, 2);
+    HOSTTEST_CHECK_EQ(queryIndex(dsd, "cd", &value), STATUS_SUCCESS);
+    HOSTTEST_CHECK_EQ(value, 3);
+    HOSTTEST_CHECK_EQ(queryIndex(dsd, "", &value), STATUS_SUCCESS);
+    HOSTTEST_CHECK_EQ(value, 4);
+    dsdFree(&dsd);
+}
+
+std::string numberedKey (ULONG Number)
+{
+    return "key-" + std::to_string(Number);
+}
+
+//
+// The table is the smallest power of two that is at least
+// ACPI_DEVICE_PROPERTIES_INDEX_MIN_BUCKETS and twice the pair count, and
+// every key is found within it
+//
+void testTableBounds ()
+{
+    for (ULONG pairCount = 0; pairCount <= 300; ++pairCount) {
+        const int failuresBefore = HostTestFailureCount;
+        std::vector<ARGUMENT> pairs;
+        TEST_DSD dsd;
+
+        for (ULONG i = 0; i < pairCount; ++i) {
+            pairs.push_back(pairArgument(numberedKey(i), i * 3));
+        }
+
+        dsdInit(&dsd, pairs);
+
+        const ULONG bucketCount = dsd.IndexPtr->BucketMask + 1;
+        HOSTTEST_CHECK_EQ(bucketCount & dsd.IndexPtr->BucketMask, 0);
+        HOSTTEST_CHECK(bucketCount >= ACPI_DEVICE_PROPERTIES_INDEX_MIN_BUCKETS);
+        HOSTTEST_CHECK(bucketCount >= (pairCount * 2));
+        HOSTTEST_CHECK(
+            (bucketCount == ACPI_DEVICE_PROPERTIES_INDEX_MIN_BUCKETS) ||
+            (bucketCount < (pairCount * 4)));
+        HOSTTEST_CHECK_EQ(dsd.IndexPtr->EntryCount, pairCount);
+
+        ULONG usedBuckets = 0;
+        for (ULONG bucket = 0; bucket < bucketCount; ++bucket) {
+            usedBuckets += (dsd.IndexPtr->Buckets[bucket].KeyPtr != nullptr) ? 1 : 0;
+        }
+        HOSTTEST_CHECK_EQ(usedBuckets, pairCount);
+
+        for (ULONG i = 0; i < pairCount; ++i) {
+            UINT32 value;
+            HOSTTEST_CHECK_EQ(queryIndex(dsd, numberedKey(i), &value), STATUS_SUCCESS);
+            HOSTTEST_CHECK_EQ(value, i * 3);
+        }
+
+        UINT32 value;
+        HOSTTEST_CHECK_EQ(queryIndex(dsd, numberedKey(pairCount), &value), STATUS_NOT_FOUND);
+
+        if (HostTestFailureCount != failuresBefore) {
+            fprintf(stderr, "  %u pairs\n", pairCount);
+        }
+
+        dsdFree(&dsd);
+    }
+}
+
+UINT32 keyHash (const std::string& Key)
+{
+    USHORT keyLength;
+    return AcpiDevicePropertiesHashKey(Key.c_str(), Key.size() + 1, &keyLength);
+}
+
+//
+// Keys that share a bucket probe past each other and wrap around the end of
+// the table, keys that share the full hash are told apart by their text
+//
+void testCollidingKeys ()
+{
+    const UINT32 bucketMask = ACPI_DEVICE_PROPERTIES_INDEX_MIN_BUCKETS - 1;
+    std::vector<std::string> lastBucketKeys;
+
+    for (ULONG i = 0; lastBucketKeys.size() < 5; ++i) {
+        if ((keyHash(numberedKey(i)) & bucketMask) == bucketMask) {
+            lastBucketKeys.push_back(numberedKey(i));
+        }
+    }
+
+    //
+    // Four pairs fill half of the smallest table: the last bucket, then
+    // the first three
+    //
+    TEST_DSD dsd;
+    UINT32 value;
+
+    dsdInit(&dsd, {
+        pairArgument(lastBucketKeys[0], 0),
+        pairArgument(lastBucketKeys[1], 1),
+        pairArgument(lastBucketKeys[2], 2),
+        pairArgument(lastBucketKeys[3], 3),
+        });
+    HOSTTEST_CHECK_EQ(dsd.IndexPtr->BucketMask, bucketMask);
+    HOSTTEST_CHECK(dsd.IndexPtr->Buckets[bucketMask].KeyPtr != nullptr);
+    HOSTTEST_CHECK(dsd.IndexPtr->Buckets[0].KeyPtr != nullptr);
+    HOSTTEST_CHECK(dsd.IndexPtr->Buckets[2].KeyPtr != nullptr);
+    HOSTTEST_CHECK(dsd.IndexPtr->Buckets[3].KeyPtr == nullptr);
+
+    for (ULONG i = 0; i < 4; ++i) {
+        HOSTTEST_CHECK_EQ(queryIndex(dsd, lastBucketKeys[i], &value), STATUS_SUCCESS);
+        HOSTTEST_CHECK_EQ(value, i);
+    }
+    HOSTTEST_CHECK_EQ(queryIndex(dsd, lastBucketKeys[4], &value), STATUS_NOT_FOUND);
+    dsdFree(&dsd);
+
+    //
+    // Two keys with the same 32 bit hash
+    //
+    std::unordered_map<UINT32, std::string> keysByHash;
+    std::string firstKey;
+    std::string secondKey;
+
+    for (ULONG i = 0; firstKey.empty(); ++i) {
+        const std::string key = numberedKey(i);
+        auto inserted = keysByHash.emplace(keyHash(key), key);
+        if (!inserted.second) {
+            firstKey = inserted.first->second;
+            secondKey = key;
+        }
+    }
+
+    HOSTTEST_CHECK_EQ(keyHash(firstKey), keyHash(secondKey));
+
+    dsdInit(&dsd, { pairArgument(firstKey, 1), pairArgument(secondKey, 2) });
+    HOSTTEST_CHECK_EQ(dsd.IndexPtr->EntryCount, 2);
+    HOSTTEST_CHECK_EQ(queryIndex(dsd, firstKey, &value), STATUS_SUCCESS);
+    HOSTTEST_CHECK_EQ(value, 1);
+    HOSTTEST_CHECK_EQ(queryIndex(dsd, secondKey, &value), STATUS_SUCCESS);
+    HOSTTEST_CHECK_EQ(value, 2);
+    dsdFree(&dsd);
+
+    dsdInit(&dsd, { pairArgument(firstKey, 1) });
+    HOSTTEST_CHECK_EQ(queryIndex(dsd, secondKey, &value), STATUS_NOT_FOUND);
+    dsdFree(&dsd);
+}
+
+//
+// Nanoseconds per query of every key of the package, in order
+//
+template <typename QUERY>
+double nsPerQuery (const TEST_DSD& Dsd, const std::vector<std::string>& Keys, QUERY Query)
+{
+    const ULONG queries = 2000000;
+    const ULONG rounds = ULONG(queries / Keys.size());
+    volatile UINT32 sink = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (ULONG round = 0; round < rounds; ++round) {
+        for (const std::string& key : Keys) {
+            UINT32 value;
+            if (NT_SUCCESS(Query(Dsd, key, &value))) {
+                sink = sink + value;
+            }
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - start).count() /
+           (double(rounds) * Keys.size());
+}
+
+void benchmark ()
+{
+    static const ULONG pairCounts[] = { 4, 16, 64, 256 };
+
+    printf("\nDevice Properties key query, ns per query of each key in turn\n");
+    printf("%8s %12s %12s\n", "pairs", "scan", "index");
+
+    for (ULONG pairCount : pairCounts) {
+        std::vector<ARGUMENT> pairs;
+        std::vector<std::string> keys;
+        TEST_DSD dsd;
+
+        for (ULONG i = 0; i < pairCount; ++i) {
+            keys.push_back("vendor,property-" + std::to_string(i));
+            pairs.push_back(pairArgument(keys.back(), i));
+        }
+
+        dsdInit(&dsd, pairs);
+        printf(
+            "%8u %12.1f %12.1f\n",
+            pairCount,
+            nsPerQuery(dsd, keys, queryScan),
+            nsPerQuery(dsd, keys, queryIndex));
+        dsdFree(&dsd);
+    }
+}
+
+} // namespace "static"
+
+int main (int argc, char* argv[])
+{
+    HOSTTEST_RUN(testWellFormed);
+    HOSTTEST_RUN(testNotDeviceProperties);
+    HOSTTEST_RUN(testMalformedPairs);
+    HOSTTEST_RUN(testDuplicateKeys);
+    HOSTTEST_RUN(testLongKeys);
+    HOSTTEST_RUN(testTableBounds);
+    HOSTTEST_RUN(testCollidingKeys);
+
+    if ((argc > 1) && (strcmp(argv[1], "bench") == 0)) {
+        benchmark();
+    }
+
+    return HostTestExit();
+}
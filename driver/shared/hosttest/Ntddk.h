@@ -0,0 +1,194 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// Host stand-in for the WDK header of the same name, see hosttest.h.
+// Provides the kernel types and routines that the shared ACPI utilities
+// refer to. Pool allocations come from the C heap. The host tests do not
+// send IRPs, so IoAllocateIrp always fails.
+//
+
+#ifndef _HOSTTEST_NTDDK_H_
+#define _HOSTTEST_NTDDK_H_
+
+#include "hosttest.h"
+
+#define __pragma(Pragma)
+
+#define ARGUMENT_PRESENT(ArgumentPointer) ((CHAR*)(ArgumentPointer) != NULL)
+#define NT_ASSERTMSG(Message, Condition) assert((Message) && (Condition))
+#define ANSI_NULL ((CHAR)0)
+
+#define STATUS_NAME_TOO_LONG                    ((NTSTATUS)0xC0000106L)
+#define STATUS_INVALID_PARAMETER_1              ((NTSTATUS)0xC00000EFL)
+#define STATUS_INVALID_PARAMETER_2              ((NTSTATUS)0xC00000F0L)
+#define STATUS_INVALID_PARAMETER_3              ((NTSTATUS)0xC00000F1L)
+#define STATUS_INVALID_PARAMETER_4              ((NTSTATUS)0xC00000F2L)
+#define STATUS_NOT_FOUND                        ((NTSTATUS)0xC0000225L)
+#define STATUS_ACPI_INVALID_ARGTYPE             ((NTSTATUS)0xC0140008L)
+#define STATUS_ACPI_INCORRECT_ARGUMENT_COUNT    ((NTSTATUS)0xC014000BL)
+#define STATUS_ACPI_INVALID_DATA                ((NTSTATUS)0xC014000FL)
+
+#define METHOD_FROM_CTL_CODE(CtrlCode) ((ULONG)((CtrlCode) & 3))
+
+//
+// IRQL
+//
+
+typedef UCHAR KIRQL;
+
+#define PASSIVE_LEVEL 0
+#define APC_LEVEL 1
+#define DISPATCH_LEVEL 2
+
+static inline KIRQL KeGetCurrentIrql (void)
+{
+    return PASSIVE_LEVEL;
+}
+
+//
+// Pool
+//
+
+typedef enum _POOL_TYPE {
+    NonPagedPoolNx = 512,
+} POOL_TYPE;
+
+static inline PVOID ExAllocatePoolWithTag (
+    POOL_TYPE PoolType,
+    SIZE_T NumberOfBytes,
+    ULONG Tag
+    )
+{
+    UNREFERENCED_PARAMETER(PoolType);
+    UNREFERENCED_PARAMETER(Tag);
+    return malloc(NumberOfBytes);
+}
+
+static inline void ExFreePoolWithTag (PVOID P, ULONG Tag)
+{
+    UNREFERENCED_PARAMETER(Tag);
+    free(P);
+}
+
+//
+// Strings and GUIDs
+//
+
+typedef const CHAR* PCSZ;
+
+typedef struct _STRING {
+    USHORT Length;
+    USHORT MaximumLength;
+    CHAR* Buffer;
+} ANSI_STRING, *PANSI_STRING;
+
+static inline NTSTATUS RtlInitAnsiStringEx (
+    PANSI_STRING DestinationString,
+    PCSZ SourceString
+    )
+{
+    DestinationString->Length = 0;
+    DestinationString->MaximumLength = 0;
+    DestinationString->Buffer = (CHAR*)SourceString;
+    if (SourceString != NULL) {
+        const size_t length = strlen(SourceString);
+        if (length > (MAXUSHORT - 1)) {
+            return STATUS_NAME_TOO_LONG;
+        }
+
+        DestinationString->Length = (USHORT)length;
+        DestinationString->MaximumLength = (USHORT)(length + 1);
+    }
+
+    return STATUS_SUCCESS;
+}
+
+static inline BOOLEAN RtlEqualString (
+    const ANSI_STRING* String1,
+    const ANSI_STRING* String2,
+    BOOLEAN CaseInSensitive
+    )
+{
+    assert(!CaseInSensitive);
+    UNREFERENCED_PARAMETER(CaseInSensitive);
+    return (String1->Length == String2->Length) &&
+           (memcmp(String1->Buffer, String2->Buffer, String1->Length) == 0);
+}
+
+#define RtlEqualMemory(Destination, Source, Length) \
+    (memcmp((Destination), (Source), (Length)) == 0)
+
+#ifdef __cplusplus
+static inline bool InlineIsEqualGUID (const GUID& Guid1, const GUID& Guid2)
+{
+    return memcmp(&Guid1, &Guid2, sizeof(GUID)) == 0;
+}
+#endif
+
+//
+// I/O manager
+//
+
+#define IRP_MJ_DEVICE_CONTROL 0x0e
+
+typedef struct _DEVICE_OBJECT {
+    CHAR StackSize;
+} DEVICE_OBJECT, *PDEVICE_OBJECT;
+
+typedef struct _IO_STATUS_BLOCK {
+    NTSTATUS Status;
+    ULONG_PTR Information;
+} IO_STATUS_BLOCK;
+
+typedef struct _IRP {
+    USHORT Flags;
+    union {
+        PVOID SystemBuffer;
+    } AssociatedIrp;
+    IO_STATUS_BLOCK IoStatus;
+    PVOID UserBuffer;
+} IRP, *PIRP;
+
+typedef struct _IO_STACK_LOCATION {
+    UCHAR MajorFunction;
+    union {
+        struct {
+            ULONG OutputBufferLength;
+            ULONG InputBufferLength;
+            ULONG IoControlCode;
+        } DeviceIoControl;
+    } Parameters;
+} IO_STACK_LOCATION, *PIO_STACK_LOCATION;
+
+static inline PIRP IoAllocateIrp (CHAR StackSize, BOOLEAN ChargeQuota)
+{
+    UNREFERENCED_PARAMETER(StackSize);
+    UNREFERENCED_PARAMETER(ChargeQuota);
+    return NULL;
+}
+
+static inline void IoFreeIrp (PIRP Irp)
+{
+    UNREFERENCED_PARAMETER(Irp);
+    assert(!"host tests do not send IRPs");
+}
+
+static inline PIO_STACK_LOCATION IoGetNextIrpStackLocation (PIRP Irp)
+{
+    UNREFERENCED_PARAMETER(Irp);
+    assert(!"host tests do not send IRPs");
+    return NULL;
+}
+
+static inline NTSTATUS IoSynchronousCallDriver (
+    PDEVICE_OBJECT DeviceObject,
+    PIRP Irp
+    )
+{
+    UNREFERENCED_PARAMETER(DeviceObject);
+    UNREFERENCED_PARAMETER(Irp);
+    assert(!"host tests do not send IRPs");
+    return STATUS_NOT_SUPPORTED;
+}
+
+#endif // _HOSTTEST_NTDDK_H_
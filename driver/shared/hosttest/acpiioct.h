@@ -0,0 +1,92 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// Host stand-in for the WDK header of the same name, see hosttest.h.
+// Provides the ACPI method argument and evaluation buffer layouts.
+//
+
+#ifndef _HOSTTEST_ACPIIOCT_H_
+#define _HOSTTEST_ACPIIOCT_H_
+
+#include "hosttest.h"
+
+#define IOCTL_ACPI_EVAL_METHOD \
+    CTL_CODE(0x32, 0, METHOD_BUFFERED, FILE_READ_DATA | FILE_WRITE_DATA)
+
+#define ACPI_EVAL_INPUT_BUFFER_SIGNATURE            'BieA'
+#define ACPI_EVAL_INPUT_BUFFER_COMPLEX_SIGNATURE    'CieA'
+#define ACPI_EVAL_OUTPUT_BUFFER_SIGNATURE           'BoeA'
+
+#define ACPI_METHOD_ARGUMENT_INTEGER    0x0
+#define ACPI_METHOD_ARGUMENT_STRING     0x1
+#define ACPI_METHOD_ARGUMENT_BUFFER     0x2
+#define ACPI_METHOD_ARGUMENT_PACKAGE    0x3
+
+typedef struct _ACPI_METHOD_ARGUMENT {
+    USHORT Type;
+    USHORT DataLength;
+    union {
+        ULONG Argument;
+        UCHAR Data[ANYSIZE_ARRAY];
+    };
+} ACPI_METHOD_ARGUMENT, *PACPI_METHOD_ARGUMENT;
+
+#define ACPI_METHOD_ARGUMENT_LENGTH(DataLength)                             \
+    (FIELD_OFFSET(ACPI_METHOD_ARGUMENT, Data) +                             \
+     (((DataLength) > sizeof(ULONG)) ? (DataLength) : sizeof(ULONG)))
+
+#define ACPI_METHOD_ARGUMENT_LENGTH_FROM_ARGUMENT(Argument)                 \
+    ACPI_METHOD_ARGUMENT_LENGTH(((PACPI_METHOD_ARGUMENT)(Argument))->DataLength)
+
+#define ACPI_METHOD_NEXT_ARGUMENT(Argument)                                 \
+    ((PACPI_METHOD_ARGUMENT)((PUCHAR)(Argument) +                           \
+        ACPI_METHOD_ARGUMENT_LENGTH_FROM_ARGUMENT(Argument)))
+
+#define ACPI_METHOD_SET_ARGUMENT_INTEGER(MethodArgument, IntData)           \
+    {                                                                       \
+        (MethodArgument)->Type = ACPI_METHOD_ARGUMENT_INTEGER;              \
+        (MethodArgument)->DataLength = sizeof(ULONG);                       \
+        (MethodArgument)->Argument = (IntData);                             \
+    }
+
+#define ACPI_METHOD_SET_ARGUMENT_BUFFER(MethodArgument, BuffData, BuffLength) \
+    {                                                                       \
+        (MethodArgument)->Type = ACPI_METHOD_ARGUMENT_BUFFER;               \
+        (MethodArgument)->DataLength = (USHORT)(BuffLength);                \
+        RtlCopyMemory(&(MethodArgument)->Data[0], (BuffData), (BuffLength)); \
+    }
+
+typedef struct _ACPI_EVAL_INPUT_BUFFER {
+    ULONG Signature;
+    union {
+        UCHAR MethodName[4];
+        ULONG MethodNameAsUlong;
+    };
+} ACPI_EVAL_INPUT_BUFFER, *PACPI_EVAL_INPUT_BUFFER;
+
+typedef struct _ACPI_EVAL_INPUT_BUFFER_COMPLEX {
+    ULONG Signature;
+    union {
+        UCHAR MethodName[4];
+        ULONG MethodNameAsUlong;
+    };
+    ULONG Size;
+    ULONG ArgumentCount;
+    ACPI_METHOD_ARGUMENT Argument[ANYSIZE_ARRAY];
+} ACPI_EVAL_INPUT_BUFFER_COMPLEX, *PACPI_EVAL_INPUT_BUFFER_COMPLEX;
+
+typedef struct _ACPI_EVAL_OUTPUT_BUFFER {
+    ULONG Signature;
+    ULONG Length;
+    ULONG Count;
+    ACPI_METHOD_ARGUMENT Argument[ANYSIZE_ARRAY];
+} ACPI_EVAL_OUTPUT_BUFFER, *PACPI_EVAL_OUTPUT_BUFFER;
+
+#define ACPI_EVAL_OUTPUT_BUFFER_ARGUMENTS_END(EvalOutputBuffer)             \
+    ((PACPI_METHOD_ARGUMENT)((PUCHAR)(EvalOutputBuffer) +                   \
+        (EvalOutputBuffer)->Length))
+
+#define ACPI_EVAL_OUTPUT_BUFFER_ARGUMENT_LENGTH(EvalOutputBuffer)           \
+    ((EvalOutputBuffer)->Length - FIELD_OFFSET(ACPI_EVAL_OUTPUT_BUFFER, Argument))
+
+#endif // _HOSTTEST_ACPIIOCT_H_
@@ -0,0 +1,352 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// Module Name:
+//
+//   hosttest.h
+//
+// Abstract:
+//
+//   Stand-ins for the WDK types, SAL annotations and Rtl routines used by
+//   the portable parts of the drivers, so that they can be built and unit
+//   tested on a development host with gcc or clang. Only what the host tests
+//   include is provided; anything that touches hardware or the kernel stays
+//   in the driver.
+//
+//   A host test is a single source file next to the driver it tests. It
+//   includes this header first and is built and run with one command, given
+//   at the top of each test and listed in Documentation/tests.md.
+//
+// Environment:
+//
+//   User mode, Linux or any other C11/C++14 host
+//
+
+#ifndef _HOSTTEST_H_
+#define _HOSTTEST_H_
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//
+// Basic types
+//
+
+#ifndef VOID
+#define VOID void
+#endif
+
+typedef char CHAR, *PCHAR;
+typedef uint8_t UCHAR, *PUCHAR, UINT8, BYTE;
+typedef int16_t SHORT;
+typedef uint16_t USHORT, *PUSHORT, UINT16, WCHAR;
+typedef int32_t LONG, *PLONG, INT32;
+typedef uint32_t ULONG, *PULONG, UINT32, DWORD;
+typedef unsigned int UINT;
+typedef int64_t LONG64, LONGLONG, INT64;
+typedef uint64_t ULONG64, ULONGLONG, UINT64;
+typedef size_t SIZE_T;
+typedef uintptr_t ULONG_PTR;
+typedef intptr_t LONG_PTR;
+typedef void* PVOID;
+typedef UCHAR BOOLEAN;
+typedef LONG NTSTATUS;
+
+typedef union _LARGE_INTEGER {
+    struct {
+        ULONG LowPart;
+        LONG HighPart;
+    };
+    struct {
+        ULONG LowPart;
+        LONG HighPart;
+    } u;
+    LONGLONG QuadPart;
+} LARGE_INTEGER, *PLARGE_INTEGER;
+
+#ifndef TRUE
+#define TRUE 1
+#define FALSE 0
+#endif
+
+#define MAXUSHORT 0xffff
+#define MAXULONG 0xffffffffUL
+
+//
+// Status codes used by the portable modules
+//
+
+#define STATUS_SUCCESS                  ((NTSTATUS)0x00000000L)
+#define STATUS_PENDING                  ((NTSTATUS)0x00000103L)
+#define STATUS_BUFFER_OVERFLOW          ((NTSTATUS)0x80000005L)
+#define STATUS_NO_MORE_ENTRIES          ((NTSTATUS)0x8000001AL)
+#define STATUS_UNSUCCESSFUL             ((NTSTATUS)0xC0000001L)
+#define STATUS_NOT_IMPLEMENTED          ((NTSTATUS)0xC0000002L)
+#define STATUS_INVALID_PARAMETER        ((NTSTATUS)0xC000000DL)
+#define STATUS_NO_MEMORY                ((NTSTATUS)0xC0000017L)
+#define STATUS_BUFFER_TOO_SMALL         ((NTSTATUS)0xC0000023L)
+#define STATUS_DEVICE_NOT_READY         ((NTSTATUS)0xC00000A3L)
+#define STATUS_INSUFFICIENT_RESOURCES   ((NTSTATUS)0xC000009AL)
+#define STATUS_IO_TIMEOUT               ((NTSTATUS)0xC00000B5L)
+#define STATUS_NOT_SUPPORTED            ((NTSTATUS)0xC00000BBL)
+#define STATUS_DEVICE_BUSY              ((NTSTATUS)0x80000011L)
+#define STATUS_INVALID_DEVICE_STATE     ((NTSTATUS)0xC0000184L)
+
+#define NT_SUCCESS(Status) (((NTSTATUS)(Status)) >= 0)
+
+//
+// Win32 error codes used by the portable parts of the user mode tools
+//
+
+#define NO_ERROR 0L
+
+//
+// Compiler and SAL
+//
+
+#define FORCEINLINE static inline __attribute__((always_inline))
+#define __forceinline inline __attribute__((always_inline))
+#define UNREFERENCED_PARAMETER(P) ((void)(P))
+#define ARRAYSIZE(A) (sizeof(A) / sizeof((A)[0]))
+#ifndef FIELD_OFFSET
+#define FIELD_OFFSET(Type, Field) offsetof(Type, Field)
+#endif
+#define DECLSPEC_ALIGN(X) __attribute__((aligned(X)))
+#define ANYSIZE_ARRAY 1
+
+#ifdef __cplusplus
+#define C_ASSERT(Expression) static_assert((Expression), #Expression)
+#else
+#define C_ASSERT(Expression) _Static_assert((Expression), #Expression)
+#endif
+#define UNALIGNED
+
+#define _In_
+#define _In_opt_
+#define _Out_
+#define _Out_opt_
+#define _Inout_
+#define _Inout_opt_
+#define _In_reads_(Count)
+#define _In_reads_bytes_(Size)
+#define _In_reads_opt_(Count)
+#define _In_reads_or_z_(Count)
+#define _In_z_
+#define _Out_writes_(Count)
+#define _Out_writes_bytes_(Size)
+#define _Out_writes_to_(Size, Count)
+#define _Out_writes_bytes_to_(Size, Count)
+#define _Outptr_
+#define _Outptr_result_bytebuffer_(Size)
+#define _Outptr_opt_result_bytebuffer_(Size)
+#define _Inout_updates_(Count)
+#define _Inout_updates_bytes_(Size)
+#define _Use_decl_annotations_
+#define _Must_inspect_result_
+#define _IRQL_requires_(Irql)
+#define _IRQL_requires_max_(Irql)
+#define _IRQL_requires_same_
+#define _Requires_lock_held_(Lock)
+#define _Analysis_assume_(Expression)
+#define _Analysis_assume_nullterminated_(Pointer)
+#define __analysis_assume_nullterminated(Pointer)
+#ifndef __fallthrough
+#define __fallthrough
+#endif
+
+#ifndef WDF_EXTERN_C_START
+#ifdef __cplusplus
+#define WDF_EXTERN_C_START extern "C" {
+#define WDF_EXTERN_C_END }
+#else
+#define WDF_EXTERN_C_START
+#define WDF_EXTERN_C_END
+#endif
+#endif
+
+#define NT_ASSERT(Condition) assert(Condition)
+#define ASSERT(Condition) assert(Condition)
+
+//
+// IOCTL codes, for the IOCTL headers shared with user mode tools
+//
+
+#define FILE_DEVICE_UNKNOWN 0x00000022
+#define METHOD_BUFFERED 0
+#define METHOD_IN_DIRECT 1
+#define METHOD_OUT_DIRECT 2
+#define METHOD_NEITHER 3
+#define FILE_ANY_ACCESS 0
+#define FILE_READ_DATA 0x0001
+#define FILE_WRITE_DATA 0x0002
+
+#define CTL_CODE(DeviceType, Function, Method, Access) \
+    (((DeviceType) << 16) | ((Access) << 14) | ((Function) << 2) | (Method))
+
+typedef struct _GUID {
+    ULONG Data1;
+    USHORT Data2;
+    USHORT Data3;
+    UCHAR Data4[8];
+} GUID;
+
+#define DEFINE_GUID(Name, L, W1, W2, B1, B2, B3, B4, B5, B6, B7, B8) \
+    static const GUID Name = {L, W1, W2, {B1, B2, B3, B4, B5, B6, B7, B8}}
+
+//
+// Rtl and barriers
+//
+
+#define RtlZeroMemory(Destination, Length) memset((Destination), 0, (Length))
+#define RtlFillMemory(Destination, Length, Fill) memset((Destination), (Fill), (Length))
+#define RtlCopyMemory(Destination, Source, Length) memcpy((Destination), (Source), (Length))
+#define RtlMoveMemory(Destination, Source, Length) memmove((Destination), (Source), (Length))
+
+#define _DataSynchronizationBarrier() __sync_synchronize()
+#define KeMemoryBarrier() __sync_synchronize()
+
+#define InterlockedExchange(Target, Value) \
+    __atomic_exchange_n((Target), (Value), __ATOMIC_SEQ_CST)
+#define InterlockedIncrement(Target) \
+    __atomic_add_fetch((Target), 1, __ATOMIC_SEQ_CST)
+#define InterlockedDecrement(Target) \
+    __atomic_sub_fetch((Target), 1, __ATOMIC_SEQ_CST)
+#define InterlockedAdd(Target, Value) \
+    __atomic_add_fetch((Target), (Value), __ATOMIC_SEQ_CST)
+#define InterlockedCompareExchange(Target, Exchange, Comparand) \
+    __sync_val_compare_and_swap((Target), (Comparand), (Exchange))
+
+//
+// Interlocked singly linked lists. The host list is guarded by a spin
+// lock rather than being lock-free, which is enough to run the drivers'
+// SLIST users from several threads.
+//
+
+#define PAGE_SIZE 0x1000
+
+typedef struct _SLIST_ENTRY {
+    struct _SLIST_ENTRY* Next;
+} SLIST_ENTRY, *PSLIST_ENTRY;
+
+typedef struct _SLIST_HEADER {
+    PSLIST_ENTRY Next;
+    volatile LONG Lock;
+} SLIST_HEADER, *PSLIST_HEADER;
+
+static inline void InitializeSListHead (PSLIST_HEADER ListHead)
+{
+    ListHead->Next = NULL;
+    ListHead->Lock = 0;
+}
+
+static inline void HostTestSListLock (PSLIST_HEADER ListHead)
+{
+    while (__atomic_exchange_n(&ListHead->Lock, 1, __ATOMIC_ACQUIRE) != 0) {
+        while (__atomic_load_n(&ListHead->Lock, __ATOMIC_RELAXED) != 0) {
+        }
+    }
+}
+
+static inline void HostTestSListUnlock (PSLIST_HEADER ListHead)
+{
+    __atomic_store_n(&ListHead->Lock, 0, __ATOMIC_RELEASE);
+}
+
+static inline PSLIST_ENTRY InterlockedPushEntrySList (
+    PSLIST_HEADER ListHead,
+    PSLIST_ENTRY ListEntry
+    )
+{
+    PSLIST_ENTRY first;
+
+    HostTestSListLock(ListHead);
+    first = ListHead->Next;
+    ListEntry->Next = first;
+    ListHead->Next = ListEntry;
+    HostTestSListUnlock(ListHead);
+    return first;
+}
+
+static inline PSLIST_ENTRY InterlockedPopEntrySList (PSLIST_HEADER ListHead)
+{
+    PSLIST_ENTRY first;
+
+    HostTestSListLock(ListHead);
+    first = ListHead->Next;
+    if (first != NULL) {
+        ListHead->Next = first->Next;
+    }
+    HostTestSListUnlock(ListHead);
+    return first;
+}
+
+#define RtlUshortByteSwap(Source) ((USHORT)__builtin_bswap16((USHORT)(Source)))
+#define RtlUlongByteSwap(Source) ((ULONG)__builtin_bswap32((ULONG)(Source)))
+
+//
+// Register access. A test that models a device defines these before
+// including this header, to route the driver's accesses to its model.
+//
+
+#ifndef READ_REGISTER_NOFENCE_ULONG
+#define READ_REGISTER_NOFENCE_ULONG(Register) (*(volatile ULONG*)(Register))
+#endif
+#ifndef WRITE_REGISTER_NOFENCE_ULONG
+#define WRITE_REGISTER_NOFENCE_ULONG(Register, Value) \
+    (*(volatile ULONG*)(Register) = (Value))
+#endif
+
+//
+// Checks. A failed check is reported and counted, and the test carries on
+// so that one run shows every failure.
+//
+
+static int HostTestFailureCount;
+
+#define HOSTTEST_CHECK(Condition)                                           \
+    do {                                                                    \
+        if (!(Condition)) {                                                 \
+            fprintf(stderr, "%s(%d): check failed: %s\n",                   \
+                    __FILE__, __LINE__, #Condition);                        \
+            ++HostTestFailureCount;                                         \
+        }                                                                   \
+    } while (0)
+
+#define HOSTTEST_CHECK_EQ(Actual, Expected)                                 \
+    do {                                                                    \
+        const long long _actual = (long long)(Actual);                      \
+        const long long _expected = (long long)(Expected);                  \
+        if (_actual != _expected) {                                         \
+            fprintf(stderr, "%s(%d): check failed: %s == %s "               \
+                    "(%lld != %lld)\n", __FILE__, __LINE__, #Actual,        \
+                    #Expected, _actual, _expected);                         \
+            ++HostTestFailureCount;                                         \
+        }                                                                   \
+    } while (0)
+
+//
+// Runs a test routine and reports it, main() returns HostTestExit().
+//
+#define HOSTTEST_RUN(Routine)                                               \
+    do {                                                                    \
+        const int _before = HostTestFailureCount;                           \
+        Routine();                                                          \
+        printf("%-48s %s\n", #Routine,                                      \
+               (HostTestFailureCount == _before) ? "ok" : "FAILED");        \
+    } while (0)
+
+static inline int HostTestExit (void)
+{
+    if (HostTestFailureCount != 0) {
+        printf("%d check(s) failed\n", HostTestFailureCount);
+        return 1;
+    }
+
+    return 0;
+}
+
+#endif // _HOSTTEST_H_
@@ -0,0 +1,7 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// Host stand-in for the SDK header of the same name, see hosttest.h.
+//
+
+#pragma pack(push, 1)
@@ -35,6 +35,10 @@
 #ifdef ALLOC_PRAGMA
     #pragma alloc_text(PAGE, ECSPIEvtDevicePrepareHardware)
     #pragma alloc_text(PAGE, ECSPIEvtDeviceReleaseHardware)
+    #pragma alloc_text(PAGE, ECSPIpDeviceMapCsGpioRegs)
+    #pragma alloc_text(PAGE, ECSPIpDeviceUnmapCsGpioReg)
+    #pragma alloc_text(PAGE, ECSPIpDeviceUnmapCsGpioRegs)
+    #pragma alloc_text(PAGE, ECSPIpDeviceQueryCsGpioPin)
 #endif
 
 //
@@ -260,6 +264,8 @@ ECSPIEvtDevicePrepareHardware (
         PVOID(devExtPtr->ECSPIRegsPtr)
         );
 
+    ECSPIpDeviceMapCsGpioRegs(devExtPtr);
+
     return STATUS_SUCCESS;
 }
 
@@ -304,6 +310,8 @@ ECSPIEvtDeviceReleaseHardware (
     }
     devExtPtr->ECSPIRegsPtr = nullptr;
 
+    ECSPIpDeviceUnmapCsGpioRegs(devExtPtr);
+
     for (ULONG spiCh = 0; spiCh < ECSPI_CHANNEL::COUNT; ++spiCh) {
 
         ECSPI_CS_GPIO_PIN* csGpioPinPtr = &devExtPtr->CsGpioPins[spiCh];
@@ -1340,9 +1348,13 @@ ECSPIDeviceAssertCS (
     //
     ECSPIHwSelectTarget(TrgCtxPtr);
 
-    if (csGpioPinPtr->GpioConnectionId.QuadPart == 0) {
+    if ((csGpioPinPtr->GpioConnectionId.QuadPart == 0) ||
+        ECSPIpDeviceSetGpioPinDirect(
+            TrgCtxPtr,
+            ECSPISpbGetCsActiveValue(TrgCtxPtr)
+            )) {
         //
-        // Not using GPIO for CS
+        // Not using GPIO for CS, or CS GPIO pin already set directly
         //
         SPBREQUEST lockRequest = devExtPtr->LockUnlockRequest;
         if (lockRequest != NULL) {
@@ -1423,9 +1435,13 @@ ECSPIDeviceNegateCS (
     ECSPI_DEVICE_EXTENSION* devExtPtr = TrgCtxPtr->DevExtPtr;
     ECSPI_CS_GPIO_PIN* csGpioPinPtr = ECSPIDeviceGetCsGpio(TrgCtxPtr);
 
-    if (csGpioPinPtr->GpioConnectionId.QuadPart == 0) {
+    if ((csGpioPinPtr->GpioConnectionId.QuadPart == 0) ||
+        ECSPIpDeviceSetGpioPinDirect(
+            TrgCtxPtr,
+            ECSPISpbGetCsNonActiveValue(TrgCtxPtr)
+            )) {
         //
-        // Not using GPIO for CS
+        // Not using GPIO for CS, or CS GPIO pin already set directly
         //
         SPBREQUEST lockRequest = devExtPtr->LockUnlockRequest;
         if (lockRequest != NULL) {
@@ -1556,6 +1572,599 @@ ECSPIpDeviceLogDeinit (
 }
 
 
+//
+// Routine Description:
+//
+//  ECSPIpDeviceMapCsGpioRegs is called to map the GPIO bank registers
+//  of the CS GPIO pins that are described by the optional device
+//  properties Cs<n>GpioBasePA (GPIO bank register base address),
+//  Cs<n>GpioPin (pin number in the bank) and Cs<n>GpioBankExclusive.
+//  The GPIO driver keeps a shadow copy of the bank data register and
+//  writes it back whole, so the direct path is only used when firmware
+//  sets Cs<n>GpioBankExclusive to state that no other pin of the bank is
+//  driven at runtime, except CS pins of this controller, and only if
+//  every CS pin of this controller in that bank is set directly.
+//  Cs<n>GpioBasePA must be the base of a GPIO bank register block, and
+//  that bank and Cs<n>GpioPin must match the GpioIo connection resource
+//  of the channel.
+//  CS GPIO pins without these properties are set through the GPIO driver.
+//
+// Arguments:
+//
+//  DevExtPtr - The device extension.
+//
+// Return Value:
+//
+_Use_decl_annotations_
+VOID
+ECSPIpDeviceMapCsGpioRegs (
+    ECSPI_DEVICE_EXTENSION* DevExtPtr
+    )
+{
+    PAGED_CODE();
+
+    static const CHAR* const csGpioBaseKeys[ECSPI_CHANNEL::COUNT] = {
+        "Cs0GpioBasePA", "Cs1GpioBasePA", "Cs2GpioBasePA", "Cs3GpioBasePA"
+        };
+    static const CHAR* const csGpioPinKeys[ECSPI_CHANNEL::COUNT] = {
+        "Cs0GpioPin", "Cs1GpioPin", "Cs2GpioPin", "Cs3GpioPin"
+        };
+    static const CHAR* const csGpioExclusiveKeys[ECSPI_CHANNEL::COUNT] = {
+        "Cs0GpioBankExclusive", "Cs1GpioBankExclusive",
+        "Cs2GpioBankExclusive", "Cs3GpioBankExclusive"
+        };
+
+    ACPI_EVAL_OUTPUT_BUFFER UNALIGNED* dsdBufferPtr = nullptr;
+    ACPI_DEVICE_PROPERTIES_INDEX* devicePropertiesIndexPtr = nullptr;
+    ULONG csGpioBanks[ECSPI_CHANNEL::COUNT];
+
+    for (ULONG spiCh = 0; spiCh < ECSPI_CHANNEL::COUNT; ++spiCh) {
+
+        csGpioBanks[spiCh] = ECSPI_GPIO_BANK_UNKNOWN;
+    }
+
+    NTSTATUS status = AcpiQueryDsd(
+        WdfDeviceWdmGetPhysicalDevice(DevExtPtr->WdfDevice),
+        &dsdBufferPtr
+        );
+    if (!NT_SUCCESS(status) || (dsdBufferPtr == nullptr)) {
+
+        goto done;
+    }
+
+    status = AcpiParseDsdAsDeviceProperties(
+        dsdBufferPtr,
+        &devicePropertiesIndexPtr
+        );
+    if (!NT_SUCCESS(status)) {
+
+        goto done;
+    }
+
+    for (ULONG spiCh = 0; spiCh < ECSPI_CHANNEL::COUNT; ++spiCh) {
+
+        ECSPI_CS_GPIO_PIN* csGpioPinPtr = &DevExtPtr->CsGpioPins[spiCh];
+        UINT32 gpioBasePA;
+        UINT32 gpioPin;
+        UINT32 gpioBankExclusive;
+        ULONG gpioBank;
+        ULONG connectionPin;
+
+        if (csGpioPinPtr->GpioConnectionId.QuadPart == 0) {
+
+            continue;
+        }
+
+        status = ECSPIpDeviceQueryCsGpioPin(
+            DevExtPtr,
+            csGpioPinPtr->GpioConnectionId,
+            &connectionPin
+            );
+        if (!NT_SUCCESS(status)) {
+
+            ECSPI_LOG_ERROR(
+                DevExtPtr->IfrLogHandle,
+                "Failed to query CS%lu GpioIo resource, status %!STATUS!, "
+                "CS GPIO pins are set through the GPIO driver",
+                spiCh,
+                status
+                );
+            continue;
+        }
+        csGpioBanks[spiCh] = connectionPin / ECSPI_GPIO_PINS_PER_BANK;
+
+        if (!NT_SUCCESS(AcpiDevicePropertiesQueryIntegerValue(
+                devicePropertiesIndexPtr,
+                csGpioBaseKeys[spiCh],
+                &gpioBasePA
+                )) ||
+            !NT_SUCCESS(AcpiDevicePropertiesQueryIntegerValue(
+                devicePropertiesIndexPtr,
+                csGpioPinKeys[spiCh],
+                &gpioPin
+                ))) {
+
+            continue;
+        }
+
+        if (!NT_SUCCESS(AcpiDevicePropertiesQueryIntegerValue(
+                devicePropertiesIndexPtr,
+                csGpioExclusiveKeys[spiCh],
+                &gpioBankExclusive
+                )) ||
+            (gpioBankExclusive == 0)) {
+
+            ECSPI_LOG_INFORMATION(
+                DevExtPtr->IfrLogHandle,
+                "%s not set, CS%lu GPIO pin is set through the GPIO driver",
+                csGpioExclusiveKeys[spiCh],
+                spiCh
+                );
+            continue;
+        }
+
+        if ((gpioPin >= ECSPI_GPIO_PINS_PER_BANK) ||
+            !ECSPIpDeviceDecodeGpioBank(gpioBasePA, &gpioBank)) {
+
+            ECSPI_LOG_ERROR(
+                DevExtPtr->IfrLogHandle,
+                "Invalid %s/%s values 0x%08lX/%lu, CS%lu GPIO pin is set "
+                "through the GPIO driver",
+                csGpioBaseKeys[spiCh],
+                csGpioPinKeys[spiCh],
+                gpioBasePA,
+                gpioPin,
+                spiCh
+                );
+            continue;
+        }
+
+        if ((csGpioBanks[spiCh] != gpioBank) ||
+            ((connectionPin % ECSPI_GPIO_PINS_PER_BANK) != gpioPin)) {
+
+            ECSPI_LOG_ERROR(
+                DevExtPtr->IfrLogHandle,
+                "%s/%s values 0x%08lX/%lu do not match CS%lu GpioIo "
+                "resource pin %lu, CS GPIO pin is set through the GPIO driver",
+                csGpioBaseKeys[spiCh],
+                csGpioPinKeys[spiCh],
+                gpioBasePA,
+                gpioPin,
+                spiCh,
+                connectionPin
+                );
+            continue;
+        }
+
+        csGpioPinPtr->GpioBankPhysAddress.QuadPart = gpioBasePA;
+        csGpioPinPtr->GpioDataRegPtr = static_cast<volatile ULONG*>(
+            MmMapIoSpaceEx(
+                csGpioPinPtr->GpioBankPhysAddress,
+                sizeof(ULONG),
+                PAGE_READWRITE | PAGE_NOCACHE
+                ));
+        if (csGpioPinPtr->GpioDataRegPtr == nullptr) {
+
+            ECSPI_LOG_ERROR(
+                DevExtPtr->IfrLogHandle,
+                "Failed to map CS%lu GPIO bank regs at 0x%08lX, "
+                "CS GPIO pin is set through the GPIO driver",
+                spiCh,
+                gpioBasePA
+                );
+            continue;
+        }
+        csGpioPinPtr->GpioPinMask = 1UL << gpioPin;
+
+        ECSPI_LOG_INFORMATION(
+            DevExtPtr->IfrLogHandle,
+            "CS%lu GPIO pin %lu set directly, bank regs mapped at %p",
+            spiCh,
+            gpioPin,
+            PVOID(csGpioPinPtr->GpioDataRegPtr)
+            );
+    }
+
+    //
+    // A CS pin set through the GPIO driver would write back the driver's
+    // stale copy of a directly set CS pin in the same bank, so the CS pins
+    // of a bank are either all set directly or all through the GPIO driver.
+    //
+    for (ULONG spiCh = 0; spiCh < ECSPI_CHANNEL::COUNT; ++spiCh) {
+
+        ECSPI_CS_GPIO_PIN* csGpioPinPtr = &DevExtPtr->CsGpioPins[spiCh];
+
+        if (csGpioPinPtr->GpioDataRegPtr == nullptr) {
+
+            continue;
+        }
+
+        for (ULONG otherCh = 0; otherCh < ECSPI_CHANNEL::COUNT; ++otherCh) {
+
+            const ECSPI_CS_GPIO_PIN* otherPinPtr = &DevExtPtr->CsGpioPins[otherCh];
+
+            if ((otherPinPtr->GpioConnectionId.QuadPart == 0) ||
+                (otherPinPtr->GpioDataRegPtr != nullptr) ||
+                ((csGpioBanks[otherCh] != csGpioBanks[spiCh]) &&
+                 (csGpioBanks[otherCh] != ECSPI_GPIO_BANK_UNKNOWN))) {
+
+                continue;
+            }
+
+            ECSPI_LOG_INFORMATION(
+                DevExtPtr->IfrLogHandle,
+                "CS%lu GPIO pin is set through the GPIO driver and may share "
+                "a bank with CS%lu, CS%lu GPIO pin is set through the GPIO driver",
+                otherCh,
+                spiCh,
+                spiCh
+                );
+
+            //
+            // A pin is only unmapped because of a pin that was already
+            // set through the GPIO driver, which every other directly set
+            // pin of the bank sees as well, so one pass is enough.
+            //
+            ECSPIpDeviceUnmapCsGpioReg(csGpioPinPtr);
+            break;
+        }
+    }
+
+done:
+
+    if (devicePropertiesIndexPtr != nullptr) {
+
+        AcpiDevicePropertiesFreeIndex(devicePropertiesIndexPtr);
+    }
+
+    if (dsdBufferPtr != nullptr) {
+
+        ExFreePoolWithTag(dsdBufferPtr, ACPI_TAG_EVAL_OUTPUT_BUFFER);
+    }
+}
+
+
+//
+// Routine Description:
+//
+//  ECSPIpDeviceQueryCsGpioPin is called to get the pin number of
+//  a CS GpioIo connection resource from the resource hub.
+//
+// Arguments:
+//
+//  DevExtPtr - The device extension.
+//
+//  ConnectionId - The CS GPIO pin connection ID.
+//
+//  PinNumberPtr - Caller pin number address. The pin number is the GPIO
+//      controller pin number, which is the bank pin number for the first
+//      bank.
+//
+// Return Value:
+//
+//  STATUS_INVALID_PARAMETER if the resource does not describe
+//  a single pin, or the resource hub status.
+//
+_Use_decl_annotations_
+NTSTATUS
+ECSPIpDeviceQueryCsGpioPin (
+    ECSPI_DEVICE_EXTENSION* DevExtPtr,
+    LARGE_INTEGER ConnectionId,
+    ULONG* PinNumberPtr
+    )
+{
+    PAGED_CODE();
+
+    WDFIOTARGET wdfIoTargetResHub = NULL;
+    RH_QUERY_CONNECTION_PROPERTIES_OUTPUT_BUFFER* propertiesPtr = nullptr;
+    ULONG propertiesLength =
+        FIELD_OFFSET(RH_QUERY_CONNECTION_PROPERTIES_OUTPUT_BUFFER,
+            ConnectionProperties) +
+        sizeof(PNP_GPIO_INTERRUPT_IO_DESCRIPTOR) +
+        64;
+
+    NTSTATUS status = WdfIoTargetCreate(
+        DevExtPtr->WdfDevice,
+        WDF_NO_OBJECT_ATTRIBUTES,
+        &wdfIoTargetResHub
+        );
+    if (!NT_SUCCESS(status)) {
+
+        goto done;
+    }
+
+    {
+        DECLARE_CONST_UNICODE_STRING(resHubName, RESOURCE_HUB_DEVICE_NAME);
+        WDF_IO_TARGET_OPEN_PARAMS openParams;
+
+        WDF_IO_TARGET_OPEN_PARAMS_INIT_OPEN_BY_NAME(
+            &openParams,
+            &resHubName,
+            STANDARD_RIGHTS_ALL
+            );
+        status = WdfIoTargetOpen(wdfIoTargetResHub, &openParams);
+        if (!NT_SUCCESS(status)) {
+
+            goto done;
+        }
+    }
+
+    RH_QUERY_CONNECTION_PROPERTIES_INPUT_BUFFER inputBuffer;
+    RtlZeroMemory(&inputBuffer, sizeof(inputBuffer));
+    inputBuffer.Version = RH_QUERY_CONNECTION_PROPERTIES_INPUT_VERSION;
+    inputBuffer.QueryType = ConnectionIdType;
+    inputBuffer.u.ConnectionId = ConnectionId;
+
+    WDF_MEMORY_DESCRIPTOR inputMemDesc;
+    WDF_MEMORY_DESCRIPTOR_INIT_BUFFER(
+        &inputMemDesc,
+        &inputBuffer,
+        sizeof(inputBuffer)
+        );
+
+    do {
+
+        propertiesPtr = static_cast<RH_QUERY_CONNECTION_PROPERTIES_OUTPUT_BUFFER*>(
+            ExAllocatePoolWithTag(
+                PagedPool,
+                propertiesLength,
+                ULONG(ECSPI_ALLOC_TAG::ECSPI_ALLOC_TAG_TEMP)
+                ));
+        if (propertiesPtr == nullptr) {
+
+            status = STATUS_INSUFFICIENT_RESOURCES;
+            goto done;
+        }
+
+        WDF_MEMORY_DESCRIPTOR outputMemDesc;
+        WDF_MEMORY_DESCRIPTOR_INIT_BUFFER(
+            &outputMemDesc,
+            propertiesPtr,
+            propertiesLength
+            );
+
+        status = WdfIoTargetSendIoctlSynchronously(
+            wdfIoTargetResHub,
+            NULL,
+            IOCTL_RH_QUERY_CONNECTION_PROPERTIES,
+            &inputMemDesc,
+            &outputMemDesc,
+            NULL,
+            NULL
+            );
+        if (status == STATUS_BUFFER_TOO_SMALL) {
+
+            propertiesLength = propertiesPtr->PropertiesLength +
+                FIELD_OFFSET(RH_QUERY_CONNECTION_PROPERTIES_OUTPUT_BUFFER,
+                    ConnectionProperties);
+            ExFreePoolWithTag(
+                propertiesPtr,
+                ULONG(ECSPI_ALLOC_TAG::ECSPI_ALLOC_TAG_TEMP)
+                );
+            propertiesPtr = nullptr;
+        }
+
+    } while (status == STATUS_BUFFER_TOO_SMALL);
+
+    if (!NT_SUCCESS(status)) {
+
+        goto done;
+    }
+
+    {
+        const PNP_GPIO_INTERRUPT_IO_DESCRIPTOR* gpioDescPtr =
+            reinterpret_cast<const PNP_GPIO_INTERRUPT_IO_DESCRIPTOR*>(
+                propertiesPtr->ConnectionProperties);
+        const ULONG descLength = propertiesPtr->PropertiesLength;
+
+        if ((descLength < sizeof(PNP_GPIO_INTERRUPT_IO_DESCRIPTOR)) ||
+            (gpioDescPtr->ResourceSourceNameOffset > descLength) ||
+            ((gpioDescPtr->ResourceSourceNameOffset -
+                gpioDescPtr->PinTableOffset) != sizeof(USHORT))) {
+
+            status = STATUS_INVALID_PARAMETER;
+            goto done;
+        }
+
+        *PinNumberPtr = *reinterpret_cast<const USHORT UNALIGNED*>(
+            reinterpret_cast<const UCHAR*>(gpioDescPtr) +
+                gpioDescPtr->PinTableOffset);
+    }
+
+done:
+
+    if (propertiesPtr != nullptr) {
+
+        ExFreePoolWithTag(
+            propertiesPtr,
+            ULONG(ECSPI_ALLOC_TAG::ECSPI_ALLOC_TAG_TEMP)
+            );
+    }
+
+    if (wdfIoTargetResHub != NULL) {
+
+        WdfObjectDelete(wdfIoTargetResHub);
+    }
+
+    return status;
+}
+
+
+//
+// Routine Description:
+//
+//  ECSPIpDeviceDecodeGpioBank is called to get the GPIO bank number
+//  of a GPIO bank register block base address.
+//
+// Arguments:
+//
+//  GpioBasePA - The GPIO bank register block physical address.
+//
+//  BankPtr - Caller bank number address, 0 for GPIO1.
+//
+// Return Value:
+//
+//  TRUE if GpioBasePA is the base of an i.MX GPIO bank, otherwise FALSE.
+//
+_Use_decl_annotations_
+BOOLEAN
+ECSPIpDeviceDecodeGpioBank (
+    UINT32 GpioBasePA,
+    ULONG* BankPtr
+    )
+{
+    static const struct {
+        ULONG Gpio1Base;
+        ULONG BankStride;
+        ULONG BankCount;
+    } gpioLayouts[] = {
+        { ECSPI_IMX6_GPIO1_BASE, ECSPI_IMX6_GPIO_BANK_STRIDE, ECSPI_IMX6_GPIO_BANK_COUNT },
+        { ECSPI_IMX7_GPIO1_BASE, ECSPI_IMX7_GPIO_BANK_STRIDE, ECSPI_IMX7_GPIO_BANK_COUNT },
+        };
+
+    for (ULONG layoutInx = 0; layoutInx < ARRAYSIZE(gpioLayouts); ++layoutInx) {
+
+        if (GpioBasePA < gpioLayouts[layoutInx].Gpio1Base) {
+
+            continue;
+        }
+
+        ULONG offset = GpioBasePA - gpioLayouts[layoutInx].Gpio1Base;
+        if (((offset % gpioLayouts[layoutInx].BankStride) == 0) &&
+            ((offset / gpioLayouts[layoutInx].BankStride) <
+                gpioLayouts[layoutInx].BankCount)) {
+
+            *BankPtr = offset / gpioLayouts[layoutInx].BankStride;
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+
+//
+// Routine Description:
+//
+//  ECSPIpDeviceUnmapCsGpioReg is called to unmap the GPIO bank registers
+//  of a CS GPIO pin, which is then set through the GPIO driver.
+//
+// Arguments:
+//
+//  CsGpioPinPtr - The CS GPIO pin.
+//
+// Return Value:
+//
+_Use_decl_annotations_
+VOID
+ECSPIpDeviceUnmapCsGpioReg (
+    ECSPI_CS_GPIO_PIN* CsGpioPinPtr
+    )
+{
+    PAGED_CODE();
+
+    if (CsGpioPinPtr->GpioDataRegPtr != nullptr) {
+
+        MmUnmapIoSpace(
+            const_cast<ULONG*>(CsGpioPinPtr->GpioDataRegPtr),
+            sizeof(ULONG)
+            );
+    }
+    CsGpioPinPtr->GpioDataRegPtr = nullptr;
+    CsGpioPinPtr->GpioPinMask = 0;
+    CsGpioPinPtr->GpioBankPhysAddress.QuadPart = 0;
+}
+
+
+//
+// Routine Description:
+//
+//  ECSPIpDeviceUnmapCsGpioRegs is called to unmap the GPIO bank registers
+//  mapped by ECSPIpDeviceMapCsGpioRegs.
+//
+// Arguments:
+//
+//  DevExtPtr - The device extension.
+//
+// Return Value:
+//
+_Use_decl_annotations_
+VOID
+ECSPIpDeviceUnmapCsGpioRegs (
+    ECSPI_DEVICE_EXTENSION* DevExtPtr
+    )
+{
+    PAGED_CODE();
+
+    for (ULONG spiCh = 0; spiCh < ECSPI_CHANNEL::COUNT; ++spiCh) {
+
+        ECSPIpDeviceUnmapCsGpioReg(&DevExtPtr->CsGpioPins[spiCh]);
+    }
+}
+
+
+//
+// Routine Description:
+//
+//  ECSPIpDeviceSetGpioPinDirect is called to change the state of the
+//  CS GPIO pin by writing the GPIO bank data register, without
+//  going through the GPIO driver.
+//  The pin is only mapped when firmware states the bank is not driven
+//  by anyone else at runtime (Cs<n>GpioBankExclusive) and every CS pin
+//  of this controller in the bank is set directly, so the GPIO driver
+//  never writes its copy of the data register back over the CS pins.
+//  Target connect and the transfers may set CS pins of the same bank
+//  concurrently, so the read-modify-write is done under CsGpioLock.
+//  The write completes synchronously, for IsWait callers as well.
+//
+// Arguments:
+//
+//  TrgCtxPtr - The target context.
+//
+//  Value - The new GPIO pin value.
+//
+// Return Value:
+//
+//  TRUE if the GPIO pin has been set, FALSE if it needs to be set
+//  through the GPIO driver.
+//
+_Use_decl_annotations_
+BOOLEAN
+ECSPIpDeviceSetGpioPinDirect (
+    ECSPI_TARGET_CONTEXT* TrgCtxPtr,
+    ULONG Value
+    )
+{
+    ECSPI_DEVICE_EXTENSION* devExtPtr = TrgCtxPtr->DevExtPtr;
+    ECSPI_CS_GPIO_PIN* csGpioPinPtr = ECSPIDeviceGetCsGpio(TrgCtxPtr);
+    KLOCK_QUEUE_HANDLE lockHandle;
+
+    if (csGpioPinPtr->GpioDataRegPtr == nullptr) {
+
+        return FALSE;
+    }
+
+    KeAcquireInStackQueuedSpinLock(&devExtPtr->CsGpioLock, &lockHandle);
+
+    ULONG gpioData = READ_REGISTER_NOFENCE_ULONG(csGpioPinPtr->GpioDataRegPtr);
+    if (Value != 0) {
+
+        gpioData |= csGpioPinPtr->GpioPinMask;
+
+    } else {
+
+        gpioData &= ~csGpioPinPtr->GpioPinMask;
+    }
+    WRITE_REGISTER_ULONG(csGpioPinPtr->GpioDataRegPtr, gpioData);
+
+    KeReleaseInStackQueuedSpinLock(&lockHandle);
+
+    csGpioPinPtr->GpioData = Value;
+
+    return TRUE;
+}
+
+
 //
 // Routine Description:
 //
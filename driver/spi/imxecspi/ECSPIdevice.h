@@ -22,6 +22,32 @@
 WDF_EXTERN_C_START
 
 
+//
+// i.MX GPIO bank layout, used to validate the
+// Cs<n>GpioBasePA/Cs<n>GpioPin device properties.
+//
+enum : ULONG {
+
+    ECSPI_GPIO_PINS_PER_BANK = 32,
+    ECSPI_GPIO_BANK_UNKNOWN = MAXULONG,
+
+    //
+    // i.MX6: GPIO1 at 0x0209C000, 7 banks, 16KB apart
+    //
+    ECSPI_IMX6_GPIO1_BASE = 0x0209C000,
+    ECSPI_IMX6_GPIO_BANK_STRIDE = 0x4000,
+    ECSPI_IMX6_GPIO_BANK_COUNT = 7,
+
+    //
+    // i.MX7/i.MX8M: GPIO1 at 0x30200000, up to 7 banks, 64KB apart
+    //
+    ECSPI_IMX7_GPIO1_BASE = 0x30200000,
+    ECSPI_IMX7_GPIO_BANK_STRIDE = 0x10000,
+    ECSPI_IMX7_GPIO_BANK_COUNT = 7
+
+};
+
+
 //
 // ECSPI_CS_GPIO_PIN.
 //  A CS GPIO pin descriptor.
@@ -60,6 +86,21 @@ typedef struct _ECSPI_CS_GPIO_PIN
     //
     ULONG OpenCount;
 
+    //
+    // Optional direct access to the CS GPIO pin, described by the
+    // Cs<n>GpioBasePA/Cs<n>GpioPin device properties.
+    // When available, CS is toggled by writing the GPIO bank data
+    // register (GPIOx_DR) from the transfer path, instead of sending
+    // IOCTL_GPIO_WRITE_PINS to the GPIO driver.
+    // The GPIO driver keeps a shadow copy of GPIOx_DR and writes it back
+    // whole, so this is only used when Cs<n>GpioBankExclusive states the
+    // bank has no other output pins that are changed at runtime, and
+    // when every CS pin of this controller in the bank is set directly.
+    //
+    PHYSICAL_ADDRESS GpioBankPhysAddress;
+    volatile ULONG* GpioDataRegPtr;
+    ULONG GpioPinMask;
+
 } ECSPI_CS_GPIO_PIN;
 
 
@@ -81,6 +122,12 @@ typedef struct _ECSPI_DEVICE_EXTENSION
     //
     KSPIN_LOCK DeviceLock;
 
+    //
+    // Serializes the read-modify-write of directly set CS GPIO
+    // bank data registers.
+    //
+    KSPIN_LOCK CsGpioLock;
+
     //
     // The LOG handle for this device
     //
@@ -223,6 +270,38 @@ ECSPIDeviceGetCsGpio (
         _In_ ECSPI_DEVICE_EXTENSION* DevExtPtr
         );
 
+    _IRQL_requires_max_(PASSIVE_LEVEL)
+    static VOID
+    ECSPIpDeviceMapCsGpioRegs (
+        _In_ ECSPI_DEVICE_EXTENSION* DevExtPtr
+        );
+
+    _IRQL_requires_max_(PASSIVE_LEVEL)
+    static NTSTATUS
+    ECSPIpDeviceQueryCsGpioPin (
+        _In_ ECSPI_DEVICE_EXTENSION* DevExtPtr,
+        _In_ LARGE_INTEGER ConnectionId,
+        _Out_ ULONG* PinNumberPtr
+        );
+
+    static BOOLEAN
+    ECSPIpDeviceDecodeGpioBank (
+        _In_ UINT32 GpioBasePA,
+        _Out_ ULONG* BankPtr
+        );
+
+    _IRQL_requires_max_(PASSIVE_LEVEL)
+    static VOID
+    ECSPIpDeviceUnmapCsGpioReg (
+        _Inout_ ECSPI_CS_GPIO_PIN* CsGpioPinPtr
+        );
+
+    _IRQL_requires_max_(PASSIVE_LEVEL)
+    static VOID
+    ECSPIpDeviceUnmapCsGpioRegs (
+        _In_ ECSPI_DEVICE_EXTENSION* DevExtPtr
+        );
+
     _IRQL_requires_max_(DISPATCH_LEVEL)
     static NTSTATUS
     ECSPIpDeviceSetGpioPin (
@@ -230,6 +309,13 @@ ECSPIDeviceGetCsGpio (
         _In_ ULONG Value
         );
 
+    _IRQL_requires_max_(DISPATCH_LEVEL)
+    static BOOLEAN
+    ECSPIpDeviceSetGpioPinDirect (
+        _In_ ECSPI_TARGET_CONTEXT* TrgCtxPtr,
+        _In_ ULONG Value
+        );
+
     static EVT_WDF_REQUEST_COMPLETION_ROUTINE ECSPIpGpioAssertCompletionRoutine;
     static EVT_WDF_REQUEST_COMPLETION_ROUTINE ECSPIpGpioNegateCompletionRoutine;
 
@@ -367,6 +367,7 @@ ECSPIEvtDeviceAdd (
         devExtPtr->WdfDevice = wdfDevice;
         devExtPtr->WdfSpiInterrupt = wdfInterrupt;
         KeInitializeSpinLock(&devExtPtr->DeviceLock);
+        KeInitializeSpinLock(&devExtPtr->CsGpioLock);
 
     } // Initialize the device extension
 
@@ -0,0 +1,346 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// Module Name:
+//
+//    ECSPIfifo.h
+//
+// Abstract:
+//
+//    This module contains the conversion between transfer buffer bytes
+//    and ECSPI FIFO words, used by the TX/RX FIFO paths in ECSPIhw.cpp.
+//    The routines touch nothing but the buffer and the FIFO data
+//    register, so they are also unit tested on the host
+//    (test/ECSPIfifotest.cpp).
+//
+// Environment:
+//
+//    kernel-mode only
+//
+
+#ifndef _ECSPI_FIFO_H_
+#define _ECSPI_FIFO_H_
+
+//
+// Routine Description:
+//
+//  ECSPIpHwByteSwap swaps the given number of bytes within a
+//  32 bit variable.
+//
+// Arguments:
+//
+//  Data - The original base value
+//
+//  BytesToSwap - The number of bytes to swap.
+//
+// Return Value:
+//
+//  A ULONG value with the bytes swapped.
+//
+__forceinline
+ULONG
+ECSPIpHwByteSwap (
+    _In_ ULONG Data,
+    _In_ ULONG BytesToSwap
+    ) 
+{
+    switch (BytesToSwap) {
+    case 1:
+        return Data;
+
+    case 2:
+        return ULONG(RtlUshortByteSwap(Data));
+
+    case 3:
+        return RtlUlongByteSwap(Data) >> 8;
+
+    case 4:
+        return RtlUlongByteSwap(Data);
+
+    default:
+        NT_ASSERT(FALSE);
+        return ULONG(-1);
+    }
+}
+
+//
+// Routine Description:
+//
+//  ECSPIpHwDataSwap swaps the given number based on
+//  the data bit length.
+//  Since ECSPI always shifts MSB first. When we are doing 
+//  8 bit transfers, we need to make sure data is sent 
+//  in the expected order.
+//
+// Arguments:
+//
+//  Data - The original base value
+//
+//  DataBitLengthBytes - The data bit length in bytes
+//
+// Return Value:
+//
+//  A ULONG value with the bytes swapped.
+//
+__forceinline
+ULONG
+ECSPIpHwDataSwap (
+    _In_ ULONG Data,
+    _In_ ULONG BytesToSwap,
+    _In_ ULONG DataBitLengthBytes
+    )
+{
+    switch (DataBitLengthBytes) {
+    case 1: // 8 bit transfers
+        return ECSPIpHwByteSwap(Data, BytesToSwap);
+
+    case 2: // 16 bit transfers
+        if (BytesToSwap == 4) {
+
+            return UlongWordSwap(Data);
+        }
+        NT_ASSERT(BytesToSwap == 2);
+        __fallthrough;
+    case 4: // 32 bit transfers
+        return Data;
+
+    default:
+        NT_ASSERT(FALSE);
+        return ULONG(-1);
+    }
+}
+
+//
+// Routine Description:
+//
+//  ECSPIpHwPackWord packs buffer bytes into a TX FIFO word.
+//  The buffer bytes are loaded with a single (unaligned) access,
+//  and swapped to match the data bit length.
+//  The routine has no side effects.
+//
+// Arguments:
+//
+//  BufferPtr - Address of the first byte to pack, no alignment
+//      is assumed.
+//
+//  BytesToPack - Number of bytes to pack (1..4).
+//
+//  DataBitLengthBytes - The data bit length in bytes
+//
+// Return Value:
+//
+//  The TX FIFO word.
+//
+__forceinline
+ULONG
+ECSPIpHwPackWord (
+    _In_reads_bytes_(BytesToPack) const UCHAR* BufferPtr,
+    _In_ ULONG BytesToPack,
+    _In_ ULONG DataBitLengthBytes
+    )
+{
+    ULONG data;
+
+    switch (BytesToPack) {
+    case 1:
+        data = *BufferPtr;
+        break;
+
+    case 2:
+        data = *reinterpret_cast<const USHORT UNALIGNED*>(BufferPtr);
+        break;
+
+    case 3:
+        data = *reinterpret_cast<const USHORT UNALIGNED*>(BufferPtr) |
+            (ULONG(BufferPtr[2]) << 16);
+        break;
+
+    case 4:
+        data = *reinterpret_cast<const ULONG UNALIGNED*>(BufferPtr);
+        break;
+
+    default:
+        NT_ASSERT(FALSE);
+        return ULONG(-1);
+    }
+
+    return ECSPIpHwDataSwap(data, BytesToPack, DataBitLengthBytes);
+}
+
+//
+// Routine Description:
+//
+//  ECSPIpHwUnpackWord unpacks a RX FIFO word into buffer bytes.
+//  It is the inverse of ECSPIpHwPackWord.
+//  The routine has no side effects other than writing the buffer.
+//
+// Arguments:
+//
+//  Data - The RX FIFO word.
+//
+//  BytesToUnpack - Number of bytes to unpack (1..4).
+//
+//  DataBitLengthBytes - The data bit length in bytes
+//
+//  BufferPtr - Address of the first byte to write, no alignment
+//      is assumed.
+//
+// Return Value:
+//
+__forceinline
+VOID
+ECSPIpHwUnpackWord (
+    _In_ ULONG Data,
+    _In_ ULONG BytesToUnpack,
+    _In_ ULONG DataBitLengthBytes,
+    _Out_writes_bytes_(BytesToUnpack) UCHAR* BufferPtr
+    )
+{
+    ULONG data = ECSPIpHwDataSwap(Data, BytesToUnpack, DataBitLengthBytes);
+
+    switch (BytesToUnpack) {
+    case 1:
+        *BufferPtr = UCHAR(data);
+        break;
+
+    case 2:
+        *reinterpret_cast<USHORT UNALIGNED*>(BufferPtr) = USHORT(data);
+        break;
+
+    case 3:
+        *reinterpret_cast<USHORT UNALIGNED*>(BufferPtr) = USHORT(data);
+        BufferPtr[2] = UCHAR(data >> 16);
+        break;
+
+    case 4:
+        *reinterpret_cast<ULONG UNALIGNED*>(BufferPtr) = data;
+        break;
+
+    default:
+        NT_ASSERT(FALSE);
+        break;
+    }
+}
+
+//
+// Routine Description:
+//
+//  ECSPIpHwWriteTxFifoWords writes full words from the buffer to
+//  TX FIFO. The data bit length is resolved once for the whole run,
+//  so each word is a single buffer load and a single register store.
+//  Produces the same FIFO words as ECSPIpHwPackWord(BufferPtr, 4, ...)
+//  called for each word.
+//
+// Arguments:
+//
+//  TxDataRegPtr - Address of the TXDATA register
+//
+//  BufferPtr - Address of the first byte, no alignment is assumed.
+//
+//  WordCount - Number of words to write. The caller makes sure the buffer
+//      holds WordCount words and TX FIFO has room for them.
+//
+//  DataBitLengthBytes - The data bit length in bytes
+//
+// Return Value:
+//
+__forceinline
+VOID
+ECSPIpHwWriteTxFifoWords (
+    _In_ volatile ULONG* TxDataRegPtr,
+    _In_reads_bytes_(WordCount * sizeof(ULONG)) const UCHAR* BufferPtr,
+    _In_ ULONG WordCount,
+    _In_ ULONG DataBitLengthBytes
+    )
+{
+    const ULONG UNALIGNED* wordPtr =
+        reinterpret_cast<const ULONG UNALIGNED*>(BufferPtr);
+    const ULONG UNALIGNED* endPtr = wordPtr + WordCount;
+
+    switch (DataBitLengthBytes) {
+    case 1: // 8 bit transfers
+        for (; wordPtr != endPtr; ++wordPtr) {
+            WRITE_REGISTER_NOFENCE_ULONG(
+                TxDataRegPtr,
+                RtlUlongByteSwap(*wordPtr)
+                );
+        }
+        break;
+
+    case 2: // 16 bit transfers
+        for (; wordPtr != endPtr; ++wordPtr) {
+            WRITE_REGISTER_NOFENCE_ULONG(TxDataRegPtr, UlongWordSwap(*wordPtr));
+        }
+        break;
+
+    case 4: // 32 bit transfers
+        for (; wordPtr != endPtr; ++wordPtr) {
+            WRITE_REGISTER_NOFENCE_ULONG(TxDataRegPtr, *wordPtr);
+        }
+        break;
+
+    default:
+        NT_ASSERT(FALSE);
+        break;
+    }
+}
+
+//
+// Routine Description:
+//
+//  ECSPIpHwReadRxFifoWords reads full words from RX FIFO to the buffer.
+//  It is the inverse of ECSPIpHwWriteTxFifoWords, and stores the same
+//  bytes as ECSPIpHwUnpackWord(..., 4, ...) called for each word.
+//
+// Arguments:
+//
+//  RxDataRegPtr - Address of the RXDATA register
+//
+//  WordCount - Number of words to read. The caller makes sure RX FIFO
+//      holds WordCount words and the buffer has room for them.
+//
+//  DataBitLengthBytes - The data bit length in bytes
+//
+//  BufferPtr - Address of the first byte to write, no alignment
+//      is assumed.
+//
+// Return Value:
+//
+__forceinline
+VOID
+ECSPIpHwReadRxFifoWords (
+    _In_ volatile ULONG* RxDataRegPtr,
+    _In_ ULONG WordCount,
+    _In_ ULONG DataBitLengthBytes,
+    _Out_writes_bytes_(WordCount * sizeof(ULONG)) UCHAR* BufferPtr
+    )
+{
+    ULONG UNALIGNED* wordPtr = reinterpret_cast<ULONG UNALIGNED*>(BufferPtr);
+    ULONG UNALIGNED* endPtr = wordPtr + WordCount;
+
+    switch (DataBitLengthBytes) {
+    case 1: // 8 bit transfers
+        for (; wordPtr != endPtr; ++wordPtr) {
+            *wordPtr = RtlUlongByteSwap(READ_REGISTER_NOFENCE_ULONG(RxDataRegPtr));
+        }
+        break;
+
+    case 2: // 16 bit transfers
+        for (; wordPtr != endPtr; ++wordPtr) {
+            *wordPtr = UlongWordSwap(READ_REGISTER_NOFENCE_ULONG(RxDataRegPtr));
+        }
+        break;
+
+    case 4: // 32 bit transfers
+        for (; wordPtr != endPtr; ++wordPtr) {
+            *wordPtr = READ_REGISTER_NOFENCE_ULONG(RxDataRegPtr);
+        }
+        break;
+
+    default:
+        NT_ASSERT(FALSE);
+        break;
+    }
+}
+
+#endif // !_ECSPI_FIFO_H_
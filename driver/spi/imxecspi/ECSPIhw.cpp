@@ -29,6 +29,7 @@
 
 // Module specific header files
 #include "ECSPIhw.h"
+#include "ECSPIfifo.h"
 #include "ECSPIspb.h"
 #include "ECSPIdriver.h"
 #include "ECSPIdevice.h"
@@ -591,18 +592,42 @@ ECSPIHwWriteTxFIFO (
     while ((maxWordsToWrite != 0) &&
            !ECSPISpbIsAllDataTransferred(TransferPtr)) {
 
-        ULONG txFifoWord;
-        ULONG bytesRead = ECSPIpHwReadWordFromMdl(TransferPtr, &txFifoWord);
+        ULONG bytesRead;
+        ULONG wordsWritten = ECSPIpHwGetFullWordRun(
+            TransferPtr,
+            maxWordsToWrite
+            );
+        if (wordsWritten != 0) {
+            //
+            // Full words within the burst and the current MDL
+            //
+            ECSPIpHwWriteTxFifoWords(
+                txDataRegPtr,
+                TransferPtr->CurrentMdlVaPtr + TransferPtr->CurrentMdlOffset,
+                wordsWritten,
+                TransferPtr->BufferStride
+                );
+            bytesRead = wordsWritten * sizeof(ULONG);
+            TransferPtr->CurrentMdlOffset += bytesRead;
 
-        WRITE_REGISTER_NOFENCE_ULONG(txDataRegPtr, txFifoWord);
-        --TransferPtr->BurstWords;
+        } else {
+            //
+            // Partial first word of a burst, or a word spanning MDLs
+            //
+            ULONG txFifoWord;
+            bytesRead = ECSPIpHwReadWordFromMdl(TransferPtr, &txFifoWord);
+
+            WRITE_REGISTER_NOFENCE_ULONG(txDataRegPtr, txFifoWord);
+            wordsWritten = 1;
+        }
+        TransferPtr->BurstWords -= wordsWritten;
 
         ECSPIpHwUpdateTransfer(TransferPtr, bytesRead);
 
         ECSPIpHwStartBurstIf(DevExtPtr, TransferPtr);
 
         totalBytesRead += bytesRead;
-        --maxWordsToWrite;
+        maxWordsToWrite -= wordsWritten;
     }
     requestPtr->TotalBytesTransferred += totalBytesRead;
 
@@ -647,18 +672,47 @@ ECSPIHwReadRxFIFO (
     volatile ULONG* rxDataRegPtr = &ecspiRegsPtr->RXDATA;
     ECSPI_SPB_REQUEST* requestPtr = TransferPtr->AssociatedRequestPtr;
 
+    ULONG maxWordsToRead = ECSPIHwQueryRxFifoCount(ecspiRegsPtr);
     ULONG totalBytesWritten = 0;
-    while (!ECSPIHwIsRxFifoEmpty(ecspiRegsPtr) && 
+    while ((maxWordsToRead != 0) &&
            !ECSPISpbIsAllDataTransferred(TransferPtr)) {
 
-        ULONG rxFifoWord = READ_REGISTER_NOFENCE_ULONG(rxDataRegPtr);
-        ULONG bytesWritten = ECSPIpHwWriteWordToMdl(TransferPtr, rxFifoWord);
+        ULONG bytesWritten;
+        ULONG wordsRead = ECSPIpHwGetFullWordRun(TransferPtr, maxWordsToRead);
+        if (wordsRead != 0) {
+            //
+            // Full words within the burst and the current MDL
+            //
+            ECSPIpHwReadRxFifoWords(
+                rxDataRegPtr,
+                wordsRead,
+                TransferPtr->BufferStride,
+                TransferPtr->CurrentMdlVaPtr + TransferPtr->CurrentMdlOffset
+                );
+            bytesWritten = wordsRead * sizeof(ULONG);
+            TransferPtr->CurrentMdlOffset += bytesWritten;
+
+        } else {
+            //
+            // Partial first word of a burst, or a word spanning MDLs
+            //
+            ULONG rxFifoWord = READ_REGISTER_NOFENCE_ULONG(rxDataRegPtr);
+            bytesWritten = ECSPIpHwWriteWordToMdl(TransferPtr, rxFifoWord);
+            wordsRead = 1;
+        }
 
         ECSPIpHwUpdateTransfer(TransferPtr, bytesWritten);
 
         ECSPIpHwStartBurstIf(DevExtPtr, TransferPtr);
 
         totalBytesWritten += bytesWritten;
+        maxWordsToRead -= wordsRead;
+        if (maxWordsToRead == 0) {
+            //
+            // Pick up the words received meanwhile
+            //
+            maxWordsToRead = ECSPIHwQueryRxFifoCount(ecspiRegsPtr);
+        }
     }
     requestPtr->TotalBytesTransferred += totalBytesWritten;
 
@@ -708,17 +762,11 @@ ECSPIHwWriteZerosTxFIFO (
     ULONG maxWordsToWrite = ECSPIHwQueryTxFifoSpace(ecspiRegsPtr);
 
     wordsToWrite = min(wordsToWrite, maxWordsToWrite);
-    while (wordsToWrite != 0) {
-        if (ECSPIHwIsTxFifoFull(ecspiRegsPtr)) {
-            break;
-        }
+    TransferPtr->BurstWords -= wordsToWrite;
+    for (; wordsToWrite != 0; --wordsToWrite) {
         WRITE_REGISTER_NOFENCE_ULONG(txDataRegPtr, 0);
-        --TransferPtr->BurstWords;
-        --wordsToWrite;
-
-        burstStarted |= ECSPIpHwStartBurstIf(DevExtPtr, TransferPtr);
     }
-    burstStarted |= ECSPIpHwStartBurstIf(DevExtPtr, TransferPtr);
+    burstStarted = ECSPIpHwStartBurstIf(DevExtPtr, TransferPtr);
 
     if (TransferPtr->IsStartBurst && !burstStarted) {
         // Need to start a new burst, but still processing current one.
@@ -956,63 +1004,51 @@ ECSPIpHwReadWordFromMdl (
     PULONG DataPtr
     )
 {
-    PMDL mdlPtr = TransferPtr->CurrentMdlPtr;
-    size_t mdlOffset = TransferPtr->CurrentMdlOffset;
-    ULONG bytesToRead = sizeof(ULONG);
-    ULONG readData = 0;
-    UCHAR* dataBytePtr = reinterpret_cast<UCHAR*>(&readData);
+    ULONG bytesToRead = ECSPIpHwGetWordBytes(TransferPtr);
+
+    ECSPIpHwSkipDoneMdls(TransferPtr);
 
     //
-    // LSBytes are in the first WORD of burst
+    // Fast path: the whole word is in the current MDL
     //
-    if (ECSPISpbIsBurstStart(TransferPtr)) {
-
-        bytesToRead = TransferPtr->BurstLength % sizeof(ULONG);
-        if (bytesToRead == 0) {
+    size_t mdlOffset = TransferPtr->CurrentMdlOffset;
+    if ((TransferPtr->CurrentMdlByteCount - mdlOffset) >= bytesToRead) {
 
-            bytesToRead = sizeof(ULONG);
-        }
+        *DataPtr = ECSPIpHwPackWord(
+            TransferPtr->CurrentMdlVaPtr + mdlOffset,
+            bytesToRead,
+            TransferPtr->BufferStride
+            );
+        TransferPtr->CurrentMdlOffset = mdlOffset + bytesToRead;
+        return bytesToRead;
     }
 
-    ULONG bytesLeftToRead = bytesToRead;
-    while (mdlPtr != nullptr) {
-
-        const UCHAR* mdlAddr =
-            reinterpret_cast<const UCHAR*>(mdlPtr->MappedSystemVa) + mdlOffset;
-        size_t byteCount = MmGetMdlByteCount(mdlPtr) - mdlOffset;
-
-        while (byteCount > 0) {
-
-            *dataBytePtr = *mdlAddr;
-
-            ++dataBytePtr;
-            ++mdlAddr;
-            ++mdlOffset;
-
-            --bytesLeftToRead;
-            if (bytesLeftToRead == 0) {
-
-                goto done;
-            }
-
-            --byteCount;
-
-        } // More bytes to write
+    //
+    // Word spans MDLs, gather it byte by byte
+    //
+    UCHAR wordBytes[sizeof(ULONG)];
+    ULONG bytesRead = 0;
+    while ((bytesRead < bytesToRead) &&
+           (TransferPtr->CurrentMdlPtr != nullptr)) {
 
-        mdlPtr = mdlPtr->Next;
-        mdlOffset = 0;
+        wordBytes[bytesRead] =
+            TransferPtr->CurrentMdlVaPtr[TransferPtr->CurrentMdlOffset];
 
-    } // More MDLs
+        ++TransferPtr->CurrentMdlOffset;
+        ++bytesRead;
 
-done:
+        ECSPIpHwSkipDoneMdls(TransferPtr);
 
-    NT_ASSERT(bytesLeftToRead == 0);
+    } // More bytes to read
 
-    *DataPtr = ECSPIpHwDataSwap(readData, bytesToRead, TransferPtr->BufferStride);
+    NT_ASSERT(bytesRead == bytesToRead);
 
-    TransferPtr->CurrentMdlPtr = mdlPtr;
-    TransferPtr->CurrentMdlOffset = mdlOffset;
-    return bytesToRead - bytesLeftToRead;
+    *DataPtr = ECSPIpHwPackWord(
+        wordBytes,
+        bytesRead,
+        TransferPtr->BufferStride
+        );
+    return bytesRead;
 }
 
 
@@ -1039,63 +1075,54 @@ ECSPIpHwWriteWordToMdl (
     ULONG Data
     )
 {
-    PMDL mdlPtr = TransferPtr->CurrentMdlPtr;
-    size_t mdlOffset = TransferPtr->CurrentMdlOffset;
-    ULONG bytesToWrite = sizeof(ULONG);
-    ULONG dataToWrite;
-    const UCHAR* dataBytePtr = reinterpret_cast<const UCHAR*>(&dataToWrite);
+    ULONG bytesToWrite = ECSPIpHwGetWordBytes(TransferPtr);
+
+    ECSPIpHwSkipDoneMdls(TransferPtr);
 
     //
-    // LSBytes are in the first WORD of burst
+    // Fast path: the whole word goes to the current MDL
     //
-    if (ECSPISpbIsBurstStart(TransferPtr)) {
-
-        bytesToWrite = TransferPtr->BurstLength % sizeof(ULONG);
-        if (bytesToWrite == 0) {
+    size_t mdlOffset = TransferPtr->CurrentMdlOffset;
+    if ((TransferPtr->CurrentMdlByteCount - mdlOffset) >= bytesToWrite) {
 
-            bytesToWrite = sizeof(ULONG);
-        }
+        ECSPIpHwUnpackWord(
+            Data,
+            bytesToWrite,
+            TransferPtr->BufferStride,
+            TransferPtr->CurrentMdlVaPtr + mdlOffset
+            );
+        TransferPtr->CurrentMdlOffset = mdlOffset + bytesToWrite;
+        return bytesToWrite;
     }
 
-    dataToWrite = ECSPIpHwDataSwap(Data, bytesToWrite, TransferPtr->BufferStride);
-
-    ULONG bytesLeftToWrite = bytesToWrite;
-    while (mdlPtr != nullptr) {
-
-        UCHAR* mdlAddr = 
-            reinterpret_cast<UCHAR*>(mdlPtr->MappedSystemVa) + mdlOffset;
-        size_t byteCount = MmGetMdlByteCount(mdlPtr) - mdlOffset;
-
-        while (byteCount > 0) {
-
-            *mdlAddr = *dataBytePtr;
-
-            ++dataBytePtr;
-            ++mdlAddr;
-            ++mdlOffset;
-
-            --bytesLeftToWrite;
-            if (bytesLeftToWrite == 0) {
-
-                goto done;
-            }
+    //
+    // Word spans MDLs, scatter it byte by byte
+    //
+    UCHAR wordBytes[sizeof(ULONG)];
+    ECSPIpHwUnpackWord(
+        Data,
+        bytesToWrite,
+        TransferPtr->BufferStride,
+        wordBytes
+        );
 
-            --byteCount;
+    ULONG bytesWritten = 0;
+    while ((bytesWritten < bytesToWrite) &&
+           (TransferPtr->CurrentMdlPtr != nullptr)) {
 
-        } // More bytes to write
+        TransferPtr->CurrentMdlVaPtr[TransferPtr->CurrentMdlOffset] =
+            wordBytes[bytesWritten];
 
-        mdlPtr = mdlPtr->Next;
-        mdlOffset = 0;
+        ++TransferPtr->CurrentMdlOffset;
+        ++bytesWritten;
 
-    } // More MDLs
+        ECSPIpHwSkipDoneMdls(TransferPtr);
 
-done:
+    } // More bytes to write
 
-    NT_ASSERT(bytesLeftToWrite == 0);
+    NT_ASSERT(bytesWritten == bytesToWrite);
 
-    TransferPtr->CurrentMdlPtr = mdlPtr;
-    TransferPtr->CurrentMdlOffset = mdlOffset;
-    return bytesToWrite - bytesLeftToWrite;
+    return bytesWritten;
 }
 
 
@@ -572,90 +572,106 @@ ECSPIpHwStartBurstIf (
     //
     // Routine Description:
     //
-    //  ECSPIpHwByteSwap swaps the given number of bytes within a
-    //  32 bit variable.
+    //  ECSPIpHwGetWordBytes returns the number of buffer bytes
+    //  carried by the next FIFO word.
+    //  LSBytes are in the first WORD of burst, all other
+    //  burst words are full.
     //
     // Arguments:
     //
-    //  Data - The original base value
-    //
-    //  BytesToSwap - The number of bytes to swap.
+    //  TransferPtr - The transfer descriptor
     //
     // Return Value:
     //
-    //  A ULONG value with the bytes swapped.
+    //  Number of bytes (1..4).
     //
     __forceinline
     ULONG
-    ECSPIpHwByteSwap (
-        _In_ ULONG Data,
-        _In_ ULONG BytesToSwap
-        ) 
+    ECSPIpHwGetWordBytes (
+        _In_ const ECSPI_SPB_TRANSFER* TransferPtr
+        )
     {
-        switch (BytesToSwap) {
-        case 1:
-            return Data;
-
-        case 2:
-            return ULONG(RtlUshortByteSwap(Data));
+        if (ECSPISpbIsBurstStart(TransferPtr)) {
 
-        case 3:
-            return RtlUlongByteSwap(Data) >> 8;
+            ULONG bytes = ULONG(TransferPtr->BurstLength % sizeof(ULONG));
+            if (bytes != 0) {
 
-        case 4:
-            return RtlUlongByteSwap(Data);
+                return bytes;
+            }
+        }
+        return sizeof(ULONG);
+    }
 
-        default:
-            NT_ASSERT(FALSE);
-            return ULONG(-1);
+    //
+    // Routine Description:
+    //
+    //  ECSPIpHwSkipDoneMdls moves the transfer to the next MDL
+    //  that still has data, if the current one is exhausted.
+    //
+    // Arguments:
+    //
+    //  TransferPtr - The transfer descriptor
+    //
+    // Return Value:
+    //
+    __forceinline
+    VOID
+    ECSPIpHwSkipDoneMdls (
+        _Inout_ ECSPI_SPB_TRANSFER* TransferPtr
+        )
+    {
+        while ((TransferPtr->CurrentMdlPtr != nullptr) &&
+               (TransferPtr->CurrentMdlOffset ==
+                TransferPtr->CurrentMdlByteCount)) {
+
+            ECSPISpbSetCurrentMdl(
+                TransferPtr,
+                TransferPtr->CurrentMdlPtr->Next
+                );
         }
     }
 
     //
     // Routine Description:
     //
-    //  ECSPIpHwDataSwap swaps the given number based on
-    //  the data bit length.
-    //  Since ECSPI always shifts MSB first. When we are doing 
-    //  8 bit transfers, we need to make sure data is sent 
-    //  in the expected order.
+    //  ECSPIpHwGetFullWordRun returns the number of full FIFO words
+    //  that can be moved between the current MDL and the FIFO in one run:
+    //  the words up to the end of the burst or of the current MDL,
+    //  whichever comes first, and at most MaxWords.
+    //  Returns 0 if the next word is the partial first word of a burst or
+    //  spans MDLs, these go through ECSPIpHwReadWordFromMdl and
+    //  ECSPIpHwWriteWordToMdl.
     //
     // Arguments:
     //
-    //  Data - The original base value
+    //  TransferPtr - The transfer descriptor
     //
-    //  DataBitLengthBytes - The data bit length in bytes
+    //  MaxWords - TX FIFO space or RX FIFO count
     //
     // Return Value:
     //
-    //  A ULONG value with the bytes swapped.
+    //  Number of words.
     //
     __forceinline
     ULONG
-    ECSPIpHwDataSwap (
-        _In_ ULONG Data,
-        _In_ ULONG BytesToSwap,
-        _In_ ULONG DataBitLengthBytes
+    ECSPIpHwGetFullWordRun (
+        _Inout_ ECSPI_SPB_TRANSFER* TransferPtr,
+        _In_ ULONG MaxWords
         )
     {
-        switch (DataBitLengthBytes) {
-        case 1: // 8 bit transfers
-            return ECSPIpHwByteSwap(Data, BytesToSwap);
+        ECSPIpHwSkipDoneMdls(TransferPtr);
 
-        case 2: // 16 bit transfers
-            if (BytesToSwap == 4) {
+        if (ECSPIpHwGetWordBytes(TransferPtr) != sizeof(ULONG)) {
 
-                return UlongWordSwap(Data);
-            }
-            NT_ASSERT(BytesToSwap == 2);
-            __fallthrough;
-        case 4: // 32 bit transfers
-            return Data;
-
-        default:
-            NT_ASSERT(FALSE);
-            return ULONG(-1);
+            return 0;
         }
+
+        size_t words = TransferPtr->BytesLeftInBurst / sizeof(ULONG);
+        size_t mdlWords = (TransferPtr->CurrentMdlByteCount -
+            TransferPtr->CurrentMdlOffset) / sizeof(ULONG);
+
+        words = min(words, mdlWords);
+        return ULONG(min(words, size_t(MaxWords)));
     }
 
     static VOID
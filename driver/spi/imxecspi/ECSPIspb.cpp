@@ -768,6 +768,8 @@ ECSPISpbPrepareNextTransfer (
 
         } // More MDLs
 
+        ECSPISpbSetCurrentMdl(reqXferPtr, baseMdlPtr);
+
         transferIn = (transferIn + 1) % MAX_PREPARED_TRANSFERS_COUNT;
         ++preparedTransfers;
 
@@ -181,6 +181,13 @@ typedef struct _ECSPI_SPB_TRANSFER {
     //
     size_t CurrentMdlOffset;
 
+    //
+    // Current MDL system address and byte count, cached so the
+    // FIFO paths do not go back to the MDL for every word.
+    //
+    UCHAR* CurrentMdlVaPtr;
+    size_t CurrentMdlByteCount;
+
     //
     // Buffer stride in bytes
     //
@@ -361,6 +368,46 @@ ECSPISpbIsBurstStart (
     return TransferPtr->BytesLeftInBurst == TransferPtr->BurstLength;
 }
 
+//
+// Routine Description:
+//
+//  ECSPISpbSetCurrentMdl makes the given MDL the current transfer MDL,
+//  and caches its system address and byte count.
+//  The MDL is expected to be already mapped to system address space.
+//
+// Arguments:
+//
+//  TransferPtr - The transfer descriptor
+//
+//  MdlPtr - The new current MDL, or nullptr if no more MDLs.
+//
+// Return Value:
+//
+__forceinline
+VOID
+ECSPISpbSetCurrentMdl (
+    _Inout_ ECSPI_SPB_TRANSFER* TransferPtr,
+    _In_opt_ PMDL MdlPtr
+    )
+{
+    TransferPtr->CurrentMdlPtr = MdlPtr;
+    TransferPtr->CurrentMdlOffset = 0;
+
+    if (MdlPtr != nullptr) {
+
+        NT_ASSERT(MdlPtr->MappedSystemVa != nullptr);
+
+        TransferPtr->CurrentMdlVaPtr =
+            reinterpret_cast<UCHAR*>(MdlPtr->MappedSystemVa);
+        TransferPtr->CurrentMdlByteCount = MmGetMdlByteCount(MdlPtr);
+
+    } else {
+
+        TransferPtr->CurrentMdlVaPtr = nullptr;
+        TransferPtr->CurrentMdlByteCount = 0;
+    }
+}
+
 //
 // Routine Description:
 //
@@ -20,6 +20,8 @@
 #include <wdf.h>
 #include <SpbCx.h>
 #include <gpio.h>
+#include <acpiioct.h>
+#include "acpiutil.hpp"
 
 #define RESHUB_USE_HELPER_ROUTINES
 #include <reshub.h>
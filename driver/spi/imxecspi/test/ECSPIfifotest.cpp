@@ -0,0 +1,347 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// Module Name:
+//
+//   ECSPIfifotest.cpp
+//
+// Abstract:
+//
+//   Host test of the ECSPI FIFO word packing in ECSPIfifo.h. Checks the
+//   FIFO words ECSPIpHwPackWord produces for every word size and data bit
+//   length, that ECSPIpHwUnpackWord undoes them at any buffer offset, and
+//   that the straight-line FIFO runs used for full words move the same
+//   words as packing them one at a time.
+//
+//   Build and run from the repository root:
+//
+//     c++ -std=c++14 -Wall -Wno-unknown-pragmas -Wno-multichar
+//         -I driver/shared/hosttest -I driver/spi/imxecspi
+//         driver/spi/imxecspi/test/ECSPIfifotest.cpp -o ECSPIfifotest
+//     ./ECSPIfifotest
+//
+// Environment:
+//
+//   User mode, host
+//
+
+//
+// TXDATA/RXDATA model: TX writes are appended to TxFifo, RX reads are
+// served from RxFifo.
+//
+#define WRITE_REGISTER_NOFENCE_ULONG(Register, Value) \
+    ((void)(Register), txFifoPush(Value))
+#define READ_REGISTER_NOFENCE_ULONG(Register) \
+    ((void)(Register), rxFifoPop())
+
+#include "hosttest.h"
+
+namespace { // static
+
+const ULONG FIFO_DEPTH = 64;
+
+ULONG TxFifo[FIFO_DEPTH];
+ULONG TxFifoCount;
+ULONG RxFifo[FIFO_DEPTH];
+ULONG RxFifoCount;
+ULONG RxFifoHead;
+
+void txFifoPush (ULONG Value)
+{
+    HOSTTEST_CHECK(TxFifoCount < FIFO_DEPTH);
+    if (TxFifoCount < FIFO_DEPTH) {
+        TxFifo[TxFifoCount++] = Value;
+    }
+}
+
+ULONG rxFifoPop ()
+{
+    HOSTTEST_CHECK(RxFifoHead < RxFifoCount);
+    if (RxFifoHead < RxFifoCount) {
+        return RxFifo[RxFifoHead++];
+    }
+    return 0xDEADBEEF;
+}
+
+} // namespace "static"
+
+#include "ECSPIcommon.h"
+#include "ECSPIfifo.h"
+
+namespace { // static
+
+const ULONG DATA_BIT_LENGTHS[] = { 1, 2, 4 };
+
+//
+// Offsets 0..3 of a buffer with an aligned base
+//
+union TEST_BUFFER {
+    ULONG Align;
+    UCHAR Bytes[(FIFO_DEPTH + 1) * sizeof(ULONG)];
+};
+
+void fillPattern (UCHAR* BufferPtr, ULONG Length, UCHAR Seed)
+{
+    for (ULONG i = 0; i < Length; ++i) {
+        BufferPtr[i] = UCHAR(Seed + i * 7 + 1);
+    }
+}
+
+bool isValidPacking (ULONG Bytes, ULONG DataBitLengthBytes)
+{
+    // A 16 bit transfer moves whole 16 bit words
+    return (DataBitLengthBytes != 2) || (Bytes == 2) || (Bytes == 4);
+}
+
+//
+// ECSPI shifts each FIFO word out MSB first. Returns the bytes of an
+// 8 bit transfer word in the order they go on the bus.
+//
+ULONG busBytes (ULONG Word, ULONG Bytes, UCHAR* BusPtr)
+{
+    ULONG count = 0;
+    for (LONG i = LONG(Bytes) - 1; i >= 0; --i) {
+        BusPtr[count++] = UCHAR(Word >> (i * 8));
+    }
+    return count;
+}
+
+//
+// Bytes go on the bus in buffer order for 8 bit transfers, and as
+// little endian 16/32 bit data words for wider transfers.
+//
+void testPackWordBusOrder ()
+{
+    static const UCHAR buffer[] = { 0x11, 0x22, 0x33, 0x44 };
+
+    HOSTTEST_CHECK_EQ(ECSPIpHwPackWord(buffer, 1, 1), 0x11);
+    HOSTTEST_CHECK_EQ(ECSPIpHwPackWord(buffer, 2, 1), 0x1122);
+    HOSTTEST_CHECK_EQ(ECSPIpHwPackWord(buffer, 3, 1), 0x112233);
+    HOSTTEST_CHECK_EQ(ECSPIpHwPackWord(buffer, 4, 1), 0x11223344);
+
+    HOSTTEST_CHECK_EQ(ECSPIpHwPackWord(buffer, 2, 2), 0x2211);
+    HOSTTEST_CHECK_EQ(ECSPIpHwPackWord(buffer, 4, 2), 0x22114433);
+
+    HOSTTEST_CHECK_EQ(ECSPIpHwPackWord(buffer, 1, 4), 0x11);
+    HOSTTEST_CHECK_EQ(ECSPIpHwPackWord(buffer, 2, 4), 0x2211);
+    HOSTTEST_CHECK_EQ(ECSPIpHwPackWord(buffer, 3, 4), 0x332211);
+    HOSTTEST_CHECK_EQ(ECSPIpHwPackWord(buffer, 4, 4), 0x44332211);
+
+    // 8 bit transfers: the bus carries the buffer bytes in order
+    for (ULONG bytes = 1; bytes <= 4; ++bytes) {
+        UCHAR bus[4];
+        ULONG count = busBytes(ECSPIpHwPackWord(buffer, bytes, 1), bytes, bus);
+
+        HOSTTEST_CHECK_EQ(count, bytes);
+        HOSTTEST_CHECK(memcmp(bus, buffer, bytes) == 0);
+    }
+}
+
+//
+// Pack never reads, and unpack never writes, past the given bytes,
+// whatever the alignment of the buffer.
+//
+void testPackUnpackUnaligned ()
+{
+    for (ULONG dataBitLength : DATA_BIT_LENGTHS) {
+        for (ULONG bytes = 1; bytes <= 4; ++bytes) {
+            if (!isValidPacking(bytes, dataBitLength)) {
+                continue;
+            }
+
+            for (ULONG offset = 0; offset < 4; ++offset) {
+                TEST_BUFFER source;
+                fillPattern(source.Bytes, sizeof(source.Bytes), UCHAR(offset));
+
+                // Bytes beyond the packed ones must not leak into the word
+                TEST_BUFFER poisoned = source;
+                for (ULONG i = offset + bytes; i < 8; ++i) {
+                    poisoned.Bytes[i] ^= 0xFF;
+                }
+
+                const ULONG word = ECSPIpHwPackWord(
+                        source.Bytes + offset,
+                        bytes,
+                        dataBitLength);
+
+                HOSTTEST_CHECK_EQ(
+                    ECSPIpHwPackWord(
+                        poisoned.Bytes + offset,
+                        bytes,
+                        dataBitLength),
+                    word);
+
+                if (bytes < 4) {
+                    HOSTTEST_CHECK_EQ(word >> (bytes * 8), 0);
+                }
+
+                TEST_BUFFER target;
+                RtlFillMemory(target.Bytes, sizeof(target.Bytes), 0xA5);
+                ECSPIpHwUnpackWord(
+                    word,
+                    bytes,
+                    dataBitLength,
+                    target.Bytes + offset);
+
+                HOSTTEST_CHECK(memcmp(
+                    target.Bytes + offset,
+                    source.Bytes + offset,
+                    bytes) == 0);
+
+                for (ULONG i = 0; i < sizeof(target.Bytes); ++i) {
+                    if ((i < offset) || (i >= (offset + bytes))) {
+                        HOSTTEST_CHECK_EQ(target.Bytes[i], 0xA5);
+                    }
+                }
+            }
+        }
+    }
+}
+
+//
+// A TX FIFO run writes the words ECSPIpHwPackWord gives for each full
+// word, at every offset, and stops at WordCount.
+//
+void testTxFifoRun ()
+{
+    for (ULONG dataBitLength : DATA_BIT_LENGTHS) {
+        for (ULONG offset = 0; offset < 4; ++offset) {
+            for (ULONG words = 0; words <= FIFO_DEPTH; words += 7) {
+                TEST_BUFFER source;
+                fillPattern(source.Bytes, sizeof(source.Bytes), UCHAR(words));
+
+                TxFifoCount = 0;
+                ECSPIpHwWriteTxFifoWords(
+                    nullptr,
+                    source.Bytes + offset,
+                    words,
+                    dataBitLength);
+
+                HOSTTEST_CHECK_EQ(TxFifoCount, words);
+                for (ULONG i = 0; (i < words) && (i < TxFifoCount); ++i) {
+                    HOSTTEST_CHECK_EQ(
+                        TxFifo[i],
+                        ECSPIpHwPackWord(
+                            source.Bytes + offset + i * sizeof(ULONG),
+                            sizeof(ULONG),
+                            dataBitLength));
+                }
+            }
+        }
+    }
+}
+
+//
+// A RX FIFO run stores the bytes ECSPIpHwUnpackWord gives for each full
+// word, at every offset, and leaves the rest of the buffer alone.
+//
+void testRxFifoRun ()
+{
+    for (ULONG dataBitLength : DATA_BIT_LENGTHS) {
+        for (ULONG offset = 0; offset < 4; ++offset) {
+            for (ULONG words = 0; words <= FIFO_DEPTH; words += 7) {
+                for (ULONG i = 0; i < words; ++i) {
+                    RxFifo[i] = 0x01020304 * (i + 1) ^ (offset << 28);
+                }
+                RxFifoCount = words;
+                RxFifoHead = 0;
+
+                TEST_BUFFER target;
+                RtlFillMemory(target.Bytes, sizeof(target.Bytes), 0x5A);
+                ECSPIpHwReadRxFifoWords(
+                    nullptr,
+                    words,
+                    dataBitLength,
+                    target.Bytes + offset);
+
+                HOSTTEST_CHECK_EQ(RxFifoHead, words);
+
+                TEST_BUFFER expected;
+                RtlFillMemory(expected.Bytes, sizeof(expected.Bytes), 0x5A);
+                for (ULONG i = 0; i < words; ++i) {
+                    ECSPIpHwUnpackWord(
+                        RxFifo[i],
+                        sizeof(ULONG),
+                        dataBitLength,
+                        expected.Bytes + offset + i * sizeof(ULONG));
+                }
+
+                HOSTTEST_CHECK(memcmp(
+                    target.Bytes,
+                    expected.Bytes,
+                    sizeof(target.Bytes)) == 0);
+            }
+        }
+    }
+}
+
+//
+// What goes out through TX comes back unchanged through RX in loopback,
+// for a transfer split into a partial first word and full word runs.
+//
+void testLoopback ()
+{
+    for (ULONG dataBitLength : DATA_BIT_LENGTHS) {
+        for (ULONG length = 1; length <= (FIFO_DEPTH * sizeof(ULONG)); ++length) {
+            const ULONG firstBytes = ((length % 4) != 0) ? (length % 4) : 4;
+            if (!isValidPacking(firstBytes, dataBitLength) ||
+                ((length % dataBitLength) != 0)) {
+
+                continue;
+            }
+
+            const ULONG offset = length % 4;
+            TEST_BUFFER source;
+            fillPattern(source.Bytes, sizeof(source.Bytes), UCHAR(length));
+
+            TxFifoCount = 0;
+            txFifoPush(ECSPIpHwPackWord(
+                source.Bytes + offset,
+                firstBytes,
+                dataBitLength));
+
+            ECSPIpHwWriteTxFifoWords(
+                nullptr,
+                source.Bytes + offset + firstBytes,
+                (length - firstBytes) / sizeof(ULONG),
+                dataBitLength);
+
+            memcpy(RxFifo, TxFifo, TxFifoCount * sizeof(ULONG));
+            RxFifoCount = TxFifoCount;
+            RxFifoHead = 0;
+
+            TEST_BUFFER target;
+            RtlZeroMemory(target.Bytes, sizeof(target.Bytes));
+            ECSPIpHwUnpackWord(
+                rxFifoPop(),
+                firstBytes,
+                dataBitLength,
+                target.Bytes + offset);
+
+            ECSPIpHwReadRxFifoWords(
+                nullptr,
+                (length - firstBytes) / sizeof(ULONG),
+                dataBitLength,
+                target.Bytes + offset + firstBytes);
+
+            HOSTTEST_CHECK_EQ(RxFifoHead, RxFifoCount);
+            HOSTTEST_CHECK(memcmp(
+                target.Bytes + offset,
+                source.Bytes + offset,
+                length) == 0);
+        }
+    }
+}
+
+} // namespace "static"
+
+int main ()
+{
+    HOSTTEST_RUN(testPackWordBusOrder);
+    HOSTTEST_RUN(testPackUnpackUnaligned);
+    HOSTTEST_RUN(testTxFifoRun);
+    HOSTTEST_RUN(testRxFifoRun);
+    HOSTTEST_RUN(testLoopback);
+
+    return HostTestExit();
+}
@@ -29,6 +29,13 @@ Abstract:
 
 #define GPT_RESET_DONE_MAX_RETRY 100    // Max retry counter for GPT reset complete
 
+//
+// GPT one-shot range. The upper bound keeps the distance to the
+// compare value unambiguous when checking for a missed match.
+//
+#define GPT_ONE_SHOT_MIN_TICKS 4
+#define GPT_ONE_SHOT_MAX_TICKS 0x7FFFFFFF
+
 typedef enum {
   IMX_TIMER_TYPE_INVALID,
   IMX_TIMER_TYPE_GPT,
@@ -162,6 +169,26 @@ HalpGptTimerQueryCounter(
     __in PVOID TimerDataPtr
     );
 
+static
+NTSTATUS
+HalpGptTimerArm(
+    __in PVOID TimerDataPtr,
+    __in TIMER_MODE Mode,
+    __in ULONGLONG TickCount
+    );
+
+static
+VOID
+HalpGptTimerAcknowledgeInterrupt(
+    __in PVOID TimerDataPtr
+    );
+
+static
+VOID
+HalpGptTimerStop(
+    __in PVOID TimerDataPtr
+    );
+
 //
 // EPIT Timer Functions
 //
@@ -293,6 +320,25 @@ HalpGptTimerRegister(
 
     NewTimer.MaxDivisor = 1;
     NewTimer.Capabilities = TIMER_COUNTER_READABLE;
+
+    //
+    // With an interrupt, output compare channel 1 provides a one-shot
+    // timer on top of the free running counter. The GPT goes offline in
+    // STOP mode, so it is not reported as always on.
+    //
+    if (CsrtTimerDescPtr->Interrupt != 0) {
+        NewTimer.FunctionTable.AcknowledgeInterrupt = HalpGptTimerAcknowledgeInterrupt;
+        NewTimer.FunctionTable.ArmTimer = HalpGptTimerArm;
+        NewTimer.FunctionTable.Stop = HalpGptTimerStop;
+
+        NewTimer.Capabilities |= TIMER_ONE_SHOT_CAPABLE |
+                                 TIMER_GENERATES_LINE_BASED_INTERRUPTS;
+
+        NewTimer.Interrupt.Mode = LevelSensitive;
+        NewTimer.Interrupt.Polarity = InterruptActiveHigh;
+        NewTimer.Interrupt.Gsi = CsrtTimerDescPtr->Interrupt;
+    }
+
     NewTimer.KnownType = TimerUnknown;
     NewTimer.Identifier = CsrtTimerDescPtr->Header.Uid;
 
@@ -531,6 +577,181 @@ Return Value:
     return ReadTimerReg(TimerPtr->BaseAddressPtr, GptCounterReg);
 }
 
+NTSTATUS
+HalpGptTimerArm (
+    __in PVOID TimerDataPtr,
+    __in TIMER_MODE Mode,
+    __in ULONGLONG TickCount
+    )
+
+/*++
+
+Routine Description:
+
+    This routine arms the GPT output compare channel 1 to fire an interrupt
+    after a given period of time. The counter keeps running freely, so the
+    compare value is set relative to the current count.
+
+Arguments:
+
+    TimerDataPtr - Supplies a pointer to the timer's internal data.
+
+    Mode - Supplies the desired mode to arm the timer with, only one-shot
+        is supported.
+
+    TickCount - Supplies the number of ticks from now that the timer should
+        interrupt in. Longer periods are clamped to GPT_ONE_SHOT_MAX_TICKS,
+        which fires early.
+
+Return Value:
+
+    STATUS_SUCCESS on success.
+
+    STATUS_INVALID_PARAMETER if an invalid mode was supplied.
+
+--*/
+
+{
+    PIMX6_GPT_INTERNAL_DATA TimerPtr;
+    PULONG BaseAddressPtr;
+    GPT_IR GptIR;
+    GPT_SR GptSR;
+    ULONG Ticks;
+    ULONG StartCount;
+
+    TimerPtr = (PIMX6_GPT_INTERNAL_DATA)TimerDataPtr;
+    BaseAddressPtr = TimerPtr->BaseAddressPtr;
+
+    if (Mode != TimerModeOneShot) {
+        NT_ASSERT(!"Invalid timer mode");
+        return STATUS_INVALID_PARAMETER;
+    }
+
+    if (TickCount < GPT_ONE_SHOT_MIN_TICKS) {
+        Ticks = GPT_ONE_SHOT_MIN_TICKS;
+    } else if (TickCount > GPT_ONE_SHOT_MAX_TICKS) {
+        Ticks = GPT_ONE_SHOT_MAX_TICKS;
+    } else {
+        Ticks = (ULONG)TickCount;
+    }
+
+    //
+    // ACK a stale compare event before programming the new one
+    //
+
+    GptSR.Dword = 0;
+    GptSR.Bits.OF1 = 1;
+    WriteTimerReg(BaseAddressPtr, GptStatusReg, GptSR.Dword);
+
+    StartCount = ReadTimerReg(BaseAddressPtr, GptCounterReg);
+    WriteTimerReg(BaseAddressPtr, GptCompare1Reg, StartCount + Ticks);
+
+    GptIR.Dword = 0;
+    GptIR.Bits.OF1E = 1;
+    WriteTimerReg(BaseAddressPtr, GptInterruptReg, GptIR.Dword);
+
+    //
+    // If the counter went past the compare value while it was being
+    // written, the match is missed until the counter wraps. Move the
+    // compare value ahead until it is either pending or still to come.
+    //
+
+    for (;;) {
+        ULONG Count;
+
+        GptSR.Dword = ReadTimerReg(BaseAddressPtr, GptStatusReg);
+        if (GptSR.Bits.OF1 != 0) {
+            break;
+        }
+
+        Count = ReadTimerReg(BaseAddressPtr, GptCounterReg);
+        if ((Count - StartCount) < Ticks) {
+            break;
+        }
+
+        StartCount = Count;
+        Ticks = GPT_ONE_SHOT_MIN_TICKS;
+        WriteTimerReg(BaseAddressPtr, GptCompare1Reg, StartCount + Ticks);
+    }
+
+    return STATUS_SUCCESS;
+}
+
+VOID
+HalpGptTimerAcknowledgeInterrupt (
+    __in PVOID TimerDataPtr
+    )
+
+/*++
+
+Routine Description:
+
+    This routine acknowledges a GPT output compare interrupt and disarms
+    the one-shot timer.
+
+Arguments:
+
+    TimerDataPtr - Supplies a pointer to the timer's internal data.
+
+Return Value:
+
+    None.
+
+--*/
+
+{
+    HalpGptTimerStop(TimerDataPtr);
+
+    return;
+}
+
+VOID
+HalpGptTimerStop (
+    __in PVOID TimerDataPtr
+    )
+
+/*++
+
+Routine Description:
+
+    This routine stops the GPT from generating interrupts. The counter
+    keeps running.
+
+Arguments:
+
+    TimerDataPtr - Supplies a pointer to the timer's internal data.
+
+Return Value:
+
+    None.
+
+--*/
+
+{
+    PIMX6_GPT_INTERNAL_DATA TimerPtr;
+    PULONG BaseAddressPtr;
+    GPT_SR GptSR;
+
+    TimerPtr = (PIMX6_GPT_INTERNAL_DATA)TimerDataPtr;
+    BaseAddressPtr = TimerPtr->BaseAddressPtr;
+
+    //
+    // Disable interrupts
+    //
+
+    WriteTimerReg(BaseAddressPtr, GptInterruptReg, 0);
+
+    //
+    // ACK any pending compare event
+    //
+
+    GptSR.Dword = 0;
+    GptSR.Bits.OF1 = 1;
+    WriteTimerReg(BaseAddressPtr, GptStatusReg, GptSR.Dword);
+
+    return;
+}
+
 NTSTATUS
 HalpEpitTimerRegister(
     ULONG Handle,
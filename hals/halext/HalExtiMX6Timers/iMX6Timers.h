@@ -36,6 +36,7 @@ typedef enum _GPT_REGISTERS {
     GptPreScalerReg    =  0x04, // GPT_PR
     GptStatusReg       =  0x08, // GPT_SR
     GptInterruptReg    =  0x0C, // GPT_IR
+    GptCompare1Reg     =  0x10, // GPT_OCR1
     GptCounterReg      =  0x24, // GPT_CNT
 
     MaxGptReg